@@ -0,0 +1,221 @@
+/*
+ *   @file  mmw_bulk_cfg.h
+ *
+ *   @brief
+ *      Framing and parsing of the bulkCfg CLI command.
+ *
+ *      The host sends one command line
+ *          bulkCfg <bytes> <fletcher16 hex>
+ *      ended by a single LF, waits for Ready and then sends the whole .cfg
+ *      profile in one write. The CLI reads the command line up to the
+ *      first CR or LF, so a CR LF ending would leave the LF in front of
+ *      the profile; the host must only send the LF. The profile is then
+ *      checked, split into lines and arguments in place and every command
+ *      looked up before any of them runs.
+ *
+ *      Nothing here needs the SDK, the MSS CLI uses it and
+ *      HostTools/bulk_cfg_load.c sends and round trips with it.
+ */
+
+#ifndef MMW_BULK_CFG_H
+#define MMW_BULK_CFG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*! @brief  Name of the command */
+#define MMWDEMO_BULK_CFG_CMD            "bulkCfg"
+
+/*! @brief  Largest profile, a full demo .cfg is around 1.5KB */
+#define MMWDEMO_BULK_CFG_MAX_SIZE       (4096U)
+
+/*! @brief  Most command lines in a profile */
+#define MMWDEMO_BULK_CFG_MAX_LINES      (96U)
+
+/*! @brief  Most arguments in a profile, over all its lines */
+#define MMWDEMO_BULK_CFG_MAX_ARGS       (1024U)
+
+/*! @brief  Most arguments of one line, as CLI_MAX_ARGS of the SDK CLI */
+#define MMWDEMO_BULK_CFG_MAX_LINE_ARGS  (40U)
+
+/*!
+ * @brief
+ *  One command line of a profile.
+ */
+typedef struct MmwDemo_bulkCfgLine_t
+{
+    /*! @brief   What the lookup returned for the command */
+    void        *entry;
+
+    /*! @brief   First argument in args[], the command name */
+    uint16_t    argStart;
+
+    /*! @brief   Arguments, the command name included */
+    uint16_t    argc;
+
+    /*! @brief   Line number in the profile, from 1 */
+    uint16_t    lineNum;
+} MmwDemo_bulkCfgLine;
+
+/*!
+ * @brief
+ *  A received profile and its parse. Several KB, so kept out of task stacks.
+ */
+typedef struct MmwDemo_bulkCfg_t
+{
+    /*! @brief   Profile as received, one more byte to end it */
+    uint8_t             buf[MMWDEMO_BULK_CFG_MAX_SIZE + 1U];
+
+    /*! @brief   Command lines found */
+    MmwDemo_bulkCfgLine line[MMWDEMO_BULK_CFG_MAX_LINES];
+
+    /*! @brief   Arguments of all lines, pointing into buf */
+    char                *args[MMWDEMO_BULK_CFG_MAX_ARGS];
+
+    /*! @brief   Valid entries in line[] */
+    uint32_t            numLines;
+} MmwDemo_bulkCfg;
+
+/*!
+ * @brief
+ *  Finds a command for @ref MmwDemo_bulkCfgParse, NULL when there is none
+ *  or it is not allowed in a profile.
+ */
+typedef void *(*MmwDemo_bulkCfgLookupFxn)(void *arg, const char *cmd);
+
+/**
+ *  @b Description
+ *  @n
+ *      Fletcher-16 checksum of a profile.
+ *
+ *  @retval   Checksum
+ */
+static inline uint16_t MmwDemo_bulkCfgChecksum(const uint8_t *data, uint32_t size)
+{
+    uint32_t sum1 = 0U;
+    uint32_t sum2 = 0U;
+    uint32_t i;
+
+    for (i = 0U; i < size; i++)
+    {
+        sum1 = (sum1 + data[i]) % 255U;
+        sum2 = (sum2 + sum1) % 255U;
+    }
+    return (uint16_t)((sum2 << 8) | sum1);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Writes the command line the host sends in front of a profile.
+ *
+ *  @param[out] out         Command line, ended by a single LF
+ *  @param[in]  outSize     Bytes of out
+ *  @param[in]  data        Profile
+ *  @param[in]  size        Bytes of the profile
+ *
+ *  @retval   Bytes of the command line, as snprintf
+ */
+static inline int32_t MmwDemo_bulkCfgFormatCmd(char *out, uint32_t outSize, const uint8_t *data, uint32_t size)
+{
+    return (int32_t)snprintf(out, outSize, "%s %u %x\n", MMWDEMO_BULK_CFG_CMD, (unsigned int)size,
+                             (unsigned int)MmwDemo_bulkCfgChecksum(data, size));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Splits the profile in cfg->buf into lines and arguments in place and
+ *      looks up the command of every line. Empty lines and lines starting
+ *      with '%' are skipped, a CR LF pair ends one line. Nothing is run, so
+ *      a bad profile is refused before it touches the configuration.
+ *
+ *  @param[in]  cfg         Profile, size bytes in buf
+ *  @param[in]  size        Bytes of the profile, at most @ref MMWDEMO_BULK_CFG_MAX_SIZE
+ *  @param[in]  lookup      Finds the command of a line
+ *  @param[in]  arg         Passed to lookup
+ *
+ *  @retval   0 when every line checks out, else the number of the first bad line
+ */
+static inline int32_t MmwDemo_bulkCfgParse(MmwDemo_bulkCfg *cfg, uint32_t size,
+                                           MmwDemo_bulkCfgLookupFxn lookup, void *arg)
+{
+    char        *ptrLine = (char *)&cfg->buf[0];
+    char        *ptrEnd  = (char *)&cfg->buf[size];
+    char        *ptrNext;
+    char        *ptr;
+    char        term;
+    uint32_t    numArgs = 0U;
+    uint16_t    lineNum = 0U;
+
+    cfg->numLines = 0U;
+    cfg->buf[size] = 0;
+    while (ptrLine < ptrEnd)
+    {
+        uint32_t argStart = numArgs;
+
+        /* Cut out the next line */
+        lineNum++;
+        ptrNext = ptrLine;
+        while ((ptrNext < ptrEnd) && (*ptrNext != '\n') && (*ptrNext != '\r'))
+        {
+            ptrNext++;
+        }
+        term = *ptrNext;
+        *ptrNext = 0;
+
+        if (ptrLine[0] != '%')
+        {
+            /* Split it at spaces and tabs */
+            ptr = ptrLine;
+            while (*ptr != 0)
+            {
+                if ((*ptr == ' ') || (*ptr == '\t'))
+                {
+                    *ptr++ = 0;
+                    continue;
+                }
+                if ((numArgs >= MMWDEMO_BULK_CFG_MAX_ARGS) ||
+                    ((numArgs - argStart) >= MMWDEMO_BULK_CFG_MAX_LINE_ARGS))
+                {
+                    return lineNum;
+                }
+                cfg->args[numArgs++] = ptr;
+                while ((*ptr != 0) && (*ptr != ' ') && (*ptr != '\t'))
+                {
+                    ptr++;
+                }
+            }
+
+            if (numArgs > argStart)
+            {
+                MmwDemo_bulkCfgLine *line;
+
+                if (cfg->numLines >= MMWDEMO_BULK_CFG_MAX_LINES)
+                {
+                    return lineNum;
+                }
+                line = &cfg->line[cfg->numLines];
+                line->entry    = lookup(arg, cfg->args[argStart]);
+                line->argStart = (uint16_t)argStart;
+                line->argc     = (uint16_t)(numArgs - argStart);
+                line->lineNum  = lineNum;
+                if (line->entry == NULL)
+                {
+                    return lineNum;
+                }
+                cfg->numLines++;
+            }
+        }
+
+        /* A CR LF pair only counts as one line */
+        if ((term == '\r') && ((ptrNext + 1) < ptrEnd) && (ptrNext[1] == '\n'))
+        {
+            ptrNext++;
+        }
+        ptrLine = ptrNext + 1;
+    }
+    return 0;
+}
+
+#endif /* MMW_BULK_CFG_H */
@@ -69,6 +69,8 @@ typedef struct MmwDemo_GuiMonSel_t
     /*! @brief   if 1: Send list of detected objects (see @ref DPIF_PointCloudCartesian) and
      *                 side info (@ref DPIF_PointCloudSideInfo).\n
      *           if 2: Send list of detected objects only (no side info)\n
+     *           if 3: Send detected objects and side info quantized to 10 bytes
+     *                 a point (@ref MMWDEMO_OUTPUT_MSG_COMPRESSED_POINTS)\n
      *           if 0: Don't send anything */
     uint8_t        detectedObjects;
 
@@ -81,7 +83,10 @@ typedef struct MmwDemo_GuiMonSel_t
     /*! @brief   Send complex range bins at zero doppler, all antenna symbols for range-azimuth heat map */
     uint8_t        rangeAzimuthHeatMap;
 
-    /*! @brief   Send complex range bins at zero doppler, (all antenna symbols), for range-azimuth heat map */
+    /*! @brief   if 1: Send the range/Doppler detection matrix\n
+     *           if 2: Send it losslessly compressed (@ref MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED)\n
+     *           if 3 to 9: Send it compressed with an error of at most 2^(level-2)-1 LSB\n
+     *           if 0: Don't send it */
     uint8_t        rangeDopplerHeatMap;
 
     /*! @brief   Send stats */
@@ -0,0 +1,337 @@
+/*
+ *   @file  mmw_heatmap_codec.h
+ *
+ *   @brief
+ *      Codec of the compressed range/Doppler heatmap TLV,
+ *      @ref MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED.
+ *
+ *      Every bin is predicted, from the same bin of the heatmap before or,
+ *      in a key frame, from the bin before it in the same heatmap. Only the
+ *      residuals are sent, in one to three bytes, and a run of zero
+ *      residuals takes one or two bytes however long it is. A residual no
+ *      bigger than the dead band of the level is sent as zero, so a
+ *      detection matrix that only moves in its noise costs a few bytes.
+ *      The encoder predicts from what the decoder will have, not from the
+ *      input, so the error never grows past the dead band. The MSS encodes,
+ *      HostTools/heatmap_dec.c decodes. Nothing here needs the SDK.
+ */
+
+#ifndef MMW_HEATMAP_CODEC_H
+#define MMW_HEATMAP_CODEC_H
+
+#include <stdint.h>
+
+/*! @brief  rangeDopplerHeatMap of guiMonitor that sends the heatmap losslessly compressed */
+#define MMWDEMO_HEATMAP_LEVEL_LOSSLESS      (2U)
+
+/*! @brief  Highest rangeDopplerHeatMap, dead band of 127 */
+#define MMWDEMO_HEATMAP_LEVEL_MAX           (9U)
+
+/*! @brief  Heatmaps between key frames, so a host that joins late catches up */
+#define MMWDEMO_HEATMAP_KEY_FRAME_INTERVAL  (32U)
+
+/*
+ * Codes of the residual stream:
+ *   0xxxxxxx                 residual -64..63
+ *   10nnnnnn                 1..64 zero residuals
+ *   110xxxxx xxxxxxxx        residual -4096..4095, high bits first
+ *   1110nnnn nnnnnnnn        65..4160 zero residuals, high bits first
+ *   11111111 llllllll hhhhhhhh  any residual, low byte first
+ */
+#define MMWDEMO_HEATMAP_CODE_RUN            (0x80U)
+#define MMWDEMO_HEATMAP_CODE_RES13          (0xC0U)
+#define MMWDEMO_HEATMAP_CODE_LONG_RUN       (0xE0U)
+#define MMWDEMO_HEATMAP_CODE_RES16          (0xFFU)
+#define MMWDEMO_HEATMAP_SHORT_RUN_MAX       (64U)
+#define MMWDEMO_HEATMAP_LONG_RUN_MAX        (MMWDEMO_HEATMAP_SHORT_RUN_MAX + 4096U)
+
+/*!
+ * @brief
+ *  Start of the payload of @ref MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED,
+ *  the residual stream follows.
+ */
+typedef struct MmwDemo_heatMapCompressedHdr_t
+{
+    /*! @brief   Range bins */
+    uint16_t    numRangeBins;
+
+    /*! @brief   Doppler bins */
+    uint16_t    numDopplerBins;
+
+    /*! @brief   Counts the compressed heatmaps sent, a heatmap that is not a
+     *           key frame only decodes on top of the one with seq - 1 */
+    uint16_t    seq;
+
+    /*! @brief   1 when the bins are predicted within the heatmap */
+    uint8_t     keyFrame;
+
+    /*! @brief   rangeDopplerHeatMap it was sent with */
+    uint8_t     level;
+} MmwDemo_heatMapCompressedHdr;
+
+/**
+ *  @b Description
+ *  @n
+ *      Returns the largest error of a level, residuals up to it are sent as zero.
+ *
+ *  @param[in]  level       rangeDopplerHeatMap of guiMonitor
+ *
+ *  @retval   Dead band in LSBs of the detection matrix
+ */
+static inline uint32_t MmwDemo_heatMapDeadBand(uint32_t level)
+{
+    if (level <= MMWDEMO_HEATMAP_LEVEL_LOSSLESS)
+    {
+        return 0U;
+    }
+    if (level > MMWDEMO_HEATMAP_LEVEL_MAX)
+    {
+        level = MMWDEMO_HEATMAP_LEVEL_MAX;
+    }
+    return (1U << (level - MMWDEMO_HEATMAP_LEVEL_LOSSLESS)) - 1U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Writes the codes of a run of zero residuals.
+ *
+ *  @param[in]  run         Zero residuals, at least 1
+ *  @param[out] out         Where the codes go
+ *  @param[in]  outSize     Bytes left in out
+ *
+ *  @retval   Bytes written, 0 when out is full
+ */
+static inline uint32_t MmwDemo_heatMapPutRun(uint32_t run, uint8_t *out, uint32_t outSize)
+{
+    uint32_t len = 0U;
+    uint32_t n;
+
+    while (run > 0U)
+    {
+        if (run <= MMWDEMO_HEATMAP_SHORT_RUN_MAX)
+        {
+            if ((len + 1U) > outSize)
+            {
+                return 0U;
+            }
+            out[len++] = (uint8_t)(MMWDEMO_HEATMAP_CODE_RUN | (run - 1U));
+            run = 0U;
+        }
+        else
+        {
+            n = (run < MMWDEMO_HEATMAP_LONG_RUN_MAX) ? run : MMWDEMO_HEATMAP_LONG_RUN_MAX;
+            if ((len + 2U) > outSize)
+            {
+                return 0U;
+            }
+            out[len++] = (uint8_t)(MMWDEMO_HEATMAP_CODE_LONG_RUN | ((n - 65U) >> 8));
+            out[len++] = (uint8_t)(n - 65U);
+            run -= n;
+        }
+    }
+    return len;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Compresses a detection matrix.
+ *
+ *  @param[in]     in          Detection matrix
+ *  @param[in,out] ref         Heatmap the decoder has, ignored for a key frame,
+ *                             what it will have after this one on return
+ *  @param[in]     numBins     Bins of the detection matrix
+ *  @param[in]     keyFrame    1 to predict within the heatmap
+ *  @param[in]     deadBand    @ref MmwDemo_heatMapDeadBand
+ *  @param[out]    out         Residual stream
+ *  @param[in]     outSize     Bytes of out
+ *
+ *  @retval   Bytes of the residual stream, 0 when it does not fit in out. ref
+ *            is then half updated and the next heatmap has to be a key frame.
+ */
+static inline uint32_t MmwDemo_heatMapEncode(const uint16_t *in, uint16_t *ref, uint32_t numBins,
+                                             uint32_t keyFrame, uint32_t deadBand,
+                                             uint8_t *out, uint32_t outSize)
+{
+    uint32_t len = 0U;
+    uint32_t run = 0U;
+    uint32_t bin, n;
+    uint16_t pred = 0U;
+    int32_t res;
+
+    for (bin = 0U; bin < numBins; bin++)
+    {
+        if (keyFrame == 0U)
+        {
+            pred = ref[bin];
+        }
+        res = (int32_t)(int16_t)(uint16_t)(in[bin] - pred);
+
+        if ((uint32_t)((res < 0) ? -res : res) <= deadBand)
+        {
+            run++;
+            ref[bin] = pred;
+            continue;
+        }
+
+        if (run > 0U)
+        {
+            n = MmwDemo_heatMapPutRun(run, &out[len], outSize - len);
+            if (n == 0U)
+            {
+                return 0U;
+            }
+            len += n;
+            run = 0U;
+        }
+        if ((res >= -64) && (res <= 63))
+        {
+            if ((len + 1U) > outSize)
+            {
+                return 0U;
+            }
+            out[len++] = (uint8_t)res & 0x7FU;
+        }
+        else if ((res >= -4096) && (res <= 4095))
+        {
+            if ((len + 2U) > outSize)
+            {
+                return 0U;
+            }
+            out[len++] = (uint8_t)(MMWDEMO_HEATMAP_CODE_RES13 | (((uint32_t)res >> 8) & 0x1FU));
+            out[len++] = (uint8_t)res;
+        }
+        else
+        {
+            if ((len + 3U) > outSize)
+            {
+                return 0U;
+            }
+            out[len++] = MMWDEMO_HEATMAP_CODE_RES16;
+            out[len++] = (uint8_t)res;
+            out[len++] = (uint8_t)((uint32_t)res >> 8);
+        }
+        ref[bin] = in[bin];
+        pred = in[bin];
+    }
+
+    if (run > 0U)
+    {
+        n = MmwDemo_heatMapPutRun(run, &out[len], outSize - len);
+        if (n == 0U)
+        {
+            return 0U;
+        }
+        len += n;
+    }
+    return len;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Decompresses a detection matrix.
+ *
+ *  @param[in]     in          Residual stream
+ *  @param[in]     inLen       Bytes of the residual stream
+ *  @param[in,out] ref         Heatmap before, ignored for a key frame, the
+ *                             decoded heatmap on return
+ *  @param[in]     numBins     Bins of the detection matrix
+ *  @param[in]     keyFrame    1 when the bins are predicted within the heatmap
+ *
+ *  @retval   0 on success, -1 when the stream is broken or does not give numBins bins
+ */
+static inline int32_t MmwDemo_heatMapDecode(const uint8_t *in, uint32_t inLen, uint16_t *ref,
+                                            uint32_t numBins, uint32_t keyFrame)
+{
+    uint32_t pos = 0U;
+    uint32_t bin = 0U;
+    uint32_t run;
+    uint16_t pred = 0U;
+    uint16_t res;
+    uint8_t code;
+
+    while (pos < inLen)
+    {
+        code = in[pos++];
+        run = 0U;
+        res = 0U;
+
+        if ((code & 0x80U) == 0U)
+        {
+            /* Sign extend the 7 bits */
+            res = (uint16_t)(((code & 0x40U) != 0U) ? (code | 0xFF80U) : code);
+        }
+        else if ((code & 0xC0U) == MMWDEMO_HEATMAP_CODE_RUN)
+        {
+            run = (uint32_t)(code & 0x3FU) + 1U;
+        }
+        else if ((code & 0xE0U) == MMWDEMO_HEATMAP_CODE_RES13)
+        {
+            if (pos >= inLen)
+            {
+                return -1;
+            }
+            res = (uint16_t)(((uint32_t)(code & 0x1FU) << 8) | in[pos++]);
+            if ((res & 0x1000U) != 0U)
+            {
+                res |= 0xE000U;
+            }
+        }
+        else if ((code & 0xF0U) == MMWDEMO_HEATMAP_CODE_LONG_RUN)
+        {
+            if (pos >= inLen)
+            {
+                return -1;
+            }
+            run = (((uint32_t)(code & 0x0FU) << 8) | in[pos++]) + 65U;
+        }
+        else if (code == MMWDEMO_HEATMAP_CODE_RES16)
+        {
+            if ((pos + 2U) > inLen)
+            {
+                return -1;
+            }
+            res = (uint16_t)(in[pos] | ((uint32_t)in[pos + 1U] << 8));
+            pos += 2U;
+        }
+        else
+        {
+            return -1;
+        }
+
+        if (run > 0U)
+        {
+            if ((bin + run) > numBins)
+            {
+                return -1;
+            }
+            /* Bins of a heatmap that is not a key frame stay as they were */
+            for (; run > 0U; run--, bin++)
+            {
+                if (keyFrame != 0U)
+                {
+                    ref[bin] = pred;
+                }
+            }
+        }
+        else
+        {
+            if (bin >= numBins)
+            {
+                return -1;
+            }
+            if (keyFrame == 0U)
+            {
+                pred = ref[bin];
+            }
+            ref[bin] = (uint16_t)(pred + res);
+            pred = ref[bin];
+            bin++;
+        }
+    }
+    return (bin == numBins) ? 0 : -1;
+}
+
+#endif /* MMW_HEATMAP_CODEC_H */
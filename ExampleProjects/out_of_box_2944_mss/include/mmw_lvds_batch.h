@@ -0,0 +1,310 @@
+/*
+ *   @file  mmw_lvds_batch.h
+ *
+ *   @brief
+ *      Software data of the LVDS stream, batched.
+ *
+ *      With one frame to a batch, the default, the MSS streams every frame
+ *      as the SDK demo does and the layout here is not used. With more, set
+ *      with lvdsBatchCfg, the CBUFF software session streams one user buffer
+ *      of a size fixed when the sensor starts, so it is created once and
+ *      never touched between frames. Every frame the MSS copies its point cloud and side
+ *      info into that buffer, one frame after the other behind a batch
+ *      header, and the session is activated once framesPerBatch frames are
+ *      in. The buffer is sized for framesPerBatch frames of maxObj points,
+ *      both set with lvdsBatchCfg; the batch header says how much of it is
+ *      used and the rest is left as it was. The session streams the whole
+ *      buffer every batch, MmwDemo_lvdsBatchSize() bytes, however few
+ *      points the frames had.
+ *
+ *      Nothing here needs the SDK, the MSS writes with it and
+ *      HostTools/lvds_batch_test.c reads with it.
+ */
+
+#ifndef MMW_LVDS_BATCH_H
+#define MMW_LVDS_BATCH_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*! @brief  "MMWL" in the first word of every batch */
+#define MMWDEMO_LVDS_BATCH_MAGIC        (0x4C574D4DU)
+
+/*! @brief  Most frames in a batch */
+#define MMWDEMO_LVDS_BATCH_MAX_FRAMES   (4U)
+
+/*! @brief  Bytes of a point, as DPIF_PointCloudCartesian */
+#define MMWDEMO_LVDS_BATCH_POINT_SIZE   (16U)
+
+/*! @brief  Bytes of the side info of a point, as DPIF_PointCloudSideInfo */
+#define MMWDEMO_LVDS_BATCH_SIDE_SIZE    (4U)
+
+/*!
+ * @brief
+ *  Start of the user buffer, the frames follow.
+ */
+typedef struct MmwDemo_lvdsBatchHdr_t
+{
+    /*! @brief   @ref MMWDEMO_LVDS_BATCH_MAGIC */
+    uint32_t    magic;
+
+    /*! @brief   Counts the batches streamed, from 0 */
+    uint32_t    seq;
+
+    /*! @brief   Frames in the batch */
+    uint32_t    numFrames;
+
+    /*! @brief   Bytes of the frames after this header */
+    uint32_t    length;
+} MmwDemo_lvdsBatchHdr;
+
+/*!
+ * @brief
+ *  Start of every frame, numObj points and then their side info follow.
+ */
+typedef struct MmwDemo_lvdsFrameHdr_t
+{
+    /*! @brief   Frame number, as in the output packet header */
+    uint32_t    frameNum;
+
+    /*! @brief   Sub-frame of the frame */
+    uint16_t    subFrameNum;
+
+    /*! @brief   Points of the frame */
+    uint16_t    numObj;
+} MmwDemo_lvdsFrameHdr;
+
+/*!
+ * @brief
+ *  Writer of the user buffer.
+ */
+typedef struct MmwDemo_lvdsBatch_t
+{
+    /*! @brief   User buffer */
+    uint8_t     *buf;
+
+    /*! @brief   Bytes of the user buffer */
+    uint32_t    size;
+
+    /*! @brief   Most points a frame can have, more are cut off */
+    uint32_t    maxObj;
+
+    /*! @brief   Frames to a batch */
+    uint32_t    framesPerBatch;
+
+    /*! @brief   Points cut off because a frame had more than maxObj */
+    uint32_t    numCut;
+} MmwDemo_lvdsBatch;
+
+/**
+ *  @b Description
+ *  @n
+ *      Bytes of a frame with numObj points.
+ *
+ *  @retval   Bytes, always a multiple of 4
+ */
+static inline uint32_t MmwDemo_lvdsBatchFrameSize(uint32_t numObj)
+{
+    return sizeof(MmwDemo_lvdsFrameHdr) +
+           (numObj * (MMWDEMO_LVDS_BATCH_POINT_SIZE + MMWDEMO_LVDS_BATCH_SIDE_SIZE));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Bytes of the user buffer for a batch of framesPerBatch frames with
+ *      up to maxObj points each.
+ *
+ *  @retval   Bytes, always a multiple of 4
+ */
+static inline uint32_t MmwDemo_lvdsBatchSize(uint32_t framesPerBatch, uint32_t maxObj)
+{
+    return sizeof(MmwDemo_lvdsBatchHdr) + (framesPerBatch * MmwDemo_lvdsBatchFrameSize(maxObj));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts a writer on a user buffer, with an empty first batch.
+ *
+ *  @param[out] batch           Writer
+ *  @param[in]  buf             User buffer, 4 byte aligned and at least
+ *                              MmwDemo_lvdsBatchSize(framesPerBatch, maxObj) bytes
+ *  @param[in]  framesPerBatch  Frames to a batch, 1 to @ref MMWDEMO_LVDS_BATCH_MAX_FRAMES
+ *  @param[in]  maxObj          Most points a frame can have
+ */
+static inline void MmwDemo_lvdsBatchInit(MmwDemo_lvdsBatch *batch, uint8_t *buf,
+                                         uint32_t framesPerBatch, uint32_t maxObj)
+{
+    MmwDemo_lvdsBatchHdr *hdr = (MmwDemo_lvdsBatchHdr *)buf;
+
+    memset(batch, 0, sizeof(*batch));
+    batch->buf            = buf;
+    batch->framesPerBatch = framesPerBatch;
+    batch->maxObj         = maxObj;
+    batch->size           = MmwDemo_lvdsBatchSize(framesPerBatch, maxObj);
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = MMWDEMO_LVDS_BATCH_MAGIC;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Adds one frame to the batch being filled. The writer only calls
+ *      it while no transfer of the buffer is going on.
+ *
+ *  @param[in]  batch       Writer
+ *  @param[in]  frameNum    Frame number
+ *  @param[in]  subFrameNum Sub-frame
+ *  @param[in]  numObj      Points, more than maxObj are cut off
+ *  @param[in]  points      numObj points
+ *  @param[in]  sideInfo    numObj side infos
+ *
+ *  @retval   1 when the batch is full and is to be streamed, 0 otherwise
+ */
+static inline int32_t MmwDemo_lvdsBatchAdd(MmwDemo_lvdsBatch *batch, uint32_t frameNum, uint16_t subFrameNum,
+                                           uint32_t numObj, const void *points, const void *sideInfo)
+{
+    MmwDemo_lvdsBatchHdr *hdr = (MmwDemo_lvdsBatchHdr *)batch->buf;
+    MmwDemo_lvdsFrameHdr frame;
+    uint8_t *dst = batch->buf + sizeof(MmwDemo_lvdsBatchHdr) + hdr->length;
+
+    if (numObj > batch->maxObj)
+    {
+        batch->numCut += numObj - batch->maxObj;
+        numObj = batch->maxObj;
+    }
+    frame.frameNum    = frameNum;
+    frame.subFrameNum = subFrameNum;
+    frame.numObj      = (uint16_t)numObj;
+
+    memcpy(dst, &frame, sizeof(frame));
+    dst += sizeof(frame);
+    if (numObj != 0U)
+    {
+        memcpy(dst, points, numObj * MMWDEMO_LVDS_BATCH_POINT_SIZE);
+        dst += numObj * MMWDEMO_LVDS_BATCH_POINT_SIZE;
+        memcpy(dst, sideInfo, numObj * MMWDEMO_LVDS_BATCH_SIDE_SIZE);
+    }
+    hdr->length += MmwDemo_lvdsBatchFrameSize(numObj);
+    hdr->numFrames++;
+
+    return (hdr->numFrames >= batch->framesPerBatch) ? 1 : 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts the next batch once the last one has been streamed.
+ *
+ *  @param[in]  batch       Writer
+ */
+static inline void MmwDemo_lvdsBatchNext(MmwDemo_lvdsBatch *batch)
+{
+    MmwDemo_lvdsBatchHdr *hdr = (MmwDemo_lvdsBatchHdr *)batch->buf;
+
+    hdr->seq++;
+    hdr->numFrames = 0U;
+    hdr->length    = 0U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Frames in the batch being filled.
+ *
+ *  @param[in]  batch       Writer
+ *
+ *  @retval   Frames
+ */
+static inline uint32_t MmwDemo_lvdsBatchNumFrames(const MmwDemo_lvdsBatch *batch)
+{
+    return ((const MmwDemo_lvdsBatchHdr *)batch->buf)->numFrames;
+}
+
+/*!
+ * @brief
+ *  Called by @ref MmwDemo_lvdsBatchRead for every frame of a batch, points
+ *  and sideInfo point into the buffer read and may be unaligned.
+ */
+typedef void (*MmwDemo_lvdsBatchFrameFxn)(void *arg, const MmwDemo_lvdsFrameHdr *frame,
+                                          const uint8_t *points, const uint8_t *sideInfo);
+
+/**
+ *  @b Description
+ *  @n
+ *      Reads one user buffer as streamed, the HSI header taken off, and
+ *      hands over its frames. The frames are only handed over when the
+ *      whole batch checks out.
+ *
+ *  @param[in]  buf         User buffer
+ *  @param[in]  len         Bytes of it
+ *  @param[out] seq         seq of the batch
+ *  @param[in]  fxn         Called for every frame
+ *  @param[in]  arg         Passed to fxn
+ *
+ *  @retval   Frames in the batch, -1 when it is not a batch or is cut short
+ */
+static inline int32_t MmwDemo_lvdsBatchRead(const uint8_t *buf, uint32_t len, uint32_t *seq,
+                                            MmwDemo_lvdsBatchFrameFxn fxn, void *arg)
+{
+    MmwDemo_lvdsBatchHdr hdr;
+    MmwDemo_lvdsFrameHdr frame;
+    uint32_t pos, end, i;
+    int32_t pass;
+
+    if (len < sizeof(hdr))
+    {
+        return -1;
+    }
+    memcpy(&hdr, buf, sizeof(hdr));
+    if ((hdr.magic != MMWDEMO_LVDS_BATCH_MAGIC) || (hdr.numFrames > MMWDEMO_LVDS_BATCH_MAX_FRAMES) ||
+        (hdr.length > (len - sizeof(hdr))))
+    {
+        return -1;
+    }
+    end = sizeof(hdr) + hdr.length;
+
+    /* Walk the frames once to check them, then once to hand them over */
+    for (pass = 0; pass < 2; pass++)
+    {
+        pos = sizeof(hdr);
+        for (i = 0U; i < hdr.numFrames; i++)
+        {
+            if ((end - pos) < sizeof(frame))
+            {
+                return -1;
+            }
+            memcpy(&frame, buf + pos, sizeof(frame));
+            if ((end - pos) < MmwDemo_lvdsBatchFrameSize(frame.numObj))
+            {
+                return -1;
+            }
+            if (pass == 1)
+            {
+                fxn(arg, &frame, buf + pos + sizeof(frame),
+                    buf + pos + sizeof(frame) + (frame.numObj * MMWDEMO_LVDS_BATCH_POINT_SIZE));
+            }
+            pos += MmwDemo_lvdsBatchFrameSize(frame.numObj);
+        }
+        if (pos != end)
+        {
+            return -1;
+        }
+    }
+    *seq = hdr.seq;
+    return (int32_t)hdr.numFrames;
+}
+
+/* Software session of the LVDS stream, in mmw_lvds_stream.c */
+extern void MmwDemo_LVDSStreamSwBatchConfig(uint32_t framesPerBatch, uint32_t maxObj);
+extern uint32_t MmwDemo_LVDSStreamSwMaxObj(void);
+extern void MmwDemo_LVDSStreamStart(void);
+extern void MmwDemo_LVDSStreamSwWait(void);
+extern void MmwDemo_LVDSStreamSwStop(void);
+extern void MmwDemo_transferLVDSUserData(uint8_t subFrameIndx, uint32_t frameNum, uint32_t numObjOut,
+                                         const void *objOut, const void *objOutSideInfo);
+extern void MmwDemo_LVDSStreamGetSwStats(uint32_t *numBatches, uint32_t *numCut);
+
+#endif /* MMW_LVDS_BATCH_H */
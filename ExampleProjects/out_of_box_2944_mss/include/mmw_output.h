@@ -43,6 +43,7 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
 #include <ti/common/syscommon.h>
 #ifdef MMWDEMO_TDM
 #include <ti/datapath/dpc/objectdetection/objdethwa/objectdetection.h>
@@ -91,6 +92,15 @@ typedef enum MmwDemo_output_message_type_e
     /*! @brief   temperature stats from Radar front end */
     MMWDEMO_OUTPUT_MSG_TEMPERATURE_STATS,
 
+    /*! @brief   Per stage DSP processing time, sent with the stats */
+    MMWDEMO_OUTPUT_MSG_STAGE_TIMING,
+
+    /*! @brief   Detected points with side info, quantized */
+    MMWDEMO_OUTPUT_MSG_COMPRESSED_POINTS,
+
+    /*! @brief   Range/Doppler detection matrix, compressed as in mmw_heatmap_codec.h */
+    MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED,
+
     MMWDEMO_OUTPUT_MSG_MAX
 } MmwDemo_output_message_type;
 
@@ -162,27 +172,365 @@ typedef struct MmwDemo_output_message_stats_t
     volatile uint32_t     interFrameCPULoad;
 } MmwDemo_output_message_stats;
 
-/**
+/*!
+ * @brief
+ *  DSP processing stages reported in @ref MMWDEMO_OUTPUT_MSG_STAGE_TIMING,
+ *  in the order they run.
+ */
+typedef enum MmwDemo_output_stage_e
+{
+    /*! @brief   Frame start to range FFT done, includes chirping */
+    MMWDEMO_OUTPUT_STAGE_RANGE = 0,
+
+    /*! @brief   Doppler DPU */
+    MMWDEMO_OUTPUT_STAGE_DOPPLER,
+
+    /*! @brief   Range CFAR DPU */
+    MMWDEMO_OUTPUT_STAGE_RANGE_CFAR,
+
+    /*! @brief   Intersection of the Doppler and range CFAR detections */
+    MMWDEMO_OUTPUT_STAGE_INTERSECT,
+
+    /*! @brief   Angle of arrival estimation */
+    MMWDEMO_OUTPUT_STAGE_AOA,
+
+    /*! @brief   Copy of the results to HSRAM */
+    MMWDEMO_OUTPUT_STAGE_HSRAM_COPY,
+
+    MMWDEMO_OUTPUT_STAGE_MAX
+} MmwDemo_output_stage;
+
+/*!
+ * @brief
+ *  Time one stage took over a window of frames, in DSP cycles.
+ */
+typedef struct MmwDemo_output_stageTiming_t
+{
+    /*! @brief   Shortest */
+    uint32_t     minCycles;
+
+    /*! @brief   Mean */
+    uint32_t     meanCycles;
+
+    /*! @brief   99th percentile, at most 12.5% above the real value */
+    uint32_t     p99Cycles;
+
+    /*! @brief   Longest */
+    uint32_t     maxCycles;
+} MmwDemo_output_stageTiming;
+
+/*!
+ * @brief
+ *  Payload of @ref MMWDEMO_OUTPUT_MSG_STAGE_TIMING.
+ *
+ * @details
+ *  The DSP collects the time every stage takes and publishes a summary
+ *  once per window of frames, the same summary goes out with every frame
+ *  until the next window is done. All sub-frames share the window.
+ */
+typedef struct MmwDemo_output_message_stageTiming_t
+{
+    /*! @brief   Number of windows published, 0 until the first one is done */
+    uint32_t     windowIndex;
+
+    /*! @brief   Frames in the window */
+    uint32_t     numFrames;
+
+    /*! @brief   DSP clock in MHz, cycles / dspClockMHz is usec */
+    uint32_t     dspClockMHz;
+
+    /*! @brief   1 when the AoA ran pipelined with the next range FFT */
+    uint32_t     pipelinedAoa;
+
+    /*! @brief   One entry per @ref MmwDemo_output_stage */
+    MmwDemo_output_stageTiming stage[MMWDEMO_OUTPUT_STAGE_MAX];
+
+    /*! @brief   Frames since start whose point cloud was cut to what a result slot holds */
+    uint32_t     numClamped;
+
+    /*! @brief   Frames since start dropped because the MSS still held their result slot */
+    uint32_t     numSlotBusy;
+} MmwDemo_output_message_stageTiming;
+
+/*!
  * @brief
- *  Size of HSRAM Payload data array.
+ *  Units of @ref MMWDEMO_OUTPUT_MSG_COMPRESSED_POINTS, chosen per frame so
+ *  the largest magnitude of the frame uses the whole range of its field.
+ *  All fields are signed and symmetric around 0, value = field * unit.
  */
-#define MMWDEMO_HSRAM_PAYLOAD_SIZE        (SYS_COMMON_HSRAM_SIZE - sizeof(DPC_ObjectDetection_ExecuteResult) - \
-                                           sizeof(MmwDemo_output_message_stats)) 
+typedef struct MmwDemo_output_message_compressedPointUnit_t
+{
+    /*! @brief   Meters per LSB of x, y and z */
+    float        xyzUnit;
+
+    /*! @brief   m/s per LSB of velocity */
+    float        velocityUnit;
+
+    /*! @brief   dB per LSB of snr */
+    float        snrUnit;
+
+    /*! @brief   dB per LSB of noise */
+    float        noiseUnit;
+} MmwDemo_output_message_compressedPointUnit;
+
+/*!
+ * @brief
+ *  One point of @ref MMWDEMO_OUTPUT_MSG_COMPRESSED_POINTS, 10 bytes where
+ *  @ref DPIF_PointCloudCartesian and @ref DPIF_PointCloudSideInfo take 20.
+ */
+typedef struct MmwDemo_output_message_compressedPoint_t
+{
+    /*! @brief   x in xyzUnit */
+    int16_t      x;
+
+    /*! @brief   y in xyzUnit */
+    int16_t      y;
+
+    /*! @brief   z in xyzUnit */
+    int16_t      z;
+
+    /*! @brief   Radial velocity in velocityUnit */
+    int16_t      velocity;
+
+    /*! @brief   SNR in snrUnit, -127 to 127 */
+    int8_t       snr;
+
+    /*! @brief   Noise in noiseUnit, -127 to 127 */
+    int8_t       noise;
+} MmwDemo_output_message_compressedPoint;
+
+/** @brief Sub-frames with a DSP memory map */
+#define MMWDEMO_MEMMAP_MAX_SUBFRAMES      (4U)
+
+/** @brief Buffers per DSP memory map */
+#define MMWDEMO_MEMMAP_MAX_ENTRIES        (32U)
+
+/** @brief Characters of a buffer name, including the terminating 0 */
+#define MMWDEMO_MEMMAP_NAME_LEN           (12U)
+
+/** @brief Offset of a buffer that did not fit in its pool */
+#define MMWDEMO_MEMMAP_NO_FIT             (0xFFFFFFFFU)
+
+/*!
+ * @brief
+ *  Pools the object detection DPC allocates from.
+ */
+typedef enum MmwDemo_memMapPool_e
+{
+    /*! @brief   L3 RAM (gMmwL3) */
+    MMWDEMO_MEMMAP_POOL_L3 = 0,
+
+    /*! @brief   DSP L2 heap (gDPC_ObjDetL2Heap) */
+    MMWDEMO_MEMMAP_POOL_L2,
+
+    /*! @brief   DSP L2 FFT window buffer */
+    MMWDEMO_MEMMAP_POOL_WINBUF,
+
+    /*! @brief   Range DPU DC and interference estimates of all sub-frames */
+    MMWDEMO_MEMMAP_POOL_PREPROC,
+
+    /*! @brief   HWA window RAM, sizes in coefficients */
+    MMWDEMO_MEMMAP_POOL_HWA_WINRAM,
+
+    /*! @brief   HWA param sets, sizes in param sets */
+    MMWDEMO_MEMMAP_POOL_HWA_PARAMSET,
+
+    MMWDEMO_MEMMAP_POOL_MAX
+} MmwDemo_memMapPool;
+
+/*!
+ * @brief
+ *  What a buffer is for.
+ */
+typedef enum MmwDemo_memMapOwner_e
+{
+    /*! @brief   The DPC, shared by the DPUs */
+    MMWDEMO_MEMMAP_OWNER_DPC = 0,
+
+    /*! @brief   Range DPU */
+    MMWDEMO_MEMMAP_OWNER_RANGE,
+
+    /*! @brief   Doppler DPU */
+    MMWDEMO_MEMMAP_OWNER_DOPPLER,
+
+    /*! @brief   Range CFAR DPU */
+    MMWDEMO_MEMMAP_OWNER_RANGE_CFAR,
+
+    /*! @brief   Angle of arrival estimation */
+    MMWDEMO_MEMMAP_OWNER_AOA,
+
+    MMWDEMO_MEMMAP_OWNER_MAX
+} MmwDemo_memMapOwner;
+
+/*!
+ * @brief
+ *  One buffer in a DSP memory map.
+ */
+typedef struct MmwDemo_memMapEntry_t
+{
+    /*! @brief   Buffer name */
+    char         name[MMWDEMO_MEMMAP_NAME_LEN];
+
+    /*! @brief   Offset from the pool start, @ref MMWDEMO_MEMMAP_NO_FIT if it did not fit */
+    uint32_t     offset;
+
+    /*! @brief   Requested size */
+    uint32_t     size;
+
+    /*! @brief   Bytes skipped in front of it for the alignment */
+    uint16_t     alignWaste;
+
+    /*! @brief   @ref MmwDemo_memMapPool */
+    uint8_t      pool;
+
+    /*! @brief   @ref MmwDemo_memMapOwner */
+    uint8_t      owner;
+} MmwDemo_memMapEntry;
+
+/*!
+ * @brief
+ *  Size of a pool and how much of it a sub-frame uses.
+ */
+typedef struct MmwDemo_memMapPoolUsage_t
+{
+    /*! @brief   Pool size */
+    uint32_t     size;
+
+    /*! @brief   End of the last byte used by the sub-frame's buffers */
+    uint32_t     highWater;
+
+    /*! @brief   Bytes lost to alignment */
+    uint32_t     alignWaste;
+} MmwDemo_memMapPoolUsage;
+
+/*!
+ * @brief
+ *  Memory map of one sub-frame as configured on the DSP.
+ *
+ * @details
+ *  The DSP writes the maps of all sub-frames when their pre-start
+ *  configuration is done, the memMap CLI command prints them. L3 and L2
+ *  scratch is reused from DPU to DPU within a sub-frame, so buffers of
+ *  different DPUs can overlap.
+ */
+typedef struct MmwDemo_memMap_t
+{
+    /*! @brief   Valid entries in entry[] */
+    uint32_t     numEntries;
+
+    /*! @brief   Buffers that did not fit in entry[] */
+    uint32_t     numDropped;
+
+    /*! @brief   Allocations that failed */
+    uint32_t     numNoFit;
+
+    /*! @brief   1 once the sub-frame was configured */
+    uint32_t     valid;
+
+    /*! @brief   One per @ref MmwDemo_memMapPool */
+    MmwDemo_memMapPoolUsage pool[MMWDEMO_MEMMAP_POOL_MAX];
+
+    /*! @brief   Buffers in the order they were handed out */
+    MmwDemo_memMapEntry entry[MMWDEMO_MEMMAP_MAX_ENTRIES];
+} MmwDemo_memMap;
 
 /**
+ * @brief Result slots in HSRAM, the DSS fills one while the MSS sends the other.
+ *
+ * Each slot gets half of what is left of HSRAM, so the largest point cloud
+ * is about half of what the single result area held. Points past what a
+ * slot holds are cut and counted in
+ * @ref MmwDemo_output_message_stageTiming_t::numClamped.
+ */
+#define MMWDEMO_HSRAM_NUM_SLOTS           (2U)
+
+/** @brief Cache line size the HSRAM layout keeps the two cores apart by (C66x L2) */
+#define MMWDEMO_HSRAM_LINE_SIZE           (128U)
+
+/*!
  * @brief
- *  DSS stores demo output and stats in HSRAM.
+ *  HSRAM words only the MSS writes, on a cache line of their own.
  */
-typedef struct MmwDemo_HSRAM_t
+typedef struct MmwDemo_HSRAM_owner_t
+{
+    /*! @brief   Sequence number of the last result slot the MSS is done with */
+    volatile uint32_t              releasedSeq;
+
+    /*! @brief   Rest of the cache line */
+    uint8_t                        pad[MMWDEMO_HSRAM_LINE_SIZE - sizeof(uint32_t)];
+} MmwDemo_HSRAM_owner;
+
+/*!
+ * @brief
+ *  Fixed part of a result slot. The DPM result buffers point here.
+ */
+typedef struct MmwDemo_resultSlotHeader_t
 {
+    /*! @brief   Sequence number of the frame in the slot, 0 before the first */
+    uint32_t                       seq;
+
     /*! @brief   DPC execution result */
     DPC_ObjectDetection_ExecuteResult result;
 
     /*! @brief   Output message stats reported by DSS */
     MmwDemo_output_message_stats   outStats;
 
+    /*! @brief   Per stage timing reported by DSS */
+    MmwDemo_output_message_stageTiming stageTiming;
+} MmwDemo_resultSlotHeader;
+
+/**
+ * @brief
+ *  Size of a result slot, whole cache lines.
+ */
+#define MMWDEMO_HSRAM_SLOT_SIZE           (((SYS_COMMON_HSRAM_SIZE - sizeof(MmwDemo_HSRAM_owner) - \
+                                             (MMWDEMO_MEMMAP_MAX_SUBFRAMES * sizeof(MmwDemo_memMap))) / \
+                                            MMWDEMO_HSRAM_NUM_SLOTS) & ~(MMWDEMO_HSRAM_LINE_SIZE - 1U))
+
+/**
+ * @brief
+ *  Size of the payload data array of a result slot.
+ */
+#define MMWDEMO_HSRAM_PAYLOAD_SIZE        (MMWDEMO_HSRAM_SLOT_SIZE - sizeof(MmwDemo_resultSlotHeader))
+
+/*!
+ * @brief
+ *  Results of one frame in HSRAM.
+ *
+ * @details
+ *  The DPC writes the point cloud of frame seq straight into the payload of
+ *  slot seq % @ref MMWDEMO_HSRAM_NUM_SLOTS, the DSS fills in the header and
+ *  writes back what it touched. The DSS only takes a slot once
+ *  @ref MmwDemo_HSRAM_owner_t::releasedSeq shows the MSS is done with the
+ *  frame that was in it before.
+ */
+typedef struct MmwDemo_resultSlot_t
+{
+    /*! @brief   Result, stats and stage timing */
+    MmwDemo_resultSlotHeader       hdr;
+
     /*! @brief   Payload data of result */
     uint8_t                        payload[MMWDEMO_HSRAM_PAYLOAD_SIZE];
+} MmwDemo_resultSlot;
+
+/** @brief Slot holding a result the DPM handed over */
+#define MMWDEMO_HSRAM_SLOT_OF_RESULT(res) \
+    ((MmwDemo_resultSlot *)((uint8_t *)(res) - offsetof(MmwDemo_resultSlotHeader, result)))
+
+/**
+ * @brief
+ *  DSS stores demo output and stats in HSRAM.
+ */
+typedef struct MmwDemo_HSRAM_t
+{
+    /*! @brief   Written by the MSS only */
+    MmwDemo_HSRAM_owner            owner;
+
+    /*! @brief   Result slots, written by the DSS only */
+    MmwDemo_resultSlot             slot[MMWDEMO_HSRAM_NUM_SLOTS];
+
+    /*! @brief   DSP memory map of every sub-frame, written at configuration */
+    MmwDemo_memMap                 memMap[MMWDEMO_MEMMAP_MAX_SUBFRAMES];
 } MmwDemo_HSRAM;
 
 /**
@@ -0,0 +1,85 @@
+/*
+ *   @file  mmw_output_sink.h
+ *
+ *   @brief
+ *      Where the output packet of every frame goes.
+ *
+ *      MmwDemo_transmitProcessedOutput builds the packet as a list of
+ *      segments and hands it to the sink that is selected. The segments
+ *      point into the DSS result slot and the packet staging, so the sink
+ *      calls back once it is done with them and only then are they reused.
+ *      The UART sink hands the segments to its own task, which writes them
+ *      to the logging UART and calls back when the last byte is out. The
+ *      UDP sink, built with
+ *      ENET_STREAM, copies them into MTU sized datagrams as in
+ *      mmw_udp_batch.h and its own task sends those to the host set with
+ *      enetStreamCfg. outputSinkCfg selects the sink.
+ */
+
+#ifndef MMW_OUTPUT_SINK_H
+#define MMW_OUTPUT_SINK_H
+
+#include <stdint.h>
+
+/*! @brief  outputSinkCfg sink of the logging UART */
+#define MMWDEMO_OUTPUT_SINK_UART        (0U)
+
+/*! @brief  outputSinkCfg sink of UDP over Ethernet */
+#define MMWDEMO_OUTPUT_SINK_UDP         (1U)
+
+/*!
+ * @brief
+ *  Called by a sink once it is done with the segments of a packet.
+ */
+typedef void (*MmwDemo_outputSinkDoneFxn)(void *arg);
+
+/*!
+ * @brief
+ *  Output sink.
+ */
+typedef struct MmwDemo_outputSink_t
+{
+    /*! @brief   Name for the CLI */
+    const char  *name;
+
+    /**
+     * @brief  Sends one packet. The segments, and the segBuf and segLen
+     *         arrays, must stay as they are until the sink calls done,
+     *         which it does exactly once, sent or dropped, either before
+     *         send returns or later from its own task.
+     *
+     * @param[in] handle       handle of the sink
+     * @param[in] segBuf       start of every segment
+     * @param[in] segLen       bytes of every segment
+     * @param[in] numSegments  segments
+     * @param[in] packetLen    bytes of all segments
+     * @param[in] done         called once the segments may be reused
+     * @param[in] doneArg      passed to done
+     *
+     * @retval 0 when sent or queued, <0 when the packet was dropped
+     */
+    int32_t     (*send)(void *handle, const uint8_t * const *segBuf, const uint32_t *segLen,
+                        uint32_t numSegments, uint32_t packetLen,
+                        MmwDemo_outputSinkDoneFxn done, void *doneArg);
+
+    /*! @brief   Passed to send */
+    void        *handle;
+} MmwDemo_outputSink;
+
+/* Sink of the logging UART, and the sink in use, in mss_main.c */
+extern MmwDemo_outputSink gMmwUartSink;
+extern MmwDemo_outputSink *gMmwOutputSink;
+
+extern void MmwDemo_uartSinkInit(uint32_t taskPriority);
+
+#ifdef ENET_STREAM
+/* UDP sink, in mmw_udp_sink.c */
+extern MmwDemo_outputSink gMmwUdpSink;
+
+extern void MmwDemo_udpSinkInit(uint32_t taskPriority);
+extern void MmwDemo_udpSinkConfig(uint16_t port, uint32_t framesPerBatch);
+extern void MmwDemo_udpSinkFlush(void);
+extern void MmwDemo_udpSinkGetStats(uint32_t *numSent, uint32_t *numDropped);
+#endif
+
+#endif /* MMW_OUTPUT_SINK_H */
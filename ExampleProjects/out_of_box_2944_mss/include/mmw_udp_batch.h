@@ -0,0 +1,399 @@
+/*
+ *   @file  mmw_udp_batch.h
+ *
+ *   @brief
+ *      Datagrams of the UDP output sink.
+ *
+ *      The output packets of the frames are written one after the other
+ *      into a byte stream and the stream is cut into datagrams that fit
+ *      an Ethernet MTU, so a datagram can hold the end of one packet and
+ *      the start of the next and a heatmap spreads over as many as it
+ *      needs. Every datagram is numbered and says where the first packet
+ *      starting in it starts, so a receiver that loses one drops the
+ *      packet it was in and picks up again at the next packet start.
+ *
+ *      The writer fills a ring of datagrams from one task and another task
+ *      sends them, the indexes are only written by one side each. The
+ *      reader puts the packets back together. Nothing here needs the SDK,
+ *      the MSS writes with it and HostTools/udp_sink_test.c reads with it.
+ */
+
+#ifndef MMW_UDP_BATCH_H
+#define MMW_UDP_BATCH_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*! @brief  Bytes of a datagram, an Ethernet MTU less the IPv4 and UDP headers */
+#define MMWDEMO_UDP_DGRAM_SIZE          (1472U)
+
+/*! @brief  "MMWU" in the first word of every datagram */
+#define MMWDEMO_UDP_DGRAM_MAGIC         (0x55574D4DU)
+
+/*! @brief  firstPacket of a datagram in which no packet starts */
+#define MMWDEMO_UDP_NO_PACKET_START     (0xFFFFU)
+
+/*! @brief  Datagrams this far behind the expected one are duplicates or
+ *          came out of order, further back the board started again */
+#define MMWDEMO_UDP_REASM_WINDOW        (64U)
+
+/*! @brief  Default UDP port of the output sink */
+#define MMWDEMO_UDP_SINK_PORT           (7001U)
+
+/*!
+ * @brief
+ *  Start of every datagram, the stream bytes follow.
+ */
+typedef struct MmwDemo_udpDgramHdr_t
+{
+    /*! @brief   @ref MMWDEMO_UDP_DGRAM_MAGIC */
+    uint32_t    magic;
+
+    /*! @brief   Counts the datagrams sent, from 0 */
+    uint32_t    seq;
+
+    /*! @brief   Offset in the stream bytes of the first packet that starts
+     *           here, @ref MMWDEMO_UDP_NO_PACKET_START when none does */
+    uint16_t    firstPacket;
+
+    /*! @brief   Stream bytes in the datagram */
+    uint16_t    length;
+} MmwDemo_udpDgramHdr;
+
+/*! @brief  Stream bytes a datagram holds */
+#define MMWDEMO_UDP_DGRAM_PAYLOAD       (MMWDEMO_UDP_DGRAM_SIZE - sizeof(MmwDemo_udpDgramHdr))
+
+/*! @brief  One datagram */
+typedef struct MmwDemo_udpDgram_t
+{
+    MmwDemo_udpDgramHdr hdr;
+    uint8_t             payload[MMWDEMO_UDP_DGRAM_PAYLOAD];
+} MmwDemo_udpDgram;
+
+/*!
+ * @brief
+ *  Writer of the datagram ring.
+ *
+ * @details
+ *  Datagrams tail up to head are ready to send, datagram head is being
+ *  filled. head is only written by the writer, tail only by the
+ *  sender, both only ever grow and wrap with the 32 bits.
+ */
+typedef struct MmwDemo_udpBatch_t
+{
+    /*! @brief   Ring of datagrams */
+    MmwDemo_udpDgram    *dgram;
+
+    /*! @brief   Datagrams in the ring */
+    uint32_t            numDgrams;
+
+    /*! @brief   Datagrams handed to the sender */
+    volatile uint32_t   head;
+
+    /*! @brief   Datagrams the sender is done with */
+    volatile uint32_t   tail;
+
+    /*! @brief   seq of the next datagram */
+    uint32_t            seq;
+
+    /*! @brief   Packets dropped because the ring was full */
+    uint32_t            numDropped;
+} MmwDemo_udpBatch;
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts a writer on an empty ring.
+ *
+ *  @param[out] batch       Writer
+ *  @param[in]  dgram       Ring of datagrams
+ *  @param[in]  numDgrams   Datagrams in the ring, a power of 2 so the
+ *                          indexes wrap with it, at least 2
+ */
+static inline void MmwDemo_udpBatchInit(MmwDemo_udpBatch *batch, MmwDemo_udpDgram *dgram, uint32_t numDgrams)
+{
+    memset(batch, 0, sizeof(*batch));
+    batch->dgram     = dgram;
+    batch->numDgrams = numDgrams;
+    dgram[0].hdr.length      = 0U;
+    dgram[0].hdr.firstPacket = MMWDEMO_UDP_NO_PACKET_START;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Hands the datagram being filled to the sender and starts the next.
+ *      Does nothing when it is empty. The writer flushes after the last
+ *      packet of a batch, a full datagram goes when the next packet needs
+ *      room or at that flush.
+ *
+ *  @param[in]  batch       Writer
+ */
+static inline void MmwDemo_udpBatchFlush(MmwDemo_udpBatch *batch)
+{
+    MmwDemo_udpDgram *dgram = &batch->dgram[batch->head % batch->numDgrams];
+    MmwDemo_udpDgram *next;
+
+    /* The next one to fill would still be with the sender */
+    if ((dgram->hdr.length == 0U) || ((batch->head - batch->tail) >= (batch->numDgrams - 1U)))
+    {
+        return;
+    }
+    dgram->hdr.magic = MMWDEMO_UDP_DGRAM_MAGIC;
+    dgram->hdr.seq   = batch->seq++;
+
+    /* The sender may take it once head moves past it */
+    batch->head = batch->head + 1U;
+
+    next = &batch->dgram[batch->head % batch->numDgrams];
+    next->hdr.length      = 0U;
+    next->hdr.firstPacket = MMWDEMO_UDP_NO_PACKET_START;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Writes one output packet, given as segments, into the ring. The
+ *      packet goes in whole or, when the ring cannot take it, not at all.
+ *
+ *  @param[in]  batch       Writer
+ *  @param[in]  segBuf      Start of every segment
+ *  @param[in]  segLen      Bytes of every segment
+ *  @param[in]  numSegments Segments
+ *  @param[in]  packetLen   Bytes of all segments
+ *
+ *  @retval   0 when written, -1 when dropped
+ */
+static inline int32_t MmwDemo_udpBatchWrite(MmwDemo_udpBatch *batch, const uint8_t * const *segBuf,
+                                            const uint32_t *segLen, uint32_t numSegments, uint32_t packetLen)
+{
+    MmwDemo_udpDgram *dgram = &batch->dgram[batch->head % batch->numDgrams];
+    uint32_t inUse = batch->head - batch->tail;
+    uint32_t room;
+    uint32_t seg, pos, n;
+
+    /* Room in the datagram being filled and in the ones after it, keeping
+     * one free so the last can be flushed */
+    room = ((inUse + 2U) <= batch->numDgrams) ?
+           ((MMWDEMO_UDP_DGRAM_PAYLOAD - dgram->hdr.length) +
+            ((batch->numDgrams - 2U - inUse) * MMWDEMO_UDP_DGRAM_PAYLOAD)) : 0U;
+    if (packetLen > room)
+    {
+        batch->numDropped++;
+        return -1;
+    }
+
+    if (dgram->hdr.length == MMWDEMO_UDP_DGRAM_PAYLOAD)
+    {
+        MmwDemo_udpBatchFlush(batch);
+        dgram = &batch->dgram[batch->head % batch->numDgrams];
+    }
+    if (dgram->hdr.firstPacket == MMWDEMO_UDP_NO_PACKET_START)
+    {
+        dgram->hdr.firstPacket = dgram->hdr.length;
+    }
+    for (seg = 0U; seg < numSegments; seg++)
+    {
+        for (pos = 0U; pos < segLen[seg]; pos += n)
+        {
+            if (dgram->hdr.length == MMWDEMO_UDP_DGRAM_PAYLOAD)
+            {
+                MmwDemo_udpBatchFlush(batch);
+                dgram = &batch->dgram[batch->head % batch->numDgrams];
+            }
+            n = MMWDEMO_UDP_DGRAM_PAYLOAD - dgram->hdr.length;
+            n = (n < (segLen[seg] - pos)) ? n : (segLen[seg] - pos);
+            memcpy(&dgram->payload[dgram->hdr.length], &segBuf[seg][pos], n);
+            dgram->hdr.length = (uint16_t)(dgram->hdr.length + n);
+        }
+    }
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Returns the oldest datagram handed to the sender.
+ *
+ *  @param[in]  batch       Writer
+ *
+ *  @retval   Datagram of sizeof(hdr) + hdr.length bytes, NULL when there is none
+ */
+static inline const MmwDemo_udpDgram *MmwDemo_udpBatchNext(const MmwDemo_udpBatch *batch)
+{
+    if (batch->tail == batch->head)
+    {
+        return NULL;
+    }
+    return &batch->dgram[batch->tail % batch->numDgrams];
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Gives the oldest datagram back to the writer once it is sent.
+ *
+ *  @param[in]  batch       Writer
+ */
+static inline void MmwDemo_udpBatchRelease(MmwDemo_udpBatch *batch)
+{
+    batch->tail = batch->tail + 1U;
+}
+
+/*!
+ * @brief
+ *  Reader that puts the output packets back together.
+ */
+typedef struct MmwDemo_udpReasm_t
+{
+    /*! @brief   Packet being put together */
+    uint8_t     *packet;
+
+    /*! @brief   Bytes of packet */
+    uint32_t    packetSize;
+
+    /*! @brief   Bytes of the packet so far */
+    uint32_t    have;
+
+    /*! @brief   1 when the bytes coming in belong to the packet */
+    uint32_t    inSync;
+
+    /*! @brief   seq the next datagram should have */
+    uint32_t    nextSeq;
+
+    /*! @brief   1 once a datagram came */
+    uint32_t    started;
+
+    /*! @brief   Datagrams that never came */
+    uint32_t    numLost;
+
+    /*! @brief   Packets dropped, because of a lost datagram or because they
+     *           did not fit in packet. A lower bound: packets that start
+     *           and end in lost datagrams, or start while the reader waits
+     *           for a packet start, are not seen so are not counted */
+    uint32_t    numDropped;
+
+    /*! @brief   Duplicate or out of order datagrams skipped */
+    uint32_t    numStale;
+} MmwDemo_udpReasm;
+
+/**
+ *  @b Description
+ *  @n
+ *      Returns the length of a packet from its header, once the header is there.
+ *
+ *  @retval   Bytes, 0 when not known yet
+ */
+static inline uint32_t MmwDemo_udpReasmPacketLen(const MmwDemo_udpReasm *reasm)
+{
+    /* totalPacketLen follows the magic word and the version */
+    if (reasm->have < 16U)
+    {
+        return 0U;
+    }
+    return (uint32_t)reasm->packet[12] | ((uint32_t)reasm->packet[13] << 8) |
+           ((uint32_t)reasm->packet[14] << 16) | ((uint32_t)reasm->packet[15] << 24);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Takes one datagram and calls back with every packet it completes.
+ *
+ *  @param[in]  reasm       Reader
+ *  @param[in]  data        Datagram
+ *  @param[in]  len         Bytes of the datagram
+ *  @param[in]  onPacket    Called with every complete packet
+ *  @param[in]  arg         Passed to onPacket
+ *
+ *  @retval   0, -1 when it is not a datagram of the sink
+ */
+static inline int32_t MmwDemo_udpReasmFeed(MmwDemo_udpReasm *reasm, const uint8_t *data, uint32_t len,
+                                           void (*onPacket)(void *arg, const uint8_t *packet, uint32_t len),
+                                           void *arg)
+{
+    MmwDemo_udpDgramHdr hdr;
+    uint32_t pos, n, packetLen;
+    int32_t gap;
+
+    if (len < sizeof(hdr))
+    {
+        return -1;
+    }
+    memcpy(&hdr, data, sizeof(hdr));
+    if ((hdr.magic != MMWDEMO_UDP_DGRAM_MAGIC) || ((sizeof(hdr) + hdr.length) > len) ||
+        ((hdr.firstPacket != MMWDEMO_UDP_NO_PACKET_START) && (hdr.firstPacket >= hdr.length)))
+    {
+        return -1;
+    }
+    data += sizeof(hdr);
+
+    gap = (int32_t)(hdr.seq - reasm->nextSeq);
+    if (reasm->started && (gap < 0) && (gap > -(int32_t)MMWDEMO_UDP_REASM_WINDOW))
+    {
+        /* Its bytes are in already or were given up on */
+        reasm->numStale++;
+        return 0;
+    }
+    if (reasm->started && (gap != 0))
+    {
+        /* Further back the board started again, nothing was lost */
+        if (gap > 0)
+        {
+            reasm->numLost += (uint32_t)gap;
+        }
+        if (reasm->inSync && (reasm->have > 0U))
+        {
+            reasm->numDropped++;
+        }
+        reasm->inSync = 0U;
+    }
+    reasm->started = 1U;
+    reasm->nextSeq = hdr.seq + 1U;
+
+    pos = 0U;
+    if (!reasm->inSync)
+    {
+        if (hdr.firstPacket == MMWDEMO_UDP_NO_PACKET_START)
+        {
+            return 0;
+        }
+        pos = hdr.firstPacket;
+        reasm->have   = 0U;
+        reasm->inSync = 1U;
+    }
+
+    while (pos < hdr.length)
+    {
+        packetLen = MmwDemo_udpReasmPacketLen(reasm);
+        if (packetLen == 0U)
+        {
+            n = 16U - reasm->have;
+        }
+        else if ((packetLen < 16U) || (packetLen > reasm->packetSize))
+        {
+            /* Cannot hold it, wait for the next packet start */
+            reasm->numDropped++;
+            reasm->inSync = 0U;
+            return 0;
+        }
+        else
+        {
+            n = packetLen - reasm->have;
+        }
+        n = (n < (hdr.length - pos)) ? n : (hdr.length - pos);
+        memcpy(&reasm->packet[reasm->have], &data[pos], n);
+        reasm->have += n;
+        pos += n;
+
+        packetLen = MmwDemo_udpReasmPacketLen(reasm);
+        if ((packetLen != 0U) && (reasm->have == packetLen))
+        {
+            onPacket(arg, reasm->packet, packetLen);
+            reasm->have = 0U;
+        }
+    }
+    return 0;
+}
+
+#endif /* MMW_UDP_BATCH_H */
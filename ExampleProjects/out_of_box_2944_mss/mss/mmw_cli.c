@@ -50,6 +50,8 @@
 
 /* MCU + SDK Include Files: */
 #include <drivers/uart.h>
+#include <kernel/dpl/CacheP.h>
+#include <kernel/dpl/ClockP.h>
 
 /* mmWave SDK Include Files: */
 #include <ti/common/syscommon.h>
@@ -58,8 +60,13 @@
 #include <ti/utils/cli/cli.h>
 #include <ti/utils/mathutils/mathutils.h>
 
-/* Demo Include Files */
-#include <ti/demo/awr294x/mmw/include/mmw_config.h>
+/* Demo Include Files, the ones in ../include ahead of mmw_mss.h so they
+ * take the place of the SDK copies it includes */
+#include "mmw_config.h"
+#include "mmw_output.h"
+#include "mmw_output_sink.h"
+#include "mmw_lvds_batch.h"
+#include "mmw_bulk_cfg.h"
 #include <ti/demo/awr294x/mmw/mss/mmw_mss.h>
 #include <ti/demo/utils/mmwdemo_adcconfig.h>
 #include <ti/demo/utils/mmwdemo_rfparser.h>
@@ -106,11 +113,15 @@ static int32_t MmwDemo_CLIChirpQualityRxSatMonCfg (int32_t argc, char* argv[]);
 static int32_t MmwDemo_CLIChirpQualitySigImgMonCfg (int32_t argc, char* argv[]);
 static int32_t MmwDemo_CLIAnalogMonitorCfg (int32_t argc, char* argv[]);
 static int32_t MmwDemo_CLILvdsStreamCfg (int32_t argc, char* argv[]);
+static int32_t MmwDemo_CLILvdsBatchCfg (int32_t argc, char* argv[]);
 static int32_t MmwDemo_CLIConfigDataPort (int32_t argc, char* argv[]);
 static int32_t MmwDemo_CLISSCConfig (int32_t argc, char* argv[]);
+static int32_t MmwDemo_CLIBulkCfg (int32_t argc, char* argv[]);
+static int32_t MmwDemo_CLIMemMap (int32_t argc, char* argv[]);
 #ifdef ENET_STREAM
 static int32_t MmwDemo_CLIQueryLocalIp (int32_t argc, char* argv[]);
 static int32_t MmwDemo_CLIEnetCfg(int32_t argc, char* argv[]);
+static int32_t MmwDemo_CLIOutputSinkCfg(int32_t argc, char* argv[]);
 #endif
 
 /**************************************************************************
@@ -119,6 +130,10 @@ static int32_t MmwDemo_CLIEnetCfg(int32_t argc, char* argv[]);
 
 extern MmwDemo_MSS_MCB    gMmwMssMCB;
 extern UART_Params gUartParams[CONFIG_UART_NUM_INSTANCES];
+extern MmwDemo_HSRAM gHSRAM;
+
+/* mmWave extension commands of the SDK CLI, ended by an entry without a handler */
+extern CLI_CmdTableEntry gCLIMMWaveExtensionTable[];
 
 /**************************************************************************
  *************************** Local Definitions ****************************
@@ -126,6 +141,18 @@ extern UART_Params gUartParams[CONFIG_UART_NUM_INSTANCES];
 
 #define MMWDEMO_DATAUART_MAX_BAUDRATE_SUPPORTED 3125000
 
+/* Baud rate of the command UART as set in mss.syscfg, and the time the host
+ * gets on top of the transfer itself to start sending a bulkCfg profile */
+#define MMWDEMO_BULK_CFG_BAUD_RATE      (115200U)
+#define MMWDEMO_BULK_CFG_SLACK_US       (2000000U)
+
+/* Demo commands, kept after CLI_open for bulkCfg to look up */
+static CLI_CmdTableEntry gMmwCliTable[CLI_MAX_CMD];
+static uint32_t gMmwCliNumCmds;
+
+/* Profile received by bulkCfg and its parse */
+static MmwDemo_bulkCfg gMmwBulkCfg;
+
 /**************************************************************************
  *************************** CLI  Function Definitions **************************
  **************************************************************************/
@@ -1698,6 +1725,71 @@ static int32_t MmwDemo_CLILvdsStreamCfg (int32_t argc, char* argv[])
     return 0;
 }
 
+/**
+ *  @b Description
+ *  @n
+ *      This is the CLI Handler for the frames of s/w data that go out in
+ *      one transfer of the LVDS s/w session
+ *
+ *  @param[in] argc
+ *      Number of arguments
+ *  @param[in] argv
+ *      Arguments
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t MmwDemo_CLILvdsBatchCfg (int32_t argc, char* argv[])
+{
+    int32_t  framesPerBatch, maxObj;
+    uint32_t numBatches, numCut;
+
+    if (gMmwMssMCB.sensorState == MmwDemo_SensorState_STARTED)
+    {
+        CLI_write ("Ignored: This command is not allowed after sensor has started\n");
+        return 0;
+    }
+
+    /* Sanity Check: Minimum argument check */
+    if (argc != 3)
+    {
+        CLI_write ("Error: Invalid usage of the CLI command\n");
+        return -1;
+    }
+
+    framesPerBatch = atoi(argv[1]);
+    maxObj         = atoi(argv[2]);
+    if ((framesPerBatch <= 0) || (framesPerBatch > (int32_t)MMWDEMO_LVDS_BATCH_MAX_FRAMES))
+    {
+        CLI_write ("Error: frames per batch must be 1 to %u\n", MMWDEMO_LVDS_BATCH_MAX_FRAMES);
+        return -1;
+    }
+
+    if ((maxObj <= 0) || (maxObj > (int32_t)MmwDemo_LVDSStreamSwMaxObj()))
+    {
+        CLI_write ("Error: max points of a frame must be 1 to %u\n", MmwDemo_LVDSStreamSwMaxObj());
+        return -1;
+    }
+
+    MmwDemo_LVDSStreamSwBatchConfig((uint32_t)framesPerBatch, (uint32_t)maxObj);
+
+    /* One frame streams with the points it has, a batch streams the whole buffer, full or not */
+    MmwDemo_LVDSStreamGetSwStats(&numBatches, &numCut);
+    if (framesPerBatch == 1)
+    {
+        CLI_write ("LVDS s/w data goes out every frame with up to %d points, 8 + 20 bytes a point\n", maxObj);
+    }
+    else
+    {
+        CLI_write ("LVDS s/w data goes out %d frames of up to %d points at a time, %u bytes a batch\n",
+                   framesPerBatch, maxObj, MmwDemo_lvdsBatchSize((uint32_t)framesPerBatch, (uint32_t)maxObj));
+    }
+    CLI_write ("%u batches streamed and %u points cut off\n", numBatches, numCut);
+    return 0;
+}
+
 
 
 /**
@@ -1796,6 +1888,89 @@ static int32_t MmwDemo_CLIQueryDemoStatus (int32_t argc, char* argv[])
     return 0;
 }
 
+/**
+ *  @b Description
+ *  @n
+ *      This is the CLI Handler for printing the DSP memory map of a
+ *      sub-frame: the size, use and alignment waste of every pool, then
+ *      every buffer the DSP handed out for the sub-frame. The map is written
+ *      by the DSP when the sub-frame is configured, a buffer that did not
+ *      fit is listed as such with the size it asked for.
+ *
+ *  @param[in] argc
+ *      Number of arguments
+ *  @param[in] argv
+ *      Arguments
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t MmwDemo_CLIMemMap (int32_t argc, char* argv[])
+{
+    static const char * const poolName[MMWDEMO_MEMMAP_POOL_MAX] =
+        {"L3", "L2", "winBuf", "preProc", "hwaWinRam", "hwaParams"};
+    static const char * const ownerName[MMWDEMO_MEMMAP_OWNER_MAX] =
+        {"dpc", "range", "doppler", "rangeCfar", "aoa"};
+    MmwDemo_memMap      *map;
+    MmwDemo_memMapEntry *entry;
+    int8_t              subFrameNum;
+    uint32_t            i;
+
+    if (MmwDemo_CLIGetSubframe(argc, argv, 2, &subFrameNum) < 0)
+    {
+        return -1;
+    }
+    if (subFrameNum < 0)
+    {
+        CLI_write ("Error: Subframe number is invalid\n");
+        return -1;
+    }
+
+    map = &gHSRAM.memMap[subFrameNum];
+    CacheP_inv((void *)map, sizeof(MmwDemo_memMap), CacheP_TYPE_ALLD);
+    if (map->valid == 0U)
+    {
+        CLI_write ("Error: Sub-frame %d is not configured\n", subFrameNum);
+        return -1;
+    }
+
+    CLI_write ("%-10s %10s %10s %10s %8s\n", "pool", "size", "used", "free", "align");
+    for (i = 0; i < MMWDEMO_MEMMAP_POOL_MAX; i++)
+    {
+        CLI_write ("%-10s %10u %10u %10u %8u\n", poolName[i],
+                   map->pool[i].size, map->pool[i].highWater,
+                   map->pool[i].size - map->pool[i].highWater,
+                   map->pool[i].alignWaste);
+    }
+
+    CLI_write ("%-12s %-10s %-10s %10s %10s %6s\n", "buffer", "pool", "owner", "offset", "size", "align");
+    for (i = 0; i < map->numEntries; i++)
+    {
+        entry = &map->entry[i];
+        if (entry->offset == MMWDEMO_MEMMAP_NO_FIT)
+        {
+            CLI_write ("%-12s %-10s %-10s %10s %10u %6s\n", entry->name,
+                       poolName[entry->pool], ownerName[entry->owner],
+                       "NO FIT", entry->size, "-");
+        }
+        else
+        {
+            CLI_write ("%-12s %-10s %-10s 0x%08x %10u %6u\n", entry->name,
+                       poolName[entry->pool], ownerName[entry->owner],
+                       entry->offset, entry->size, entry->alignWaste);
+        }
+    }
+    if (map->numDropped != 0U)
+    {
+        CLI_write ("%u more buffers did not fit in the map\n", map->numDropped);
+    }
+    CLI_write ("hwaWinRam is in coefficients, hwaParams in param sets\n");
+
+    return 0;
+}
+
 #ifdef ENET_STREAM
 /**
  *  @b Description
@@ -1874,6 +2049,60 @@ static int32_t MmwDemo_CLIEnetCfg(int32_t argc, char* argv[])
 
     return 0;
 }
+
+/**
+ *  @b Description
+ *  @n
+ *      This is the CLI Handler for selecting where the output packets go,
+ *      the logging UART or UDP to the remote IP of enetStreamCfg
+ *
+ *  @param[in] argc
+ *      Number of arguments
+ *  @param[in] argv
+ *      Arguments
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t MmwDemo_CLIOutputSinkCfg(int32_t argc, char* argv[])
+{
+    uint32_t sink;
+    int32_t  port;
+    int32_t  framesPerBatch;
+    uint32_t numSent, numDropped;
+
+    if (gMmwMssMCB.sensorState == MmwDemo_SensorState_STARTED)
+    {
+        CLI_write ("Ignored: This command is not allowed after sensor has started\n");
+        return 0;
+    }
+
+    /* Sanity Check: Minimum argument check */
+    if (argc != 4)
+    {
+        CLI_write ("Error: Invalid usage of the CLI command\n");
+        return -1;
+    }
+
+    sink           = (uint32_t)atoi(argv[1]);
+    port           = atoi(argv[2]);
+    framesPerBatch = atoi(argv[3]);
+    if ((sink > MMWDEMO_OUTPUT_SINK_UDP) || (port <= 0) || (port > 65535) || (framesPerBatch <= 0))
+    {
+        CLI_write ("Error: Invalid sink, port or frames per batch\n");
+        return -1;
+    }
+
+    MmwDemo_udpSinkConfig((uint16_t)port, (uint32_t)framesPerBatch);
+    gMmwOutputSink = (sink == MMWDEMO_OUTPUT_SINK_UDP) ? &gMmwUdpSink : &gMmwUartSink;
+
+    MmwDemo_udpSinkGetStats(&numSent, &numDropped);
+    CLI_write ("Output goes to %s, udp has sent %u datagrams and dropped %u packets\n",
+               gMmwOutputSink->name, numSent, numDropped);
+    return 0;
+}
 #endif
 
 /**
@@ -2030,6 +2259,160 @@ static int32_t MmwDemo_CLISSCConfig (int32_t argc, char* argv[])
     return 0;
 }
 
+/**
+ *  @b Description
+ *  @n
+ *      Finds a command of a bulkCfg profile among the demo commands and the
+ *      mmWave extension commands. bulkCfg itself is not allowed in a profile.
+ *
+ *  @param[in] arg
+ *      Not used
+ *  @param[in] cmd
+ *      Command name
+ *
+ *  @retval
+ *      Command table entry, NULL when there is none
+ */
+static void *MmwDemo_CLIBulkCfgLookup (void *arg, const char *cmd)
+{
+    CLI_CmdTableEntry *ptrEntry;
+    uint32_t index;
+
+    (void)arg;
+    for (index = 0; index < gMmwCliNumCmds; index++)
+    {
+        if (strcmp (gMmwCliTable[index].cmd, cmd) == 0)
+        {
+            return (gMmwCliTable[index].cmdHandlerFxn == MmwDemo_CLIBulkCfg) ? NULL : &gMmwCliTable[index];
+        }
+    }
+    for (ptrEntry = &gCLIMMWaveExtensionTable[0]; ptrEntry->cmdHandlerFxn != NULL; ptrEntry++)
+    {
+        if (strcmp (ptrEntry->cmd, cmd) == 0)
+        {
+            return ptrEntry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      This is the CLI Handler for loading a whole .cfg profile in one
+ *      transfer, framed as in mmw_bulk_cfg.h. The profile is checked, every
+ *      line is parsed and looked up, and only then are the commands run back
+ *      to back. If one fails part way flushCfg is run, so the sensor is not
+ *      left with half of a profile; a profile cannot be taken at all without
+ *      flushCfg to roll back with.
+ *
+ *  @param[in] argc
+ *      Number of arguments
+ *  @param[in] argv
+ *      Arguments
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t MmwDemo_CLIBulkCfg (int32_t argc, char* argv[])
+{
+    UART_Transaction    trans;
+    CLI_CmdTableEntry   *ptrFlush;
+    char                *flushArgs[1] = { "flushCfg" };
+    uint32_t            size;
+    uint32_t            index;
+    uint16_t            checksum;
+    int32_t             status;
+
+    if (gMmwMssMCB.sensorState == MmwDemo_SensorState_STARTED)
+    {
+        CLI_write ("Ignored: This command is not allowed after sensor has started\n");
+        return 0;
+    }
+
+    /* Sanity Check: Minimum argument check */
+    if (argc != 3)
+    {
+        CLI_write ("Error: Invalid usage of the CLI command\n");
+        return -1;
+    }
+    size     = (uint32_t)strtoul (argv[1], NULL, 0);
+    checksum = (uint16_t)strtoul (argv[2], NULL, 16);
+    if ((size == 0U) || (size > MMWDEMO_BULK_CFG_MAX_SIZE))
+    {
+        CLI_write ("Error: bulkCfg size must be 1 to %u bytes\n", MMWDEMO_BULK_CFG_MAX_SIZE);
+        return -1;
+    }
+
+    /* Without flushCfg a failed profile could not be rolled back */
+    ptrFlush = (CLI_CmdTableEntry *)MmwDemo_CLIBulkCfgLookup (NULL, "flushCfg");
+    if (ptrFlush == NULL)
+    {
+        CLI_write ("Error: bulkCfg needs flushCfg to roll back, nothing applied\n");
+        return -1;
+    }
+
+    /* Tell the host to start sending and take the whole profile in one read,
+     * giving it twice the time the bytes take at 10 bits each plus the slack */
+    CLI_write ("Ready\n");
+    UART_Transaction_init(&trans);
+    trans.buf     = &gMmwBulkCfg.buf[0];
+    trans.count   = size;
+    trans.timeout = ClockP_usecToTicks (((uint64_t)size * 10U * 2U * 1000000U) / MMWDEMO_BULK_CFG_BAUD_RATE +
+                                        MMWDEMO_BULK_CFG_SLACK_US);
+    status = UART_read (gMmwMssMCB.commandUartHandle, &trans);
+    if ((status == SystemP_TIMEOUT) || (trans.status == UART_TRANSFER_STATUS_TIMEOUT))
+    {
+        CLI_write ("Error: bulkCfg receive timed out\n");
+        return -2;
+    }
+    if ((status != SystemP_SUCCESS) || (trans.status != UART_TRANSFER_STATUS_SUCCESS))
+    {
+        CLI_write ("Error: bulkCfg receive failed\n");
+        return -2;
+    }
+    if (MmwDemo_bulkCfgChecksum (&gMmwBulkCfg.buf[0], size) != checksum)
+    {
+        CLI_write ("Error: bulkCfg checksum mismatch\n");
+        return -3;
+    }
+
+    /* Validate the profile as a unit before running any of it */
+    status = MmwDemo_bulkCfgParse (&gMmwBulkCfg, size, MmwDemo_CLIBulkCfgLookup, NULL);
+    if (status != 0)
+    {
+        CLI_write ("Error: bulkCfg rejected at line %d, nothing applied\n", status);
+        return -4;
+    }
+
+    /* Commit */
+    for (index = 0; index < gMmwBulkCfg.numLines; index++)
+    {
+        MmwDemo_bulkCfgLine *ptrLine = &gMmwBulkCfg.line[index];
+        CLI_CmdTableEntry   *ptrEntry = (CLI_CmdTableEntry *)ptrLine->entry;
+
+        status = ptrEntry->cmdHandlerFxn (ptrLine->argc, &gMmwBulkCfg.args[ptrLine->argStart]);
+        if (status != 0)
+        {
+            CLI_write ("Error: bulkCfg line %u '%s' failed with %d\n", ptrLine->lineNum, ptrEntry->cmd, status);
+
+            /* Roll back to an empty configuration rather than a partial one */
+            status = ptrFlush->cmdHandlerFxn (1, flushArgs);
+            if (status != 0)
+            {
+                CLI_write ("Error: bulkCfg roll back failed with %d, configuration is partial\n", status);
+                return -6;
+            }
+            return -5;
+        }
+    }
+
+    CLI_write ("bulkCfg applied %u commands\n", gMmwBulkCfg.numLines);
+    return 0;
+}
+
 /**
  *  @b Description
  *  @n
@@ -2173,6 +2556,11 @@ void MmwDemo_CLIInit (uint8_t taskPriority)
     cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLILvdsStreamCfg;
     cnt++;
 
+    cliCfg.tableEntry[cnt].cmd            = "lvdsBatchCfg";
+    cliCfg.tableEntry[cnt].helpString     = "<framesPerBatch> <maxObj> (1 frame streams as it is, more stream 16 + framesPerBatch*(8 + 20*maxObj) bytes a batch)";
+    cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLILvdsBatchCfg;
+    cnt++;
+
     cliCfg.tableEntry[cnt].cmd            = "configDataPort";
     cliCfg.tableEntry[cnt].helpString     = "<baudrate> <ackPing>";
     cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIConfigDataPort;
@@ -2183,6 +2571,11 @@ void MmwDemo_CLIInit (uint8_t taskPriority)
     cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIQueryDemoStatus;
     cnt++;
 
+    cliCfg.tableEntry[cnt].cmd            = "memMap";
+    cliCfg.tableEntry[cnt].helpString     = "<subFrameIdx>";
+    cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIMemMap;
+    cnt++;
+
 #ifdef ENET_STREAM
     cliCfg.tableEntry[cnt].cmd            = "queryLocalIp";
     cliCfg.tableEntry[cnt].helpString     = "";
@@ -2200,6 +2593,11 @@ void MmwDemo_CLIInit (uint8_t taskPriority)
     cliCfg.tableEntry[cnt].helpString     = "<isEnabled> <remoteIpD> <remoteIpC> <remoteIpB> <remoteIpA>"; /* Ip: D.C.B.A */
     cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIEnetCfg;
     cnt++;
+
+    cliCfg.tableEntry[cnt].cmd            = "outputSinkCfg";
+    cliCfg.tableEntry[cnt].helpString     = "<sink> <udpPort> <framesPerBatch>"; /* sink: 0 UART, 1 UDP */
+    cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIOutputSinkCfg;
+    cnt++;
 #endif
 
 #ifdef MMWDEMO_DDM
@@ -2249,6 +2647,14 @@ void MmwDemo_CLIInit (uint8_t taskPriority)
     cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLISSCConfig;
     cnt++;
 
+    cliCfg.tableEntry[cnt].cmd            = "bulkCfg";
+    cliCfg.tableEntry[cnt].helpString     = "<bytes> <fletcher16 hex>, then the whole .cfg in one transfer";
+    cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIBulkCfg;
+    cnt++;
+
+    /* Keep the commands for bulkCfg, CLI_open takes its own copy */
+    memcpy ((void *)&gMmwCliTable[0], (void *)&cliCfg.tableEntry[0], sizeof(gMmwCliTable));
+    gMmwCliNumCmds = cnt;
 
     /* Open the CLI: */
     if (CLI_open (&cliCfg) < 0)
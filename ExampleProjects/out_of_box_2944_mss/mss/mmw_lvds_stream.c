@@ -44,11 +44,16 @@
 #include <string.h>
 #include <stdio.h>
 
+/* MCU Plus Include Files. */
+#include <kernel/dpl/CacheP.h>
+
 /* MMWSDK Include Files. */
 #include <ti/common/syscommon.h>
 #include <ti/utils/hsiheader/hsiheader.h>
 
-/* MMWAVE Demo Include Files */
+/* MMWAVE Demo Include Files, the ones in ../include ahead of mmw_mss.h */
+#include "mmw_output.h"
+#include "mmw_lvds_batch.h"
 #include <ti/demo/awr294x/mmw/mss/mmw_mss.h>
 
 #ifdef MMWDEMO_TDM
@@ -58,9 +63,72 @@
 #endif
 
 extern MmwDemo_MSS_MCB    gMmwMssMCB;
-uint8_t gUserDataHeader[8] __attribute__((aligned(32)));
 uint8_t gHwDataHeader[256] __attribute__((aligned(32)));
 
+/* Most points of a frame that can be streamed, as many as a DSS result slot holds */
+#define MMWDEMO_LVDS_SW_MAX_OBJ     (MMWDEMO_HSRAM_PAYLOAD_SIZE / \
+                                     (sizeof(DPIF_PointCloudCartesian) + sizeof(DPIF_PointCloudSideInfo)))
+
+/* User buffer of the SW session, for the largest batch lvdsBatchCfg allows */
+#define MMWDEMO_LVDS_SW_BUF_SIZE    (sizeof(MmwDemo_lvdsBatchHdr) + (MMWDEMO_LVDS_BATCH_MAX_FRAMES * \
+                                     (sizeof(MmwDemo_lvdsFrameHdr) + (MMWDEMO_LVDS_SW_MAX_OBJ * \
+                                      (MMWDEMO_LVDS_BATCH_POINT_SIZE + MMWDEMO_LVDS_BATCH_SIDE_SIZE)))))
+
+/**
+ * @brief
+ *  Sessions kept from sensor start to stop.
+ *
+ * @details
+ *  The CBUFF driver has two trigger EDMA channels, so one HW and one SW
+ *  session can exist at a time.
+ *
+ *  With one frame to a batch, the default, the SW session streams a frame
+ *  as the SDK demo does: the MmwDemo_LVDSUserDataHeader_t, the points and
+ *  the side info, each a user buffer of the size the frame needs. The user
+ *  buffer sizes are fixed in a session, so it is created again whenever a
+ *  frame has another number of points than the one before.
+ *
+ *  With more frames to a batch it streams a user buffer laid out as in
+ *  mmw_lvds_batch.h at a fixed address and of a fixed size, it is created
+ *  at start and every frame only copies into the buffer. The size is set by
+ *  lvdsBatchCfg, every batch streams all of it however few points the
+ *  frames had.
+ *
+ *  The HW session configuration of every sub-frame is built at start, the
+ *  session is only created again when the next sub-frame streams with
+ *  another configuration.
+ */
+typedef struct MmwDemo_LVDSStreamPersist_t
+{
+    /*! @brief   HW session configuration of every sub-frame, without the HSI header */
+    CBUFF_SessionCfg    hwSessionCfg[RL_MAX_SUBFRAMES];
+
+    /*! @brief   Sub-frame the HW session was created for, -1 when there is none */
+    int8_t              hwSessionSubFrame;
+
+    /*! @brief   Frames to a batch, set with lvdsBatchCfg */
+    uint32_t            framesPerBatch;
+
+    /*! @brief   Most points of a frame streamed, set with lvdsBatchCfg */
+    uint32_t            maxObj;
+
+    /*! @brief   Writer of the SW user buffer */
+    MmwDemo_lvdsBatch   batch;
+
+    /*! @brief   Points of a frame the SW session was created for with one
+     *           frame to a batch, -1 when there is none */
+    int32_t             swSessionNumObj;
+
+    /*! @brief   SW session is streaming, swFrameDoneSemHandle is posted when it is done */
+    bool                isSwStreaming;
+
+    /*! @brief   Batches streamed */
+    uint32_t            numBatches;
+} MmwDemo_LVDSStreamPersist;
+
+static MmwDemo_LVDSStreamPersist gLVDSStreamPersist;
+static uint8_t gSwUserData[MMWDEMO_LVDS_SW_BUF_SIZE] __attribute__((aligned(32)));
+
 
 /**
  *  @b Description
@@ -243,10 +311,12 @@ int32_t MmwDemo_LVDSStreamInit (void)
     }
 
 
-    /* User data buffer is involved in LVDS streaming.
-     * The 64 byte alignment is a speculative workaround for an issue where
-     * EDMA is not completing transfer. */
-    gMmwMssMCB.lvdsStream.userDataHeader = (MmwDemo_LVDSUserDataHeader_t*)&gUserDataHeader[0];
+    /* No sessions until the sensor starts, one frame of up to the most points
+     * to a batch until lvdsBatchCfg */
+    memset ((void *)&gLVDSStreamPersist, 0, sizeof(MmwDemo_LVDSStreamPersist));
+    gLVDSStreamPersist.hwSessionSubFrame = -1;
+    gLVDSStreamPersist.framesPerBatch    = 1U;
+    gLVDSStreamPersist.maxObj            = MMWDEMO_LVDS_SW_MAX_OBJ;
 
     /* Initialize the HSI Header Module: */
     if (HSIHeader_init (&initCfg, &errCode) < 0)
@@ -270,11 +340,17 @@ int32_t MmwDemo_LVDSStreamInit (void)
     // gMmwMssMCB.lvdsStream.hwFrameDoneSemHandle = SemaphoreP_create(0, &semParams);
     // gMmwMssMCB.lvdsStream.swFrameDoneSemHandle = SemaphoreP_create(0, &semParams);
 
-    /* Check some assumptions about s/w session regarding sizes for user buffer which
-     * are going to stream out in CBUFF units so must be even number of bytes */
+    /* The s/w session user buffer is laid out as in mmw_lvds_batch.h, which has
+     * its own point sizes, and streams out in CBUFF units so must be an even
+     * number of bytes; the batch layout keeps everything in multiples of 4 */
+    MmwDemo_debugAssert(sizeof(DPIF_PointCloudCartesian) == MMWDEMO_LVDS_BATCH_POINT_SIZE);
+    MmwDemo_debugAssert(sizeof(DPIF_PointCloudSideInfo) == MMWDEMO_LVDS_BATCH_SIDE_SIZE);
+    MmwDemo_debugAssert(MMWDEMO_LVDS_SW_MAX_OBJ <= 0xFFFFU);
+
+    /* One frame streamed on its own must fit the user buffer too */
     MmwDemo_debugAssert((sizeof(MmwDemo_LVDSUserDataHeader_t) & 1) == 0);
-    MmwDemo_debugAssert((sizeof(DPIF_PointCloudCartesian) & 1) == 0);
-    MmwDemo_debugAssert((sizeof(DPIF_PointCloudSideInfo) & 1) == 0);
+    MmwDemo_debugAssert((sizeof(MmwDemo_LVDSUserDataHeader_t) + (MMWDEMO_LVDS_SW_MAX_OBJ *
+                         (sizeof(DPIF_PointCloudCartesian) + sizeof(DPIF_PointCloudSideInfo)))) <= MMWDEMO_LVDS_SW_BUF_SIZE);
 
     retVal = 0;
 
@@ -542,6 +618,7 @@ void MmwDemo_LVDSStreamDeleteHwSession (void)
     }
     
     streamMcb->hwSessionHandle = NULL;
+    gLVDSStreamPersist.hwSessionSubFrame = -1;
     
     /* Did we stream out with the HSI Header? */
     if (streamMcb->isHwSessionHSIHeaderAllocated == true)
@@ -699,56 +776,77 @@ static void MmwDemo_LVDSStream_SwTriggerFrameDone (CBUFF_SessionHandle sessionHa
 /**
  *  @b Description
  *  @n
- *      This is the LVDS streaming config function. 
- *      It configures the sessions for the LVDS streaming.
+ *      Builds the HW session configuration of a sub-frame, without the
+ *      HSI header which is only created with the session.
+ *
+ *  @param[in]  subFrameIndx   Index of sub-frame
+ *  @param[out] sessionCfg     Session configuration
  *
  *  @retval
- *      Success -   0
- *  @retval
- *      Error   -   <0
+ *      Not applicable
  */
-int32_t MmwDemo_LVDSStreamHwConfig (uint8_t subFrameIndx)
+static void MmwDemo_LVDSStreamHwBuildCfg (uint8_t subFrameIndx, CBUFF_SessionCfg *sessionCfg)
 {
-    CBUFF_SessionCfg          sessionCfg;
-    MmwDemo_LVDSStream_MCB_t* streamMcb = &gMmwMssMCB.lvdsStream;
-    int32_t                   errCode;
-    int32_t                   retVal = MINUS_ONE;
     MmwDemo_SubFrameCfg       *subFrameCfg = &gMmwMssMCB.subFrameCfg[subFrameIndx];
 
-    memset ((void*)&sessionCfg, 0, sizeof(CBUFF_SessionCfg));
+    /* Zeroed in full, configurations of two sub-frames are compared with memcmp */
+    memset ((void*)sessionCfg, 0, sizeof(CBUFF_SessionCfg));
     
     /* Populate the configuration: */
-    sessionCfg.executionMode          = CBUFF_SessionExecuteMode_HW;
-    sessionCfg.edmaHandle             = gMmwMssMCB.edmaHandle;
-    sessionCfg.allocateEDMAChannelFxn = MmwDemo_LVDSStream_EDMAAllocateCBUFFHwChannel;
-    sessionCfg.freeEDMAChannelFxn     = MmwDemo_LVDSStream_EDMAFreeCBUFFHwChannel;
-    sessionCfg.frameDoneCallbackFxn   = MmwDemo_LVDSStream_HwTriggerFrameDone;
-    sessionCfg.dataType               = CBUFF_DataType_REAL;
-    sessionCfg.u.hwCfg.dataMode       = (CBUFF_DataMode)subFrameCfg->adcBufCfg.chInterleave;
+    sessionCfg->executionMode          = CBUFF_SessionExecuteMode_HW;
+    sessionCfg->edmaHandle             = gMmwMssMCB.edmaHandle;
+    sessionCfg->allocateEDMAChannelFxn = MmwDemo_LVDSStream_EDMAAllocateCBUFFHwChannel;
+    sessionCfg->freeEDMAChannelFxn     = MmwDemo_LVDSStream_EDMAFreeCBUFFHwChannel;
+    sessionCfg->frameDoneCallbackFxn   = MmwDemo_LVDSStream_HwTriggerFrameDone;
+    sessionCfg->dataType               = CBUFF_DataType_REAL;
+    sessionCfg->u.hwCfg.dataMode       = (CBUFF_DataMode)subFrameCfg->adcBufCfg.chInterleave;
     
     /* Populate the HW Session configuration: */
-    sessionCfg.u.hwCfg.adcBufHandle      = gMmwMssMCB.adcBufHandle;
-    sessionCfg.u.hwCfg.numADCSamples     = subFrameCfg->numAdcSamples;
-    sessionCfg.u.hwCfg.numChirpsPerFrame = subFrameCfg->numChirpsPerSubFrame;
-    sessionCfg.u.hwCfg.chirpMode         = subFrameCfg->adcBufCfg.chirpThreshold;
-    sessionCfg.u.hwCfg.opMode            = CBUFF_OperationalMode_CHIRP;
+    sessionCfg->u.hwCfg.adcBufHandle      = gMmwMssMCB.adcBufHandle;
+    sessionCfg->u.hwCfg.numADCSamples     = subFrameCfg->numAdcSamples;
+    sessionCfg->u.hwCfg.numChirpsPerFrame = subFrameCfg->numChirpsPerSubFrame;
+    sessionCfg->u.hwCfg.chirpMode         = subFrameCfg->adcBufCfg.chirpThreshold;
+    sessionCfg->u.hwCfg.opMode            = CBUFF_OperationalMode_CHIRP;
     
     switch(subFrameCfg->lvdsStreamCfg.dataFmt)
     {
         case MMW_DEMO_LVDS_STREAM_CFG_DATAFMT_ADC:
-            sessionCfg.u.hwCfg.dataFormat = CBUFF_DataFmt_ADC_DATA;
+            sessionCfg->u.hwCfg.dataFormat = CBUFF_DataFmt_ADC_DATA;
         break;
         case MMW_DEMO_LVDS_STREAM_CFG_DATAFMT_CP_ADC_CQ:
-            sessionCfg.u.hwCfg.dataFormat = CBUFF_DataFmt_CP_ADC_CQ;
-            sessionCfg.u.hwCfg.cqSize[0] = 132;
-            sessionCfg.u.hwCfg.cqSize[1] = 132;
-            sessionCfg.u.hwCfg.cqSize[2] = 72;
+            sessionCfg->u.hwCfg.dataFormat = CBUFF_DataFmt_CP_ADC_CQ;
+            sessionCfg->u.hwCfg.cqSize[0] = 132;
+            sessionCfg->u.hwCfg.cqSize[1] = 132;
+            sessionCfg->u.hwCfg.cqSize[2] = 72;
         break;
         default:
             test_print ("Error: lvdsStreamCfg dataFmt %d is invalid\n", subFrameCfg->lvdsStreamCfg.dataFmt);
             MmwDemo_debugAssert(0);
         break;
     }    
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      This is the LVDS streaming config function. 
+ *      It creates the HW session of a sub-frame from the configuration
+ *      built by @ref MmwDemo_LVDSStreamStart.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int32_t MmwDemo_LVDSStreamHwConfig (uint8_t subFrameIndx)
+{
+    CBUFF_SessionCfg          sessionCfg;
+    MmwDemo_LVDSStream_MCB_t* streamMcb = &gMmwMssMCB.lvdsStream;
+    int32_t                   errCode;
+    int32_t                   retVal = MINUS_ONE;
+    MmwDemo_SubFrameCfg       *subFrameCfg = &gMmwMssMCB.subFrameCfg[subFrameIndx];
+
+    memcpy ((void*)&sessionCfg, (void*)&gLVDSStreamPersist.hwSessionCfg[subFrameIndx], sizeof(CBUFF_SessionCfg));
         
     if(subFrameCfg->lvdsStreamCfg.isHeaderEnabled)
     {    
@@ -780,6 +878,7 @@ int32_t MmwDemo_LVDSStreamHwConfig (uint8_t subFrameIndx)
         test_print("Error: MmwDemo_LVDSStream_config unable to create the CBUFF hardware session with [Error=%d]\n", errCode);
         goto exit;
     }
+    gLVDSStreamPersist.hwSessionSubFrame = (int8_t)subFrameIndx;
 
     /* Control comes here implies that the LVDS Stream has been configured successfully */
     retVal = 0;
@@ -792,23 +891,34 @@ exit:
  *  @b Description
  *  @n
  *      This is the LVDS sw streaming config function.
- *      It configures the sw session for the LVDS streaming.
+ *      It creates the sw session for the LVDS streaming.
  *
- *  @param[in]  numObjOut      Number of detected objects to stream out
- *  @param[in]  objOut         Pointer to detected objects point cloud
- *  @param[in]  objOutSideInfo Pointer to detected objects side information
+ *      With one frame to a batch the session streams the user data header
+ *      and numObj points and side infos, the frame as copied into the user
+ *      buffer by MmwDemo_LVDSStreamSwSendFrame, so the link carries
+ *      8 + 20 * numObj bytes plus the HSI header for the frame.
+ *
+ *      With more frames the session streams the whole user buffer of the
+ *      batch, so it is created once at start and only the buffer contents
+ *      change from frame to frame. The buffer is sized by lvdsBatchCfg, so
+ *      every batch costs MmwDemo_lvdsBatchSize(framesPerBatch, maxObj) bytes
+ *      on the link (16 + framesPerBatch * (8 + 20 * maxObj)) plus the HSI
+ *      header, even when the frames had no points.
+ *
+ *  @param[in]  numObj      Points of the frame with one frame to a batch, else not used
  *
  *  @retval
  *      Success -   0
  *  @retval
  *      Error   -   <0
  */
-int32_t MmwDemo_LVDSStreamSwConfig (uint32_t numObjOut,
-                                    DPIF_PointCloudCartesian *objOut,
-                                    DPIF_PointCloudSideInfo *objOutSideInfo)
+static int32_t MmwDemo_LVDSStreamSwCreate (uint32_t numObj)
 {
     CBUFF_SessionCfg          sessionCfg;
     MmwDemo_LVDSStream_MCB_t* streamMcb = &gMmwMssMCB.lvdsStream;
+    MmwDemo_LVDSStreamPersist *persist = &gLVDSStreamPersist;
+    uint32_t                  pointsOffset = sizeof(MmwDemo_LVDSUserDataHeader_t);
+    uint32_t                  sideOffset   = pointsOffset + (numObj * sizeof(DPIF_PointCloudCartesian));
     int32_t                   errCode;
     int32_t                   retVal = MINUS_ONE;
 
@@ -821,24 +931,32 @@ int32_t MmwDemo_LVDSStreamSwConfig (uint32_t numObjOut,
     sessionCfg.freeEDMAChannelFxn                = MmwDemo_LVDSStream_EDMAFreeCBUFFSwChannel;
     sessionCfg.frameDoneCallbackFxn              = MmwDemo_LVDSStream_SwTriggerFrameDone;
     sessionCfg.dataType                          = CBUFF_DataType_REAL; 
-    sessionCfg.u.swCfg.userBufferInfo[0].size    = HSIHeader_toCBUFFUnits(sizeof(MmwDemo_LVDSUserDataHeader_t));
-    sessionCfg.u.swCfg.userBufferInfo[0].address = (uint32_t)(streamMcb->userDataHeader);
-
-    /* Note size and addresses have defaulted to 0 due to memset zero initialization above */
-    if(numObjOut != 0)
+    if (persist->framesPerBatch == 1U)
     {
-        sessionCfg.u.swCfg.userBufferInfo[1].size    = HSIHeader_toCBUFFUnits(numObjOut * sizeof(DPIF_PointCloudCartesian));
-        sessionCfg.u.swCfg.userBufferInfo[1].address = (uint32_t)objOut;
+        sessionCfg.u.swCfg.userBufferInfo[0].size    = HSIHeader_toCBUFFUnits(sizeof(MmwDemo_LVDSUserDataHeader_t));
+        sessionCfg.u.swCfg.userBufferInfo[0].address = (uint32_t)&gSwUserData[0];
 
-        sessionCfg.u.swCfg.userBufferInfo[2].size    = HSIHeader_toCBUFFUnits(numObjOut * sizeof(DPIF_PointCloudSideInfo));
-        sessionCfg.u.swCfg.userBufferInfo[2].address = (uint32_t)objOutSideInfo;
+        /* Note size and addresses have defaulted to 0 due to memset zero initialization above */
+        if (numObj != 0U)
+        {
+            sessionCfg.u.swCfg.userBufferInfo[1].size    = HSIHeader_toCBUFFUnits(numObj * sizeof(DPIF_PointCloudCartesian));
+            sessionCfg.u.swCfg.userBufferInfo[1].address = (uint32_t)&gSwUserData[pointsOffset];
+
+            sessionCfg.u.swCfg.userBufferInfo[2].size    = HSIHeader_toCBUFFUnits(numObj * sizeof(DPIF_PointCloudSideInfo));
+            sessionCfg.u.swCfg.userBufferInfo[2].address = (uint32_t)&gSwUserData[sideOffset];
+        }
+    }
+    else
+    {
+        sessionCfg.u.swCfg.userBufferInfo[0].size    = HSIHeader_toCBUFFUnits(persist->batch.size);
+        sessionCfg.u.swCfg.userBufferInfo[0].address = (uint32_t)(persist->batch.buf);
     }
 
     /* Create the HSI Header to be used for the SW Session: */
     if (HSIHeader_createHeader (&sessionCfg, true, &(streamMcb->swSessionHSIHeader), &errCode) < 0)
     {
         /* Error: Unable to create the HSI Header; report the error */
-        test_print("Error: MmwDemo_LVDSStream_config unable to create HW HSI header with [Error=%d]\n", errCode);
+        test_print("Error: MmwDemo_LVDSStream_config unable to create SW HSI header with [Error=%d]\n", errCode);
         goto exit;
     }
     
@@ -857,17 +975,315 @@ int32_t MmwDemo_LVDSStreamSwConfig (uint32_t numObjOut,
     }
 
     /* Control comes here implies that the LVDS Stream has been configured successfully */
+    persist->swSessionNumObj = (int32_t)numObj;
     retVal = 0;
 
 exit:
     return retVal;
 }
 
+/**
+ *  @b Description
+ *  @n
+ *      Sets how many frames of s/w data go into one transfer of the s/w
+ *      session and how many points of a frame are streamed. Only called
+ *      while the sensor is stopped. One frame to a batch streams every
+ *      frame with the points it has. With more, the transfer is the whole
+ *      buffer for framesPerBatch frames of maxObj points whatever the
+ *      frames had, so maxObj is best set to the most points the scene is
+ *      expected to give.
+ *
+ *  @param[in]  framesPerBatch  Frames to a batch, 1 streams every frame as it comes
+ *  @param[in]  maxObj          Most points of a frame, more are cut off
+ *
+ *  @retval
+ *      Not applicable
+ */
+void MmwDemo_LVDSStreamSwBatchConfig (uint32_t framesPerBatch, uint32_t maxObj)
+{
+    if (framesPerBatch == 0U)
+    {
+        framesPerBatch = 1U;
+    }
+    if (framesPerBatch > MMWDEMO_LVDS_BATCH_MAX_FRAMES)
+    {
+        framesPerBatch = MMWDEMO_LVDS_BATCH_MAX_FRAMES;
+    }
+    if (maxObj > MMWDEMO_LVDS_SW_MAX_OBJ)
+    {
+        maxObj = MMWDEMO_LVDS_SW_MAX_OBJ;
+    }
+    gLVDSStreamPersist.framesPerBatch = framesPerBatch;
+    gLVDSStreamPersist.maxObj         = maxObj;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Most points of a frame the s/w session can stream.
+ *
+ *  @retval
+ *      Points
+ */
+uint32_t MmwDemo_LVDSStreamSwMaxObj (void)
+{
+    return (uint32_t)MMWDEMO_LVDS_SW_MAX_OBJ;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Sets up the sessions that are kept until the sensor stops: builds the
+ *      h/w session configuration of every sub-frame that streams h/w data and
+ *      creates the s/w session when any sub-frame streams s/w data.
+ *
+ *  @retval
+ *      Not applicable
+ */
+void MmwDemo_LVDSStreamStart (void)
+{
+    uint8_t  subFrameIndx;
+    uint8_t  numSubFrames = gMmwMssMCB.objDetCommonCfg.preStartCommonCfg.numSubFrames;
+    bool     isSwEnabled = false;
+
+    for (subFrameIndx = 0; subFrameIndx < numSubFrames; subFrameIndx++)
+    {
+        if (gMmwMssMCB.subFrameCfg[subFrameIndx].lvdsStreamCfg.dataFmt != MMW_DEMO_LVDS_STREAM_CFG_DATAFMT_DISABLED)
+        {
+            MmwDemo_LVDSStreamHwBuildCfg(subFrameIndx, &gLVDSStreamPersist.hwSessionCfg[subFrameIndx]);
+        }
+        if (gMmwMssMCB.subFrameCfg[subFrameIndx].lvdsStreamCfg.isSwEnabled)
+        {
+            isSwEnabled = true;
+        }
+    }
+
+    if ((isSwEnabled == true) && (gMmwMssMCB.lvdsStream.swSessionHandle == NULL))
+    {
+        MmwDemo_lvdsBatchInit(&gLVDSStreamPersist.batch, &gSwUserData[0],
+                              gLVDSStreamPersist.framesPerBatch, gLVDSStreamPersist.maxObj);
+        gLVDSStreamPersist.isSwStreaming   = false;
+        gLVDSStreamPersist.numBatches      = 0U;
+        gLVDSStreamPersist.swSessionNumObj = -1;
+        if (MmwDemo_LVDSStreamSwCreate(0U) < 0)
+        {
+            test_print("Failed LVDS stream SW configuration\n");
+            MmwDemo_debugAssert(0);
+        }
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Waits for the s/w session to finish streaming a batch, if it is, and
+ *      starts the next batch. Generally this does not wait, a batch streams
+ *      out well before the next frame is done.
+ *
+ *  @retval
+ *      Not applicable
+ */
+void MmwDemo_LVDSStreamSwWait (void)
+{
+    MmwDemo_LVDSStreamPersist *persist = &gLVDSStreamPersist;
+
+    if (persist->isSwStreaming == true)
+    {
+        SemaphoreP_pend(&gMmwMssMCB.lvdsStream.swFrameDoneSemHandle, SystemP_WAIT_FOREVER);
+        persist->isSwStreaming = false;
+        if (persist->framesPerBatch > 1U)
+        {
+            MmwDemo_lvdsBatchNext(&persist->batch);
+        }
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Streams the first bytes of the s/w user buffer, the batch or the
+ *      frame the session was created for.
+ *
+ *  @param[in]  numBytes    Bytes written into the user buffer
+ *
+ *  @retval
+ *      Not applicable
+ */
+static void MmwDemo_LVDSStreamSwSend (uint32_t numBytes)
+{
+    MmwDemo_LVDSStreamPersist *persist = &gLVDSStreamPersist;
+    int32_t errCode;
+
+    /* The EDMA reads the buffer from memory */
+    CacheP_wb((void *)&gSwUserData[0], numBytes, CacheP_TYPE_ALLD);
+
+    persist->isSwStreaming = true;
+    persist->numBatches++;
+    if (CBUFF_activateSession (gMmwMssMCB.lvdsStream.swSessionHandle, &errCode) < 0)
+    {
+        test_print("Failed to activate CBUFF session for LVDS stream SW. errCode=%d\n", errCode);
+        MmwDemo_debugAssert(0);
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Streams the s/w data of a frame on its own, with one frame to a
+ *      batch: the user data header, the points and the side info back to
+ *      back in the user buffer, streamed as three user buffers of exactly
+ *      the size the frame needs.
+ *
+ *  @param[in]  subFrameIndx    Index of sub-frame
+ *  @param[in]  frameNum        Frame number
+ *  @param[in]  numObj          Number of detected objects, more than maxObj are cut off
+ *  @param[in]  objOut          Detected objects point cloud
+ *  @param[in]  objOutSideInfo  Detected objects side information
+ *
+ *  @retval
+ *      Not applicable
+ */
+static void MmwDemo_LVDSStreamSwSendFrame (uint8_t subFrameIndx, uint32_t frameNum, uint32_t numObj,
+                                           const void *objOut, const void *objOutSideInfo)
+{
+    MmwDemo_LVDSStreamPersist *persist = &gLVDSStreamPersist;
+    MmwDemo_LVDSUserDataHeader_t *userDataHeader = (MmwDemo_LVDSUserDataHeader_t *)&gSwUserData[0];
+    uint32_t pointsOffset = sizeof(MmwDemo_LVDSUserDataHeader_t);
+    uint32_t sideOffset;
+
+    if (numObj > persist->maxObj)
+    {
+        persist->batch.numCut += numObj - persist->maxObj;
+        numObj = persist->maxObj;
+    }
+    sideOffset = pointsOffset + (numObj * sizeof(DPIF_PointCloudCartesian));
+
+    /* Populate user data header that will be streamed out*/
+    userDataHeader->frameNum    = frameNum;
+    userDataHeader->detObjNum   = (uint16_t)numObj;
+    userDataHeader->subFrameNum = (uint16_t)subFrameIndx;
+    memcpy(&gSwUserData[pointsOffset], objOut, numObj * sizeof(DPIF_PointCloudCartesian));
+    memcpy(&gSwUserData[sideOffset], objOutSideInfo, numObj * sizeof(DPIF_PointCloudSideInfo));
+
+    /* The user buffer sizes are part of the session and its HSI header */
+    if (persist->swSessionNumObj != (int32_t)numObj)
+    {
+        MmwDemo_LVDSStreamDeleteSwSession();
+        if (MmwDemo_LVDSStreamSwCreate(numObj) < 0)
+        {
+            test_print("Failed LVDS stream SW configuration\n");
+            MmwDemo_debugAssert(0);
+        }
+    }
+
+    MmwDemo_LVDSStreamSwSend(sideOffset + (numObj * sizeof(DPIF_PointCloudSideInfo)));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Adds the s/w data of a frame to the batch and streams the batch once
+ *      it has framesPerBatch frames, or streams the frame on its own with
+ *      one frame to a batch. Called after the h/w session of the frame is
+ *      done.
+ *
+ *  @param[in]  subFrameIndx    Index of sub-frame
+ *  @param[in]  frameNum        Frame number
+ *  @param[in]  numObjOut       Number of detected objects to stream out
+ *  @param[in]  objOut          Detected objects point cloud
+ *  @param[in]  objOutSideInfo  Detected objects side information
+ *
+ *  @retval
+ *      Not applicable
+ */
+void MmwDemo_transferLVDSUserData (uint8_t subFrameIndx, uint32_t frameNum, uint32_t numObjOut,
+                                   const void *objOut, const void *objOutSideInfo)
+{
+    MmwDemo_LVDSStreamPersist *persist = &gLVDSStreamPersist;
+    int32_t errCode;
+
+    if (gMmwMssMCB.lvdsStream.swSessionHandle == NULL)
+    {
+        return;
+    }
+
+    /* The buffer is only written once the last batch is out */
+    MmwDemo_LVDSStreamSwWait();
+
+    if (persist->framesPerBatch == 1U)
+    {
+        MmwDemo_LVDSStreamSwSendFrame(subFrameIndx, frameNum, numObjOut, objOut, objOutSideInfo);
+    }
+    else if (MmwDemo_lvdsBatchAdd(&persist->batch, frameNum, subFrameIndx, numObjOut, objOut, objOutSideInfo) == 1)
+    {
+        MmwDemo_LVDSStreamSwSend(sizeof(MmwDemo_lvdsBatchHdr) + ((MmwDemo_lvdsBatchHdr *)persist->batch.buf)->length);
+    }
+    else if ((gMmwMssMCB.objDetCommonCfg.preStartCommonCfg.numSubFrames == 1) &&
+             (gMmwMssMCB.lvdsStream.hwSessionHandle != NULL))
+    {
+        /* The h/w session deactivated itself for the s/w session; nothing
+         * streams this frame, so activate it as the s/w completion would */
+        if (CBUFF_activateSession (gMmwMssMCB.lvdsStream.hwSessionHandle, &errCode) < 0)
+        {
+            test_print("Failed to activate CBUFF session for LVDS stream HW. errCode=%d\n", errCode);
+            MmwDemo_debugAssert(0);
+        }
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Streams what is left of the last batch and deletes the s/w session.
+ *      Called at stop once the h/w session is deleted.
+ *
+ *  @retval
+ *      Not applicable
+ */
+void MmwDemo_LVDSStreamSwStop (void)
+{
+    if (gMmwMssMCB.lvdsStream.swSessionHandle == NULL)
+    {
+        return;
+    }
+
+    MmwDemo_LVDSStreamSwWait();
+    if ((gLVDSStreamPersist.framesPerBatch > 1U) && (MmwDemo_lvdsBatchNumFrames(&gLVDSStreamPersist.batch) != 0U))
+    {
+        MmwDemo_LVDSStreamSwSend(sizeof(MmwDemo_lvdsBatchHdr) +
+                                 ((MmwDemo_lvdsBatchHdr *)gLVDSStreamPersist.batch.buf)->length);
+        MmwDemo_LVDSStreamSwWait();
+    }
+
+    /* S/w session never needs to be deactivated because it always
+     * (unconditionally) deactivates itself upon completion */
+    MmwDemo_LVDSStreamDeleteSwSession();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Returns the batches the s/w session streamed and the points cut off
+ *      because a frame had more than a batch takes.
+ *
+ *  @param[out] numBatches      Batches streamed
+ *  @param[out] numCut          Points cut off
+ *
+ *  @retval
+ *      Not applicable
+ */
+void MmwDemo_LVDSStreamGetSwStats (uint32_t *numBatches, uint32_t *numCut)
+{
+    *numBatches = gLVDSStreamPersist.numBatches;
+    *numCut     = gLVDSStreamPersist.batch.numCut;
+}
+
 /**
 *  @b Description
 *  @n
-*      High level API for configuring Hw session. Deletes h/w session if it exists,
-*      configures desired configuration input and activates the h/w session
+*      High level API for configuring Hw session. Keeps the h/w session when
+*      it was created for the same configuration, else deletes it and
+*      creates it for the sub-frame, then activates it.
 *  @param[in]  subFrameIndx Index of sub-frame
 *
 *  @retval
@@ -876,15 +1292,25 @@ exit:
 void MmwDemo_configLVDSHwData(uint8_t subFrameIndx)
 {
     int32_t retVal;
-
-    /* Delete previous CBUFF HW session if one was configured */
-    if(gMmwMssMCB.lvdsStream.hwSessionHandle != NULL)
+    int8_t  liveSubFrame = gLVDSStreamPersist.hwSessionSubFrame;
+
+    /* Only one session can be active, let the s/w data of the last sub-frame go first */
+    MmwDemo_LVDSStreamSwWait();
+
+    /* Delete previous CBUFF HW session if it streams another configuration */
+    if((gMmwMssMCB.lvdsStream.hwSessionHandle != NULL) &&
+       ((liveSubFrame < 0) ||
+        (gMmwMssMCB.subFrameCfg[liveSubFrame].lvdsStreamCfg.isHeaderEnabled !=
+         gMmwMssMCB.subFrameCfg[subFrameIndx].lvdsStreamCfg.isHeaderEnabled) ||
+        (memcmp((void *)&gLVDSStreamPersist.hwSessionCfg[liveSubFrame],
+                (void *)&gLVDSStreamPersist.hwSessionCfg[subFrameIndx],
+                sizeof(CBUFF_SessionCfg)) != 0)))
     {
         MmwDemo_LVDSStreamDeleteHwSession();
     }
 
     /* Configure HW session */
-    if (MmwDemo_LVDSStreamHwConfig(subFrameIndx) < 0)
+    if((gMmwMssMCB.lvdsStream.hwSessionHandle == NULL) && (MmwDemo_LVDSStreamHwConfig(subFrameIndx) < 0))
     {
         test_print("Failed LVDS stream HW configuration\n");
         MmwDemo_debugAssert(0);
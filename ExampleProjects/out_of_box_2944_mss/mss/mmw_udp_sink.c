@@ -0,0 +1,325 @@
+/**
+ *   @file  mmw_udp_sink.c
+ *
+ *   @brief
+ *      Sends the output packets over UDP.
+ *
+ *      The data export task writes every packet into a ring of MTU sized
+ *      datagrams (mmw_udp_batch.h) and returns, a packet the ring cannot
+ *      take is dropped whole. The datagram being filled is handed on after
+ *      framesPerBatch packets, when it is full, when its first packet is
+ *      MMWDEMO_UDP_SINK_MAX_AGE_MS old, and when the sensor stops or the
+ *      sink is configured again. The UDP sink task sends what was handed
+ *      on to the host set with enetStreamCfg. So a slow network costs
+ *      frames of output, never frames of processing.
+ *      HostTools/udp_sink_test.c receives it.
+ */
+
+/**************************************************************************
+ *************************** Include Files ********************************
+ **************************************************************************/
+#ifdef ENET_STREAM
+
+#include <stdint.h>
+#include <string.h>
+
+/* MCU Plus Include Files. */
+#include <kernel/dpl/SemaphoreP.h>
+#include <kernel/dpl/ClockP.h>
+#include <kernel/dpl/DebugP.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lwip/api.h"
+
+/* MMWAVE Demo Include Files, the ones in ../include ahead of mmw_mss.h */
+#include "mmw_output_sink.h"
+#include "mmw_udp_batch.h"
+#include <ti/demo/awr294x/mmw/mss/mmw_mss.h>
+
+extern MmwDemo_MSS_MCB    gMmwMssMCB;
+
+/* Datagrams in the ring, a power of 2, 94 KB hold a full heatmap and then some */
+#define MMWDEMO_UDP_SINK_NUM_DGRAMS         (64U)
+
+#define MMWDEMO_UDP_SINK_TASK_STACK_SIZE    (2*1024U)
+
+/* Time between checks whether the link is up */
+#define MMWDEMO_UDP_SINK_LINK_POLL_MS       (100U)
+
+/* Longest a packet waits in a batch that is not full yet */
+#define MMWDEMO_UDP_SINK_MAX_AGE_MS         (100U)
+
+static int32_t MmwDemo_udpSinkSend(void *handle, const uint8_t * const *segBuf, const uint32_t *segLen,
+                                   uint32_t numSegments, uint32_t packetLen,
+                                   MmwDemo_outputSinkDoneFxn done, void *doneArg);
+
+/**
+ * @brief
+ *  UDP sink.
+ */
+typedef struct MmwDemo_udpSink_t
+{
+    /*! @brief   Ring written by the data export task */
+    MmwDemo_udpBatch    batch;
+
+    /*! @brief   Posted when datagrams are handed on */
+    SemaphoreP_Object   dgramSemHandle;
+
+    /*! @brief   Guards the writer side of the ring and the batch count, the
+     *           UDP sink task and sensor stop flush it too */
+    SemaphoreP_Object   writeLockHandle;
+
+    /*! @brief   Destination port */
+    uint16_t            port;
+
+    /*! @brief   Packets to a batch */
+    uint32_t            framesPerBatch;
+
+    /*! @brief   Packets written since the last batch */
+    uint32_t            framesInBatch;
+
+    /*! @brief   When the first packet of the batch was written, usec */
+    uint64_t            batchStartTime;
+
+    /*! @brief   Datagrams sent */
+    volatile uint32_t   numSent;
+
+    /*! @brief   Task */
+    TaskHandle_t        task;
+    StaticTask_t        taskObj;
+} MmwDemo_udpSink;
+
+static MmwDemo_udpSink gMmwUdpSinkObj;
+static MmwDemo_udpDgram gMmwUdpSinkRing[MMWDEMO_UDP_SINK_NUM_DGRAMS] __attribute__((aligned(32)));
+static StackType_t gMmwUdpSinkTskStack[MMWDEMO_UDP_SINK_TASK_STACK_SIZE] __attribute__((aligned(32)));
+
+MmwDemo_outputSink gMmwUdpSink = {"udp", MmwDemo_udpSinkSend, &gMmwUdpSinkObj};
+
+/**
+ *  @b Description
+ *  @n
+ *      Hands on the batch being filled, a partial one included, and wakes
+ *      the UDP sink task. Called with the write lock held.
+ *
+ *  @param[in]  sink            UDP sink
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_udpSinkFlushLocked(MmwDemo_udpSink *sink)
+{
+    uint32_t head = sink->batch.head;
+
+    MmwDemo_udpBatchFlush(&sink->batch);
+    if (sink->batch.head != head)
+    {
+        SemaphoreP_post(&sink->dgramSemHandle);
+    }
+
+    /* With the ring full the datagram stays, and is tried again when older */
+    if (sink->batch.dgram[sink->batch.head % sink->batch.numDgrams].hdr.length == 0U)
+    {
+        sink->framesInBatch = 0U;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Output sink send function of the UDP sink, called from the data
+ *      export task. Copies the packet into the ring, so it is done with
+ *      the segments before it returns.
+ *
+ *  @retval
+ *      0 when queued, -1 when the ring was full and the packet is dropped
+ */
+static int32_t MmwDemo_udpSinkSend(void *handle, const uint8_t * const *segBuf, const uint32_t *segLen,
+                                   uint32_t numSegments, uint32_t packetLen,
+                                   MmwDemo_outputSinkDoneFxn done, void *doneArg)
+{
+    MmwDemo_udpSink *sink = (MmwDemo_udpSink *)handle;
+    uint32_t head;
+    int32_t retVal;
+
+    SemaphoreP_pend(&sink->writeLockHandle, SystemP_WAIT_FOREVER);
+    head = sink->batch.head;
+    retVal = MmwDemo_udpBatchWrite(&sink->batch, segBuf, segLen, numSegments, packetLen);
+
+    if (sink->framesInBatch == 0U)
+    {
+        sink->batchStartTime = ClockP_getTimeUsec();
+    }
+    sink->framesInBatch++;
+    if (sink->framesInBatch >= sink->framesPerBatch)
+    {
+        MmwDemo_udpBatchFlush(&sink->batch);
+        sink->framesInBatch = 0U;
+    }
+    if (sink->batch.head != head)
+    {
+        SemaphoreP_post(&sink->dgramSemHandle);
+    }
+    SemaphoreP_post(&sink->writeLockHandle);
+
+    /* Last, the export task may go on to stop the sensor once it is called */
+    done(doneArg);
+    return retVal;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      UDP sink task. Waits for the link, then sends every datagram handed
+ *      on and gives it back to the ring. Hands on a batch whose first
+ *      packet waited MMWDEMO_UDP_SINK_MAX_AGE_MS, so a slow frame rate
+ *      with many frames to a batch does not hold packets back.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_udpSinkTask(void *args)
+{
+    MmwDemo_udpSink *sink = (MmwDemo_udpSink *)args;
+    const MmwDemo_udpDgram *dgram;
+    struct netconn *conn;
+    struct netbuf *buf;
+    void *payload;
+    uint32_t len;
+
+    /* enetTask brings the link up */
+    while (gMmwMssMCB.enetCfg.status != 1)
+    {
+        ClockP_usleep(MMWDEMO_UDP_SINK_LINK_POLL_MS * 1000U);
+    }
+    conn = netconn_new(NETCONN_UDP);
+    DebugP_assert(conn != NULL);
+
+    while (1)
+    {
+        SemaphoreP_pend(&sink->dgramSemHandle, ClockP_usecToTicks(MMWDEMO_UDP_SINK_MAX_AGE_MS * 1000U));
+
+        SemaphoreP_pend(&sink->writeLockHandle, SystemP_WAIT_FOREVER);
+        if ((sink->framesInBatch > 0U) &&
+            ((ClockP_getTimeUsec() - sink->batchStartTime) >= (MMWDEMO_UDP_SINK_MAX_AGE_MS * 1000U)))
+        {
+            MmwDemo_udpSinkFlushLocked(sink);
+        }
+        SemaphoreP_post(&sink->writeLockHandle);
+
+        while ((dgram = MmwDemo_udpBatchNext(&sink->batch)) != NULL)
+        {
+            len = sizeof(dgram->hdr) + dgram->hdr.length;
+
+            /* Copied, the driver may still hold the pbuf after sendto returns */
+            buf = netbuf_new();
+            if (buf != NULL)
+            {
+                payload = netbuf_alloc(buf, (u16_t)len);
+                if (payload != NULL)
+                {
+                    memcpy(payload, dgram, len);
+                    if (netconn_sendto(conn, buf, &gMmwMssMCB.enetCfg.remoteIp, sink->port) == ERR_OK)
+                    {
+                        sink->numSent++;
+                    }
+                }
+                netbuf_delete(buf);
+            }
+            MmwDemo_udpBatchRelease(&sink->batch);
+        }
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Sets up the UDP sink and starts its task. It sends nothing until
+ *      outputSinkCfg selects it.
+ *
+ *  @param[in] taskPriority     Priority of the UDP sink task
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_udpSinkInit(uint32_t taskPriority)
+{
+    MmwDemo_udpSink *sink = &gMmwUdpSinkObj;
+
+    memset(sink, 0, sizeof(*sink));
+    MmwDemo_udpBatchInit(&sink->batch, gMmwUdpSinkRing, MMWDEMO_UDP_SINK_NUM_DGRAMS);
+    sink->port           = MMWDEMO_UDP_SINK_PORT;
+    sink->framesPerBatch = 1U;
+    SemaphoreP_constructBinary(&sink->dgramSemHandle, 0);
+    SemaphoreP_constructMutex(&sink->writeLockHandle);
+
+    sink->task = xTaskCreateStatic(MmwDemo_udpSinkTask,
+                                   "udp_sink_task",
+                                   MMWDEMO_UDP_SINK_TASK_STACK_SIZE,
+                                   sink,
+                                   taskPriority,
+                                   gMmwUdpSinkTskStack,
+                                   &sink->taskObj);
+    configASSERT(sink->task != NULL);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Sets the destination port and how many frames go into a batch.
+ *      Only called while the sensor is stopped, a partial batch still
+ *      waiting is handed on first.
+ *
+ *  @param[in] port             Destination port
+ *  @param[in] framesPerBatch   Packets to a batch, 1 sends every frame as it comes
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_udpSinkConfig(uint16_t port, uint32_t framesPerBatch)
+{
+    MmwDemo_udpSink *sink = &gMmwUdpSinkObj;
+
+    MmwDemo_udpSinkFlush();
+
+    SemaphoreP_pend(&sink->writeLockHandle, SystemP_WAIT_FOREVER);
+    sink->port           = port;
+    sink->framesPerBatch = (framesPerBatch == 0U) ? 1U : framesPerBatch;
+    SemaphoreP_post(&sink->writeLockHandle);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Hands on a partial batch, so the last frames before the sensor
+ *      stops are not held back until it starts again.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_udpSinkFlush(void)
+{
+    MmwDemo_udpSink *sink = &gMmwUdpSinkObj;
+
+    SemaphoreP_pend(&sink->writeLockHandle, SystemP_WAIT_FOREVER);
+    MmwDemo_udpSinkFlushLocked(sink);
+    SemaphoreP_post(&sink->writeLockHandle);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Returns the datagrams sent and the packets dropped because the ring was full.
+ *
+ *  @param[out] numSent         Datagrams sent
+ *  @param[out] numDropped      Packets dropped
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_udpSinkGetStats(uint32_t *numSent, uint32_t *numDropped)
+{
+    *numSent    = gMmwUdpSinkObj.numSent;
+    *numDropped = gMmwUdpSinkObj.batch.numDropped;
+}
+
+#endif /* ENET_STREAM */
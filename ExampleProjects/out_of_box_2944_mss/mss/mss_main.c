@@ -129,7 +129,10 @@
  *      with DPM.
  *    - @ref mmwDemo_mssUartDataExportTask. This task is used to export the data on UART. This task
  *      pends for @ref MmwDemo_MSS_MCB_t::UartExportSemHandle in an endless loop, which is posted when current frame
- *      processing and previous frame's uart transmission is completed.
+ *      processing is completed. It builds the output packet and hands it to the output sink.
+ *    - @ref MmwDemo_uartSinkTask. This task writes the output packets handed to the UART sink to the
+ *      logging UART. Once the last byte of a packet is out it releases the result slot of its frame,
+ *      so the data export task never waits for the UART.
  *
  *    **DSS**
  *    - @ref MmwDemo_initTask. This task is created/launched by @ref main and is a
@@ -383,6 +386,47 @@
  *       values in @ref MmwDemo_temperatureStats_t::temperatureReport are valid else they should
  *       be ignored. This TLV is sent along with Stats TLV described in @ref tlv6
  *
+ *      @subsection tlv10 DSP stage timing
+ *       Type: (@ref MMWDEMO_OUTPUT_MSG_STAGE_TIMING)
+ *
+ *       Length: (size of @ref MmwDemo_output_message_stageTiming_t)
+ *
+ *       Value: Min, mean, 99th percentile and max DSP cycles of every processing
+ *       stage in @ref MmwDemo_output_stage_e, over the last finished window of frames.
+ *       The DSP publishes a new summary every window and
+ *       @ref MmwDemo_output_message_stageTiming_t::windowIndex counts them, it is 0
+ *       until the first window is done. This TLV is sent along with Stats TLV
+ *       described in @ref tlv6 when the DSS reports it.
+ *
+ *      @subsection tlv11 Compressed list of detected objects
+ *       Type: (@ref MMWDEMO_OUTPUT_MSG_COMPRESSED_POINTS)
+ *
+ *       Length: (size of @ref MmwDemo_output_message_compressedPointUnit_t) +
+ *       (Number of detected objects) x (size of @ref MmwDemo_output_message_compressedPoint_t)
+ *
+ *       Value: The units of the frame followed by the detected objects with
+ *       their side information, 10 bytes each instead of 20. A value in
+ *       meters, m/s or dB is the field times its unit. The units are picked
+ *       every frame so the largest value of the frame fills its field. Sent
+ *       instead of @ref tlv1 and @ref tlv7 when detectedObjects of guiMonitor
+ *       is 3. When the number of detected objects is zero, this TLV item is not sent.
+ *
+ *      @subsection tlv12 Compressed range/Doppler heatmap
+ *       Type: (@ref MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED)
+ *
+ *       Length: (size of @ref MmwDemo_heatMapCompressedHdr_t) + bytes of the residual stream
+ *
+ *       Value: The detection matrix of @ref tlv5, compressed as described in
+ *       mmw_heatmap_codec.h. Sent instead of @ref tlv5 when rangeDopplerHeatMap
+ *       of guiMonitor is 2 or more, 2 is lossless and every level above
+ *       doubles the error allowed. A heatmap that is not a key frame is sent
+ *       as the change from the one before, a host decodes it only when it has
+ *       decoded the one with the seq before. Key frames come every
+ *       @ref MMWDEMO_HEATMAP_KEY_FRAME_INTERVAL heatmaps and whenever the
+ *       sub-frame or size changes. A heatmap that does not get smaller is
+ *       sent as @ref tlv5 and the next one is a key frame. HostTools/heatmap_dec.c
+ *       decodes it.
+ *
  *  @section Calibration_section Range Bias (only supported in TDM) and Rx Channel Gain/Phase Measurement and Compensation
  *
  *     Because of imperfections in antenna layouts on the board, RF delays in SOC, etc,
@@ -499,25 +543,36 @@
  *      @ref MmwDemo_BoardInit function for register configuration related to HSI clock.
  *    -# EDMA channel resources for CBUFF/LVDS are in the global resource file
  *      (mmw_res.h, see @ref resourceAlloc) along with other EDMA resource allocation.
- *      The user data header and two user payloads are configured as three user buffers in the CBUFF driver.
- *      Hence SW allocation for EDMA provides for three sets of EDMA resources as seen in
- *      the SW part (swSessionEDMAChannelTable[.]) of @ref MmwDemo_LVDSStream_EDMAInit.
+ *      The SW data goes out of one user buffer laid out as in mmw_lvds_batch.h, the
+ *      SW part (swSessionEDMAChannelTable[.]) of @ref MmwDemo_LVDSStream_EDMAInit
+ *      has room for up to three.
  *    -# Although the CBUFF driver is configured for two sessions (hw and sw),
  *      at any time only one can be active. So depending on the LVDS CLI configuration
  *      and whether advanced frame or not, there is logic to activate/deactivate
  *      HW and SW sessions as necessary.
- *    -# The CBUFF session (HW/SW) configure-create and delete
- *      depends on whether or not re-configuration is required after the
- *      first time configuration.
- *      -# For HW session, re-configuration is done during sub-frame switching to
- *        re-configure for the next sub-frame but when there is no advanced frame
- *        (number of sub-frames = 1), the HW configuration does not need to
- *        change so HW session does not need to be re-created.
- *    -# SW-trigger-based streaming is not supported in the current release.
+ *    -# The CBUFF sessions are set up at sensor start and deleted at stop,
+ *      nothing is created or deleted between frames unless a sub-frame needs it.
+ *      -# The HW session configuration of every sub-frame is built at start. On a
+ *        sub-frame switch the HW session is only re-created when the next sub-frame
+ *        streams with another configuration, otherwise it is activated again as it is.
+ *        When there is no advanced frame (number of sub-frames = 1) it is never re-created.
+ *      -# The SW session streams the point cloud and side info of the frames.
+ *        By default every frame goes out on its own as in the SDK demo: the
+ *        MmwDemo_LVDSUserDataHeader_t, the points and the side info, 8 + 20 * numObj
+ *        bytes. The session is only created again when a frame has another number
+ *        of points than the one before.
+ *        lvdsBatchCfg can put more frames into a batch streamed from a buffer at a
+ *        fixed address laid out as in mmw_lvds_batch.h, so the session is created
+ *        once and every frame only copies its data in. The session is activated once
+ *        the batch is full, what is left at stop goes out then. The whole buffer
+ *        streams every batch however few points the frames had, that is
+ *        16 + framesPerBatch * (8 + 20 * maxObj) bytes, and it must stream out
+ *        within a frame period. lvdsBatchCfg also sets the most points of a frame
+ *        (as many as a DSS result slot holds by default), more are cut off.
  *
  *    The following figure shows a timing diagram for the LVDS streaming
  *    (the figure is not to scale as actual durations will vary based on configuration).
- *    Note: SW streaming is not supported in the current version of the demo.
+ *    Note: the figure does not show the SW session.
  *
  *      @image html lvdstiming.png "LVDS timing diagram"
  *
@@ -547,6 +602,19 @@
  *    -# It must be noted that the LwIP stack requires extra memory (L3 RAM), and care must be taken to
  *       ensure that the demo L3 requirements do not result in higher L3 memory usage than what is available.
  *
+ *   @subsection enetUdpSink UDP output sink
+ *
+ *    The output packets that normally go out of the logging UART (see @ref output) can go over UDP
+ *    instead, to the remote IP of enetStreamCfg, which keeps heatmaps on at full frame rate.
+ *    The CLI command "outputSinkCfg <sink> <udpPort> <framesPerBatch>" selects it, sink 0 is the UART
+ *    and 1 is UDP. The packets are written one after the other into datagrams of 1472 bytes, each
+ *    with a sequence number and where the first packet in it starts (see mmw_udp_batch.h), and
+ *    the datagrams are sent by their own task, udp_sink_task. framesPerBatch packets go into a batch
+ *    before the last datagram is sent part filled, a batch also goes when its first packet is 100 ms
+ *    old and when the sensor stops. A packet that does not fit in the 64 datagrams
+ *    waiting to be sent is dropped. HostTools/udp_sink_test.c listen receives them and writes the
+ *    packets to a file as the UART would have sent them.
+ *
  *  @section bypassCLI How to bypass CLI
  *
  *    Re-implement the file mmw_cli.c as follows:
@@ -674,8 +742,13 @@
 #include <ti/utils/mathutils/mathutils.h>
 #include <ti/utils/testlogger/logger.h>
 
-/* Demo Include Files */
-#include <ti/demo/awr294x/mmw/include/mmw_config.h>
+/* Demo Include Files, the ones in ../include first so they take the place
+ * of the SDK copies the demo headers include */
+#include "mmw_config.h"
+#include "mmw_output.h"
+#include "mmw_heatmap_codec.h"
+#include "mmw_output_sink.h"
+#include "mmw_lvds_batch.h"
 #include <ti/demo/utils/mmwdemo_rfparser.h>
 #include <ti/demo/utils/mmwdemo_adcconfig.h>
 #include <ti/demo/utils/mmwdemo_monitor.h>
@@ -686,7 +759,6 @@
 #include <ti/demo/awr294x/mmw/mmw_resDDM.h>
 #endif
 #include <ti/demo/awr294x/mmw/mss/mmw_mss.h>
-#include <ti/demo/awr294x/mmw/include/mmw_output.h>
 #include <ti/board/antenna_geometry.h>
 #include <ti/demo/utils/mmwdemo_flash.h>
 
@@ -707,12 +779,15 @@
 /* Demo tasks should have priority higher than enet/lwip tasks */
 #ifdef ENET_STREAM
 #define MMWDEMO_CLI_TASK_PRIORITY                 7
+#define MMWDEMO_UART_TX_TASK_PRIORITY             8
 #define MMWDEMO_UART_EXPORT_TASK_PRIORITY         8
 #define MMWDEMO_DPC_OBJDET_DPM_TASK_PRIORITY      9
 #define MMWDEMO_MMWAVE_CTRL_TASK_PRIORITY         10
 #define MMWDEMO_MMWAVE_ENET_TASK_PRIORITY         1
+#define MMWDEMO_UDP_SINK_TASK_PRIORITY            2
 #else
 #define MMWDEMO_CLI_TASK_PRIORITY                 3
+#define MMWDEMO_UART_TX_TASK_PRIORITY             4
 #define MMWDEMO_UART_EXPORT_TASK_PRIORITY         4
 #define MMWDEMO_DPC_OBJDET_DPM_TASK_PRIORITY      5
 #define MMWDEMO_MMWAVE_CTRL_TASK_PRIORITY         6
@@ -742,6 +817,7 @@ extern SemaphoreP_Object objDataSemaphoreHandle;
 /* Variable to store detected object data for ethernet streaming */
 MmwDemo_enetStreamObjData gEnetStreamObjData;
 #endif
+
 /**************************************************************************
  *************************** Global Definitions ***************************
  **************************************************************************/
@@ -752,6 +828,7 @@ MmwDemo_enetStreamObjData gEnetStreamObjData;
 #define MMWDEMO_MMWAVE_CTRL_TASK_STACK_SIZE (3*1024U)
 #define MMWDEMO_DPC_OBJDET_DPM_TASK_STACK_SIZE (4*1024U)
 #define MMWDEMO_UART_DATA_EXPORT_TASK_STACK_SIZE (4*1024U)
+#define MMWDEMO_UART_TX_TASK_STACK_SIZE (2*1024U)
 #ifdef ENET_STREAM
 #define MMWDEMO_MMWAVE_ENET_TASK_STACK_SIZE (4*1024U)
 #endif
@@ -761,6 +838,7 @@ StackType_t gAppMainTskStack[MMWDEMO_INIT_TASK_STACK_SIZE] __attribute__((aligne
 StackType_t gMmwCtrlTskStack[MMWDEMO_MMWAVE_CTRL_TASK_STACK_SIZE] __attribute__((aligned(32)));
 StackType_t gDpmTskStack[MMWDEMO_DPC_OBJDET_DPM_TASK_STACK_SIZE] __attribute__((aligned(32)));
 StackType_t gUartTskStack[MMWDEMO_UART_DATA_EXPORT_TASK_STACK_SIZE] __attribute__((aligned(32)));
+StackType_t gUartTxTskStack[MMWDEMO_UART_TX_TASK_STACK_SIZE] __attribute__((aligned(32)));
 #ifdef ENET_STREAM
 StackType_t gMmwEnetTskStack[MMWDEMO_MMWAVE_ENET_TASK_STACK_SIZE] __attribute__((aligned(32)));
 #endif
@@ -783,7 +861,7 @@ MmwDemo_MSS_MCB    gMmwMssMCB;
  * @brief
  *  Global Variable for HSRAM buffer used to share results to remote
  */
-MmwDemo_HSRAM gHSRAM __attribute__((aligned(64U), section(".demoSharedMem")));
+MmwDemo_HSRAM gHSRAM __attribute__((aligned(MMWDEMO_HSRAM_LINE_SIZE), section(".demoSharedMem")));
 
 
 /* Calibration Data Save/Restore defines */
@@ -812,6 +890,7 @@ static int32_t MmwDemo_dataPathConfig (void);
 static void MmwDemo_dataPathStart (void);
 static void MmwDemo_dataPathStop (void);
 void MmwDemo_handleObjectDetResult(void);
+static void MmwDemo_releaseResultSlot(DPC_ObjectDetection_ExecuteResult *dpcResults);
 static void MmwDemo_DPC_ObjectDetection_reportFxn
 (
     DPM_Report  reportType,
@@ -822,10 +901,18 @@ static void MmwDemo_DPC_ObjectDetection_reportFxn
 );
 static void MmwDemo_transmitProcessedOutput
 (
-    UART_Handle     uartHandle,
+    const MmwDemo_outputSink            *sink,
     DPC_ObjectDetection_ExecuteResult   *result,
-    MmwDemo_output_message_stats        *timingInfo
+    MmwDemo_output_message_stats        *timingInfo,
+    MmwDemo_output_message_stageTiming  *stageTiming,
+    MmwDemo_outputSinkDoneFxn           done,
+    void                                *doneArg
 );
+static int32_t MmwDemo_uartSinkSend(void *handle, const uint8_t * const *segBuf, const uint32_t *segLen,
+                                    uint32_t numSegments, uint32_t packetLen,
+                                    MmwDemo_outputSinkDoneFxn done, void *doneArg);
+static void MmwDemo_outputPktDone(void *arg);
+static void MmwDemo_outputWait(void);
 
 static void MmwDemo_measurementResultOutput(void* compRxChanCfg);
 #ifdef MMWDEMO_TDM
@@ -865,6 +952,57 @@ static int32_t MmwDemo_calibSave(MmwDemo_calibDataHeader *ptrCalibDataHdr, MmwDe
 static int32_t MmwDemo_calibRestore(MmwDemo_calibData  *calibrationData);
 
 volatile uint32_t transmitStartTime =0;
+
+/**
+ * @brief
+ *  UART sink. Its task writes the packet handed over to the logging UART,
+ *  one packet at a time.
+ */
+typedef struct MmwDemo_uartSink_t
+{
+    /*! @brief   Posted when a packet is handed over */
+    SemaphoreP_Object           txSemHandle;
+
+    /*! @brief   Segments of the packet being sent */
+    const uint8_t * const       *segBuf;
+    const uint32_t              *segLen;
+    uint32_t                    numSegments;
+
+    /*! @brief   Called once the packet is out, NULL when the sink is idle */
+    MmwDemo_outputSinkDoneFxn   done;
+    void                        *doneArg;
+
+    /*! @brief   Task */
+    TaskHandle_t                task;
+    StaticTask_t                taskObj;
+} MmwDemo_uartSink;
+
+static MmwDemo_uartSink gMmwUartSinkObj;
+
+/* Output sinks, the UART one writes to whatever UART1 handle is current */
+MmwDemo_outputSink gMmwUartSink = {"uart", MmwDemo_uartSinkSend, &gMmwUartSinkObj};
+MmwDemo_outputSink *gMmwOutputSink = &gMmwUartSink;
+
+/**
+ * @brief
+ *  Output packet handed to the sink and not sent yet.
+ */
+typedef struct MmwDemo_outputInFlight_t
+{
+    /*! @brief   Result of the frame, its slot is held until the packet is out */
+    DPC_ObjectDetection_ExecuteResult   *result;
+
+    /*! @brief   Stats of the sub-frame, transmitOutputTime is set when it is out */
+    MmwDemo_SubFrameStats               *subFrameStats;
+
+    /*! @brief   Cycle count when the results of the frame came in */
+    uint32_t                            startTime;
+} MmwDemo_outputInFlight;
+
+static MmwDemo_outputInFlight gMmwOutputInFlight;
+
+/* Posted when the output packet, and what its segments point at, may be reused */
+static SemaphoreP_Object gMmwOutputPktFreeSemHandle;
 /**************************************************************************
  ************************* Millimeter Wave Demo Functions **********************
  **************************************************************************/
@@ -1287,10 +1425,581 @@ int32_t i;
 }
 
 
-/** @brief Transmits detection data over UART
+/** @brief Segments of an output packet: the header, two per TLV and the padding */
+#define MMWDEMO_OUTPUT_PKT_MAX_SEGMENTS     ((2U * MMWDEMO_OUTPUT_MSG_MAX) + 2U)
+
+/** @brief Range bins of a range or noise profile the packet can gather, a
+ *         config with more is refused by MmwDemo_dataPathConfig */
+#define MMWDEMO_OUTPUT_PKT_MAX_RANGE_BINS   (1024U)
+
+/** @brief Staging for the header, TLV headers, padding, the stats and the two profiles */
+#define MMWDEMO_OUTPUT_PKT_STAGING_SIZE     (sizeof(MmwDemo_output_message_header) + \
+                                             (MMWDEMO_OUTPUT_MSG_MAX * sizeof(MmwDemo_output_message_tl)) + \
+                                             MMWDEMO_OUTPUT_MSG_SEGMENT_LEN + \
+                                             sizeof(MmwDemo_output_message_stats) + \
+                                             sizeof(MmwDemo_temperatureStats) + \
+                                             (2U * MMWDEMO_OUTPUT_PKT_MAX_RANGE_BINS * sizeof(uint16_t)))
+
+/** @brief Points the compressed point cloud holds, as many as a DSS result slot can */
+#define MMWDEMO_OUTPUT_MAX_COMPRESSED_POINTS (MMWDEMO_HSRAM_PAYLOAD_SIZE / sizeof(DPIF_PointCloudCartesian))
+
+/** @brief Bins of a range/Doppler heatmap that can be sent compressed */
+#define MMWDEMO_OUTPUT_HEATMAP_MAX_BINS     (32768U)
+
+/**
+ * @brief
+ *  Output packet as a list of segments sent back to back.
+ *
+ * @details
+ *  TLV payloads are sent from where they are. The header, TLV headers,
+ *  padding and the profiles, which have to be gathered from the detection
+ *  matrix, go to staging. A segment that starts where the one before ends
+ *  is merged into it, so the header and the first TLV header are one.
+ */
+typedef struct MmwDemo_outputPacket_t
+{
+    /*! @brief   Segments in use */
+    uint32_t        numSegments;
+
+    /*! @brief   Start of every segment */
+    const uint8_t   *segBuf[MMWDEMO_OUTPUT_PKT_MAX_SEGMENTS];
+
+    /*! @brief   Bytes of every segment */
+    uint32_t        segLen[MMWDEMO_OUTPUT_PKT_MAX_SEGMENTS];
+
+    /*! @brief   Bytes of all segments */
+    uint32_t        packetLen;
+
+    /*! @brief   TLVs added */
+    uint32_t        numTLVs;
+
+    /*! @brief   Bytes of staging handed out */
+    uint32_t        stagingUsed;
+
+    /*! @brief   Staging, the header is at its start */
+    uint8_t         staging[MMWDEMO_OUTPUT_PKT_STAGING_SIZE];
+} MmwDemo_outputPacket;
+
+/**
+ * @brief
+ *  Payload of @ref MMWDEMO_OUTPUT_MSG_COMPRESSED_POINTS.
+ */
+typedef struct MmwDemo_compressedPoints_t
+{
+    /*! @brief   Units of the frame */
+    MmwDemo_output_message_compressedPointUnit unit;
+
+    /*! @brief   Points */
+    MmwDemo_output_message_compressedPoint     point[MMWDEMO_OUTPUT_MAX_COMPRESSED_POINTS];
+} MmwDemo_compressedPoints;
+
+/* Packet being sent and the compressed point cloud in it */
+static MmwDemo_outputPacket gMmwOutputPkt __attribute__((aligned(32U)));
+static MmwDemo_compressedPoints gMmwCompressedPoints __attribute__((aligned(32U)));
+
+/**
+ * @brief
+ *  Encoder of @ref MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED.
+ *
+ * @details
+ *  Holds the heatmap the host has after the last one sent. There is one
+ *  for all sub-frames, a heatmap of another sub-frame or size than the
+ *  last one is sent as a key frame.
+ */
+typedef struct MmwDemo_heatMapEncoder_t
+{
+    /*! @brief   1 when ref holds the heatmap the host has */
+    uint32_t        refValid;
+
+    /*! @brief   Sub-frame of ref */
+    uint8_t         subFrameIdx;
+
+    /*! @brief   Range bins of ref */
+    uint16_t        numRangeBins;
+
+    /*! @brief   Doppler bins of ref */
+    uint16_t        numDopplerBins;
+
+    /*! @brief   seq of the last heatmap sent */
+    uint16_t        seq;
+
+    /*! @brief   Heatmaps sent since the last key frame */
+    uint32_t        sinceKeyFrame;
+
+    /*! @brief   Heatmap the host has */
+    uint16_t        ref[MMWDEMO_OUTPUT_HEATMAP_MAX_BINS];
+
+    /*! @brief   Payload being sent, no bigger than the heatmap it replaces */
+    uint8_t         payload[sizeof(MmwDemo_heatMapCompressedHdr) + (MMWDEMO_OUTPUT_HEATMAP_MAX_BINS * sizeof(uint16_t))];
+} MmwDemo_heatMapEncoder;
+
+static MmwDemo_heatMapEncoder gMmwHeatMapEnc __attribute__((aligned(32U)));
+
+/**
+ *  @b Description
+ *  @n
+ *      Appends a segment to the output packet.
+ *
+ *  @param[in] pkt      Output packet
+ *  @param[in] buf      Start of the segment
+ *  @param[in] len      Bytes of the segment
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_outPktAddSeg(MmwDemo_outputPacket *pkt, const void *buf, uint32_t len)
+{
+    const uint8_t *start = (const uint8_t *)buf;
+    uint32_t last = pkt->numSegments - 1U;
+
+    if (len == 0U)
+    {
+        return;
+    }
+    if ((pkt->numSegments > 0U) && ((pkt->segBuf[last] + pkt->segLen[last]) == start))
+    {
+        pkt->segLen[last] += len;
+    }
+    else
+    {
+        DebugP_assert(pkt->numSegments < MMWDEMO_OUTPUT_PKT_MAX_SEGMENTS);
+        pkt->segBuf[pkt->numSegments] = start;
+        pkt->segLen[pkt->numSegments] = len;
+        pkt->numSegments++;
+    }
+    pkt->packetLen += len;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Appends bytes from staging to the output packet, for the caller to fill.
+ *
+ *  @param[in] pkt      Output packet
+ *  @param[in] len      Bytes
+ *
+ *  @retval
+ *      Bytes to fill, NULL when staging is full
+ */
+static void *MmwDemo_outPktStage(MmwDemo_outputPacket *pkt, uint32_t len)
+{
+    uint8_t *buf;
+
+    if ((pkt->stagingUsed + len) > sizeof(pkt->staging))
+    {
+        return NULL;
+    }
+    buf = &pkt->staging[pkt->stagingUsed];
+    pkt->stagingUsed += len;
+    MmwDemo_outPktAddSeg(pkt, buf, len);
+    return buf;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts an output packet with room for the header.
+ *
+ *  @param[in] pkt      Output packet
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_outPktInit(MmwDemo_outputPacket *pkt)
+{
+    pkt->numSegments = 0U;
+    pkt->packetLen   = 0U;
+    pkt->numTLVs     = 0U;
+    pkt->stagingUsed = 0U;
+    (void)MmwDemo_outPktStage(pkt, sizeof(MmwDemo_output_message_header));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Appends a TLV whose payload is sent from where it is. The payload
+ *      must stay untouched until the packet is sent.
+ *
+ *  @param[in] pkt      Output packet
+ *  @param[in] type     TLV type, @ref MmwDemo_output_message_type
+ *  @param[in] payload  Payload
+ *  @param[in] len      Bytes of payload
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_outPktAddTlv(MmwDemo_outputPacket *pkt, uint32_t type, const void *payload, uint32_t len)
+{
+    /* Staging has room for a TLV header of every type */
+    MmwDemo_output_message_tl *tl = (MmwDemo_output_message_tl *)MmwDemo_outPktStage(pkt, sizeof(MmwDemo_output_message_tl));
+
+    DebugP_assert(tl != NULL);
+    tl->type   = type;
+    tl->length = len;
+    MmwDemo_outPktAddSeg(pkt, payload, len);
+    pkt->numTLVs++;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Appends a TLV whose payload the caller gathers into staging.
+ *
+ *  @param[in] pkt      Output packet
+ *  @param[in] type     TLV type, @ref MmwDemo_output_message_type
+ *  @param[in] len      Bytes of payload
+ *
+ *  @retval
+ *      Payload to fill, NULL when it does not fit and the TLV is left out
+ */
+static void *MmwDemo_outPktAddStagedTlv(MmwDemo_outputPacket *pkt, uint32_t type, uint32_t len)
+{
+    MmwDemo_output_message_tl *tl;
+
+    if ((pkt->stagingUsed + sizeof(MmwDemo_output_message_tl) + len) > sizeof(pkt->staging))
+    {
+        return NULL;
+    }
+    tl = (MmwDemo_output_message_tl *)MmwDemo_outPktStage(pkt, sizeof(MmwDemo_output_message_tl));
+    tl->type   = type;
+    tl->length = len;
+    pkt->numTLVs++;
+    return MmwDemo_outPktStage(pkt, len);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Pads the output packet to a multiple of
+ *      @ref MMWDEMO_OUTPUT_MSG_SEGMENT_LEN and puts the header in front.
+ *
+ *  @param[in] pkt      Output packet
+ *  @param[in] header   Header, its length and number of TLVs are filled in
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_outPktFinish(MmwDemo_outputPacket *pkt, MmwDemo_output_message_header *header)
+{
+    uint32_t numPaddingBytes = MMWDEMO_OUTPUT_MSG_SEGMENT_LEN - (pkt->packetLen & (MMWDEMO_OUTPUT_MSG_SEGMENT_LEN-1));
+    void *padding;
+
+    if (numPaddingBytes < MMWDEMO_OUTPUT_MSG_SEGMENT_LEN)
+    {
+        padding = MmwDemo_outPktStage(pkt, numPaddingBytes);
+        DebugP_assert(padding != NULL);
+        memset(padding, 0, numPaddingBytes);
+    }
+    header->numTLVs        = pkt->numTLVs;
+    header->totalPacketLen = pkt->packetLen;
+    memcpy(&pkt->staging[0], header, sizeof(MmwDemo_output_message_header));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Output sink send function of the UART sink. Hands the packet to the
+ *      UART sink task and returns, the task calls done once the last byte
+ *      is out. The data export task waits for done before it builds the
+ *      next packet, so there is never more than one packet handed over.
+ *
+ *  @param[in] handle       UART sink
+ *  @param[in] segBuf       Start of every segment
+ *  @param[in] segLen       Bytes of every segment
+ *  @param[in] numSegments  Segments
+ *  @param[in] packetLen    Bytes of all segments
+ *  @param[in] done         Called once the packet is out
+ *  @param[in] doneArg      Passed to done
+ *
+ *  @retval
+ *      0
+ */
+static int32_t MmwDemo_uartSinkSend(void *handle, const uint8_t * const *segBuf, const uint32_t *segLen,
+                                    uint32_t numSegments, uint32_t packetLen,
+                                    MmwDemo_outputSinkDoneFxn done, void *doneArg)
+{
+    MmwDemo_uartSink *sink = (MmwDemo_uartSink *)handle;
+
+    (void)packetLen;
+
+    DebugP_assert(sink->done == NULL);
+    sink->segBuf      = segBuf;
+    sink->segLen      = segLen;
+    sink->numSegments = numSegments;
+    sink->doneArg     = doneArg;
+    sink->done        = done;
+    SemaphoreP_post(&sink->txSemHandle);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      UART sink task. Writes every packet handed over to the logging
+ *      UART, the UART moves each segment with EDMA while this task sleeps.
+ *      The handle is taken from gMmwMssMCB for every packet because
+ *      configDataPort reopens the UART, which it only does once the sensor
+ *      stop waited for the last packet.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_uartSinkTask(void *args)
+{
+    MmwDemo_uartSink *sink = (MmwDemo_uartSink *)args;
+    MmwDemo_outputSinkDoneFxn done;
+    UART_Transaction trans;
+    uint32_t seg;
+
+    while (1)
+    {
+        SemaphoreP_pend(&sink->txSemHandle, SystemP_WAIT_FOREVER);
+
+        /* EDMA reads memory, push out what the R5F wrote */
+        for (seg = 0; seg < sink->numSegments; seg++)
+        {
+            CacheP_wb((void *)sink->segBuf[seg], sink->segLen[seg], CacheP_TYPE_ALLD);
+        }
+        for (seg = 0; seg < sink->numSegments; seg++)
+        {
+            UART_Transaction_init(&trans);
+            trans.buf   = (uint8_t *)sink->segBuf[seg];
+            trans.count = sink->segLen[seg];
+            UART_write(gMmwMssMCB.loggingUartHandle, &trans);
+        }
+
+        /* Idle again before done, done lets the next packet be handed over */
+        done = sink->done;
+        sink->done = NULL;
+        done(sink->doneArg);
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Sets up the UART sink and starts its task.
+ *
+ *  @param[in] taskPriority     Priority of the UART sink task
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_uartSinkInit(uint32_t taskPriority)
+{
+    MmwDemo_uartSink *sink = &gMmwUartSinkObj;
+
+    memset(sink, 0, sizeof(*sink));
+    SemaphoreP_constructBinary(&sink->txSemHandle, 0);
+
+    sink->task = xTaskCreateStatic(MmwDemo_uartSinkTask,
+                                   "mmwdemo_uart_tx_task",
+                                   MMWDEMO_UART_TX_TASK_STACK_SIZE,
+                                   sink,
+                                   taskPriority,
+                                   gUartTxTskStack,
+                                   &sink->taskObj);
+    configASSERT(sink->task != NULL);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Called by the output sink once it is done with the packet. Sets the
+ *      transmit time of the frame, hands its result slot back to the DSS
+ *      and lets the next packet be built.
+ *
+ *  @param[in] arg      @ref MmwDemo_outputInFlight of the packet
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_outputPktDone(void *arg)
+{
+    MmwDemo_outputInFlight *inFlight = (MmwDemo_outputInFlight *)arg;
+
+    inFlight->subFrameStats->outputStats.transmitOutputTime =
+        (CycleCounterP_getCount32() - inFlight->startTime)/(SOC_getSelfCpuClk()/1000000U); /* In micro seconds */
+    MmwDemo_releaseResultSlot(inFlight->result);
+    SemaphoreP_post(&gMmwOutputPktFreeSemHandle);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Waits until the output sink is done with the last packet handed to it.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_outputWait(void)
+{
+    SemaphoreP_pend(&gMmwOutputPktFreeSemHandle, SystemP_WAIT_FOREVER);
+    SemaphoreP_post(&gMmwOutputPktFreeSemHandle);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Rounds a value in units of a field and clips it to the field's range.
+ *
+ *  @param[in] value    Value in units
+ *  @param[in] minValue Smallest value of the field
+ *  @param[in] maxValue Largest value of the field
+ *
+ *  @retval
+ *      Rounded value
+ */
+static int32_t MmwDemo_quantize(float value, int32_t minValue, int32_t maxValue)
+{
+    int32_t q = (int32_t)((value >= 0.0f) ? (value + 0.5f) : (value - 0.5f));
+
+    if (q > maxValue)
+    {
+        q = maxValue;
+    }
+    if (q < minValue)
+    {
+        q = minValue;
+    }
+    return q;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Quantizes the point cloud and its side info for
+ *      @ref MMWDEMO_OUTPUT_MSG_COMPRESSED_POINTS. The units are picked so the
+ *      largest magnitude of coordinate, velocity, SNR and noise of the frame
+ *      is the largest value of its field, x, y and z share a unit. Every
+ *      field is signed, SNR and noise in dB can be below 0.
+ *
+ *  @param[in]  objOut          Point cloud
+ *  @param[in]  objOutSideInfo  Side info, SNR and noise in 0.1 dB
+ *  @param[in]  numPoints       Points, at most @ref MMWDEMO_OUTPUT_MAX_COMPRESSED_POINTS
+ *  @param[out] out             Compressed point cloud
+ *
+ *  @retval
+ *      Bytes of the TLV payload
+ */
+static uint32_t MmwDemo_compressPoints
+(
+    const DPIF_PointCloudCartesian *objOut,
+    const DPIF_PointCloudSideInfo  *objOutSideInfo,
+    uint32_t                        numPoints,
+    MmwDemo_compressedPoints       *out
+)
+{
+    float maxXyz = 0.0f, maxVelocity = 0.0f;
+    int32_t maxSnr = 0, maxNoise = 0;
+    float xyzScale, velocityScale, snrScale, noiseScale;
+    uint32_t i;
+
+    for (i = 0; i < numPoints; i++)
+    {
+        maxXyz = fmaxf(maxXyz, fmaxf(fabsf(objOut[i].x), fmaxf(fabsf(objOut[i].y), fabsf(objOut[i].z))));
+        maxVelocity = fmaxf(maxVelocity, fabsf(objOut[i].velocity));
+        maxSnr = (abs(objOutSideInfo[i].snr) > maxSnr) ? abs(objOutSideInfo[i].snr) : maxSnr;
+        maxNoise = (abs(objOutSideInfo[i].noise) > maxNoise) ? abs(objOutSideInfo[i].noise) : maxNoise;
+    }
+
+    /* A frame of zeros still gets a unit, any will do */
+    out->unit.xyzUnit      = (maxXyz > 0.0f) ? (maxXyz / 32767.0f) : 1.0f;
+    out->unit.velocityUnit = (maxVelocity > 0.0f) ? (maxVelocity / 32767.0f) : 1.0f;
+    out->unit.snrUnit      = (maxSnr > 0) ? ((0.1f * (float)maxSnr) / 127.0f) : 1.0f;
+    out->unit.noiseUnit    = (maxNoise > 0) ? ((0.1f * (float)maxNoise) / 127.0f) : 1.0f;
+    xyzScale      = 1.0f / out->unit.xyzUnit;
+    velocityScale = 1.0f / out->unit.velocityUnit;
+    snrScale      = 0.1f / out->unit.snrUnit;
+    noiseScale    = 0.1f / out->unit.noiseUnit;
+
+    for (i = 0; i < numPoints; i++)
+    {
+        MmwDemo_output_message_compressedPoint *point = &out->point[i];
+
+        point->x        = (int16_t)MmwDemo_quantize(objOut[i].x * xyzScale, -32767, 32767);
+        point->y        = (int16_t)MmwDemo_quantize(objOut[i].y * xyzScale, -32767, 32767);
+        point->z        = (int16_t)MmwDemo_quantize(objOut[i].z * xyzScale, -32767, 32767);
+        point->velocity = (int16_t)MmwDemo_quantize(objOut[i].velocity * velocityScale, -32767, 32767);
+        point->snr      = (int8_t)MmwDemo_quantize((float)objOutSideInfo[i].snr * snrScale, -127, 127);
+        point->noise    = (int8_t)MmwDemo_quantize((float)objOutSideInfo[i].noise * noiseScale, -127, 127);
+    }
+
+    return sizeof(MmwDemo_output_message_compressedPointUnit) +
+           (numPoints * sizeof(MmwDemo_output_message_compressedPoint));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Compresses the range/Doppler heatmap into the payload of
+ *      @ref MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED, predicting
+ *      from the heatmap sent before when it is of the same sub-frame and size.
+ *
+ *  @param[in]  enc             Encoder
+ *  @param[in]  detMatrix       Detection matrix
+ *  @param[in]  subFrameIdx     Sub-frame of the detection matrix
+ *  @param[in]  numRangeBins    Range bins
+ *  @param[in]  numDopplerBins  Doppler bins
+ *  @param[in]  level           rangeDopplerHeatMap of guiMonitor, 2 or more
+ *
+ *  @retval
+ *      Bytes of enc->payload, 0 when it would not be smaller than the
+ *      detection matrix and the matrix has to be sent as it is
+ */
+static uint32_t MmwDemo_compressHeatMap
+(
+    MmwDemo_heatMapEncoder  *enc,
+    const uint16_t          *detMatrix,
+    uint8_t                 subFrameIdx,
+    uint16_t                numRangeBins,
+    uint16_t                numDopplerBins,
+    uint8_t                 level
+)
+{
+    MmwDemo_heatMapCompressedHdr *hdr = (MmwDemo_heatMapCompressedHdr *)enc->payload;
+    uint32_t numBins = (uint32_t)numRangeBins * numDopplerBins;
+    uint32_t len;
+
+    if (numBins > MMWDEMO_OUTPUT_HEATMAP_MAX_BINS)
+    {
+        return 0U;
+    }
+
+    hdr->keyFrame = ((enc->refValid == 0U) ||
+                     (enc->subFrameIdx != subFrameIdx) ||
+                     (enc->numRangeBins != numRangeBins) ||
+                     (enc->numDopplerBins != numDopplerBins) ||
+                     (enc->sinceKeyFrame >= MMWDEMO_HEATMAP_KEY_FRAME_INTERVAL)) ? 1U : 0U;
+
+    /* A stream that does not fit leaves ref half updated */
+    enc->refValid = 0U;
+    len = MmwDemo_heatMapEncode(detMatrix, enc->ref, numBins, hdr->keyFrame,
+                                MmwDemo_heatMapDeadBand(level), &enc->payload[sizeof(*hdr)],
+                                (numBins * sizeof(uint16_t)) - sizeof(*hdr));
+    if (len == 0U)
+    {
+        return 0U;
+    }
+
+    enc->refValid       = 1U;
+    enc->subFrameIdx    = subFrameIdx;
+    enc->numRangeBins   = numRangeBins;
+    enc->numDopplerBins = numDopplerBins;
+    enc->sinceKeyFrame  = (hdr->keyFrame != 0U) ? 1U : (enc->sinceKeyFrame + 1U);
+    enc->seq++;
+
+    hdr->numRangeBins   = numRangeBins;
+    hdr->numDopplerBins = numDopplerBins;
+    hdr->seq            = enc->seq;
+    hdr->level          = level;
+    return sizeof(*hdr) + len;
+}
+
+/** @brief Transmits detection data over the selected output sink, the UART unless outputSinkCfg says UDP
 *
 *    The following data is transmitted:
-*    1. Header (size = 32bytes), including "Magic word", (size = 8 bytes)
+*    1. Header (size = 40bytes), including "Magic word", (size = 8 bytes)
 *       and including the number of TLV items
 *    TLV Items:
 *    2. If detectedObjects flag is 1 or 2, DPIF_PointCloudCartesian structure containing
@@ -1299,36 +2008,53 @@ int32_t i;
 *    3. If detectedObjects flag is 1, DPIF_PointCloudSideInfo structure containing SNR
 *       and noise for detected objects,
 *       size = sizeof(DPIF_PointCloudCartesian) * number of detected objects
-*    4. If logMagRange flag is set,  rangeProfile,
+*    4. If detectedObjects flag is 3, both of the above quantized to 10 bytes a
+*       point, size = 16 + 10 * number of detected objects
+*    5. If logMagRange flag is set,  rangeProfile,
 *       size = number of range bins * sizeof(uint16_t)
-*    5. If noiseProfile flag is set,  noiseProfile,
+*    6. If noiseProfile flag is set,  noiseProfile,
 *       size = number of range bins * sizeof(uint16_t)
-*    6. If rangeAzimuthHeatMap flag is set, the zero Doppler column of the
+*    7. If rangeAzimuthHeatMap flag is set, the zero Doppler column of the
 *       range cubed matrix, size = number of Rx Azimuth virtual antennas *
 *       number of chirps per frame * sizeof(uint32_t)
-*    7. If rangeDopplerHeatMap flag is set, the log magnitude range-Doppler matrix,
-*       size = number of range bins * number of Doppler bins * sizeof(uint16_t)
-*    8. If statsInfo flag is set, the stats information
-*   @param[in] uartHandle   UART driver handle
+*    8. If rangeDopplerHeatMap flag is 1, the log magnitude range-Doppler matrix,
+*       size = number of range bins * number of Doppler bins * sizeof(uint16_t).
+*       If it is 2 or more, the matrix compressed, or as for 1 when that
+*       would not be smaller
+*    9. If statsInfo flag is set, the stats information, and the per stage
+*       timing if the data path core reported it
+*
+*    The packet is put together as a list of segments that point at the
+*    results where they are and sent in one go at the end. Only the
+*    profiles, which are strided through the detection matrix, and the
+*    compressed points are built in MSS memory, the stats are copied there
+*    as they keep changing. The sink may still be sending when this returns,
+*    the caller must wait for done before the next packet is built.
+*
+*   @param[in] sink         Output sink the packet goes to
 *   @param[in] result       Pointer to result from object detection DPC processing
 *   @param[in] timingInfo   Pointer to timing information provided from core that runs data path
+*   @param[in] stageTiming  Pointer to per stage timing from core that runs data path, or NULL
+*   @param[in] done         Called by the sink once the packet is out
+*   @param[in] doneArg      Passed to done
 */
 static void MmwDemo_transmitProcessedOutput
 (
-    UART_Handle     uartHandle,
+    const MmwDemo_outputSink            *sink,
     DPC_ObjectDetection_ExecuteResult   *result,
-    MmwDemo_output_message_stats        *timingInfo
+    MmwDemo_output_message_stats        *timingInfo,
+    MmwDemo_output_message_stageTiming  *stageTiming,
+    MmwDemo_outputSinkDoneFxn           done,
+    void                                *doneArg
 )
 {
     MmwDemo_output_message_header header;
+    MmwDemo_outputPacket *pkt = &gMmwOutputPkt;
     MmwDemo_GuiMonSel   *pGuiMonSel;
     MmwDemo_SubFrameCfg *subFrameCfg;
-    uint32_t tlvIdx = 0;
     uint32_t index;
-    uint32_t numPaddingBytes;
-    uint32_t packetLen;
-    uint8_t padding[MMWDEMO_OUTPUT_MSG_SEGMENT_LEN];
-    MmwDemo_output_message_tl   tl[MMWDEMO_OUTPUT_MSG_MAX];
+    uint32_t numPoints;
+    uint16_t *profile;
     uint16_t *detMatrix = (uint16_t *)result->detMatrix.data;
     DPIF_PointCloudCartesian *objOut;
 #ifdef MMWDEMO_TDM
@@ -1336,9 +2062,6 @@ static void MmwDemo_transmitProcessedOutput
 #endif
     DPIF_PointCloudSideInfo *objOutSideInfo;
     DPC_ObjectDetection_Stats *stats;
-    UART_Transaction trans;
-
-    UART_Transaction_init(&trans);
 
     /* Get subframe configuration */
     subFrameCfg = &gMmwMssMCB.subFrameCfg[result->subFrameIdx];
@@ -1390,103 +2113,28 @@ static void MmwDemo_transmitProcessedOutput
                         (MMWAVE_SDK_VERSION_MINOR << 16) |
                         (MMWAVE_SDK_VERSION_MAJOR << 24);
 
-    packetLen = sizeof(MmwDemo_output_message_header);
+    MmwDemo_outPktInit(pkt);
+
+    /* Detected objects */
     if (((pGuiMonSel->detectedObjects == 1) || (pGuiMonSel->detectedObjects == 2)) &&
          (result->numObjOut > 0))
     {
-        tl[tlvIdx].type = MMWDEMO_OUTPUT_MSG_DETECTED_POINTS;
-        tl[tlvIdx].length = sizeof(DPIF_PointCloudCartesian) * result->numObjOut;
-        packetLen += sizeof(MmwDemo_output_message_tl) + tl[tlvIdx].length;
-        tlvIdx++;
+        MmwDemo_outPktAddTlv(pkt, MMWDEMO_OUTPUT_MSG_DETECTED_POINTS, objOut,
+                             sizeof(DPIF_PointCloudCartesian) * result->numObjOut);
     }
     /* Side info */
     if ((pGuiMonSel->detectedObjects == 1) && (result->numObjOut > 0))
     {
-        tl[tlvIdx].type = MMWDEMO_OUTPUT_MSG_DETECTED_POINTS_SIDE_INFO;
-        tl[tlvIdx].length = sizeof(DPIF_PointCloudSideInfo) * result->numObjOut;
-        packetLen += sizeof(MmwDemo_output_message_tl) + tl[tlvIdx].length;
-        tlvIdx++;
-    }
-    if (pGuiMonSel->logMagRange)
-    {
-        tl[tlvIdx].type = MMWDEMO_OUTPUT_MSG_RANGE_PROFILE;
-        tl[tlvIdx].length = sizeof(uint16_t) * subFrameCfg->numRangeBins;
-        packetLen += sizeof(MmwDemo_output_message_tl) + tl[tlvIdx].length;
-        tlvIdx++;
-    }
-    if (pGuiMonSel->noiseProfile)
-    {
-        tl[tlvIdx].type = MMWDEMO_OUTPUT_MSG_NOISE_PROFILE;
-        tl[tlvIdx].length = sizeof(uint16_t) * subFrameCfg->numRangeBins;
-        packetLen += sizeof(MmwDemo_output_message_tl) + tl[tlvIdx].length;
-        tlvIdx++;
-    }
-#ifdef MMWDEMO_TDM
-    if (pGuiMonSel->rangeAzimuthHeatMap)
-    {
-        tl[tlvIdx].type = MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP;
-        tl[tlvIdx].length = result->azimuthStaticHeatMapSize * sizeof(cmplx16ImRe_t);
-        packetLen += sizeof(MmwDemo_output_message_tl) +  tl[tlvIdx].length;
-        tlvIdx++;
-    }
-#endif
-    if (pGuiMonSel->rangeDopplerHeatMap)
-    {
-        tl[tlvIdx].type = MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP;
-#ifdef MMWDEMO_TDM
-        tl[tlvIdx].length = subFrameCfg->numRangeBins * subFrameCfg->numDopplerBins * sizeof(uint16_t);
-#elif defined(MMWDEMO_DDM)
-        tl[tlvIdx].length = subFrameCfg->numRangeBins * numDopFFTSubBins * sizeof(uint16_t);
-#endif
-        packetLen += sizeof(MmwDemo_output_message_tl) + tl[tlvIdx].length;
-        tlvIdx++;
-    }
-    if (pGuiMonSel->statsInfo)
-    {
-        tl[tlvIdx].type = MMWDEMO_OUTPUT_MSG_STATS;
-        tl[tlvIdx].length = sizeof(MmwDemo_output_message_stats);
-        packetLen += sizeof(MmwDemo_output_message_tl) + tl[tlvIdx].length;
-        tlvIdx++;
-
-        MmwDemo_getTemperatureReport();
-        tl[tlvIdx].type = MMWDEMO_OUTPUT_MSG_TEMPERATURE_STATS;
-        tl[tlvIdx].length = sizeof(MmwDemo_temperatureStats);
-        packetLen += sizeof(MmwDemo_output_message_tl) + tl[tlvIdx].length;
-        tlvIdx++;
+        MmwDemo_outPktAddTlv(pkt, MMWDEMO_OUTPUT_MSG_DETECTED_POINTS_SIDE_INFO, objOutSideInfo,
+                             sizeof(DPIF_PointCloudSideInfo) * result->numObjOut);
     }
-
-    header.numTLVs = tlvIdx;
-    /* Round up packet length to multiple of MMWDEMO_OUTPUT_MSG_SEGMENT_LEN */
-    header.totalPacketLen = MMWDEMO_OUTPUT_MSG_SEGMENT_LEN *
-            ((packetLen + (MMWDEMO_OUTPUT_MSG_SEGMENT_LEN-1))/MMWDEMO_OUTPUT_MSG_SEGMENT_LEN);
-    header.timeCpuCycles = 0; //Pmu_getCount(0);
-    header.frameNumber = stats->frameStartIntCounter;
-    header.subFrameNumber = result->subFrameIdx;
-
-    DebugP_logInfo("Platform = %d, Version = %d, NumObj = %d, numTLVs = %d", header.platform, header.version, header.numDetectedObj, header.numTLVs);
-
-    CacheP_wbInv((void *)&header, sizeof(MmwDemo_output_message_header), CacheP_TYPE_ALLD);
-    UART_Transaction_init(&trans);
-    trans.buf   = (uint8_t*)&header;
-    trans.count = sizeof(MmwDemo_output_message_header);
-    UART_write(uartHandle, &trans);
-
-    tlvIdx = 0;
-    /* Send detected Objects */
-    if (((pGuiMonSel->detectedObjects == 1) || (pGuiMonSel->detectedObjects == 2)) &&
-        (result->numObjOut > 0))
+    /* Both, quantized */
+    if ((pGuiMonSel->detectedObjects == 3) && (result->numObjOut > 0))
     {
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)&tl[tlvIdx];
-        trans.count = sizeof(MmwDemo_output_message_tl);
-        UART_write(uartHandle, &trans);
-
-        /*Send array of objects */
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)objOut;
-        trans.count = sizeof(DPIF_PointCloudCartesian) * result->numObjOut;
-        UART_write(uartHandle, &trans);
-        tlvIdx++;
+        numPoints = (result->numObjOut < MMWDEMO_OUTPUT_MAX_COMPRESSED_POINTS) ?
+                    result->numObjOut : MMWDEMO_OUTPUT_MAX_COMPRESSED_POINTS;
+        MmwDemo_outPktAddTlv(pkt, MMWDEMO_OUTPUT_MSG_COMPRESSED_POINTS, &gMmwCompressedPoints,
+                             MmwDemo_compressPoints(objOut, objOutSideInfo, numPoints, &gMmwCompressedPoints));
     }
 
 #ifdef ENET_STREAM
@@ -1498,131 +2146,102 @@ static void MmwDemo_transmitProcessedOutput
     }
 #endif
 
-    /* Send detected Objects Side Info */
-    if ((pGuiMonSel->detectedObjects == 1) && (result->numObjOut > 0))
-    {
-
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)&tl[tlvIdx];
-        trans.count = sizeof(MmwDemo_output_message_tl);
-        UART_write(uartHandle, &trans);
-
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)objOutSideInfo;
-        trans.count = sizeof(DPIF_PointCloudSideInfo) * result->numObjOut;
-        UART_write(uartHandle, &trans);
-        tlvIdx++;
-    }
-
-    /* Send Range profile */
+    /* Range profile, the zero Doppler column of the detection matrix */
     if (pGuiMonSel->logMagRange)
     {
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)&tl[tlvIdx];
-        trans.count = sizeof(MmwDemo_output_message_tl);
-        UART_write(uartHandle, &trans);
-
-        for(index = 0; index < subFrameCfg->numRangeBins; index++)
+        profile = (uint16_t *)MmwDemo_outPktAddStagedTlv(pkt, MMWDEMO_OUTPUT_MSG_RANGE_PROFILE,
+                                                         sizeof(uint16_t) * subFrameCfg->numRangeBins);
+        for(index = 0; (profile != NULL) && (index < subFrameCfg->numRangeBins); index++)
         {
-            UART_Transaction_init(&trans);
 #ifdef MMWDEMO_TDM
-            trans.buf   = (uint8_t*)&detMatrix[index*subFrameCfg->numDopplerBins];
+            profile[index] = detMatrix[index*subFrameCfg->numDopplerBins];
 #elif defined(MMWDEMO_DDM)
-            trans.buf   = (uint8_t*)&detMatrix[index * numDopFFTSubBins];
+            profile[index] = detMatrix[index * numDopFFTSubBins];
 #endif
-            trans.count = sizeof(uint16_t);
-            UART_write(uartHandle, &trans);
         }
-        tlvIdx++;
     }
 
-    /* Send noise profile */
+    /* Noise profile, the highest Doppler column */
     if (pGuiMonSel->noiseProfile)
     {
         uint32_t maxDopIdx = subFrameCfg->numDopplerBins/2 -1;
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)&tl[tlvIdx];
-        trans.count = sizeof(MmwDemo_output_message_tl);
-        UART_write(uartHandle, &trans);
-
-        for(index = 0; index < subFrameCfg->numRangeBins; index++)
+        profile = (uint16_t *)MmwDemo_outPktAddStagedTlv(pkt, MMWDEMO_OUTPUT_MSG_NOISE_PROFILE,
+                                                         sizeof(uint16_t) * subFrameCfg->numRangeBins);
+        for(index = 0; (profile != NULL) && (index < subFrameCfg->numRangeBins); index++)
         {
-            UART_Transaction_init(&trans);
-            trans.buf   = (uint8_t*)&detMatrix[index*subFrameCfg->numDopplerBins + maxDopIdx];
-            trans.count = sizeof(uint16_t);
-            UART_write(uartHandle, &trans);
+            profile[index] = detMatrix[index*subFrameCfg->numDopplerBins + maxDopIdx];
         }
-        tlvIdx++;
     }
 
 #ifdef MMWDEMO_TDM
-    /* Send data for static azimuth heatmap */
+    /* Static azimuth heatmap */
     if (pGuiMonSel->rangeAzimuthHeatMap)
     {
         azimuthStaticHeatMap = (cmplx16ImRe_t *) AddrTranslateP_getLocalAddr((uint32_t)result->azimuthStaticHeatMap);
-
-        trans.buf   = (uint8_t*)&tl[tlvIdx];
-        trans.count = sizeof(MmwDemo_output_message_tl);
-        UART_write(uartHandle, &trans);
-
-        trans.buf   = (uint8_t*)azimuthStaticHeatMap;
-        trans.count = result->azimuthStaticHeatMapSize * sizeof(cmplx16ImRe_t);
-        UART_write(uartHandle, &trans);
-
-        tlvIdx++;
+        MmwDemo_outPktAddTlv(pkt, MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP, azimuthStaticHeatMap,
+                             result->azimuthStaticHeatMapSize * sizeof(cmplx16ImRe_t));
     }
 #endif
 
-    /* Send data for range/Doppler heatmap */
-    if (pGuiMonSel->rangeDopplerHeatMap == 1)
+    /* Range/Doppler heatmap */
+    if (pGuiMonSel->rangeDopplerHeatMap != 0)
     {
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)&tl[tlvIdx];
-        trans.count = sizeof(MmwDemo_output_message_tl);
-        UART_write(uartHandle, &trans);
-
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)detMatrix;
-        trans.count = tl[tlvIdx].length;
-        UART_write(uartHandle, &trans);
-        tlvIdx++;
+#ifdef MMWDEMO_TDM
+        uint16_t numHeatMapDopplerBins = subFrameCfg->numDopplerBins;
+#elif defined(MMWDEMO_DDM)
+        uint16_t numHeatMapDopplerBins = numDopFFTSubBins;
+#endif
+        uint32_t heatMapLen = 0U;
+
+        if (pGuiMonSel->rangeDopplerHeatMap >= MMWDEMO_HEATMAP_LEVEL_LOSSLESS)
+        {
+            heatMapLen = MmwDemo_compressHeatMap(&gMmwHeatMapEnc, detMatrix, result->subFrameIdx,
+                                                 subFrameCfg->numRangeBins, numHeatMapDopplerBins,
+                                                 pGuiMonSel->rangeDopplerHeatMap);
+        }
+        if (heatMapLen != 0U)
+        {
+            MmwDemo_outPktAddTlv(pkt, MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED,
+                                 gMmwHeatMapEnc.payload, heatMapLen);
+        }
+        else
+        {
+            MmwDemo_outPktAddTlv(pkt, MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP, detMatrix,
+                                 subFrameCfg->numRangeBins * numHeatMapDopplerBins * sizeof(uint16_t));
+        }
     }
 
-    /* Send stats information */
+    /* Stats information */
     if (pGuiMonSel->statsInfo == 1)
     {
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)&tl[tlvIdx];
-        trans.count = sizeof(MmwDemo_output_message_tl);
-        UART_write(uartHandle, &trans);
-
-        /* Address translation is done when buffer is received*/
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)timingInfo;
-        trans.count = tl[tlvIdx].length;
-        UART_write(uartHandle, &trans);
-        tlvIdx++;
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)&tl[tlvIdx];
-        trans.count = sizeof(MmwDemo_output_message_tl);
-        UART_write(uartHandle, &trans);
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)&gMmwMssMCB.temperatureStats;
-        trans.count = tl[tlvIdx].length;
-        UART_write(uartHandle, &trans);
-        tlvIdx++;
-    }
+        void *stats;
 
-    /* Send padding bytes */
-    numPaddingBytes = MMWDEMO_OUTPUT_MSG_SEGMENT_LEN - (packetLen & (MMWDEMO_OUTPUT_MSG_SEGMENT_LEN-1));
-    if (numPaddingBytes<MMWDEMO_OUTPUT_MSG_SEGMENT_LEN)
-    {
-        UART_Transaction_init(&trans);
-        trans.buf   = (uint8_t*)padding;
-        trans.count = numPaddingBytes;
-        UART_write(uartHandle, &trans);
+        /* Address translation is done when buffer is received. Copied, the
+         * next frame updates them while this packet may still be going out */
+        stats = MmwDemo_outPktAddStagedTlv(pkt, MMWDEMO_OUTPUT_MSG_STATS, sizeof(MmwDemo_output_message_stats));
+        DebugP_assert(stats != NULL);
+        memcpy(stats, timingInfo, sizeof(MmwDemo_output_message_stats));
+
+        MmwDemo_getTemperatureReport();
+        stats = MmwDemo_outPktAddStagedTlv(pkt, MMWDEMO_OUTPUT_MSG_TEMPERATURE_STATS, sizeof(MmwDemo_temperatureStats));
+        DebugP_assert(stats != NULL);
+        memcpy(stats, &gMmwMssMCB.temperatureStats, sizeof(MmwDemo_temperatureStats));
+
+        if (stageTiming != NULL)
+        {
+            MmwDemo_outPktAddTlv(pkt, MMWDEMO_OUTPUT_MSG_STAGE_TIMING, stageTiming,
+                                 sizeof(MmwDemo_output_message_stageTiming));
+        }
     }
 
+    header.timeCpuCycles = 0; //Pmu_getCount(0);
+    header.frameNumber = stats->frameStartIntCounter;
+    header.subFrameNumber = result->subFrameIdx;
+    MmwDemo_outPktFinish(pkt, &header);
+
+    DebugP_logInfo("Platform = %d, Version = %d, NumObj = %d, numTLVs = %d", header.platform, header.version, header.numDetectedObj, header.numTLVs);
+
+    sink->send(sink->handle, pkt->segBuf, pkt->segLen, pkt->numSegments, pkt->packetLen, done, doneArg);
 }
 
 /**************************************************************************
@@ -2095,6 +2714,16 @@ static int32_t MmwDemo_dataPathConfig (void)
             RFparserOutParams.numRangeBins = 1022;
         }
 
+        /* The output packet gathers the range and noise profiles in its staging */
+        if (((subFrameCfg->guiMonSel.logMagRange) || (subFrameCfg->guiMonSel.noiseProfile)) &&
+            (subFrameCfg->numRangeBins > MMWDEMO_OUTPUT_PKT_MAX_RANGE_BINS))
+        {
+            CLI_write ("Error: Sub-frame %d has %d range bins, the range and noise profiles hold at most %u\n",
+                       subFrameIndx, subFrameCfg->numRangeBins, MMWDEMO_OUTPUT_PKT_MAX_RANGE_BINS);
+            errCode = -1;
+            goto exit;
+        }
+
 #ifdef MMWDEMO_DDM
         subFrameCfg->datapathStaticCfg.compressionCfg.numRxAntennaPerBlock = RFparserOutParams.numRxAntennas;
         if(subFrameCfg->datapathStaticCfg.compressionCfg.compressionMethod == 1)
@@ -2300,6 +2929,9 @@ static void MmwDemo_dataPathStart (void)
 
     DebugP_logInfo("App: Issuing DPM_start\n");
 #ifdef LVDS_STREAM
+    /* Build the sessions kept until stop */
+    MmwDemo_LVDSStreamStart();
+
     /* Configure HW LVDS stream for the first sub-frame that will start upon
      * start of frame */
     if (gMmwMssMCB.subFrameCfg[0].lvdsStreamCfg.dataFmt != MMW_DEMO_LVDS_STREAM_CFG_DATAFMT_DISABLED)
@@ -2965,6 +3597,27 @@ exit:
 }
 #endif
 
+/**
+ *  @b Description
+ *  @n
+ *      Hands the HSRAM result slot of a frame back to the DSS once its
+ *      results went out. The DSS checks releasedSeq before it lets the DPC
+ *      write a slot again.
+ *
+ *  @param[in] dpcResults  Result of the frame, in its slot
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_releaseResultSlot(DPC_ObjectDetection_ExecuteResult *dpcResults)
+{
+    MmwDemo_resultSlot *slot = MMWDEMO_HSRAM_SLOT_OF_RESULT(dpcResults);
+
+    CacheP_inv((void *)&slot->hdr.seq, sizeof(slot->hdr.seq), CacheP_TYPE_ALLD);
+    gHSRAM.owner.releasedSeq = slot->hdr.seq;
+    CacheP_wb((void *)&gHSRAM.owner, sizeof(MmwDemo_HSRAM_owner), CacheP_TYPE_ALLD);
+}
+
 /**
  *  @b Description
  *  @n
@@ -2977,6 +3630,7 @@ void MmwDemo_handleObjectDetResult(void)
 {
     DPC_ObjectDetection_ExecuteResult        *dpcResults;
     MmwDemo_output_message_stats            *frameStats;
+    MmwDemo_output_message_stageTiming      *stageTiming = NULL;
     volatile uint32_t                        startTime;
     uint8_t                                  nextSubFrameIdx;
     uint8_t                                  numSubFrames;
@@ -3033,6 +3687,12 @@ void MmwDemo_handleObjectDetResult(void)
     /* Translate the address: */
     frameStats = (MmwDemo_output_message_stats *) AddrTranslateP_getLocalAddr((uint32_t)gMmwMssMCB.ptrResult.ptrBuffer[1]);
 
+    /* Stage timing is only there when the DSS reports it */
+    if (gMmwMssMCB.ptrResult.size[2] == sizeof(MmwDemo_output_message_stageTiming))
+    {
+        stageTiming = (MmwDemo_output_message_stageTiming *) AddrTranslateP_getLocalAddr((uint32_t)gMmwMssMCB.ptrResult.ptrBuffer[2]);
+    }
+
     /* Update current frame stats */
     currSubFrameStats->outputStats.interFrameCPULoad = frameStats->interFrameCPULoad;
     currSubFrameStats->outputStats.activeFrameCPULoad= frameStats->activeFrameCPULoad;
@@ -3054,16 +3714,35 @@ void MmwDemo_handleObjectDetResult(void)
          * be bigger than the transmission of the h/w session */
         SemaphoreP_pend(&gMmwMssMCB.lvdsStream.hwFrameDoneSemHandle, SystemP_WAIT_FOREVER);
     }
+
+    /* S/w data of the frame, streamed with the batch it completes */
+    if (gMmwMssMCB.subFrameCfg[currSubFrameIdx].lvdsStreamCfg.isSwEnabled == 1)
+    {
+        DPC_ObjectDetection_Stats *dpcStats;
+
+        dpcStats = (DPC_ObjectDetection_Stats *) AddrTranslateP_getLocalAddr((uint32_t)dpcResults->stats);
+        MmwDemo_transferLVDSUserData(currSubFrameIdx,
+                                     dpcStats->frameStartIntCounter,
+                                     dpcResults->numObjOut,
+                                     (void *) AddrTranslateP_getLocalAddr((uint32_t)dpcResults->objOut),
+                                     (void *) AddrTranslateP_getLocalAddr((uint32_t)dpcResults->objOutSideInfo));
+    }
 #endif
 
-    /* Transmit processing results for the frame */
+    /* Transmit processing results for the frame once the sink is done with
+     * the last packet. The sink releases the result slot, and sets the
+     * transmit time, when this one is out */
+    SemaphoreP_pend(&gMmwOutputPktFreeSemHandle, SystemP_WAIT_FOREVER);
+    gMmwOutputInFlight.result        = dpcResults;
+    gMmwOutputInFlight.subFrameStats = currSubFrameStats;
+    gMmwOutputInFlight.startTime     = startTime;
     transmitStartTime = CycleCounterP_getCount32();
-    MmwDemo_transmitProcessedOutput(gMmwMssMCB.loggingUartHandle,
+    MmwDemo_transmitProcessedOutput(gMmwOutputSink,
                                     dpcResults,
-                                    &currSubFrameStats->outputStats);
-
-    /* Update current frame transmit time */
-    currSubFrameStats->outputStats.transmitOutputTime = (CycleCounterP_getCount32() - startTime)/(SOC_getSelfCpuClk()/1000000U); /* In micro seconds */
+                                    &currSubFrameStats->outputStats,
+                                    stageTiming,
+                                    MmwDemo_outputPktDone,
+                                    &gMmwOutputInFlight);
 
     /*****************************************************************
      * Handle dynamic pending configuration
@@ -3703,7 +4382,20 @@ void MmwDemo_stopSensor(void)
     /* Wait until DPM_stop is completed */
     SemaphoreP_pend(&gMmwMssMCB.DPMstopSemHandle, SystemP_WAIT_FOREVER);
 
+    /* Let the packet of the last frame go out, it holds its result slot and
+     * configDataPort may reopen the UART after this */
+    MmwDemo_outputWait();
+
+#ifdef ENET_STREAM
+    /* Send the frames of a batch that was not full yet */
+    MmwDemo_udpSinkFlush();
+#endif
+
 #ifdef LVDS_STREAM
+    /* Let a batch of s/w data that is streaming finish, in the one sub-frame
+     * case its completion activates the h/w session again */
+    MmwDemo_LVDSStreamSwWait();
+
     /* Delete any active streaming session */
     if(gMmwMssMCB.lvdsStream.hwSessionHandle != NULL)
     {
@@ -3733,13 +4425,8 @@ void MmwDemo_stopSensor(void)
         MmwDemo_LVDSStreamDeleteHwSession();
     }
 
-    /* Delete s/w session if it exists. S/w session never needs to be deactivated in stop because
-     * it always (unconditionally) deactivates itself upon completion.
-     */
-    if(gMmwMssMCB.lvdsStream.swSessionHandle != NULL)
-    {
-        MmwDemo_LVDSStreamDeleteSwSession();
-    }
+    /* Stream what is left of the last s/w batch and delete the s/w session if it exists */
+    MmwDemo_LVDSStreamSwStop();
 #endif
 
     /* Print epilog */
@@ -3986,6 +4673,10 @@ static void MmwDemo_initTask(void* args)
     /* Initialize Last Frame data Set flag for first frame. */
     gMmwMssMCB.stats.isLastFrameDataProcessed = true;
 
+    /* No result slot is held, the DSS numbers its first frame 1 */
+    gHSRAM.owner.releasedSeq = 0U;
+    CacheP_wb((void *)&gHSRAM.owner, sizeof(MmwDemo_HSRAM_owner), CacheP_TYPE_ALLD);
+
 #ifdef LVDS_STREAM
     gMmwMssMCB.edmaHandle = gEdmaHandle[CONFIG_EDMA0];
 
@@ -4045,6 +4736,7 @@ static void MmwDemo_initTask(void* args)
     SemaphoreP_constructBinary(&gMmwMssMCB.DPMstopSemHandle, 0);
     SemaphoreP_constructBinary(&gMmwMssMCB.DPMioctlSemHandle, 0);
     SemaphoreP_constructBinary(&gMmwMssMCB.UartExportSemHandle, 0);
+    SemaphoreP_constructBinary(&gMmwOutputPktFreeSemHandle, 1);
 
     /* Create binary semaphore to pend Main task, */
     SemaphoreP_constructBinary(&gMmwMssMCB.demoInitTaskCompleteSemHandle, 0);
@@ -4120,6 +4812,9 @@ static void MmwDemo_initTask(void* args)
                                       &gMmwMssMCB.taskHandles.enetTaskObj );
 
     configASSERT(gMmwMssMCB.taskHandles.enetTask != NULL);
+
+    /* UDP output sink, idle until outputSinkCfg selects it */
+    MmwDemo_udpSinkInit(MMWDEMO_UDP_SINK_TASK_PRIORITY);
 #endif
 
     /*****************************************************************************
@@ -4197,6 +4892,9 @@ static void MmwDemo_initTask(void* args)
 
     configASSERT(gMmwMssMCB.taskHandles.uartDataExportTask != NULL);
 
+    /* Launch the UART sink task */
+    MmwDemo_uartSinkInit(MMWDEMO_UART_TX_TASK_PRIORITY);
+
     /*****************************************************************************
      * Initialize the Profiler
      *****************************************************************************/
@@ -0,0 +1,335 @@
+/*
+ * bfp_codec.h
+ *
+ * Host side BFP compression and decompression of radar cube blocks, bit
+ * for bit what the HWA does.
+ *
+ * The block format is the one in dpc_bfp.h: a 4 bit scale factor, then
+ * per sample the imaginary and the real mantissa, LSB first in 32 bit
+ * words, the imaginary one decrImagBitw bits narrower on ES2.0 parts.
+ * DPC_ObjDet_bfpPackBlock and DPC_ObjDet_bfpUnpackBlock there do one block
+ * at a time and are the reference. Here BFP_CODEC_LANES blocks go at once,
+ * one block per vector lane. All blocks of a cube have the same format, so
+ * a mantissa sits at the same bit of every block and each one is a few
+ * shifts, a mask and a multiply by the block's power of two for all lanes.
+ * The lanes are filled and emptied by transposing the blocks, the
+ * blocks left over at the end of a cube go through the reference.
+ *
+ * The backend is chosen at compile time: AVX2 (8 lanes), SSE2 or NEON
+ * (4 lanes), or plain C (4 lanes) when none is there or when
+ * BFP_CODEC_GENERIC is defined.
+ */
+
+#ifndef BFP_CODEC_H
+#define BFP_CODEC_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "dpc_bfp.h"
+
+/* ======================= Vector backends ======================= */
+
+#if !defined(BFP_CODEC_GENERIC) && defined(__AVX2__)
+
+#include <immintrin.h>
+#define BFP_CODEC_LANES     (8U)
+#define BFP_CODEC_NAME      "avx2"
+typedef __m256i BfpVec;
+#define bfp_vload(p)        _mm256_load_si256((const __m256i *)(p))
+#define bfp_vstore(p, a)    _mm256_store_si256((__m256i *)(p), (a))
+#define bfp_vset1(x)        _mm256_set1_epi32(x)
+#define bfp_vand(a, b)      _mm256_and_si256((a), (b))
+#define bfp_vor(a, b)       _mm256_or_si256((a), (b))
+#define bfp_vxor(a, b)      _mm256_xor_si256((a), (b))
+#define bfp_vsll(a, n)      _mm256_sll_epi32((a), _mm_cvtsi32_si128((int)(n)))
+#define bfp_vsrl(a, n)      _mm256_srl_epi32((a), _mm_cvtsi32_si128((int)(n)))
+#define bfp_vsra(a, n)      _mm256_sra_epi32((a), _mm_cvtsi32_si128((int)(n)))
+#define bfp_vmul(a, b)      _mm256_mullo_epi32((a), (b))
+
+#elif !defined(BFP_CODEC_GENERIC) && defined(__SSE2__)
+
+#include <emmintrin.h>
+#define BFP_CODEC_LANES     (4U)
+#define BFP_CODEC_NAME      "sse2"
+typedef __m128i BfpVec;
+#define bfp_vload(p)        _mm_load_si128((const __m128i *)(p))
+#define bfp_vstore(p, a)    _mm_store_si128((__m128i *)(p), (a))
+#define bfp_vset1(x)        _mm_set1_epi32(x)
+#define bfp_vand(a, b)      _mm_and_si128((a), (b))
+#define bfp_vor(a, b)       _mm_or_si128((a), (b))
+#define bfp_vxor(a, b)      _mm_xor_si128((a), (b))
+#define bfp_vsll(a, n)      _mm_sll_epi32((a), _mm_cvtsi32_si128((int)(n)))
+#define bfp_vsrl(a, n)      _mm_srl_epi32((a), _mm_cvtsi32_si128((int)(n)))
+#define bfp_vsra(a, n)      _mm_sra_epi32((a), _mm_cvtsi32_si128((int)(n)))
+
+/* SSE2 has no 32 bit multiply keeping the low half, two 32x32->64 do it */
+static inline BfpVec bfp_vmul(BfpVec a, BfpVec b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+#elif !defined(BFP_CODEC_GENERIC) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+
+#include <arm_neon.h>
+#define BFP_CODEC_LANES     (4U)
+#define BFP_CODEC_NAME      "neon"
+typedef int32x4_t BfpVec;
+#define bfp_vload(p)        vld1q_s32((const int32_t *)(p))
+#define bfp_vstore(p, a)    vst1q_s32((int32_t *)(p), (a))
+#define bfp_vset1(x)        vdupq_n_s32(x)
+#define bfp_vand(a, b)      vandq_s32((a), (b))
+#define bfp_vor(a, b)       vorrq_s32((a), (b))
+#define bfp_vxor(a, b)      veorq_s32((a), (b))
+#define bfp_vsll(a, n)      vshlq_s32((a), vdupq_n_s32((int32_t)(n)))
+#define bfp_vsrl(a, n)      vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(a), vdupq_n_s32(-(int32_t)(n))))
+#define bfp_vsra(a, n)      vshlq_s32((a), vdupq_n_s32(-(int32_t)(n)))
+#define bfp_vmul(a, b)      vmulq_s32((a), (b))
+
+#else
+
+#define BFP_CODEC_LANES     (4U)
+#define BFP_CODEC_NAME      "generic"
+typedef struct BfpVec_t
+{
+    int32_t v[4];
+} BfpVec;
+
+static inline BfpVec bfp_vload(const void *p)
+{
+    BfpVec r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+static inline void bfp_vstore(void *p, BfpVec a)
+{
+    memcpy(p, a.v, sizeof(a.v));
+}
+static inline BfpVec bfp_vset1(int32_t x)
+{
+    BfpVec r = {{x, x, x, x}};
+    return r;
+}
+#define BFP_VEC_OP(name, expr) \
+    static inline BfpVec name(BfpVec a, BfpVec b) \
+    { \
+        BfpVec r; \
+        uint32_t i; \
+        for(i = 0; i < 4U; i++) { r.v[i] = (expr); } \
+        return r; \
+    }
+BFP_VEC_OP(bfp_vand, a.v[i] & b.v[i])
+BFP_VEC_OP(bfp_vor, a.v[i] | b.v[i])
+BFP_VEC_OP(bfp_vxor, a.v[i] ^ b.v[i])
+BFP_VEC_OP(bfp_vmul, (int32_t)((uint32_t)a.v[i] * (uint32_t)b.v[i]))
+#define BFP_VEC_SHIFT(name, expr) \
+    static inline BfpVec name(BfpVec a, uint32_t n) \
+    { \
+        BfpVec r; \
+        uint32_t i; \
+        for(i = 0; i < 4U; i++) { r.v[i] = (expr); } \
+        return r; \
+    }
+BFP_VEC_SHIFT(bfp_vsll, (int32_t)((uint32_t)a.v[i] << n))
+BFP_VEC_SHIFT(bfp_vsrl, (int32_t)((uint32_t)a.v[i] >> n))
+BFP_VEC_SHIFT(bfp_vsra, a.v[i] >> n)
+
+#endif
+
+/* ======================= Codec ======================= */
+
+#define BFP_CODEC_MAX_FIELDS (2U * DPC_OBJDET_BFP_MAX_BLOCK_SAMPLES)
+#define BFP_CODEC_MAX_WORDS  (DPC_OBJDET_BFP_MAX_BLOCK_SAMPLES + 1U)
+
+/* Block format of a compressed cube and where its mantissas sit */
+typedef struct BfpCodecFormat_t
+{
+    uint32_t samplesPerBlock;  //rangeBinsPerBlock
+    uint32_t wordsPerBlock;    //compressed block size in 32 bit words
+    uint32_t mantissaBW;       //real mantissa bits
+    uint32_t decrImagBitw;     //1 when the imaginary mantissa is one bit narrower
+    uint8_t  word[BFP_CODEC_MAX_FIELDS];  //word holding the first bit of each mantissa
+    uint8_t  bit[BFP_CODEC_MAX_FIELDS];   //its first bit in that word
+    uint8_t  width[BFP_CODEC_MAX_FIELDS]; //its bits
+} BfpCodecFormat;
+
+/* This function sets a format up for a compression ratio the way the DPC
+ * does and returns 0, or -1 when the ratio leaves no room for mantissas
+ */
+static inline int bfp_codec_format(BfpCodecFormat *fmt, float ratio, uint32_t samplesPerBlock, uint32_t decrImagBitw)
+{
+    uint32_t f, pos = DPC_OBJDET_BFP_SCALE_FAC_BW;
+
+    memset(fmt, 0, sizeof(*fmt));
+    if(samplesPerBlock == 0U || samplesPerBlock > DPC_OBJDET_BFP_MAX_BLOCK_SAMPLES || decrImagBitw > 1U)
+    {
+        return -1;
+    }
+    fmt->samplesPerBlock = samplesPerBlock;
+    fmt->wordsPerBlock = DPC_ObjDet_bfpWordsPerBlock(ratio, samplesPerBlock);
+    fmt->mantissaBW = DPC_ObjDet_bfpMantissaBW(fmt->wordsPerBlock, samplesPerBlock, decrImagBitw);
+    fmt->decrImagBitw = decrImagBitw;
+    if(fmt->wordsPerBlock == 0U || fmt->wordsPerBlock > samplesPerBlock || fmt->mantissaBW <= decrImagBitw)
+    {
+        return -1;
+    }
+    for(f = 0; f < 2U * samplesPerBlock; f++)
+    {
+        fmt->word[f] = (uint8_t)(pos >> 5);
+        fmt->bit[f] = (uint8_t)(pos & 31U);
+        fmt->width[f] = (uint8_t)((f & 1U) ? fmt->mantissaBW : fmt->mantissaBW - decrImagBitw);
+        pos += fmt->width[f];
+    }
+    return 0;
+}
+
+/* This function decompresses numBlocks blocks into cmplx16ImRe_t samples
+ * held as 16 bit pairs, imaginary first
+ */
+static inline void bfp_codec_decompress(const BfpCodecFormat *fmt, const uint32_t *in, uint32_t numBlocks, int16_t *out)
+{
+    static int32_t words[BFP_CODEC_MAX_WORDS][BFP_CODEC_LANES] __attribute__((aligned(32)));
+    static int32_t fields[BFP_CODEC_MAX_FIELDS][BFP_CODEC_LANES] __attribute__((aligned(32)));
+    int32_t mul[2][BFP_CODEC_LANES] __attribute__((aligned(32)));
+    const uint32_t wpb = fmt->wordsPerBlock;
+    const uint32_t numFields = 2U * fmt->samplesPerBlock;
+    uint32_t block, f, k, j;
+
+    for(block = 0; block + BFP_CODEC_LANES <= numBlocks; block += BFP_CODEC_LANES)
+    {
+        const uint32_t *src = &in[block * wpb];
+        int16_t *dst = &out[block * numFields];
+
+        //word k of every block side by side, and a zero word past the end
+        for(k = 0; k < wpb; k++)
+        {
+            for(j = 0; j < BFP_CODEC_LANES; j++)
+            {
+                words[k][j] = (int32_t)src[j * wpb + k];
+            }
+        }
+        memset(words[wpb], 0, sizeof(words[wpb]));
+
+        //the imaginary part is shifted by the scale factor, the real decrImagBitw less
+        for(j = 0; j < BFP_CODEC_LANES; j++)
+        {
+            uint32_t scaleFac = (uint32_t)words[0][j] & ((1U << DPC_OBJDET_BFP_SCALE_FAC_BW) - 1U);
+            mul[0][j] = 1 << scaleFac;
+            mul[1][j] = 1 << ((scaleFac > fmt->decrImagBitw) ? scaleFac - fmt->decrImagBitw : 0U);
+        }
+
+        for(f = 0; f < numFields; f++)
+        {
+            uint32_t b = fmt->bit[f];
+            uint32_t w = fmt->width[f];
+            BfpVec v = bfp_vsrl(bfp_vload(words[fmt->word[f]]), b);
+
+            if(b + w > 32U)
+            {
+                v = bfp_vor(v, bfp_vsll(bfp_vload(words[fmt->word[f] + 1U]), 32U - b));
+            }
+            //sign extend, then scale by the block's power of two
+            v = bfp_vsra(bfp_vsll(v, 32U - w), 32U - w);
+            bfp_vstore(fields[f], bfp_vmul(v, bfp_vload(mul[f & 1U])));
+        }
+
+        for(j = 0; j < BFP_CODEC_LANES; j++)
+        {
+            for(f = 0; f < numFields; f++)
+            {
+                dst[j * numFields + f] = (int16_t)fields[f][j];
+            }
+        }
+    }
+
+    for(; block < numBlocks; block++)
+    {
+        (void)DPC_ObjDet_bfpUnpackBlock(&in[block * wpb], fmt->samplesPerBlock, fmt->mantissaBW,
+                                        fmt->decrImagBitw, &out[block * numFields]);
+    }
+}
+
+/* This function compresses numBlocks blocks of cmplx16ImRe_t samples held
+ * as 16 bit pairs, imaginary first
+ */
+static inline void bfp_codec_compress(const BfpCodecFormat *fmt, const int16_t *in, uint32_t numBlocks, uint32_t *out)
+{
+    static int32_t words[BFP_CODEC_MAX_WORDS][BFP_CODEC_LANES] __attribute__((aligned(32)));
+    static int32_t fields[BFP_CODEC_MAX_FIELDS][BFP_CODEC_LANES] __attribute__((aligned(32)));
+    int32_t mul[2][BFP_CODEC_LANES] __attribute__((aligned(32)));
+    int32_t widest[BFP_CODEC_LANES] __attribute__((aligned(32)));
+    const uint32_t wpb = fmt->wordsPerBlock;
+    const uint32_t numFields = 2U * fmt->samplesPerBlock;
+    uint32_t block, f, k, j;
+
+    for(block = 0; block + BFP_CODEC_LANES <= numBlocks; block += BFP_CODEC_LANES)
+    {
+        const int16_t *src = &in[block * numFields];
+        uint32_t *dst = &out[block * wpb];
+        BfpVec mag = bfp_vset1(0);
+
+        for(j = 0; j < BFP_CODEC_LANES; j++)
+        {
+            for(f = 0; f < numFields; f++)
+            {
+                fields[f][j] = src[j * numFields + f];
+            }
+        }
+
+        //the OR of every sample with its sign bits folded off has the block's width
+        for(f = 0; f < numFields; f++)
+        {
+            BfpVec v = bfp_vload(fields[f]);
+            mag = bfp_vor(mag, bfp_vxor(v, bfp_vsra(v, 31U)));
+        }
+        bfp_vstore(widest, mag);
+
+        memset(words, 0, (wpb + 1U) * sizeof(words[0]));
+        for(j = 0; j < BFP_CODEC_LANES; j++)
+        {
+            uint32_t scaleFac = DPC_ObjDet_bfpScaleFactor(DPC_ObjDet_bfpBitWidth(widest[j]),
+                                                          fmt->mantissaBW, fmt->decrImagBitw);
+            uint32_t realShift = (scaleFac > fmt->decrImagBitw) ? scaleFac - fmt->decrImagBitw : 0U;
+
+            //x * 2^(16 - shift) >> 16 is x >> shift, without a per lane shift
+            words[0][j] = (int32_t)scaleFac;
+            mul[0][j] = 1 << (16U - scaleFac);
+            mul[1][j] = 1 << (16U - realShift);
+        }
+
+        for(f = 0; f < numFields; f++)
+        {
+            uint32_t b = fmt->bit[f];
+            uint32_t w = fmt->width[f];
+            BfpVec v = bfp_vsra(bfp_vmul(bfp_vload(fields[f]), bfp_vload(mul[f & 1U])), 16U);
+
+            v = bfp_vand(v, bfp_vset1((int32_t)((1U << w) - 1U)));
+            bfp_vstore(words[fmt->word[f]], bfp_vor(bfp_vload(words[fmt->word[f]]), bfp_vsll(v, b)));
+            if(b + w > 32U)
+            {
+                bfp_vstore(words[fmt->word[f] + 1U],
+                           bfp_vor(bfp_vload(words[fmt->word[f] + 1U]), bfp_vsrl(v, 32U - b)));
+            }
+        }
+
+        for(j = 0; j < BFP_CODEC_LANES; j++)
+        {
+            for(k = 0; k < wpb; k++)
+            {
+                dst[j * wpb + k] = (uint32_t)words[k][j];
+            }
+        }
+    }
+
+    for(; block < numBlocks; block++)
+    {
+        DPC_ObjDet_bfpPackBlock(&in[block * numFields], fmt->samplesPerBlock, wpb,
+                                fmt->decrImagBitw, &out[block * wpb]);
+    }
+}
+
+#endif /* BFP_CODEC_H */
@@ -0,0 +1,421 @@
+/*
+ * bfp_ref.c
+ *
+ * Host reference of the HWA BFP compression of the radar cube, for decoding
+ * compressed cubes captured off the board and for trying compression
+ * ratios on recorded cubes before setting compressionRatio in the profile.
+ *
+ * The codec is bfp_codec.h on top of the block format in dpc_bfp.h. Run
+ * without arguments it compresses the input of the HWA BFP example and
+ * checks the result against the example's expected outputs for all three
+ * ratios, with and without the narrower imaginary mantissa of ES2.0, checks
+ * the vector codec against the one block reference on random cubes of
+ * every format, and prints how fast both decode.
+ *
+ * "decode" turns a file of compressed blocks into cmplx16ImRe_t samples.
+ * "eval" compresses a file of cmplx16ImRe_t samples at every block size a
+ * ratio can give and prints the SQNR and how much the quantization noise
+ * raises the noise floor, taking the median block power as the floor like
+ * the ratio tuner in the DPC does.
+ *
+ * This runs on the PC, not on the board. Build with:
+ *     cc -O2 -Wall -I../TestProjects/empty_awr294x-evm_c66ss0_freertos_ti-c6000
+ *        -I../ExampleProjects/hwa_bfp_compression_awr294x-evm_c66ss0_nortos_ti-c6000
+ *        -o bfp_ref bfp_ref.c -lm
+ * adding -mavx2 for the AVX2 backend or -DBFP_CODEC_GENERIC for plain C,
+ * and run as:
+ *     ./bfp_ref
+ *     ./bfp_ref decode <samplesPerBlock> <ratio> <decrImagBitw> in.bin out.bin
+ *     ./bfp_ref eval <samplesPerBlock> <decrImagBitw> cube.bin
+ * It exits with 1 if a check fails or a file cannot be used.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define OBJDET_HOST_SIM
+#include "bfp_codec.h"
+
+//the ES2.0 expected outputs are only built for these parts
+#define SOC_AWR294X
+#include "hwa_bfp_input_testvector.h"
+#include "hwa_bfp_output_testvector.h"
+
+#define VEC_SAMPLES_PER_BLOCK (8U) //rangeBinsPerBlock of the HWA example
+#define VEC_NUM_SAMPLES (sizeof(gHWATest_compressBFP_input1) / sizeof(uint32_t))
+#define VEC_NUM_BLOCKS (VEC_NUM_SAMPLES / VEC_SAMPLES_PER_BLOCK)
+#define RAND_MAX_BLOCKS (1031U) //not a multiple of the lanes, so the tail is covered
+#define BENCH_NUM_BLOCKS (65536U)
+#define BENCH_ROUNDS (20U)
+
+static int gFailed = 0;
+static uint32_t gSeed = 1U;
+
+/* This function records one check
+ */
+static void check(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAILED: %s\n", what);
+        gFailed = 1;
+    }
+}
+
+/* This function returns a pseudo random 32 bit value
+ */
+static uint32_t ref_rand(void)
+{
+    gSeed = gSeed * 1664525U + 1013904223U;
+    return gSeed;
+}
+
+/* This function fills samples with noise of a random level per block, so
+ * every scale factor shows up
+ */
+static void ref_random_cube(int16_t *cube, uint32_t numBlocks, uint32_t samplesPerBlock)
+{
+    uint32_t block, i;
+    for(block = 0; block < numBlocks; block++)
+    {
+        uint32_t bits = ref_rand() >> 28; //0..15 bits below the sign
+        for(i = 0; i < 2U * samplesPerBlock; i++)
+        {
+            int32_t x = (int32_t)(ref_rand() >> 16) - 32768;
+            cube[block * 2U * samplesPerBlock + i] = (int16_t)(x >> (15U - bits));
+        }
+    }
+}
+
+/* This function returns seconds from a monotonic clock
+ */
+static double ref_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* This function reads a whole file, or returns NULL
+ */
+static void *ref_read_file(const char *path, size_t *size)
+{
+    FILE *fp = fopen(path, "rb");
+    void *data = NULL;
+    long len;
+
+    if(fp == NULL)
+    {
+        return NULL;
+    }
+    if(fseek(fp, 0, SEEK_END) == 0 && (len = ftell(fp)) > 0 && fseek(fp, 0, SEEK_SET) == 0)
+    {
+        data = malloc((size_t)len);
+        if(data != NULL && fread(data, 1, (size_t)len, fp) != (size_t)len)
+        {
+            free(data);
+            data = NULL;
+        }
+        *size = (size_t)len;
+    }
+    fclose(fp);
+    return data;
+}
+
+/* This function checks the codec against the HWA example vectors
+ */
+static void test_vectors(void)
+{
+    static const uint32_t *expected[2][3] = {
+        { gHWATest_decompBFP_output1, gHWATest_decompBFP_output2, gHWATest_decompBFP_output3 },
+        { gHWATest_decompBFP_output1_2p1, gHWATest_decompBFP_output2_2p1, gHWATest_decompBFP_output3_2p1 },
+    };
+    static uint32_t packed[VEC_NUM_SAMPLES];
+    static uint32_t decoded[VEC_NUM_SAMPLES];
+    const int16_t *input = (const int16_t *)gHWATest_compressBFP_input1;
+    uint32_t d, r;
+    char what[96];
+
+    for(d = 0; d < 2U; d++)
+    {
+        for(r = 0; r < 3U; r++)
+        {
+            BfpCodecFormat fmt;
+            int ok = bfp_codec_format(&fmt, compRatio[r], VEC_SAMPLES_PER_BLOCK, d) == 0;
+
+            snprintf(what, sizeof(what), "ratio %.2f decrImagBitw %u format", compRatio[r], d);
+            check(ok, what);
+            if(!ok)
+            {
+                continue;
+            }
+            bfp_codec_compress(&fmt, input, VEC_NUM_BLOCKS, packed);
+            bfp_codec_decompress(&fmt, packed, VEC_NUM_BLOCKS, (int16_t *)decoded);
+            snprintf(what, sizeof(what), "ratio %.2f decrImagBitw %u matches the HWA", compRatio[r], d);
+            check(memcmp(decoded, expected[d][r], sizeof(decoded)) == 0, what);
+        }
+    }
+}
+
+/* This function checks the vector codec against the one block reference
+ * for every format a ratio can give
+ */
+static void test_reference(void)
+{
+    static int16_t cube[RAND_MAX_BLOCKS * 2U * 32U];
+    static int16_t decoded[RAND_MAX_BLOCKS * 2U * 32U];
+    static int16_t refDecoded[RAND_MAX_BLOCKS * 2U * 32U];
+    static uint32_t packed[RAND_MAX_BLOCKS * 32U];
+    static uint32_t refPacked[RAND_MAX_BLOCKS * 32U];
+    uint32_t samplesPerBlock, words, d, block;
+    int packOk = 1, unpackOk = 1;
+
+    for(samplesPerBlock = 1U; samplesPerBlock <= 32U; samplesPerBlock++)
+    {
+        uint32_t numBlocks = RAND_MAX_BLOCKS - samplesPerBlock;
+        ref_random_cube(cube, numBlocks, samplesPerBlock);
+        for(d = 0; d < 2U; d++)
+        {
+            for(words = 1U; words <= samplesPerBlock; words++)
+            {
+                BfpCodecFormat fmt;
+                if(bfp_codec_format(&fmt, DPC_ObjDet_bfpRatio(words, samplesPerBlock), samplesPerBlock, d) != 0)
+                {
+                    continue;
+                }
+                packOk &= fmt.wordsPerBlock == words;
+
+                bfp_codec_compress(&fmt, cube, numBlocks, packed);
+                bfp_codec_decompress(&fmt, packed, numBlocks, decoded);
+                for(block = 0; block < numBlocks; block++)
+                {
+                    DPC_ObjDet_bfpPackBlock(&cube[block * 2U * samplesPerBlock], samplesPerBlock, words, d,
+                                            &refPacked[block * words]);
+                    (void)DPC_ObjDet_bfpUnpackBlock(&refPacked[block * words], samplesPerBlock,
+                                                    fmt.mantissaBW, d,
+                                                    &refDecoded[block * 2U * samplesPerBlock]);
+                }
+                packOk &= memcmp(packed, refPacked, numBlocks * words * sizeof(uint32_t)) == 0;
+                unpackOk &= memcmp(decoded, refDecoded, numBlocks * 2U * samplesPerBlock * sizeof(int16_t)) == 0;
+            }
+        }
+    }
+    check(packOk, "vector compress matches the reference");
+    check(unpackOk, "vector decompress matches the reference");
+}
+
+/* This function prints how fast the reference and the codec decode a cube
+ * of the HWA example's block format at ratio 0.5
+ */
+static void bench(void)
+{
+    static int16_t cube[BENCH_NUM_BLOCKS * 2U * VEC_SAMPLES_PER_BLOCK];
+    static uint32_t packed[BENCH_NUM_BLOCKS * VEC_SAMPLES_PER_BLOCK];
+    BfpCodecFormat fmt;
+    double t0, refS, vecS, mbytes;
+    uint32_t round, block;
+
+    (void)bfp_codec_format(&fmt, 0.5F, VEC_SAMPLES_PER_BLOCK, 1U);
+    ref_random_cube(cube, BENCH_NUM_BLOCKS, VEC_SAMPLES_PER_BLOCK);
+    bfp_codec_compress(&fmt, cube, BENCH_NUM_BLOCKS, packed);
+
+    t0 = ref_now();
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for(block = 0; block < BENCH_NUM_BLOCKS; block++)
+        {
+            (void)DPC_ObjDet_bfpUnpackBlock(&packed[block * fmt.wordsPerBlock], VEC_SAMPLES_PER_BLOCK,
+                                            fmt.mantissaBW, fmt.decrImagBitw,
+                                            &cube[block * 2U * VEC_SAMPLES_PER_BLOCK]);
+        }
+    }
+    refS = ref_now() - t0;
+
+    t0 = ref_now();
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        bfp_codec_decompress(&fmt, packed, BENCH_NUM_BLOCKS, cube);
+    }
+    vecS = ref_now() - t0;
+
+    //throughput counted in decoded bytes, what the cube is on the board
+    mbytes = (double)BENCH_ROUNDS * sizeof(cube) / 1e6;
+    printf("decode: reference %.0f MB/s, %s %.0f MB/s\n", mbytes / refS, BFP_CODEC_NAME, mbytes / vecS);
+}
+
+/* This function decodes a file of compressed blocks
+ */
+static int run_decode(uint32_t samplesPerBlock, float ratio, uint32_t decrImagBitw,
+                      const char *inPath, const char *outPath)
+{
+    BfpCodecFormat fmt;
+    uint32_t *packed;
+    int16_t *decoded;
+    size_t size = 0, numBlocks;
+    FILE *fp;
+    int ret = 1;
+
+    if(bfp_codec_format(&fmt, ratio, samplesPerBlock, decrImagBitw) != 0)
+    {
+        fprintf(stderr, "no BFP format for %u samples at ratio %.3f\n", samplesPerBlock, ratio);
+        return 1;
+    }
+    packed = ref_read_file(inPath, &size);
+    if(packed == NULL)
+    {
+        fprintf(stderr, "cannot read %s\n", inPath);
+        return 1;
+    }
+    numBlocks = size / (fmt.wordsPerBlock * sizeof(uint32_t));
+    if(numBlocks * fmt.wordsPerBlock * sizeof(uint32_t) != size)
+    {
+        fprintf(stderr, "%s is not whole blocks of %u words\n", inPath, fmt.wordsPerBlock);
+        free(packed);
+        return 1;
+    }
+
+    decoded = malloc(numBlocks * 2U * samplesPerBlock * sizeof(int16_t));
+    fp = fopen(outPath, "wb");
+    if(decoded != NULL && fp != NULL)
+    {
+        bfp_codec_decompress(&fmt, packed, (uint32_t)numBlocks, decoded);
+        if(fwrite(decoded, 2U * samplesPerBlock * sizeof(int16_t), numBlocks, fp) == numBlocks)
+        {
+            printf("%zu blocks, %u words each, mantissa %u bits\n", numBlocks, fmt.wordsPerBlock, fmt.mantissaBW);
+            ret = 0;
+        }
+    }
+    if(ret != 0)
+    {
+        fprintf(stderr, "cannot write %s\n", outPath);
+    }
+    if(fp != NULL)
+    {
+        fclose(fp);
+    }
+    free(decoded);
+    free(packed);
+    return ret;
+}
+
+/* This function sorts block powers for the median
+ */
+static int ref_cmp_float(const void *a, const void *b)
+{
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+/* This function prints what every block size does to a recorded cube
+ */
+static int run_eval(uint32_t samplesPerBlock, uint32_t decrImagBitw, const char *path)
+{
+    uint32_t numFields = 2U * samplesPerBlock;
+    size_t size = 0, numBlocks, block, i;
+    int16_t *cube, *decoded;
+    uint32_t *packed, words;
+    float *power;
+    double signal = 0.0, noiseFloor;
+
+    cube = ref_read_file(path, &size);
+    if(cube == NULL)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    numBlocks = size / (numFields * sizeof(int16_t));
+    if(numBlocks == 0U || samplesPerBlock > DPC_OBJDET_BFP_MAX_BLOCK_SAMPLES || decrImagBitw > 1U)
+    {
+        fprintf(stderr, "%s has no whole block of %u samples\n", path, samplesPerBlock);
+        free(cube);
+        return 1;
+    }
+    decoded = malloc(numBlocks * numFields * sizeof(int16_t));
+    packed = malloc(numBlocks * samplesPerBlock * sizeof(uint32_t));
+    power = malloc(numBlocks * sizeof(float));
+    if(decoded == NULL || packed == NULL || power == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        free(cube); free(decoded); free(packed); free(power);
+        return 1;
+    }
+
+    //power per sample, per component like the tuner
+    for(block = 0; block < numBlocks; block++)
+    {
+        double p = 0.0;
+        for(i = 0; i < numFields; i++)
+        {
+            double x = cube[block * numFields + i];
+            p += x * x;
+        }
+        signal += p;
+        power[block] = (float)(p / numFields);
+    }
+    qsort(power, numBlocks, sizeof(float), ref_cmp_float);
+    noiseFloor = power[numBlocks / 2U];
+
+    printf("%zu blocks, noise floor %.1f dB\n", numBlocks, 10.0 * log10(noiseFloor + 1e-12));
+    printf("words  ratio  mantissa  sqnr dB  loss dB\n");
+    for(words = 1U; words <= samplesPerBlock; words++)
+    {
+        BfpCodecFormat fmt;
+        double err = 0.0;
+
+        if(bfp_codec_format(&fmt, DPC_ObjDet_bfpRatio(words, samplesPerBlock), samplesPerBlock, decrImagBitw) != 0)
+        {
+            continue;
+        }
+        bfp_codec_compress(&fmt, cube, (uint32_t)numBlocks, packed);
+        bfp_codec_decompress(&fmt, packed, (uint32_t)numBlocks, decoded);
+        for(i = 0; i < numBlocks * numFields; i++)
+        {
+            double e = (double)cube[i] - (double)decoded[i];
+            err += e * e;
+        }
+        printf("%5u  %5.3f  %8u  %7.2f  %7.3f\n", words, DPC_ObjDet_bfpRatio(words, samplesPerBlock),
+               fmt.mantissaBW, 10.0 * log10((signal + 1e-12) / (err + 1e-12)),
+               10.0 * log10((noiseFloor + err / (double)(numBlocks * numFields)) / (noiseFloor + 1e-12)));
+    }
+
+    free(cube);
+    free(decoded);
+    free(packed);
+    free(power);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc == 7 && strcmp(argv[1], "decode") == 0)
+    {
+        return run_decode((uint32_t)atoi(argv[2]), (float)atof(argv[3]), (uint32_t)atoi(argv[4]),
+                          argv[5], argv[6]);
+    }
+    if(argc == 5 && strcmp(argv[1], "eval") == 0)
+    {
+        return run_eval((uint32_t)atoi(argv[2]), (uint32_t)atoi(argv[3]), argv[4]);
+    }
+    if(argc != 1)
+    {
+        fprintf(stderr, "usage: %s [decode <samplesPerBlock> <ratio> <decrImagBitw> in.bin out.bin |"
+                        " eval <samplesPerBlock> <decrImagBitw> cube.bin]\n", argv[0]);
+        return 1;
+    }
+
+    test_vectors();
+    test_reference();
+    if(gFailed)
+    {
+        printf("checks FAILED\n");
+        return 1;
+    }
+    printf("all checks passed (%s)\n", BFP_CODEC_NAME);
+    bench();
+    return 0;
+}
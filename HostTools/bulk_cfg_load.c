@@ -0,0 +1,384 @@
+/*
+ * bulk_cfg_load.c
+ *
+ * Sends a whole .cfg profile to the mmw demo CLI in one bulkCfg transaction
+ * instead of one line at a time.
+ *
+ * Writes "bulkCfg <bytes> <fletcher16>" ended by a single LF, waits for the
+ * board to answer Ready, sends the file in one write and then prints the
+ * board's replies until it reports Done or Error. The framing and the
+ * checksum come from mmw_bulk_cfg.h, the same code the MSS CLI uses.
+ *
+ * Run without arguments it checks the framing round trip: the bytes the
+ * host writes go through a model of the CLI, which reads the command line
+ * up to the first CR or LF as CLI_readLine does and then takes exactly the
+ * profile bytes, and the commands that come out are checked against the
+ * file, for LF and CR LF profiles, comments and empty lines, bad profiles
+ * and a command that fails part way.
+ *
+ * This runs on the PC, not on the board. Build with:
+ *     cc -O2 -Wall -I../ExampleProjects/out_of_box_2944_mss/include
+ *        -o bulk_cfg_load bulk_cfg_load.c
+ * and run as:
+ *     ./bulk_cfg_load
+ *     ./bulk_cfg_load /dev/ttyACM0 profile.cfg
+ * or with "-" as the port to only print the bulkCfg line for the file.
+ * It exits with 1 if a check fails or the profile was not applied.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+
+#include "mmw_bulk_cfg.h"
+
+#define REPLY_TIMEOUT_S (5)
+
+static uint8_t gCfg[MMWDEMO_BULK_CFG_MAX_SIZE];
+
+static int gFailed = 0;
+
+/* This function records a failed check
+ */
+static void check(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAILED: %s\n", what);
+        gFailed = 1;
+    }
+}
+
+/* ======================= Framing round trip ======================= */
+
+//bytes on their way from the host to the board
+static uint8_t gWire[2U * MMWDEMO_BULK_CFG_MAX_SIZE];
+static uint32_t gWireWr;
+static uint32_t gWireRd;
+
+//commands the board model ran, one per line as "name argc"
+static char gRan[4096];
+
+static MmwDemo_bulkCfg gBoardCfg;
+
+//commands the board model knows, failCmd fails when it runs
+static const char *gBoardCmds[] = {"sensorStop", "flushCfg", "channelCfg", "profileCfg", "chirpCfg",
+                                   "frameCfg", "cfarCfg", "guiMonitor", "sensorStart", "bulkCfg"};
+static const char *gFailCmd;
+
+/* This function writes bytes as the host would to the serial port
+ */
+static void wire_write(const void *data, uint32_t size)
+{
+    memcpy(&gWire[gWireWr], data, size);
+    gWireWr += size;
+}
+
+/* This function is the lookup of the board model, bulkCfg itself is not
+ * allowed in a profile as on the board
+ */
+static void *board_lookup(void *arg, const char *cmd)
+{
+    uint32_t i;
+    (void)arg;
+    for(i = 0; i < sizeof(gBoardCmds) / sizeof(gBoardCmds[0]); i++)
+    {
+        if(strcmp(gBoardCmds[i], cmd) == 0)
+        {
+            return (strcmp(cmd, MMWDEMO_BULK_CFG_CMD) == 0) ? NULL : (void *)gBoardCmds[i];
+        }
+    }
+    return NULL;
+}
+
+/* This function runs one command on the board model
+ */
+static int32_t board_run(const char *cmd, uint32_t argc)
+{
+    char one[64];
+    snprintf(one, sizeof(one), "%s %u\n", cmd, argc);
+    strncat(gRan, one, sizeof(gRan) - strlen(gRan) - 1U);
+    return (gFailCmd != NULL && strcmp(cmd, gFailCmd) == 0) ? -1 : 0;
+}
+
+/* This function is the board side: reads the command line up to the first
+ * CR or LF like CLI_readLine, then the profile like MmwDemo_CLIBulkCfg.
+ * It returns 0 when applied, or the error MmwDemo_CLIBulkCfg returns.
+ */
+static int32_t board_bulk(void)
+{
+    char line[128];
+    uint32_t n = 0;
+    uint32_t size, i;
+    uint16_t checksum;
+    char *name, *sizeArg, *sumArg;
+
+    while(gWireRd < gWireWr && gWire[gWireRd] != '\r' && gWire[gWireRd] != '\n' && n + 1 < sizeof(line))
+    {
+        line[n++] = (char)gWire[gWireRd++];
+    }
+    line[n] = 0;
+    gWireRd++; //the terminator
+
+    name = strtok(line, " \t");
+    sizeArg = strtok(NULL, " \t");
+    sumArg = strtok(NULL, " \t");
+    if(name == NULL || sizeArg == NULL || sumArg == NULL || strcmp(name, MMWDEMO_BULK_CFG_CMD) != 0)
+    {
+        return -1;
+    }
+    size = (uint32_t)strtoul(sizeArg, NULL, 0);
+    checksum = (uint16_t)strtoul(sumArg, NULL, 16);
+    if(size == 0U || size > MMWDEMO_BULK_CFG_MAX_SIZE || gWireWr - gWireRd < size)
+    {
+        return -2;
+    }
+    memcpy(gBoardCfg.buf, &gWire[gWireRd], size);
+    gWireRd += size;
+    if(MmwDemo_bulkCfgChecksum(gBoardCfg.buf, size) != checksum)
+    {
+        return -3;
+    }
+    if(MmwDemo_bulkCfgParse(&gBoardCfg, size, board_lookup, NULL) != 0)
+    {
+        return -4;
+    }
+    for(i = 0; i < gBoardCfg.numLines; i++)
+    {
+        MmwDemo_bulkCfgLine *l = &gBoardCfg.line[i];
+        if(board_run(gBoardCfg.args[l->argStart], l->argc) != 0)
+        {
+            board_run("flushCfg", 1U);
+            return -5;
+        }
+    }
+    return 0;
+}
+
+/* This function sends a profile through the board model.
+ * crlf ends the command line with CR LF instead of the LF the host sends.
+ */
+static int32_t round_trip(const char *profile, int crlf)
+{
+    char cmd[64];
+    int32_t len;
+
+    gWireWr = 0;
+    gWireRd = 0;
+    gRan[0] = 0;
+    len = MmwDemo_bulkCfgFormatCmd(cmd, sizeof(cmd), (const uint8_t *)profile, (uint32_t)strlen(profile));
+    if(crlf)
+    {
+        cmd[len - 1] = '\r';
+        cmd[len++] = '\n';
+    }
+    wire_write(cmd, (uint32_t)len);
+    wire_write(profile, (uint32_t)strlen(profile));
+    return board_bulk();
+}
+
+static void test_round_trip(void)
+{
+    static const char expect[] =
+        "sensorStop 1\nflushCfg 1\nchannelCfg 4\nprofileCfg 15\nchirpCfg 9\nframeCfg 8\nsensorStart 1\n";
+    static const char lf[] =
+        "% demo profile\n"
+        "\n"
+        "sensorStop\n"
+        "flushCfg\n"
+        "channelCfg 15 5 0\n"
+        "profileCfg 0 77 7 7 57.14 0 0 70 1 256 5209 0 0 30\n"
+        "\t chirpCfg 0 0 0 0 0 0 0 1  \n"
+        "%frameCfg 0 0 1 0 100 1 0\n"
+        "frameCfg 0 0 64 0 100 1 0\n"
+        "sensorStart";
+    char crlf[sizeof(lf) + 16];
+    uint32_t i, j;
+
+    //the same profile with CR LF line ends and a blank first line
+    j = 0;
+    crlf[j++] = '\r';
+    crlf[j++] = '\n';
+    for(i = 0; lf[i] != 0; i++)
+    {
+        if(lf[i] == '\n')
+        {
+            crlf[j++] = '\r';
+        }
+        crlf[j++] = lf[i];
+    }
+    crlf[j] = 0;
+
+    gFailCmd = NULL;
+    check(round_trip(lf, 0) == 0 && strcmp(gRan, expect) == 0, "LF profile runs every command in order");
+    check(gWireRd == gWireWr, "LF profile leaves nothing on the wire");
+    check(round_trip(crlf, 0) == 0 && strcmp(gRan, expect) == 0, "CR LF profile runs every command in order");
+    check(gWireRd == gWireWr, "CR LF profile leaves nothing on the wire");
+
+    //a CR LF after the command line shifts the profile by the LF
+    check(round_trip(lf, 1) == -3 && gWireWr - gWireRd == 1U, "CR LF command line fails the checksum");
+
+    check(round_trip("sensorStop\nprofilecfg 0\nsensorStart\n", 0) == -4 && gRan[0] == 0,
+          "unknown command refuses the whole profile");
+    check(round_trip("sensorStop\nbulkCfg 4 0\n", 0) == -4 && gRan[0] == 0, "nested bulkCfg is refused");
+    check(round_trip("% only comments\n\r\n\n", 0) == 0 && gRan[0] == 0, "profile of comments runs nothing");
+
+    gFailCmd = "frameCfg";
+    check(round_trip(lf, 0) == -5 &&
+          strcmp(gRan, "sensorStop 1\nflushCfg 1\nchannelCfg 4\nprofileCfg 15\nchirpCfg 9\nframeCfg 8\nflushCfg 1\n") == 0,
+          "failing command stops the profile and rolls back");
+    gFailCmd = NULL;
+}
+
+/* ======================= Serial port ======================= */
+
+/* This function reads one line from the board, or returns -1 on timeout
+ */
+static int read_line(int fd, char *line, size_t size)
+{
+    size_t n = 0;
+    while(n + 1 < size)
+    {
+        fd_set rd;
+        struct timeval tv = {REPLY_TIMEOUT_S, 0};
+        char c;
+        FD_ZERO(&rd);
+        FD_SET(fd, &rd);
+        if(select(fd + 1, &rd, NULL, NULL, &tv) <= 0 || read(fd, &c, 1) != 1)
+        {
+            return -1;
+        }
+        if(c == '\n')
+        {
+            break;
+        }
+        if(c != '\r')
+        {
+            line[n++] = c;
+        }
+    }
+    line[n] = 0;
+    return 0;
+}
+
+/* This function sets the port to raw 115200 8N1
+ */
+static int open_port(const char *path)
+{
+    struct termios tio;
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    if(tcgetattr(fd, &tio) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+int main(int argc, char *argv[])
+{
+    char header[64];
+    char line[256];
+    size_t size;
+    FILE *f;
+    int fd;
+
+    if(argc == 1)
+    {
+        test_round_trip();
+        printf(gFailed ? "checks FAILED\n" : "all checks passed\n");
+        return gFailed;
+    }
+    if(argc != 3)
+    {
+        printf("Usage: %s [<serial port | -> <profile.cfg>]\n", argv[0]);
+        return 1;
+    }
+
+    f = fopen(argv[2], "rb");
+    if(f == NULL)
+    {
+        printf("cannot open %s\n", argv[2]);
+        return 1;
+    }
+    size = fread(gCfg, 1, sizeof(gCfg), f);
+    if(!feof(f))
+    {
+        printf("%s is larger than %u bytes\n", argv[2], MMWDEMO_BULK_CFG_MAX_SIZE);
+        fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    //a single LF, the CLI would take the LF of a CR LF as the first profile byte
+    MmwDemo_bulkCfgFormatCmd(header, sizeof(header), gCfg, (uint32_t)size);
+    if(strcmp(argv[1], "-") == 0)
+    {
+        fputs(header, stdout);
+        return 0;
+    }
+
+    fd = open_port(argv[1]);
+    if(fd < 0)
+    {
+        printf("cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    //the board must be sitting in its read before the profile goes out
+    if(write(fd, header, strlen(header)) != (ssize_t)strlen(header))
+    {
+        printf("write failed\n");
+        return 1;
+    }
+    do
+    {
+        if(read_line(fd, line, sizeof(line)) != 0)
+        {
+            printf("no Ready from the board\n");
+            return 1;
+        }
+    } while(strstr(line, "Ready") == NULL && strstr(line, "Error") == NULL);
+    if(strstr(line, "Error") != NULL)
+    {
+        printf("%s\n", line);
+        return 1;
+    }
+
+    if(write(fd, gCfg, size) != (ssize_t)size)
+    {
+        printf("write failed\n");
+        return 1;
+    }
+    while(read_line(fd, line, sizeof(line)) == 0)
+    {
+        if(line[0] != 0)
+        {
+            printf("%s\n", line);
+        }
+        if(strncmp(line, "Done", 4) == 0)
+        {
+            return 0;
+        }
+        if(strncmp(line, "Error", 5) == 0)
+        {
+            return 1;
+        }
+    }
+    printf("no reply from the board\n");
+    return 1;
+}
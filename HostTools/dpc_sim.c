@@ -0,0 +1,1697 @@
+/*
+ * dpc_sim.c
+ *
+ * Host side simulation of the object detection DPC that runs on the DSP.
+ *
+ * Builds the DPC math from objdet_math.h (the same code objectdetection.c
+ * runs) with plain C in place of the C66x intrinsics and mathlib, and
+ * feeds it the detection lists the HWA stages would hand over:
+ *  - the Doppler DPU detection list (DetObjParams, 160 bytes each)
+ *  - the range CFAR list and its cumulative count per Doppler bin
+ * Then it runs the same steps as DPC_ObjectDetection_execute after the
+ * HWA is done: range/Doppler intersection with a memcpy standing in for
+ * the EDMA into L2, and DPC_ObjDet_estimateXYZ. The intersection is also
+ * timed on clutter heavy scenes with the range CFAR bitmap and with the
+ * per Doppler bin list search it replaced, and a few frames are run
+ * through the pipelined AoA order and compared with the normal one. The
+ * window generators and their cache, the memory pool, the memory map from
+ * dpc_mem_map.h, the stage timing histograms from dpc_stage_timing.h and
+ * the BFP block format and compression ratio tuner from dpc_bfp.h and
+ * the HSRAM result slot hand-off from dpc_result_slot.h are checked on
+ * their own. The batched estimateXYZ from
+ * objdet_simd.h is run on the same list, checked against the per object
+ * one and timed next to it.
+ *
+ * The synthetic scene puts targets at known positions behind a permuted
+ * antenna geometry with per antenna phase errors that the calibration
+ * params undo, and adds clutter that both CFARs see, Doppler detections
+ * range CFAR rejects and range CFAR detections with no Doppler partner.
+ *
+ * Scenes can be saved and replayed. The file is a SimSceneHeader then the
+ * DetObjParams, RangeCfarListObj and per Doppler bin counts exactly as the
+ * DSP holds them, then the ground truth (none for a captured scene), so a
+ * memory dump of those DSP buffers can be wrapped with a header and replayed.
+ * A capture the DSP recorded with DPC_OBJDET_CAPTURE_RECORD is replayed
+ * record by record: the intersection has to give the recorded final list
+ * exactly, the AoA the recorded points within what mathlib and libm differ.
+ *
+ * This runs on the PC, not on the board. Build with:
+ *     cc -O2 -DOBJDET_HOST_SIM -I../TestProjects/empty_awr294x-evm_c66ss0_freertos_ti-c6000 -o dpc_sim dpc_sim.c -lm
+ * and run as:
+ *     ./dpc_sim                    synthetic scene
+ *     ./dpc_sim record scene.bin   synthetic scene, also saved to scene.bin
+ *     ./dpc_sim replay scene.bin   saved or captured scene
+ *     ./dpc_sim caprecord cap.bin  synthetic scene, frames also captured to cap.bin
+ *     ./dpc_sim capreplay cap.bin  replays a capture (dpc_capture.h) and exits
+ * Add -mavx2 for the 8 lane AVX batch, or -DOBJDET_SIMD_GENERIC for the
+ * plain C one. SSE2 is the default on x86-64 and NEON on 64 bit ARM.
+ * It exits with 1 if any check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "objdet_math.h"
+#include "objdet_simd.h"
+
+#define SIM_MAGIC (0x53435044U) //"DPCS"
+#define SIM_VERSION (2U)
+#define SIM_MAX_DET (1024U)
+#define SIM_MAX_RANGE_CFAR (1024U)
+#define SIM_MAX_DOP_BINS (512U)
+#define SIM_MAX_TRUTH (256U)
+#define SIM_L2_SCRATCH_SIZE (48U * 1024U) //core local scratch the final list is carved from
+#define SIM_FRAMES (2000U) //frames timed per stage
+#define SIM_BITMAP_SIZE_WORDS (2048U) //RANGECFAR_BITMAP_SIZE_WORDS in objectdetection.c
+#define SIM_PIPE_FRAMES (6U) //frames run through the pipelined AoA
+
+//synthetic scene
+#define SIM_NUM_TARGETS (32U)
+#define SIM_NUM_CLUTTER (160U) //seen by both CFARs
+#define SIM_NUM_DOP_GHOSTS (96U) //Doppler CFAR only
+#define SIM_NUM_RANGE_GHOSTS (64U) //range CFAR only
+#define SIM_NUM_RANGE_BINS (256U)
+
+//everything about a scene that is not a list
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numDet;
+    uint32_t numRangeCfar;
+    uint32_t numTruth;
+    uint32_t numRangeBins;
+    uint16_t numDopplerBins;
+    uint16_t numAzimFFTBins;
+    float rangeStep;
+    float dopplerStep;
+    float xSpacingByLambda;
+    float zSpacingByLambda;
+    uint64_t zeroInsrtMaskAzim;
+    uint64_t zeroInsrtMaskElev;
+    uint16_t antennaGeometryCfg[MAX_NUM_VIRT_ANT];
+    float antennaCalibParams[2U * MAX_NUM_VIRT_ANT];
+    ObjDetFovAoaSinVal fov;
+} SimSceneHeader;
+
+//where a synthetic target really is
+typedef struct {
+    uint32_t detIdx; //its entry in the Doppler detection list
+    float x;
+    float y;
+    float z;
+    float velocity;
+} SimTruth;
+
+typedef struct {
+    SimSceneHeader hdr;
+    DetObjParams det[SIM_MAX_DET];
+    RangeCfarListObj rangeCfar[SIM_MAX_RANGE_CFAR];
+    uint16_t perDop[SIM_MAX_DOP_BINS]; //cumulative range CFAR count up to each Doppler bin
+    SimTruth truth[SIM_MAX_TRUTH];
+} SimScene;
+
+static SimScene gScene;
+static SimScene gDense; //clutter heavy scenes for the intersection benchmark
+static uint32_t gRangeCfarBitmap[SIM_BITMAP_SIZE_WORDS];
+static uint16_t gValidIdx[SIM_MAX_DET]; //gIntersectValidIdx in objectdetection.c
+static uint32_t gNumRuns; //EDMA transfers the last intersection took
+static DPIF_PointCloudCartesian gSerialOut[SIM_PIPE_FRAMES][SIM_MAX_DET];
+static uint32_t gSerialNumOut[SIM_PIPE_FRAMES];
+static DPIF_PointCloudCartesian gPipeOut[2][SIM_MAX_DET]; //gAoaObjOut in objectdetection.c
+static DPIF_PointCloudSideInfo gPipeSideInfo[2][SIM_MAX_DET];
+static uint8_t gL2Scratch[SIM_L2_SCRATCH_SIZE] __attribute__((aligned(8)));
+static DPIF_PointCloudCartesian gObjOut[SIM_MAX_DET];
+static DPIF_PointCloudSideInfo gSideInfo[SIM_MAX_DET];
+static DPIF_PointCloudCartesian gObjOutBatch[SIM_MAX_DET];
+static DPIF_PointCloudSideInfo gSideInfoBatch[SIM_MAX_DET];
+static uint32_t gSeed = 1234U;
+static int gFailed = 0;
+
+cmplxfImRe_t dftSinCosTable[AOA_DFT_LEN];
+
+static void check(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("  FAIL: %s\n", what);
+        gFailed = 1;
+    }
+}
+
+/* ======================= SDK stand-ins ======================= */
+
+/* This function generates the first winGenLen coefficients of a window
+ * like the mmWave SDK mathutils does
+ */
+void mathUtils_genWindow(uint32_t *win, uint32_t windowLength, uint32_t winGenLen,
+                         uint32_t winType, uint32_t qFormat)
+{
+    uint32_t i;
+    double oneQformat = (double)(1U << qFormat);
+    double phi = 2.0 * 3.14159265358979323846 / ((double)windowLength - 1.0);
+
+    for(i = 0; i < winGenLen; i++)
+    {
+        double val;
+        if(winType == MATHUTILS_WIN_HANNING)
+        {
+            val = 0.5 - 0.5 * cos(phi * i);
+        }
+        else if(winType == MATHUTILS_WIN_BLACKMAN)
+        {
+            val = 0.42 - 0.5 * cos(phi * i) + 0.08 * cos(2.0 * phi * i);
+        }
+        else
+        {
+            val = 1.0;
+        }
+        uint32_t q = (uint32_t)(oneQformat * val + 0.5);
+        win[i] = (q >= (1U << qFormat)) ? (1U << qFormat) - 1U : q; //clip to the Q format
+    }
+}
+
+/* This function fills the DFT table, e^(-j 2 pi k / AOA_DFT_LEN).
+ * On the DSP the table comes from cossintable.c.
+ */
+static void make_dft_table(void)
+{
+    uint32_t k;
+    for(k = 0; k < AOA_DFT_LEN; k++)
+    {
+        double w = 2.0 * 3.14159265358979323846 * k / AOA_DFT_LEN;
+        dftSinCosTable[k].real = (float)cos(w);
+        dftSinCosTable[k].imag = (float)-sin(w);
+    }
+}
+
+/* ======================= Synthetic scene ======================= */
+
+static uint32_t sim_rand(void)
+{
+    gSeed = gSeed * 1103515245U + 12345U;
+    return gSeed >> 8;
+}
+
+static double sim_uniform(double lo, double hi)
+{
+    return lo + (hi - lo) * (double)(sim_rand() & 0xFFFFU) / 65535.0;
+}
+
+static double sim_noise(double sigma)
+{
+    return sigma * (sim_uniform(-1.0, 1.0) + sim_uniform(-1.0, 1.0) + sim_uniform(-1.0, 1.0));
+}
+
+/* This function returns the positions set in a zero insertion mask
+ */
+static uint32_t mask_positions(uint64_t mask, uint32_t *pos, uint32_t max)
+{
+    uint32_t n = 0;
+    uint32_t bit;
+    for(bit = 0; bit < 64U && n < max; bit++)
+    {
+        if((mask >> bit) & 1U)
+        {
+            pos[n++] = bit;
+        }
+    }
+    return n;
+}
+
+/* This function builds one Doppler detection the way the HWA would hand
+ * it over: raw antenna samples in geometry order with the phase errors
+ * still in them, and the azimuth FFT peak as log2 magnitude in Q11.
+ */
+static void make_det(DetObjParams *det, uint32_t rangeIdx, int32_t dopBin, double sinAzim, double sinElev, double amp, const double *phaseErr)
+{
+    const SimSceneHeader *h = &gScene.hdr;
+    uint32_t azimPos[MAX_NUM_AZIM_VIRT_ANT], elevPos[MAX_NUM_ELEV_VIRT_ANT];
+    double rowRe[64] = {0}, rowIm[64] = {0};
+    double mag[64];
+    double cosElev = sqrt(1.0 - sinElev * sinElev);
+    double wx = 2.0 * 3.14159265358979323846 * h->xSpacingByLambda * sinAzim * cosElev;
+    double wz = 2.0 * 3.14159265358979323846 * h->zSpacingByLambda * sinElev;
+    double noise = amp / 200.0;
+    uint32_t k, p, peak = 0;
+
+    memset(det, 0, sizeof(*det));
+    mask_positions(h->zeroInsrtMaskAzim, azimPos, MAX_NUM_AZIM_VIRT_ANT);
+    mask_positions(h->zeroInsrtMaskElev, elevPos, MAX_NUM_ELEV_VIRT_ANT);
+
+    for(k = 0; k < MAX_NUM_VIRT_ANT; k++)
+    {
+        int isAzim = k < MAX_NUM_AZIM_VIRT_ANT;
+        uint32_t pos = isAzim ? azimPos[k] : elevPos[k - MAX_NUM_AZIM_VIRT_ANT];
+        double ph = wx * pos - (isAzim ? 0.0 : wz);
+        double re = amp * cos(ph) + sim_noise(noise);
+        double im = amp * sin(ph) + sim_noise(noise);
+        cmplx32ImRe_t *dst = isAzim ? &det->azimSamples[h->antennaGeometryCfg[k]] :
+                                      &det->elevSamples[h->antennaGeometryCfg[k]];
+        //the antenna adds its phase error, the calib params take it back out
+        dst->real = (int32_t)(re * cos(phaseErr[k]) - im * sin(phaseErr[k]));
+        dst->imag = (int32_t)(re * sin(phaseErr[k]) + im * cos(phaseErr[k]));
+        if(isAzim)
+        {
+            rowRe[pos] = re;
+            rowIm[pos] = im;
+        }
+    }
+
+    //azimuth FFT over the zero inserted row
+    for(k = 0; k < h->numAzimFFTBins; k++)
+    {
+        double sRe = 0.0, sIm = 0.0;
+        for(p = 0; p < 64U; p++)
+        {
+            double w = -2.0 * 3.14159265358979323846 * k * p / h->numAzimFFTBins;
+            sRe += rowRe[p] * cos(w) - rowIm[p] * sin(w);
+            sIm += rowRe[p] * sin(w) + rowIm[p] * cos(w);
+        }
+        mag[k] = sqrt(sRe * sRe + sIm * sIm) + 1.0;
+        if(mag[k] > mag[peak])
+        {
+            peak = k;
+        }
+    }
+    det->azimIdx = peak;
+    det->azimPeakSamples[0] = (uint32_t)(log2(mag[(peak + h->numAzimFFTBins - 1U) % h->numAzimFFTBins]) * (1 << QVALUE_SIGNAL));
+    det->azimPeakSamples[1] = (uint32_t)(log2(mag[peak]) * (1 << QVALUE_SIGNAL));
+    det->azimPeakSamples[2] = (uint32_t)(log2(mag[(peak + 1U) % h->numAzimFFTBins]) * (1 << QVALUE_SIGNAL));
+
+    det->rangeIdx = rangeIdx;
+    det->dopIdxActual = (uint32_t)dopBin & (h->numDopplerBins - 1U);
+    det->dopIdx = det->dopIdxActual; //sub bands are not folded in the sim
+    det->dopCfarNoise = (uint32_t)(log2(noise * 12.0) * (1 << QVALUE_NOISE));
+}
+
+/* This function adds a range CFAR entry, the list is sorted at the end
+ */
+static void add_range_cfar(SimScene *scene, uint32_t rangeIdx, uint32_t dopIdx)
+{
+    RangeCfarListObj *r = &scene->rangeCfar[scene->hdr.numRangeCfar++];
+    r->rangeIdx = rangeIdx;
+    r->dopIdx = dopIdx;
+    r->rangeCFARNoise = 1000U;
+}
+
+static int cmp_range_cfar(const void *a, const void *b)
+{
+    const RangeCfarListObj *ra = (const RangeCfarListObj *)a;
+    const RangeCfarListObj *rb = (const RangeCfarListObj *)b;
+    return (ra->dopIdx != rb->dopIdx) ? ((ra->dopIdx < rb->dopIdx) ? -1 : 1) :
+           (ra->rangeIdx < rb->rangeIdx) ? -1 : (ra->rangeIdx > rb->rangeIdx);
+}
+
+/* This function builds the range CFAR per Doppler bin counts
+ */
+static void make_per_dop(SimScene *scene)
+{
+    uint32_t i, bin;
+    qsort(scene->rangeCfar, scene->hdr.numRangeCfar, sizeof(RangeCfarListObj), cmp_range_cfar);
+    memset(scene->perDop, 0, sizeof(scene->perDop));
+    for(i = 0; i < scene->hdr.numRangeCfar; i++)
+    {
+        scene->perDop[scene->rangeCfar[i].dopIdx]++;
+    }
+    for(bin = 1; bin < scene->hdr.numDopplerBins; bin++)
+    {
+        scene->perDop[bin] += scene->perDop[bin - 1U];
+    }
+}
+
+/* This function builds the synthetic scene
+ */
+static void make_scene(void)
+{
+    SimSceneHeader *h = &gScene.hdr;
+    double phaseErr[MAX_NUM_VIRT_ANT];
+    uint32_t i, k;
+
+    memset(&gScene, 0, sizeof(gScene));
+    h->magic = SIM_MAGIC;
+    h->version = SIM_VERSION;
+    h->numRangeBins = SIM_NUM_RANGE_BINS;
+    h->numDopplerBins = 64U;
+    h->numAzimFFTBins = 32U;
+    h->rangeStep = 0.15f;
+    h->dopplerStep = 0.12f;
+    h->xSpacingByLambda = 0.5f;
+    h->zSpacingByLambda = 0.5f;
+    h->zeroInsrtMaskAzim = 0xFFFU; //12 azimuth antennas side by side
+    h->zeroInsrtMaskElev = 0x3CU; //4 elevation antennas above positions 2 to 5
+    h->fov.minAzimuthSinVal = -1.0f;
+    h->fov.maxAzimuthSinVal = 1.0f;
+    h->fov.minElevationSinVal = -1.0f;
+    h->fov.maxElevationSinVal = 1.0f;
+
+    //antennas are wired out of order and each has its own phase error
+    for(k = 0; k < MAX_NUM_AZIM_VIRT_ANT; k++)
+    {
+        h->antennaGeometryCfg[k] = (uint16_t)((k * 5U) % MAX_NUM_AZIM_VIRT_ANT);
+    }
+    for(k = 0; k < MAX_NUM_ELEV_VIRT_ANT; k++)
+    {
+        h->antennaGeometryCfg[MAX_NUM_AZIM_VIRT_ANT + k] = (uint16_t)((k * 3U) % MAX_NUM_ELEV_VIRT_ANT);
+    }
+    for(k = 0; k < MAX_NUM_VIRT_ANT; k++)
+    {
+        phaseErr[k] = sim_uniform(-1.0, 1.0);
+        h->antennaCalibParams[2U * k] = (float)-sin(phaseErr[k]); //imag
+        h->antennaCalibParams[2U * k + 1U] = (float)cos(phaseErr[k]); //real
+    }
+
+    //real targets
+    for(i = 0; i < SIM_NUM_TARGETS; i++)
+    {
+        uint32_t rangeIdx = 20U + sim_rand() % (SIM_NUM_RANGE_BINS - 40U);
+        int32_t dopBin = (int32_t)(sim_rand() % (h->numDopplerBins - 2U)) - (int32_t)(h->numDopplerBins / 2U) + 1;
+        double sinAzim = sim_uniform(-0.6, 0.6);
+        double sinElev = sim_uniform(-0.3, 0.3);
+        double range = h->rangeStep * rangeIdx;
+        SimTruth *t = &gScene.truth[h->numTruth++];
+
+        t->detIdx = h->numDet;
+        t->x = (float)(range * sqrt(1.0 - sinElev * sinElev) * sinAzim);
+        t->z = (float)(range * sinElev);
+        t->y = (float)sqrt(range * range - t->x * t->x - t->z * t->z);
+        t->velocity = dopBin * h->dopplerStep;
+        make_det(&gScene.det[h->numDet++], rangeIdx, dopBin, sinAzim, sinElev, 20000.0, phaseErr);
+        add_range_cfar(&gScene, rangeIdx, (uint32_t)dopBin & (h->numDopplerBins - 1U));
+    }
+
+    //clutter both CFARs see, piled into a few Doppler bins like static ground returns
+    for(i = 0; i < SIM_NUM_CLUTTER; i++)
+    {
+        uint32_t rangeIdx = sim_rand() % SIM_NUM_RANGE_BINS;
+        int32_t dopBin = (int32_t)(sim_rand() % 3U) - 1;
+        make_det(&gScene.det[h->numDet++], rangeIdx, dopBin, sim_uniform(-0.9, 0.9), sim_uniform(-0.5, 0.5), 5000.0, phaseErr);
+        add_range_cfar(&gScene, rangeIdx, (uint32_t)dopBin & (h->numDopplerBins - 1U));
+    }
+
+    //Doppler CFAR false alarms and range CFAR only detections
+    for(i = 0; i < SIM_NUM_DOP_GHOSTS; i++)
+    {
+        make_det(&gScene.det[h->numDet++], sim_rand() % SIM_NUM_RANGE_BINS, (int32_t)(sim_rand() % h->numDopplerBins),
+                 sim_uniform(-0.9, 0.9), sim_uniform(-0.5, 0.5), 3000.0, phaseErr);
+    }
+    for(i = 0; i < SIM_NUM_RANGE_GHOSTS; i++)
+    {
+        add_range_cfar(&gScene, sim_rand() % SIM_NUM_RANGE_BINS, sim_rand() % h->numDopplerBins);
+    }
+    make_per_dop(&gScene);
+}
+
+/* ======================= Record / replay ======================= */
+
+static int save_scene(const char *path)
+{
+    const SimSceneHeader *h = &gScene.hdr;
+    FILE *f = fopen(path, "wb");
+    int ok;
+    if(f == NULL)
+    {
+        return -1;
+    }
+    ok = fwrite(h, sizeof(*h), 1, f) == 1 &&
+         fwrite(gScene.det, sizeof(DetObjParams), h->numDet, f) == h->numDet &&
+         fwrite(gScene.rangeCfar, sizeof(RangeCfarListObj), h->numRangeCfar, f) == h->numRangeCfar &&
+         fwrite(gScene.perDop, sizeof(uint16_t), h->numDopplerBins, f) == h->numDopplerBins &&
+         fwrite(gScene.truth, sizeof(SimTruth), h->numTruth, f) == h->numTruth;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+static int load_scene(const char *path)
+{
+    SimSceneHeader *h = &gScene.hdr;
+    FILE *f = fopen(path, "rb");
+    int ok;
+    if(f == NULL)
+    {
+        return -1;
+    }
+    memset(&gScene, 0, sizeof(gScene));
+    ok = fread(h, sizeof(*h), 1, f) == 1 && h->magic == SIM_MAGIC && h->version == SIM_VERSION &&
+         h->numDet <= SIM_MAX_DET && h->numRangeCfar <= SIM_MAX_RANGE_CFAR &&
+         h->numDopplerBins <= SIM_MAX_DOP_BINS && h->numTruth <= SIM_MAX_TRUTH &&
+         fread(gScene.det, sizeof(DetObjParams), h->numDet, f) == h->numDet &&
+         fread(gScene.rangeCfar, sizeof(RangeCfarListObj), h->numRangeCfar, f) == h->numRangeCfar &&
+         fread(gScene.perDop, sizeof(uint16_t), h->numDopplerBins, f) == h->numDopplerBins &&
+         fread(gScene.truth, sizeof(SimTruth), h->numTruth, f) == h->numTruth;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+/* ======================= DPC steps ======================= */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+/* This function is DPC_ObjDet_intersectDopAndRangeCFAR with a memcpy per
+ * run of neighbouring detections in place of the EDMA transfer into L2.
+ * useBitmap picks the range CFAR bitmap the DSP uses when the profile fits
+ * it, or the per Doppler bin list search it falls back to. It returns the
+ * final number of detections and leaves the number of runs in gNumRuns.
+ */
+static uint32_t sim_intersect(const SimScene *scene, int useBitmap, DetObjParams *finalDetObjList, uint32_t finalMaxNumDetObjs)
+{
+    const SimSceneHeader *h = &scene->hdr;
+    uint32_t rowWords = DPC_OBJDET_RANGECFAR_BITMAP_ROW_WORDS(h->numRangeBins);
+    uint32_t objIdx, isValidObj, numValidObjs = 0, runStart, runLen;
+
+    if(useBitmap)
+    {
+        DPC_ObjDet_rangeCfarBitmapMark(gRangeCfarBitmap, rowWords, h->numDopplerBins, h->numRangeBins,
+                                       scene->rangeCfar, scene->perDop[h->numDopplerBins - 1U], 1U);
+    }
+    for(objIdx = 0; objIdx < h->numDet; objIdx++)
+    {
+        if(useBitmap)
+        {
+            isValidObj = DPC_ObjDet_isDetInRangeCfarBitmap(&scene->det[objIdx], gRangeCfarBitmap,
+                                                           rowWords, h->numDopplerBins, h->numRangeBins);
+        }
+        else
+        {
+            isValidObj = DPC_ObjDet_isDetInRangeCfar(&scene->det[objIdx], scene->rangeCfar, scene->perDop);
+        }
+        if(isValidObj)
+        {
+            gValidIdx[numValidObjs++] = (uint16_t)objIdx;
+            if(numValidObjs >= finalMaxNumDetObjs)
+            {
+                break;
+            }
+        }
+    }
+    gNumRuns = 0;
+    for(runStart = 0; runStart < numValidObjs; runStart += runLen)
+    {
+        runLen = DPC_ObjDet_detObjRunLen(gValidIdx, numValidObjs, runStart);
+        memcpy(&finalDetObjList[runStart], &scene->det[gValidIdx[runStart]], runLen * sizeof(DetObjParams));
+        gNumRuns++;
+    }
+    if(useBitmap)
+    {
+        DPC_ObjDet_rangeCfarBitmapMark(gRangeCfarBitmap, rowWords, h->numDopplerBins, h->numRangeBins,
+                                       scene->rangeCfar, scene->perDop[h->numDopplerBins - 1U], 0U);
+    }
+    return numValidObjs;
+}
+
+/* This function says whether a scene fits the range CFAR bitmap
+ */
+static int sim_fits_bitmap(const SimScene *scene)
+{
+    const SimSceneHeader *h = &scene->hdr;
+    return h->numDopplerBins > 0 &&
+           h->numDopplerBins * DPC_OBJDET_RANGECFAR_BITMAP_ROW_WORDS(h->numRangeBins) <= SIM_BITMAP_SIZE_WORDS;
+}
+
+/* This function fills in what DPC_ObjDet_estimateXYZ reads from the DPC objects
+ */
+static void sim_xyz_cfg(DPC_ObjDet_XYZCfg *cfg)
+{
+    const SimSceneHeader *h = &gScene.hdr;
+    cfg->antennaCalibParams = h->antennaCalibParams;
+    cfg->antennaGeometryCfg = h->antennaGeometryCfg;
+    cfg->zeroInsrtMaskAzim = h->zeroInsrtMaskAzim;
+    cfg->zeroInsrtMaskElev = h->zeroInsrtMaskElev;
+    cfg->xSpacingByLambda = h->xSpacingByLambda;
+    cfg->zSpacingByLambda = h->zSpacingByLambda;
+    cfg->rangeStep = h->rangeStep;
+    cfg->dopplerStep = h->dopplerStep;
+    cfg->numAzimFFTBins = h->numAzimFFTBins;
+    cfg->numDopplerBins = h->numDopplerBins;
+    cfg->fov = h->fov;
+}
+
+/* ======================= Checks ======================= */
+
+static void test_mem_pool(void)
+{
+    static uint8_t buf[256] __attribute__((aligned(8)));
+    MemPoolObj pool;
+    uint8_t *a, *b, *c;
+
+    printf("memory pool:\n");
+    pool.cfg.addr = buf;
+    pool.cfg.size = sizeof(buf);
+    DPC_ObjDet_MemPoolReset(&pool);
+    a = (uint8_t *)DPC_ObjDet_MemPoolAlloc(&pool, 3U, 1U);
+    b = (uint8_t *)DPC_ObjDet_MemPoolAlloc(&pool, 16U, 8U);
+    check(a == buf && b == buf + 8, "allocations are aligned");
+    check(DPC_ObjDet_MemPoolAlloc(&pool, 512U, 4U) == NULL, "too large an allocation fails");
+    check(DPC_ObjDet_MemPoolGet(&pool) == buf + 24, "a failed allocation does not move the pool");
+    DPC_ObjDet_MemPoolSet(&pool, b);
+    c = (uint8_t *)DPC_ObjDet_MemPoolAlloc(&pool, 4U, 4U);
+    check(c == b, "rewind reuses the space");
+    check(DPC_ObjDet_MemPoolGetMaxUsage(&pool) == 24U, "max usage survives a rewind");
+    check(DPC_ObjDet_MemPoolAlloc(&pool, sizeof(buf) - 12U, 4U) != NULL &&
+          DPC_ObjDet_MemPoolGetMaxUsage(&pool) == sizeof(buf), "pool can be filled exactly");
+    DPC_ObjDet_MemPoolReset(&pool);
+    check(DPC_ObjDet_MemPoolGetMaxUsage(&pool) == 0U, "reset clears the usage");
+}
+
+static void test_mem_map(void)
+{
+    static uint8_t buf[256] __attribute__((aligned(8)));
+    static DPC_ObjDet_MemMap map;
+    MemPoolObj pool;
+    uint8_t *a, *b;
+    uint32_t i;
+
+    printf("memory map:\n");
+    pool.cfg.addr = buf;
+    pool.cfg.size = sizeof(buf);
+    DPC_ObjDet_MemPoolReset(&pool);
+    DPC_ObjDet_memMapReset(&map);
+    DPC_ObjDet_memMapSetPool(&map, DPC_OBJDET_MEMMAP_POOL_L2, sizeof(buf));
+
+    a = (uint8_t *)DPC_ObjDet_MemPoolAllocTagged(&pool, 3U, 1U, &map, DPC_OBJDET_MEMMAP_POOL_L2,
+                                                 DPC_OBJDET_MEMMAP_OWNER_RANGE, "first");
+    b = (uint8_t *)DPC_ObjDet_MemPoolAllocTagged(&pool, 16U, 8U, &map, DPC_OBJDET_MEMMAP_POOL_L2,
+                                                 DPC_OBJDET_MEMMAP_OWNER_DOPPLER, "a_long_buffer_name");
+    check(a == buf && b == buf + 8, "tagged allocations are the plain ones");
+    check(map.numEntries == 2U && map.entry[1].offset == 8U && map.entry[1].size == 16U &&
+          map.entry[1].alignWaste == 5U && map.entry[1].owner == DPC_OBJDET_MEMMAP_OWNER_DOPPLER,
+          "offset, size, owner and alignment waste are recorded");
+    check(strcmp(map.entry[1].name, "a_long_buff") == 0, "long names are cut and terminated");
+    check(map.pool[DPC_OBJDET_MEMMAP_POOL_L2].highWater == 24U &&
+          map.pool[DPC_OBJDET_MEMMAP_POOL_L2].alignWaste == 5U, "pool use follows the allocations");
+
+    check(DPC_ObjDet_MemPoolAllocTagged(&pool, 512U, 4U, &map, DPC_OBJDET_MEMMAP_POOL_L2,
+                                        DPC_OBJDET_MEMMAP_OWNER_AOA, "tooBig") == NULL, "too large a tagged allocation fails");
+    check(map.numNoFit == 1U && map.entry[2].offset == DPC_OBJDET_MEMMAP_NO_FIT && map.entry[2].size == 512U &&
+          map.pool[DPC_OBJDET_MEMMAP_POOL_L2].highWater == 24U, "a failed allocation is listed but not counted as used");
+
+    /* rewound scratch shows up as overlapping buffers, the high water stays */
+    DPC_ObjDet_MemPoolSet(&pool, buf);
+    (void)DPC_ObjDet_MemPoolAllocTagged(&pool, 8U, 4U, &map, DPC_OBJDET_MEMMAP_POOL_L2,
+                                        DPC_OBJDET_MEMMAP_OWNER_RANGE_CFAR, "scratch");
+    check(map.entry[3].offset == 0U && map.pool[DPC_OBJDET_MEMMAP_POOL_L2].highWater == 24U,
+          "rewound scratch keeps the high water");
+
+    for (i = map.numEntries; i < DPC_OBJDET_MEMMAP_MAX_ENTRIES + 3U; i++)
+    {
+        DPC_ObjDet_memMapAdd(&map, DPC_OBJDET_MEMMAP_POOL_HWA_PARAMSET, DPC_OBJDET_MEMMAP_OWNER_DPC,
+                             "params", i, 1U, 0U);
+    }
+    check(map.numEntries == DPC_OBJDET_MEMMAP_MAX_ENTRIES && map.numDropped == 3U &&
+          map.pool[DPC_OBJDET_MEMMAP_POOL_HWA_PARAMSET].highWater == DPC_OBJDET_MEMMAP_MAX_ENTRIES + 3U,
+          "a full map drops entries but still counts their use");
+    check(sizeof(DPC_ObjDet_MemMapEntry) == 24U, "entries are 24 bytes like the HSRAM copy");
+    DPC_ObjDet_memMapAdd(NULL, DPC_OBJDET_MEMMAP_POOL_L3, DPC_OBJDET_MEMMAP_OWNER_DPC, "none", 0U, 1U, 0U);
+}
+
+static void test_windows(void)
+{
+    uint32_t win[256];
+    uint8_t interf[5];
+    uint32_t i;
+    uint64_t t0, t1;
+
+    printf("windows:\n");
+    check(DPC_ObjDet_rangeWinGenLen(256U) == 128U && DPC_ObjDet_rangeWinGenLen(255U) == 128U, "symmetric range window length");
+    check(DPC_ObjDet_dopplerWinGenLen(64U) == 32U && DPC_ObjDet_dopplerWinGenLen(3U) == 2U, "symmetric Doppler window length");
+
+    t0 = now_ns();
+    for(i = 0; i < SIM_FRAMES; i++)
+    {
+        DPC_ObjDet_genRangeWindow(win, 256U, interf, 5U);
+    }
+    t1 = now_ns();
+    check(win[0] == 0U && win[127] >= (1U << 17) - 64U && win[127] < (1U << 17), "Hanning range window in Q17");
+    for(i = 1; i < 128U; i++)
+    {
+        check(win[i] >= win[i - 1U], "half window rises to the middle");
+    }
+    for(i = 1; i < 5U; i++)
+    {
+        check(interf[i] >= interf[i - 1U] && interf[i] < 32U, "interference window rises in Q5");
+    }
+    printf("  range window 256 samples  %6.2f us\n", (double)(t1 - t0) / SIM_FRAMES / 1000.0);
+
+    check(DPC_ObjDet_genDopplerWindow(win, 64U) == MATHUTILS_WIN_HANNING && win[0] == 0U, "Hanning Doppler window");
+    check(DPC_ObjDet_genDopplerWindow(win, 4U) == MATHUTILS_WIN_RECT && win[0] == (1U << 17) - 1U, "4 chirps use a rectangular window");
+}
+
+/* This function runs the window cache through a few configurations: a
+ * 4 sub-frame profile where every sub-frame has the same windows, one
+ * that no longer fits and starts the cache over, and one that still
+ * holds its first window when the second does not fit.
+ */
+static void test_win_cache(void)
+{
+    static uint32_t buf[256]; //1 KB, gWinBuf is 4 KB
+    static uint32_t ref[128];
+    DPC_ObjDet_WinCache cache;
+    uint32_t *range[4], *doppler[4];
+    uint32_t sf;
+    int same = 1;
+
+    printf("window cache:\n");
+    DPC_ObjDet_winCacheInit(&cache, buf, sizeof(buf));
+    DPC_ObjDet_winCacheNewConfig(&cache);
+    for(sf = 0; sf < 4U; sf++)
+    {
+        range[sf] = DPC_ObjDet_winCacheGet(&cache, 256U, 128U, MATHUTILS_WIN_HANNING, DPC_OBJDET_QFORMAT_RANGE_FFT);
+        doppler[sf] = DPC_ObjDet_winCacheGet(&cache, 128U, 64U, MATHUTILS_WIN_HANNING, DPC_OBJDET_QFORMAT_DOPPLER_FFT);
+        same &= (range[sf] == range[0]) && (doppler[sf] == doppler[0]);
+    }
+    check(range[0] != NULL && doppler[0] != NULL && range[0] != doppler[0], "range and Doppler windows are cached apart");
+    check(same && cache.numGenerated == 2U && cache.numHits == 6U, "sub-frames with the same windows share them");
+    mathUtils_genWindow(ref, 256U, 128U, MATHUTILS_WIN_HANNING, DPC_OBJDET_QFORMAT_RANGE_FFT);
+    check(memcmp(ref, range[0], 128U * sizeof(uint32_t)) == 0, "cached window is the generated one");
+    check(DPC_ObjDet_winCacheGet(&cache, 256U, 128U, MATHUTILS_WIN_HANNING, 15U) == NULL && cache.bypass,
+          "a window that does not fit next to held ones bypasses the cache");
+    check(DPC_ObjDet_winCacheGet(&cache, 128U, 64U, MATHUTILS_WIN_HANNING, DPC_OBJDET_QFORMAT_DOPPLER_FFT) == NULL,
+          "the rest of a bypassed configuration bypasses too");
+
+    //next configuration, nothing held yet
+    DPC_ObjDet_winCacheNewConfig(&cache);
+    range[0] = DPC_ObjDet_winCacheGet(&cache, 512U, 256U, MATHUTILS_WIN_HANNING, DPC_OBJDET_QFORMAT_RANGE_FFT);
+    check(range[0] == buf && !cache.bypass, "a configuration that holds nothing starts the cache over");
+    doppler[0] = DPC_ObjDet_winCacheGet(&cache, 4U, 2U, MATHUTILS_WIN_RECT, DPC_OBJDET_QFORMAT_DOPPLER_FFT);
+    check(doppler[0] == NULL && cache.bypass, "full cache bypasses");
+
+    DPC_ObjDet_winCacheNewConfig(&cache);
+    range[1] = DPC_ObjDet_winCacheGet(&cache, 128U, 64U, MATHUTILS_WIN_HANNING, DPC_OBJDET_QFORMAT_DOPPLER_FFT);
+    doppler[1] = DPC_ObjDet_winCacheGet(&cache, 4U, 2U, MATHUTILS_WIN_RECT, DPC_OBJDET_QFORMAT_DOPPLER_FFT);
+    check(range[1] != NULL && doppler[1] != NULL && !cache.bypass, "bypass ends with the configuration");
+    printf("  %u windows generated, %u served from the cache\n", cache.numGenerated, cache.numHits);
+}
+
+/* This function feeds the stage timing histogram a known spread of
+ * durations and checks its summary, and that every cycle count lands in
+ * the bin whose edges hold it.
+ */
+static void test_stage_hist(void)
+{
+    static DPC_ObjDet_StageHist hist;
+    DPC_ObjDet_StageSummary summary;
+    uint32_t i, bin, v, p99 = 1000U + 989U * 13U;
+    int binsOk = 1;
+
+    printf("stage timing histogram:\n");
+    for(v = 0; v < (1U << 16); v++)
+    {
+        bin = DPC_ObjDet_stageHistBin(v);
+        binsOk &= (bin < DPC_STAGE_HIST_NUM_BINS) && (v <= DPC_ObjDet_stageHistBinTop(bin)) &&
+                  (bin == 0U || v > DPC_ObjDet_stageHistBinTop(bin - 1U));
+    }
+    bin = DPC_ObjDet_stageHistBin(0xFFFFFFFFU);
+    binsOk &= (bin == DPC_STAGE_HIST_NUM_BINS - 1U) && (DPC_ObjDet_stageHistBinTop(bin) == 0xFFFFFFFFU);
+    check(binsOk, "every count lands in the bin that holds it");
+
+    DPC_ObjDet_stageHistReset(&hist);
+    DPC_ObjDet_stageHistSummary(&hist, &summary);
+    check(summary.maxCycles == 0U && summary.p99Cycles == 0U, "empty histogram reads as zero");
+
+    //1000 durations from 1000 to 13987 cycles in scrambled order
+    for(i = 0; i < 1000U; i++)
+    {
+        DPC_ObjDet_stageHistAdd(&hist, 1000U + ((i * 7919U) % 1000U) * 13U);
+    }
+    DPC_ObjDet_stageHistSummary(&hist, &summary);
+    check(summary.minCycles == 1000U && summary.maxCycles == 13987U, "min and max are exact");
+    check(summary.meanCycles == 7493U, "mean is exact");
+    check(summary.p99Cycles >= p99 && summary.p99Cycles <= p99 + p99 / 8U, "p99 within one bin above the real one");
+    printf("  p99 %u cycles, real %u\n", summary.p99Cycles, p99);
+}
+
+#define SIM_BFP_SAMPLES (8U) //rangeBinsPerBlock
+#define SIM_BFP_BLOCKS (4096U) //blocks of the simulated radar cube
+#define SIM_BFP_SIGMA (40.0) //noise per real and imaginary part, LSB
+
+static int16_t gBfpCube[SIM_BFP_BLOCKS * SIM_BFP_SAMPLES * 2U];
+static int16_t gBfpDecoded[SIM_BFP_BLOCKS * SIM_BFP_SAMPLES * 2U];
+static uint32_t gBfpPacked[SIM_BFP_BLOCKS * SIM_BFP_SAMPLES];
+
+/* This function fills the simulated radar cube with noise and puts a
+ * strong target into every targetEvery-th block
+ */
+static void sim_bfp_cube(uint32_t targetEvery)
+{
+    uint32_t i, block;
+
+    for(i = 0; i < SIM_BFP_BLOCKS * SIM_BFP_SAMPLES * 2U; i++)
+    {
+        gBfpCube[i] = (int16_t)lrint(sim_noise(SIM_BFP_SIGMA));
+    }
+    for(block = 0; block < SIM_BFP_BLOCKS; block += targetEvery)
+    {
+        double phase = sim_uniform(0.0, 2.0 * PI_);
+        i = block * SIM_BFP_SAMPLES * 2U + 2U * (sim_rand() % SIM_BFP_SAMPLES);
+        gBfpCube[i] = (int16_t)lrint(12000.0 * sin(phase));
+        gBfpCube[i + 1U] = (int16_t)lrint(12000.0 * cos(phase));
+    }
+}
+
+/* This function compresses the simulated radar cube at wordsPerBlock */
+static void sim_bfp_pack(uint32_t wordsPerBlock, uint32_t decrImagBitw)
+{
+    uint32_t block;
+
+    for(block = 0; block < SIM_BFP_BLOCKS; block++)
+    {
+        DPC_ObjDet_bfpPackBlock(&gBfpCube[block * SIM_BFP_SAMPLES * 2U], SIM_BFP_SAMPLES, wordsPerBlock,
+                                decrImagBitw, &gBfpPacked[block * wordsPerBlock]);
+    }
+}
+
+/* This function returns the real SNR loss of the simulated radar cube
+ * compressed at wordsPerBlock, from the error of every sample
+ */
+static double sim_bfp_loss_db(uint32_t wordsPerBlock, uint32_t decrImagBitw)
+{
+    uint32_t mantissaBW = DPC_ObjDet_bfpMantissaBW(wordsPerBlock, SIM_BFP_SAMPLES, decrImagBitw);
+    double err = 0.0;
+    uint32_t block, i;
+
+    sim_bfp_pack(wordsPerBlock, decrImagBitw);
+    for(block = 0; block < SIM_BFP_BLOCKS; block++)
+    {
+        (void)DPC_ObjDet_bfpUnpackBlock(&gBfpPacked[block * wordsPerBlock], SIM_BFP_SAMPLES, mantissaBW,
+                                        decrImagBitw, &gBfpDecoded[block * SIM_BFP_SAMPLES * 2U]);
+    }
+    for(i = 0; i < SIM_BFP_BLOCKS * SIM_BFP_SAMPLES * 2U; i++)
+    {
+        double d = (double)gBfpCube[i] - (double)gBfpDecoded[i];
+        err += d * d;
+    }
+    err /= (double)(SIM_BFP_BLOCKS * SIM_BFP_SAMPLES);
+    return 10.0 * log10(1.0 + err / (2.0 * SIM_BFP_SIGMA * SIM_BFP_SIGMA));
+}
+
+/* This function runs frames of the simulated radar cube through the
+ * compression ratio tuner like DPC_ObjectDetection_execute does, returns
+ * the words per block it ends on and checks it never goes down more than
+ * one word per decision
+ */
+static uint32_t sim_bfp_tune_frames(DPC_ObjDet_BfpTune *tune, uint32_t targetEvery, uint32_t numDecisions)
+{
+    static float power[DPC_OBJDET_BFP_TUNE_MAX_BLOCKS];
+    uint32_t frame, prevWords;
+    int stepsOk = 1;
+
+    for(frame = 0; frame < numDecisions * tune->framesPerDecision; frame++)
+    {
+        sim_bfp_cube(targetEvery);
+        sim_bfp_pack(tune->wordsCur, tune->decrImagBitw);
+        DPC_ObjDet_bfpTuneSample(tune, gBfpPacked, SIM_BFP_BLOCKS, power);
+        prevWords = tune->wordsCur;
+        stepsOk &= (DPC_ObjDet_bfpTuneDecide(tune) + 1U >= prevWords);
+    }
+    check(stepsOk, "ratio goes down at most one word per decision");
+    return tune->wordsCur;
+}
+
+/* This function checks the BFP block format against blocks of the
+ * hwa_bfp_compression example and its own round trip, then lets the
+ * compression ratio tuner settle on a noise cube with a few targets and
+ * compares its pick and predicted loss with the real loss of every ratio
+ */
+static void test_bfp_tune(void)
+{
+    //block 112 of gHWATest_compressBFP_input1 at ratio 0.33, imaginary first
+    static const int16_t hwaIn[16] = {24, -243, 154, 97, -9, 81, -170, 65, 24, -243, 154, 97, -9, 81, -170, 65};
+    static const int16_t hwaOut[16] = {16, -256, 144, 96, -16, 80, -176, 64, 16, -256, 144, 96, -16, 80, -176, 64};
+    static const int16_t hwaOut2p1[16] = {16, -248, 144, 96, -16, 80, -176, 64, 16, -248, 144, 96, -16, 80, -176, 64};
+    DPC_ObjDet_BfpTune tune;
+    int16_t block[2U * SIM_BFP_SAMPLES], decoded[2U * SIM_BFP_SAMPLES];
+    uint32_t packed[SIM_BFP_SAMPLES];
+    uint32_t words, decr, i, j, settled, backedOff;
+    double lossDb = 0.5, loss, lossBelow;
+    int roundTripOk = 1;
+
+    printf("BFP compression tuner:\n");
+    check(DPC_ObjDet_bfpWordsPerBlock(0.33F, 8U) == 3U && DPC_ObjDet_bfpMantissaBW(3U, 8U, 0U) == 5U &&
+          DPC_ObjDet_bfpMantissaBW(3U, 8U, 1U) == 6U, "words and mantissa width as in the HWA example");
+    DPC_ObjDet_bfpPackBlock(hwaIn, 8U, 3U, 0U, packed);
+    (void)DPC_ObjDet_bfpUnpackBlock(packed, 8U, 5U, 0U, decoded);
+    check(memcmp(decoded, hwaOut, sizeof(hwaOut)) == 0, "block decompresses like the HWA");
+    DPC_ObjDet_bfpPackBlock(hwaIn, 8U, 3U, 1U, packed);
+    (void)DPC_ObjDet_bfpUnpackBlock(packed, 8U, 6U, 1U, decoded);
+    check(memcmp(decoded, hwaOut2p1, sizeof(hwaOut2p1)) == 0, "block with narrower imaginary decompresses like the ES2.0 HWA");
+
+    //every width of every ratio truncates by the scale factor
+    for(i = 0; i < 2000U; i++)
+    {
+        uint32_t bits = 1U + (i % 16U);
+        decr = (i >> 4) & 1U;
+        words = 2U + (i % 7U);
+        for(j = 0; j < 2U * SIM_BFP_SAMPLES; j++)
+        {
+            block[j] = (int16_t)((int32_t)(sim_rand() & 0xFFFFU) >> (16U - bits + (sim_rand() & 1U)));
+        }
+        DPC_ObjDet_bfpPackBlock(block, SIM_BFP_SAMPLES, words, decr, packed);
+        {
+            uint32_t mantissaBW = DPC_ObjDet_bfpMantissaBW(words, SIM_BFP_SAMPLES, decr);
+            uint32_t width = 1U, scaleFac;
+
+            for(j = 0; j < 2U * SIM_BFP_SAMPLES; j++)
+            {
+                uint32_t w = DPC_ObjDet_bfpBitWidth(block[j]);
+                width = (w > width) ? w : width;
+            }
+            scaleFac = DPC_ObjDet_bfpUnpackBlock(packed, SIM_BFP_SAMPLES, mantissaBW, decr, decoded);
+            roundTripOk &= (scaleFac == DPC_ObjDet_bfpScaleFactor(width, mantissaBW, decr));
+            for(j = 0; j < 2U * SIM_BFP_SAMPLES; j++)
+            {
+                uint32_t shift = (j & 1U) ? ((scaleFac > decr) ? scaleFac - decr : 0U) : scaleFac;
+                roundTripOk &= (decoded[j] == (int16_t)(((int32_t)block[j] >> shift) * (1 << shift)));
+            }
+        }
+    }
+    check(roundTripOk, "round trip truncates by the scale factor");
+
+    //starts at ratio 0.75, one target every 32 blocks
+    DPC_ObjDet_bfpTuneInit(&tune, SIM_BFP_SAMPLES, 1U, 0.75F, 0.25F, (float)lossDb, 0.1F, 64U, 8U);
+    check(tune.enabled && tune.wordsMax == 6U && tune.wordsMin == 2U, "tuner ladder from 2 to 6 words");
+    settled = sim_bfp_tune_frames(&tune, 32U, 12U);
+    loss = sim_bfp_loss_db(settled, 1U);
+    lossBelow = sim_bfp_loss_db(settled - 1U, 1U);
+    check(settled < tune.wordsMax && loss <= lossDb + 0.05, "settles below the configured ratio within the budget");
+    check(settled == tune.wordsMin || lossBelow > lossDb - 0.1 - 0.05, "one word less would be over the budget");
+    check(fabs((double)tune.lossDb - loss) < 0.15, "predicted loss close to the real one");
+    printf("  settled on ratio %.3f (%u words): loss %.3f dB predicted, %.3f dB real, %.3f dB one word less\n",
+           (double)DPC_ObjDet_bfpRatio(settled, SIM_BFP_SAMPLES), settled, (double)tune.lossDb, loss, lossBelow);
+
+    //a target in every third block needs more bits, the tuner backs off at once
+    backedOff = sim_bfp_tune_frames(&tune, 3U, 1U);
+    check(backedOff > settled && sim_bfp_loss_db(backedOff, 1U) <= lossDb + 0.05, "backs off in one decision when targets crowd in");
+    printf("  %u words with a target in every third block, %u ratio changes\n", backedOff, tune.numChanges);
+}
+
+/* This function runs the HSRAM result slot hand-off across the wrap of
+ * the sequence numbers with the MSS one frame behind, then lets it fall
+ * further behind, and checks the point cloud is cut to what a slot holds
+ * and a frame whose slot is still held goes without one.
+ */
+static void test_result_slot(void)
+{
+    DPC_ObjDet_ResultSlot slot;
+    uint32_t held[2] = {0U, 0U}; //frame in each slot
+    uint32_t seq = 0xFFFFFFF0U;
+    uint32_t released = seq - 1U;
+    uint32_t n;
+    int isFree = 1, alternates = 1, untouched = 1;
+
+    printf("result slots:\n");
+    for(n = 0; n < 32U; n++, seq++)
+    {
+        uint32_t idx = DPC_ObjDet_resultSlotIdx(seq, 2U);
+        isFree &= DPC_ObjDet_resultSlotFree(seq, released, 2U) != 0U;
+        //the frame last in the slot is the one the MSS just released
+        untouched &= (n < 2U) || (held[idx] == released);
+        alternates &= (n == 0U) || (idx != DPC_ObjDet_resultSlotIdx(seq - 1U, 2U));
+        held[idx] = seq;
+        released = seq - 1U; //the MSS took this frame, so it is done with the one before
+    }
+    check(isFree, "the slot is free when the MSS is one frame behind");
+    check(alternates && untouched, "frames alternate slots across the wrap and never hit one being sent");
+    check(DPC_ObjDet_resultSlotFree(seq + 1U, released, 2U) == 0U, "a slot the MSS still sends is not free");
+
+    memset(&slot, 0, sizeof(slot));
+    check(DPC_ObjDet_resultSlotClamp(&slot, 5000U) == 5000U, "no slot leaves the detections alone");
+    slot.objOut = held;
+    slot.maxNumObjOut = 600U;
+    check(DPC_ObjDet_resultSlotClamp(&slot, 600U) == 600U && slot.numClamped == 0U, "detections that fit are kept");
+    check(DPC_ObjDet_resultSlotClamp(&slot, 601U) == 600U && slot.numClamped == 1U, "detections that do not fit are cut and counted");
+    DPC_ObjDet_resultSlotSkip(&slot);
+    check(slot.objOut == NULL && slot.numBusy == 1U, "a frame whose slot is held gets none and is counted");
+    check(DPC_ObjDet_resultSlotClamp(&slot, 5000U) == 5000U && slot.numClamped == 1U, "a dropped frame keeps all its detections");
+}
+
+/* This function checks the intersection against a brute force search of
+ * the whole range CFAR list
+ */
+static void test_intersect(const SimScene *scene, DetObjParams *finalDetObjList, uint32_t finalNumObjs)
+{
+    uint32_t objIdx, r, expect = 0;
+    int sameOrder = 1;
+
+    for(objIdx = 0; objIdx < scene->hdr.numDet; objIdx++)
+    {
+        const DetObjParams *d = &scene->det[objIdx];
+        int found = 0;
+        for(r = 0; r < scene->hdr.numRangeCfar && !found; r++)
+        {
+            found = (scene->rangeCfar[r].rangeIdx == d->rangeIdx) && (scene->rangeCfar[r].dopIdx == d->dopIdx);
+        }
+        if(found)
+        {
+            if(expect >= finalNumObjs || memcmp(&finalDetObjList[expect], d, sizeof(*d)) != 0)
+            {
+                sameOrder = 0;
+            }
+            expect++;
+        }
+    }
+    check(expect == finalNumObjs, "intersection keeps every detection both CFARs saw");
+    check(sameOrder, "intersection keeps the Doppler list order");
+}
+
+/* This function runs every true target through estimateXYZ on its own and
+ * compares it with where it really is
+ */
+static void test_accuracy(const DPC_ObjDet_XYZCfg *cfg)
+{
+    uint32_t i;
+    float worst = 0.0f;
+
+    for(i = 0; i < gScene.hdr.numTruth; i++)
+    {
+        const SimTruth *t = &gScene.truth[i];
+        DPIF_PointCloudCartesian p;
+        DPIF_PointCloudSideInfo side;
+        float range = sqrtf(t->x * t->x + t->y * t->y + t->z * t->z);
+        float tol = 0.03f * range + 0.05f;
+
+        if(DPC_ObjDet_estimateXYZKernel(cfg, &gScene.det[t->detIdx], 1U, &p, &side) != 1U)
+        {
+            check(0, "target inside the field of view is kept");
+            continue;
+        }
+        float err = fmaxf(fmaxf(fabsf(p.x - t->x), fabsf(p.y - t->y)), fabsf(p.z - t->z));
+        worst = fmaxf(worst, err / range);
+        check(err <= tol, "target position within 3% of range");
+        check(fabsf(p.velocity - t->velocity) < 1e-4f, "target velocity");
+        check(side.snr > 0, "target SNR is positive");
+    }
+    if(gScene.hdr.numTruth > 0)
+    {
+        printf("  %u targets, worst position error %.2f%% of range\n", gScene.hdr.numTruth, worst * 100.0f);
+    }
+}
+
+/* This function checks the batched estimateXYZ gave the same points as
+ * the per object one
+ */
+static void test_batch(uint32_t numObjOut, uint32_t numObjOutBatch)
+{
+    uint32_t i;
+    float worst = 0.0f;
+
+    check(numObjOutBatch == numObjOut, "batch keeps the same objects");
+    for(i = 0; i < numObjOut && i < numObjOutBatch; i++)
+    {
+        const DPIF_PointCloudCartesian *a = &gObjOut[i];
+        const DPIF_PointCloudCartesian *b = &gObjOutBatch[i];
+        float range = sqrtf(a->x * a->x + a->y * a->y + a->z * a->z);
+        float err = fmaxf(fmaxf(fabsf(a->x - b->x), fabsf(a->y - b->y)), fabsf(a->z - b->z));
+        worst = fmaxf(worst, err / range);
+        check(err <= 1e-3f * range + 1e-4f, "batch position matches within 0.1% of range");
+        check(a->velocity == b->velocity, "batch velocity matches");
+        check(abs(gSideInfo[i].snr - gSideInfoBatch[i].snr) <= 1 &&
+              abs(gSideInfo[i].noise - gSideInfoBatch[i].noise) <= 1, "batch side info matches");
+    }
+    printf("  batch vs per object: worst difference %.5f%% of range\n", worst * 100.0f);
+}
+
+/* This function times the per frame steps
+ */
+static void run_frames(const DPC_ObjDet_XYZCfg *cfg, DetObjParams *finalDetObjList, uint32_t finalMaxNumDetObjs)
+{
+    uint64_t intersectNs = 0, xyzNs = 0, batchNs = 0;
+    uint32_t frame, finalNumObjs = 0, numObjOut = 0, numObjOutBatch = 0;
+
+    for(frame = 0; frame < SIM_FRAMES; frame++)
+    {
+        uint64_t t0 = now_ns();
+        finalNumObjs = sim_intersect(&gScene, sim_fits_bitmap(&gScene), finalDetObjList, finalMaxNumDetObjs);
+        uint64_t t1 = now_ns();
+        numObjOut = DPC_ObjDet_estimateXYZKernel(cfg, finalDetObjList, finalNumObjs, gObjOut, gSideInfo);
+        uint64_t t2 = now_ns();
+        numObjOutBatch = DPC_ObjDet_estimateXYZBatch(cfg, finalDetObjList, finalNumObjs, gObjOutBatch, gSideInfoBatch);
+        uint64_t t3 = now_ns();
+        intersectNs += t1 - t0;
+        xyzNs += t2 - t1;
+        batchNs += t3 - t2;
+    }
+
+    printf("  %u Doppler detections, %u range CFAR, %u after intersection in %u transfers, %u points out\n",
+           gScene.hdr.numDet, gScene.hdr.numRangeCfar, finalNumObjs, gNumRuns, numObjOut);
+    printf("  stage              us/frame   objects/s\n");
+    printf("  intersect          %8.2f  %10.0f\n", (double)intersectNs / SIM_FRAMES / 1000.0,
+           (double)gScene.hdr.numDet * SIM_FRAMES * 1e9 / (double)(intersectNs ? intersectNs : 1U));
+    printf("  estimateXYZ        %8.2f  %10.0f\n", (double)xyzNs / SIM_FRAMES / 1000.0,
+           (double)finalNumObjs * SIM_FRAMES * 1e9 / (double)(xyzNs ? xyzNs : 1U));
+    printf("  estimateXYZ %-7s%8.2f  %10.0f  (%u lanes, %.2fx)\n", OBJDET_SIMD_NAME,
+           (double)batchNs / SIM_FRAMES / 1000.0,
+           (double)finalNumObjs * SIM_FRAMES * 1e9 / (double)(batchNs ? batchNs : 1U),
+           OBJDET_SIMD_WIDTH, (double)xyzNs / (double)(batchNs ? batchNs : 1U));
+    printf("  inter-frame DSP time %.2f us, %.2f us with the AoA pipelined into the range FFT wait\n",
+           (double)(intersectNs + xyzNs) / SIM_FRAMES / 1000.0, (double)intersectNs / SIM_FRAMES / 1000.0);
+
+    test_intersect(&gScene, finalDetObjList, finalNumObjs);
+    check(sim_intersect(&gScene, 0, finalDetObjList, finalMaxNumDetObjs) == finalNumObjs, "list search and bitmap agree");
+    test_intersect(&gScene, finalDetObjList, finalNumObjs);
+    check(numObjOut <= finalNumObjs, "estimateXYZ never adds points");
+    test_batch(numObjOut, numObjOutBatch);
+}
+
+/* This function runs frames through the pipelined AoA the way
+ * DPC_ObjectDetection_execute does with DPC_OBJDET_PIPELINED_AOA: the AoA of
+ * frame N runs at the start of frame N+1, before its intersection, into
+ * the buffer the previous point cloud is not in. Frames alternate between
+ * the scene and the scene with its Doppler list reversed, so a point cloud
+ * from the wrong frame or an overwritten buffer shows up.
+ */
+static void test_pipeline(const DPC_ObjDet_XYZCfg *cfg, DetObjParams *finalDetObjList, uint32_t finalMaxNumDetObjs)
+{
+    DPC_ObjDet_AoaPipe pipe;
+    uint32_t f, i, n, prevBufIdx = 0;
+
+    memcpy(&gDense, &gScene, sizeof(gScene));
+    for(i = 0; i < gDense.hdr.numDet; i++)
+    {
+        gDense.det[i] = gScene.det[gScene.hdr.numDet - 1U - i];
+    }
+
+    //the same frames in the normal order
+    for(f = 0; f < SIM_PIPE_FRAMES; f++)
+    {
+        const SimScene *scene = (f & 1U) ? &gDense : &gScene;
+        n = sim_intersect(scene, sim_fits_bitmap(scene), finalDetObjList, finalMaxNumDetObjs);
+        gSerialNumOut[f] = DPC_ObjDet_estimateXYZKernel(cfg, finalDetObjList, n, gSerialOut[f], gSideInfo);
+    }
+
+    //one more execute than frames to drain the last one
+    DPC_ObjDet_aoaPipeReset(&pipe, 1U);
+    for(f = 0; f <= SIM_PIPE_FRAMES; f++)
+    {
+        uint32_t outBufIdx = pipe.outBufIdx;
+        uint32_t numDetObjs = 0, numObjOut;
+        uint32_t had = DPC_ObjDet_aoaPipePop(&pipe, &outBufIdx);
+
+        if(had)
+        {
+            numDetObjs = pipe.numDetObjs;
+        }
+        numObjOut = DPC_ObjDet_estimateXYZKernel(cfg, finalDetObjList, numDetObjs, gPipeOut[outBufIdx], gPipeSideInfo[outBufIdx]);
+        if(f == 0)
+        {
+            check(!had && numObjOut == 0, "first pipelined frame has an empty point cloud");
+        }
+        else
+        {
+            check(numObjOut == gSerialNumOut[f - 1U] &&
+                  memcmp(gPipeOut[outBufIdx], gSerialOut[f - 1U], numObjOut * sizeof(DPIF_PointCloudCartesian)) == 0,
+                  "pipelined point cloud is the previous frame's");
+        }
+        if(f >= 2)
+        {
+            check(outBufIdx != prevBufIdx &&
+                  memcmp(gPipeOut[prevBufIdx], gSerialOut[f - 2U], gSerialNumOut[f - 2U] * sizeof(DPIF_PointCloudCartesian)) == 0,
+                  "previous point cloud untouched by the next AoA");
+        }
+        prevBufIdx = outBufIdx;
+
+        if(f < SIM_PIPE_FRAMES)
+        {
+            const SimScene *scene = (f & 1U) ? &gDense : &gScene;
+            n = sim_intersect(scene, sim_fits_bitmap(scene), finalDetObjList, finalMaxNumDetObjs);
+            DPC_ObjDet_aoaPipePush(&pipe, 0U, n);
+        }
+    }
+    printf("  %u frames, point clouds match the normal order one frame later\n", SIM_PIPE_FRAMES);
+}
+
+/* This function builds a scene where the ground returns fill the three
+ * static Doppler bins with perBin range CFAR detections each, and as many
+ * Doppler detections of which every other one has a range CFAR partner.
+ * A few movers sit in the other bins.
+ */
+static void make_dense_scene(uint32_t perBin)
+{
+    static const uint32_t clutterBins[3] = {63U, 0U, 1U};
+    SimSceneHeader *h = &gDense.hdr;
+    uint32_t b, j;
+
+    memset(&gDense, 0, sizeof(gDense));
+    h->numRangeBins = SIM_NUM_RANGE_BINS;
+    h->numDopplerBins = 64U;
+    for(b = 0; b < 3U; b++)
+    {
+        for(j = 0; j < perBin; j++)
+        {
+            DetObjParams *d = &gDense.det[h->numDet++];
+            //37 is odd, so the range bins of one Doppler bin never repeat
+            add_range_cfar(&gDense, (j * 37U + b * 11U) % SIM_NUM_RANGE_BINS, clutterBins[b]);
+            d->dopIdx = clutterBins[b];
+            d->rangeIdx = ((j & 1U) == 0U) ? (j * 37U + b * 11U) % SIM_NUM_RANGE_BINS : sim_rand() % SIM_NUM_RANGE_BINS;
+        }
+    }
+    for(j = 0; j < 32U; j++)
+    {
+        DetObjParams *d = &gDense.det[h->numDet++];
+        d->dopIdx = 2U + sim_rand() % 60U;
+        d->rangeIdx = sim_rand() % SIM_NUM_RANGE_BINS;
+        add_range_cfar(&gDense, d->rangeIdx, d->dopIdx);
+    }
+    make_per_dop(&gDense);
+}
+
+/* This function times the list search against the bitmap on ever denser
+ * clutter, where the list search cost grows with the square of the
+ * detections per Doppler bin
+ */
+static void bench_dense(DetObjParams *finalDetObjList, uint32_t finalMaxNumDetObjs)
+{
+    static const uint32_t perBin[4] = {16U, 32U, 64U, 96U}; //kept lists stay under the 307 the L2 scratch holds
+    uint32_t i, frame;
+
+    printf("  per bin  Doppler  range CFAR  kept  transfers   list us  bitmap us  saved us/frame\n");
+    for(i = 0; i < 4U; i++)
+    {
+        uint64_t listNs = 0, bitmapNs = 0;
+        uint32_t numList = 0, numBitmap = 0;
+
+        make_dense_scene(perBin[i]);
+        for(frame = 0; frame < SIM_FRAMES; frame++)
+        {
+            uint64_t t0 = now_ns();
+            numList = sim_intersect(&gDense, 0, finalDetObjList, finalMaxNumDetObjs);
+            uint64_t t1 = now_ns();
+            numBitmap = sim_intersect(&gDense, 1, finalDetObjList, finalMaxNumDetObjs);
+            uint64_t t2 = now_ns();
+            listNs += t1 - t0;
+            bitmapNs += t2 - t1;
+        }
+        printf("  %7u  %7u  %10u  %4u  %9u  %8.2f  %9.2f  %14.2f\n", perBin[i], gDense.hdr.numDet,
+               gDense.hdr.numRangeCfar, numBitmap, gNumRuns, (double)listNs / SIM_FRAMES / 1000.0,
+               (double)bitmapNs / SIM_FRAMES / 1000.0, ((double)listNs - (double)bitmapNs) / SIM_FRAMES / 1000.0);
+        check(sim_fits_bitmap(&gDense), "dense scene fits the bitmap");
+        check(numList == numBitmap, "list search and bitmap agree on dense clutter");
+        test_intersect(&gDense, finalDetObjList, numBitmap);
+    }
+}
+
+/* ======================= Capture ======================= */
+
+#define SIM_CAP_SIZE (8U * 1024U * 1024U) //largest capture read
+#define SIM_CAP_FRAMES (8U) //frames of the synthetic capture
+#define SIM_CAP_POINT_TOL (1e-3f) //m and m/s, DSP mathlib and libm differ in the last bits
+#define SIM_CAP_SIDE_INFO_TOL (1) //0.1 dB, the dB values are truncated
+
+static uint8_t gCapBuf[SIM_CAP_SIZE] __attribute__((aligned(8)));
+static SimScene gCapScene;
+
+/* This function fills in what DPC_ObjDet_estimateXYZ reads from the DPC
+ * objects out of the header of a capture
+ */
+static void cap_xyz_cfg(const DPC_ObjDet_CaptureHdr *hdr, uint32_t subFrameIdx, DPC_ObjDet_XYZCfg *cfg)
+{
+    const DPC_ObjDet_CaptureSubFrame *sf = &hdr->subFrame[subFrameIdx];
+    cfg->antennaCalibParams = hdr->antennaCalibParams;
+    cfg->antennaGeometryCfg = hdr->antennaGeometryCfg;
+    cfg->zeroInsrtMaskAzim = hdr->zeroInsrtMaskAzim;
+    cfg->zeroInsrtMaskElev = hdr->zeroInsrtMaskElev;
+    cfg->xSpacingByLambda = hdr->xSpacingByLambda;
+    cfg->zSpacingByLambda = hdr->zSpacingByLambda;
+    cfg->rangeStep = sf->rangeStep;
+    cfg->dopplerStep = sf->dopplerStep;
+    cfg->numAzimFFTBins = sf->numAzimFFTBins;
+    cfg->numDopplerBins = sf->numDopplerBins;
+    cfg->fov.minAzimuthSinVal = sf->fov[0];
+    cfg->fov.maxAzimuthSinVal = sf->fov[1];
+    cfg->fov.minElevationSinVal = sf->fov[2];
+    cfg->fov.maxElevationSinVal = sf->fov[3];
+}
+
+/* This function copies the section type of a record into dst, which holds
+ * max elements. It returns the number of elements, or -1 when the record
+ * does not have the section or dst is too small.
+ */
+static int32_t cap_section(const DPC_ObjDet_CaptureRec *rec, uint32_t type, void *dst, uint32_t max, uint32_t elemSize)
+{
+    const DPC_ObjDet_CaptureSec *sec = DPC_ObjDet_captureFind(rec, type);
+    if(sec == NULL || sec->elemSize != elemSize || sec->count > max)
+    {
+        return -1;
+    }
+    memcpy(dst, sec + 1, sec->count * elemSize);
+    return (int32_t)sec->count;
+}
+
+/* This function puts the lists a record holds into gCapScene. The range
+ * CFAR list is counted per Doppler sub bin, so those are the Doppler bins
+ * of the scene. It returns 0 when the record has what the intersection needs.
+ */
+static int cap_scene(const DPC_ObjDet_CaptureHdr *hdr, const DPC_ObjDet_CaptureRec *rec)
+{
+    const DPC_ObjDet_CaptureSubFrame *sf = &hdr->subFrame[rec->subFrameIdx];
+    SimSceneHeader *h = &gCapScene.hdr;
+    int32_t n;
+
+    memset(h, 0, sizeof(*h));
+    h->numRangeBins = sf->numRangeBins;
+    n = cap_section(rec, DPC_OBJDET_CAPTURE_SEC_DOP_LIST, gCapScene.det, SIM_MAX_DET, sizeof(DetObjParams));
+    if(n < 0)
+    {
+        return -1;
+    }
+    h->numDet = (uint32_t)n;
+    if(sf->rangeCfarEnabled)
+    {
+        h->numDopplerBins = sf->numSubBins;
+        n = cap_section(rec, DPC_OBJDET_CAPTURE_SEC_RCFAR_LIST, gCapScene.rangeCfar, SIM_MAX_RANGE_CFAR, sizeof(RangeCfarListObj));
+        if(n < 0 || h->numDopplerBins == 0U ||
+           cap_section(rec, DPC_OBJDET_CAPTURE_SEC_RCFAR_PERDOP, gCapScene.perDop, SIM_MAX_DOP_BINS, sizeof(uint16_t)) != (int32_t)h->numDopplerBins)
+        {
+            return -1;
+        }
+        h->numRangeCfar = (uint32_t)n;
+    }
+    return 0;
+}
+
+/* This function runs the intersection on gCapScene the way the DSP does
+ * for the sub-frame: bitmap or list search when range CFAR is on, the head
+ * of the Doppler list when it is off.
+ */
+static uint32_t cap_intersect(const DPC_ObjDet_CaptureSubFrame *sf, DetObjParams *finalDetObjList, uint32_t finalMaxNumDetObjs)
+{
+    uint32_t n;
+
+    if(sf->finalMaxNumDetObjs < finalMaxNumDetObjs)
+    {
+        finalMaxNumDetObjs = sf->finalMaxNumDetObjs;
+    }
+    if(sf->rangeCfarEnabled)
+    {
+        if(finalMaxNumDetObjs > SIM_MAX_DET)
+        {
+            finalMaxNumDetObjs = SIM_MAX_DET; //INTERSECT_MAX_VALID_OBJS
+        }
+        return sim_intersect(&gCapScene, sim_fits_bitmap(&gCapScene), finalDetObjList, finalMaxNumDetObjs);
+    }
+    n = gCapScene.hdr.numDet < finalMaxNumDetObjs ? gCapScene.hdr.numDet : finalMaxNumDetObjs;
+    memcpy(finalDetObjList, gCapScene.det, n * sizeof(DetObjParams));
+    return n;
+}
+
+/* This function compares the point cloud of a replayed frame with the
+ * recorded one, within SIM_CAP_POINT_TOL. It returns 1 when they differ.
+ */
+static uint32_t cap_compare_points(DPC_ObjDet_CaptureStats *stats, const DPC_ObjDet_CaptureRec *rec,
+                                   uint32_t numObjOut, float *maxErr)
+{
+    const DPC_ObjDet_CaptureSec *sec;
+    const DPIF_PointCloudCartesian *pts;
+    const DPIF_PointCloudSideInfo *side;
+    uint32_t i, differ = 0;
+
+    sec = DPC_ObjDet_captureFind(rec, DPC_OBJDET_CAPTURE_SEC_POINTS);
+    if(sec != NULL)
+    {
+        pts = (const DPIF_PointCloudCartesian *)(sec + 1);
+        if(sec->count != numObjOut || sec->elemSize != sizeof(DPIF_PointCloudCartesian))
+        {
+            differ = 1;
+        }
+        for(i = 0; !differ && i < numObjOut; i++)
+        {
+            float err = fabsf(pts[i].x - gObjOut[i].x);
+            err = fmaxf(err, fabsf(pts[i].y - gObjOut[i].y));
+            err = fmaxf(err, fabsf(pts[i].z - gObjOut[i].z));
+            err = fmaxf(err, fabsf(pts[i].velocity - gObjOut[i].velocity));
+            *maxErr = fmaxf(*maxErr, err);
+            differ = err > SIM_CAP_POINT_TOL;
+        }
+        if(differ)
+        {
+            stats->secMismatches[DPC_OBJDET_CAPTURE_SEC_POINTS]++;
+            return 1;
+        }
+    }
+    sec = DPC_ObjDet_captureFind(rec, DPC_OBJDET_CAPTURE_SEC_SIDE_INFO);
+    if(sec != NULL)
+    {
+        side = (const DPIF_PointCloudSideInfo *)(sec + 1);
+        if(sec->count != numObjOut || sec->elemSize != sizeof(DPIF_PointCloudSideInfo))
+        {
+            differ = 1;
+        }
+        for(i = 0; !differ && i < numObjOut; i++)
+        {
+            differ = abs(side[i].snr - gSideInfo[i].snr) > SIM_CAP_SIDE_INFO_TOL ||
+                     abs(side[i].noise - gSideInfo[i].noise) > SIM_CAP_SIDE_INFO_TOL;
+        }
+        if(differ)
+        {
+            stats->secMismatches[DPC_OBJDET_CAPTURE_SEC_SIDE_INFO]++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* This function replays the lists of every record of a capture through the
+ * intersection and the AoA. The final list has to be the recorded one
+ * exactly, the points within SIM_CAP_POINT_TOL. Records without the lists
+ * are skipped. It returns -1 when the capture cannot be replayed here.
+ */
+static int cap_replay(const void *buf, uint32_t size, DetObjParams *finalDetObjList, uint32_t finalMaxNumDetObjs,
+                      DPC_ObjDet_CaptureStats *stats, float *maxErr)
+{
+    const DPC_ObjDet_CaptureHdr *hdr;
+    const DPC_ObjDet_CaptureRec *rec;
+    DPC_ObjDet_XYZCfg cfg;
+    uint32_t n, numObjOut, numDiffer;
+
+    memset(stats, 0, sizeof(*stats));
+    *maxErr = 0.0f;
+    hdr = DPC_ObjDet_captureCheck(buf, size, sizeof(DetObjParams), sizeof(RangeCfarListObj),
+                                  sizeof(DPIF_PointCloudCartesian), sizeof(DPIF_PointCloudSideInfo));
+    if(hdr == NULL)
+    {
+        return -1;
+    }
+    for(rec = DPC_ObjDet_captureNext(hdr, NULL); rec != NULL; rec = DPC_ObjDet_captureNext(hdr, rec))
+    {
+        if(rec->subFrameIdx >= hdr->numSubFrames || cap_scene(hdr, rec) != 0)
+        {
+            stats->numSkipped++;
+            continue;
+        }
+        n = cap_intersect(&hdr->subFrame[rec->subFrameIdx], finalDetObjList, finalMaxNumDetObjs);
+        numDiffer = DPC_ObjDet_captureCompare(stats, rec, DPC_OBJDET_CAPTURE_SEC_FINAL_LIST,
+                                              finalDetObjList, n, sizeof(DetObjParams));
+        cap_xyz_cfg(hdr, rec->subFrameIdx, &cfg);
+        numObjOut = DPC_ObjDet_estimateXYZKernel(&cfg, finalDetObjList, n, gObjOut, gSideInfo);
+        numDiffer += cap_compare_points(stats, rec, numObjOut, maxErr);
+        DPC_ObjDet_captureFrameDone(stats, rec, numDiffer);
+    }
+    return 0;
+}
+
+/* This function records frames of the synthetic scene the way the DSP does
+ * with DPC_OBJDET_CAPTURE_RECORD and DPC_OBJDET_CAPTURE_SECS_LISTS. Every
+ * other frame has its Doppler list reversed. It returns the header, NULL
+ * when buf is too small for it.
+ */
+static DPC_ObjDet_CaptureHdr *cap_record(void *buf, uint32_t size, uint32_t numFrames, const DPC_ObjDet_XYZCfg *cfg,
+                                         DetObjParams *finalDetObjList, uint32_t finalMaxNumDetObjs)
+{
+    const SimSceneHeader *h = &gScene.hdr;
+    DPC_ObjDet_CaptureHdr *hdr = DPC_ObjDet_captureInit(buf, size, DPC_OBJDET_CAPTURE_SECS_LISTS);
+    DPC_ObjDet_CaptureSubFrame *sf;
+    DPC_ObjDet_CaptureRec *rec;
+    uint32_t f, i, n, numObjOut;
+
+    if(hdr == NULL)
+    {
+        return NULL;
+    }
+    hdr->detObjSize = sizeof(DetObjParams);
+    hdr->rangeCfarObjSize = sizeof(RangeCfarListObj);
+    hdr->pointSize = sizeof(DPIF_PointCloudCartesian);
+    hdr->sideInfoSize = sizeof(DPIF_PointCloudSideInfo);
+    hdr->numSubFrames = 1U;
+    hdr->zeroInsrtMaskAzim = h->zeroInsrtMaskAzim;
+    hdr->zeroInsrtMaskElev = h->zeroInsrtMaskElev;
+    hdr->xSpacingByLambda = h->xSpacingByLambda;
+    hdr->zSpacingByLambda = h->zSpacingByLambda;
+    memcpy(hdr->antennaGeometryCfg, h->antennaGeometryCfg, sizeof(h->antennaGeometryCfg));
+    memcpy(hdr->antennaCalibParams, h->antennaCalibParams, sizeof(h->antennaCalibParams));
+    sf = &hdr->subFrame[0];
+    sf->numRangeBins = (uint16_t)h->numRangeBins;
+    sf->numDopplerBins = h->numDopplerBins;
+    sf->numSubBins = h->numDopplerBins;
+    sf->numAzimFFTBins = h->numAzimFFTBins;
+    sf->numRxAntennas = 4U;
+    sf->numVirtualAntennas = MAX_NUM_VIRT_ANT;
+    sf->radarCubeSize = h->numRangeBins * h->numDopplerBins * sf->numRxAntennas * 4U * sizeof(uint32_t);
+    sf->finalMaxNumDetObjs = (uint16_t)finalMaxNumDetObjs;
+    sf->rangeCfarEnabled = 1U;
+    sf->compressionRatio = 1.0f;
+    sf->rangeStep = h->rangeStep;
+    sf->dopplerStep = h->dopplerStep;
+    sf->fov[0] = h->fov.minAzimuthSinVal;
+    sf->fov[1] = h->fov.maxAzimuthSinVal;
+    sf->fov[2] = h->fov.minElevationSinVal;
+    sf->fov[3] = h->fov.maxElevationSinVal;
+
+    memcpy(&gCapScene, &gScene, sizeof(gScene));
+    for(i = 0; i < gScene.hdr.numDet; i++)
+    {
+        gCapScene.det[i] = gScene.det[gScene.hdr.numDet - 1U - i];
+    }
+    for(f = 0; f < numFrames; f++)
+    {
+        const SimScene *scene = (f & 1U) ? &gCapScene : &gScene;
+        rec = DPC_ObjDet_captureBegin(hdr, f, 0U);
+        rec = DPC_ObjDet_captureAdd(hdr, rec, DPC_OBJDET_CAPTURE_SEC_RADAR_CUBE, NULL, 0U, 1U); //not asked for
+        rec = DPC_ObjDet_captureAdd(hdr, rec, DPC_OBJDET_CAPTURE_SEC_DOP_LIST, scene->det, scene->hdr.numDet, sizeof(DetObjParams));
+        rec = DPC_ObjDet_captureAdd(hdr, rec, DPC_OBJDET_CAPTURE_SEC_RCFAR_LIST, scene->rangeCfar, scene->hdr.numRangeCfar,
+                                    sizeof(RangeCfarListObj));
+        rec = DPC_ObjDet_captureAdd(hdr, rec, DPC_OBJDET_CAPTURE_SEC_RCFAR_PERDOP, scene->perDop, scene->hdr.numDopplerBins,
+                                    sizeof(uint16_t));
+        n = sim_intersect(scene, sim_fits_bitmap(scene), finalDetObjList, finalMaxNumDetObjs);
+        rec = DPC_ObjDet_captureAdd(hdr, rec, DPC_OBJDET_CAPTURE_SEC_FINAL_LIST, finalDetObjList, n, sizeof(DetObjParams));
+        numObjOut = DPC_ObjDet_estimateXYZKernel(cfg, finalDetObjList, n, gObjOut, gSideInfo);
+        rec = DPC_ObjDet_captureAdd(hdr, rec, DPC_OBJDET_CAPTURE_SEC_POINTS, gObjOut, numObjOut,
+                                    sizeof(DPIF_PointCloudCartesian));
+        rec = DPC_ObjDet_captureAdd(hdr, rec, DPC_OBJDET_CAPTURE_SEC_SIDE_INFO, gSideInfo, numObjOut,
+                                    sizeof(DPIF_PointCloudSideInfo));
+        DPC_ObjDet_captureEnd(hdr, rec);
+    }
+    return hdr;
+}
+
+/* This function counts the records a walk over a capture finds
+ */
+static uint32_t cap_count(const DPC_ObjDet_CaptureHdr *hdr)
+{
+    const DPC_ObjDet_CaptureRec *rec;
+    uint32_t n = 0;
+    for(rec = DPC_ObjDet_captureNext(hdr, NULL); rec != NULL; rec = DPC_ObjDet_captureNext(hdr, rec))
+    {
+        n++;
+    }
+    return n;
+}
+
+/* This function records a capture, replays it to identical lists, and
+ * checks that a changed list shows up, that what does not fit is dropped
+ * whole, and that a capture a reader cannot take is refused
+ */
+static void test_capture(const DPC_ObjDet_XYZCfg *cfg, DetObjParams *finalDetObjList, uint32_t finalMaxNumDetObjs)
+{
+    DPC_ObjDet_CaptureHdr *hdr;
+    DPC_ObjDet_CaptureRec *rec;
+    const DPC_ObjDet_CaptureSec *sec;
+    DPC_ObjDet_CaptureStats stats;
+    uint32_t used, recSize;
+    float maxErr;
+
+    check(sizeof(DPC_ObjDet_CaptureRec) % DPC_OBJDET_CAPTURE_ALIGN == 0U &&
+          sizeof(DPC_ObjDet_CaptureSec) % DPC_OBJDET_CAPTURE_ALIGN == 0U, "records keep their sections aligned");
+    hdr = cap_record(gCapBuf, SIM_CAP_SIZE, SIM_CAP_FRAMES, cfg, finalDetObjList, finalMaxNumDetObjs);
+    check(hdr != NULL && hdr->numRecords == SIM_CAP_FRAMES && hdr->numDropped == 0U, "every frame recorded");
+    if(hdr == NULL)
+    {
+        return;
+    }
+    check(cap_count(hdr) == SIM_CAP_FRAMES, "walk finds every record");
+    rec = (DPC_ObjDet_CaptureRec *)DPC_ObjDet_captureNext(hdr, NULL);
+    check((rec->sections & (1U << DPC_OBJDET_CAPTURE_SEC_RADAR_CUBE)) == 0U && rec->numSections == 6U,
+          "sections not asked for are left out");
+    check(cap_replay(gCapBuf, hdr->usedSize, finalDetObjList, finalMaxNumDetObjs, &stats, &maxErr) == 0 &&
+          stats.numFrames == SIM_CAP_FRAMES && stats.numMismatched == 0U && stats.numSkipped == 0U,
+          "replay gives the recorded lists");
+    printf("  %u frames in %u bytes, %u bytes a frame, replayed identically\n", hdr->numRecords, hdr->usedSize,
+           (hdr->usedSize - hdr->hdrSize) / hdr->numRecords);
+
+    //a changed detection in frame 3 shows up in its final list
+    rec = (DPC_ObjDet_CaptureRec *)DPC_ObjDet_captureNext(hdr, rec);
+    rec = (DPC_ObjDet_CaptureRec *)DPC_ObjDet_captureNext(hdr, rec);
+    rec = (DPC_ObjDet_CaptureRec *)DPC_ObjDet_captureNext(hdr, rec);
+    sec = DPC_ObjDet_captureFind(rec, DPC_OBJDET_CAPTURE_SEC_FINAL_LIST);
+    check(rec->frameIdx == 3U && sec != NULL && sec->count > 0U, "record 3 has a final list");
+    if(sec != NULL && sec->count > 0U)
+    {
+        ((DetObjParams *)(sec + 1))->dopCfarNoise ^= 1U;
+        cap_replay(gCapBuf, hdr->usedSize, finalDetObjList, finalMaxNumDetObjs, &stats, &maxErr);
+        check(stats.numMismatched == 1U && stats.firstMismatchFrame == 3U &&
+              stats.secMismatches[DPC_OBJDET_CAPTURE_SEC_FINAL_LIST] == 1U, "changed final list found");
+        ((DetObjParams *)(sec + 1))->dopCfarNoise ^= 1U;
+    }
+
+    //a walk stops at a record that does not hold together
+    recSize = rec->recSize;
+    rec->recSize = 12U;
+    check(cap_count(hdr) == 3U, "walk stops at a broken record");
+    rec->recSize = recSize;
+
+    //readers refuse what they cannot read
+    check(DPC_ObjDet_captureCheck(gCapBuf, hdr->usedSize - 1U, sizeof(DetObjParams), sizeof(RangeCfarListObj),
+                                  sizeof(DPIF_PointCloudCartesian), sizeof(DPIF_PointCloudSideInfo)) == NULL,
+          "truncated capture refused");
+    check(DPC_ObjDet_captureCheck(gCapBuf, hdr->usedSize, sizeof(DetObjParams) - 4U, sizeof(RangeCfarListObj),
+                                  sizeof(DPIF_PointCloudCartesian), sizeof(DPIF_PointCloudSideInfo)) == NULL,
+          "capture of another DetObjParams refused");
+    hdr->version++;
+    check(cap_replay(gCapBuf, hdr->usedSize, finalDetObjList, finalMaxNumDetObjs, &stats, &maxErr) == -1,
+          "capture of another version refused");
+    hdr->version--;
+
+    //a record begun and not ended is dropped by the next one
+    used = hdr->usedSize;
+    rec = DPC_ObjDet_captureBegin(hdr, 99U, 0U);
+    rec = DPC_ObjDet_captureAdd(hdr, rec, DPC_OBJDET_CAPTURE_SEC_DOP_LIST, gScene.det, 4U, sizeof(DetObjParams));
+    check(rec != NULL && hdr->usedSize == used && cap_count(hdr) == SIM_CAP_FRAMES, "unended record is not part of it");
+
+    //a buffer that holds two and a half frames keeps two whole ones
+    recSize = (used - hdr->hdrSize) / SIM_CAP_FRAMES;
+    hdr = cap_record(gCapBuf, hdr->hdrSize + 2U * recSize + recSize / 2U, SIM_CAP_FRAMES, cfg, finalDetObjList,
+                     finalMaxNumDetObjs);
+    check(hdr->numRecords == 2U && hdr->numDropped == SIM_CAP_FRAMES - 2U && cap_count(hdr) == 2U,
+          "frames that do not fit are dropped whole");
+}
+
+/* This function replays a capture file. It returns 0 when every frame
+ * gave the recorded lists.
+ */
+static int replay_capture(const char *path, DetObjParams *finalDetObjList, uint32_t finalMaxNumDetObjs)
+{
+    const DPC_ObjDet_CaptureHdr *hdr = (const DPC_ObjDet_CaptureHdr *)gCapBuf;
+    DPC_ObjDet_CaptureStats stats;
+    FILE *f = fopen(path, "rb");
+    uint32_t size, i;
+    float maxErr;
+
+    if(f == NULL)
+    {
+        printf("cannot read capture %s\n", path);
+        return 1;
+    }
+    size = (uint32_t)fread(gCapBuf, 1, SIM_CAP_SIZE, f);
+    fclose(f);
+    if(cap_replay(gCapBuf, size, finalDetObjList, finalMaxNumDetObjs, &stats, &maxErr) != 0)
+    {
+        printf("%s is not a capture of this version and these structures\n", path);
+        return 1;
+    }
+    printf("replaying capture %s: %u sub-frames, %u records, %u dropped while recording%s\n", path,
+           hdr->numSubFrames, hdr->numRecords, hdr->numDropped, hdr->pipelinedAoa ? ", pipelined AoA" : "");
+    printf("  %u frames replayed, %u skipped, %u differ, largest point error %g\n",
+           stats.numFrames, stats.numSkipped, stats.numMismatched, (double)maxErr);
+    if(stats.numMismatched > 0U)
+    {
+        printf("  first differing frame %u\n", stats.firstMismatchFrame);
+        for(i = 0; i < DPC_OBJDET_CAPTURE_NUM_SECS; i++)
+        {
+            if(stats.secMismatches[i] > 0U)
+            {
+                printf("  section %u differs in %u frames\n", i, stats.secMismatches[i]);
+            }
+        }
+    }
+    return (stats.numMismatched == 0U && stats.numFrames > 0U) ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    DPC_ObjDet_XYZCfg cfg;
+    MemPoolObj l2Pool;
+    DetObjParams *finalDetObjList;
+    uint32_t finalMaxNumDetObjs;
+
+    check(sizeof(DetObjParams) == 160U, "DetObjParams matches the DSP layout");
+    make_dft_table();
+
+    //final list is carved out of core local scratch like DPC_ObjDet_dopplerConfig does
+    l2Pool.cfg.addr = gL2Scratch;
+    l2Pool.cfg.size = sizeof(gL2Scratch);
+    DPC_ObjDet_MemPoolReset(&l2Pool);
+    finalMaxNumDetObjs = l2Pool.cfg.size / sizeof(DetObjParams);
+    finalDetObjList = (DetObjParams *)DPC_ObjDet_MemPoolAlloc(&l2Pool, finalMaxNumDetObjs * sizeof(DetObjParams), (uint8_t)sizeof(uint32_t));
+    if(finalDetObjList == NULL)
+    {
+        printf("L2 scratch too small\n");
+        return 1;
+    }
+
+    if(argc == 3 && strcmp(argv[1], "capreplay") == 0)
+    {
+        return replay_capture(argv[2], finalDetObjList, finalMaxNumDetObjs);
+    }
+    else if(argc == 3 && strcmp(argv[1], "replay") == 0)
+    {
+        if(load_scene(argv[2]) != 0)
+        {
+            printf("cannot read scene %s\n", argv[2]);
+            return 1;
+        }
+        printf("replaying %s\n", argv[2]);
+    }
+    else if(argc == 1 || (argc == 3 && strcmp(argv[1], "record") == 0))
+    {
+        make_scene();
+        if(argc == 3 && save_scene(argv[2]) != 0)
+        {
+            printf("cannot write scene %s\n", argv[2]);
+            return 1;
+        }
+        printf("synthetic scene\n");
+    }
+    else if(argc == 3 && strcmp(argv[1], "caprecord") == 0)
+    {
+        const DPC_ObjDet_CaptureHdr *hdr;
+        FILE *f;
+        int ok;
+
+        make_scene();
+        sim_xyz_cfg(&cfg);
+        hdr = cap_record(gCapBuf, SIM_CAP_SIZE, SIM_CAP_FRAMES, &cfg, finalDetObjList, finalMaxNumDetObjs);
+        f = fopen(argv[2], "wb");
+        ok = f != NULL && hdr != NULL && fwrite(gCapBuf, 1, hdr->usedSize, f) == hdr->usedSize;
+        if(f != NULL)
+        {
+            fclose(f);
+        }
+        if(!ok)
+        {
+            printf("cannot write capture %s\n", argv[2]);
+            return 1;
+        }
+        printf("synthetic scene, %u frames captured to %s\n", hdr->numRecords, argv[2]);
+    }
+    else
+    {
+        printf("Usage: %s [record <scene.bin> | replay <scene.bin> | caprecord <cap.bin> | capreplay <cap.bin>]\n", argv[0]);
+        return 1;
+    }
+
+    test_mem_pool();
+    test_mem_map();
+    test_windows();
+    test_win_cache();
+    test_stage_hist();
+    test_bfp_tune();
+    test_result_slot();
+
+    printf("frame:\n");
+    sim_xyz_cfg(&cfg);
+    run_frames(&cfg, finalDetObjList, finalMaxNumDetObjs);
+    test_accuracy(&cfg);
+    printf("pipelined AoA:\n");
+    test_pipeline(&cfg, finalDetObjList, finalMaxNumDetObjs);
+    printf("capture:\n");
+    test_capture(&cfg, finalDetObjList, finalMaxNumDetObjs);
+    printf("dense clutter intersection:\n");
+    bench_dense(finalDetObjList, finalMaxNumDetObjs);
+
+    printf(gFailed ? "FAILED\n" : "all checks passed\n");
+    return gFailed;
+}
@@ -0,0 +1,342 @@
+/*
+ * heatmap_dec.c
+ *
+ * Host decoder of the compressed range/Doppler heatmap TLV the MSS sends
+ * when rangeDopplerHeatMap of guiMonitor is 2 or more.
+ *
+ * The codec is mmw_heatmap_codec.h, the same one the MSS encodes with. Run
+ * without arguments it sends made up heatmaps of a noise floor with a few
+ * moving targets through the encoder and the decoder at every level,
+ * checks the lossless level gives the heatmaps back bit for bit and the
+ * others stay inside their dead band, checks every residual code and that
+ * broken streams are refused, and prints how small each level gets.
+ *
+ * "decode" goes through a capture of the UART output with the parser of
+ * mmw_tlv.h, takes the heatmap of every packet, compressed or not, and
+ * writes them one after the other as uint16_t range x Doppler matrices. A
+ * compressed heatmap that is not a key frame needs the one before it, when
+ * that is missing it is skipped until the next key frame.
+ *
+ * This runs on the PC, not on the board. Build with:
+ *     cc -O2 -Wall -I../ExampleProjects/out_of_box_2944_mss/include
+ *        -o heatmap_dec heatmap_dec.c
+ * and run as:
+ *     ./heatmap_dec
+ *     ./heatmap_dec decode capture.bin heatmaps.bin
+ * It exits with 1 if a check fails or a file cannot be used.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mmw_heatmap_codec.h"
+#include "mmw_tlv.h"
+
+#define TEST_RANGE_BINS (256U)
+#define TEST_DOPPLER_BINS (32U)
+#define TEST_BINS (TEST_RANGE_BINS * TEST_DOPPLER_BINS)
+#define TEST_FRAMES (100U)
+#define TEST_OUT_SIZE (TEST_BINS * sizeof(uint16_t))
+
+static int gFailed = 0;
+static uint32_t gSeed = 1U;
+
+/* This function records one check
+ */
+static void check(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAILED: %s\n", what);
+        gFailed = 1;
+    }
+}
+
+/* This function returns a pseudo random 32 bit value
+ */
+static uint32_t dec_rand(void)
+{
+    gSeed = gSeed * 1664525U + 1013904223U;
+    return gSeed;
+}
+
+/* This function makes the heatmap of a frame: a log magnitude noise floor
+ * falling with range, jittering by a few LSBs, and targets walking through
+ * range and Doppler
+ */
+static void dec_make_heatmap(uint16_t *heatMap, uint32_t frame)
+{
+    uint32_t r, d, t;
+    for(r = 0; r < TEST_RANGE_BINS; r++)
+    {
+        for(d = 0; d < TEST_DOPPLER_BINS; d++)
+        {
+            heatMap[r * TEST_DOPPLER_BINS + d] = (uint16_t)(6000U - 8U * r + (dec_rand() >> 30));
+        }
+    }
+    for(t = 0; t < 4U; t++)
+    {
+        r = (40U * t + frame) % TEST_RANGE_BINS;
+        d = (7U * t + frame / 4U) % TEST_DOPPLER_BINS;
+        heatMap[r * TEST_DOPPLER_BINS + d] += (uint16_t)(3000U + 500U * t);
+    }
+}
+
+/* This function returns the largest difference of two heatmaps
+ */
+static uint32_t dec_max_err(const uint16_t *a, const uint16_t *b, uint32_t numBins)
+{
+    uint32_t i, maxErr = 0;
+    for(i = 0; i < numBins; i++)
+    {
+        uint32_t err = (a[i] > b[i]) ? (uint32_t)(a[i] - b[i]) : (uint32_t)(b[i] - a[i]);
+        maxErr = (err > maxErr) ? err : maxErr;
+    }
+    return maxErr;
+}
+
+/* This function sends made up frames through the codec at every level
+ */
+static void test_levels(void)
+{
+    static uint16_t in[TEST_BINS], encRef[TEST_BINS], decRef[TEST_BINS];
+    static uint8_t out[TEST_OUT_SIZE];
+    uint32_t level, frame;
+
+    for(level = MMWDEMO_HEATMAP_LEVEL_LOSSLESS; level <= MMWDEMO_HEATMAP_LEVEL_MAX; level++)
+    {
+        uint32_t deadBand = MmwDemo_heatMapDeadBand(level);
+        uint32_t maxErr = 0, worstLen = 0, failed = 0;
+        uint64_t bytes = 0;
+
+        gSeed = 1U;
+        for(frame = 0; frame < TEST_FRAMES; frame++)
+        {
+            uint32_t keyFrame = (frame % MMWDEMO_HEATMAP_KEY_FRAME_INTERVAL) == 0U;
+            uint32_t len, err;
+
+            dec_make_heatmap(in, frame);
+            len = MmwDemo_heatMapEncode(in, encRef, TEST_BINS, keyFrame, deadBand, out, sizeof(out));
+            if(len == 0U || MmwDemo_heatMapDecode(out, len, decRef, TEST_BINS, keyFrame) != 0)
+            {
+                failed = 1;
+                break;
+            }
+            err = dec_max_err(in, decRef, TEST_BINS);
+            maxErr = (err > maxErr) ? err : maxErr;
+            failed |= memcmp(encRef, decRef, sizeof(decRef)) != 0;
+            worstLen = (len > worstLen) ? len : worstLen;
+            bytes += len;
+        }
+        check(!failed, "encoder and decoder end up with the same heatmap");
+        check(maxErr <= deadBand, "error stays inside the dead band");
+        printf("level %u: dead band %3u, max error %3u, %6.1f bytes a frame, worst %6u, of %u\n",
+               level, deadBand, maxErr, (double)bytes / TEST_FRAMES, worstLen, (unsigned)TEST_OUT_SIZE);
+    }
+}
+
+/* This function checks every residual code at its edges, long runs and
+ * that broken streams are refused
+ */
+static void test_codes(void)
+{
+    static const int32_t steps[] = {0, 63, -64, 64, -65, 4095, -4096, 4096, -4097, 32767, -32768, 1};
+    static uint16_t in[6000], encRef[6000], decRef[6000];
+    uint8_t out[sizeof(in) * 2U];
+    uint32_t numBins = sizeof(in) / sizeof(in[0]);
+    uint32_t i, len, cut;
+    uint16_t v = 1000U;
+
+    //residuals of every size, then runs of 1, 64, 65, 4160 and 4161 zeros
+    memset(in, 0, sizeof(in));
+    for(i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+    {
+        v = (uint16_t)(v + steps[i]);
+        in[i] = v;
+    }
+    for(; i < numBins; i++)
+    {
+        in[i] = (i == 20U || i == 85U || i == 151U || i == 4312U) ? (uint16_t)(v + 1U) : v;
+    }
+
+    len = MmwDemo_heatMapEncode(in, encRef, numBins, 1U, 0U, out, sizeof(out));
+    check(len != 0U && MmwDemo_heatMapDecode(out, len, decRef, numBins, 1U) == 0 &&
+          memcmp(in, decRef, sizeof(in)) == 0, "key frame with every code decodes");
+
+    //the same again as a change from it is one long run
+    len = MmwDemo_heatMapEncode(in, encRef, numBins, 0U, 0U, out, sizeof(out));
+    check(len == 4U && MmwDemo_heatMapDecode(out, len, decRef, numBins, 0U) == 0 &&
+          memcmp(in, decRef, sizeof(in)) == 0, "unchanged heatmap is a few bytes");
+
+    len = MmwDemo_heatMapEncode(in, encRef, numBins, 1U, 0U, out, sizeof(out));
+    for(cut = 1; cut < len; cut++)
+    {
+        if(MmwDemo_heatMapDecode(out, len - cut, decRef, numBins, 1U) == 0)
+        {
+            break;
+        }
+    }
+    check(cut == len, "truncated stream is refused");
+    check(MmwDemo_heatMapDecode(out, len, decRef, numBins - 1U, 1U) != 0, "stream of more bins is refused");
+    out[0] = 0xF0U;
+    check(MmwDemo_heatMapDecode(out, len, decRef, numBins, 1U) != 0, "unknown code is refused");
+    check(MmwDemo_heatMapEncode(in, encRef, numBins, 1U, 0U, out, 16U) == 0U, "stream that does not fit is refused");
+}
+
+/* This function reads a whole file, or returns NULL
+ */
+static void *dec_read_file(const char *path, size_t *size)
+{
+    FILE *fp = fopen(path, "rb");
+    void *data = NULL;
+    long len;
+
+    if(fp == NULL)
+    {
+        return NULL;
+    }
+    if(fseek(fp, 0, SEEK_END) == 0 && (len = ftell(fp)) > 0 && fseek(fp, 0, SEEK_SET) == 0)
+    {
+        data = malloc((size_t)len);
+        if(data != NULL && fread(data, 1, (size_t)len, fp) != (size_t)len)
+        {
+            free(data);
+            data = NULL;
+        }
+        *size = (size_t)len;
+    }
+    fclose(fp);
+    return data;
+}
+
+/* This function writes the heatmap of every packet of a UART capture
+ */
+static int run_decode(const char *inPath, const char *outPath)
+{
+    uint8_t *cap;
+    uint16_t *heatMap = NULL;
+    uint32_t heatMapBins = 0, haveSeq = 0, lastSeq = 0;
+    uint32_t numPackets = 0, numRaw = 0, numCompressed = 0, numSkipped = 0;
+    uint64_t compressedBytes = 0;
+    size_t size = 0;
+    MmwTlvFrame frame;
+    MmwTlvScan scan;
+    FILE *fp;
+    int ret = 0;
+
+    cap = dec_read_file(inPath, &size);
+    if(cap == NULL)
+    {
+        fprintf(stderr, "cannot read %s\n", inPath);
+        return 1;
+    }
+    fp = fopen(outPath, "wb");
+    if(fp == NULL)
+    {
+        fprintf(stderr, "cannot write %s\n", outPath);
+        free(cap);
+        return 1;
+    }
+
+    mmw_tlv_scan_init(&scan, cap, size, 1);
+    while(ret == 0 && mmw_tlv_scan_next(&scan, &frame))
+    {
+        const MmwTlv *raw = mmw_tlv_get(&frame, MMW_TLV_RANGE_DOPPLER_HEAT_MAP);
+        const MmwTlv *tlv = mmw_tlv_get(&frame, MMW_TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED);
+        MmwDemo_heatMapCompressedHdr hdr;
+        uint32_t numBins;
+
+        numPackets++;
+        if(raw != NULL)
+        {
+            //the next compressed one is a key frame
+            haveSeq = 0;
+            numRaw++;
+            if(fwrite(raw->payload, 1, raw->length, fp) != raw->length)
+            {
+                ret = 1;
+            }
+        }
+        if(tlv == NULL)
+        {
+            continue;
+        }
+
+        //the parser checked it holds the header
+        memcpy(&hdr, tlv->payload, sizeof(hdr));
+        numBins = (uint32_t)hdr.numRangeBins * hdr.numDopplerBins;
+        if(numBins != heatMapBins)
+        {
+            free(heatMap);
+            heatMap = malloc(numBins * sizeof(uint16_t));
+            heatMapBins = numBins;
+            haveSeq = 0;
+            if(heatMap == NULL)
+            {
+                ret = 1;
+                break;
+            }
+        }
+        if(hdr.keyFrame == 0U && (haveSeq == 0U || (uint16_t)(lastSeq + 1U) != hdr.seq))
+        {
+            numSkipped++;
+            haveSeq = 0;
+            continue;
+        }
+        if(MmwDemo_heatMapDecode(tlv->payload + sizeof(hdr), tlv->length - (uint32_t)sizeof(hdr),
+                                 heatMap, numBins, hdr.keyFrame) != 0)
+        {
+            numSkipped++;
+            haveSeq = 0;
+            continue;
+        }
+        haveSeq = 1;
+        lastSeq = hdr.seq;
+        numCompressed++;
+        compressedBytes += tlv->length;
+        if(fwrite(heatMap, sizeof(uint16_t), numBins, fp) != numBins)
+        {
+            ret = 1;
+        }
+    }
+
+    if(ret != 0)
+    {
+        fprintf(stderr, "cannot write %s\n", outPath);
+    }
+    else
+    {
+        printf("%u packets, %u heatmaps sent as they are, %u compressed (%.1f bytes each), %u skipped\n",
+               numPackets, numRaw, numCompressed,
+               numCompressed ? (double)compressedBytes / numCompressed : 0.0, numSkipped);
+    }
+    fclose(fp);
+    free(heatMap);
+    free(cap);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc == 4 && strcmp(argv[1], "decode") == 0)
+    {
+        return run_decode(argv[2], argv[3]);
+    }
+    if(argc != 1)
+    {
+        fprintf(stderr, "usage: %s [decode capture.bin heatmaps.bin]\n", argv[0]);
+        return 1;
+    }
+
+    test_codes();
+    test_levels();
+    if(gFailed)
+    {
+        printf("checks FAILED\n");
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
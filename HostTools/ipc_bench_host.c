@@ -0,0 +1,237 @@
+/*
+ * ipc_bench_host.c
+ *
+ * Host side check of the IPC benchmark harness in ipc_bench.h.
+ *
+ * Replaces RPMessage and CycleCounterP with a stand-in transport: a fake
+ * cycle counter that only moves when the transport says so, and a loopback
+ * peer that answers every message with ipc_bench_echo like R5F_1 and the
+ * DSP do. Because the link delay and the remote turnaround are known
+ * exactly, the round trip, one-way, histogram and throughput numbers can
+ * be checked against what they must be. Also covers dropped echoes, stale
+ * echoes arriving after a timeout, and the cycle counter wrapping.
+ *
+ * This runs on the PC, not on the board. Build with:
+ *     cc -O2 -I.. -o ipc_bench_host ipc_bench_host.c
+ * and run as:
+ *     ./ipc_bench_host
+ * It exits with 1 if any check fails.
+ */
+
+#include <stdio.h>
+
+#include "enums.h"
+#include "ipc_bench.h"
+
+#define LOCAL_MHZ (300U) //R5F
+#define REMOTE_MHZ (360U) //DSP
+#define QUEUE_LEN (16U)
+
+//one message waiting in the fake link
+typedef struct {
+    uint8_t buf[IPC_MSG_MAX_SIZE];
+    uint16_t len;
+} FakeMsg;
+
+//stand-in for RPMessage plus the remote core
+typedef struct {
+    uint32_t now; //fake CycleCounterP, in local cycles
+    uint32_t sendCycles; //time RPMessage_send takes
+    uint32_t linkCycles; //time from send on one core to recv on the other, each way
+    uint32_t turnaroundCycles; //remote cycles between its recv and its send
+    uint32_t dropEvery; //lose every Nth message (0 = never)
+    uint32_t staleEvery; //hold every Nth echo back until after the next send (0 = never)
+    uint32_t sent;
+    FakeMsg queue[QUEUE_LEN]; //echoes on their way back
+    uint32_t head;
+    uint32_t count;
+    FakeMsg held; //echo delivered late
+    int heldValid;
+} FakeLink;
+
+static int32_t fake_send(void *ctx, const void *buf, uint16_t len)
+{
+    FakeLink *link = (FakeLink *)ctx;
+    FakeMsg msg;
+
+    link->now += link->sendCycles;
+    link->sent++;
+    if(link->heldValid)
+    {
+        //the late echo from an earlier message shows up now
+        link->queue[(link->head + link->count++) % QUEUE_LEN] = link->held;
+        link->heldValid = 0;
+    }
+    if(link->dropEvery != 0 && (link->sent % link->dropEvery) == 0)
+    {
+        return 0; //lost on the way, the remote never sees it
+    }
+
+    //the remote core receives it and echoes it
+    memcpy(msg.buf, buf, len);
+    msg.len = len;
+    if(!ipc_bench_echo(msg.buf, msg.len, link->turnaroundCycles, REMOTE_MHZ))
+    {
+        return -1;
+    }
+    if(link->staleEvery != 0 && (link->sent % link->staleEvery) == 0)
+    {
+        link->held = msg;
+        link->heldValid = 1;
+        return 0;
+    }
+    if(link->count >= QUEUE_LEN)
+    {
+        return -1;
+    }
+    link->queue[(link->head + link->count++) % QUEUE_LEN] = msg;
+    return 0;
+}
+
+static int32_t fake_recv(void *ctx, void *buf, uint16_t *len)
+{
+    FakeLink *link = (FakeLink *)ctx;
+    uint32_t remoteLocal = (uint32_t)(((uint64_t)link->turnaroundCycles * LOCAL_MHZ) / REMOTE_MHZ);
+
+    if(link->count == 0)
+    {
+        link->now += 10000U * LOCAL_MHZ; //sat out the whole receive timeout
+        return -1;
+    }
+    FakeMsg *msg = &link->queue[link->head];
+    link->head = (link->head + 1U) % QUEUE_LEN;
+    link->count--;
+    memcpy(buf, msg->buf, msg->len);
+    *len = msg->len;
+    link->now += 2U * link->linkCycles + remoteLocal;
+    return 0;
+}
+
+static uint32_t fake_cycles(void *ctx)
+{
+    return ((FakeLink *)ctx)->now;
+}
+
+static int gFailed = 0;
+
+static void check(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("  FAIL: %s\n", what);
+        gFailed = 1;
+    }
+}
+
+static void print_result(const IpcBenchResult *res)
+{
+    uint32_t i;
+    printf("  bytes drops  rtt min/avg/p99/max ns        one-way avg ns  msgs/s    bytes/s\n");
+    for(i = 0; i < IPC_BENCH_NUM_SIZES; i++)
+    {
+        const IpcBenchSizeResult *sz = &res->size[i];
+        printf("  %5u %5u  %6u/%6u/%6u/%6u  %6u          %8u %10u\n",
+               sz->msgBytes, sz->drops, sz->rtt.minNs,
+               sz->rtt.count ? (uint32_t)(sz->rtt.sumNs / sz->rtt.count) : 0U,
+               ipc_bench_percentile_us(&sz->rtt, 99U) * 1000U, sz->rtt.maxNs,
+               sz->oneWay.count ? (uint32_t)(sz->oneWay.sumNs / sz->oneWay.count) : 0U,
+               sz->msgsPerSec, sz->bytesPerSec);
+    }
+}
+
+static void run(FakeLink *link, uint32_t iterations, IpcBenchResult *res)
+{
+    IpcBenchTransport t = {fake_send, fake_recv, fake_cycles, link, LOCAL_MHZ};
+    ipc_bench_run(&t, iterations, res);
+    print_result(res);
+}
+
+/* Clean link: every number is known exactly.
+ * send 300 cycles (1us), link 1500 cycles (5us) each way,
+ * remote turnaround 720 DSP cycles (2us).
+ */
+static void test_clean(uint32_t startCycles, const char *name)
+{
+    FakeLink link = {0};
+    IpcBenchResult res;
+    uint32_t i;
+
+    printf("%s:\n", name);
+    link.now = startCycles;
+    link.sendCycles = 300U;
+    link.linkCycles = 1500U;
+    link.turnaroundCycles = 720U;
+    run(&link, 100U, &res);
+
+    for(i = 0; i < IPC_BENCH_NUM_SIZES; i++)
+    {
+        const IpcBenchSizeResult *sz = &res.size[i];
+        check(sz->msgBytes == IPC_BENCH_SIZE(i), "message size");
+        check(sz->drops == 0, "no drops on a clean link");
+        check(sz->rtt.count == 100U && sz->rtt.minNs == 13000U && sz->rtt.maxNs == 13000U, "round trip is 13us");
+        check(sz->oneWay.minNs == 5500U && sz->oneWay.maxNs == 5500U, "one way is (13 - 2) / 2 us");
+        check(sz->rtt.hist[4] == 100U, "13us lands in the [8, 16) us bin");
+        check(ipc_bench_percentile_us(&sz->rtt, 99U) == 16U, "p99 bin edge");
+        check(sz->msgsPerSec == 1000000000U / 13000U, "window throughput with 13us per echo");
+        check(sz->bytesPerSec == sz->msgsPerSec * 2U * sz->msgBytes, "bytes per second counts both directions");
+    }
+}
+
+/* Lossy link: every 7th message vanishes and every 11th echo shows up late
+ * so the harness has to throw it away.
+ */
+static void test_lossy(void)
+{
+    FakeLink link = {0};
+    IpcBenchResult res;
+    uint32_t i;
+
+    printf("lossy link:\n");
+    link.sendCycles = 300U;
+    link.linkCycles = 1500U;
+    link.turnaroundCycles = 720U;
+    link.dropEvery = 7U;
+    link.staleEvery = 11U;
+    run(&link, 100U, &res);
+
+    for(i = 0; i < IPC_BENCH_NUM_SIZES; i++)
+    {
+        const IpcBenchSizeResult *sz = &res.size[i];
+        check(sz->drops > 0, "drops are counted");
+        check(sz->rtt.count + sz->drops >= 100U, "every latency message is a sample or a drop");
+        check(sz->rtt.minNs == 13000U, "stale echoes are never matched to a later send");
+        check(sz->oneWay.count == sz->rtt.count, "every round trip gives a one way sample");
+    }
+}
+
+/* Echo path: anything that is not a benchmark request is left alone
+ */
+static void test_echo(void)
+{
+    IpcMsg msg;
+    uint8_t buf[IPC_MSG_MAX_SIZE];
+    uint16_t size = ipc_msg_encode_math(&msg, IPC_OP_ADD, 1, 2, 3);
+
+    printf("echo filter:\n");
+    memcpy(buf, &msg, size);
+    check(ipc_bench_echo(buf, size, 0, REMOTE_MHZ) == 0, "math request is not echoed");
+    check(memcmp(buf, &msg, size) == 0, "math request untouched");
+    ipc_bench_build(buf, IPC_BENCH_SIZE(0), 5U);
+    check(ipc_bench_echo(buf, IPC_BENCH_SIZE(0), 0, REMOTE_MHZ) == 1, "bench request is echoed");
+    check(ipc_bench_echo(buf, IPC_BENCH_SIZE(0), 0, REMOTE_MHZ) == 0, "an echo is not echoed again");
+    check(ipc_bench_bin(999U) == 0 && ipc_bench_bin(1000U) == 1 && ipc_bench_bin(0xFFFFFFFFU) == IPC_BENCH_HIST_BINS - 1U, "bin edges");
+}
+
+int main(void)
+{
+    check(sizeof(IpcBenchResult) <= IPC_SHM_BENCH_SIZE, "result fits the shared memory bench area");
+    check(IPC_BENCH_MAX_SIZE <= IPC_MSG_MAX_SIZE, "largest message fits a vring buffer");
+
+    test_clean(0, "clean link");
+    test_clean(0xFFFFFFFFU - 5000U, "clean link across a cycle counter wrap");
+    test_lossy();
+    test_echo();
+
+    printf(gFailed ? "FAILED\n" : "all checks passed\n");
+    return gFailed;
+}
@@ -0,0 +1,161 @@
+/*
+ * ipc_msg_bench.c
+ *
+ * Host side benchmark for the inter-core command format.
+ *
+ * Compares the old text path (snprintf the command, sscanf it on the
+ * remote core, snprintf the result, atoi it back) against the binary
+ * IpcMsg path from enums.h (encode, decode, handle, decode reply).
+ * It measures the CPU cost of one full round trip minus the transport
+ * and the number of bytes each format puts on the vring.
+ *
+ * This runs on the PC, not on the board. Build with:
+ *     cc -O2 -I.. -o ipc_msg_bench ipc_msg_bench.c
+ * and run as:
+ *     ./ipc_msg_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "enums.h"
+
+#define DEFAULT_ITERATIONS (1000000U)
+
+//keeps the compiler from throwing the loops away
+static volatile int32_t gSink;
+
+/* This function returns the current time in nanoseconds
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* This function does one round trip the way the cores used to,
+ * with a formatted command string and a formatted result string.
+ * It returns the number of bytes sent in both directions.
+ */
+static uint32_t string_round_trip(int32_t x, int32_t y, int32_t *result)
+{
+    char req[IPC_MSG_MAX_SIZE];
+    char reply[IPC_MSG_MAX_SIZE];
+    char cmd[8];
+    int a, b, res = 0;
+    int reqLen, replyLen;
+
+    //R5F_0 side, build the request (terminator is sent too)
+    reqLen = snprintf(req, sizeof(req), "SUB %d %d", (int)x, (int)y) + 1;
+
+    //remote core, parse and answer
+    if(sscanf(req, "%7s %d %d", cmd, &a, &b) == 3)
+    {
+        if(strcmp(cmd, "ADD") == 0)
+        {
+            res = a + b;
+        }
+        else if(strcmp(cmd, "SUB") == 0)
+        {
+            res = a - b;
+        }
+        else if(strcmp(cmd, "MUL") == 0)
+        {
+            res = a * b;
+        }
+    }
+    replyLen = snprintf(reply, sizeof(reply), "%d", res) + 1;
+
+    //R5F_0 side, read the answer back
+    *result = atoi(reply);
+    return (uint32_t)(reqLen + replyLen);
+}
+
+/* This function does one round trip with the binary IpcMsg format.
+ * It returns the number of bytes sent in both directions.
+ */
+static uint32_t binary_round_trip(int32_t x, int32_t y, uint16_t reqId, int32_t *result)
+{
+    IpcMsg out, req, reply, in;
+    uint16_t reqLen, replyLen;
+
+    //R5F_0 side, build the request
+    reqLen = ipc_msg_encode_math(&out, IPC_OP_SUB, reqId, x, y);
+
+    //remote core, decode and answer
+    if(ipc_msg_decode(&out, reqLen, &req) == IPC_STATUS_OK)
+    {
+        replyLen = ipc_msg_handle_math(&req, &reply);
+    }
+    else
+    {
+        replyLen = ipc_msg_encode_result(&reply, &req.hdr, IPC_STATUS_BAD_LENGTH, 0);
+    }
+
+    //R5F_0 side, read the answer back
+    if(ipc_msg_decode(&reply, replyLen, &in) != IPC_STATUS_OK || in.hdr.reqId != reqId)
+    {
+        return 0;
+    }
+    *result = in.payload.result;
+    return (uint32_t)(reqLen + replyLen);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = DEFAULT_ITERATIONS;
+    uint32_t i;
+    uint32_t stringBytes = 0, binaryBytes = 0;
+    uint64_t start, stringNs, binaryNs;
+    int32_t result;
+
+    if(argc > 1)
+    {
+        iterations = (uint32_t)strtoul(argv[1], NULL, 0);
+        if(iterations == 0)
+        {
+            iterations = DEFAULT_ITERATIONS;
+        }
+    }
+
+    //check both paths agree before timing anything
+    for(i = 0; i < 1000; i++)
+    {
+        int32_t x = (int32_t)(i * 7919U) - 500000;
+        int32_t y = (int32_t)(i * 104729U) - 50000000;
+        int32_t s = 0, b = 0;
+        string_round_trip(x, y, &s);
+        if(binary_round_trip(x, y, (uint16_t)i, &b) == 0 || s != b)
+        {
+            printf("mismatch at %u: string %d binary %d\n", i, (int)s, (int)b);
+            return 1;
+        }
+    }
+
+    start = now_ns();
+    for(i = 0; i < iterations; i++)
+    {
+        stringBytes += string_round_trip((int32_t)i, (int32_t)(i >> 1), &result);
+        gSink += result;
+    }
+    stringNs = now_ns() - start;
+
+    start = now_ns();
+    for(i = 0; i < iterations; i++)
+    {
+        binaryBytes += binary_round_trip((int32_t)i, (int32_t)(i >> 1), (uint16_t)i, &result);
+        gSink += result;
+    }
+    binaryNs = now_ns() - start;
+
+    printf("iterations          : %u\n", iterations);
+    printf("                      %12s %12s\n", "string", "binary");
+    printf("ns per round trip   : %12.1f %12.1f\n",
+           (double)stringNs / iterations, (double)binaryNs / iterations);
+    printf("bytes per round trip: %12.1f %12.1f\n",
+           (double)stringBytes / iterations, (double)binaryBytes / iterations);
+    printf("speedup             : %.1fx\n", (double)stringNs / (double)binaryNs);
+    return 0;
+}
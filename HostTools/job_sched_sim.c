@@ -0,0 +1,343 @@
+/*
+ * job_sched_sim.c
+ *
+ * Host side simulation of the offload job scheduler in job_sched.h.
+ *
+ * Models R5F_0, R5F_1 and the DSP as three cores that each run one job
+ * at a time, with a fixed IPC cost each way for the two remote cores.
+ * The same job stream is run through the scheduler and through the old
+ * fixed routing (ADD on R5F_0, SUB on R5F_1, everything else on the DSP)
+ * and the latencies are compared. The second scenario makes the DSP ten
+ * times slower halfway through, like it would be while busy with a radar
+ * frame, to check queued work moves to the other cores. Last it checks a
+ * job dropped after a failed send leaves the latency estimate alone.
+ *
+ * This runs on the PC, not on the board. Build with:
+ *     cc -O2 -I.. -o job_sched_sim job_sched_sim.c
+ * and run as:
+ *     ./job_sched_sim
+ * It exits with 1 if any check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "enums.h"
+#include "job_sched.h"
+
+#define NUM_JOBS (4000U)
+#define IPC_ONE_WAY_US (15U) //RPMessage send on one side to recv on the other
+
+//ops in the simulated stream, registered in this order
+static const uint8_t gOps[] = {IPC_OP_ADD, IPC_OP_SUB, IPC_OP_MUL, IPC_OP_VEC_MUL};
+#define NUM_OPS (sizeof(gOps) / sizeof(gOps[0]))
+
+//time each core needs to run each op once it has it (not counting IPC)
+static const uint32_t gServiceUs[SCHED_NUM_CORES][NUM_OPS] = {
+    {  2U,  2U,  3U, 400U}, //R5F_0, also runs the CLI so batches are slow
+    {  2U,  2U,  3U, 300U}, //R5F_1
+    {  3U,  3U,  3U,  60U}, //DSP with the SIMD loop
+};
+
+//one simulated job
+typedef struct {
+    uint32_t op; //index into gOps
+    uint64_t arriveUs;
+    uint64_t sentUs; //when it left the scheduler queue
+    uint64_t doneUs; //when the reply got back to R5F_0
+    int32_t core;
+    int32_t finished;
+    SchedJob job;
+} SimJob;
+
+//one simulated core
+typedef struct {
+    uint64_t freeUs; //when it can start the next job
+} SimCore;
+
+typedef struct {
+    const char *name;
+    uint64_t makespanUs;
+    double meanUs;
+    uint64_t maxUs;
+    uint32_t perCore[SCHED_NUM_CORES];
+    uint32_t steals;
+} SimResult;
+
+static SimJob gJobs[NUM_JOBS];
+
+/* This function returns how long a core takes for an op at a given time.
+ * When slowDsp is set the DSP is 10x slower for the second half of the run.
+ */
+static uint32_t service_us(int32_t core, uint32_t op, uint64_t nowUs, uint64_t slowFromUs, int slowDsp)
+{
+    uint32_t us = gServiceUs[core][op];
+    if(slowDsp && core == SCHED_CORE_DSP && nowUs >= slowFromUs)
+    {
+        us *= 10U;
+    }
+    return us;
+}
+
+/* This function builds the job stream: bursts of mixed ops with idle gaps.
+ */
+static void make_jobs(void)
+{
+    uint32_t i;
+    uint64_t t = 0;
+    srand(1234);
+    for(i = 0; i < NUM_JOBS; i++)
+    {
+        int r = rand() % 100;
+        gJobs[i].op = (r < 30) ? 0U : (r < 60) ? 1U : (r < 90) ? 2U : 3U;
+        if((i % 50U) == 0)
+        {
+            t += 2000U; //gap between bursts
+        }
+        t += (uint64_t)(rand() % 20);
+        gJobs[i].arriveUs = t;
+    }
+}
+
+/* This function starts a job on a simulated core and works out when its
+ * reply gets back to R5F_0.
+ */
+static void sim_start(SimJob *j, int32_t core, uint64_t nowUs, SimCore *cores, uint64_t slowFromUs, int slowDsp)
+{
+    uint64_t ipc = (core == SCHED_CORE_R5F0) ? 0U : IPC_ONE_WAY_US;
+    uint64_t start = nowUs + ipc;
+    if(cores[core].freeUs > start)
+    {
+        start = cores[core].freeUs;
+    }
+    uint64_t end = start + service_us(core, j->op, start, slowFromUs, slowDsp);
+    cores[core].freeUs = end;
+    j->core = core;
+    j->sentUs = nowUs;
+    j->doneUs = end + ipc;
+}
+
+/* This function collects latency numbers once every job has finished
+ */
+static void sim_summarise(SimResult *res)
+{
+    uint32_t i;
+    double total = 0.0;
+    res->makespanUs = 0;
+    res->maxUs = 0;
+    for(i = 0; i < SCHED_NUM_CORES; i++)
+    {
+        res->perCore[i] = 0;
+    }
+    for(i = 0; i < NUM_JOBS; i++)
+    {
+        uint64_t lat = gJobs[i].doneUs - gJobs[i].arriveUs;
+        total += (double)lat;
+        if(lat > res->maxUs)
+        {
+            res->maxUs = lat;
+        }
+        if(gJobs[i].doneUs > res->makespanUs)
+        {
+            res->makespanUs = gJobs[i].doneUs;
+        }
+        res->perCore[gJobs[i].core]++;
+    }
+    res->meanUs = total / NUM_JOBS;
+}
+
+/* This function runs the old fixed routing
+ */
+static void sim_fixed(SimResult *res, int slowDsp, uint64_t slowFromUs)
+{
+    SimCore cores[SCHED_NUM_CORES] = {{0}};
+    uint32_t i;
+    for(i = 0; i < NUM_JOBS; i++)
+    {
+        int32_t core = (gOps[gJobs[i].op] == IPC_OP_ADD) ? SCHED_CORE_R5F0 :
+                       (gOps[gJobs[i].op] == IPC_OP_SUB) ? SCHED_CORE_R5F1 : SCHED_CORE_DSP;
+        sim_start(&gJobs[i], core, gJobs[i].arriveUs, cores, slowFromUs, slowDsp);
+    }
+    res->name = "fixed";
+    res->steals = 0;
+    sim_summarise(res);
+}
+
+/* This function starts every queued job that has room, like sched_pump
+ */
+static void sim_pump(Sched *s, uint64_t nowUs, SimCore *cores, uint64_t slowFromUs, int slowDsp)
+{
+    uint32_t started;
+    do
+    {
+        uint32_t core;
+        started = 0;
+        for(core = 0; core < SCHED_NUM_CORES; core++)
+        {
+            SchedJob job;
+            if(sched_next(s, core, &job))
+            {
+                SimJob *j = (SimJob *)job.arg;
+                j->job = job;
+                sim_start(j, (int32_t)core, nowUs, cores, slowFromUs, slowDsp);
+                started++;
+            }
+        }
+    } while(started > 0);
+}
+
+/* This function runs the job stream through job_sched.h.
+ * Returns 0 if the run was consistent.
+ */
+static int sim_sched(SimResult *res, int slowDsp, uint64_t slowFromUs)
+{
+    Sched s;
+    SimCore cores[SCHED_NUM_CORES] = {{0}};
+    const uint32_t mathSeedUs[SCHED_NUM_CORES] = {2U, 40U, 60U};
+    const uint32_t vecSeedUs[SCHED_NUM_CORES] = {400U, 300U, 120U};
+    uint32_t next = 0;
+    uint32_t done = 0;
+    uint32_t i;
+
+    sched_init(&s);
+    for(i = 0; i < NUM_OPS; i++)
+    {
+        sched_register_op(&s, gOps[i], SCHED_CAP_ALL, ipc_opcode_is_vec(gOps[i]) ? vecSeedUs : mathSeedUs);
+    }
+    for(i = 0; i < NUM_JOBS; i++)
+    {
+        gJobs[i].finished = 0;
+        gJobs[i].doneUs = 0;
+        gJobs[i].core = -1;
+    }
+
+    while(done < NUM_JOBS)
+    {
+        //earliest reply still in flight
+        SimJob *first = NULL;
+        for(i = 0; i < NUM_JOBS; i++)
+        {
+            if(gJobs[i].core >= 0 && !gJobs[i].finished && (first == NULL || gJobs[i].doneUs < first->doneUs))
+            {
+                first = &gJobs[i];
+            }
+        }
+
+        if(next < NUM_JOBS && (first == NULL || gJobs[next].arriveUs <= first->doneUs))
+        {
+            //new job arrives
+            if(sched_submit(&s, gOps[gJobs[next].op], &gJobs[next]) < 0)
+            {
+                printf("submit failed at job %u\n", next);
+                return -1;
+            }
+            sim_pump(&s, gJobs[next].arriveUs, cores, slowFromUs, slowDsp);
+            next++;
+        }
+        else if(first != NULL)
+        {
+            //a reply comes back
+            first->finished = 1;
+            sched_complete(&s, &first->job, (uint32_t)(first->doneUs - first->sentUs));
+            sim_pump(&s, first->doneUs, cores, slowFromUs, slowDsp);
+            done++;
+        }
+        else
+        {
+            printf("jobs stuck in the queues with nothing in flight\n");
+            return -1;
+        }
+    }
+
+    for(i = 0; i < SCHED_NUM_CORES; i++)
+    {
+        if(s.inFlight[i] != 0 || s.queue[i].count != 0)
+        {
+            printf("core %u not idle at the end\n", i);
+            return -1;
+        }
+    }
+
+    res->name = "scheduled";
+    res->steals = s.steals[0] + s.steals[1] + s.steals[2];
+    sim_summarise(res);
+    return 0;
+}
+
+static void print_result(const SimResult *res)
+{
+    printf("  %-10s mean %8.1f us  max %7llu us  makespan %9llu us  R5F0 %4u  R5F1 %4u  DSP %4u  steals %u\n",
+           res->name, res->meanUs, (unsigned long long)res->maxUs, (unsigned long long)res->makespanUs,
+           res->perCore[0], res->perCore[1], res->perCore[2], res->steals);
+}
+
+/* This function checks a job dropped after a failed send frees its core
+ * without moving the latency estimate.
+ */
+static int sim_abort(void)
+{
+    static const uint32_t seedUs[SCHED_NUM_CORES] = {100U, 10U, 10U};
+    Sched s;
+    SchedJob job;
+    int32_t core;
+
+    sched_init(&s);
+    sched_register_op(&s, IPC_OP_MUL, SCHED_CAP_ALL, seedUs);
+    core = sched_submit(&s, IPC_OP_MUL, NULL);
+    if(core != SCHED_CORE_R5F1 || !sched_next(&s, (uint32_t)core, &job))
+    {
+        printf("  FAIL: job not placed on R5F_1\n");
+        return 1;
+    }
+    sched_abort(&s, &job);
+    if(s.inFlight[core] != 0U || s.backlogUs[core] != 0U || s.estUs[core][0] != seedUs[core])
+    {
+        printf("  FAIL: aborted job left state behind or moved the estimate\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    SimResult fixed, sched;
+    int failed = 0;
+    uint64_t slowFromUs;
+
+    make_jobs();
+    slowFromUs = gJobs[NUM_JOBS / 2U].arriveUs;
+
+    printf("steady load:\n");
+    sim_fixed(&fixed, 0, 0);
+    print_result(&fixed);
+    if(sim_sched(&sched, 0, 0) != 0)
+    {
+        return 1;
+    }
+    print_result(&sched);
+    if(sched.meanUs > fixed.meanUs)
+    {
+        printf("  FAIL: scheduler slower than fixed routing\n");
+        failed = 1;
+    }
+
+    printf("DSP 10x slower after %llu us:\n", (unsigned long long)slowFromUs);
+    sim_fixed(&fixed, 1, slowFromUs);
+    print_result(&fixed);
+    if(sim_sched(&sched, 1, slowFromUs) != 0)
+    {
+        return 1;
+    }
+    print_result(&sched);
+    if(sched.meanUs > fixed.meanUs)
+    {
+        printf("  FAIL: scheduler slower than fixed routing\n");
+        failed = 1;
+    }
+
+    printf("send failure:\n");
+    failed |= sim_abort();
+
+    printf(failed ? "FAILED\n" : "all checks passed\n");
+    return failed;
+}
@@ -0,0 +1,334 @@
+/*
+ * lvds_batch_test.c
+ *
+ * Host side of the LVDS software session: checks the batch layout of
+ * mmw_lvds_batch.h and reads the user buffers the board streamed.
+ *
+ * Run without arguments it writes made up frames, from none to more
+ * points than a frame may have, into a user buffer as the MSS does, one
+ * to the most frames to a batch, and checks the frames come out of the
+ * reader as they went in, cut off where the writer cuts them off. It also
+ * checks a batch cut short at stop reads back and a damaged one is refused
+ * whole.
+ *
+ * "read" takes a file of user buffers as captured off LVDS with the HSI
+ * headers taken off, every one bufferBytes long, and prints every frame.
+ * It is for lvdsBatchCfg with 2 or more frames to a batch; with 1 the
+ * board streams every frame in the SDK demo format instead.
+ * bufferBytes is MmwDemo_lvdsBatchSize(framesPerBatch, maxObj) of the
+ * board's lvdsBatchCfg, 16 + framesPerBatch * (8 + 20 * maxObj), the user
+ * buffer size in its SW session HSI header.
+ *
+ * This runs on the PC, not on the board. Build with:
+ *     cc -O2 -Wall -I../ExampleProjects/out_of_box_2944_mss/include
+ *        -o lvds_batch_test lvds_batch_test.c
+ * and run as:
+ *     ./lvds_batch_test
+ *     ./lvds_batch_test read <bufferBytes> capture.bin
+ * It exits with 1 if a check fails, the file cannot be read or a buffer
+ * in it is not a batch.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mmw_lvds_batch.h"
+
+#define TEST_MAX_OBJ (50U)
+#define TEST_NUM_FRAMES (200U)
+#define TEST_BUF_SIZE (sizeof(MmwDemo_lvdsBatchHdr) + \
+                       MMWDEMO_LVDS_BATCH_MAX_FRAMES * (sizeof(MmwDemo_lvdsFrameHdr) + \
+                       TEST_MAX_OBJ * (MMWDEMO_LVDS_BATCH_POINT_SIZE + MMWDEMO_LVDS_BATCH_SIDE_SIZE)))
+
+static int gFailed = 0;
+static uint32_t gSeed = 1U;
+
+static uint32_t gBuf[TEST_BUF_SIZE / 4U];
+static uint8_t gPoints[(TEST_MAX_OBJ + 8U) * MMWDEMO_LVDS_BATCH_POINT_SIZE];
+static uint8_t gSide[(TEST_MAX_OBJ + 8U) * MMWDEMO_LVDS_BATCH_SIDE_SIZE];
+
+/* Frames the reader gave back, checked against what was written */
+typedef struct
+{
+    uint32_t numFrames;
+    uint32_t numBad;
+    uint32_t nextFrame;
+} ReadCheck;
+
+/* This function records one check
+ */
+static void check(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAILED: %s\n", what);
+        gFailed = 1;
+    }
+}
+
+/* This function returns a pseudo random 32 bit value
+ */
+static uint32_t test_rand(void)
+{
+    gSeed = gSeed * 1664525U + 1013904223U;
+    return gSeed;
+}
+
+/* This function returns the points of a frame, now and then more than a
+ * frame may have
+ */
+static uint32_t test_num_obj(uint32_t frame)
+{
+    if(frame % 13U == 5U)
+    {
+        return TEST_MAX_OBJ + 1U + (frame % 7U);
+    }
+    return test_rand() % (TEST_MAX_OBJ + 1U);
+}
+
+/* This function fills the points and side info of a frame so every byte
+ * tells the frame and where it is
+ */
+static void test_make_frame(uint32_t frame, uint32_t numObj)
+{
+    uint32_t i;
+
+    for(i = 0U; i < numObj * MMWDEMO_LVDS_BATCH_POINT_SIZE; i++)
+    {
+        gPoints[i] = (uint8_t)(frame * 31U + i);
+    }
+    for(i = 0U; i < numObj * MMWDEMO_LVDS_BATCH_SIDE_SIZE; i++)
+    {
+        gSide[i] = (uint8_t)(frame * 17U + i * 3U);
+    }
+}
+
+/* This function checks one frame the reader gave back
+ */
+static void test_on_frame(void *arg, const MmwDemo_lvdsFrameHdr *frame,
+                          const uint8_t *points, const uint8_t *sideInfo)
+{
+    ReadCheck *rc = (ReadCheck *)arg;
+    uint32_t numObj;
+    int ok;
+
+    gSeed = frame->frameNum * 2654435761U + 1U;
+    numObj = test_num_obj(frame->frameNum);
+    if(numObj > TEST_MAX_OBJ)
+    {
+        numObj = TEST_MAX_OBJ;
+    }
+    test_make_frame(frame->frameNum, numObj);
+
+    ok = (frame->frameNum == rc->nextFrame) && (frame->subFrameNum == frame->frameNum % 4U) &&
+         (frame->numObj == numObj) &&
+         (memcmp(points, gPoints, numObj * MMWDEMO_LVDS_BATCH_POINT_SIZE) == 0) &&
+         (memcmp(sideInfo, gSide, numObj * MMWDEMO_LVDS_BATCH_SIDE_SIZE) == 0);
+    if(!ok)
+    {
+        rc->numBad++;
+    }
+    rc->nextFrame = frame->frameNum + 1U;
+    rc->numFrames++;
+}
+
+/* This function adds frame to the batch as the MSS does
+ */
+static int32_t test_add(MmwDemo_lvdsBatch *batch, uint32_t frame)
+{
+    uint32_t numObj;
+
+    gSeed = frame * 2654435761U + 1U;
+    numObj = test_num_obj(frame);
+    test_make_frame(frame, numObj);
+    return MmwDemo_lvdsBatchAdd(batch, frame, (uint16_t)(frame % 4U), numObj, gPoints, gSide);
+}
+
+/* This function streams TEST_NUM_FRAMES frames framesPerBatch at a time
+ * and reads every batch back, the last one cut short as at stop
+ */
+static void test_batches(uint32_t framesPerBatch)
+{
+    MmwDemo_lvdsBatch batch;
+    ReadCheck rc;
+    char what[96];
+    uint32_t frame, seq = 0U, numCut = 0U, expectSeq = 0U;
+    int32_t n;
+    int ok = 1;
+
+    memset(&rc, 0, sizeof(rc));
+    MmwDemo_lvdsBatchInit(&batch, (uint8_t *)gBuf, framesPerBatch, TEST_MAX_OBJ);
+    ok &= (batch.size == MmwDemo_lvdsBatchSize(framesPerBatch, TEST_MAX_OBJ)) && (batch.size <= TEST_BUF_SIZE);
+
+    for(frame = 0U; frame < TEST_NUM_FRAMES; frame++)
+    {
+        gSeed = frame * 2654435761U + 1U;
+        if(test_num_obj(frame) > TEST_MAX_OBJ)
+        {
+            numCut += test_num_obj(frame) - TEST_MAX_OBJ;
+        }
+        if(test_add(&batch, frame) == 1)
+        {
+            n = MmwDemo_lvdsBatchRead((const uint8_t *)gBuf, batch.size, &seq, test_on_frame, &rc);
+            ok &= (n == (int32_t)framesPerBatch) && (seq == expectSeq++);
+            MmwDemo_lvdsBatchNext(&batch);
+        }
+    }
+
+    /* What is left goes out at stop */
+    if(MmwDemo_lvdsBatchNumFrames(&batch) != 0U)
+    {
+        n = MmwDemo_lvdsBatchRead((const uint8_t *)gBuf, batch.size, &seq, test_on_frame, &rc);
+        ok &= (n == (int32_t)(TEST_NUM_FRAMES % framesPerBatch)) && (seq == expectSeq);
+    }
+
+    snprintf(what, sizeof(what), "%u frames a batch, %u read, %u bad", framesPerBatch, rc.numFrames, rc.numBad);
+    check(ok && (rc.numFrames == TEST_NUM_FRAMES) && (rc.numBad == 0U), what);
+    snprintf(what, sizeof(what), "%u frames a batch, %u points cut off", framesPerBatch, batch.numCut);
+    check((numCut != 0U) && (batch.numCut == numCut), what);
+}
+
+/* This function checks a damaged batch is refused and none of its frames
+ * handed over
+ */
+static void test_damaged(void)
+{
+    MmwDemo_lvdsBatch batch;
+    MmwDemo_lvdsBatchHdr hdr;
+    MmwDemo_lvdsFrameHdr frame;
+    ReadCheck rc;
+    uint8_t *buf = (uint8_t *)gBuf;
+    uint32_t seq, frame1;
+
+    MmwDemo_lvdsBatchInit(&batch, buf, 3U, TEST_MAX_OBJ);
+    test_add(&batch, 0U);
+    test_add(&batch, 1U);
+    test_add(&batch, 2U);
+    memcpy(&hdr, buf, sizeof(hdr));
+    memset(&rc, 0, sizeof(rc));
+
+    check(MmwDemo_lvdsBatchRead(buf, batch.size, &seq, test_on_frame, &rc) == 3, "intact batch read");
+
+    /* Cut short by the capture */
+    memset(&rc, 0, sizeof(rc));
+    check(MmwDemo_lvdsBatchRead(buf, sizeof(hdr) + hdr.length - 4U, &seq, test_on_frame, &rc) == -1 &&
+          rc.numFrames == 0U, "cut short batch refused");
+
+    /* Not a batch */
+    buf[0] ^= 0xFFU;
+    check(MmwDemo_lvdsBatchRead(buf, batch.size, &seq, test_on_frame, &rc) == -1 &&
+          rc.numFrames == 0U, "wrong magic refused");
+    buf[0] ^= 0xFFU;
+
+    /* A frame says it has more points than there are bytes */
+    frame1 = sizeof(hdr) + MmwDemo_lvdsBatchFrameSize(((const MmwDemo_lvdsFrameHdr *)(buf + sizeof(hdr)))->numObj);
+    memcpy(&frame, buf + frame1, sizeof(frame));
+    frame.numObj = (uint16_t)(frame.numObj + 200U);
+    memcpy(buf + frame1, &frame, sizeof(frame));
+    check(MmwDemo_lvdsBatchRead(buf, batch.size, &seq, test_on_frame, &rc) == -1 &&
+          rc.numFrames == 0U, "overlong frame refused");
+    frame.numObj = (uint16_t)(frame.numObj - 200U);
+    memcpy(buf + frame1, &frame, sizeof(frame));
+
+    /* Frames do not add up to the length */
+    hdr.length += 4U;
+    memcpy(buf, &hdr, sizeof(hdr));
+    check(MmwDemo_lvdsBatchRead(buf, batch.size, &seq, test_on_frame, &rc) == -1 &&
+          rc.numFrames == 0U, "length mismatch refused");
+}
+
+/* This function prints a frame of the board
+ */
+static void read_on_frame(void *arg, const MmwDemo_lvdsFrameHdr *frame,
+                          const uint8_t *points, const uint8_t *sideInfo)
+{
+    float xyzv[4];
+    int16_t snrNoise[2];
+    uint16_t i;
+
+    (void)arg;
+    printf("frame %u subframe %u, %u points\n", frame->frameNum, frame->subFrameNum, frame->numObj);
+    for(i = 0U; i < frame->numObj; i++)
+    {
+        memcpy(xyzv, points + i * MMWDEMO_LVDS_BATCH_POINT_SIZE, sizeof(xyzv));
+        memcpy(snrNoise, sideInfo + i * MMWDEMO_LVDS_BATCH_SIDE_SIZE, sizeof(snrNoise));
+        printf("  %8.3f %8.3f %8.3f %8.3f  snr %.1f noise %.1f\n", xyzv[0], xyzv[1], xyzv[2], xyzv[3],
+               snrNoise[0] * 0.1, snrNoise[1] * 0.1);
+    }
+}
+
+static int run_read(uint32_t bufferBytes, const char *path)
+{
+    FILE *f;
+    uint8_t *buf;
+    uint32_t seq, numBatches = 0U, numFrames = 0U, lost = 0U, nextSeq = 0U;
+    int32_t n;
+    int bad = 0;
+
+    if(bufferBytes < sizeof(MmwDemo_lvdsBatchHdr))
+    {
+        fprintf(stderr, "bufferBytes too small\n");
+        return 1;
+    }
+    f = fopen(path, "rb");
+    buf = malloc(bufferBytes);
+    if(f == NULL || buf == NULL)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    while(fread(buf, 1, bufferBytes, f) == bufferBytes)
+    {
+        n = MmwDemo_lvdsBatchRead(buf, bufferBytes, &seq, read_on_frame, NULL);
+        if(n < 0)
+        {
+            fprintf(stderr, "buffer %u is not a batch\n", numBatches);
+            bad = 1;
+            break;
+        }
+        if(numBatches != 0U && seq != nextSeq)
+        {
+            lost += seq - nextSeq;
+        }
+        nextSeq = seq + 1U;
+        numBatches++;
+        numFrames += (uint32_t)n;
+    }
+    fflush(stdout);
+    fprintf(stderr, "%u batches, %u frames, %u batches lost\n", numBatches, numFrames, lost);
+    free(buf);
+    fclose(f);
+    return bad;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t framesPerBatch;
+
+    if(argc == 4 && strcmp(argv[1], "read") == 0)
+    {
+        return run_read((uint32_t)atoi(argv[2]), argv[3]);
+    }
+    if(argc != 1)
+    {
+        fprintf(stderr, "usage: %s [read <bufferBytes> capture.bin]\n", argv[0]);
+        return 1;
+    }
+
+    for(framesPerBatch = 1U; framesPerBatch <= MMWDEMO_LVDS_BATCH_MAX_FRAMES; framesPerBatch++)
+    {
+        test_batches(framesPerBatch);
+    }
+    test_damaged();
+    //the lvdsBatchCfg help gives the bytes a batch streams as this
+    check(MmwDemo_lvdsBatchSize(3U, 25U) == 16U + 3U * (8U + 20U * 25U), "batch size as in the lvdsBatchCfg help");
+    if(gFailed)
+    {
+        printf("checks FAILED\n");
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
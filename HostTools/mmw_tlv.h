@@ -0,0 +1,592 @@
+/*
+ * mmw_tlv.h
+ *
+ * Host side parser of the output packets of the demo: a 40 byte
+ * MmwDemo_output_message_header starting with the magic word, then numTLVs
+ * TLVs of an 8 byte type and length and the payload, padded to a multiple
+ * of 32 bytes.
+ *
+ * Nothing is copied. mmw_tlv_parse checks a packet where it lies and
+ * fills an MmwTlvFrame with its header and pointers to the TLV payloads,
+ * the typed views below read the payloads out of that. The lengths are
+ * checked against the packet and, for the types whose size is known,
+ * against the type, so a view never reads past its TLV. mmw_tlv_scan
+ * walks a buffer of packets, skipping over anything between them,
+ * and MmwTlvStream does the same for bytes that arrive in pieces, copying
+ * only a packet that is split between two pieces. The magic word is
+ * looked for with memchr on its first byte, which the C library does
+ * many bytes at a time.
+ *
+ * The packets carry no checksum. A packet cut short in its last TLV, by a
+ * lost datagram or bytes dropped on the UART, is taken with the start of
+ * the next one as the rest of its payload and the next one is lost. A cut
+ * anywhere else does not line up and only the packet that was cut is lost.
+ *
+ * The TLV types and payloads are the ones of mmw_output.h, repeated here
+ * because that one needs the SDK. The header of the compressed heatmap is
+ * the one of mmw_heatmap_codec.h, so build with
+ * -I../ExampleProjects/out_of_box_2944_mss/include.
+ */
+
+#ifndef MMW_TLV_H
+#define MMW_TLV_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mmw_heatmap_codec.h"
+
+#define MMW_TLV_MAGIC_LEN (8U)
+#define MMW_TLV_HEADER_LEN (40U)
+#define MMW_TLV_TL_LEN (8U)
+#define MMW_TLV_SEGMENT_LEN (32U) //MMWDEMO_OUTPUT_MSG_SEGMENT_LEN
+#define MMW_TLV_MAX_TLVS (32U)
+#define MMW_TLV_MAX_PACKET_LEN (1024U * 1024U) //longer is taken for a false magic word
+
+/* MmwDemo_output_message_type */
+typedef enum
+{
+    MMW_TLV_DETECTED_POINTS = 1,
+    MMW_TLV_RANGE_PROFILE,
+    MMW_TLV_NOISE_PROFILE,
+    MMW_TLV_AZIMUT_STATIC_HEAT_MAP,
+    MMW_TLV_RANGE_DOPPLER_HEAT_MAP,
+    MMW_TLV_STATS,
+    MMW_TLV_DETECTED_POINTS_SIDE_INFO,
+    MMW_TLV_AZIMUT_ELEVATION_STATIC_HEAT_MAP,
+    MMW_TLV_TEMPERATURE_STATS,
+    MMW_TLV_STAGE_TIMING,
+    MMW_TLV_COMPRESSED_POINTS,
+    MMW_TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED,
+    MMW_TLV_TYPE_MAX
+} MmwTlvType;
+
+/* Results of mmw_tlv_parse */
+#define MMW_TLV_OK (0)
+#define MMW_TLV_NEED_MORE (1)
+#define MMW_TLV_BAD (-1)
+
+/* One TLV, payload points into the packet */
+typedef struct
+{
+    uint32_t type;
+    uint32_t length;
+    const uint8_t *payload;
+} MmwTlv;
+
+/* One packet, MmwDemo_output_message_header and its TLVs */
+typedef struct
+{
+    const uint8_t *packet;
+    uint32_t version;
+    uint32_t totalPacketLen;
+    uint32_t platform;
+    uint32_t frameNumber;
+    uint32_t timeCpuCycles;
+    uint32_t numDetectedObj;
+    uint32_t numTLVs;
+    uint32_t subFrameNumber;
+    MmwTlv tlv[MMW_TLV_MAX_TLVS];
+    const MmwTlv *byType[MMW_TLV_TYPE_MAX]; //first TLV of every known type, NULL when not there
+} MmwTlvFrame;
+
+/* DPIF_PointCloudCartesian */
+typedef struct
+{
+    float x;
+    float y;
+    float z;
+    float velocity;
+} MmwTlvPoint;
+
+/* DPIF_PointCloudSideInfo, 0.1 dB */
+typedef struct
+{
+    int16_t snr;
+    int16_t noise;
+} MmwTlvSideInfo;
+
+/* MmwDemo_output_message_stats */
+typedef struct
+{
+    uint32_t interFrameProcessingTime;
+    uint32_t transmitOutputTime;
+    uint32_t interFrameProcessingMargin;
+    uint32_t interChirpProcessingMargin;
+    uint32_t activeFrameCPULoad;
+    uint32_t interFrameCPULoad;
+} MmwTlvStats;
+
+/* MmwDemo_output_message_stageTiming, MMWDEMO_OUTPUT_STAGE_MAX stages */
+#define MMW_TLV_NUM_STAGES (6U)
+typedef struct
+{
+    uint32_t windowIndex;
+    uint32_t numFrames;
+    uint32_t dspClockMHz;
+    uint32_t pipelinedAoa;
+    struct
+    {
+        uint32_t minCycles;
+        uint32_t meanCycles;
+        uint32_t p99Cycles;
+        uint32_t maxCycles;
+    } stage[MMW_TLV_NUM_STAGES];
+    uint32_t numClamped;  //frames whose point cloud was cut to a result slot
+    uint32_t numSlotBusy; //frames dropped because the MSS still held their slot
+} MmwTlvStageTiming;
+
+/* MmwDemo_output_message_compressedPointUnit and one compressed point */
+#define MMW_TLV_COMPRESSED_UNIT_LEN (16U)
+#define MMW_TLV_COMPRESSED_POINT_LEN (10U)
+
+/* A run of fixed size elements in a payload, read with the getters as it
+ * may not be aligned */
+typedef struct
+{
+    const uint8_t *data;
+    uint32_t count;
+} MmwTlvArray;
+
+/* This function reads a little endian word */
+static inline uint32_t mmw_tlv_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* This function returns where the next magic word starts in buf, or len
+ * when there is none. A magic word cut off by the end of buf is found
+ * too, with fewer than 8 bytes after it
+ */
+static inline size_t mmw_tlv_find_magic(const uint8_t *buf, size_t len)
+{
+    static const uint8_t magic[MMW_TLV_MAGIC_LEN] = {0x02, 0x01, 0x04, 0x03, 0x06, 0x05, 0x08, 0x07};
+    const uint8_t *p = buf;
+    const uint8_t *end = buf + len;
+
+    while((p = memchr(p, magic[0], (size_t)(end - p))) != NULL)
+    {
+        size_t n = (size_t)(end - p) < sizeof(magic) ? (size_t)(end - p) : sizeof(magic);
+        if(memcmp(p, magic, n) == 0)
+        {
+            return (size_t)(p - buf);
+        }
+        p++;
+    }
+    return len;
+}
+
+/* This function checks the length of a TLV of a known type against the
+ * type and the packet header, and returns 0 when it does not fit
+ */
+static inline int mmw_tlv_length_ok(uint32_t type, uint32_t length, uint32_t numDetectedObj)
+{
+    switch(type)
+    {
+        case MMW_TLV_DETECTED_POINTS:
+            return length == numDetectedObj * sizeof(MmwTlvPoint);
+        case MMW_TLV_DETECTED_POINTS_SIDE_INFO:
+            return length == numDetectedObj * sizeof(MmwTlvSideInfo);
+        case MMW_TLV_RANGE_PROFILE:
+        case MMW_TLV_NOISE_PROFILE:
+        case MMW_TLV_RANGE_DOPPLER_HEAT_MAP:
+            return (length & 1U) == 0U;
+        case MMW_TLV_AZIMUT_STATIC_HEAT_MAP:
+            return (length & 3U) == 0U; //cmplx16ImRe_t
+        case MMW_TLV_STATS:
+            return length == sizeof(MmwTlvStats);
+        case MMW_TLV_STAGE_TIMING:
+            return length == sizeof(MmwTlvStageTiming);
+        case MMW_TLV_COMPRESSED_POINTS:
+            //at most numDetectedObj, the MSS caps them at what a result slot holds
+            return length >= MMW_TLV_COMPRESSED_UNIT_LEN &&
+                   (length - MMW_TLV_COMPRESSED_UNIT_LEN) % MMW_TLV_COMPRESSED_POINT_LEN == 0U &&
+                   (length - MMW_TLV_COMPRESSED_UNIT_LEN) / MMW_TLV_COMPRESSED_POINT_LEN <= numDetectedObj;
+        case MMW_TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED:
+            return length >= sizeof(MmwDemo_heatMapCompressedHdr);
+        default:
+            return 1;
+    }
+}
+
+/* This function parses the packet at the start of buf. It returns
+ * MMW_TLV_OK with frame filled in, MMW_TLV_NEED_MORE when buf ends before
+ * the packet does, or MMW_TLV_BAD when buf does not start with a packet
+ * or the packet does not hold together
+ */
+static inline int mmw_tlv_parse(const uint8_t *buf, size_t len, MmwTlvFrame *frame)
+{
+    uint32_t i, pos;
+
+    if(len < MMW_TLV_HEADER_LEN)
+    {
+        size_t n = len < MMW_TLV_MAGIC_LEN ? len : MMW_TLV_MAGIC_LEN;
+        return (mmw_tlv_find_magic(buf, n) == 0U) ? MMW_TLV_NEED_MORE : MMW_TLV_BAD;
+    }
+    if(mmw_tlv_find_magic(buf, MMW_TLV_MAGIC_LEN) != 0U)
+    {
+        return MMW_TLV_BAD;
+    }
+    frame->totalPacketLen = mmw_tlv_le32(&buf[12]);
+    frame->numTLVs = mmw_tlv_le32(&buf[32]);
+    if(frame->totalPacketLen < MMW_TLV_HEADER_LEN || frame->totalPacketLen > MMW_TLV_MAX_PACKET_LEN ||
+       frame->numTLVs > MMW_TLV_MAX_TLVS ||
+       frame->totalPacketLen < MMW_TLV_HEADER_LEN + frame->numTLVs * MMW_TLV_TL_LEN)
+    {
+        return MMW_TLV_BAD;
+    }
+    if(len < frame->totalPacketLen)
+    {
+        return MMW_TLV_NEED_MORE;
+    }
+
+    frame->packet = buf;
+    frame->version = mmw_tlv_le32(&buf[8]);
+    frame->platform = mmw_tlv_le32(&buf[16]);
+    frame->frameNumber = mmw_tlv_le32(&buf[20]);
+    frame->timeCpuCycles = mmw_tlv_le32(&buf[24]);
+    frame->numDetectedObj = mmw_tlv_le32(&buf[28]);
+    frame->subFrameNumber = mmw_tlv_le32(&buf[36]);
+    memset(frame->byType, 0, sizeof(frame->byType));
+
+    pos = MMW_TLV_HEADER_LEN;
+    for(i = 0; i < frame->numTLVs; i++)
+    {
+        MmwTlv *tlv = &frame->tlv[i];
+        if(frame->totalPacketLen - pos < MMW_TLV_TL_LEN)
+        {
+            return MMW_TLV_BAD;
+        }
+        tlv->type = mmw_tlv_le32(&buf[pos]);
+        tlv->length = mmw_tlv_le32(&buf[pos + 4U]);
+        pos += MMW_TLV_TL_LEN;
+        if(tlv->length > frame->totalPacketLen - pos ||
+           !mmw_tlv_length_ok(tlv->type, tlv->length, frame->numDetectedObj))
+        {
+            return MMW_TLV_BAD;
+        }
+        tlv->payload = &buf[pos];
+        pos += tlv->length;
+        if(tlv->type < MMW_TLV_TYPE_MAX && frame->byType[tlv->type] == NULL)
+        {
+            frame->byType[tlv->type] = tlv;
+        }
+    }
+    //what is left is the padding to a whole segment
+    return (frame->totalPacketLen - pos < MMW_TLV_SEGMENT_LEN) ? MMW_TLV_OK : MMW_TLV_BAD;
+}
+
+/* Walk over a buffer of packets */
+typedef struct
+{
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    int complete;        //1 when buf is all there is
+    uint64_t numSkipped; //bytes that were not part of a packet
+    uint32_t numBad;     //whole magic words that did not start a packet
+} MmwTlvScan;
+
+/* This function starts a walk over buf. With complete 0 a packet cut off
+ * by the end of buf is left at scan->pos for when more comes, with 1 it is
+ * skipped like a bad one
+ */
+static inline void mmw_tlv_scan_init(MmwTlvScan *scan, const uint8_t *buf, size_t len, int complete)
+{
+    memset(scan, 0, sizeof(*scan));
+    scan->buf = buf;
+    scan->len = len;
+    scan->complete = complete;
+}
+
+/* This function finds the next packet and returns 1, or 0 at the end of
+ * the buffer
+ */
+static inline int mmw_tlv_scan_next(MmwTlvScan *scan, MmwTlvFrame *frame)
+{
+    while(scan->pos < scan->len)
+    {
+        size_t at = scan->pos + mmw_tlv_find_magic(scan->buf + scan->pos, scan->len - scan->pos);
+        int ret;
+
+        scan->numSkipped += at - scan->pos;
+        scan->pos = at;
+        if(at == scan->len)
+        {
+            return 0;
+        }
+        ret = mmw_tlv_parse(scan->buf + at, scan->len - at, frame);
+        if(ret == MMW_TLV_OK)
+        {
+            scan->pos += frame->totalPacketLen;
+            return 1;
+        }
+        if(ret == MMW_TLV_NEED_MORE && !scan->complete)
+        {
+            return 0;
+        }
+        //a magic word cut off by the end is no bad packet
+        scan->numBad += scan->len - at >= MMW_TLV_MAGIC_LEN;
+        scan->numSkipped++;
+        scan->pos++;
+    }
+    return 0;
+}
+
+/* Parser of bytes that arrive in pieces, from a serial port or a socket */
+typedef struct
+{
+    uint8_t *pending;    //start of a packet that a piece ended in
+    size_t numPending;
+    uint64_t numSkipped;
+    uint32_t numBad;
+    uint64_t numFrames;
+} MmwTlvStream;
+
+typedef void (*MmwTlvFrameFn)(void *arg, const MmwTlvFrame *frame);
+
+/* This function starts a stream parser, it returns -1 when out of memory */
+static inline int mmw_tlv_stream_init(MmwTlvStream *stream)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->pending = malloc(MMW_TLV_MAX_PACKET_LEN);
+    return stream->pending != NULL ? 0 : -1;
+}
+
+/* This function frees a stream parser */
+static inline void mmw_tlv_stream_free(MmwTlvStream *stream)
+{
+    free(stream->pending);
+    stream->pending = NULL;
+}
+
+/* This function drops the first byte of what is pending and keeps what
+ * follows from the next magic word on
+ */
+static inline void mmw_tlv_stream_resync(MmwTlvStream *stream)
+{
+    size_t at = 1U + mmw_tlv_find_magic(stream->pending + 1U, stream->numPending - 1U);
+
+    //what started like one may not have been a whole magic word
+    stream->numBad += stream->numPending >= MMW_TLV_MAGIC_LEN &&
+                      mmw_tlv_find_magic(stream->pending, MMW_TLV_MAGIC_LEN) == 0U;
+    stream->numSkipped += at;
+    memmove(stream->pending, stream->pending + at, stream->numPending - at);
+    stream->numPending -= at;
+}
+
+/* This function takes the packets at the start of what is pending, and
+ * more of len - *pos bytes of data while the first one is not complete
+ */
+static inline void mmw_tlv_stream_pending(MmwTlvStream *stream, const uint8_t *data, size_t len, size_t *pos,
+                                          int complete, MmwTlvFrameFn onFrame, void *arg)
+{
+    MmwTlvFrame frame;
+
+    while(stream->numPending > 0U)
+    {
+        size_t want, take;
+        int ret = mmw_tlv_parse(stream->pending, stream->numPending, &frame);
+
+        if(ret == MMW_TLV_OK)
+        {
+            //only after a resync, a packet that was behind a bad one
+            stream->numFrames++;
+            onFrame(arg, &frame);
+            stream->numPending -= frame.totalPacketLen;
+            memmove(stream->pending, stream->pending + frame.totalPacketLen, stream->numPending);
+        }
+        else if(ret == MMW_TLV_BAD || (*pos == len && complete))
+        {
+            mmw_tlv_stream_resync(stream);
+        }
+        else if(*pos == len)
+        {
+            break;
+        }
+        else
+        {
+            want = stream->numPending < MMW_TLV_HEADER_LEN ? MMW_TLV_HEADER_LEN : frame.totalPacketLen;
+            take = want - stream->numPending;
+            take = take < len - *pos ? take : len - *pos;
+            memcpy(stream->pending + stream->numPending, data + *pos, take);
+            stream->numPending += take;
+            *pos += take;
+        }
+    }
+}
+
+/* This function takes the next piece of the stream and calls onFrame with
+ * every packet that is complete. The frame passed to onFrame points into
+ * data or into the stream and is only good until onFrame returns
+ */
+static inline void mmw_tlv_stream_feed(MmwTlvStream *stream, const uint8_t *data, size_t len,
+                                       MmwTlvFrameFn onFrame, void *arg)
+{
+    MmwTlvFrame frame;
+    MmwTlvScan scan;
+    size_t pos = 0;
+
+    //finish the packet the last piece ended in
+    mmw_tlv_stream_pending(stream, data, len, &pos, 0, onFrame, arg);
+    if(stream->numPending > 0U)
+    {
+        return;
+    }
+
+    //then take the packets of this piece where they are
+    mmw_tlv_scan_init(&scan, data + pos, len - pos, 0);
+    while(mmw_tlv_scan_next(&scan, &frame))
+    {
+        stream->numFrames++;
+        onFrame(arg, &frame);
+    }
+    stream->numSkipped += scan.numSkipped;
+    stream->numBad += scan.numBad;
+    memcpy(stream->pending, scan.buf + scan.pos, scan.len - scan.pos);
+    stream->numPending = scan.len - scan.pos;
+}
+
+/* This function is called at the end of the stream, what is pending then
+ * is skipped up to the packets that follow a bad one
+ */
+static inline void mmw_tlv_stream_finish(MmwTlvStream *stream, MmwTlvFrameFn onFrame, void *arg)
+{
+    size_t pos = 0;
+    mmw_tlv_stream_pending(stream, NULL, 0, &pos, 1, onFrame, arg);
+}
+
+/* ======================= Typed views ======================= */
+
+/* This function returns the TLV of a type, or NULL */
+static inline const MmwTlv *mmw_tlv_get(const MmwTlvFrame *frame, MmwTlvType type)
+{
+    return frame->byType[type];
+}
+
+/* This function returns the run of elem byte elements of a TLV, empty when
+ * the TLV is not there
+ */
+static inline MmwTlvArray mmw_tlv_array(const MmwTlvFrame *frame, MmwTlvType type, uint32_t elem)
+{
+    const MmwTlv *tlv = frame->byType[type];
+    MmwTlvArray arr = {NULL, 0};
+
+    if(tlv != NULL)
+    {
+        arr.data = tlv->payload;
+        arr.count = tlv->length / elem;
+    }
+    return arr;
+}
+
+/* This function returns the detected points */
+static inline MmwTlvArray mmw_tlv_points(const MmwTlvFrame *frame)
+{
+    return mmw_tlv_array(frame, MMW_TLV_DETECTED_POINTS, sizeof(MmwTlvPoint));
+}
+
+/* This function returns point i of the detected points */
+static inline MmwTlvPoint mmw_tlv_point_at(MmwTlvArray points, uint32_t i)
+{
+    MmwTlvPoint p;
+    memcpy(&p, points.data + i * sizeof(p), sizeof(p));
+    return p;
+}
+
+/* This function returns the side info of the detected points */
+static inline MmwTlvArray mmw_tlv_side_info(const MmwTlvFrame *frame)
+{
+    return mmw_tlv_array(frame, MMW_TLV_DETECTED_POINTS_SIDE_INFO, sizeof(MmwTlvSideInfo));
+}
+
+/* This function returns the side info of point i */
+static inline MmwTlvSideInfo mmw_tlv_side_info_at(MmwTlvArray sideInfo, uint32_t i)
+{
+    MmwTlvSideInfo s;
+    memcpy(&s, sideInfo.data + i * sizeof(s), sizeof(s));
+    return s;
+}
+
+/* This function returns a range or noise profile or the range/Doppler
+ * heatmap, as uint16_t bins
+ */
+static inline MmwTlvArray mmw_tlv_bins(const MmwTlvFrame *frame, MmwTlvType type)
+{
+    return mmw_tlv_array(frame, type, sizeof(uint16_t));
+}
+
+/* This function returns bin i */
+static inline uint16_t mmw_tlv_bin_at(MmwTlvArray bins, uint32_t i)
+{
+    return (uint16_t)(bins.data[2U * i] | (bins.data[2U * i + 1U] << 8));
+}
+
+/* This function copies the stats out and returns 1, or 0 when not there */
+static inline int mmw_tlv_stats(const MmwTlvFrame *frame, MmwTlvStats *stats)
+{
+    const MmwTlv *tlv = frame->byType[MMW_TLV_STATS];
+    if(tlv == NULL)
+    {
+        return 0;
+    }
+    memcpy(stats, tlv->payload, sizeof(*stats));
+    return 1;
+}
+
+/* This function copies the stage timing out and returns 1, or 0 when not there */
+static inline int mmw_tlv_stage_timing(const MmwTlvFrame *frame, MmwTlvStageTiming *timing)
+{
+    const MmwTlv *tlv = frame->byType[MMW_TLV_STAGE_TIMING];
+    if(tlv == NULL)
+    {
+        return 0;
+    }
+    memcpy(timing, tlv->payload, sizeof(*timing));
+    return 1;
+}
+
+/* This function returns the compressed points after their units */
+static inline MmwTlvArray mmw_tlv_compressed_points(const MmwTlvFrame *frame)
+{
+    const MmwTlv *tlv = frame->byType[MMW_TLV_COMPRESSED_POINTS];
+    MmwTlvArray arr = {NULL, 0};
+
+    if(tlv != NULL)
+    {
+        arr.data = tlv->payload + MMW_TLV_COMPRESSED_UNIT_LEN;
+        arr.count = (tlv->length - MMW_TLV_COMPRESSED_UNIT_LEN) / MMW_TLV_COMPRESSED_POINT_LEN;
+    }
+    return arr;
+}
+
+/* This function returns compressed point i in meters and m/s, and its snr
+ * and noise in dB when those are not NULL
+ */
+static inline MmwTlvPoint mmw_tlv_compressed_point_at(MmwTlvArray points, uint32_t i, float *snr, float *noise)
+{
+    const uint8_t *unit = points.data - MMW_TLV_COMPRESSED_UNIT_LEN;
+    const uint8_t *q = points.data + i * MMW_TLV_COMPRESSED_POINT_LEN;
+    float u[4];
+    int16_t v[4];
+    MmwTlvPoint p;
+
+    memcpy(u, unit, sizeof(u)); //xyz, velocity, snr, noise
+    memcpy(v, q, sizeof(v));
+    p.x = v[0] * u[0];
+    p.y = v[1] * u[0];
+    p.z = v[2] * u[0];
+    p.velocity = v[3] * u[1];
+    if(snr != NULL)
+    {
+        *snr = q[8] * u[2];
+    }
+    if(noise != NULL)
+    {
+        *noise = q[9] * u[3];
+    }
+    return p;
+}
+
+#endif /* MMW_TLV_H */
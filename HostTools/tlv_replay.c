@@ -0,0 +1,698 @@
+/*
+ * tlv_replay.c
+ *
+ * Host side checks and replay of the TLV parser of mmw_tlv.h, which takes
+ * the output packets of the board apart where they lie.
+ *
+ * Run without arguments it checks the parser on made up packets: every
+ * cut off prefix of a packet asks for more, and TLVs that run past their
+ * packet, do not match their type or leave too much padding are refused.
+ * It then writes a capture of packets with noise, false magic words,
+ * packets cut short and broken packets between them, checks the walk over
+ * the whole capture and the stream parser fed in pieces of 1 byte to a few
+ * KB both find just the good packets, and that the points, profiles and
+ * stats read back through the typed views are the ones that went in.
+ * Last it times the parser on a capture of typical frames and prints how
+ * many times the line rate of the UART and of 1 Gb Ethernet it keeps up
+ * with.
+ *
+ * "replay" feeds a capture of the UART or of udp_sink_test listen through
+ * the stream parser in pieces of the given size, repeat times, and prints
+ * the frames, the frames that are missing, the TLVs by type and how fast
+ * they were parsed.
+ *
+ * This runs on the PC, not on the board. Build with:
+ *     cc -O2 -Wall -I../ExampleProjects/out_of_box_2944_mss/include
+ *        -o tlv_replay tlv_replay.c
+ * and run as:
+ *     ./tlv_replay
+ *     ./tlv_replay replay capture.bin [pieceSize] [repeat]
+ * It exits with 1 if a check fails or the file cannot be used.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "mmw_tlv.h"
+
+#define TEST_MAX_PACKET (16U * 1024U)
+#define TEST_NUM_PACKETS (600U)
+#define TEST_CAPTURE_SIZE (TEST_NUM_PACKETS * (TEST_MAX_PACKET + 256U))
+
+#define BENCH_NUM_OBJ (64U)
+#define BENCH_RANGE_BINS (256U)
+#define BENCH_CAPTURE_SIZE (64U * 1024U * 1024U)
+#define BENCH_PIECE_SIZE (4096U)
+#define BENCH_ROUNDS (4U)
+
+//bytes per second on the line, the UART sends 10 bits to a byte
+#define UART_BYTES_PER_S (3125000.0 / 10.0)
+#define GBE_BYTES_PER_S (1e9 / 8.0)
+
+static int gFailed = 0;
+static uint32_t gSeed = 1U;
+
+static const uint8_t gMagic[8] = {0x02, 0x01, 0x04, 0x03, 0x06, 0x05, 0x08, 0x07};
+
+/* How a made up packet is broken */
+typedef enum
+{
+    PACKET_GOOD,
+    PACKET_CUT,       //ends early, the next packet follows
+    PACKET_BAD_TLV,   //points TLV does not match numDetectedObj
+    PACKET_BAD_COUNT, //more TLVs than the packet holds
+    PACKET_KINDS
+} PacketKind;
+
+/* Frames the parser gave back, checked against what was written */
+typedef struct
+{
+    uint32_t *frames;
+    uint32_t numFrames;
+    uint32_t maxFrames;
+    uint32_t numViewErrors;
+} FrameList;
+
+/* Totals of a replay */
+typedef struct
+{
+    uint64_t numFrames;
+    uint64_t numMissing;
+    uint64_t numPoints;
+    uint64_t numTlvs[MMW_TLV_TYPE_MAX + 1U]; //the last one counts unknown types
+    uint32_t lastFrame;
+    int haveFrame;
+} ReplayTotals;
+
+/* This function records one check
+ */
+static void check(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAILED: %s\n", what);
+        gFailed = 1;
+    }
+}
+
+/* This function returns a pseudo random 32 bit value
+ */
+static uint32_t test_rand(void)
+{
+    gSeed = gSeed * 1664525U + 1013904223U;
+    return gSeed;
+}
+
+/* This function returns seconds from a monotonic clock
+ */
+static double test_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* This function writes a little endian word
+ */
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/* This function appends the type and length of a TLV and returns where its
+ * payload goes
+ */
+static uint8_t *put_tlv(uint8_t *buf, uint32_t *pos, uint32_t type, uint32_t length)
+{
+    put_le32(&buf[*pos], type);
+    put_le32(&buf[*pos + 4U], length);
+    *pos += MMW_TLV_TL_LEN + length;
+    return &buf[*pos - length];
+}
+
+/* These functions give the values a made up frame carries, so the typed
+ * views can be checked against the frame number alone
+ */
+static MmwTlvPoint test_point(uint32_t frame, uint32_t i)
+{
+    MmwTlvPoint p;
+    p.x = (float)(frame % 100U) * 0.5F + (float)i;
+    p.y = -(float)i * 0.25F;
+    p.z = (float)(frame & 7U);
+    p.velocity = (float)i - 8.0F;
+    return p;
+}
+
+static uint16_t test_bin(uint32_t frame, uint32_t bin)
+{
+    return (uint16_t)(frame * 31U + bin * 7U);
+}
+
+/* This function writes a packet the way the MSS does: header, detected
+ * points, side info, range profile, stats, stage timing, compressed points
+ * and padding to a whole segment. It returns the length of the packet
+ */
+static uint32_t test_make_packet(uint8_t *buf, uint32_t frame, uint32_t numObj, uint32_t numRangeBins)
+{
+    uint32_t pos = MMW_TLV_HEADER_LEN;
+    uint32_t i;
+    uint8_t *p;
+
+    memcpy(buf, gMagic, sizeof(gMagic));
+    put_le32(&buf[8], 0x03060000U);
+    put_le32(&buf[16], 0xA2944U);
+    put_le32(&buf[20], frame);
+    put_le32(&buf[24], frame * 1000U);
+    put_le32(&buf[28], numObj);
+    put_le32(&buf[32], 7U);
+    put_le32(&buf[36], 0U);
+
+    p = put_tlv(buf, &pos, MMW_TLV_DETECTED_POINTS, numObj * (uint32_t)sizeof(MmwTlvPoint));
+    for(i = 0; i < numObj; i++)
+    {
+        MmwTlvPoint pt = test_point(frame, i);
+        memcpy(&p[i * sizeof(pt)], &pt, sizeof(pt));
+    }
+    p = put_tlv(buf, &pos, MMW_TLV_DETECTED_POINTS_SIDE_INFO, numObj * (uint32_t)sizeof(MmwTlvSideInfo));
+    for(i = 0; i < numObj; i++)
+    {
+        MmwTlvSideInfo s = {(int16_t)(100 + i), (int16_t)(frame & 0xFFU)};
+        memcpy(&p[i * sizeof(s)], &s, sizeof(s));
+    }
+    p = put_tlv(buf, &pos, MMW_TLV_RANGE_PROFILE, numRangeBins * 2U);
+    for(i = 0; i < numRangeBins; i++)
+    {
+        uint16_t v = test_bin(frame, i);
+        p[2U * i] = (uint8_t)v;
+        p[2U * i + 1U] = (uint8_t)(v >> 8);
+    }
+    p = put_tlv(buf, &pos, MMW_TLV_STATS, (uint32_t)sizeof(MmwTlvStats));
+    for(i = 0; i < sizeof(MmwTlvStats) / 4U; i++)
+    {
+        put_le32(&p[4U * i], frame + i);
+    }
+    p = put_tlv(buf, &pos, MMW_TLV_STAGE_TIMING, (uint32_t)sizeof(MmwTlvStageTiming));
+    for(i = 0; i < sizeof(MmwTlvStageTiming) / 4U; i++)
+    {
+        put_le32(&p[4U * i], frame ^ i);
+    }
+    //an unknown type, a later firmware may send it
+    p = put_tlv(buf, &pos, 0x100U, 6U);
+    memset(p, 0x02, 6U);
+    p = put_tlv(buf, &pos, MMW_TLV_COMPRESSED_POINTS, MMW_TLV_COMPRESSED_UNIT_LEN + numObj * MMW_TLV_COMPRESSED_POINT_LEN);
+    {
+        float unit[4] = {0.25F, 0.125F, 0.5F, 1.0F};
+        memcpy(p, unit, sizeof(unit));
+        p += MMW_TLV_COMPRESSED_UNIT_LEN;
+        for(i = 0; i < numObj; i++)
+        {
+            MmwTlvPoint pt = test_point(frame, i);
+            int16_t q[4] = {(int16_t)(pt.x * 4.0F), (int16_t)(pt.y * 4.0F), (int16_t)(pt.z * 4.0F),
+                            (int16_t)(pt.velocity * 8.0F)};
+            memcpy(&p[i * MMW_TLV_COMPRESSED_POINT_LEN], q, sizeof(q));
+            p[i * MMW_TLV_COMPRESSED_POINT_LEN + 8U] = (uint8_t)i;
+            p[i * MMW_TLV_COMPRESSED_POINT_LEN + 9U] = (uint8_t)(frame & 0x3FU);
+        }
+    }
+
+    i = MMW_TLV_SEGMENT_LEN - (pos & (MMW_TLV_SEGMENT_LEN - 1U));
+    if(i < MMW_TLV_SEGMENT_LEN)
+    {
+        memset(&buf[pos], 0x0F, i);
+        pos += i;
+    }
+    put_le32(&buf[12], pos);
+    return pos;
+}
+
+/* This function checks what the typed views read out of a frame against
+ * the values test_make_packet put in, and returns the number of mismatches
+ */
+static uint32_t test_check_views(const MmwTlvFrame *frame)
+{
+    MmwTlvArray points = mmw_tlv_points(frame);
+    MmwTlvArray side = mmw_tlv_side_info(frame);
+    MmwTlvArray profile = mmw_tlv_bins(frame, MMW_TLV_RANGE_PROFILE);
+    MmwTlvArray compressed = mmw_tlv_compressed_points(frame);
+    MmwTlvStats stats;
+    MmwTlvStageTiming timing;
+    uint32_t f = frame->frameNumber;
+    uint32_t errors = 0, i;
+
+    errors += points.count != frame->numDetectedObj || side.count != points.count || compressed.count != points.count;
+    errors += frame->numTLVs != 7U || mmw_tlv_get(frame, MMW_TLV_NOISE_PROFILE) != NULL;
+    for(i = 0; i < points.count && i < side.count && i < compressed.count; i++)
+    {
+        MmwTlvPoint want = test_point(f, i);
+        MmwTlvPoint got = mmw_tlv_point_at(points, i);
+        MmwTlvSideInfo s = mmw_tlv_side_info_at(side, i);
+        float snr, noise;
+        MmwTlvPoint c = mmw_tlv_compressed_point_at(compressed, i, &snr, &noise);
+
+        errors += memcmp(&want, &got, sizeof(want)) != 0;
+        errors += s.snr != (int16_t)(100 + i) || s.noise != (int16_t)(f & 0xFFU);
+        //within a unit of the quantization, rounding toward 0
+        errors += c.x > want.x + 0.25F || c.x < want.x - 0.25F || c.velocity > want.velocity + 0.125F ||
+                  c.velocity < want.velocity - 0.125F;
+        errors += snr != (float)i * 0.5F || noise != (float)(f & 0x3FU);
+    }
+    for(i = 0; i < profile.count; i++)
+    {
+        errors += mmw_tlv_bin_at(profile, i) != test_bin(f, i);
+    }
+    errors += !mmw_tlv_stats(frame, &stats) || stats.interFrameProcessingTime != f || stats.interFrameCPULoad != f + 5U;
+    errors += !mmw_tlv_stage_timing(frame, &timing) || timing.windowIndex != f ||
+              timing.stage[MMW_TLV_NUM_STAGES - 1U].maxCycles != (f ^ 27U) || timing.numSlotBusy != (f ^ 29U);
+    return errors;
+}
+
+/* This function checks a single packet: whole, every cut off prefix, and
+ * broken in each way the parser has to refuse
+ */
+static void test_parse(void)
+{
+    static uint8_t buf[TEST_MAX_PACKET];
+    static uint8_t bad[TEST_MAX_PACKET];
+    MmwTlvFrame frame;
+    uint32_t len, cut, pointsLenPos;
+    int needMore = 1;
+
+    len = test_make_packet(buf, 77U, 5U, 16U);
+    check((len % MMW_TLV_SEGMENT_LEN) == 0U, "packet padded to a whole segment");
+    check(mmw_tlv_parse(buf, len, &frame) == MMW_TLV_OK, "whole packet parses");
+    check(frame.totalPacketLen == len && frame.frameNumber == 77U && frame.numDetectedObj == 5U, "header read");
+    check(test_check_views(&frame) == 0U, "views of a single packet");
+    check(mmw_tlv_parse(buf, len + 100U, &frame) == MMW_TLV_OK, "bytes after a packet are not its business");
+
+    for(cut = 1; cut < len; cut++)
+    {
+        needMore &= mmw_tlv_parse(buf, cut, &frame) == MMW_TLV_NEED_MORE;
+    }
+    check(needMore, "every prefix asks for more");
+    check(mmw_tlv_parse(buf + 1, len - 1U, &frame) == MMW_TLV_BAD, "packet not at the start is refused");
+
+    pointsLenPos = MMW_TLV_HEADER_LEN + 4U;
+    memcpy(bad, buf, len);
+    put_le32(&bad[pointsLenPos], 6U * (uint32_t)sizeof(MmwTlvPoint));
+    check(mmw_tlv_parse(bad, len, &frame) == MMW_TLV_BAD, "points that do not match numDetectedObj");
+
+    memcpy(bad, buf, len);
+    put_le32(&bad[pointsLenPos], len);
+    check(mmw_tlv_parse(bad, len, &frame) == MMW_TLV_BAD, "TLV running past the packet");
+
+    memcpy(bad, buf, len);
+    put_le32(&bad[32], 8U);
+    check(mmw_tlv_parse(bad, len, &frame) == MMW_TLV_BAD, "more TLVs than there are");
+
+    memcpy(bad, buf, len);
+    put_le32(&bad[32], 6U);
+    check(mmw_tlv_parse(bad, len, &frame) == MMW_TLV_BAD, "more padding than a segment");
+
+    memcpy(bad, buf, len);
+    put_le32(&bad[32], MMW_TLV_MAX_TLVS + 1U);
+    check(mmw_tlv_parse(bad, len, &frame) == MMW_TLV_BAD, "numTLVs out of range");
+
+    memcpy(bad, buf, len);
+    put_le32(&bad[12], MMW_TLV_MAX_PACKET_LEN + 32U);
+    check(mmw_tlv_parse(bad, len, &frame) == MMW_TLV_BAD, "totalPacketLen out of range, not more to come");
+
+    memcpy(bad, buf, len);
+    put_le32(&bad[12], 8U);
+    check(mmw_tlv_parse(bad, len, &frame) == MMW_TLV_BAD, "totalPacketLen shorter than the header");
+
+    len = test_make_packet(buf, 78U, 0U, 0U);
+    check(mmw_tlv_parse(buf, len, &frame) == MMW_TLV_OK && mmw_tlv_points(&frame).count == 0U,
+          "packet without points");
+}
+
+/* This function writes a capture of packets with everything a serial
+ * line or a lost datagram can leave between them, and the frame numbers
+ * of the good packets to expected. It returns the size of the capture
+ */
+static size_t test_make_capture(uint8_t *cap, uint32_t *expected, uint32_t *numExpected)
+{
+    static uint8_t packet[TEST_MAX_PACKET];
+    size_t pos = 0;
+    uint32_t frame, i;
+
+    *numExpected = 0;
+    for(frame = 0; frame < TEST_NUM_PACKETS; frame++)
+    {
+        PacketKind kind = (test_rand() >> 8) % 8U < 5U ? PACKET_GOOD : (PacketKind)((test_rand() >> 8) % PACKET_KINDS);
+        uint32_t len = test_make_packet(packet, frame, (test_rand() >> 8) % 200U, (test_rand() >> 8) % 512U);
+        uint32_t junk = (test_rand() >> 8) % 4U;
+
+        //noise, with a false or a partial magic word now and then
+        if(junk != 0U)
+        {
+            uint32_t n = (test_rand() >> 8) % 80U;
+            for(i = 0; i < n; i++)
+            {
+                cap[pos++] = (test_rand() >> 8) % 4U == 0U ? 0x02U : (uint8_t)(test_rand() >> 16);
+            }
+            if(junk == 2U)
+            {
+                memcpy(&cap[pos], gMagic, sizeof(gMagic));
+                pos += sizeof(gMagic);
+                for(i = 0; i < 40U; i++)
+                {
+                    cap[pos++] = (uint8_t)(test_rand() >> 16);
+                }
+            }
+            else if(junk == 3U)
+            {
+                i = 1U + (test_rand() >> 8) % 7U;
+                memcpy(&cap[pos], gMagic, i);
+                pos += i;
+            }
+        }
+
+        switch(kind)
+        {
+            case PACKET_GOOD:
+                expected[(*numExpected)++] = frame;
+                break;
+            case PACKET_CUT:
+                //inside the header or the first TLV, the ones after it do not then line up
+                len = 8U + (test_rand() >> 8) % (MMW_TLV_HEADER_LEN + MMW_TLV_TL_LEN);
+                break;
+            case PACKET_BAD_TLV:
+                put_le32(&packet[MMW_TLV_HEADER_LEN + 4U], mmw_tlv_le32(&packet[MMW_TLV_HEADER_LEN + 4U]) + 16U);
+                break;
+            default:
+                put_le32(&packet[32], 12U);
+                break;
+        }
+        memcpy(&cap[pos], packet, len);
+        pos += len;
+    }
+    //and one cut off by the end of the capture
+    memcpy(&cap[pos], packet, 100U);
+    return pos + 100U;
+}
+
+/* This function collects the frames of the stream parser
+ */
+static void test_on_frame(void *arg, const MmwTlvFrame *frame)
+{
+    FrameList *list = (FrameList *)arg;
+
+    if(list->numFrames < list->maxFrames)
+    {
+        list->frames[list->numFrames] = frame->frameNumber;
+    }
+    list->numFrames++;
+    list->numViewErrors += test_check_views(frame);
+}
+
+/* This function checks the walk over a whole capture and the stream
+ * parser fed in pieces find the same good packets
+ */
+static void test_capture(void)
+{
+    static uint32_t expected[TEST_NUM_PACKETS];
+    static uint32_t found[TEST_NUM_PACKETS];
+    static uint32_t streamed[TEST_NUM_PACKETS];
+    uint8_t *cap = malloc(TEST_CAPTURE_SIZE);
+    uint32_t numExpected, numFound = 0, viewErrors = 0, round;
+    MmwTlvFrame frame;
+    MmwTlvScan scan;
+    size_t size;
+
+    if(cap == NULL)
+    {
+        check(0, "memory for the capture");
+        return;
+    }
+    size = test_make_capture(cap, expected, &numExpected);
+
+    mmw_tlv_scan_init(&scan, cap, size, 1);
+    while(mmw_tlv_scan_next(&scan, &frame))
+    {
+        if(numFound < TEST_NUM_PACKETS)
+        {
+            found[numFound] = frame.frameNumber;
+        }
+        numFound++;
+        viewErrors += test_check_views(&frame);
+    }
+    check(numFound == numExpected && memcmp(found, expected, numExpected * sizeof(uint32_t)) == 0,
+          "walk finds just the good packets");
+    check(viewErrors == 0U, "views of the walk");
+    check(scan.pos == size && scan.numBad > 0U, "walk reaches the end over the broken packets");
+
+    //one byte at a time, pieces that cut every header, socket sized pieces
+    for(round = 0; round < 4U; round++)
+    {
+        static const uint32_t maxPiece[4] = {1U, 13U, 1500U, 16384U};
+        FrameList list = {streamed, 0, TEST_NUM_PACKETS, 0};
+        MmwTlvStream stream;
+        size_t pos = 0;
+
+        if(mmw_tlv_stream_init(&stream) != 0)
+        {
+            check(0, "memory for the stream");
+            break;
+        }
+        while(pos < size)
+        {
+            size_t n = 1U + (test_rand() >> 8) % maxPiece[round];
+            n = n < size - pos ? n : size - pos;
+            mmw_tlv_stream_feed(&stream, cap + pos, n, test_on_frame, &list);
+            pos += n;
+        }
+        mmw_tlv_stream_finish(&stream, test_on_frame, &list);
+        check(list.numFrames == numExpected && memcmp(streamed, expected, numExpected * sizeof(uint32_t)) == 0,
+              "stream finds just the good packets");
+        check(list.numViewErrors == 0U, "views of the stream");
+        check(stream.numSkipped == scan.numSkipped && stream.numBad == scan.numBad && stream.numPending == 0U,
+              "stream skips what the walk skips");
+        mmw_tlv_stream_free(&stream);
+    }
+    printf("capture: %zu bytes, %u good packets, %u bad magic words, %llu bytes skipped\n", size, numExpected,
+           scan.numBad, (unsigned long long)scan.numSkipped);
+    free(cap);
+}
+
+/* This function counts the frames of a stream, for the timing
+ */
+static void bench_on_frame(void *arg, const MmwTlvFrame *frame)
+{
+    *(uint64_t *)arg += mmw_tlv_points(frame).count;
+}
+
+/* This function prints a rate against the line rates
+ */
+static void bench_print(const char *what, double frames, double bytes, double seconds)
+{
+    printf("%s: %.0f frames/s, %.0f MB/s, %.0fx the UART, %.1fx 1 Gb Ethernet\n", what, frames / seconds,
+           bytes / seconds / 1e6, bytes / seconds / UART_BYTES_PER_S, bytes / seconds / GBE_BYTES_PER_S);
+}
+
+/* This function times the walk and the stream parser on a capture of
+ * typical frames
+ */
+static void bench(void)
+{
+    uint8_t *cap = malloc(BENCH_CAPTURE_SIZE);
+    uint64_t numPoints = 0;
+    uint32_t numFrames = 0, round;
+    MmwTlvFrame frame;
+    MmwTlvScan scan;
+    MmwTlvStream stream;
+    size_t size = 0, pos;
+    double t0, seconds;
+
+    if(cap == NULL || mmw_tlv_stream_init(&stream) != 0)
+    {
+        check(0, "memory for the timing");
+        free(cap);
+        return;
+    }
+    while(size + TEST_MAX_PACKET <= BENCH_CAPTURE_SIZE)
+    {
+        size += test_make_packet(cap + size, numFrames++, BENCH_NUM_OBJ, BENCH_RANGE_BINS);
+    }
+
+    t0 = test_now();
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        mmw_tlv_scan_init(&scan, cap, size, 1);
+        while(mmw_tlv_scan_next(&scan, &frame))
+        {
+            numPoints += mmw_tlv_points(&frame).count;
+        }
+    }
+    seconds = test_now() - t0;
+    bench_print("walk", (double)numFrames * BENCH_ROUNDS, (double)size * BENCH_ROUNDS, seconds);
+
+    t0 = test_now();
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for(pos = 0; pos < size; pos += BENCH_PIECE_SIZE)
+        {
+            mmw_tlv_stream_feed(&stream, cap + pos, size - pos < BENCH_PIECE_SIZE ? size - pos : BENCH_PIECE_SIZE,
+                                bench_on_frame, &numPoints);
+        }
+    }
+    seconds = test_now() - t0;
+    bench_print("stream", (double)numFrames * BENCH_ROUNDS, (double)size * BENCH_ROUNDS, seconds);
+
+    check(stream.numFrames == (uint64_t)numFrames * BENCH_ROUNDS &&
+          numPoints == 2U * stream.numFrames * BENCH_NUM_OBJ, "timing saw every frame");
+    check((double)size * BENCH_ROUNDS / seconds > UART_BYTES_PER_S, "stream keeps up with the UART");
+    mmw_tlv_stream_free(&stream);
+    free(cap);
+}
+
+/* This function reads a whole file, or returns NULL
+ */
+static void *replay_read_file(const char *path, size_t *size)
+{
+    FILE *fp = fopen(path, "rb");
+    void *data = NULL;
+    long len;
+
+    if(fp == NULL)
+    {
+        return NULL;
+    }
+    if(fseek(fp, 0, SEEK_END) == 0 && (len = ftell(fp)) > 0 && fseek(fp, 0, SEEK_SET) == 0)
+    {
+        data = malloc((size_t)len);
+        if(data != NULL && fread(data, 1, (size_t)len, fp) != (size_t)len)
+        {
+            free(data);
+            data = NULL;
+        }
+        *size = (size_t)len;
+    }
+    fclose(fp);
+    return data;
+}
+
+/* This function adds up one frame of a replay
+ */
+static void replay_on_frame(void *arg, const MmwTlvFrame *frame)
+{
+    ReplayTotals *totals = (ReplayTotals *)arg;
+    uint32_t i;
+
+    //sub-frames share a frame number, a gap of more than one is lost frames
+    if(totals->haveFrame && frame->frameNumber > totals->lastFrame + 1U)
+    {
+        totals->numMissing += frame->frameNumber - totals->lastFrame - 1U;
+    }
+    totals->lastFrame = frame->frameNumber;
+    totals->haveFrame = 1;
+    totals->numFrames++;
+    totals->numPoints += frame->numDetectedObj;
+    for(i = 0; i < frame->numTLVs; i++)
+    {
+        uint32_t type = frame->tlv[i].type;
+        totals->numTlvs[type < MMW_TLV_TYPE_MAX ? type : MMW_TLV_TYPE_MAX]++;
+    }
+}
+
+/* This function replays a capture through the stream parser
+ */
+static int run_replay(const char *path, uint32_t pieceSize, uint32_t repeat)
+{
+    ReplayTotals totals;
+    MmwTlvStream stream;
+    uint64_t numSkipped = 0, numBad = 0;
+    uint8_t *cap;
+    size_t size = 0, pos;
+    uint32_t round, type;
+    double t0, seconds;
+
+    cap = replay_read_file(path, &size);
+    if(cap == NULL)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    memset(&totals, 0, sizeof(totals));
+
+    t0 = test_now();
+    for(round = 0; round < repeat; round++)
+    {
+        if(mmw_tlv_stream_init(&stream) != 0)
+        {
+            fprintf(stderr, "out of memory\n");
+            free(cap);
+            return 1;
+        }
+        totals.haveFrame = 0;
+        for(pos = 0; pos < size; pos += pieceSize)
+        {
+            mmw_tlv_stream_feed(&stream, cap + pos, size - pos < pieceSize ? size - pos : pieceSize,
+                                replay_on_frame, &totals);
+        }
+        mmw_tlv_stream_finish(&stream, replay_on_frame, &totals);
+        numSkipped += stream.numSkipped;
+        numBad += stream.numBad;
+        mmw_tlv_stream_free(&stream);
+    }
+    seconds = test_now() - t0;
+
+    printf("%llu frames, %llu missing, %.1f points a frame, %llu bytes skipped, %llu bad magic words\n",
+           (unsigned long long)(totals.numFrames / repeat), (unsigned long long)(totals.numMissing / repeat),
+           totals.numFrames ? (double)totals.numPoints / totals.numFrames : 0.0,
+           (unsigned long long)(numSkipped / repeat), (unsigned long long)(numBad / repeat));
+    for(type = 1; type <= MMW_TLV_TYPE_MAX; type++)
+    {
+        if(totals.numTlvs[type] != 0U)
+        {
+            if(type < MMW_TLV_TYPE_MAX)
+            {
+                printf("  type %2u: %llu\n", type, (unsigned long long)(totals.numTlvs[type] / repeat));
+            }
+            else
+            {
+                printf("  unknown: %llu\n", (unsigned long long)(totals.numTlvs[type] / repeat));
+            }
+        }
+    }
+    bench_print("replay", (double)totals.numFrames, (double)size * repeat, seconds);
+    free(cap);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc >= 3 && argc <= 5 && strcmp(argv[1], "replay") == 0)
+    {
+        uint32_t pieceSize = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : BENCH_PIECE_SIZE;
+        uint32_t repeat = argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 0) : 1U;
+
+        if(pieceSize == 0U || repeat == 0U)
+        {
+            fprintf(stderr, "pieceSize and repeat must be at least 1\n");
+            return 1;
+        }
+        return run_replay(argv[2], pieceSize, repeat);
+    }
+    if(argc != 1)
+    {
+        fprintf(stderr, "usage: %s [replay capture.bin [pieceSize] [repeat]]\n", argv[0]);
+        return 1;
+    }
+
+    test_parse();
+    test_capture();
+    bench();
+    if(gFailed)
+    {
+        printf("checks FAILED\n");
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,468 @@
+/*
+ * udp_sink_test.c
+ *
+ * Host side of the UDP output sink: checks the datagram batching of
+ * mmw_udp_batch.h and receives the output of the board.
+ *
+ * Run without arguments it writes made up output packets, from a few
+ * bytes to a full heatmap, into the same datagram ring the MSS uses, and
+ * checks the packets come out of the reader as they went in: straight
+ * from the ring, with datagrams lost on the way, and through a UDP socket
+ * on the loopback interface with one to several frames to a batch. It
+ * also checks a full ring drops whole packets, and duplicated datagrams
+ * and a board restart are neither counted lost nor hand a packet back twice.
+ *
+ * "listen" takes the datagrams of the board on a port and writes the
+ * packets, as the UART would have sent them, to a file that heatmap_dec
+ * decode can read. It stops after the given number of packets, or never
+ * when that is 0.
+ *
+ * This runs on the PC, not on the board. Build with:
+ *     cc -O2 -Wall -I../ExampleProjects/out_of_box_2944_mss/include
+ *        -o udp_sink_test udp_sink_test.c
+ * and run as:
+ *     ./udp_sink_test
+ *     ./udp_sink_test listen <port> <numPackets> packets.bin
+ * It exits with 1 if a check fails or the socket or file cannot be used.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "mmw_udp_batch.h"
+
+#define TEST_NUM_DGRAMS (64U) //as in the MSS
+#define TEST_MAX_PACKET (64U * 1024U)
+#define TEST_NUM_PACKETS (400U)
+#define TEST_HEADER_LEN (40U)
+#define TEST_SEGMENT_LEN (32U)
+
+static int gFailed = 0;
+static uint32_t gSeed = 1U;
+
+static MmwDemo_udpDgram gRing[TEST_NUM_DGRAMS];
+static uint8_t gPacket[TEST_MAX_PACKET];
+static uint8_t gReasmBuf[TEST_MAX_PACKET];
+
+/* Packets the reader gave back, checked against what was written */
+typedef struct
+{
+    uint32_t numPackets;
+    uint32_t numBad;
+    uint32_t lastFrame;
+} RecvCheck;
+
+/* This function records one check
+ */
+static void check(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAILED: %s\n", what);
+        gFailed = 1;
+    }
+}
+
+/* This function returns a pseudo random 32 bit value
+ */
+static uint32_t test_rand(void)
+{
+    gSeed = gSeed * 1664525U + 1013904223U;
+    return gSeed;
+}
+
+/* This function writes a little endian word
+ */
+static void test_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/* This function reads a little endian word
+ */
+static uint32_t test_get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* This function makes the output packet of a frame, mostly small ones
+ * with now and then a heatmap. The bytes after the header follow from
+ * the frame number, so the reader can check them
+ */
+static uint32_t test_make_packet(uint8_t *packet, uint32_t frame)
+{
+    uint32_t len, i;
+
+    len = (test_rand() % 8U == 0U) ? (TEST_MAX_PACKET - 1024U - (test_rand() % 4096U))
+                                   : (TEST_HEADER_LEN + (test_rand() % 3000U));
+    len = (len + TEST_SEGMENT_LEN - 1U) & ~(TEST_SEGMENT_LEN - 1U);
+
+    memset(packet, 0, TEST_HEADER_LEN);
+    packet[0] = 0x02; packet[1] = 0x01; packet[2] = 0x04; packet[3] = 0x03;
+    packet[4] = 0x06; packet[5] = 0x05; packet[6] = 0x08; packet[7] = 0x07;
+    test_put32(&packet[12], len);
+    test_put32(&packet[20], frame);
+    for(i = TEST_HEADER_LEN; i < len; i++)
+    {
+        packet[i] = (uint8_t)(frame * 31U + i);
+    }
+    return len;
+}
+
+/* This function checks a packet that came out of the reader
+ */
+static void test_on_packet(void *arg, const uint8_t *packet, uint32_t len)
+{
+    RecvCheck *rc = (RecvCheck *)arg;
+    uint32_t frame = test_get32(&packet[20]);
+    uint32_t i;
+    int ok = test_get32(&packet[12]) == len && (rc->numPackets == 0U || frame > rc->lastFrame);
+
+    for(i = TEST_HEADER_LEN; ok && i < len; i++)
+    {
+        ok = packet[i] == (uint8_t)(frame * 31U + i);
+    }
+    rc->numBad += !ok;
+    rc->lastFrame = frame;
+    rc->numPackets++;
+}
+
+/* This function writes one packet as the MSS would, in a few segments
+ */
+static int32_t test_write(MmwDemo_udpBatch *batch, const uint8_t *packet, uint32_t len)
+{
+    const uint8_t *segBuf[3];
+    uint32_t segLen[3];
+
+    segBuf[0] = packet;
+    segLen[0] = TEST_HEADER_LEN;
+    segBuf[1] = packet + TEST_HEADER_LEN;
+    segLen[1] = (len - TEST_HEADER_LEN) / 2U;
+    segBuf[2] = segBuf[1] + segLen[1];
+    segLen[2] = len - TEST_HEADER_LEN - segLen[1];
+    return MmwDemo_udpBatchWrite(batch, segBuf, segLen, 3U, len);
+}
+
+/* This function passes packets through the ring straight into the reader,
+ * losing every lossEvery-th datagram when that is not 0
+ */
+static void test_ring(uint32_t framesPerBatch, uint32_t lossEvery, const char *what)
+{
+    MmwDemo_udpBatch batch;
+    MmwDemo_udpReasm reasm;
+    RecvCheck rc = {0};
+    const MmwDemo_udpDgram *dgram;
+    uint32_t frame, numWritten = 0, numDgrams = 0;
+    char msg[128];
+
+    MmwDemo_udpBatchInit(&batch, gRing, TEST_NUM_DGRAMS);
+    memset(&reasm, 0, sizeof(reasm));
+    reasm.packet = gReasmBuf;
+    reasm.packetSize = sizeof(gReasmBuf);
+    gSeed = 7U;
+
+    for(frame = 1; frame <= TEST_NUM_PACKETS; frame++)
+    {
+        uint32_t len = test_make_packet(gPacket, frame);
+        numWritten += test_write(&batch, gPacket, len) == 0;
+        if(frame % framesPerBatch == 0U || frame == TEST_NUM_PACKETS)
+        {
+            MmwDemo_udpBatchFlush(&batch);
+        }
+        while((dgram = MmwDemo_udpBatchNext(&batch)) != NULL)
+        {
+            numDgrams++;
+            if(lossEvery == 0U || numDgrams % lossEvery != 0U)
+            {
+                check(MmwDemo_udpReasmFeed(&reasm, (const uint8_t *)dgram,
+                                           (uint32_t)sizeof(dgram->hdr) + dgram->hdr.length,
+                                           test_on_packet, &rc) == 0, "datagram is taken");
+            }
+            MmwDemo_udpBatchRelease(&batch);
+        }
+    }
+
+    snprintf(msg, sizeof(msg), "%s: packets come back intact", what);
+    check(rc.numBad == 0U, msg);
+    snprintf(msg, sizeof(msg), "%s: no packet is dropped by the writer", what);
+    check(numWritten == TEST_NUM_PACKETS && batch.numDropped == 0U, msg);
+    if(lossEvery == 0U)
+    {
+        snprintf(msg, sizeof(msg), "%s: every packet comes back", what);
+        check(rc.numPackets == TEST_NUM_PACKETS && reasm.numLost == 0U, msg);
+    }
+    else
+    {
+        snprintf(msg, sizeof(msg), "%s: lost datagrams are counted", what);
+        //a loss at the very end is never noticed
+        check(reasm.numLost == (numDgrams - 1U) / lossEvery, msg);
+        snprintf(msg, sizeof(msg), "%s: packets after a loss come back", what);
+        check(rc.numPackets > TEST_NUM_PACKETS / 4U, msg);
+        //numDropped is a lower bound, packets wholly in lost datagrams are not seen
+        snprintf(msg, sizeof(msg), "%s: dropped packets are not overcounted", what);
+        check(rc.numPackets + reasm.numDropped <= numWritten, msg);
+    }
+    printf("%-28s %3u packets in %5u datagrams, %3u back, %2u lost, %3u dropped\n",
+           what, numWritten, numDgrams, rc.numPackets, reasm.numLost, reasm.numDropped);
+}
+
+/* This function feeds every datagram of a stream twice, and part of the
+ * way through starts the stream again from seq 0 as a board restart does.
+ * Neither may count as lost and every packet has to come back once
+ */
+static void test_stale(void)
+{
+    MmwDemo_udpBatch batch;
+    MmwDemo_udpReasm reasm;
+    RecvCheck rc = {0};
+    const MmwDemo_udpDgram *dgram;
+    uint32_t frame, numWritten = 0, numFed = 0;
+
+    MmwDemo_udpBatchInit(&batch, gRing, TEST_NUM_DGRAMS);
+    memset(&reasm, 0, sizeof(reasm));
+    reasm.packet = gReasmBuf;
+    reasm.packetSize = sizeof(gReasmBuf);
+    gSeed = 13U;
+
+    for(frame = 1; frame <= TEST_NUM_PACKETS; frame++)
+    {
+        uint32_t len = test_make_packet(gPacket, frame);
+        if(frame == TEST_NUM_PACKETS / 2U)
+        {
+            MmwDemo_udpBatchInit(&batch, gRing, TEST_NUM_DGRAMS);
+        }
+        numWritten += test_write(&batch, gPacket, len) == 0;
+        MmwDemo_udpBatchFlush(&batch);
+        while((dgram = MmwDemo_udpBatchNext(&batch)) != NULL)
+        {
+            MmwDemo_udpReasmFeed(&reasm, (const uint8_t *)dgram, (uint32_t)sizeof(dgram->hdr) + dgram->hdr.length,
+                                 test_on_packet, &rc);
+            MmwDemo_udpReasmFeed(&reasm, (const uint8_t *)dgram, (uint32_t)sizeof(dgram->hdr) + dgram->hdr.length,
+                                 test_on_packet, &rc);
+            numFed++;
+            MmwDemo_udpBatchRelease(&batch);
+        }
+    }
+    check(rc.numPackets == numWritten && rc.numBad == 0U, "duplicates and a restart: packets come back once");
+    check(reasm.numLost == 0U && reasm.numDropped == 0U, "duplicates and a restart: nothing counted lost");
+    check(reasm.numStale == numFed, "duplicates are skipped");
+}
+
+/* This function checks a ring the sender does not drain drops whole
+ * packets and keeps the ones it took
+ */
+static void test_full(void)
+{
+    MmwDemo_udpBatch batch;
+    MmwDemo_udpReasm reasm;
+    RecvCheck rc = {0};
+    const MmwDemo_udpDgram *dgram;
+    uint32_t frame, numWritten = 0;
+
+    MmwDemo_udpBatchInit(&batch, gRing, TEST_NUM_DGRAMS);
+    memset(&reasm, 0, sizeof(reasm));
+    reasm.packet = gReasmBuf;
+    reasm.packetSize = sizeof(gReasmBuf);
+    gSeed = 11U;
+
+    for(frame = 1; frame <= TEST_NUM_PACKETS; frame++)
+    {
+        uint32_t len = test_make_packet(gPacket, frame);
+        numWritten += test_write(&batch, gPacket, len) == 0;
+        MmwDemo_udpBatchFlush(&batch);
+        check(batch.head - batch.tail <= TEST_NUM_DGRAMS - 1U, "ring never overruns the sender");
+    }
+    while((dgram = MmwDemo_udpBatchNext(&batch)) != NULL)
+    {
+        MmwDemo_udpReasmFeed(&reasm, (const uint8_t *)dgram, (uint32_t)sizeof(dgram->hdr) + dgram->hdr.length,
+                             test_on_packet, &rc);
+        MmwDemo_udpBatchRelease(&batch);
+    }
+    check(batch.numDropped > 0U && numWritten + batch.numDropped == TEST_NUM_PACKETS, "full ring drops packets");
+    check(rc.numPackets == numWritten && rc.numBad == 0U && reasm.numLost == 0U, "packets taken before it filled come back");
+}
+
+/* This function opens a UDP socket on the loopback interface, on port or,
+ * when that is 0, a free one
+ */
+static int test_socket(uint16_t port, struct sockaddr_in *addr)
+{
+    socklen_t addrLen = sizeof(*addr);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr->sin_port = htons(port);
+    if(fd < 0 || bind(fd, (struct sockaddr *)addr, sizeof(*addr)) != 0 ||
+       getsockname(fd, (struct sockaddr *)addr, &addrLen) != 0)
+    {
+        if(fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+/* This function sends packets from the ring through a loopback socket
+ * like the sink task does and reads them back
+ */
+static void test_loopback(uint32_t framesPerBatch)
+{
+    MmwDemo_udpBatch batch;
+    MmwDemo_udpReasm reasm;
+    RecvCheck rc = {0};
+    const MmwDemo_udpDgram *dgram;
+    struct sockaddr_in rxAddr, txAddr;
+    uint8_t rx[2U * MMWDEMO_UDP_DGRAM_SIZE];
+    uint32_t frame, numDgrams = 0;
+    int rxFd, txFd;
+    char msg[128];
+    ssize_t n;
+
+    rxFd = test_socket(0, &rxAddr);
+    txFd = test_socket(0, &txAddr);
+    check(rxFd >= 0 && txFd >= 0, "loopback sockets open");
+    if(rxFd < 0 || txFd < 0)
+    {
+        return;
+    }
+
+    MmwDemo_udpBatchInit(&batch, gRing, TEST_NUM_DGRAMS);
+    memset(&reasm, 0, sizeof(reasm));
+    reasm.packet = gReasmBuf;
+    reasm.packetSize = sizeof(gReasmBuf);
+    gSeed = 7U;
+
+    for(frame = 1; frame <= TEST_NUM_PACKETS; frame++)
+    {
+        uint32_t len = test_make_packet(gPacket, frame);
+        test_write(&batch, gPacket, len);
+        if(frame % framesPerBatch == 0U || frame == TEST_NUM_PACKETS)
+        {
+            MmwDemo_udpBatchFlush(&batch);
+        }
+        while((dgram = MmwDemo_udpBatchNext(&batch)) != NULL)
+        {
+            //one at a time, so the receive buffer never overflows
+            if(sendto(txFd, dgram, sizeof(dgram->hdr) + dgram->hdr.length, 0,
+                      (struct sockaddr *)&rxAddr, sizeof(rxAddr)) < 0)
+            {
+                check(0, "datagram is sent");
+                break;
+            }
+            MmwDemo_udpBatchRelease(&batch);
+            numDgrams++;
+            n = recv(rxFd, rx, sizeof(rx), 0);
+            check(n > 0 && MmwDemo_udpReasmFeed(&reasm, rx, (uint32_t)n, test_on_packet, &rc) == 0,
+                  "datagram is received");
+        }
+    }
+
+    snprintf(msg, sizeof(msg), "loopback, %u frames a batch: every packet comes back intact", framesPerBatch);
+    check(rc.numPackets == TEST_NUM_PACKETS && rc.numBad == 0U && reasm.numLost == 0U, msg);
+    printf("loopback, %u frames a batch:   %3u packets in %5u datagrams\n", framesPerBatch, rc.numPackets, numDgrams);
+    close(rxFd);
+    close(txFd);
+}
+
+/* This function writes every packet of the board to stdout, which
+ * run_listen points at the file
+ */
+static void listen_on_packet(void *arg, const uint8_t *packet, uint32_t len)
+{
+    RecvCheck *rc = (RecvCheck *)arg;
+    rc->numPackets++;
+    rc->numBad += fwrite(packet, 1, len, stdout) != len;
+}
+
+/* This function receives the output of the board
+ */
+static int run_listen(uint16_t port, uint32_t numPackets, const char *outPath)
+{
+    MmwDemo_udpReasm reasm;
+    RecvCheck rc = {0};
+    struct sockaddr_in addr;
+    static uint8_t rx[2U * MMWDEMO_UDP_DGRAM_SIZE];
+    int fd;
+    ssize_t n;
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if(fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        fprintf(stderr, "cannot listen on port %u: %s\n", port, strerror(errno));
+        return 1;
+    }
+    if(freopen(outPath, "wb", stdout) == NULL)
+    {
+        fprintf(stderr, "cannot write %s\n", outPath);
+        close(fd);
+        return 1;
+    }
+
+    memset(&reasm, 0, sizeof(reasm));
+    reasm.packet = gReasmBuf;
+    reasm.packetSize = sizeof(gReasmBuf);
+    while(numPackets == 0U || rc.numPackets < numPackets)
+    {
+        n = recv(fd, rx, sizeof(rx), 0);
+        if(n < 0)
+        {
+            break;
+        }
+        if(MmwDemo_udpReasmFeed(&reasm, rx, (uint32_t)n, listen_on_packet, &rc) != 0)
+        {
+            fprintf(stderr, "not a datagram of the sink, %zd bytes\n", n);
+        }
+    }
+    fflush(stdout);
+    fprintf(stderr, "%u packets, %u datagrams lost, at least %u packets dropped, %u stale datagrams\n",
+            rc.numPackets, reasm.numLost, reasm.numDropped, reasm.numStale);
+    close(fd);
+    return rc.numBad != 0U;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc == 5 && strcmp(argv[1], "listen") == 0)
+    {
+        return run_listen((uint16_t)atoi(argv[2]), (uint32_t)atoi(argv[3]), argv[4]);
+    }
+    if(argc != 1)
+    {
+        fprintf(stderr, "usage: %s [listen <port> <numPackets> packets.bin]\n", argv[0]);
+        return 1;
+    }
+
+    test_ring(1U, 0U, "ring, 1 frame a batch");
+    test_ring(4U, 0U, "ring, 4 frames a batch");
+    test_ring(1U, 17U, "ring, every 17th lost");
+    test_ring(3U, 5U, "ring, every 5th lost");
+    test_full();
+    test_stale();
+    test_loopback(1U);
+    test_loopback(4U);
+    if(gFailed)
+    {
+        printf("checks FAILED\n");
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
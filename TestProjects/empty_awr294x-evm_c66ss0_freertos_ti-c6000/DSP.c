@@ -38,17 +38,20 @@
 
 #include <string.h> //needed for string operations
 #include <C:\Users\there\Documents\Capstone\RadarFirmware\enums.h> //my custom universal values
+#include <C:\Users\there\Documents\Capstone\RadarFirmware\ipc_bench.h> //IPC benchmark echo
 
 //Inclusions to use TI object detection framework
 #include <ti/control/dpm/dpm.h>
 #include <ti/datapath/dpc/objectdetection/objdethwaDDMA/objectdetection.h>
+#include "mmw_config.h" //shared with the MSS project, ahead of the SDK copy
 #include "mmw_dss.h" //modified demo header file
+#include "dpc_stage_timing.h" //per stage timing of the DPC
+#include "dpc_mem_map.h" //memory map of the DPC
+#include "dpc_result_slot.h" //HSRAM slot the DPC writes its point cloud into
 
-/* Demo Include Files */
-#include <ti/demo/awr294x/mmw/include/mmw_config.h>
-#include <ti/demo/awr294x/mmw/dss/mmw_dss.h>
 #include <kernel/dpl/CycleCounterP.h>
 #include <kernel/dpl/TaskP.h>
+#include <kernel/dpl/CacheP.h> //needed for shared memory batches
 
 
 //RPMessage objects
@@ -97,7 +100,7 @@ uint8_t gDPC_ObjDetL2Heap[MMWDEMO_OBJDET_L2RAM_SIZE];
 
  /*! HSRAM for processing results */
 #pragma DATA_SECTION(gHSRAM, ".demoSharedMem");
-#pragma DATA_ALIGN(gHSRAM, 64U);
+#pragma DATA_ALIGN(gHSRAM, MMWDEMO_HSRAM_LINE_SIZE);
 
 /* Task declarations */
 #define MMWDEMO_DSS_INIT_TASK_PRI         (1U)
@@ -105,9 +108,15 @@ uint8_t gDPC_ObjDetL2Heap[MMWDEMO_OBJDET_L2RAM_SIZE];
 #define MMWDEMO_DPM_TASK_PRI              (5U)
 #define MMWDEMO_DPM_TASK_STACK_SIZE       (1 * 1024u)
 
+#define DSP_IPC_TASK_PRI                  (2U)
+#define DSP_IPC_TASK_STACK_SIZE           (1 * 1024u)
+
 /* Stack for tasks */
 StackType_t gMmwDemo_dssInitTaskStack[MMWDEMO_DSS_INIT_TASK_STACK_SIZE] __attribute__((aligned(64)));
 StackType_t gMmwDemo_dpmTaskStack[MMWDEMO_DPM_TASK_STACK_SIZE] __attribute__((aligned(64)));
+StackType_t gDspIpcTaskStack[DSP_IPC_TASK_STACK_SIZE] __attribute__((aligned(64)));
+StaticTask_t gDspIpcTaskObj;
+TaskHandle_t gDspIpcTask;
 
 /**************************************************************************
  *************************** Global Definitions ***************************
@@ -131,6 +140,56 @@ DPM_Buffer  resultBuffer;
  */
 MmwDemo_HSRAM gHSRAM;
 
+/**
+ * @brief
+ *  What a result slot holds besides the point cloud, at the start of its
+ *  payload. These live in DPC memory and are copied.
+ */
+typedef struct MmwDemo_resultSlotExtra_t
+{
+    /*! @brief   DPC stats */
+    DPC_ObjectDetection_Stats           stats;
+
+#ifdef MMWDEMO_TDM
+    /*! @brief   Rx channel bias measurement */
+    DPU_AoAProc_compRxChannelBiasCfg    compRxChanBias;
+#elif defined(MMWDEMO_DDM)
+    /*! @brief   Rx channel bias measurement */
+    Measure_compRxChannelBiasCfg        compRxChanBias;
+#endif
+} MmwDemo_resultSlotExtra;
+
+/*! @brief Point cloud of a result slot, after the extras */
+#define MMWDEMO_SLOT_OBJOUT_OFFSET        ((sizeof(MmwDemo_resultSlotExtra) + 7U) & ~7U)
+
+/*! @brief Points a result slot holds, with their side info */
+#define MMWDEMO_SLOT_MAX_OBJOUT           ((MMWDEMO_HSRAM_PAYLOAD_SIZE - MMWDEMO_SLOT_OBJOUT_OFFSET) / \
+                                           (sizeof(DPIF_PointCloudCartesian) + sizeof(DPIF_PointCloudSideInfo)))
+
+/**
+ * @brief
+ *  Sequence number of the frame being processed, its result goes into
+ *  gHSRAM.slot[gResultSeq % MMWDEMO_HSRAM_NUM_SLOTS]. Wraps after 2^32
+ *  frames, the slot order does not notice.
+ */
+static uint32_t gResultSeq = 0U;
+
+/**
+ * @brief
+ *  Frames per published stage timing summary. Bins count up to 65535, so
+ *  this has to stay below that.
+ */
+#define MMWDEMO_STAGE_TIMING_WINDOW       (128U)
+
+/**
+ * @brief
+ *  Per stage timing histograms of the current window, frames in it and the
+ *  summary of the last finished window, which goes out with every frame.
+ */
+static DPC_ObjDet_StageHist gStageHist[MMWDEMO_OUTPUT_STAGE_MAX];
+static uint32_t gStageTimingFrames = 0U;
+static MmwDemo_output_message_stageTiming gStageTimingReport;
+
 /**************************************************************************
  ******************* Millimeter Wave Demo Functions Prototype *******************
  **************************************************************************/
@@ -151,12 +210,14 @@ static void MmwDemo_updateObjectDetStats
     MmwDemo_output_message_stats    *outputMsgStats
 );
 
-static int32_t MmwDemo_copyResultToHSRAM
+static void MmwDemo_claimResultSlot(void);
+static MmwDemo_resultSlot *MmwDemo_fillResultSlot
 (
-    MmwDemo_HSRAM           *ptrHsramBuffer,
     DPC_ObjectDetection_ExecuteResult *result,
     MmwDemo_output_message_stats *outStats
 );
+static void MmwDemo_updateStageTiming(uint32_t hsramCopyCycles);
+static void MmwDemo_publishMemMap(void);
 static void MmwDemo_DPC_ObjectDetection_dpmTask(void* args);
 static void MmwDemo_sensorStopEpilog(void);
 
@@ -229,6 +290,10 @@ static void MmwDemo_DPC_ObjectDetection_reportFxn
              *   went through without any issues.
              *****************************************************************/
             DebugP_logInfo("DSSApp: DPM Report IOCTL, command = %d\n", arg0);
+            if (arg0 == DPC_OBJDET_IOCTL__STATIC_PRE_START_CFG)
+            {
+                MmwDemo_publishMemMap();
+            }
             break;
         }
         case DPM_Report_DPC_STARTED:
@@ -315,6 +380,7 @@ static void MmwDemo_DPC_ObjectDetection_processFrameBeginCallBackFxn(uint8_t sub
 {
     gMmwDssMCB.dataPathObj.subFrameStats[subFrameIndx].interFrameCPULoad = TaskP_loadGetTotalCpuLoad() / 100;
     TaskP_loadResetAll();
+    MmwDemo_claimResultSlot();
 }
 
 /**
@@ -370,166 +436,237 @@ static void MmwDemo_DPC_ObjectDetection_processInterFrameBeginCallBackFxn(uint8_
     prevInterFrameEndTimeStamp = currDpcStats->interFrameEndTimeStamp;
 }
 
-
 /**
  *  @b Description
  *  @n
- *      Copy DPC results and output stats to HSRAM to share with MSS
+ *      Adds the stage times of the frame the DPC just finished to the stage
+ *      histograms, and publishes their summary once the window is full.
+ *      With the pipelined AoA the AoA runs before the range FFT wait and is
+ *      taken out of the range stage.
  *
- *  @param[in]  ptrHsramBuffer      Pointer to HSRAM buffer memory
- *  @param[in]  result              Pointer to DPC results
- *  @param[in]  outStats            Pointer to Output message stats
+ *  @param[in]  hsramCopyCycles     Cycles filling in the HSRAM result slot took
  *
  *  @retval
  *      Not Applicable.
  */
-static int32_t MmwDemo_copyResultToHSRAM
-(
-    MmwDemo_HSRAM           *ptrHsramBuffer,
-    DPC_ObjectDetection_ExecuteResult *result,
-    MmwDemo_output_message_stats *outStats
-)
+static void MmwDemo_updateStageTiming(uint32_t hsramCopyCycles)
 {
-    uint8_t             *ptrCurrBuffer;
-    uint32_t            totalHsramSize;
-    uint32_t            itemPayloadLen;
+    DPC_ObjDet_StageTimes *t = &gDpcStageTimes;
+    DPC_ObjDet_StageSummary summary;
+    uint32_t aoaCycles = t->aoaEnd - t->aoaStart;
+    uint32_t rangeCycles = t->rangeEnd - t->executeStart;
+    uint32_t stage;
 
-    /* Save result in HSRAM */
-    if(ptrHsramBuffer == NULL)
+    if (t->pipelined)
     {
-        return -1;
+        rangeCycles -= aoaCycles;
     }
 
-    /* Save result in HSRAM */
-    if(result != NULL)
-    {
-        itemPayloadLen = sizeof(DPC_ObjectDetection_ExecuteResult);
-        memcpy((void *)&ptrHsramBuffer->result, (void *)result, itemPayloadLen);
-    }
-    else
+    DPC_ObjDet_stageHistAdd(&gStageHist[MMWDEMO_OUTPUT_STAGE_RANGE], rangeCycles);
+    DPC_ObjDet_stageHistAdd(&gStageHist[MMWDEMO_OUTPUT_STAGE_DOPPLER], t->dopplerEnd - t->rangeEnd);
+    DPC_ObjDet_stageHistAdd(&gStageHist[MMWDEMO_OUTPUT_STAGE_RANGE_CFAR], t->rangeCfarEnd - t->dopplerEnd);
+    DPC_ObjDet_stageHistAdd(&gStageHist[MMWDEMO_OUTPUT_STAGE_INTERSECT], t->intersectEnd - t->rangeCfarEnd);
+    DPC_ObjDet_stageHistAdd(&gStageHist[MMWDEMO_OUTPUT_STAGE_AOA], aoaCycles);
+    DPC_ObjDet_stageHistAdd(&gStageHist[MMWDEMO_OUTPUT_STAGE_HSRAM_COPY], hsramCopyCycles);
+
+    gStageTimingFrames++;
+    if (gStageTimingFrames < MMWDEMO_STAGE_TIMING_WINDOW)
     {
-        return -1;
+        return;
     }
 
-    /* Save output Stats in HSRAM */
-    if(outStats != NULL)
+    /* Window is full: publish and start the next one */
+    for (stage = 0; stage < MMWDEMO_OUTPUT_STAGE_MAX; stage++)
     {
-        itemPayloadLen = sizeof(MmwDemo_output_message_stats);
-        memcpy((void *)&ptrHsramBuffer->outStats, (void *)outStats, itemPayloadLen);
+        DPC_ObjDet_stageHistSummary(&gStageHist[stage], &summary);
+        gStageTimingReport.stage[stage].minCycles  = summary.minCycles;
+        gStageTimingReport.stage[stage].meanCycles = summary.meanCycles;
+        gStageTimingReport.stage[stage].p99Cycles  = summary.p99Cycles;
+        gStageTimingReport.stage[stage].maxCycles  = summary.maxCycles;
+        DPC_ObjDet_stageHistReset(&gStageHist[stage]);
     }
+    gStageTimingReport.windowIndex++;
+    gStageTimingReport.numFrames = gStageTimingFrames;
+    gStageTimingReport.dspClockMHz = DSP_CLOCK_MHZ;
+    gStageTimingReport.pipelinedAoa = t->pipelined;
+    gStageTimingFrames = 0U;
+}
 
-    /* Set payload pointer to HSM buffer */
-    ptrCurrBuffer = &ptrHsramBuffer->payload[0];
-    totalHsramSize = MMWDEMO_HSRAM_PAYLOAD_SIZE;
+/**
+ *  @b Description
+ *  @n
+ *      Copies the memory maps of the sub-frames to HSRAM, where the memMap
+ *      CLI command of the MSS reads them. Called after every pre-start
+ *      configuration, frames are not running then.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_publishMemMap(void)
+{
+    DPC_ObjDet_MemMap *map;
+    MmwDemo_memMap *out;
+    uint32_t subFrame, i;
 
-    /* Save ObjOut in HSRAM */
-    if(result->objOut != NULL)
+    for (subFrame = 0; subFrame < MMWDEMO_MEMMAP_MAX_SUBFRAMES; subFrame++)
     {
-        itemPayloadLen = sizeof(DPIF_PointCloudCartesian) * result->numObjOut;
-        if((totalHsramSize- itemPayloadLen) > 0)
+        map = &gDpcMemMap[subFrame];
+        out = &gHSRAM.memMap[subFrame];
+
+        out->numEntries = map->numEntries;
+        out->numDropped = map->numDropped;
+        out->numNoFit   = map->numNoFit;
+        out->valid      = map->valid;
+        for (i = 0; i < MMWDEMO_MEMMAP_POOL_MAX; i++)
         {
-            memcpy(ptrCurrBuffer, (void *)result->objOut, itemPayloadLen);
-
-            ptrHsramBuffer->result.objOut = (DPIF_PointCloudCartesian *)ptrCurrBuffer;
-            ptrCurrBuffer+= itemPayloadLen;
-            totalHsramSize -=itemPayloadLen;
+            out->pool[i].size       = map->pool[i].size;
+            out->pool[i].highWater  = map->pool[i].highWater;
+            out->pool[i].alignWaste = map->pool[i].alignWaste;
         }
-        else
+        for (i = 0; i < map->numEntries; i++)
         {
-            return -1;
+            memcpy(out->entry[i].name, map->entry[i].name, MMWDEMO_MEMMAP_NAME_LEN);
+            out->entry[i].offset     = map->entry[i].offset;
+            out->entry[i].size       = map->entry[i].size;
+            out->entry[i].alignWaste = map->entry[i].alignWaste;
+            out->entry[i].pool       = map->entry[i].pool;
+            out->entry[i].owner      = map->entry[i].owner;
         }
     }
 
-#ifdef MMWDEMO_TDM
-    /* Save ObjOutSideInfo in HSRAM */
-    if(result->objOutSideInfo != NULL)
+    /* The memMap CLI command reads them on the MSS */
+    CacheP_wb(&gHSRAM.memMap[0], sizeof(gHSRAM.memMap), CacheP_TYPE_ALL);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Hands the DPC the HSRAM result slot of the frame about to be
+ *      processed, so the AoA writes the point cloud straight into it. Called
+ *      at the start of every frame. The MSS only takes a result after it
+ *      sent the one before, but a slow output can still have the slot when
+ *      the frame after next starts. That frame gets no slot and is dropped
+ *      by the DPM task, the count goes out in the stage timing TLV.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_claimResultSlot(void)
+{
+    MmwDemo_resultSlot *slot;
+    uint32_t seq = gResultSeq + 1U;
+
+    /* Only the MSS writes releasedSeq, drop the stale copy of its line */
+    CacheP_inv((void *)&gHSRAM.owner, sizeof(gHSRAM.owner), CacheP_TYPE_ALL);
+    if (DPC_ObjDet_resultSlotFree(seq, gHSRAM.owner.releasedSeq, MMWDEMO_HSRAM_NUM_SLOTS) == 0U)
     {
-        itemPayloadLen = sizeof(DPIF_PointCloudSideInfo) * result->numObjOut;
-        if((totalHsramSize- itemPayloadLen) > 0)
-        {
-            memcpy(ptrCurrBuffer, (void *)result->objOutSideInfo, itemPayloadLen);
-            ptrHsramBuffer->result.objOutSideInfo = (DPIF_PointCloudSideInfo *)ptrCurrBuffer;
-            ptrCurrBuffer+= itemPayloadLen;
-            totalHsramSize -=itemPayloadLen;
-        }
-        else
-        {
-            return -1;
-        }
+        /* Still sending the frame that was in it, the sequence number is
+         * kept for the next frame */
+        DPC_ObjDet_resultSlotSkip(&gDpcResultSlot);
+        return;
     }
-#endif
 
-    /* Save DPC_ObjectDetection_Stats in HSRAM */
-    if(result->stats != NULL)
+    slot = &gHSRAM.slot[DPC_ObjDet_resultSlotIdx(seq, MMWDEMO_HSRAM_NUM_SLOTS)];
+    gDpcResultSlot.objOut = (void *)&slot->payload[MMWDEMO_SLOT_OBJOUT_OFFSET];
+    gDpcResultSlot.objOutSideInfo = (void *)&slot->payload[MMWDEMO_SLOT_OBJOUT_OFFSET +
+                                        (MMWDEMO_SLOT_MAX_OBJOUT * sizeof(DPIF_PointCloudCartesian))];
+    gDpcResultSlot.maxNumObjOut = MMWDEMO_SLOT_MAX_OBJOUT;
+    gResultSeq = seq;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills in the result slot the DPC wrote the point cloud of this frame
+ *      into and writes back the cache lines of it that were touched. The
+ *      point cloud is not copied, only the small parts of the result that
+ *      live in DPC memory are. The header is left for the caller to write
+ *      back, it goes last.
+ *
+ *  @param[in]  result              Pointer to DPC results
+ *  @param[in]  outStats            Pointer to Output message stats
+ *
+ *  @retval
+ *      Slot of the frame, NULL when the point cloud is not in it
+ */
+static MmwDemo_resultSlot *MmwDemo_fillResultSlot
+(
+    DPC_ObjectDetection_ExecuteResult *result,
+    MmwDemo_output_message_stats *outStats
+)
+{
+    MmwDemo_resultSlot      *slot;
+    MmwDemo_resultSlotExtra *extra;
+
+    if ((result == NULL) || ((void *)result->objOut != gDpcResultSlot.objOut))
     {
-        itemPayloadLen = sizeof(DPC_ObjectDetection_Stats);
-        if((totalHsramSize- itemPayloadLen) > 0)
-        {
-            memcpy(ptrCurrBuffer, (void *)result->stats, itemPayloadLen);
-            ptrHsramBuffer->result.stats = (DPC_ObjectDetection_Stats *)ptrCurrBuffer;
-            ptrCurrBuffer+= itemPayloadLen;
-            totalHsramSize -=itemPayloadLen;
-        }
-        else
-        {
-            return -1;
-        }
+        return NULL;
     }
+    slot = &gHSRAM.slot[DPC_ObjDet_resultSlotIdx(gResultSeq, MMWDEMO_HSRAM_NUM_SLOTS)];
+    extra = (MmwDemo_resultSlotExtra *)&slot->payload[0];
 
-#ifdef MMWDEMO_TDM
-    /* Save compRxChanBiasMeasurement in HSRAM */
-    if(result->compRxChanBiasMeasurement != NULL)
+    slot->hdr.result = *result;
+    if (outStats != NULL)
     {
-        itemPayloadLen = sizeof(DPU_AoAProc_compRxChannelBiasCfg);
-        if((totalHsramSize- itemPayloadLen) > 0)
-        {
-            memcpy(ptrCurrBuffer, (void *)result->compRxChanBiasMeasurement, itemPayloadLen);
-            ptrHsramBuffer->result.compRxChanBiasMeasurement = (DPU_AoAProc_compRxChannelBiasCfg *)ptrCurrBuffer;
-            ptrCurrBuffer+= itemPayloadLen;
-            totalHsramSize -=itemPayloadLen;
-        }
-        else
-        {
-            return -1;
-        }
+        slot->hdr.outStats = *outStats;
     }
-#endif
 
-#ifdef MMWDEMO_DDM
-    /* Save compRxChanBiasMeasurement in HSRAM */
-    if(result->compRxChanBiasMeasurement != NULL)
+    /* Save the last stage timing summary */
+    slot->hdr.stageTiming = gStageTimingReport;
+    slot->hdr.stageTiming.numClamped  = gDpcResultSlot.numClamped;
+    slot->hdr.stageTiming.numSlotBusy = gDpcResultSlot.numBusy;
+
+    if (result->stats != NULL)
     {
-        itemPayloadLen = sizeof(Measure_compRxChannelBiasCfg);
-        if((totalHsramSize- itemPayloadLen) > 0)
-        {
-            memcpy(ptrCurrBuffer, (void *)result->compRxChanBiasMeasurement, itemPayloadLen);
-            ptrHsramBuffer->result.compRxChanBiasMeasurement = (Measure_compRxChannelBiasCfg *)ptrCurrBuffer;
-            ptrCurrBuffer+= itemPayloadLen;
-            totalHsramSize -=itemPayloadLen;
-        }
-        else
-        {
-            return -1;
-        }
+        extra->stats = *result->stats;
+        slot->hdr.result.stats = &extra->stats;
     }
-
-    /* save the FFT clip status in HSRAM */
-    if(result->FFTClipCount !=NULL)
+#if defined(MMWDEMO_TDM) || defined(MMWDEMO_DDM)
+    if (result->compRxChanBiasMeasurement != NULL)
     {
-        itemPayloadLen = sizeof(result->FFTClipCount);
-        if((totalHsramSize- itemPayloadLen) > 0)
-        {
-            memcpy(ptrHsramBuffer->result.FFTClipCount, (void *)result->FFTClipCount, itemPayloadLen);
-            totalHsramSize -=itemPayloadLen;
-        }
-        else
-        {
-            return -1;
-        }
+        extra->compRxChanBias = *result->compRxChanBiasMeasurement;
+        slot->hdr.result.compRxChanBiasMeasurement = &extra->compRxChanBias;
     }
 #endif
 
-    return totalHsramSize;
+    /* Write back what was written, not the whole slot */
+    CacheP_wb((void *)extra, sizeof(MmwDemo_resultSlotExtra), CacheP_TYPE_ALL);
+    if (result->numObjOut > 0U)
+    {
+        CacheP_wb((void *)result->objOut, result->numObjOut * sizeof(DPIF_PointCloudCartesian), CacheP_TYPE_ALL);
+        CacheP_wb((void *)result->objOutSideInfo, result->numObjOut * sizeof(DPIF_PointCloudSideInfo), CacheP_TYPE_ALL);
+    }
+
+    return slot;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Drops a frame that got no result slot. The MSS never sees it, so
+ *      this tells the DPC the result is done with, as the MSS does for a
+ *      frame it sent, and the next frame can start.
+ *
+ *  @param[in]  result              Pointer to DPC results
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_dropResult(DPC_ObjectDetection_ExecuteResult *result)
+{
+    DPC_ObjectDetection_ExecuteResultExportedInfo exportInfo;
+    int32_t retVal;
+
+    exportInfo.subFrameIdx = result->subFrameIdx;
+    retVal = DPM_ioctl (gMmwDssMCB.dataPathObj.objDetDpmHandle,
+                        DPC_OBJDET_IOCTL__DYNAMIC_EXECUTE_RESULT_EXPORTED,
+                        &exportInfo,
+                        sizeof(DPC_ObjectDetection_ExecuteResultExportedInfo));
+    if (retVal < 0)
+    {
+        test_print ("Error: Failed to drop the result of frame %u [Error: %d]\n", gResultSeq + 1U, retVal);
+        MmwDemo_debugAssert (0);
+    }
 }
 
 /**
@@ -547,7 +684,9 @@ static void MmwDemo_DPC_ObjectDetection_dpmTask(void* args)
 {
     int32_t     retVal;
     DPC_ObjectDetection_ExecuteResult *result;
+    MmwDemo_resultSlot             *slot;
     volatile uint32_t              startTime;
+    uint32_t                       copyCycles;
 
     while (1)
     {
@@ -563,25 +702,36 @@ static void MmwDemo_DPC_ObjectDetection_dpmTask(void* args)
             {
                 result = (DPC_ObjectDetection_ExecuteResult *)resultBuffer.ptrBuffer[0];
 
-                /* Get the time stamp before copy data to HSRAM */
+                /* Get the time stamp before filling in the HSRAM result slot */
                 startTime = CycleCounterP_getCount32();
 
                 /* Update processing stats and added it to buffer 1*/
                 MmwDemo_updateObjectDetStats(result->stats,
                                                 &gMmwDssMCB.dataPathObj.subFrameStats[result->subFrameIdx]);
 
-                /* Cache invalidation for gHSRAM needed to avoid incoherency issues between DSS and MSS */
-                CacheP_inv(&gHSRAM,SYS_COMMON_HSRAM_SIZE,CacheP_TYPE_ALL);
-                /* Copy result data to HSRAM */
-                if ((retVal = MmwDemo_copyResultToHSRAM(&gHSRAM, result, &gMmwDssMCB.dataPathObj.subFrameStats[result->subFrameIdx])) >= 0)
+                /* No slot, the MSS still had it when the frame started */
+                if (gDpcResultSlot.objOut == NULL)
+                {
+                    MmwDemo_dropResult(result);
+                }
+                /* The point cloud is already in the slot, fill in the rest */
+                else if ((slot = MmwDemo_fillResultSlot(result, &gMmwDssMCB.dataPathObj.subFrameStats[result->subFrameIdx])) != NULL)
                 {
-                    /* Update interframe margin with HSRAM copy time */
-                    gHSRAM.outStats.interFrameProcessingMargin -= ((CycleCounterP_getCount32() - startTime)/DSP_CLOCK_MHZ);
+                    /* Update interframe margin with the slot fill time */
+                    copyCycles = CycleCounterP_getCount32() - startTime;
+                    slot->hdr.outStats.interFrameProcessingMargin -= (copyCycles/DSP_CLOCK_MHZ);
+                    MmwDemo_updateStageTiming(copyCycles);
+
+                    /* Header last, its sequence number is what the MSS releases */
+                    slot->hdr.seq = gResultSeq;
+                    CacheP_wb((void *)&slot->hdr, sizeof(MmwDemo_resultSlotHeader), CacheP_TYPE_ALL);
 
                     /* Update DPM buffer */
-                    resultBuffer.ptrBuffer[0] = (uint8_t *)&gHSRAM.result;
-                    resultBuffer.ptrBuffer[1] = (uint8_t *)&gHSRAM.outStats;
+                    resultBuffer.ptrBuffer[0] = (uint8_t *)&slot->hdr.result;
+                    resultBuffer.ptrBuffer[1] = (uint8_t *)&slot->hdr.outStats;
                     resultBuffer.size[1] = sizeof(MmwDemo_output_message_stats);
+                    resultBuffer.ptrBuffer[2] = (uint8_t *)&slot->hdr.stageTiming;
+                    resultBuffer.size[2] = sizeof(MmwDemo_output_message_stageTiming);
 
 
                     /* YES: Results are available send them. */
@@ -593,7 +743,7 @@ static void MmwDemo_DPC_ObjectDetection_dpmTask(void* args)
                 }
                 else
                 {
-                    test_print ("Error: Failed to copy processing results to HSRAM, error=%d\n", retVal);
+                    test_print ("Error: Point cloud of frame %u is not in its HSRAM result slot\n", gResultSeq);
                     MmwDemo_debugAssert (0);
                 }
             }
@@ -719,12 +869,77 @@ mmWave_DSS_MCB gMmwDssMCB;
 /*                               Functions                                  */
 /* ======================================================================== */
 
+/* This function runs a batch from shared memory using the C66x SIMD
+ * instructions, 4 elements per loop the same way dotpCmplxf does.
+ * ipc_msg_handle_vec has already checked the arrays are 8 byte aligned.
+ */
+static int16_t dsp_vec_run(uint8_t opcode, const int32_t *x, const int32_t *y, int32_t *out, uint32_t count)
+{
+    uint32_t i;
+    uint32_t count4 = count & ~3U;
+
+    _nassert((int)x % 8 == 0);
+    _nassert((int)y % 8 == 0);
+    _nassert((int)out % 8 == 0);
+
+    //the R5F wrote these through a non-cached mapping
+    CacheP_inv((void *)x, count * sizeof(int32_t), CacheP_TYPE_ALL);
+    CacheP_inv((void *)y, count * sizeof(int32_t), CacheP_TYPE_ALL);
+
+    if(opcode == IPC_OP_VEC_ADD)
+    {
+        for(i = 0; i < count4; i += 4)
+        {
+            _amem8(&out[i]) = _dadd(_amem8_const(&x[i]), _amem8_const(&y[i]));
+            _amem8(&out[i+2]) = _dadd(_amem8_const(&x[i+2]), _amem8_const(&y[i+2]));
+        }
+        for(; i < count; i++)
+        {
+            out[i] = x[i] + y[i];
+        }
+    }
+    else if(opcode == IPC_OP_VEC_SUB)
+    {
+        for(i = 0; i < count4; i += 4)
+        {
+            _amem8(&out[i]) = _dsub(_amem8_const(&x[i]), _amem8_const(&y[i]));
+            _amem8(&out[i+2]) = _dsub(_amem8_const(&x[i+2]), _amem8_const(&y[i+2]));
+        }
+        for(; i < count; i++)
+        {
+            out[i] = x[i] - y[i];
+        }
+    }
+    else if(opcode == IPC_OP_VEC_MUL)
+    {
+        for(i = 0; i < count4; i += 4)
+        {
+            //four 32x32 multiplies keeping the low 32 bits, same as x * y in C
+            __x128_t prod = _qmpy32(_llto128(_amem8_const(&x[i+2]), _amem8_const(&x[i])),
+                                    _llto128(_amem8_const(&y[i+2]), _amem8_const(&y[i])));
+            _amem8(&out[i]) = _lo128(prod);
+            _amem8(&out[i+2]) = _hi128(prod);
+        }
+        for(; i < count; i++)
+        {
+            out[i] = x[i] * y[i];
+        }
+    }
+    else
+    {
+        return IPC_STATUS_BAD_OPCODE;
+    }
+
+    //push the results out before R5F_0 reads them
+    CacheP_wbInv(out, count * sizeof(int32_t), CacheP_TYPE_ALL);
+    return IPC_STATUS_OK;
+}
+
 /* This function sends commands to the correct cores to offload tasks
  */
-static void send_to_core(uint16_t RemoteCoreID, uint16_t RemoteEndPt, char buf[64])
+static void send_to_core(uint16_t RemoteCoreID, uint16_t RemoteEndPt, IpcMsg *msg, uint16_t size)
 {
-    uint16_t size = strlen(buf) + 1; //add 1 to account for terminating character
-    RPMessage_send( buf, size,
+    RPMessage_send( msg, size,
                     RemoteCoreID, RemoteEndPt,
                     gDSPSendEndPt, SystemP_WAIT_FOREVER);
 }
@@ -762,6 +977,88 @@ void dsp_start_dpm(void)
  */
 
 
+/* This function works through every entry R5F_0 has put in the shared
+ * memory ring. Batches are done in place, results overwrite x.
+ */
+static void dsp_ring_drain(void)
+{
+    IpcRing *ring = IPC_RING_PTR();
+    IpcRingEntry *entry;
+
+    while((entry = ipc_ring_peek(ring)) != NULL)
+    {
+        if(!ipc_opcode_is_vec(entry->opcode))
+        {
+            entry->status = IPC_STATUS_BAD_OPCODE;
+        }
+        else if((entry->len > IPC_RING_PAYLOAD_SIZE) ||
+                (entry->count > IPC_RING_PAYLOAD_SIZE / sizeof(int32_t)) ||
+                (entry->len < IPC_RING_VEC_LEN(entry->count)))
+        {
+            entry->status = IPC_STATUS_BAD_LENGTH;
+        }
+        else
+        {
+            int32_t *x = (int32_t *)IPC_RING_PAYLOAD(entry);
+            //y is padded to the next even element, dsp_vec_run needs it 8 byte aligned
+            entry->status = dsp_vec_run(entry->opcode, x, x + IPC_RING_VEC_Y_INDEX(entry->count), x, entry->count);
+        }
+        ipc_ring_release(ring);
+    }
+}
+
+/* This function is the DSP's IPC task.
+ * It answers commands from R5F_0 and drains the ring when the doorbell rings.
+ */
+static void dsp_ipc_task(void *args)
+{
+    uint8_t buf[IPC_MSG_MAX_SIZE];
+    uint16_t buf_size;
+    IpcMsg req, reply;
+
+    while(1)
+    {
+        buf_size = sizeof(buf);
+        uint16_t SrcCore = CSL_CORE_ID_R5FSS0_0;
+        uint16_t SrcEndPt = gMainSendEndPt;
+        int32_t status = RPMessage_recv(&gRecvObj, buf, &buf_size, &SrcCore, &SrcEndPt, SystemP_WAIT_FOREVER);
+        uint32_t rxCycles = CycleCounterP_getCount32();
+
+        //benchmark echoes go straight back to whoever sent them
+        if(status == 0 && ipc_bench_echo(buf, buf_size, CycleCounterP_getCount32() - rxCycles, DSP_CLOCK_MHZ))
+        {
+            RPMessage_send(buf, buf_size, SrcCore, SrcEndPt, gDSPSendEndPt, SystemP_WAIT_FOREVER);
+        }
+        else if(status == 0) //if a message is actually received
+        {
+            uint16_t reply_size;
+            int16_t msg_status = ipc_msg_decode(buf, buf_size, &req);
+            if(msg_status == IPC_STATUS_OK && req.hdr.opcode == IPC_OP_RING_DOORBELL)
+            {
+                dsp_ring_drain(); //one-way, R5F_0 watches the ring tail instead of a reply
+                continue;
+            }
+            else if(msg_status == IPC_STATUS_OK && ipc_opcode_is_vec(req.hdr.opcode))
+            {
+                reply_size = ipc_msg_handle_vec(&req, &reply, dsp_vec_run); //whole batch from shared memory
+            }
+            else if(msg_status == IPC_STATUS_OK)
+            {
+                reply_size = ipc_msg_handle_math(&req, &reply); //calculate
+            }
+            else
+            {
+                reply_size = ipc_msg_encode_result(&reply, &req.hdr, msg_status, 0);
+            }
+
+            DebugP_log("DSP op=%u id=%u status=%d result=%d\r\n", req.hdr.opcode, req.hdr.reqId, reply.hdr.status, reply.payload.result);
+
+            //send result
+            send_to_core(SrcCore, gMainRecEndPt, &reply, reply_size);
+        }
+    }
+}
+
 /* This is the main function for the Digital Signal Processor (DSP) 
  * firmware.
  */
@@ -771,8 +1068,6 @@ void dsp_main(void *args)
     Drivers_open();
     Board_driversOpen();
 
-    char buf[64];
-    uint16_t buf_size;
     /* IPC System things */
     //setup
     RPMessage_CreateParams createParams;
@@ -785,6 +1080,16 @@ void dsp_main(void *args)
     RPMessage_CreateParams_init(&createParams2);
     createParams2.localEndPt = gDSPSendEndPt;
     RPMessage_construct(&gMsgObj, &createParams2);
+
+    //IPC runs in its own task, anything after vTaskStartScheduler() never runs
+    gDspIpcTask = xTaskCreateStatic( dsp_ipc_task,
+                                  "dsp_ipc_task",
+                                  DSP_IPC_TASK_STACK_SIZE,
+                                  NULL,
+                                  DSP_IPC_TASK_PRI,
+                                  gDspIpcTaskStack,
+                                  &gDspIpcTaskObj );
+    configASSERT(gDspIpcTask != NULL);
     /* -------------------------------------------- */
 
     /* Initialize and populate the demo MCB */
@@ -809,32 +1114,6 @@ void dsp_main(void *args)
     techniques for trapping heap exhaustion, are described in the book text. */
     DebugP_assertNoLog(0);
 
-    while(1)
-    {
-        buf_size = sizeof(buf);
-        uint16_t SrcCore = CSL_CORE_ID_R5FSS0_0;
-        uint16_t SrcEndPt = gMainSendEndPt;
-        int32_t status = RPMessage_recv(&gRecvObj, buf, &buf_size, &SrcCore, &SrcEndPt, SystemP_WAIT_FOREVER);
-
-        if(status == 0) //if a message is actually received
-        {
-            DebugP_log("DSP got message: '%s' len=%u from core=%u ep=%u\r\n", buf, buf_size, SrcCore, SrcEndPt);
-            int x, y;
-            sscanf(buf, "MUL %d %d", &x, &y); //get numbers
-            int result = x * y; //calculate
-            snprintf(buf, sizeof(buf)-1, "%d", result);
-
-            DebugP_log("DSP sending reply: %s\r\n", buf);
-
-            //send result
-            send_to_core(SrcCore, gMainRecEndPt, buf);
-        }
-        else if(status == -1) //this is needed so that the blow statements can be reached
-        {
-            break;
-        }
-    }
-
     Board_driversClose();
     Drivers_close();
 };
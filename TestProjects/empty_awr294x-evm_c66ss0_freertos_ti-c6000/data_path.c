@@ -50,14 +50,12 @@
 #include <math.h>
 
 #include <drivers/hwa.h>
-#include <ti/demo/awr294x/mmw/dss/mmw_dss.h> 
+#include "mmw_dss.h" //modified demo header file
 #include <ti_drivers_config.h>
 #include <ti_board_config.h>
 #include <ti_drivers_open_close.h>
 #include <ti_board_open_close.h>
 
-#include <ti/demo/awr294x/mmw/dss/mmw_dss.h> 
-
 
 /**************************************************************************
  *************************** Global Definitions ********************************
@@ -0,0 +1,492 @@
+/*
+ *   @file  dpc_bfp.h
+ *
+ *   @brief
+ *      Block floating point format of the compressed radar cube, and the
+ *      tuner that picks its compression ratio.
+ *
+ *      The range DPU compresses every rangeBinsPerBlock samples of one
+ *      antenna into a block of whole 32-bit words: a 4 bit scale factor
+ *      followed by one mantissa per real and imaginary part. The samples
+ *      are shifted right (truncated) by the scale factor, the smallest shift
+ *      that fits the widest sample of the block into the mantissas. On ES2.0
+ *      parts the imaginary mantissa is one bit narrower and its shift one
+ *      larger. This reproduces the decompressed outputs of the
+ *      hwa_bfp_compression example for all its ratios. The bit order of a
+ *      block is LSB first: scale factor, then per sample the lower 16 bit
+ *      half of the input word (imaginary of cmplx16ImRe_t) and the upper.
+ *
+ *      The tuner looks at a few compressed blocks of every frame. From the
+ *      scale factor and mantissa width it knows the bit width of each
+ *      block, which gives the truncation noise the block gets at every
+ *      other ratio, and from the decoded samples it estimates the noise
+ *      floor. Quantization noise adds to the noise floor the detection
+ *      thresholds sit on, so a target loses 10log10(1 + Nq/Nfloor) dB of
+ *      SNR. Every few frames the tuner moves to the lowest ratio whose
+ *      predicted loss is within the budget. Nothing here needs the SDK,
+ *      HostTools/dpc_sim.c builds it too.
+ */
+
+#ifndef DPC_BFP_H
+#define DPC_BFP_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/*! @brief  Bits of the scale factor in front of every block */
+#define DPC_OBJDET_BFP_SCALE_FAC_BW     (4U)
+
+/*! @brief  Largest block the tuner handles, in samples and in words */
+#define DPC_OBJDET_BFP_MAX_BLOCK_SAMPLES (64U)
+
+/*! @brief  Bit widths of a 16 bit sample, 1 to 16 */
+#define DPC_OBJDET_BFP_NUM_WIDTHS       (17U)
+
+/*! @brief  Blocks the tuner can sample in one frame */
+#define DPC_OBJDET_BFP_TUNE_MAX_BLOCKS  (128U)
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the words of a compressed block for a compression ratio,
+ *     rounded up the way DPC_ObjDet_preStartConfig sizes the radar cube.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_bfpWordsPerBlock(float ratio, uint32_t samplesPerBlock)
+{
+    return (uint32_t)(((ratio * (float)(4U * samplesPerBlock)) + 3.99F) / 4.0F);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the compression ratio that gives exactly wordsPerBlock words.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline float DPC_ObjDet_bfpRatio(uint32_t wordsPerBlock, uint32_t samplesPerBlock)
+{
+    return (float)wordsPerBlock / (float)samplesPerBlock;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the width of the real mantissa, the imaginary one is
+ *     decrImagBitw narrower. Same formula as the hwa_bfp_compression example,
+ *     at most the 16 bits of a sample.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_bfpMantissaBW(uint32_t wordsPerBlock, uint32_t samplesPerBlock,
+                                                uint32_t decrImagBitw)
+{
+    uint32_t mantissaBW = ((wordsPerBlock * 32U) - DPC_OBJDET_BFP_SCALE_FAC_BW + (decrImagBitw * samplesPerBlock)) /
+                          (2U * samplesPerBlock);
+
+    return (mantissaBW < 16U) ? mantissaBW : 16U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the bits a signed value needs, 1 for 0 and -1.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_bfpBitWidth(int32_t value)
+{
+    uint32_t mag = (value < 0) ? (uint32_t)~value : (uint32_t)value;
+
+    if (mag == 0U)
+    {
+        return 1U;
+    }
+#if defined(_TMS320C6600) && !defined(OBJDET_HOST_SIM)
+    return 33U - _lmbd(1U, mag);
+#else
+    return 33U - (uint32_t)__builtin_clz(mag);
+#endif
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the scale factor of a block whose widest sample needs
+ *     bitWidth bits: the shift of the imaginary part. The real part is
+ *     shifted decrImagBitw less.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_bfpScaleFactor(uint32_t bitWidth, uint32_t mantissaBW, uint32_t decrImagBitw)
+{
+    uint32_t imagBW = mantissaBW - decrImagBitw;
+
+    return (bitWidth > imagBW) ? (bitWidth - imagBW) : 0U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the mean square error a shift by shift bits adds to a
+ *     sample, for samples evenly spread over the bits that are cut off.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline float DPC_ObjDet_bfpTruncNoise(uint32_t shift)
+{
+    float step = (float)(1U << shift);
+
+    return ((step - 1.0F) * ((2.0F * step) - 1.0F)) / 6.0F;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Compresses one block the way the HWA does.
+ *
+ *  @param[in]  in               samplesPerBlock cmplx16ImRe_t samples as 16 bit pairs
+ *  @param[in]  samplesPerBlock  Samples of the block
+ *  @param[in]  wordsPerBlock    Words of the compressed block
+ *  @param[in]  decrImagBitw     1 for the narrower imaginary mantissa
+ *  @param[out] out              wordsPerBlock words
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_bfpPackBlock(const int16_t *in, uint32_t samplesPerBlock,
+                                           uint32_t wordsPerBlock, uint32_t decrImagBitw,
+                                           uint32_t *out)
+{
+    uint32_t mantissaBW = DPC_ObjDet_bfpMantissaBW(wordsPerBlock, samplesPerBlock, decrImagBitw);
+    uint32_t bitWidth = 1U;
+    uint32_t scaleFac, shift[2], width[2];
+    uint64_t acc;
+    uint32_t accBits, i, word = 0;
+
+    for (i = 0; i < 2U * samplesPerBlock; i++)
+    {
+        uint32_t w = DPC_ObjDet_bfpBitWidth(in[i]);
+        bitWidth = (w > bitWidth) ? w : bitWidth;
+    }
+    scaleFac = DPC_ObjDet_bfpScaleFactor(bitWidth, mantissaBW, decrImagBitw);
+    shift[0] = scaleFac;
+    shift[1] = (scaleFac > decrImagBitw) ? (scaleFac - decrImagBitw) : 0U;
+    width[0] = mantissaBW - decrImagBitw;
+    width[1] = mantissaBW;
+
+    acc = scaleFac;
+    accBits = DPC_OBJDET_BFP_SCALE_FAC_BW;
+    for (i = 0; i < 2U * samplesPerBlock; i++)
+    {
+        uint32_t half = i & 1U;
+        uint32_t mant = (uint32_t)((int32_t)in[i] >> shift[half]) & ((1U << width[half]) - 1U);
+
+        acc |= (uint64_t)mant << accBits;
+        accBits += width[half];
+        if (accBits >= 32U)
+        {
+            out[word++] = (uint32_t)acc;
+            acc >>= 32;
+            accBits -= 32U;
+        }
+    }
+    while (word < wordsPerBlock)
+    {
+        out[word++] = (uint32_t)acc;
+        acc = 0U;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Decompresses one block.
+ *
+ *  @param[in]  in               wordsPerBlock words of a compressed block
+ *  @param[in]  samplesPerBlock  Samples of the block
+ *  @param[in]  mantissaBW       Real mantissa width of the block format
+ *  @param[in]  decrImagBitw     1 for the narrower imaginary mantissa
+ *  @param[out] out              samplesPerBlock cmplx16ImRe_t samples as 16 bit pairs
+ *
+ *  @retval   Scale factor of the block
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_bfpUnpackBlock(const uint32_t *in, uint32_t samplesPerBlock,
+                                                 uint32_t mantissaBW, uint32_t decrImagBitw,
+                                                 int16_t *out)
+{
+    uint64_t acc = in[0];
+    uint32_t accBits = 32U;
+    uint32_t word = 1U;
+    uint32_t scaleFac, shift[2], width[2], i;
+
+    scaleFac = (uint32_t)acc & ((1U << DPC_OBJDET_BFP_SCALE_FAC_BW) - 1U);
+    acc >>= DPC_OBJDET_BFP_SCALE_FAC_BW;
+    accBits -= DPC_OBJDET_BFP_SCALE_FAC_BW;
+    shift[0] = scaleFac;
+    shift[1] = (scaleFac > decrImagBitw) ? (scaleFac - decrImagBitw) : 0U;
+    width[0] = mantissaBW - decrImagBitw;
+    width[1] = mantissaBW;
+
+    for (i = 0; i < 2U * samplesPerBlock; i++)
+    {
+        uint32_t half = i & 1U;
+        int32_t mant;
+
+        if (accBits < width[half])
+        {
+            acc |= (uint64_t)in[word++] << accBits;
+            accBits += 32U;
+        }
+        /* sign extend the mantissa */
+        mant = (int32_t)((uint32_t)acc << (32U - width[half])) >> (32U - width[half]);
+        out[i] = (int16_t)(mant * (1 << shift[half]));
+        acc >>= width[half];
+        accBits -= width[half];
+    }
+    return scaleFac;
+}
+
+/**************************************************************************
+ ************************** Compression Tuner *****************************
+ **************************************************************************/
+
+/*! @brief  Compression ratio tuner of one sub-frame */
+typedef struct DPC_ObjDet_BfpTune_t
+{
+    uint8_t  enabled;            /*!< BFP compression in use and the tuner on */
+    uint8_t  decrImagBitw;       /*!< 1 on ES2.0 parts */
+    uint16_t samplesPerBlock;    /*!< rangeBinsPerBlock */
+    uint16_t wordsMin;           /*!< most aggressive ratio allowed, in words per block */
+    uint16_t wordsMax;           /*!< ratio the radar cube is sized for */
+    uint16_t wordsCur;           /*!< ratio in use */
+    uint16_t blocksPerFrame;     /*!< blocks sampled per frame */
+    uint16_t framesPerDecision;  /*!< frames between two ratio decisions */
+    uint16_t numFrames;          /*!< frames since the last decision */
+    uint32_t seed;               /*!< picks the sampled blocks */
+    float    lossBudget;         /*!< allowed Nq/Nfloor, 10^(dB/10) - 1 */
+    float    stepDownBudget;     /*!< Nq/Nfloor to go one word lower, budget minus hysteresis */
+    float    noiseFloorSum;      /*!< sum of the per frame noise floors, LSB^2 per sample */
+    uint32_t widthHist[DPC_OBJDET_BFP_NUM_WIDTHS]; /*!< sampled blocks per bit width */
+    float    lossDb;             /*!< predicted SNR loss at wordsCur, from the last decision */
+    float    noiseFloor;         /*!< noise floor of the last decision */
+    uint32_t numDecisions;       /*!< decisions made */
+    uint32_t numChanges;         /*!< decisions that changed the ratio */
+} DPC_ObjDet_BfpTune;
+
+/**
+ *  @b Description
+ *  @n
+ *     Sets a tuner up for a sub-frame, starting at the configured ratio.
+ *
+ *  @param[in]  tune              Tuner
+ *  @param[in]  samplesPerBlock   rangeBinsPerBlock
+ *  @param[in]  decrImagBitw      1 on ES2.0 parts
+ *  @param[in]  maxRatio          Configured compression ratio, the radar cube is sized for it
+ *  @param[in]  minRatio          Most aggressive ratio allowed
+ *  @param[in]  lossBudgetDb      Allowed detection SNR loss
+ *  @param[in]  hysteresisDb      Margin below the budget before the ratio goes down
+ *  @param[in]  blocksPerFrame    Blocks sampled per frame
+ *  @param[in]  framesPerDecision Frames between two ratio decisions
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_bfpTuneInit(DPC_ObjDet_BfpTune *tune, uint32_t samplesPerBlock,
+                                          uint32_t decrImagBitw, float maxRatio, float minRatio,
+                                          float lossBudgetDb, float hysteresisDb,
+                                          uint32_t blocksPerFrame, uint32_t framesPerDecision)
+{
+    uint32_t wordsMin;
+
+    (void)memset((void *)tune, 0, sizeof(DPC_ObjDet_BfpTune));
+    if ((samplesPerBlock == 0U) || (samplesPerBlock > DPC_OBJDET_BFP_MAX_BLOCK_SAMPLES))
+    {
+        return;
+    }
+    tune->samplesPerBlock = (uint16_t)samplesPerBlock;
+    tune->decrImagBitw = (uint8_t)decrImagBitw;
+    tune->wordsMax = (uint16_t)DPC_ObjDet_bfpWordsPerBlock(maxRatio, samplesPerBlock);
+
+    /* at least 2 bits for the narrower mantissa */
+    wordsMin = DPC_ObjDet_bfpWordsPerBlock(minRatio, samplesPerBlock);
+    while ((wordsMin < tune->wordsMax) &&
+           (DPC_ObjDet_bfpMantissaBW(wordsMin, samplesPerBlock, decrImagBitw) < (2U + decrImagBitw)))
+    {
+        wordsMin++;
+    }
+    tune->wordsMin = (uint16_t)((wordsMin < tune->wordsMax) ? wordsMin : tune->wordsMax);
+    tune->wordsCur = tune->wordsMax;
+    tune->blocksPerFrame = (uint16_t)((blocksPerFrame < DPC_OBJDET_BFP_TUNE_MAX_BLOCKS) ?
+                                      blocksPerFrame : DPC_OBJDET_BFP_TUNE_MAX_BLOCKS);
+    tune->framesPerDecision = (uint16_t)((framesPerDecision == 0U) ? 1U : framesPerDecision);
+    tune->lossBudget = powf(10.0F, lossBudgetDb / 10.0F) - 1.0F;
+    tune->stepDownBudget = powf(10.0F, (lossBudgetDb - hysteresisDb) / 10.0F) - 1.0F;
+    tune->enabled = (uint8_t)(tune->wordsMin < tune->wordsMax);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the mean truncation noise per complex sample the sampled
+ *     blocks would get at wordsPerBlock, times the number of blocks.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline float DPC_ObjDet_bfpTuneQuantNoise(const DPC_ObjDet_BfpTune *tune, uint32_t wordsPerBlock)
+{
+    uint32_t mantissaBW = DPC_ObjDet_bfpMantissaBW(wordsPerBlock, tune->samplesPerBlock, tune->decrImagBitw);
+    float noise = 0.0F;
+    uint32_t width;
+
+    for (width = 1U; width < DPC_OBJDET_BFP_NUM_WIDTHS; width++)
+    {
+        if (tune->widthHist[width] != 0U)
+        {
+            uint32_t imagShift = DPC_ObjDet_bfpScaleFactor(width, mantissaBW, tune->decrImagBitw);
+            uint32_t realShift = (imagShift > tune->decrImagBitw) ? (imagShift - tune->decrImagBitw) : 0U;
+
+            noise += (float)tune->widthHist[width] *
+                     (DPC_ObjDet_bfpTruncNoise(realShift) + DPC_ObjDet_bfpTruncNoise(imagShift));
+        }
+    }
+    return noise;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Samples blocks of this frame's compressed radar cube. The blocks are
+ *     picked at random, a target shows up in the same range block of every
+ *     chirp and antenna and would line up with an even spacing. The noise
+ *     floor of the frame is the median block power, most blocks hold no
+ *     target.
+ *
+ *  @param[in]  tune       Tuner
+ *  @param[in]  cube       Compressed radar cube, compressed at wordsCur
+ *  @param[in]  numBlocks  Blocks in the radar cube
+ *  @param[in]  scratch    blocksPerFrame floats
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_bfpTuneSample(DPC_ObjDet_BfpTune *tune, const uint32_t *cube,
+                                            uint32_t numBlocks, float *scratch)
+{
+    int16_t samples[2U * DPC_OBJDET_BFP_MAX_BLOCK_SAMPLES];
+    uint32_t mantissaBW = DPC_ObjDet_bfpMantissaBW(tune->wordsCur, tune->samplesPerBlock, tune->decrImagBitw);
+    uint32_t numSampled = (tune->blocksPerFrame < numBlocks) ? tune->blocksPerFrame : numBlocks;
+    uint32_t block, i, j;
+
+    if ((tune->enabled == 0U) || (numSampled == 0U))
+    {
+        return;
+    }
+
+    for (i = 0; i < numSampled; i++)
+    {
+        uint32_t scaleFac;
+        uint32_t width = 1U;
+        float power = 0.0F;
+
+        tune->seed = (tune->seed * 1664525U) + 1013904223U;
+        block = (uint32_t)(((uint64_t)tune->seed * numBlocks) >> 32);
+        scaleFac = DPC_ObjDet_bfpUnpackBlock(&cube[block * tune->wordsCur], tune->samplesPerBlock,
+                                             mantissaBW, tune->decrImagBitw, samples);
+
+        for (j = 0; j < 2U * tune->samplesPerBlock; j++)
+        {
+            uint32_t w = DPC_ObjDet_bfpBitWidth(samples[j]);
+            width = (w > width) ? w : width;
+            power += (float)samples[j] * (float)samples[j];
+        }
+        /* a shifted block fills the mantissas, its width is exact */
+        if (scaleFac != 0U)
+        {
+            width = scaleFac + mantissaBW - tune->decrImagBitw;
+        }
+        tune->widthHist[(width < DPC_OBJDET_BFP_NUM_WIDTHS) ? width : (DPC_OBJDET_BFP_NUM_WIDTHS - 1U)]++;
+
+        /* insertion sort for the median */
+        power /= (float)tune->samplesPerBlock;
+        for (j = i; (j > 0U) && (scratch[j - 1U] > power); j--)
+        {
+            scratch[j] = scratch[j - 1U];
+        }
+        scratch[j] = power;
+    }
+    tune->noiseFloorSum += scratch[numSampled / 2U];
+    tune->numFrames++;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Picks the ratio for the next frames once framesPerDecision frames are
+ *     sampled. The lowest ratio within the budget is taken right away when
+ *     it is higher than the current one, a lower one only one word at a
+ *     time and only when the next word down is within the budget minus the
+ *     hysteresis.
+ *
+ *  @param[in]  tune     Tuner
+ *
+ *  @retval   Words per block for the next frames, changed when not wordsCur
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_bfpTuneDecide(DPC_ObjDet_BfpTune *tune)
+{
+    uint32_t numBlocks = 0U;
+    uint32_t target, words, width;
+    float noiseFloor;
+
+    if ((tune->enabled == 0U) || (tune->numFrames < tune->framesPerDecision))
+    {
+        return tune->wordsCur;
+    }
+    for (width = 0; width < DPC_OBJDET_BFP_NUM_WIDTHS; width++)
+    {
+        numBlocks += tune->widthHist[width];
+    }
+
+    /* at least one LSB, a cube of zeros says nothing */
+    noiseFloor = tune->noiseFloorSum / (float)tune->numFrames;
+    noiseFloor = (noiseFloor > 1.0F) ? noiseFloor : 1.0F;
+
+    target = tune->wordsMax;
+    for (words = tune->wordsMin; words < tune->wordsMax; words++)
+    {
+        if (DPC_ObjDet_bfpTuneQuantNoise(tune, words) <= (tune->lossBudget * noiseFloor * (float)numBlocks))
+        {
+            target = words;
+            break;
+        }
+    }
+
+    words = tune->wordsCur;
+    if (target > words)
+    {
+        words = target;
+    }
+    else if ((target < words) &&
+             (DPC_ObjDet_bfpTuneQuantNoise(tune, words - 1U) <= (tune->stepDownBudget * noiseFloor * (float)numBlocks)))
+    {
+        words--;
+    }
+    if (words != tune->wordsCur)
+    {
+        tune->wordsCur = (uint16_t)words;
+        tune->numChanges++;
+    }
+
+    tune->noiseFloor = noiseFloor;
+    tune->lossDb = 10.0F * log10f(1.0F + (DPC_ObjDet_bfpTuneQuantNoise(tune, words) / (noiseFloor * (float)numBlocks)));
+    tune->numDecisions++;
+    tune->numFrames = 0U;
+    tune->noiseFloorSum = 0.0F;
+    (void)memset((void *)tune->widthHist, 0, sizeof(tune->widthHist));
+    return words;
+}
+
+#endif /* DPC_BFP_H */
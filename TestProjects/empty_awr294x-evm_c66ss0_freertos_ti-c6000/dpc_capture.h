@@ -0,0 +1,428 @@
+/*
+ *   @file  dpc_capture.h
+ *
+ *   @brief
+ *      Frame capture of the object detection DPC, and its replay.
+ *
+ *      A capture is one buffer that is also the file: a header with the
+ *      configuration of every sub-frame, then one record per frame. A
+ *      record holds sections, each one of the buffers the DPC went through
+ *      for that frame: the radar cube after the range FFT, the Doppler and
+ *      range CFAR lists the HWA handed over, the detections the
+ *      intersection kept and the point cloud. The DSP records into a buffer
+ *      at the end of L3 and the debugger saves the first usedSize bytes of
+ *      it. For a replay the debugger loads a capture there, the DSP puts the
+ *      recorded radar cube in place of the one of the range FFT and compares
+ *      every list of the frame with the recorded one. HostTools/dpc_sim.c
+ *      replays the lists of a capture through the intersection and the AoA
+ *      on a PC. Nothing here needs the SDK, dpc_sim builds it too.
+ *
+ *      Everything is in the byte order of the DSP and the PC, little
+ *      endian. A reader refuses a capture of another version, or whose
+ *      element sizes are not its own.
+ */
+
+#ifndef DPC_CAPTURE_H
+#define DPC_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*! @brief  "DPCR" */
+#define DPC_OBJDET_CAPTURE_MAGIC            (0x52435044U)
+
+/*! @brief  Version of the layout below, bumped on any change to it */
+#define DPC_OBJDET_CAPTURE_VERSION          (1U)
+
+/*! @brief  Sub-frames the header describes, RL_MAX_SUBFRAMES */
+#define DPC_OBJDET_CAPTURE_MAX_SUBFRAMES    (4U)
+
+/*! @brief  Virtual antennas the header describes, MAX_NUM_VIRT_ANT */
+#define DPC_OBJDET_CAPTURE_MAX_VIRT_ANT     (16U)
+
+/*! @brief  Records and sections start on 8 bytes */
+#define DPC_OBJDET_CAPTURE_ALIGN            (8U)
+
+/* Sections of a record, and the bits of DPC_ObjDet_CaptureHdr::sections */
+#define DPC_OBJDET_CAPTURE_SEC_RADAR_CUBE   (0U)    /*!< radar cube after the range FFT, bytes */
+#define DPC_OBJDET_CAPTURE_SEC_DOP_LIST     (1U)    /*!< Doppler DPU detections, DetObjParams */
+#define DPC_OBJDET_CAPTURE_SEC_RCFAR_LIST   (2U)    /*!< range CFAR detections, RangeCfarListObj */
+#define DPC_OBJDET_CAPTURE_SEC_RCFAR_PERDOP (3U)    /*!< cumulative range CFAR count per sub bin, uint16_t */
+#define DPC_OBJDET_CAPTURE_SEC_FINAL_LIST   (4U)    /*!< detections the intersection kept, DetObjParams */
+#define DPC_OBJDET_CAPTURE_SEC_POINTS       (5U)    /*!< point cloud, DPIF_PointCloudCartesian */
+#define DPC_OBJDET_CAPTURE_SEC_SIDE_INFO    (6U)    /*!< point cloud side info, DPIF_PointCloudSideInfo */
+#define DPC_OBJDET_CAPTURE_NUM_SECS         (7U)
+
+/*! @brief  Everything but the radar cube, what dpc_sim needs */
+#define DPC_OBJDET_CAPTURE_SECS_LISTS       (0x7EU)
+
+/*! @brief  Configuration of one sub-frame, what the host needs to run the
+ *          intersection and the AoA and to know the radar cube */
+typedef struct DPC_ObjDet_CaptureSubFrame_t
+{
+    uint32_t radarCubeSize;     /*!< bytes of the radar cube */
+    uint16_t numRangeBins;
+    uint16_t numDopplerBins;
+    uint16_t numSubBins;        /*!< Doppler bins of the range CFAR list, chirps / bands */
+    uint16_t numAzimFFTBins;
+    uint16_t numRxAntennas;
+    uint16_t numVirtualAntennas;
+    uint16_t finalMaxNumDetObjs; /*!< detections the intersection keeps at most */
+    uint8_t  rangeCfarEnabled;
+    uint8_t  compressed;        /*!< radar cube is BFP compressed */
+    float    compressionRatio;
+    float    rangeStep;
+    float    dopplerStep;
+    float    fov[4];            /*!< ObjDetFovAoaSinVal: min, max azimuth, min, max elevation */
+} DPC_ObjDet_CaptureSubFrame;
+
+/*! @brief  Start of a capture */
+typedef struct DPC_ObjDet_CaptureHdr_t
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t hdrSize;           /*!< the first record starts here */
+    uint32_t size;              /*!< bytes of the buffer */
+    uint32_t usedSize;          /*!< bytes of the header and the records, what the file holds */
+    uint32_t numRecords;
+    uint32_t numDropped;        /*!< frames that did not fit */
+    uint32_t sections;          /*!< sections recorded, a bit each */
+    uint16_t detObjSize;        /*!< sizeof(DetObjParams) */
+    uint16_t rangeCfarObjSize;  /*!< sizeof(RangeCfarListObj) */
+    uint16_t pointSize;         /*!< sizeof(DPIF_PointCloudCartesian) */
+    uint16_t sideInfoSize;      /*!< sizeof(DPIF_PointCloudSideInfo) */
+    uint16_t numSubFrames;
+    uint16_t pipelinedAoa;      /*!< points came one frame later */
+
+    /* Common configuration, as in the DPC's commonCfg */
+    uint64_t zeroInsrtMaskAzim;
+    uint64_t zeroInsrtMaskElev;
+    float    xSpacingByLambda;
+    float    zSpacingByLambda;
+    uint16_t antennaGeometryCfg[DPC_OBJDET_CAPTURE_MAX_VIRT_ANT];
+    float    antennaCalibParams[2U * DPC_OBJDET_CAPTURE_MAX_VIRT_ANT];
+
+    DPC_ObjDet_CaptureSubFrame subFrame[DPC_OBJDET_CAPTURE_MAX_SUBFRAMES];
+} DPC_ObjDet_CaptureHdr;
+
+/*! @brief  Start of the record of one frame, its sections follow */
+typedef struct DPC_ObjDet_CaptureRec_t
+{
+    uint32_t recSize;           /*!< bytes of the record with its sections */
+    uint32_t frameIdx;          /*!< frames since the capture started */
+    uint8_t  subFrameIdx;
+    uint8_t  numSections;
+    uint16_t sections;          /*!< sections in the record, a bit each */
+    uint32_t reserved;          /*!< keeps the sections on 8 bytes */
+} DPC_ObjDet_CaptureRec;
+
+/*! @brief  Start of one section, count elements of elemSize bytes follow */
+typedef struct DPC_ObjDet_CaptureSec_t
+{
+    uint16_t type;              /*!< DPC_OBJDET_CAPTURE_SEC_xxx */
+    uint16_t elemSize;
+    uint32_t count;
+} DPC_ObjDet_CaptureSec;
+
+/*! @brief  Outcome of a replay */
+typedef struct DPC_ObjDet_CaptureStats_t
+{
+    uint32_t numFrames;         /*!< frames replayed */
+    uint32_t numSkipped;        /*!< frames of another sub-frame or radar cube size */
+    uint32_t numWraps;          /*!< times the replay went back to the first record */
+    uint32_t numMismatched;     /*!< frames with at least one section that differs */
+    uint32_t firstMismatchFrame; /*!< frameIdx of the first of those */
+    uint32_t secMismatches[DPC_OBJDET_CAPTURE_NUM_SECS]; /*!< differing sections by type */
+} DPC_ObjDet_CaptureStats;
+
+/**
+ *  @b Description
+ *  @n
+ *     Rounds a size up to DPC_OBJDET_CAPTURE_ALIGN.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_captureAlign(uint32_t size)
+{
+    return (size + DPC_OBJDET_CAPTURE_ALIGN - 1U) & ~(DPC_OBJDET_CAPTURE_ALIGN - 1U);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Starts an empty capture in buf. The configuration in the header is
+ *     filled in by the caller.
+ *
+ *  @param[in]  buf         Buffer, 8 byte aligned
+ *  @param[in]  size        Bytes of buf
+ *  @param[in]  sections    Sections to record, a bit each
+ *
+ *  @retval   The header, NULL when buf does not hold it
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline DPC_ObjDet_CaptureHdr *DPC_ObjDet_captureInit(void *buf, uint32_t size, uint32_t sections)
+{
+    DPC_ObjDet_CaptureHdr *hdr = (DPC_ObjDet_CaptureHdr *)buf;
+
+    if ((buf == NULL) || (size < DPC_ObjDet_captureAlign((uint32_t)sizeof(*hdr))))
+    {
+        return NULL;
+    }
+    (void)memset(hdr, 0, sizeof(*hdr));
+    hdr->magic    = DPC_OBJDET_CAPTURE_MAGIC;
+    hdr->version  = (uint16_t)DPC_OBJDET_CAPTURE_VERSION;
+    hdr->hdrSize  = (uint16_t)DPC_ObjDet_captureAlign((uint32_t)sizeof(*hdr));
+    hdr->size     = size;
+    hdr->usedSize = hdr->hdrSize;
+    hdr->sections = sections;
+    return hdr;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Starts the record of a frame after the last whole one. A record that
+ *     was started and not ended is dropped.
+ *
+ *  @retval   The record, NULL when not even its start fits
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline DPC_ObjDet_CaptureRec *DPC_ObjDet_captureBegin(DPC_ObjDet_CaptureHdr *hdr, uint32_t frameIdx,
+                                                             uint8_t subFrameIdx)
+{
+    DPC_ObjDet_CaptureRec *rec;
+
+    if ((hdr->size - hdr->usedSize) < (uint32_t)sizeof(*rec))
+    {
+        hdr->numDropped++;
+        return NULL;
+    }
+    rec = (DPC_ObjDet_CaptureRec *)((uint8_t *)hdr + hdr->usedSize);
+    rec->recSize     = (uint32_t)sizeof(*rec);
+    rec->frameIdx    = frameIdx;
+    rec->subFrameIdx = subFrameIdx;
+    rec->numSections = 0U;
+    rec->sections    = 0U;
+    rec->reserved    = 0U;
+    return rec;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Appends a section to a record, when the header asks for it.
+ *
+ *  @param[in]  hdr         Capture
+ *  @param[in]  rec         Record from DPC_ObjDet_captureBegin, NULL when it was dropped
+ *  @param[in]  type        DPC_OBJDET_CAPTURE_SEC_xxx
+ *  @param[in]  data        Elements
+ *  @param[in]  count       Number of elements
+ *  @param[in]  elemSize    Bytes of an element
+ *
+ *  @retval   The record, NULL when the section does not fit and the
+ *            record is dropped
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline DPC_ObjDet_CaptureRec *DPC_ObjDet_captureAdd(DPC_ObjDet_CaptureHdr *hdr, DPC_ObjDet_CaptureRec *rec,
+                                                           uint32_t type, const void *data, uint32_t count,
+                                                           uint32_t elemSize)
+{
+    DPC_ObjDet_CaptureSec *sec;
+    uint32_t bytes = count * elemSize;
+    uint32_t room;
+
+    if ((rec == NULL) || ((hdr->sections & (1U << type)) == 0U))
+    {
+        return rec;
+    }
+    room = hdr->size - hdr->usedSize - rec->recSize;
+    if ((room < (uint32_t)sizeof(*sec)) || ((room - (uint32_t)sizeof(*sec)) < DPC_ObjDet_captureAlign(bytes)))
+    {
+        hdr->numDropped++;
+        return NULL;
+    }
+    sec = (DPC_ObjDet_CaptureSec *)((uint8_t *)rec + rec->recSize);
+    sec->type     = (uint16_t)type;
+    sec->elemSize = (uint16_t)elemSize;
+    sec->count    = count;
+    (void)memcpy(sec + 1, data, bytes);
+    rec->recSize += (uint32_t)sizeof(*sec) + DPC_ObjDet_captureAlign(bytes);
+    rec->numSections++;
+    rec->sections |= (uint16_t)(1U << type);
+    return rec;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Ends a record, it is then part of the capture.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_captureEnd(DPC_ObjDet_CaptureHdr *hdr, DPC_ObjDet_CaptureRec *rec)
+{
+    if (rec != NULL)
+    {
+        hdr->usedSize += rec->recSize;
+        hdr->numRecords++;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Checks a capture that was loaded into a buffer or read from a file
+ *     before it is replayed: version, element sizes, and that the records
+ *     fit in it.
+ *
+ *  @param[in]  buf          Capture
+ *  @param[in]  size         Bytes of buf
+ *  @param[in]  detObjSize   sizeof(DetObjParams) of the reader, the others likewise
+ *
+ *  @retval   The header, NULL when buf does not hold a capture this reader can replay
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline const DPC_ObjDet_CaptureHdr *DPC_ObjDet_captureCheck(const void *buf, uint32_t size,
+                                                                   uint32_t detObjSize, uint32_t rangeCfarObjSize,
+                                                                   uint32_t pointSize, uint32_t sideInfoSize)
+{
+    const DPC_ObjDet_CaptureHdr *hdr = (const DPC_ObjDet_CaptureHdr *)buf;
+
+    if ((buf == NULL) || (size < (uint32_t)sizeof(*hdr)) ||
+        (hdr->magic != DPC_OBJDET_CAPTURE_MAGIC) || (hdr->version != DPC_OBJDET_CAPTURE_VERSION) ||
+        (hdr->hdrSize < (uint32_t)sizeof(*hdr)) || (hdr->usedSize < hdr->hdrSize) || (hdr->usedSize > size) ||
+        (hdr->detObjSize != detObjSize) || (hdr->rangeCfarObjSize != rangeCfarObjSize) ||
+        (hdr->pointSize != pointSize) || (hdr->sideInfoSize != sideInfoSize) ||
+        (hdr->numSubFrames == 0U) || (hdr->numSubFrames > DPC_OBJDET_CAPTURE_MAX_SUBFRAMES))
+    {
+        return NULL;
+    }
+    return hdr;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the record after prev, or the first one when prev is NULL.
+ *
+ *  @retval   The record, NULL after the last one or when the next one does
+ *            not hold together
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline const DPC_ObjDet_CaptureRec *DPC_ObjDet_captureNext(const DPC_ObjDet_CaptureHdr *hdr,
+                                                                  const DPC_ObjDet_CaptureRec *prev)
+{
+    const DPC_ObjDet_CaptureRec *rec;
+    uint32_t offset, left;
+
+    offset = (prev == NULL) ? (uint32_t)hdr->hdrSize :
+             (uint32_t)((const uint8_t *)prev - (const uint8_t *)hdr) + prev->recSize;
+    left = hdr->usedSize - offset;
+    if ((offset >= hdr->usedSize) || (left < (uint32_t)sizeof(*rec)))
+    {
+        return NULL;
+    }
+    rec = (const DPC_ObjDet_CaptureRec *)((const uint8_t *)hdr + offset);
+    if ((rec->recSize < (uint32_t)sizeof(*rec)) || (rec->recSize > left) ||
+        ((rec->recSize & (DPC_OBJDET_CAPTURE_ALIGN - 1U)) != 0U))
+    {
+        return NULL;
+    }
+    return rec;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns a section of a record.
+ *
+ *  @retval   The section, its elements follow it, NULL when the record does not have it
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline const DPC_ObjDet_CaptureSec *DPC_ObjDet_captureFind(const DPC_ObjDet_CaptureRec *rec, uint32_t type)
+{
+    const uint8_t *pos = (const uint8_t *)(rec + 1);
+    const uint8_t *end = (const uint8_t *)rec + rec->recSize;
+    const DPC_ObjDet_CaptureSec *sec;
+    uint32_t bytes;
+
+    while ((uint32_t)(end - pos) >= (uint32_t)sizeof(*sec))
+    {
+        sec = (const DPC_ObjDet_CaptureSec *)pos;
+        bytes = DPC_ObjDet_captureAlign(sec->count * (uint32_t)sec->elemSize);
+        if ((uint32_t)(end - pos) - (uint32_t)sizeof(*sec) < bytes)
+        {
+            break;
+        }
+        if (sec->type == type)
+        {
+            return sec;
+        }
+        pos += sizeof(*sec) + bytes;
+    }
+    return NULL;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Compares a buffer of the replayed frame with the recorded section and
+ *     counts it in the stats when they differ. A section that was not
+ *     recorded is not compared.
+ *
+ *  @retval   1 when they differ, 0 otherwise
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_captureCompare(DPC_ObjDet_CaptureStats *stats, const DPC_ObjDet_CaptureRec *rec,
+                                                 uint32_t type, const void *data, uint32_t count, uint32_t elemSize)
+{
+    const DPC_ObjDet_CaptureSec *sec;
+
+    if ((rec == NULL) || ((rec->sections & (1U << type)) == 0U))
+    {
+        return 0U;
+    }
+    sec = DPC_ObjDet_captureFind(rec, type);
+    if ((sec != NULL) && (sec->count == count) && (sec->elemSize == elemSize) &&
+        (memcmp(sec + 1, data, count * elemSize) == 0))
+    {
+        return 0U;
+    }
+    stats->secMismatches[type]++;
+    return 1U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Ends the comparison of a replayed frame.
+ *
+ *  @param[in]  stats       Replay stats
+ *  @param[in]  rec         Record of the frame
+ *  @param[in]  numDiffer   Sections of it that differed
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_captureFrameDone(DPC_ObjDet_CaptureStats *stats, const DPC_ObjDet_CaptureRec *rec,
+                                               uint32_t numDiffer)
+{
+    if (numDiffer != 0U)
+    {
+        if (stats->numMismatched == 0U)
+        {
+            stats->firstMismatchFrame = rec->frameIdx;
+        }
+        stats->numMismatched++;
+    }
+    stats->numFrames++;
+}
+
+#endif /* DPC_CAPTURE_H */
@@ -0,0 +1,173 @@
+/*
+ *   @file  dpc_mem_map.h
+ *
+ *   @brief
+ *      Memory map of the object detection DPC.
+ *
+ *      Every buffer the DPC hands out while it configures a sub-frame is
+ *      written down here: its name, the DPU it is for, the pool it came
+ *      from, where in the pool it sits, its size and how many bytes were
+ *      skipped to align it. An allocation that does not fit is written down
+ *      too, so the map of a failed configuration shows which buffer was too
+ *      big and by how much. DSP.c publishes the maps in HSRAM and the MSS
+ *      CLI command memMap prints them. Nothing here needs the SDK,
+ *      HostTools/dpc_sim.c builds it too.
+ */
+
+#ifndef DPC_MEM_MAP_H
+#define DPC_MEM_MAP_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*! @brief  Sub-frames with a map, same as RL_MAX_SUBFRAMES */
+#define DPC_OBJDET_MEMMAP_MAX_SUBFRAMES     (4U)
+
+/*! @brief  Buffers per sub-frame map, the DDM chain hands out about 25 */
+#define DPC_OBJDET_MEMMAP_MAX_ENTRIES       (32U)
+
+/*! @brief  Characters of a buffer name, including the terminating 0 */
+#define DPC_OBJDET_MEMMAP_NAME_LEN          (12U)
+
+/*! @brief  Offset of an allocation that did not fit in its pool */
+#define DPC_OBJDET_MEMMAP_NO_FIT            (0xFFFFFFFFU)
+
+/*! @brief  Pools the DPC allocates from */
+typedef enum DPC_ObjDet_MemMapPoolId_e
+{
+    DPC_OBJDET_MEMMAP_POOL_L3 = 0,      /*!< gMmwL3 */
+    DPC_OBJDET_MEMMAP_POOL_L2,          /*!< gDPC_ObjDetL2Heap */
+    DPC_OBJDET_MEMMAP_POOL_WINBUF,      /*!< gWinBuf, the FFT windows */
+    DPC_OBJDET_MEMMAP_POOL_PREPROC,     /*!< preProcBuffer, range DPU estimates of all sub-frames */
+    DPC_OBJDET_MEMMAP_POOL_HWA_WINRAM,  /*!< HWA window RAM, in coefficients */
+    DPC_OBJDET_MEMMAP_POOL_HWA_PARAMSET,/*!< HWA param sets, in param sets */
+    DPC_OBJDET_MEMMAP_POOL_MAX
+} DPC_ObjDet_MemMapPoolId;
+
+/*! @brief  What a buffer is for */
+typedef enum DPC_ObjDet_MemMapOwner_e
+{
+    DPC_OBJDET_MEMMAP_OWNER_DPC = 0,    /*!< the DPC itself, shared by the DPUs */
+    DPC_OBJDET_MEMMAP_OWNER_RANGE,      /*!< range DPU */
+    DPC_OBJDET_MEMMAP_OWNER_DOPPLER,    /*!< Doppler DPU */
+    DPC_OBJDET_MEMMAP_OWNER_RANGE_CFAR, /*!< range CFAR DPU */
+    DPC_OBJDET_MEMMAP_OWNER_AOA,        /*!< AoA after the intersection */
+    DPC_OBJDET_MEMMAP_OWNER_MAX
+} DPC_ObjDet_MemMapOwner;
+
+/*! @brief  One buffer, 24 bytes */
+typedef struct DPC_ObjDet_MemMapEntry_t
+{
+    char     name[DPC_OBJDET_MEMMAP_NAME_LEN];
+    uint32_t offset;         /*!< from the pool start, DPC_OBJDET_MEMMAP_NO_FIT if it did not fit */
+    uint32_t size;           /*!< requested size */
+    uint16_t alignWaste;     /*!< bytes skipped in front of it for the alignment */
+    uint8_t  pool;           /*!< DPC_ObjDet_MemMapPoolId */
+    uint8_t  owner;          /*!< DPC_ObjDet_MemMapOwner */
+} DPC_ObjDet_MemMapEntry;
+
+/*! @brief  Size of a pool and how much of it the sub-frame uses */
+typedef struct DPC_ObjDet_MemMapPool_t
+{
+    uint32_t size;           /*!< pool size */
+    uint32_t highWater;      /*!< end of the last byte used by the sub-frame's buffers */
+    uint32_t alignWaste;     /*!< bytes lost to alignment */
+} DPC_ObjDet_MemMapPool;
+
+/*! @brief  Memory map of one sub-frame */
+typedef struct DPC_ObjDet_MemMap_t
+{
+    uint32_t numEntries;     /*!< valid entries in entry[] */
+    uint32_t numDropped;     /*!< buffers that did not fit in entry[] */
+    uint32_t numNoFit;       /*!< allocations that failed */
+    uint32_t valid;          /*!< 1 once the sub-frame was configured */
+    DPC_ObjDet_MemMapPool  pool[DPC_OBJDET_MEMMAP_POOL_MAX];
+    DPC_ObjDet_MemMapEntry entry[DPC_OBJDET_MEMMAP_MAX_ENTRIES];
+} DPC_ObjDet_MemMap;
+
+/* Maps of the sub-frames, defined by objectdetection.c on the DSP */
+extern DPC_ObjDet_MemMap gDpcMemMap[DPC_OBJDET_MEMMAP_MAX_SUBFRAMES];
+
+/**
+ *  @b Description
+ *  @n
+ *     Empties a map before its sub-frame is configured.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_memMapReset(DPC_ObjDet_MemMap *map)
+{
+    (void)memset((void *)map, 0, sizeof(DPC_ObjDet_MemMap));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Sets the size of a pool.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_memMapSetPool(DPC_ObjDet_MemMap *map, uint32_t pool, uint32_t size)
+{
+    if (map != NULL)
+    {
+        map->pool[pool].size = size;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Writes a buffer into the map. The pool usage counts it even when
+ *     entry[] is full. Nothing happens for a NULL map.
+ *
+ *  @param[in]  map        Map of the sub-frame being configured
+ *  @param[in]  pool       DPC_ObjDet_MemMapPoolId
+ *  @param[in]  owner      DPC_ObjDet_MemMapOwner
+ *  @param[in]  name       Buffer name, cut to DPC_OBJDET_MEMMAP_NAME_LEN - 1
+ *  @param[in]  offset     Offset in the pool or DPC_OBJDET_MEMMAP_NO_FIT
+ *  @param[in]  size       Size in the units of the pool
+ *  @param[in]  alignWaste Bytes skipped in front of the buffer
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_memMapAdd(DPC_ObjDet_MemMap *map, uint32_t pool, uint32_t owner,
+                                        const char *name, uint32_t offset, uint32_t size,
+                                        uint32_t alignWaste)
+{
+    DPC_ObjDet_MemMapEntry *entry;
+
+    if (map == NULL)
+    {
+        return;
+    }
+
+    if (offset == DPC_OBJDET_MEMMAP_NO_FIT)
+    {
+        map->numNoFit++;
+    }
+    else
+    {
+        if ((offset + size) > map->pool[pool].highWater)
+        {
+            map->pool[pool].highWater = offset + size;
+        }
+        map->pool[pool].alignWaste += alignWaste;
+    }
+
+    if (map->numEntries == DPC_OBJDET_MEMMAP_MAX_ENTRIES)
+    {
+        map->numDropped++;
+        return;
+    }
+    entry = &map->entry[map->numEntries++];
+    (void)strncpy(entry->name, name, DPC_OBJDET_MEMMAP_NAME_LEN - 1U);
+    entry->name[DPC_OBJDET_MEMMAP_NAME_LEN - 1U] = '\0';
+    entry->offset = offset;
+    entry->size = size;
+    entry->alignWaste = (uint16_t)alignWaste;
+    entry->pool = (uint8_t)pool;
+    entry->owner = (uint8_t)owner;
+}
+
+#endif /* DPC_MEM_MAP_H */
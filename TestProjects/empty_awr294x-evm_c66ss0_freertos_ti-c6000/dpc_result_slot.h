@@ -0,0 +1,108 @@
+/*
+ *   @file  dpc_result_slot.h
+ *
+ *   @brief
+ *      Result slots the object detection DPC writes its point cloud into.
+ *
+ *      DSP.c hands the DPC a slot in HSRAM at the start of every frame
+ *      through gDpcResultSlot, the AoA writes the point cloud there instead
+ *      of into its own L3 buffer, and the MSS sends it from there. Frames
+ *      are numbered from 1 and frame seq goes into slot seq % numSlots, so
+ *      a slot is free again once the MSS has released the frame that was
+ *      numSlots before. A frame whose slot the MSS still holds gets none,
+ *      the DPC writes it into its own buffers and it is dropped. Nothing
+ *      here needs the SDK, HostTools/dpc_sim.c builds it too.
+ */
+
+#ifndef DPC_RESULT_SLOT_H
+#define DPC_RESULT_SLOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*! @brief  Where the DPC puts the point cloud of the frame being processed */
+typedef struct DPC_ObjDet_ResultSlot_t
+{
+    void     *objOut;         /*!< DPIF_PointCloudCartesian[maxNumObjOut], NULL for the DPC's own */
+    void     *objOutSideInfo; /*!< DPIF_PointCloudSideInfo[maxNumObjOut] */
+    uint32_t maxNumObjOut;    /*!< points that fit */
+    uint32_t numClamped;      /*!< frames that had more detections than that */
+    uint32_t numBusy;         /*!< frames dropped because the reader still had their slot */
+} DPC_ObjDet_ResultSlot;
+
+/* Slot of the frame being processed, defined by objectdetection.c on the DSP
+ * and set by DSP.c from the frame start callback */
+extern DPC_ObjDet_ResultSlot gDpcResultSlot;
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the slot of a frame.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_resultSlotIdx(uint32_t seq, uint32_t numSlots)
+{
+    return seq % numSlots;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Checks that the reader is done with the frame that was in the slot of
+ *     frame seq before. Works across the wrap of the sequence numbers.
+ *
+ *  @param[in]  seq          Frame about to be written
+ *  @param[in]  releasedSeq  Last frame the reader is done with
+ *  @param[in]  numSlots     Slots
+ *
+ *  @retval   1 when the slot can be written, 0 when the reader still has it
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_resultSlotFree(uint32_t seq, uint32_t releasedSeq, uint32_t numSlots)
+{
+    return ((uint32_t)(seq - releasedSeq) <= numSlots) ? 1U : 0U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Hands the DPC no slot for a frame whose slot the reader still has,
+ *     so the point cloud goes into the DPC's own buffers, and counts it.
+ *
+ *  @param[in]  slot        Slot of the frame
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_resultSlotSkip(DPC_ObjDet_ResultSlot *slot)
+{
+    slot->objOut         = NULL;
+    slot->objOutSideInfo = NULL;
+    slot->maxNumObjOut   = 0U;
+    slot->numBusy++;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Limits the detections going into the AoA to what the slot holds.
+ *
+ *  @param[in]  slot        Slot of the frame, objOut NULL when there is none
+ *  @param[in]  numDetObjs  Detections of the frame
+ *
+ *  @retval   Detections to run the AoA on
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_resultSlotClamp(DPC_ObjDet_ResultSlot *slot, uint32_t numDetObjs)
+{
+    if ((slot->objOut != NULL) && (numDetObjs > slot->maxNumObjOut))
+    {
+        slot->numClamped++;
+        return slot->maxNumObjOut;
+    }
+    return numDetObjs;
+}
+
+#endif /* DPC_RESULT_SLOT_H */
@@ -0,0 +1,205 @@
+/*
+ *   @file  dpc_stage_timing.h
+ *
+ *   @brief
+ *      Per stage timing of the object detection DPC.
+ *
+ *      objectdetection.c stamps the cycle counter at the end of every stage
+ *      into gDpcStageTimes, DSP.c turns the stamps into stage durations and
+ *      collects them in one histogram per stage. The histograms have 8 bins
+ *      per power of two, so a percentile read from one is at most 12.5%
+ *      above the real value, and cost a count, a compare and an add per
+ *      stage and frame. Nothing here needs the SDK, HostTools/dpc_sim.c
+ *      builds it too.
+ */
+
+#ifndef DPC_STAGE_TIMING_H
+#define DPC_STAGE_TIMING_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*! @brief  Histogram bins: values below 8 cycles get one bin each, every
+ *          power of two above gets DPC_STAGE_HIST_SUB_BINS */
+#define DPC_STAGE_HIST_SUB_BITS     (3U)
+#define DPC_STAGE_HIST_SUB_BINS     (1U << DPC_STAGE_HIST_SUB_BITS)
+#define DPC_STAGE_HIST_NUM_BINS     ((32U - DPC_STAGE_HIST_SUB_BITS + 1U) * DPC_STAGE_HIST_SUB_BINS)
+
+/*! @brief  Cycle counter values taken by one call of DPC_ObjectDetection_execute.
+ *          With the pipelined AoA the aoa stamps are for the previous frame,
+ *          whose point cloud is what this call returns. */
+typedef struct DPC_ObjDet_StageTimes_t
+{
+    uint32_t executeStart;   /*!< execute entered, right after frame start */
+    uint32_t aoaStart;       /*!< AoA started */
+    uint32_t aoaEnd;         /*!< AoA done */
+    uint32_t rangeEnd;       /*!< range FFT of this frame done */
+    uint32_t dopplerEnd;     /*!< Doppler DPU done */
+    uint32_t rangeCfarEnd;   /*!< range CFAR done */
+    uint32_t intersectEnd;   /*!< kept detections are in L2 */
+    uint32_t resultEnd;      /*!< DPM result filled in */
+    uint32_t numDetObjs;     /*!< detections that went into the AoA */
+    uint8_t  pipelined;      /*!< 1 when the AoA ran ahead of the range FFT wait */
+} DPC_ObjDet_StageTimes;
+
+/* Stage times of the last execute call, defined by objectdetection.c on the DSP */
+extern DPC_ObjDet_StageTimes gDpcStageTimes;
+
+/*! @brief  Cycle distribution of one stage */
+typedef struct DPC_ObjDet_StageHist_t
+{
+    uint32_t count;          /*!< samples since the last reset */
+    uint32_t minCycles;      /*!< shortest sample */
+    uint32_t maxCycles;      /*!< longest sample */
+    uint64_t sumCycles;      /*!< sum of all samples, for the mean */
+    uint16_t bin[DPC_STAGE_HIST_NUM_BINS]; /*!< samples per bin */
+} DPC_ObjDet_StageHist;
+
+/*! @brief  What a histogram is boiled down to for the host */
+typedef struct DPC_ObjDet_StageSummary_t
+{
+    uint32_t minCycles;
+    uint32_t meanCycles;
+    uint32_t p99Cycles;      /*!< upper edge of the bin holding the 99th percentile */
+    uint32_t maxCycles;
+} DPC_ObjDet_StageSummary;
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the position of the highest set bit of a non zero value.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_msb(uint32_t value)
+{
+#if defined(_TMS320C6600) && !defined(OBJDET_HOST_SIM)
+    return 31U - _lmbd(1U, value);
+#else
+    return 31U - (uint32_t)__builtin_clz(value);
+#endif
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the histogram bin of a cycle count. The bin is the position
+ *     of the highest set bit followed by the next DPC_STAGE_HIST_SUB_BITS
+ *     bits, counts below 8 are their own bin.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_stageHistBin(uint32_t cycles)
+{
+    uint32_t msb;
+
+    if (cycles < DPC_STAGE_HIST_SUB_BINS)
+    {
+        return cycles;
+    }
+    msb = DPC_ObjDet_msb(cycles);
+    return ((msb - DPC_STAGE_HIST_SUB_BITS + 1U) << DPC_STAGE_HIST_SUB_BITS) |
+           ((cycles >> (msb - DPC_STAGE_HIST_SUB_BITS)) & (DPC_STAGE_HIST_SUB_BINS - 1U));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns the largest cycle count that falls into a bin.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_stageHistBinTop(uint32_t bin)
+{
+    uint32_t shift;
+
+    if (bin < DPC_STAGE_HIST_SUB_BINS)
+    {
+        return bin;
+    }
+    shift = (bin >> DPC_STAGE_HIST_SUB_BITS) - 1U;
+    return (uint32_t)(((uint64_t)(DPC_STAGE_HIST_SUB_BINS | (bin & (DPC_STAGE_HIST_SUB_BINS - 1U))) + 1U) << shift) - 1U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Empties a histogram.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_stageHistReset(DPC_ObjDet_StageHist *hist)
+{
+    (void)memset((void *)hist, 0, sizeof(DPC_ObjDet_StageHist));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Adds one stage duration to a histogram. Bins stop counting at 65535,
+ *     reset the histogram before that many samples.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_stageHistAdd(DPC_ObjDet_StageHist *hist, uint32_t cycles)
+{
+    uint32_t bin = DPC_ObjDet_stageHistBin(cycles);
+
+    if ((hist->count == 0U) || (cycles < hist->minCycles))
+    {
+        hist->minCycles = cycles;
+    }
+    if (cycles > hist->maxCycles)
+    {
+        hist->maxCycles = cycles;
+    }
+    hist->count++;
+    hist->sumCycles += cycles;
+    if (hist->bin[bin] != 0xFFFFU)
+    {
+        hist->bin[bin]++;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Boils a histogram down to min, mean, 99th percentile and max. All
+ *     zero for an empty histogram.
+ *
+ *  @param[in]  hist     Histogram
+ *  @param[out] summary  Summary in cycles
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_stageHistSummary(const DPC_ObjDet_StageHist *hist,
+                                               DPC_ObjDet_StageSummary *summary)
+{
+    uint32_t want = (uint32_t)(((uint64_t)hist->count * 99U + 99U) / 100U);
+    uint32_t seen = 0U;
+    uint32_t bin;
+
+    (void)memset((void *)summary, 0, sizeof(DPC_ObjDet_StageSummary));
+    if (hist->count == 0U)
+    {
+        return;
+    }
+
+    summary->minCycles = hist->minCycles;
+    summary->maxCycles = hist->maxCycles;
+    summary->meanCycles = (uint32_t)(hist->sumCycles / hist->count);
+    summary->p99Cycles = hist->maxCycles;
+    for (bin = 0; bin < DPC_STAGE_HIST_NUM_BINS; bin++)
+    {
+        seen += hist->bin[bin];
+        if (seen >= want)
+        {
+            /* the bin edge can be past the largest sample */
+            uint32_t top = DPC_ObjDet_stageHistBinTop(bin);
+            summary->p99Cycles = (top < hist->maxCycles) ? top : hist->maxCycles;
+            break;
+        }
+    }
+}
+
+#endif /* DPC_STAGE_TIMING_H */
@@ -58,7 +58,8 @@
 #include <ti/demo/awr294x/mmw/mmw_resDDM.h>
 #include <ti/datapath/dpc/objectdetection/objdethwaDDMA/objectdetection.h>
 #endif
-#include <ti/demo/awr294x/mmw/include/mmw_output.h>
+/* The MSS project's copy, ExampleProjects/out_of_box_2944_mss/include */
+#include "mmw_output.h"
 
 /* This is used to resolve RL_MAX_SUBFRAMES */
 #include <C:/ti/mmwave_mcuplus_sdk_04_07_01_04/mmwave_dfp_02_04_18_01/ti/control/mmwavelink/mmwavelink.h>
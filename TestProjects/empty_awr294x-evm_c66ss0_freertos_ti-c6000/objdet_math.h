@@ -0,0 +1,1401 @@
+/*
+ *   @file  objdet_math.h
+ *
+ *   @brief
+ *      Object Detection DPC math that does not touch the HWA, EDMA or cache.
+ *
+ *      Everything here used to live inside objectdetection.c. It was pulled
+ *      out so the exact same code can be built on a PC by
+ *      HostTools/dpc_sim.c. On the DSP it is included by objectdetection.c
+ *      after the SDK headers and uses the SDK types and C66x intrinsics.
+ *      When OBJDET_HOST_SIM is defined it brings its own copies of the few
+ *      SDK types it needs (same layout as the DSP build) and plain C in
+ *      place of the intrinsics and mathlib.
+ */
+
+#ifndef OBJDET_MATH_H
+#define OBJDET_MATH_H
+
+#include <stdint.h>
+#include <math.h>
+
+#include "dpc_stage_timing.h"
+#include "dpc_mem_map.h"
+#include "dpc_bfp.h"
+#include "dpc_result_slot.h"
+#include "dpc_capture.h"
+
+/**************************************************************************
+ ************************* Host Stand-ins *********************************
+ **************************************************************************/
+#ifdef OBJDET_HOST_SIM
+
+#define MAX_NUM_AZIM_VIRT_ANT   (12U)
+#define MAX_NUM_ELEV_VIRT_ANT   (4U)
+#define MAX_NUM_VIRT_ANT        (MAX_NUM_AZIM_VIRT_ANT + MAX_NUM_ELEV_VIRT_ANT)
+
+#define CSL_MAX(a, b)           (((a) > (b)) ? (a) : (b))
+#define CSL_MEM_ALIGN(addr, byteAlignment) \
+    ((((uintptr_t)(addr)) + ((uintptr_t)(byteAlignment) - 1U)) & ~((uintptr_t)(byteAlignment) - 1U))
+
+#define PI_                     (3.14159265358979323846f)
+
+#define MATHUTILS_WIN_BLACKMAN  (1U)
+#define MATHUTILS_WIN_HANNING   (2U)
+#define MATHUTILS_WIN_RECT      (3U)
+
+/*! @brief  Complex int32 sample as written by the HWA (cmplx32ImRe_t). */
+typedef struct cmplx32ImRe_t_
+{
+    int32_t imag;
+    int32_t real;
+} cmplx32ImRe_t;
+
+/*! @brief  Point cloud entry (DPIF_PointCloudCartesian). */
+typedef struct DPIF_PointCloudCartesian_t
+{
+    float x;
+    float y;
+    float z;
+    float velocity;
+} DPIF_PointCloudCartesian;
+
+/*! @brief  Point cloud side info (DPIF_PointCloudSideInfo). */
+typedef struct DPIF_PointCloudSideInfo_t
+{
+    int16_t snr;
+    int16_t noise;
+} DPIF_PointCloudSideInfo;
+
+/*! @brief  One Doppler DPU detection, 160 bytes like the DSP build. */
+typedef struct DetObjParams_t
+{
+    cmplx32ImRe_t azimSamples[MAX_NUM_AZIM_VIRT_ANT];
+    cmplx32ImRe_t elevSamples[MAX_NUM_ELEV_VIRT_ANT];
+    uint32_t azimIdx;
+    uint32_t dopIdx;
+    uint32_t rangeIdx;
+    uint32_t dopIdxActual;
+    uint32_t dopCfarNoise;
+    uint32_t azimPeakSamples[3];
+} DetObjParams;
+
+/*! @brief  One range CFAR detection (RangeCfarListObj). */
+typedef struct RangeCfarListObj_t
+{
+    uint32_t dopIdx;
+    uint32_t rangeIdx;
+    uint32_t rangeCFARNoise;
+} RangeCfarListObj;
+
+/*! @brief  Memory pool configuration (DPC_ObjectDetection_MemCfg). */
+typedef struct DPC_ObjectDetection_MemCfg_t
+{
+    void *addr;
+    uint32_t size;
+} DPC_ObjectDetection_MemCfg;
+
+/*! @brief  Memory pool object (MemPoolObj). */
+typedef struct MemPoolObj_t
+{
+    DPC_ObjectDetection_MemCfg cfg;
+    uintptr_t currAddr;
+    uintptr_t maxCurrAddr;
+} MemPoolObj;
+
+/*! @brief  Field of view limits (ObjDetFovAoaSinVal). */
+typedef struct ObjDetFovAoaSinVal_t
+{
+    float minAzimuthSinVal;
+    float maxAzimuthSinVal;
+    float minElevationSinVal;
+    float maxElevationSinVal;
+} ObjDetFovAoaSinVal;
+
+/* Supplied by the host program in place of the mmWave SDK mathutils */
+extern void mathUtils_genWindow(uint32_t *win, uint32_t windowLength, uint32_t winGenLen,
+                                uint32_t winType, uint32_t qFormat);
+
+#endif /* OBJDET_HOST_SIM */
+
+/* mathlib stand-ins for anything that is not the C66x */
+#if !defined(_TMS320C6600) || defined(OBJDET_HOST_SIM)
+#define divsp(a, b)     ((a) / (b))
+#define atan2sp(y, x)   atan2f((y), (x))
+#define sqrtsp(x)       sqrtf(x)
+#endif
+
+/**************************************************************************
+ ************************** Definitions ***********************************
+ **************************************************************************/
+
+#define QVALUE_NOISE          (11U)
+#define QVALUE_SIGNAL         (11U)
+
+#define DPC_USE_SYMMETRIC_WINDOW_RANGE_DPU
+#define DPC_USE_SYMMETRIC_WINDOW_DOPPLER_DPU
+#define DPC_DPU_RANGEPROC_FFT_WINDOW_TYPE                  MATHUTILS_WIN_HANNING
+#define DPC_DPU_RANGEPROC_INTERFMITIG_WINDOW_TYPE          MATHUTILS_WIN_HANNING
+#define DPC_DPU_DOPPLERPROC_FFT_WINDOW_TYPE                MATHUTILS_WIN_HANNING
+
+/*! Number of interference mitigation window samples. Used 16 as the size
+    instead of 14 because mathUtils generates the first and the last samples
+    as 0, which are not useful. */
+#define DPC_OBJDET_RANGEPROC_NUM_INTFMITIG_WIN_SIZE_TOTAL       (16U)
+
+/*! Q Format of interference mitigation window */
+#define DPC_OBJDET_QFORMAT_RANGEPROC_INTERFMITIG_WINDOW         (5U)
+
+#define DPC_OBJDET_QFORMAT_RANGE_FFT 17
+#define DPC_OBJDET_QFORMAT_DOPPLER_FFT 17
+
+/*! @brief  Complex data type, natural for C66x complex
+ * multiplication instructions. */
+typedef struct cmplxfImRe_t_
+{
+    float imag; /*!< @brief imaginary part */
+    float real; /*!< @brief real part */
+} cmplxfImRe_t;
+/*! @brief  Complex union type, natural for C66x intrinsic
+ * instructions. */
+typedef union cmplxfUnion_t_
+{
+	cmplxfImRe_t cmplx;
+	float dat[2];
+	double ddat;
+}cmplxfUnion_t;
+
+/*! @brief  Unsigned round (for floats). */
+#define ROUND_UNSIGNED(x) ((x) + 0.5f)
+#define AOA_DFT_LEN (128)
+
+/* A simple sin-cos LUT used for the DFT computations in
+ * DPC_ObjDet_estimateXYZ, defined by objectdetection.c on the DSP */
+extern cmplxfImRe_t dftSinCosTable[AOA_DFT_LEN];
+
+/*! @brief  Everything DPC_ObjDet_estimateXYZKernel reads from the
+ *  subframe and common configuration. */
+typedef struct DPC_ObjDet_XYZCfg_t
+{
+    /*! @brief  Per virtual antenna [imag, real] calibration, azimuth first */
+    const float *antennaCalibParams;
+
+    /*! @brief  Sample index for each virtual antenna, azimuth first */
+    const uint16_t *antennaGeometryCfg;
+
+    /*! @brief  Positions of the azimuth antennas in the zero inserted row */
+    uint64_t zeroInsrtMaskAzim;
+
+    /*! @brief  Positions of the elevation antennas in the zero inserted row */
+    uint64_t zeroInsrtMaskElev;
+
+    float xSpacingByLambda;
+    float zSpacingByLambda;
+    float rangeStep;
+    float dopplerStep;
+    uint16_t numAzimFFTBins;
+    uint16_t numDopplerBins;
+    ObjDetFovAoaSinVal fov;
+} DPC_ObjDet_XYZCfg;
+
+/**************************************************************************
+ ************************** Memory Pool ***********************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Utility function for reseting memory pool.
+ *
+ *  @param[in]  pool Handle to pool object.
+ *
+ *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ *
+ *  @retval
+ *      none.
+ */
+static inline void DPC_ObjDet_MemPoolReset(MemPoolObj *pool)
+{
+    pool->currAddr = (uintptr_t)pool->cfg.addr;
+    pool->maxCurrAddr = pool->currAddr;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Utility function for setting memory pool to desired address in the pool.
+ *      Helps to rewind for example.
+ *
+ *  @param[in]  pool Handle to pool object.
+ *  @param[in]  addr Address to assign to the pool's current address.
+ *
+ *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ *
+ *  @retval
+ *      None
+ */
+static inline void DPC_ObjDet_MemPoolSet(MemPoolObj *pool, void *addr)
+{
+    pool->currAddr = (uintptr_t)addr;
+    pool->maxCurrAddr = CSL_MAX(pool->currAddr, pool->maxCurrAddr);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Utility function for getting memory pool current address.
+ *
+ *  @param[in]  pool Handle to pool object.
+ *
+ *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ *
+ *  @retval
+ *      pointer to current address of the pool (from which next allocation will
+ *      allocate to the desired alignment).
+ */
+static inline void *DPC_ObjDet_MemPoolGet(MemPoolObj *pool)
+{
+    return((void *)pool->currAddr);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Utility function for getting maximum memory pool usage.
+ *
+ *  @param[in]  pool Handle to pool object.
+ *
+ *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ *
+ *  @retval
+ *      Amount of pool used in bytes.
+ */
+static inline uint32_t DPC_ObjDet_MemPoolGetMaxUsage(MemPoolObj *pool)
+{
+    return((uint32_t)(pool->maxCurrAddr - (uintptr_t)pool->cfg.addr));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Utility function for allocating from a static memory pool.
+ *
+ *  @param[in]  pool Handle to pool object.
+ *  @param[in]  size Size in bytes to be allocated.
+ *  @param[in]  align Alignment in bytes
+ *
+ *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ *
+ *  @retval
+ *      pointer to beginning of allocated block. NULL indicates could not
+ *      allocate.
+ */
+static inline void *DPC_ObjDet_MemPoolAlloc(MemPoolObj *pool,
+                              uint32_t size,
+                              uint8_t align)
+{
+    void *retAddr = NULL;
+    uintptr_t addr;
+
+    addr = CSL_MEM_ALIGN(pool->currAddr, align);
+    if ((addr + size) <= ((uintptr_t)pool->cfg.addr + pool->cfg.size))
+    {
+        retAddr = (void *)addr;
+        pool->currAddr = addr + size;
+        pool->maxCurrAddr = CSL_MAX(pool->currAddr, pool->maxCurrAddr);
+    }
+
+    return (retAddr);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Allocates from a static memory pool like @ref DPC_ObjDet_MemPoolAlloc
+ *      and writes the buffer into the memory map of the sub-frame, also
+ *      when it does not fit.
+ *
+ *  @param[in]  pool   Handle to pool object.
+ *  @param[in]  size   Size in bytes to be allocated.
+ *  @param[in]  align  Alignment in bytes
+ *  @param[in]  map    Memory map of the sub-frame, may be NULL
+ *  @param[in]  poolId DPC_ObjDet_MemMapPoolId of the pool
+ *  @param[in]  owner  DPC_ObjDet_MemMapOwner of the buffer
+ *  @param[in]  name   Buffer name
+ *
+ *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ *
+ *  @retval
+ *      pointer to beginning of allocated block. NULL indicates could not
+ *      allocate.
+ */
+static inline void *DPC_ObjDet_MemPoolAllocTagged(MemPoolObj *pool,
+                              uint32_t size,
+                              uint8_t align,
+                              DPC_ObjDet_MemMap *map,
+                              uint32_t poolId,
+                              uint32_t owner,
+                              const char *name)
+{
+    uintptr_t prevAddr = pool->currAddr;
+    void *retAddr = DPC_ObjDet_MemPoolAlloc(pool, size, align);
+
+    if (retAddr == NULL)
+    {
+        DPC_ObjDet_memMapAdd(map, poolId, owner, name, DPC_OBJDET_MEMMAP_NO_FIT, size, 0U);
+    }
+    else
+    {
+        DPC_ObjDet_memMapAdd(map, poolId, owner, name,
+                             (uint32_t)((uintptr_t)retAddr - (uintptr_t)pool->cfg.addr), size,
+                             (uint32_t)((uintptr_t)retAddr - prevAddr));
+    }
+
+    return (retAddr);
+}
+
+/**************************************************************************
+ ************************** Windows ***************************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Computes the length of window to generate for the range DPU.
+ *
+ *  @param[in]  numAdcSamples Number of ADC samples per chirp
+ *
+ *  @retval   Length of window to generate
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_rangeWinGenLen(uint16_t numAdcSamples)
+{
+    uint32_t winGenLen;
+
+#ifdef DPC_USE_SYMMETRIC_WINDOW_RANGE_DPU
+    winGenLen = ((uint32_t)numAdcSamples + 1U) / 2U;
+#else
+    winGenLen = numAdcSamples;
+#endif
+    return (winGenLen);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Computes the length of window to generate for the doppler DPU.
+ *
+ *  @param[in]  numDopplerChirps Number of chirps going into the Doppler FFT
+ *
+ *  @retval   Length of window to generate
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_dopplerWinGenLen(uint16_t numDopplerChirps)
+{
+    uint32_t winGenLen;
+
+#ifdef DPC_USE_SYMMETRIC_WINDOW_DOPPLER_DPU
+    winGenLen = ((uint32_t)numDopplerChirps + 1U) / 2U;
+#else
+    winGenLen = numDopplerChirps;
+#endif
+    return (winGenLen);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Generates the interference mitigation window of the range DPU
+ *      using mathutils API.
+ *
+ *  @param[out] interfMitigHwaWindow  HWA interference mitigation window
+ *  @param[in]  numInterfMitigHwaSamples  Entries in interfMitigHwaWindow
+ *
+ *  @retval   None
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_genInterfMitigWindow(uint8_t *interfMitigHwaWindow,
+                                                   uint32_t numInterfMitigHwaSamples)
+{
+    /* Symmetric window */
+    uint32_t interfMitigWindow[DPC_OBJDET_RANGEPROC_NUM_INTFMITIG_WIN_SIZE_TOTAL >> 1];
+    uint8_t idx;
+
+    mathUtils_genWindow((uint32_t *)interfMitigWindow,
+                        DPC_OBJDET_RANGEPROC_NUM_INTFMITIG_WIN_SIZE_TOTAL,
+                        DPC_OBJDET_RANGEPROC_NUM_INTFMITIG_WIN_SIZE_TOTAL >> 1,
+                        DPC_DPU_RANGEPROC_INTERFMITIG_WINDOW_TYPE,
+                        DPC_OBJDET_QFORMAT_RANGEPROC_INTERFMITIG_WINDOW);
+
+    /* Only 5 win samples are supported by the HWA */
+    for (idx = 0; idx < numInterfMitigHwaSamples; idx++)
+    {
+        interfMitigHwaWindow[numInterfMitigHwaSamples - 1U - idx] =
+            (uint8_t)interfMitigWindow[(DPC_OBJDET_RANGEPROC_NUM_INTFMITIG_WIN_SIZE_TOTAL >> 1U) - 2U - idx];
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Generates the range FFT window and the interference mitigation
+ *      window using mathutils API.
+ *
+ *  @param[out] window         Range FFT window, DPC_ObjDet_rangeWinGenLen entries
+ *  @param[in]  numAdcSamples  Number of ADC samples per chirp
+ *  @param[out] interfMitigHwaWindow  HWA interference mitigation window
+ *  @param[in]  numInterfMitigHwaSamples  Entries in interfMitigHwaWindow
+ *
+ *  @retval   None
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_genRangeWindow(uint32_t *window,
+                                             uint16_t numAdcSamples,
+                                             uint8_t *interfMitigHwaWindow,
+                                             uint32_t numInterfMitigHwaSamples)
+{
+    DPC_ObjDet_genInterfMitigWindow(interfMitigHwaWindow, numInterfMitigHwaSamples);
+
+    /* Range FFT window */
+    mathUtils_genWindow(window,
+                        numAdcSamples,
+                        DPC_ObjDet_rangeWinGenLen(numAdcSamples),
+                        DPC_DPU_RANGEPROC_FFT_WINDOW_TYPE,
+                        DPC_OBJDET_QFORMAT_RANGE_FFT);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Returns the window type of the doppler FFT.
+ *
+ *  @param[in]  numChirps   Number of chirps going into the Doppler FFT
+ *
+ *  @retval   winType window type, see mathutils.h
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_dopplerWinType(uint16_t numChirps)
+{
+    /* For too small window, force rectangular window to avoid loss of information
+     * due to small window values (e.g. hanning has first and last coefficients 0) */
+    if (numChirps <= 4U)
+    {
+        return (MATHUTILS_WIN_RECT);
+    }
+    return (DPC_DPU_DOPPLERPROC_FFT_WINDOW_TYPE);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Generates the doppler FFT window using mathutils API.
+ *
+ *  @param[out] window      Doppler FFT window, DPC_ObjDet_dopplerWinGenLen entries
+ *  @param[in]  numChirps   Number of chirps going into the Doppler FFT
+ *
+ *  @retval   winType window type, see mathutils.h
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_genDopplerWindow(uint32_t *window, uint16_t numChirps)
+{
+    uint32_t winType = DPC_ObjDet_dopplerWinType(numChirps);
+
+    mathUtils_genWindow(window,
+                        numChirps,
+                        DPC_ObjDet_dopplerWinGenLen(numChirps),
+                        winType,
+                        DPC_OBJDET_QFORMAT_DOPPLER_FFT);
+
+    return (winType);
+}
+
+/**************************************************************************
+ ************************** Window Cache **********************************
+ **************************************************************************/
+
+/*! Window cache entries, a range and a Doppler window for each of 4 sub-frames */
+#define DPC_OBJDET_WIN_CACHE_MAX_ENTRIES    (8U)
+
+/*! @brief  One generated window and what it was generated from */
+typedef struct DPC_ObjDet_WinCacheEntry_t
+{
+    uint32_t *window;        /*!< coefficients in the cache buffer */
+    uint16_t length;         /*!< window length handed to mathUtils_genWindow */
+    uint16_t genLen;         /*!< coefficients generated */
+    uint8_t  winType;        /*!< MATHUTILS_WIN_* */
+    uint8_t  qFormat;        /*!< Q format of the coefficients */
+    uint8_t  inUse;          /*!< handed out for the configuration being built */
+} DPC_ObjDet_WinCacheEntry;
+
+/*! @brief  Windows generated so far, keyed by length, type and Q format.
+ *          Sub-frames with the same window get the same table, and a
+ *          table never moves or changes once generated, so the DPUs can
+ *          be reconfigured from it without generating it again. Entries
+ *          outlive a configuration and are reused by the next one. */
+typedef struct DPC_ObjDet_WinCache_t
+{
+    MemPoolObj pool;         /*!< window buffer the tables are carved from */
+    DPC_ObjDet_WinCacheEntry entry[DPC_OBJDET_WIN_CACHE_MAX_ENTRIES];
+    uint32_t numEntries;     /*!< entries in use */
+    uint8_t  bypass;         /*!< the configuration did not fit, windows are regenerated on reconfig */
+    uint32_t numGenerated;   /*!< windows generated since init */
+    uint32_t numHits;        /*!< windows served from the cache since init */
+} DPC_ObjDet_WinCache;
+
+/**
+ *  @b Description
+ *  @n
+ *      Function empties the window cache.
+ *
+ *  @param[out] cache   Window cache
+ *  @param[in]  buf     Buffer the windows are generated into
+ *  @param[in]  size    Size of buf in bytes
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_winCacheInit(DPC_ObjDet_WinCache *cache, void *buf, uint32_t size)
+{
+    (void)memset((void *)cache, 0, sizeof(DPC_ObjDet_WinCache));
+    cache->pool.cfg.addr = buf;
+    cache->pool.cfg.size = size;
+    DPC_ObjDet_MemPoolReset(&cache->pool);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Function starts a new configuration. Windows stay in the cache but
+ *      are no longer held by anyone until they are asked for again.
+ *
+ *  @param[in,out] cache   Window cache
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_winCacheNewConfig(DPC_ObjDet_WinCache *cache)
+{
+    uint32_t i;
+
+    for (i = 0; i < cache->numEntries; i++)
+    {
+        cache->entry[i].inUse = 0U;
+    }
+    cache->bypass = 0U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Function returns the window for the given parameters, generating it
+ *      the first time it is asked for. When there is no room, the cache is
+ *      emptied if the configuration being built holds none of its windows,
+ *      otherwise the configuration goes to bypass: NULL is returned from
+ *      here on and the caller generates its windows into scratch like
+ *      before the cache, on every reconfiguration.
+ *
+ *  @param[in,out] cache   Window cache
+ *  @param[in]  length     Window length
+ *  @param[in]  genLen     Coefficients to generate, length or half of it for a symmetric window
+ *  @param[in]  winType    MATHUTILS_WIN_*
+ *  @param[in]  qFormat    Q format of the coefficients
+ *
+ *  @retval   Window coefficients, NULL in bypass
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t *DPC_ObjDet_winCacheGet(DPC_ObjDet_WinCache *cache, uint32_t length, uint32_t genLen,
+                                               uint32_t winType, uint32_t qFormat)
+{
+    DPC_ObjDet_WinCacheEntry *entry;
+    uint32_t *window = NULL;
+    uint32_t i;
+
+    if (cache->bypass)
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < cache->numEntries; i++)
+    {
+        entry = &cache->entry[i];
+        if ((entry->length == length) && (entry->genLen == genLen) &&
+            (entry->winType == winType) && (entry->qFormat == qFormat))
+        {
+            entry->inUse = 1U;
+            cache->numHits++;
+            return entry->window;
+        }
+    }
+
+    if (cache->numEntries < DPC_OBJDET_WIN_CACHE_MAX_ENTRIES)
+    {
+        window = (uint32_t *)DPC_ObjDet_MemPoolAlloc(&cache->pool, genLen * sizeof(uint32_t), (uint8_t)sizeof(uint32_t));
+    }
+    if (window == NULL)
+    {
+        for (i = 0; i < cache->numEntries; i++)
+        {
+            if (cache->entry[i].inUse)
+            {
+                /* Entries of this configuration can't move, and scratch
+                 * windows will overwrite them, so drop them all */
+                cache->numEntries = 0U;
+                DPC_ObjDet_MemPoolReset(&cache->pool);
+                cache->bypass = 1U;
+                return NULL;
+            }
+        }
+        /* Only windows of earlier configurations, start over */
+        cache->numEntries = 0U;
+        DPC_ObjDet_MemPoolReset(&cache->pool);
+        window = (uint32_t *)DPC_ObjDet_MemPoolAlloc(&cache->pool, genLen * sizeof(uint32_t), (uint8_t)sizeof(uint32_t));
+        if (window == NULL)
+        {
+            cache->bypass = 1U;
+            return NULL;
+        }
+    }
+
+    mathUtils_genWindow(window, length, genLen, winType, qFormat);
+
+    entry = &cache->entry[cache->numEntries++];
+    entry->window = window;
+    entry->length = (uint16_t)length;
+    entry->genLen = (uint16_t)genLen;
+    entry->winType = (uint8_t)winType;
+    entry->qFormat = (uint8_t)qFormat;
+    entry->inUse = 1U;
+    cache->numGenerated++;
+    return window;
+}
+
+/**************************************************************************
+ ************************ Range/Doppler Intersection **********************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *     Function checks if the same object is present
+ *     in both the rangeCFAR detected object list and the
+ *     dopplerProc detected object list (also called doppler
+ *     list)
+ *
+ *  @param[in]  rangeIdx  range index of the object (from the doppler list)
+ *  @param[in]  dopIdx    doppler index of the object (from the doppler list)
+ *  @param[in]  rangeCfarList list of rangeCFAR detected objects.
+ *  @param[in]  numObjToSearch number of Objects to search.
+ *  @retval   boolean indicating presence (true) or absence (false).
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t isObjInRangeAndDopplerList(const uint32_t rangeIdx,
+                                          const uint32_t dopIdx,
+                                            const RangeCfarListObj *rangeCfarList,
+                                            uint32_t numObjToSearch)
+{
+    uint32_t idx;
+    for (idx = 0; idx < numObjToSearch; idx++)
+    {
+        if (rangeCfarList[idx].rangeIdx == rangeIdx)
+        {
+            if (rangeCfarList[idx].dopIdx == dopIdx)
+            {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Function checks if a Doppler DPU detection was also detected by
+ *     range CFAR. Only the part of the range CFAR list belonging to the
+ *     detection's Doppler sub bin is searched.
+ *
+ *  @param[in]  detObj     Detection from the Doppler DPU
+ *  @param[in]  rangeCfarList  Range CFAR list, ordered by Doppler sub bin
+ *  @param[in]  rangeCfarObjPerDopList  Cumulative number of range CFAR
+ *                         detections up to and including each sub bin
+ *  @retval   boolean indicating presence (true) or absence (false).
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_isDetInRangeCfar(const DetObjParams *detObj,
+                                                   const RangeCfarListObj *rangeCfarList,
+                                                   const uint16_t *rangeCfarObjPerDopList)
+{
+    uint16_t valSubBinObj, cfarListStartIdx;
+    uint32_t dopIdx = detObj->dopIdx;
+
+    if (dopIdx > 0U)
+    {
+        /* Obtain the number of objects for a sub bin in the Range CFAR list by
+        * subtracting two consecutive elements from the cummulative distribution */
+        valSubBinObj = rangeCfarObjPerDopList[dopIdx] - rangeCfarObjPerDopList[dopIdx - 1U];
+        cfarListStartIdx = rangeCfarObjPerDopList[dopIdx - 1U];
+    }
+    else
+    {
+        /* For the 0th sub bin, do not perform a subtraction */
+        valSubBinObj = rangeCfarObjPerDopList[dopIdx];
+        cfarListStartIdx = 0;
+    }
+
+    /* If the sub bin has valid objects in the range CFAR list, check whether the
+    * object currently being looked at (from the Doppler CFAR list), is also available
+    * in the range CFAR list. cfarListStartIdx tells us where to start searching for in
+    * the range CFAR list, and valSubBinObj tells us how many elements to search in.
+    * This saves computation time. */
+    if (valSubBinObj == 0U)
+    {
+        return 0;
+    }
+    return isObjInRangeAndDopplerList(detObj->rangeIdx, dopIdx,
+                                      &rangeCfarList[cfarListStartIdx], valSubBinObj);
+}
+
+/*! @brief  Number of 32 bit words in one Doppler sub bin row of the range CFAR bitmap */
+#define DPC_OBJDET_RANGECFAR_BITMAP_ROW_WORDS(numRangeBins)  (((uint32_t)(numRangeBins) + 31U) >> 5U)
+
+/**
+ *  @b Description
+ *  @n
+ *     Function sets or clears the bit of every range CFAR detection in a
+ *     bitmap with one row of range bins per Doppler sub bin. The bitmap
+ *     is all zero between frames, so the caller marks the list, looks
+ *     up the Doppler list and then clears the same bits again instead of
+ *     clearing the whole bitmap. Detections outside the bitmap are skipped.
+ *
+ *  @param[in,out] bitmap  numSubBins rows of rowWords words
+ *  @param[in]  rowWords   DPC_OBJDET_RANGECFAR_BITMAP_ROW_WORDS(numRangeBins)
+ *  @param[in]  numSubBins Number of Doppler sub bins
+ *  @param[in]  numRangeBins Number of range bins
+ *  @param[in]  rangeCfarList Range CFAR list
+ *  @param[in]  numObj     Number of detections in rangeCfarList
+ *  @param[in]  set        1 to set the bits, 0 to clear them
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_rangeCfarBitmapMark(uint32_t *bitmap,
+                                                  uint32_t rowWords,
+                                                  uint32_t numSubBins,
+                                                  uint32_t numRangeBins,
+                                                  const RangeCfarListObj *rangeCfarList,
+                                                  uint32_t numObj,
+                                                  uint32_t set)
+{
+    uint32_t idx;
+    for (idx = 0; idx < numObj; idx++)
+    {
+        uint32_t rangeIdx = rangeCfarList[idx].rangeIdx;
+        uint32_t dopIdx = rangeCfarList[idx].dopIdx;
+        if ((dopIdx < numSubBins) && (rangeIdx < numRangeBins))
+        {
+            uint32_t *word = &bitmap[dopIdx * rowWords + (rangeIdx >> 5U)];
+            uint32_t bit = (uint32_t)1U << (rangeIdx & 31U);
+            *word = (set != 0U) ? (*word | bit) : (*word & ~bit);
+        }
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Function checks if a Doppler DPU detection was also detected by
+ *     range CFAR, using the bitmap marked by DPC_ObjDet_rangeCfarBitmapMark.
+ *     Unlike DPC_ObjDet_isDetInRangeCfar the cost does not depend on how
+ *     many range CFAR detections share the detection's sub bin.
+ *
+ *  @param[in]  detObj     Detection from the Doppler DPU
+ *  @param[in]  bitmap     Marked range CFAR bitmap
+ *  @param[in]  rowWords   DPC_OBJDET_RANGECFAR_BITMAP_ROW_WORDS(numRangeBins)
+ *  @param[in]  numSubBins Number of Doppler sub bins
+ *  @param[in]  numRangeBins Number of range bins
+ *  @retval   boolean indicating presence (true) or absence (false).
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_isDetInRangeCfarBitmap(const DetObjParams *detObj,
+                                                         const uint32_t *bitmap,
+                                                         uint32_t rowWords,
+                                                         uint32_t numSubBins,
+                                                         uint32_t numRangeBins)
+{
+    uint32_t rangeIdx = detObj->rangeIdx;
+    uint32_t dopIdx = detObj->dopIdx;
+
+    if ((dopIdx >= numSubBins) || (rangeIdx >= numRangeBins))
+    {
+        return 0;
+    }
+    return (bitmap[dopIdx * rowWords + (rangeIdx >> 5U)] >> (rangeIdx & 31U)) & 1U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Function returns how many of the collected detection indices,
+ *     starting at first, are consecutive in the Doppler list. Such a run
+ *     is contiguous in memory and is moved to L2 by one transfer.
+ *
+ *  @param[in]  validIdx   Indices of the kept detections, ascending
+ *  @param[in]  numValid   Number of entries in validIdx
+ *  @param[in]  first      Entry the run starts at (< numValid)
+ *  @retval   Length of the run, at least 1.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_detObjRunLen(const uint16_t *validIdx,
+                                               uint32_t numValid,
+                                               uint32_t first)
+{
+    uint32_t runLen = 1U;
+    while (((first + runLen) < numValid) &&
+           (validIdx[first + runLen] == (uint16_t)(validIdx[first] + runLen)))
+    {
+        runLen++;
+    }
+    return runLen;
+}
+
+/**************************************************************************
+ ************************** Angle of Arrival ******************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *     Function performs quadratic interpolation around a peak
+ *
+ *  @param[in]  y A Three sample array ([y0,y1,y2]) where
+ *              (y1 > y2) and (y1 > y0)
+ *
+ *  @retval   location of the interpolated peak, relative to y1.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline float DPC_ObjDet_quadInterpAroundPeak(const uint32_t * restrict y)
+{
+
+    float ym1, y0, yp1;
+    float thetapk; //, yOut;
+
+    ym1 = (float) y[0]; /* y(peak-1) */
+    y0  = (float) y[1]; /* y(peak) */
+    yp1 = (float) y[2]; /* y(peak+1) */
+
+    thetapk = divsp((yp1 - ym1), (2 * (2 * y0 - yp1 - ym1)));
+    /* yOut = y0 + (((yp1 - ym1) / 4) * thetapk); */
+
+    return thetapk;
+
+}
+
+/**
+ *  This routine calculates the dot product of 2 single-precision complex
+ *  float vectors. The even numbered locations hold the real parts of the
+ *  complex numbers while the odd numbered locations contain the imaginary
+ *  portions. On the C66x it is an exact copy of the DSPF_sp_dotp_cmplx
+ *  function from the DSPLIB.
+ *
+ *         @param x   Pointer to array holding the first floating-point vector
+ *         @param y   Pointer to array holding the second floating-point vector
+ *         @param nx  Number of values in the x and y vectors
+ *         @param re  Pointer to the location storing the real part of the result
+ *         @param im  Pointer to the location storing the imaginary part of the result
+ *
+ * @par Assumptions:
+ *   Loop counter must be multiple of 4 and > 0. <BR>
+ *   The x and y arrays must be double-word aligned. <BR>
+ *
+ *
+ */
+static inline void dotpCmplxf(const float * restrict x, const float * restrict y, int nx,
+                       float * restrict re, float * restrict im)
+{
+#if defined(_TMS320C6600) && !defined(OBJDET_HOST_SIM)
+    int i;
+    __float2_t x0_im_re, y0_im_re, result0 = 0;
+    __float2_t x1_im_re, y1_im_re, result1 = 0;
+    __float2_t x2_im_re, y2_im_re, result2 = 0;
+    __float2_t x3_im_re, y3_im_re, result3 = 0;
+    __float2_t result;
+
+    _nassert(nx % 4 == 0);
+    _nassert(nx > 0);
+    _nassert((int)x % 8 == 0);
+    _nassert((int)y % 8 == 0);
+
+    for(i = 0; i < 2 * nx; i += 8)
+    {
+        /* load 4 sets of input data */
+        x0_im_re = _amem8_f2((void*)&x[i]);
+        y0_im_re = _amem8_f2((void*)&y[i]);
+
+        x1_im_re = _amem8_f2((void*)&x[i+2]);
+        y1_im_re = _amem8_f2((void*)&y[i+2]);
+
+        x2_im_re = _amem8_f2((void*)&x[i+4]);
+        y2_im_re = _amem8_f2((void*)&y[i+4]);
+
+        x3_im_re = _amem8_f2((void*)&x[i+6]);
+        y3_im_re = _amem8_f2((void*)&y[i+6]);
+
+        /* calculate 4 running sums */
+        result0 = _daddsp(_complex_mpysp(x0_im_re, y0_im_re), result0);
+        result1 = _daddsp(_complex_mpysp(x1_im_re, y1_im_re), result1);
+        result2 = _daddsp(_complex_mpysp(x2_im_re, y2_im_re), result2);
+        result3 = _daddsp(_complex_mpysp(x3_im_re, y3_im_re), result3);
+    }
+
+    result = _daddsp(_daddsp(result0,result1),_daddsp(result2,result3));
+    *re =  _hif2(result);
+    *im =  _lof2(result);
+#else
+    /* Same sums on [imag, real] pairs, laid out like a C66x __float2_t */
+    int i;
+    float sumRe = 0.0f, sumIm = 0.0f;
+
+    for(i = 0; i < 2 * nx; i += 2)
+    {
+        sumRe += (x[i+1] * y[i+1]) - (x[i] * y[i]);
+        sumIm += (x[i+1] * y[i]) + (x[i] * y[i+1]);
+    }
+    *re = sumRe;
+    *im = sumIm;
+#endif
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Multiplies an int32 HWA sample with a float calibration coefficient,
+ *     both in [imag, real] order.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline cmplxfImRe_t DPC_ObjDet_calibSample(const cmplx32ImRe_t *sample, const float *calib)
+{
+    cmplxfUnion_t out;
+#if defined(_TMS320C6600) && !defined(OBJDET_HOST_SIM)
+    /* detection lists are only 4 byte aligned in the scratch pool */
+    out.ddat = _complex_mpysp(_dintsp(_mem8((void *)sample)), _mem8_f2((void *)calib));
+#else
+    float re = (float)sample->real;
+    float im = (float)sample->imag;
+    out.cmplx.real = (re * calib[1]) - (im * calib[0]);
+    out.cmplx.imag = (re * calib[0]) + (im * calib[1]);
+#endif
+    return out.cmplx;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Returns azim * conj(elev), the phase step from the elevation row to
+ *     the azimuth row.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline cmplxfImRe_t DPC_ObjDet_conjMpy(cmplxfUnion_t elev, cmplxfUnion_t azim)
+{
+    cmplxfUnion_t out;
+#if defined(_TMS320C6600) && !defined(OBJDET_HOST_SIM)
+    out.ddat = _complex_conjugate_mpysp(elev.ddat, azim.ddat);
+#else
+    out.cmplx.real = (azim.cmplx.real * elev.cmplx.real) + (azim.cmplx.imag * elev.cmplx.imag);
+    out.cmplx.imag = (azim.cmplx.imag * elev.cmplx.real) - (azim.cmplx.real * elev.cmplx.imag);
+#endif
+    return out.cmplx;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Steps 1 and 2 of DPC_ObjDet_estimateXYZ: interpolates the azimuth FFT
+ *     peak and returns its location on the AOA_DFT_LEN point DFT grid.
+ *
+ *  @param[in]  detObj          Detected object
+ *  @param[in]  invAzimFFTSize  1 / number of azimuth FFT bins
+ *
+ *  @retval   Peak location in [0, AOA_DFT_LEN]
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline int32_t DPC_ObjDet_azimPeakLoc(const DetObjParams * restrict detObj, float invAzimFFTSize)
+{
+    float peakIdxOffset, peakIdxFlt, peakIdxFlt_DFT;
+
+    /* 1. Interpolate around peak to get fractional estimate of Azimuth index */
+    peakIdxOffset = DPC_ObjDet_quadInterpAroundPeak(detObj->azimPeakSamples);
+
+    /* Correct peak index with the fractional index*/
+    peakIdxFlt = (float)detObj->azimIdx + peakIdxOffset;
+    peakIdxFlt_DFT = peakIdxFlt * (invAzimFFTSize * AOA_DFT_LEN);
+    return (int32_t)ROUND_UNSIGNED(peakIdxFlt_DFT);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Calculates the DFT factors \f$\e^{j wx}\f$ at the antenna positions
+ *     set in a zero insertion mask.
+ *
+ *  @param[in]  zeroInsrtMask   Antenna positions
+ *  @param[in]  peakLoc         Peak location on the AOA_DFT_LEN grid
+ *  @param[out] dftFactors      One factor per antenna
+ *  @param[in]  numAnt          Number of antennas in the row
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_dftFactors(uint64_t zeroInsrtMask, int32_t peakLoc,
+                                         cmplxfImRe_t * restrict dftFactors, uint32_t numAnt)
+{
+    uint32_t sampIdx, idx = 0;
+    uint32_t maxMaskWidth = 8*sizeof(zeroInsrtMask);
+    int32_t currLoc;
+
+    for (sampIdx = 0; sampIdx < maxMaskWidth; sampIdx ++)
+    {
+        if((zeroInsrtMask >> sampIdx) & 0x1U)
+        {
+            currLoc = (peakLoc*sampIdx)%AOA_DFT_LEN;
+            dftFactors[idx++] = dftSinCosTable[currLoc];
+        }
+
+        /* Break the loop after computing all dft factors in this dimension */
+        if(idx == numAnt)
+            break;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Steps 7 to 9 of DPC_ObjDet_estimateXYZ: turns the azimuth peak and
+ *     the azimuth to elevation phase step of one object into x, y, z,
+ *     velocity and side info, if it is inside the field of view.
+ *
+ *  @param[in]  cfg         Angle estimation configuration
+ *  @param[in]  detObj      Detected object
+ *  @param[in]  peakLoc     Azimuth peak on the AOA_DFT_LEN grid
+ *  @param[in]  elevOutput  AzimVal * conj(ElevVal)
+ *  @param[out] objOut      Point written if the object is valid
+ *  @param[out] sideInfo    Side info written if the object is valid
+ *
+ *  @retval   1 if the object is valid, 0 if it was dropped
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_xyzFromPhase(const DPC_ObjDet_XYZCfg * restrict cfg,
+                                               const DetObjParams * restrict detObj,
+                                               int32_t peakLoc,
+                                               cmplxfImRe_t elevOutput,
+                                               DPIF_PointCloudCartesian * restrict objOut,
+                                               DPIF_PointCloudSideInfo * restrict sideInfo)
+{
+    float noisedB, signaldB, snrdB;
+    float azimSinPhase, elevSinPhase, elevCosPhase;
+    float range, x, ySquared, z;
+    float wz, peakLocFlt;
+    int32_t dopIdx;
+    uint32_t numDopplerBins = cfg->numDopplerBins;
+
+    /* - 2. Compute the angle of the product to estimate the phase change in elevation.
+        \f[
+        \omega_z = angle (\ X_{elev} (\omega_x)' \times X_{azim} (\omega_x) )\
+        \f]
+    */
+    if (fabsf(elevOutput.imag) < (0.15f*fabsf(elevOutput.real)))
+    {
+        // small angle approximation.
+        wz = divsp(elevOutput.imag, elevOutput.real);
+    }
+    else
+    {
+        wz = atan2sp(elevOutput.imag, elevOutput.real);
+        if (wz > PI_)
+        {
+                wz -= 2.0f*PI_;
+        }
+    }
+
+    /* 8. Obtain range using the range resolution and the range Index  */
+    range = cfg->rangeStep * (float)detObj->rangeIdx;
+
+    /* 9. Obtain z, x coordinates.
+        \f[
+        \Phi = asin(\frac{\omega_z}{2 \pi d_z})
+        \f]
+
+    \f[
+        z = range \times sin(\phi) = range * \frac{\omega_z}{2 \pi d_z}
+    \f]
+
+    */
+    elevSinPhase = wz * (1.0f / (2.0f * PI_ * cfg->zSpacingByLambda));
+    if ((elevSinPhase <= cfg->fov.minElevationSinVal) || (elevSinPhase >= cfg->fov.maxElevationSinVal))
+    {
+        return 0;
+    }
+    z = range * elevSinPhase;
+
+    /*
+    \f[
+        x = range  cos(\phi)  sin(\theta) =  range  /frac{\omega_x}{2 \pi d_x}
+    \f]
+
+    */
+    peakLocFlt = peakLoc * (1.0f/ AOA_DFT_LEN);
+    if (peakLocFlt > 0.5f)
+    {
+        peakLocFlt -= 1.0f;
+    }
+
+    x = range * peakLocFlt * (1.0f / cfg->xSpacingByLambda);
+
+    /* Obtain 'square of y' coordinate
+        \f[
+        y^2 = range^2 -x^2 - z^2
+    \f]
+    */
+    ySquared = (range * range) - (z * z) - (x * x);
+
+    /* It is possible that ySquared is less than zero (i.e. a degenerate case). In such a case ignore the object. */
+    if (ySquared <= 0)
+    {
+        return 0;
+    }
+
+    /* Estimate azimuth phase.
+        \f[
+        sin(\Theta) = \frac{x}{range \times cos(\Phi)}
+        \f]
+    */
+    elevCosPhase = sqrtsp(1 - (elevSinPhase * elevSinPhase));
+    azimSinPhase = divsp(x, (range * elevCosPhase));
+
+    /* Check if object is in azimuth FoV */
+    if ((azimSinPhase <= cfg->fov.minAzimuthSinVal) || (azimSinPhase >= cfg->fov.maxAzimuthSinVal))
+    {
+        return 0;
+    }
+
+    /* Store x, y, z values */
+    objOut->z = z;
+    objOut->x = x;
+    objOut->y = sqrtsp(ySquared);
+
+    /* Obtain and store Velocity */
+    if (detObj->dopIdxActual > numDopplerBins / 2)
+    {
+        dopIdx = detObj->dopIdxActual - numDopplerBins;
+    }
+    else
+    {
+        dopIdx = detObj->dopIdxActual;
+    }
+    objOut->velocity = dopIdx * cfg->dopplerStep;
+
+    /* Calcute the side info of final detected object */
+    /* output is 20*log10(2)*value/2^(QVALUE) */
+    noisedB = 6.0 * ((float)detObj->dopCfarNoise) * (1.0f/(1 << QVALUE_NOISE));
+    signaldB = 6.0 * ((float)detObj->azimPeakSamples[1]) * (1.0f/(1<<QVALUE_SIGNAL));
+    snrdB = signaldB - noisedB;
+
+    sideInfo->snr = (int)(10*snrdB);
+    sideInfo->noise = (int)(10*noisedB);
+
+    return 1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Function estimates XYZ coordinates of objects in the object list.
+ *     This is the body of DPC_ObjDet_estimateXYZ with the configuration
+ *     passed in directly, so it does not need the DPC objects.
+ *     objdet_simd.h has a batched version of the same math.
+ *
+ *  @param[in]  cfg         Angle estimation configuration
+ *  @param[in]  detObjList  Detected object list
+ *  @param[in]  numObjOut   Number of detected objects
+ *  @param[out] objOut      List with x, y, z coordinates populated for each object
+ *  @param[out] sideInfo    SNR and noise of each object in objOut
+ *
+ *  @retval   Number of validated objects
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_estimateXYZKernel(const DPC_ObjDet_XYZCfg * restrict cfg,
+                                                    const DetObjParams * restrict detObjList,
+                                                    uint32_t numObjOut,
+                                                    DPIF_PointCloudCartesian * restrict objOut,
+                                                    DPIF_PointCloudSideInfo * restrict sideInfo)
+{
+    const float invAzimFFTSize = divsp(1.0f,(float) cfg->numAzimFFTBins);
+    uint32_t objIdx, sampIdx;
+    int32_t peakLoc;
+    cmplxfUnion_t DFTValAzim, DFTValElev;
+    uint32_t ValidObjIdx;
+
+    /* Alignment is to be done because we use the antenna calib params for
+     * multiplication, using optimized DSP routines, which require a 8 byte alignment */
+    cmplxfImRe_t samplesCalib[MAX_NUM_VIRT_ANT] __attribute__((aligned(8)));
+    cmplxfImRe_t dftFactorsAzim[MAX_NUM_AZIM_VIRT_ANT] __attribute__((aligned(8)));
+    cmplxfImRe_t dftFactorsElev[MAX_NUM_ELEV_VIRT_ANT] __attribute__((aligned(8)));
+    cmplxfImRe_t *azimSamplesCalib = &samplesCalib[0];
+    cmplxfImRe_t *elevSamplesCalib = &samplesCalib[MAX_NUM_AZIM_VIRT_ANT];
+
+    /* This variable will index the final object list */
+    ValidObjIdx = 0;
+
+    for (objIdx = 0; objIdx < numObjOut; objIdx++)
+    {
+        /* 1. Fractional estimate of the azimuth peak */
+        peakLoc = DPC_ObjDet_azimPeakLoc(&detObjList[objIdx], invAzimFFTSize);
+
+        /* 2a/2b. Calculate DFT Factors corresponding to wx for Row 1 and Row 0 */
+        DPC_ObjDet_dftFactors(cfg->zeroInsrtMaskAzim, peakLoc, dftFactorsAzim, MAX_NUM_AZIM_VIRT_ANT);
+        DPC_ObjDet_dftFactors(cfg->zeroInsrtMaskElev, peakLoc, dftFactorsElev, MAX_NUM_ELEV_VIRT_ANT);
+
+        /* 2c/3. Rearrange the azimuth samples according to the virtual antenna
+            * mapping and multiply them with the antenna calib params */
+        for (sampIdx = 0; sampIdx < MAX_NUM_AZIM_VIRT_ANT; sampIdx++)
+        {
+            azimSamplesCalib[sampIdx] = DPC_ObjDet_calibSample(
+                &detObjList[objIdx].azimSamples[cfg->antennaGeometryCfg[sampIdx]],
+                &cfg->antennaCalibParams[2U * sampIdx]);
+        }
+
+        /* 2c/4. Same for the elevation samples */
+        for (sampIdx = MAX_NUM_AZIM_VIRT_ANT; sampIdx < MAX_NUM_VIRT_ANT ; sampIdx++ )
+        {
+            elevSamplesCalib[sampIdx-MAX_NUM_AZIM_VIRT_ANT] = DPC_ObjDet_calibSample(
+                &detObjList[objIdx].elevSamples[cfg->antennaGeometryCfg[sampIdx]],
+                &cfg->antennaCalibParams[2U * sampIdx]);
+        }
+
+        /* 5. Single Bin DFT on the azimuth antennas to estimate phase at peak.
+            *
+            \f[
+            X_{azim} (\omega_x) = \sum_{k=0}^{N_{azim} - 1} azimSample(k)  e^{-j k \omega_x}
+            \f]
+            * Multiply DFT factors with azimuth of Doppler FFT samples corrected for antenna calibration.
+            */
+        dotpCmplxf((float *)&azimSamplesCalib[0], (float *)&dftFactorsAzim[0], MAX_NUM_AZIM_VIRT_ANT, &DFTValAzim.cmplx.real, &DFTValAzim.cmplx.imag);
+
+
+        /* 6.  Single Bin DFT on the elevation antennas to estimate phase at peak.
+            *
+            \f[
+            X_{elev} (\omega_x) = \sum_{k=0}^{N_{elev} - 1} elevSample(k)  e^{-j (k+2) \omega_x}
+            \f]
+            * The elevation antennas (essentially the 4 virtual antennas corresponding to the
+            * elevation offset Tx antenna) are 4 in number and offset by 3 positions from the
+            * azimuth virtual array. Hence when the DFT is computed, begin from the 3rd DFT parameter.
+            *
+            * Both elevSamplesCalib and cosValSinVal[4] are double-word aligned. */
+        dotpCmplxf((float *)&elevSamplesCalib[0], (float *)&dftFactorsElev[0], MAX_NUM_ELEV_VIRT_ANT, &DFTValElev.cmplx.real, &DFTValElev.cmplx.imag);
+
+        /* 7. Estimate phase difference between the peak location at azimuth antennas and elevation antennas at peak.
+            *  - 1. compute the conjugate product to get the phase difference (i.e. AzimVal * conj(ElevVal))
+            *  - 2 to 9. angles, coordinates and the field of view checks */
+        ValidObjIdx += DPC_ObjDet_xyzFromPhase(cfg, &detObjList[objIdx], peakLoc,
+                                               DPC_ObjDet_conjMpy(DFTValElev, DFTValAzim),
+                                               &objOut[ValidObjIdx], &sideInfo[ValidObjIdx]);
+    }
+
+    return ValidObjIdx;
+}
+
+/**************************************************************************
+ ***************************** AoA Pipeline *******************************
+ **************************************************************************/
+
+/*! @brief  Bookkeeping of the pipelined AoA. The intersection of frame N
+ *          leaves finalDetObjList pending, and the AoA of frame N runs at the
+ *          start of frame N+1 while the HWA does its range FFT. The point
+ *          clouds alternate between two objOut/side info buffers so the one
+ *          returned for frame N is untouched while frame N+1 is processed. */
+typedef struct DPC_ObjDet_AoaPipe_t
+{
+    uint8_t  enabled;        /*!< pipelined order in use */
+    uint8_t  pending;        /*!< finalDetObjList holds a frame whose AoA has not run */
+    uint8_t  subFrameIdx;    /*!< sub frame of the pending frame */
+    uint8_t  outBufIdx;      /*!< buffer the last AoA wrote */
+    uint32_t numDetObjs;     /*!< number of kept detections of the pending frame */
+} DPC_ObjDet_AoaPipe;
+
+/**
+ *  @b Description
+ *  @n
+ *     Function empties the AoA pipeline when the DPC starts.
+ *
+ *  @param[out] pipe     AoA pipeline
+ *  @param[in]  enabled  1 for the pipelined order, 0 for AoA in the same frame
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_aoaPipeReset(DPC_ObjDet_AoaPipe *pipe, uint8_t enabled)
+{
+    pipe->enabled = enabled;
+    pipe->pending = 0U;
+    pipe->subFrameIdx = 0U;
+    pipe->outBufIdx = 1U;
+    pipe->numDetObjs = 0U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Function records that finalDetObjList now holds a frame waiting
+ *     for its AoA.
+ *
+ *  @param[in,out] pipe     AoA pipeline
+ *  @param[in]  subFrameIdx Sub frame of the frame
+ *  @param[in]  numDetObjs  Number of kept detections
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_aoaPipePush(DPC_ObjDet_AoaPipe *pipe, uint8_t subFrameIdx, uint32_t numDetObjs)
+{
+    pipe->pending = 1U;
+    pipe->subFrameIdx = subFrameIdx;
+    pipe->numDetObjs = numDetObjs;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Function takes the pending frame for its AoA and picks the output
+ *     buffer, which is the one not returned with the previous frame.
+ *
+ *  @param[in,out] pipe    AoA pipeline
+ *  @param[out] outBufIdx  objOut/side info buffer the AoA writes
+ *  @retval   1 if a frame was pending, 0 if the pipeline was empty.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_aoaPipePop(DPC_ObjDet_AoaPipe *pipe, uint32_t *outBufIdx)
+{
+    if (pipe->pending == 0U)
+    {
+        return 0U;
+    }
+    pipe->pending = 0U;
+    pipe->outBufIdx ^= 1U;
+    *outBufIdx = pipe->outBufIdx;
+    return 1U;
+}
+
+#endif /* OBJDET_MATH_H */
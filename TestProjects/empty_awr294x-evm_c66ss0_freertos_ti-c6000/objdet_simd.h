@@ -0,0 +1,281 @@
+/*
+ *   @file  objdet_simd.h
+ *
+ *   @brief
+ *      Batched angle of arrival estimation for processors other than the C66x.
+ *
+ *      DPC_ObjDet_estimateXYZKernel in objdet_math.h handles one object at
+ *      a time with the C66x complex intrinsics. Here the two single bin
+ *      DFTs, the calibration and the conjugate product are done for
+ *      OBJDET_SIMD_WIDTH objects at once, with the antenna samples of a
+ *      batch laid out structure-of-arrays so every vector lane is one
+ *      object. Picking the peak, the DFT factors and everything after the
+ *      phase step stays per object and is shared with the scalar kernel,
+ *      so the two agree up to float rounding.
+ *
+ *      The backend is chosen at compile time: AVX (8 lanes), SSE2 or NEON
+ *      (4 lanes), or plain C (4 lanes) when none is there or when
+ *      OBJDET_SIMD_GENERIC is defined. The DSP keeps using the scalar
+ *      kernel with its intrinsics.
+ */
+
+#ifndef OBJDET_SIMD_H
+#define OBJDET_SIMD_H
+
+#include "objdet_math.h"
+
+/**************************************************************************
+ ************************** Vector Backends *******************************
+ **************************************************************************/
+#if !defined(OBJDET_SIMD_GENERIC) && defined(__AVX__)
+
+#include <immintrin.h>
+#define OBJDET_SIMD_WIDTH   (8U)
+#define OBJDET_SIMD_NAME    "avx"
+typedef __m256 ObjDetVec;
+#define ObjDet_vload(p)     _mm256_load_ps(p)
+#define ObjDet_vstore(p, a) _mm256_store_ps((p), (a))
+#define ObjDet_vset1(f)     _mm256_set1_ps(f)
+#define ObjDet_vzero()      _mm256_setzero_ps()
+#define ObjDet_vadd(a, b)   _mm256_add_ps((a), (b))
+#define ObjDet_vsub(a, b)   _mm256_sub_ps((a), (b))
+#define ObjDet_vmul(a, b)   _mm256_mul_ps((a), (b))
+#define ObjDet_vcvt(p)      _mm256_cvtepi32_ps(_mm256_load_si256((const __m256i *)(p)))
+
+#elif !defined(OBJDET_SIMD_GENERIC) && defined(__SSE2__)
+
+#include <emmintrin.h>
+#define OBJDET_SIMD_WIDTH   (4U)
+#define OBJDET_SIMD_NAME    "sse2"
+typedef __m128 ObjDetVec;
+#define ObjDet_vload(p)     _mm_load_ps(p)
+#define ObjDet_vstore(p, a) _mm_store_ps((p), (a))
+#define ObjDet_vset1(f)     _mm_set1_ps(f)
+#define ObjDet_vzero()      _mm_setzero_ps()
+#define ObjDet_vadd(a, b)   _mm_add_ps((a), (b))
+#define ObjDet_vsub(a, b)   _mm_sub_ps((a), (b))
+#define ObjDet_vmul(a, b)   _mm_mul_ps((a), (b))
+#define ObjDet_vcvt(p)      _mm_cvtepi32_ps(_mm_load_si128((const __m128i *)(p)))
+
+#elif !defined(OBJDET_SIMD_GENERIC) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+
+#include <arm_neon.h>
+#define OBJDET_SIMD_WIDTH   (4U)
+#define OBJDET_SIMD_NAME    "neon"
+typedef float32x4_t ObjDetVec;
+#define ObjDet_vload(p)     vld1q_f32(p)
+#define ObjDet_vstore(p, a) vst1q_f32((p), (a))
+#define ObjDet_vset1(f)     vdupq_n_f32(f)
+#define ObjDet_vzero()      vdupq_n_f32(0.0f)
+#define ObjDet_vadd(a, b)   vaddq_f32((a), (b))
+#define ObjDet_vsub(a, b)   vsubq_f32((a), (b))
+#define ObjDet_vmul(a, b)   vmulq_f32((a), (b))
+#define ObjDet_vcvt(p)      vcvtq_f32_s32(vld1q_s32(p))
+
+#else
+
+#define OBJDET_SIMD_WIDTH   (4U)
+#define OBJDET_SIMD_NAME    "generic"
+typedef struct ObjDetVec_t
+{
+    float v[OBJDET_SIMD_WIDTH];
+} ObjDetVec;
+
+static inline ObjDetVec ObjDet_vload(const float *p)
+{
+    ObjDetVec r;
+    uint32_t i;
+    for (i = 0; i < OBJDET_SIMD_WIDTH; i++) { r.v[i] = p[i]; }
+    return r;
+}
+static inline void ObjDet_vstore(float *p, ObjDetVec a)
+{
+    uint32_t i;
+    for (i = 0; i < OBJDET_SIMD_WIDTH; i++) { p[i] = a.v[i]; }
+}
+static inline ObjDetVec ObjDet_vset1(float f)
+{
+    ObjDetVec r;
+    uint32_t i;
+    for (i = 0; i < OBJDET_SIMD_WIDTH; i++) { r.v[i] = f; }
+    return r;
+}
+static inline ObjDetVec ObjDet_vzero(void)
+{
+    return ObjDet_vset1(0.0f);
+}
+static inline ObjDetVec ObjDet_vadd(ObjDetVec a, ObjDetVec b)
+{
+    uint32_t i;
+    for (i = 0; i < OBJDET_SIMD_WIDTH; i++) { a.v[i] += b.v[i]; }
+    return a;
+}
+static inline ObjDetVec ObjDet_vsub(ObjDetVec a, ObjDetVec b)
+{
+    uint32_t i;
+    for (i = 0; i < OBJDET_SIMD_WIDTH; i++) { a.v[i] -= b.v[i]; }
+    return a;
+}
+static inline ObjDetVec ObjDet_vmul(ObjDetVec a, ObjDetVec b)
+{
+    uint32_t i;
+    for (i = 0; i < OBJDET_SIMD_WIDTH; i++) { a.v[i] *= b.v[i]; }
+    return a;
+}
+static inline ObjDetVec ObjDet_vcvt(const int32_t *p)
+{
+    ObjDetVec r;
+    uint32_t i;
+    for (i = 0; i < OBJDET_SIMD_WIDTH; i++) { r.v[i] = (float)p[i]; }
+    return r;
+}
+
+#endif
+
+/*! @brief  Structure-of-arrays view of one batch: entry [ant][lane] */
+typedef struct DPC_ObjDet_XYZBatch_t
+{
+    int32_t  sampRe[MAX_NUM_VIRT_ANT][OBJDET_SIMD_WIDTH] __attribute__((aligned(32)));
+    int32_t  sampIm[MAX_NUM_VIRT_ANT][OBJDET_SIMD_WIDTH] __attribute__((aligned(32)));
+    float    facRe[MAX_NUM_VIRT_ANT][OBJDET_SIMD_WIDTH] __attribute__((aligned(32)));
+    float    facIm[MAX_NUM_VIRT_ANT][OBJDET_SIMD_WIDTH] __attribute__((aligned(32)));
+    float    outRe[OBJDET_SIMD_WIDTH] __attribute__((aligned(32)));
+    float    outIm[OBJDET_SIMD_WIDTH] __attribute__((aligned(32)));
+    int32_t  peakLoc[OBJDET_SIMD_WIDTH];
+} DPC_ObjDet_XYZBatch;
+
+/**
+ *  @b Description
+ *  @n
+ *     Calibrates one row of antennas for every lane and correlates it with
+ *     the DFT factors, sum over k of (sample(k) * calib(k)) * factor(k).
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline void DPC_ObjDet_batchDft(const DPC_ObjDet_XYZCfg * restrict cfg,
+                                       const DPC_ObjDet_XYZBatch * restrict b,
+                                       uint32_t firstAnt, uint32_t numAnt,
+                                       ObjDetVec *accRe, ObjDetVec *accIm)
+{
+    uint32_t k;
+    ObjDetVec re = ObjDet_vzero();
+    ObjDetVec im = ObjDet_vzero();
+
+    for (k = firstAnt; k < firstAnt + numAnt; k++)
+    {
+        ObjDetVec sRe = ObjDet_vcvt(b->sampRe[k]);
+        ObjDetVec sIm = ObjDet_vcvt(b->sampIm[k]);
+        ObjDetVec cIm = ObjDet_vset1(cfg->antennaCalibParams[2U * k]);
+        ObjDetVec cRe = ObjDet_vset1(cfg->antennaCalibParams[2U * k + 1U]);
+        ObjDetVec fRe = ObjDet_vload(b->facRe[k]);
+        ObjDetVec fIm = ObjDet_vload(b->facIm[k]);
+
+        /* calibrated sample */
+        ObjDetVec calRe = ObjDet_vsub(ObjDet_vmul(sRe, cRe), ObjDet_vmul(sIm, cIm));
+        ObjDetVec calIm = ObjDet_vadd(ObjDet_vmul(sRe, cIm), ObjDet_vmul(sIm, cRe));
+
+        /* times the DFT factor */
+        re = ObjDet_vadd(re, ObjDet_vsub(ObjDet_vmul(calRe, fRe), ObjDet_vmul(calIm, fIm)));
+        im = ObjDet_vadd(im, ObjDet_vadd(ObjDet_vmul(calRe, fIm), ObjDet_vmul(calIm, fRe)));
+    }
+    *accRe = re;
+    *accIm = im;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *     Batched DPC_ObjDet_estimateXYZKernel. Same inputs, same outputs in
+ *     the same order.
+ *
+ *  @param[in]  cfg         Angle estimation configuration
+ *  @param[in]  detObjList  Detected object list
+ *  @param[in]  numObjOut   Number of detected objects
+ *  @param[out] objOut      List with x, y, z coordinates populated for each object
+ *  @param[out] sideInfo    SNR and noise of each object in objOut
+ *
+ *  @retval   Number of validated objects
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static inline uint32_t DPC_ObjDet_estimateXYZBatch(const DPC_ObjDet_XYZCfg * restrict cfg,
+                                                   const DetObjParams * restrict detObjList,
+                                                   uint32_t numObjOut,
+                                                   DPIF_PointCloudCartesian * restrict objOut,
+                                                   DPIF_PointCloudSideInfo * restrict sideInfo)
+{
+    const float invAzimFFTSize = divsp(1.0f,(float) cfg->numAzimFFTBins);
+    DPC_ObjDet_XYZBatch batch;
+    uint32_t antPos[MAX_NUM_VIRT_ANT];
+    uint32_t base, lane, numLanes, k, bit;
+    uint32_t ValidObjIdx = 0;
+
+    /* Antenna positions only depend on the masks, find them once instead of
+     * walking both 64 bit masks for every object */
+    for (k = 0, bit = 0; (bit < 64U) && (k < MAX_NUM_AZIM_VIRT_ANT); bit++)
+    {
+        if ((cfg->zeroInsrtMaskAzim >> bit) & 0x1U)
+        {
+            antPos[k++] = bit;
+        }
+    }
+    for (k = MAX_NUM_AZIM_VIRT_ANT, bit = 0; (bit < 64U) && (k < MAX_NUM_VIRT_ANT); bit++)
+    {
+        if ((cfg->zeroInsrtMaskElev >> bit) & 0x1U)
+        {
+            antPos[k++] = bit;
+        }
+    }
+
+    for (base = 0; base < numObjOut; base += OBJDET_SIMD_WIDTH)
+    {
+        numLanes = ((numObjOut - base) < OBJDET_SIMD_WIDTH) ? (numObjOut - base) : OBJDET_SIMD_WIDTH;
+
+        /* Per object: peak, DFT factors and the samples in antenna order.
+         * Unused lanes repeat the first object and are never read back. */
+        for (lane = 0; lane < OBJDET_SIMD_WIDTH; lane++)
+        {
+            const DetObjParams *detObj = &detObjList[base + ((lane < numLanes) ? lane : 0U)];
+            int32_t peakLoc = DPC_ObjDet_azimPeakLoc(detObj, invAzimFFTSize);
+
+            batch.peakLoc[lane] = peakLoc;
+
+            for (k = 0; k < MAX_NUM_VIRT_ANT; k++)
+            {
+                const cmplx32ImRe_t *samp = (k < MAX_NUM_AZIM_VIRT_ANT) ?
+                    &detObj->azimSamples[cfg->antennaGeometryCfg[k]] :
+                    &detObj->elevSamples[cfg->antennaGeometryCfg[k]];
+                batch.sampRe[k][lane] = samp->real;
+                batch.sampIm[k][lane] = samp->imag;
+                /* same factor DPC_ObjDet_dftFactors picks, the unsigned
+                 * multiply wraps a negative peak onto the DFT grid */
+                const cmplxfImRe_t *fac = &dftSinCosTable[((uint32_t)peakLoc * antPos[k]) % AOA_DFT_LEN];
+                batch.facRe[k][lane] = fac->real;
+                batch.facIm[k][lane] = fac->imag;
+            }
+        }
+
+        /* Every lane at once: both single bin DFTs and AzimVal * conj(ElevVal) */
+        {
+            ObjDetVec azRe, azIm, elRe, elIm;
+            DPC_ObjDet_batchDft(cfg, &batch, 0U, MAX_NUM_AZIM_VIRT_ANT, &azRe, &azIm);
+            DPC_ObjDet_batchDft(cfg, &batch, MAX_NUM_AZIM_VIRT_ANT, MAX_NUM_ELEV_VIRT_ANT, &elRe, &elIm);
+            ObjDet_vstore(batch.outRe, ObjDet_vadd(ObjDet_vmul(azRe, elRe), ObjDet_vmul(azIm, elIm)));
+            ObjDet_vstore(batch.outIm, ObjDet_vsub(ObjDet_vmul(azIm, elRe), ObjDet_vmul(azRe, elIm)));
+        }
+
+        /* Per object again: angles, coordinates and field of view, in list order */
+        for (lane = 0; lane < numLanes; lane++)
+        {
+            cmplxfImRe_t elevOutput;
+            elevOutput.real = batch.outRe[lane];
+            elevOutput.imag = batch.outIm[lane];
+            ValidObjIdx += DPC_ObjDet_xyzFromPhase(cfg, &detObjList[base + lane], batch.peakLoc[lane],
+                                                   elevOutput, &objOut[ValidObjIdx], &sideInfo[ValidObjIdx]);
+        }
+    }
+
+    return ValidObjIdx;
+}
+
+#endif /* OBJDET_SIMD_H */
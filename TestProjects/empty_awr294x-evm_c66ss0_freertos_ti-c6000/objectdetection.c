@@ -88,6 +88,9 @@
 #include <ti/datapath/dpc/objectdetection/objdethwaDDMA/include/objectdetectioninternal.h>
 #include <ti/datapath/dpc/objectdetection/objdethwaDDMA/objectdetection.h>
 
+/* DPC math shared with HostTools/dpc_sim.c */
+#include "objdet_math.h"
+
 /* Power Optimization configurations */
 #if defined(SOC_AWR2X44P)
 #define DPC_OBJDET_HWA_CG_ENABLE                  (0x2U)
@@ -106,10 +109,6 @@
 
 #define DOUBLEWORD_ALIGNED    (8U)
 
-#define QVALUE_NOISE          (11U)
-#define QVALUE_SIGNAL         (11U)
-
-
 /*! Radar cube data buffer alignment in bytes. */
 #if defined(SUBSYS_MSS) || defined (SUBSYS_M4)
 #define DPC_OBJDET_RADAR_CUBE_DATABUF_BYTE_ALIGNMENT      DPU_RANGEPROCHWA_RADARCUBE_BYTE_ALIGNMENT_R5F
@@ -130,26 +129,9 @@
 
 #define DPC_OBJDET_HWA_MAX_WINDOW_RAM_SIZE_IN_SAMPLES    (CSL_DSS_HWA_WINDOW_RAM_U_SIZE >> 3)
 
-#define DPC_USE_SYMMETRIC_WINDOW_RANGE_DPU
-#define DPC_USE_SYMMETRIC_WINDOW_DOPPLER_DPU
-#define DPC_DPU_RANGEPROC_FFT_WINDOW_TYPE                  MATHUTILS_WIN_HANNING
-#define DPC_DPU_RANGEPROC_INTERFMITIG_WINDOW_TYPE          MATHUTILS_WIN_HANNING
-#define DPC_DPU_DOPPLERPROC_FFT_WINDOW_TYPE                MATHUTILS_WIN_HANNING
-
-/*! Number of interference mitigation window samples. Used 16 as the size
-    instead of 14 because mathUtils generates the first and the last samples
-    as 0, which are not useful. */
-#define DPC_OBJDET_RANGEPROC_NUM_INTFMITIG_WIN_SIZE_TOTAL       (16U)
-
 /*! Interference mitigation window type */
 #define DPC_OBJDET_RANGEPROC_INTERFMITIG_WINDOW_TYPE            MATHUTILS_WIN_HANNING
 
-/*! Q Format of interference mitigation window */
-#define DPC_OBJDET_QFORMAT_RANGEPROC_INTERFMITIG_WINDOW         (5U)
-
-#define DPC_OBJDET_QFORMAT_RANGE_FFT 17
-#define DPC_OBJDET_QFORMAT_DOPPLER_FFT 17
-
 /* Number of Azim FFT Bins */
 #define OBJECTDETECTION_NUM_AZIM_FFT_BINS (32U)
 
@@ -178,6 +160,53 @@ typedef struct timingInfo
 timingInfo gTimingInfo;
 #endif
 
+/* Uncomment to run the AoA of each frame at the start of the next frame,
+   while the HWA does its range FFT, instead of right after the intersection.
+   This takes the AoA out of the inter-frame time, and the point cloud
+   comes out one frame later. Profiles with more than one sub-frame keep the
+   normal order because sub-frames share L3. */
+// #define DPC_OBJDET_PIPELINED_AOA
+
+/* Uncomment to let the DSP tune the BFP compression ratio of the radar cube
+   while frames run. The ratio of compressionCfg becomes the highest one and
+   the radar cube stays sized for it. Every DPC_OBJDET_COMP_TUNE_FRAMES
+   frames the ratio moves towards the lowest one whose predicted detection
+   SNR loss is within DPC_OBJDET_COMP_TUNE_LOSS_DB, which cuts the L3 traffic
+   of the range and Doppler DPUs. The ratio it settles on, in gDpcBfpTune,
+   is the one to put in the profile to shrink the radar cube. */
+// #define DPC_OBJDET_COMP_TUNE
+#define DPC_OBJDET_COMP_TUNE_LOSS_DB    (0.5F)  /* allowed detection SNR loss */
+#define DPC_OBJDET_COMP_TUNE_HYST_DB    (0.1F)  /* margin below the budget to go one ratio down */
+#define DPC_OBJDET_COMP_TUNE_MIN_RATIO  (0.25F) /* most aggressive ratio */
+#define DPC_OBJDET_COMP_TUNE_BLOCKS     (64U)   /* compressed blocks sampled per frame */
+#define DPC_OBJDET_COMP_TUNE_FRAMES     (16U)   /* frames per ratio decision */
+
+/* Uncomment one of these to record the frames the DSP runs into a buffer at
+   the end of L3, or to replay a capture loaded there (dpc_capture.h). Init
+   logs where the buffer is, the debugger saves its first usedSize bytes
+   after a recording and loads a capture there before a replay. A replay
+   puts the recorded radar cube in place of the one of the range FFT and
+   compares every list of the frame with the recorded one, so a change to
+   the Doppler, CFAR, intersection or AoA code can be checked for identical
+   detections. The radar cube takes most of the buffer, without it in
+   DPC_OBJDET_CAPTURE_SECTIONS far more frames fit, which
+   HostTools/dpc_sim.c can replay. The copies cost a few ms per frame. */
+// #define DPC_OBJDET_CAPTURE_RECORD
+// #define DPC_OBJDET_CAPTURE_REPLAY
+#define DPC_OBJDET_CAPTURE_SIZE         (512U * 1024U)  /* bytes taken off the end of L3 */
+#define DPC_OBJDET_CAPTURE_SECTIONS     (0x7FU)         /* DPC_OBJDET_CAPTURE_SEC_xxx bits recorded */
+
+#if defined(DPC_OBJDET_CAPTURE_RECORD) && defined(DPC_OBJDET_CAPTURE_REPLAY)
+#error "DPC_OBJDET_CAPTURE_RECORD and DPC_OBJDET_CAPTURE_REPLAY are exclusive"
+#endif
+#if defined(DPC_OBJDET_CAPTURE_REPLAY) && defined(DPC_OBJDET_COMP_TUNE)
+#error "a replay needs the compression ratio of the capture, DPC_OBJDET_COMP_TUNE changes it"
+#endif
+/* Only where the AoA runs */
+#if (defined(DPC_OBJDET_CAPTURE_RECORD) || defined(DPC_OBJDET_CAPTURE_REPLAY)) && defined(SUBSYS_DSS)
+#define DPC_OBJDET_CAPTURE
+#endif
+
 ObjDetObj gObjDetObj __attribute__((aligned(HeapP_BYTE_ALIGNMENT))) 
 #if SUBSYS_M4
 __attribute__((section(".dpcGlobals")))
@@ -201,9 +230,73 @@ uint8_t preProcBuffer[3U * RL_MAX_SUBFRAMES * 6U * 4U * (uint32_t)sizeof(uint32_
 finalDetObjList. */
 uint8_t gWinBuf[4096] __attribute__((section(".dpc_l2Heap")));
 
+/* Windows generated into gWinBuf, shared by the sub-frames that use the same
+ * window and kept across configurations. When a configuration's windows do
+ * not fit, it falls back to generating them into gWinBuf on every
+ * sub-frame switch. */
+static DPC_ObjDet_WinCache gWinCache;
+
 #define DOPPLER_MAXDOP_SUBBAND_BUFFER_SIZE 256U /* Allocated for 768 chirps, 6 subbands, 2 ping-pong */
 uint8_t dopMaxSubBandScratchBuf[DOPPLER_MAXDOP_SUBBAND_BUFFER_SIZE];
 
+/* One bit per range bin and Doppler sub bin, set for every range CFAR
+ * detection while the Doppler list is intersected with it. Sized for 128
+ * sub bins (768 chirps, 6 subbands) of 512 range bins; larger profiles
+ * fall back to searching the range CFAR list. */
+#define RANGECFAR_BITMAP_SIZE_WORDS 2048U
+uint32_t gRangeCfarBitmap[RANGECFAR_BITMAP_SIZE_WORDS];
+
+/* Doppler list indices of the detections kept by the intersection. The
+ * 96KB L2 heap holds at most 614 DetObjParams, so finalMaxNumDetObjs
+ * stays below this. */
+#define INTERSECT_MAX_VALID_OBJS 1024U
+uint16_t gIntersectValidIdx[INTERSECT_MAX_VALID_OBJS];
+
+/* Cycle counter stamps of the last execute call */
+DPC_ObjDet_StageTimes gDpcStageTimes;
+
+/* Memory map of every sub-frame and the one of the sub-frame being
+ * configured, which the config functions write their buffers into */
+DPC_ObjDet_MemMap gDpcMemMap[DPC_OBJDET_MEMMAP_MAX_SUBFRAMES];
+static DPC_ObjDet_MemMap *gMemMap;
+
+/* Pipelined AoA state and its two point cloud buffers. Buffer 0 is the
+ * sub-frame's own objOut/detObjOutSideInfo, buffer 1 is only allocated
+ * when DPC_OBJDET_PIPELINED_AOA is defined. */
+static DPC_ObjDet_AoaPipe gAoaPipe;
+static DPIF_PointCloudCartesian *gAoaObjOut[2];
+static DPIF_PointCloudSideInfo *gAoaSideInfo[2];
+
+/* HSRAM result slot of the frame being processed. With one set the point
+ * cloud goes there and the AoA buffers above are not used. */
+DPC_ObjDet_ResultSlot gDpcResultSlot;
+
+#ifdef DPC_OBJDET_COMP_TUNE
+/* Compression ratio tuner of every sub-frame, and the block powers of the
+ * frame being sampled */
+DPC_ObjDet_BfpTune gDpcBfpTune[RL_MAX_SUBFRAMES];
+static float gBfpTunePower[DPC_OBJDET_BFP_TUNE_MAX_BLOCKS];
+#endif
+
+#ifdef DPC_OBJDET_CAPTURE
+/* Capture being recorded or replayed */
+typedef struct DPC_ObjDet_Capture_t
+{
+    uint8_t                 *buf;           /*!< end of L3, the file of the capture */
+    uint32_t                size;           /*!< bytes of buf */
+    DPC_ObjDet_CaptureHdr   *hdr;           /*!< NULL when there is nothing to record or replay */
+    DPC_ObjDet_CaptureRec   *rec;           /*!< record of this frame, NULL when dropped or skipped */
+    DPC_ObjDet_CaptureRec   *aoaRec;        /*!< record of the frame the next AoA computes the points of */
+    const DPC_ObjDet_CaptureRec *replayRec; /*!< last record replayed */
+    uint32_t                numDiffer;      /*!< sections of rec that differed */
+    uint32_t                aoaNumDiffer;   /*!< sections of aoaRec that differed */
+    uint32_t                frameIdx;       /*!< frames since start */
+    DPC_ObjDet_CaptureStats stats;          /*!< outcome of the replay */
+} DPC_ObjDet_Capture;
+
+DPC_ObjDet_Capture gDpcCapture;
+#endif
+
 /**************************************************************************
  ************************** Local Functions Declarations ******************
  **************************************************************************/
@@ -266,6 +359,22 @@ static int32_t DPC_ObjDet_rangeCfarConfig(DPU_RangeCFARProcHWA_Handle dpuHandle,
 
 static int32_t DPC_ObjDet_reconfigSubFrame(ObjDetObj *objDetObj, uint8_t subFrameIndx);
 
+#ifdef DPC_OBJDET_COMP_TUNE
+static void DPC_ObjDet_compTuneConfig(ObjDetObj *objDetObj, SubFrameObj *subFrmObj, uint8_t subFrameIndx);
+static int32_t DPC_ObjDet_compTuneDecide(ObjDetObj *objDetObj, SubFrameObj *subFrmObj);
+#endif
+
+#ifdef DPC_OBJDET_CAPTURE
+static void DPC_ObjDet_captureSetup(ObjDetObj *objDetObj);
+static void DPC_ObjDet_captureStart(ObjDetObj *objDetObj);
+static void DPC_ObjDet_captureRange(ObjDetObj *objDetObj, SubFrameObj *subFrmObj);
+static void DPC_ObjDet_captureLists(SubFrameObj *subFrmObj, const DetObjParams *detObjList,
+                                    uint32_t numDopObjs, uint32_t finalNumDetObjs);
+static void DPC_ObjDet_capturePoints(const DPIF_PointCloudCartesian *objOut,
+                                     const DPIF_PointCloudSideInfo *objOutSideInfo, uint32_t numObjOut);
+static void DPC_ObjDet_captureStop(void);
+#endif
+
 static void DPC_ObjDet_EDMAChannelConfigAssist(EDMA_Handle handle, uint32_t chNum, uint32_t shadowParam, uint32_t eventQueue, DPEDMA_ChanCfg *chanCfg);
 
 static void DPC_ObjectDetection_ConfigureADCBuf(uint16_t rxChannelEn, uint32_t chanDataSize);
@@ -326,129 +435,6 @@ DPM_ProcChainCfg gDPC_ObjectDetectionCfg =
 /**************************************************************************
  ************************** Local Functions *******************************
  **************************************************************************/
-/**
- *  @b Description
- *  @n
- *      Utility function for reseting memory pool.
- *
- *  @param[in]  pool Handle to pool object.
- *
- *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
- *
- *  @retval
- *      none.
- */
-static void DPC_ObjDet_MemPoolReset(MemPoolObj *pool)
-{
-    pool->currAddr = (uintptr_t)pool->cfg.addr;
-    pool->maxCurrAddr = pool->currAddr;
-}
-
-/**
- *  @b Description
- *  @n
- *      Utility function for setting memory pool to desired address in the pool.
- *      Helps to rewind for example.
- *
- *  @param[in]  pool Handle to pool object.
- *  @param[in]  addr Address to assign to the pool's current address.
- *
- *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
- *
- *  @retval
- *      None
- */
-static void DPC_ObjDet_MemPoolSet(MemPoolObj *pool, void *addr)
-{
-    pool->currAddr = (uintptr_t)addr;
-    pool->maxCurrAddr = CSL_MAX(pool->currAddr, pool->maxCurrAddr);
-}
-
-/**
- *  @b Description
- *  @n
- *      Utility function for getting memory pool current address.
- *
- *  @param[in]  pool Handle to pool object.
- *
- *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
- *
- *  @retval
- *      pointer to current address of the pool (from which next allocation will
- *      allocate to the desired alignment).
- */
-static void *DPC_ObjDet_MemPoolGet(MemPoolObj *pool)
-{
-    return((void *)pool->currAddr);
-}
-
-#if 0 /* may be useful in future */
-/**
- *  @b Description
- *  @n
- *      Utility function for getting current memory pool usage.
- *
- *  @param[in]  pool Handle to pool object.
- *
- *  @retval
- *      Amount of pool used in bytes.
- */
-static uint32_t DPC_ObjDet_MemPoolGetCurrentUsage(MemPoolObj *pool)
-{
-    return((uint32_t)(pool->currAddr - (uintptr_t)pool->cfg.addr));
-}
-#endif
-
-/**
- *  @b Description
- *  @n
- *      Utility function for getting maximum memory pool usage.
- *
- *  @param[in]  pool Handle to pool object.
- *
- *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
- *
- *  @retval
- *      Amount of pool used in bytes.
- */
-static uint32_t DPC_ObjDet_MemPoolGetMaxUsage(MemPoolObj *pool)
-{
-    return((uint32_t)(pool->maxCurrAddr - (uintptr_t)pool->cfg.addr));
-}
-
-/**
- *  @b Description
- *  @n
- *      Utility function for allocating from a static memory pool.
- *
- *  @param[in]  pool Handle to pool object.
- *  @param[in]  size Size in bytes to be allocated.
- *  @param[in]  align Alignment in bytes
- *
- *  \ingroup DPC_OBJDET__INTERNAL_FUNCTION
- *
- *  @retval
- *      pointer to beginning of allocated block. NULL indicates could not
- *      allocate.
- */
-static void *DPC_ObjDet_MemPoolAlloc(MemPoolObj *pool,
-                              uint32_t size,
-                              uint8_t align)
-{
-    void *retAddr = NULL;
-    uintptr_t addr;
-
-    addr = CSL_MEM_ALIGN(pool->currAddr, align);
-    if ((addr + size) <= ((uintptr_t)pool->cfg.addr + pool->cfg.size))
-    {
-        retAddr = (void *)addr;
-        pool->currAddr = addr + size;
-        pool->maxCurrAddr = CSL_MAX(pool->currAddr, pool->maxCurrAddr);
-    }
-
-    return (retAddr);
-}
-
 #ifdef INCLUDE_DPM
 
 /**
@@ -557,17 +543,7 @@ void DPC_ObjectDetection_frameStart(DPM_DPCHandle handle)
  */
 static uint32_t DPC_ObjDet_GetRangeWinGenLen(DPU_RangeProcHWA_Config *cfg)
 {
-    uint16_t numAdcSamples;
-    uint32_t winGenLen;
-
-    numAdcSamples = cfg->staticCfg.ADCBufData.dataProperty.numAdcSamples;
-
-#ifdef DPC_USE_SYMMETRIC_WINDOW_RANGE_DPU
-    winGenLen = ((uint32_t)numAdcSamples + 1U) / 2U;
-#else
-    winGenLen = numAdcSamples;
-#endif
-    return (winGenLen);
+    return (DPC_ObjDet_rangeWinGenLen(cfg->staticCfg.ADCBufData.dataProperty.numAdcSamples));
 }
 
 /**
@@ -584,30 +560,10 @@ static uint32_t DPC_ObjDet_GetRangeWinGenLen(DPU_RangeProcHWA_Config *cfg)
  */
 static void DPC_ObjDet_GenRangeWindow(DPU_RangeProcHWA_Config *cfg)
 {
-
-    /* Symmetric window */
-    uint32_t interfMitigWindow[DPC_OBJDET_RANGEPROC_NUM_INTFMITIG_WIN_SIZE_TOTAL >> 1];
-    uint8_t idx;
-
-    mathUtils_genWindow((uint32_t *)interfMitigWindow,
-                        DPC_OBJDET_RANGEPROC_NUM_INTFMITIG_WIN_SIZE_TOTAL,
-                        DPC_OBJDET_RANGEPROC_NUM_INTFMITIG_WIN_SIZE_TOTAL >> 1,
-                        DPC_DPU_RANGEPROC_INTERFMITIG_WINDOW_TYPE,
-                        DPC_OBJDET_QFORMAT_RANGEPROC_INTERFMITIG_WINDOW);
-
-    /* Only 5 win samples are supported by the HWA */
-    for (idx = 0; idx < DPU_RANGEPROCHWADDMA_NUM_INTFMITIG_WIN_HWACOMMONCFG_SIZE; idx++)
-    {
-        cfg->hwRes.hwaCfg.hwaInterfMitigWindow[DPU_RANGEPROCHWADDMA_NUM_INTFMITIG_WIN_HWACOMMONCFG_SIZE - 1U - idx] =
-            (uint8_t)interfMitigWindow[(DPC_OBJDET_RANGEPROC_NUM_INTFMITIG_WIN_SIZE_TOTAL >> 1U) - 2U - idx];
-    }
-
-    /* Range FFT window */
-    mathUtils_genWindow((uint32_t *)cfg->staticCfg.window,
-                        cfg->staticCfg.ADCBufData.dataProperty.numAdcSamples,
-                        DPC_ObjDet_GetRangeWinGenLen(cfg),
-                        DPC_DPU_RANGEPROC_FFT_WINDOW_TYPE,
-                        DPC_OBJDET_QFORMAT_RANGE_FFT);
+    DPC_ObjDet_genRangeWindow((uint32_t *)cfg->staticCfg.window,
+                              cfg->staticCfg.ADCBufData.dataProperty.numAdcSamples,
+                              cfg->hwRes.hwaCfg.hwaInterfMitigWindow,
+                              DPU_RANGEPROCHWADDMA_NUM_INTFMITIG_WIN_HWACOMMONCFG_SIZE);
 }
 
 /**
@@ -623,17 +579,7 @@ static void DPC_ObjDet_GenRangeWindow(DPU_RangeProcHWA_Config *cfg)
  */
 static uint32_t DPC_ObjDet_GetDopplerWinGenLen(DPU_DopplerProcHWA_Config *cfg)
 {
-    uint16_t numDopplerChirps;
-    uint32_t winGenLen;
-
-    numDopplerChirps = cfg->staticCfg.numChirps;
-
-#ifdef DPC_USE_SYMMETRIC_WINDOW_DOPPLER_DPU
-    winGenLen = ((uint32_t)numDopplerChirps + 1U) / 2U;
-#else
-    winGenLen = numDopplerChirps;
-#endif
-    return (winGenLen);
+    return (DPC_ObjDet_dopplerWinGenLen(cfg->staticCfg.numChirps));
 }
 
 /**
@@ -650,26 +596,8 @@ static uint32_t DPC_ObjDet_GetDopplerWinGenLen(DPU_DopplerProcHWA_Config *cfg)
  */
 static uint32_t DPC_ObjDet_GenDopplerWindow(DPU_DopplerProcHWA_Config *cfg)
 {
-    uint32_t winType;
-
-    /* For too small window, force rectangular window to avoid loss of information
-     * due to small window values (e.g. hanning has first and last coefficients 0) */
-    if (cfg->staticCfg.numChirps <= 4U)
-    {
-        winType = MATHUTILS_WIN_RECT;
-    }
-    else
-    {
-        winType = DPC_DPU_DOPPLERPROC_FFT_WINDOW_TYPE;
-    }
-
-    mathUtils_genWindow((uint32_t *)cfg->hwRes.hwaCfg.window,
-                        cfg->staticCfg.numChirps,
-                        DPC_ObjDet_GetDopplerWinGenLen(cfg),
-                        winType,
-                        DPC_OBJDET_QFORMAT_DOPPLER_FFT);
-
-    return (winType);
+    return (DPC_ObjDet_genDopplerWindow((uint32_t *)cfg->hwRes.hwaCfg.window,
+                                        cfg->staticCfg.numChirps));
 }
 
 /**
@@ -797,154 +725,7 @@ exit:
     return retVal;
 }
 
-/**
- *  @b Description
- *  @n
- *     Function checks if the same object is present
- *     in both the rangeCFAR detected object list and the
- *     dopplerProc detected object list (also called doppler
- *     list)
- *
- *  @param[in]  rangeIdx  range index of the object (from the doppler list)
- *  @param[in]  dopIdx    doppler index of the object (from the doppler list)
- *  @param[in]  rangeCfarList list of rangeCFAR detected objects.
- *  @param[in]  numObjToSearch number of Objects to search.
- *  @retval   boolean indicating presence (true) or absence (false).
- *
- * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
- */
-static inline uint32_t isObjInRangeAndDopplerList(const uint32_t rangeIdx,
-                                          const uint32_t dopIdx,
-                                            RangeCfarListObj *rangeCfarList,
-                                            uint32_t numObjToSearch)
-{
-    uint32_t idx;
-    for (idx = 0; idx < numObjToSearch; idx++)
-    {
-        if (rangeCfarList[idx].rangeIdx == rangeIdx)
-        {
-            if (rangeCfarList[idx].dopIdx == dopIdx)
-            {
-                return 1;
-            }
-        }
-    }
-
-    return 0;
-}
-
 #ifdef SUBSYS_DSS
-
-
-/**
- *  @b Description
- *  @n
- *     Function performs quadratic interpolation around a peak
- *
- *  @param[in]  y A Three sample array ([y0,y1,y2]) where
- *              (y1 > y2) and (y1 > y0)
- *
- *  @retval   location of the interpolated peak, relative to y1.
- *
- * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
- */
-static inline float DPC_ObjDet_quadInterpAroundPeak(const uint32_t * restrict y)
-{
-
-    float ym1, y0, yp1;
-    float thetapk; //, yOut;
-
-    ym1 = (float) y[0]; /* y(peak-1) */
-    y0  = (float) y[1]; /* y(peak) */
-    yp1 = (float) y[2]; /* y(peak+1) */
-
-    thetapk = divsp((yp1 - ym1), (2 * (2 * y0 - yp1 - ym1)));
-    /* yOut = y0 + (((yp1 - ym1) / 4) * thetapk); */
-
-    return thetapk;
-
-}
-
-/**
- *  This routine calculates the dot product of 2 single-precision complex
- *  float vectors. The even numbered locations hold the real parts of the
- *  complex numbers while the odd numbered locations contain the imaginary
- *  portions. It is an exact copy of the DSPF_sp_dotp_cmplx function from
- *  the DSPLIB.
- *
- *         @param x   Pointer to array holding the first floating-point vector
- *         @param y   Pointer to array holding the second floating-point vector
- *         @param nx  Number of values in the x and y vectors
- *         @param re  Pointer to the location storing the real part of the result
- *         @param im  Pointer to the location storing the imaginary part of the result
- *
- * @par Assumptions:
- *   Loop counter must be multiple of 4 and > 0. <BR>
- *   The x and y arrays must be double-word aligned. <BR>
- *
- *
- */
-static inline void dotpCmplxf(const float * restrict x, const float * restrict y, int nx,
-                       float * restrict re, float * restrict im)
-{
-    int i;
-    __float2_t x0_im_re, y0_im_re, result0 = 0;
-    __float2_t x1_im_re, y1_im_re, result1 = 0;
-    __float2_t x2_im_re, y2_im_re, result2 = 0;
-    __float2_t x3_im_re, y3_im_re, result3 = 0;
-    __float2_t result;
-
-    _nassert(nx % 4 == 0);
-    _nassert(nx > 0);
-    _nassert((int)x % 8 == 0);
-    _nassert((int)y % 8 == 0);
-
-    for(i = 0; i < 2 * nx; i += 8)
-    {
-        /* load 4 sets of input data */
-        x0_im_re = _amem8_f2((void*)&x[i]);
-        y0_im_re = _amem8_f2((void*)&y[i]);
-
-        x1_im_re = _amem8_f2((void*)&x[i+2]);
-        y1_im_re = _amem8_f2((void*)&y[i+2]);
-
-        x2_im_re = _amem8_f2((void*)&x[i+4]);
-        y2_im_re = _amem8_f2((void*)&y[i+4]);
-
-        x3_im_re = _amem8_f2((void*)&x[i+6]);
-        y3_im_re = _amem8_f2((void*)&y[i+6]);
-
-        /* calculate 4 running sums */
-        result0 = _daddsp(_complex_mpysp(x0_im_re, y0_im_re), result0);
-        result1 = _daddsp(_complex_mpysp(x1_im_re, y1_im_re), result1);
-        result2 = _daddsp(_complex_mpysp(x2_im_re, y2_im_re), result2);
-        result3 = _daddsp(_complex_mpysp(x3_im_re, y3_im_re), result3);
-    }
-
-    result = _daddsp(_daddsp(result0,result1),_daddsp(result2,result3));
-    *re =  _hif2(result);
-    *im =  _lof2(result);
-}
-
-/*! @brief  Complex data type, natural for C66x complex
- * multiplication instructions. */
-typedef struct cmplxfImRe_t_
-{
-    float imag; /*!< @brief imaginary part */
-    float real; /*!< @brief real part */
-} cmplxfImRe_t;
-/*! @brief  Complex union type, natural for C66x intrinsic
- * instructions. */
-typedef union cmplxfUnion_t_
-{
-	cmplxfImRe_t cmplx;
-	float dat[2];
-	double ddat;
-}cmplxfUnion_t;
-
-/*! @brief  Unsigned round (for floats). */
-#define ROUND_UNSIGNED(x) ((x) + 0.5f)
-#define AOA_DFT_LEN (128)
 /* A simple sin-cos LUT used for the DFT computations in
  * DPC_ObjDet_estimateXYZ */
 cmplxfImRe_t dftSinCosTable[AOA_DFT_LEN] __attribute__((aligned(8))) = {
@@ -960,6 +741,7 @@ cmplxfImRe_t dftSinCosTable[AOA_DFT_LEN] __attribute__((aligned(8))) = {
  *  @param[in]  objDetObj   DPC object detection object
  *  @param[in]  detObjList  Detected object list
  *  @param[out] objOut      List with x, y, z coordinates populated for each object
+ *  @param[out] objOutSideInfo  SNR and noise for each object in objOut
  *  @param[in]  numObjOut   Number of detected objects
  *  @param[out] finalNumObjOut  Number of validated objects
  *
@@ -971,264 +753,77 @@ int32_t DPC_ObjDet_estimateXYZ(SubFrameObj * restrict subFrmObj,
                                ObjDetObj * restrict objDetObj,
                                const DetObjParams * restrict detObjList,
                                DPIF_PointCloudCartesian * restrict objOut,
+                               DPIF_PointCloudSideInfo * restrict objOutSideInfo,
                                uint32_t numObjOut,
                                uint32_t * restrict finalNumObjOut)
 {
-
-    uint16_t azimFFTSize = subFrmObj->dpuCfg.dopplerCfg.staticCfg.numAzimFFTBins;
-    const float invAzimFFTSize = divsp(1.0f,(float) azimFFTSize);
-    uint32_t objIdx, sampIdx, idx;
-    uint32_t maxAzimMaskWidth = 8*sizeof(objDetObj->commonCfg.zeroInsrtMaskCfg.zeroInsrtMaskAzim);
-    uint32_t maxElevMaskWidth = 8*sizeof(objDetObj->commonCfg.zeroInsrtMaskCfg.zeroInsrtMaskElev);
-    int32_t currLoc;
-    float noisedB, signaldB, snrdB;
-    float peakIdxOffset, peakIdxFlt;
-    int32_t peakLoc;
-    float    azimSinPhase;
-    cmplxfUnion_t DFTValAzim, DFTValElev, elevOutput;
-    float  elevSinPhase, elevCosPhase;
-    float rangeStep, range, dopplerStep, x, ySquared, z;
-    float wz,peakLocFlt, peakIdxFlt_DFT;
-    int32_t dopIdx;
-    uint32_t numDopplerBins = subFrmObj->staticCfg.numDopplerBins;
-    int16_t ValidObjIdx;
-
-    /* Alignment is to be done because we use the antenna calib params for
-     * multiplication, using optimized DSP routines, which require a 8 byte alignment */
-    cmplxfImRe_t samplesCalib[MAX_NUM_VIRT_ANT] __attribute__((aligned(8)));
-    cmplx32ImRe_t rearrangedAzimSamples[MAX_NUM_AZIM_VIRT_ANT] __attribute__((aligned(8)));
-    cmplx32ImRe_t rearrangedElevSamples[MAX_NUM_ELEV_VIRT_ANT] __attribute__((aligned(8)));
-
     int32_t retVal = 0;
-    cmplxfImRe_t dftFactorsAzim[MAX_NUM_AZIM_VIRT_ANT] __attribute__((aligned(8)));
-    cmplxfImRe_t dftFactorsElev[MAX_NUM_ELEV_VIRT_ANT] __attribute__((aligned(8)));
-    double * azimSamplesCalib = (double *)&samplesCalib[0];
-    double * elevSamplesCalib = (double *)&samplesCalib[MAX_NUM_AZIM_VIRT_ANT];
-    int64_t  * restrict azimSamples;
-    int64_t  * restrict elevSamples;
-    double samplesFlt2;
-    double *antennaCalibParams = (double *)&objDetObj->commonCfg.antennaCalibParams[0];
-
-    rangeStep = subFrmObj->staticCfg.rangeStep;
-    dopplerStep = subFrmObj->staticCfg.dopplerStep;
-
-    /* This variable will index the final object list */
-    ValidObjIdx = 0;
-
-    for (objIdx = 0; objIdx < numObjOut; objIdx++)
-    {
-        /* 1. Interpolate around peak to get fractional estimate of Azimuth index */
-        peakIdxOffset = DPC_ObjDet_quadInterpAroundPeak(detObjList[objIdx].azimPeakSamples);
-
-        /* Correct peak index with the fractional index*/
-        peakIdxFlt = (float)detObjList[objIdx].azimIdx + peakIdxOffset;
-        peakIdxFlt_DFT = peakIdxFlt * (invAzimFFTSize * AOA_DFT_LEN);
-        peakLoc = ROUND_UNSIGNED(peakIdxFlt_DFT);
-
-
-        /* 2a. Calculate DFT Factors corresponding to wx for Row 1.
-            *  i.e. calculate \f$\e^{j wx}\f$
-            */
-        idx = 0;
-        for (sampIdx = 0; sampIdx < maxAzimMaskWidth; sampIdx ++)
-        {
-            if((objDetObj->commonCfg.zeroInsrtMaskCfg.zeroInsrtMaskAzim >> sampIdx) & 0x1U)
-            {
-                currLoc = (peakLoc*sampIdx)%AOA_DFT_LEN;
-                dftFactorsAzim[idx++] = dftSinCosTable[currLoc];
-            }
-
-            /* Break the loop after computing all dft factors in azimuth dimension */
-            if(idx == MAX_NUM_AZIM_VIRT_ANT)
-                break;
-        }
-
-        /* 2b. Calculate DFT Factors corresponding to wx for Row 0.
-            *  i.e. calculate \f$\e^{j wx}\f$
-            */
-        idx = 0;
-        for (sampIdx = 0; sampIdx < maxElevMaskWidth; sampIdx ++)
-        {
-            if((objDetObj->commonCfg.zeroInsrtMaskCfg.zeroInsrtMaskElev >> sampIdx) & 0x1U)
-            {
-                currLoc = (peakLoc*sampIdx)%AOA_DFT_LEN;
-                dftFactorsElev[idx++] = dftSinCosTable[currLoc];
-            }
-
-            /* Break the loop after computing all dft factors in elevation dimension */
-            if(idx == MAX_NUM_ELEV_VIRT_ANT)
-                break;
-        }
-
-        /* 2c. Rearrange the antenna samples according to the virtual antenna mapping. */
-        for (sampIdx = 0; sampIdx < MAX_NUM_AZIM_VIRT_ANT; sampIdx ++)
-        {
-            rearrangedAzimSamples[sampIdx] = detObjList[objIdx].azimSamples[objDetObj->commonCfg.antennaGeometryCfg[sampIdx]];
-        }
-
-        for (sampIdx = 0; sampIdx < MAX_NUM_ELEV_VIRT_ANT; sampIdx ++)
-        {
-            rearrangedElevSamples[sampIdx] = detObjList[objIdx].elevSamples[objDetObj->commonCfg.antennaGeometryCfg[MAX_NUM_AZIM_VIRT_ANT+sampIdx]];
-        }
-
-        azimSamples = (int64_t*) rearrangedAzimSamples;
-        elevSamples = (int64_t*) rearrangedElevSamples;
-
-        /* 3. Azimuth Antenna Calibration:
-            * Multiply azimuth samples (azimSamples) of Doppler FFT with antenna calib params (antennaCalibParams)
-            */
-
-        for (sampIdx = 0; sampIdx < MAX_NUM_AZIM_VIRT_ANT; sampIdx++)
-        {
-            samplesFlt2 = _dintsp(azimSamples[sampIdx]);
-            azimSamplesCalib[sampIdx] =  _complex_mpysp(samplesFlt2,antennaCalibParams[sampIdx]);
-        }
-
-        /* 4. Elevation Antenna calibration
-            * Multiply elev samples with antenna calib params  */
-        for (sampIdx = MAX_NUM_AZIM_VIRT_ANT; sampIdx < MAX_NUM_VIRT_ANT ; sampIdx++ )
-        {
-            samplesFlt2 = _dintsp(elevSamples[sampIdx - MAX_NUM_AZIM_VIRT_ANT]);
-            elevSamplesCalib[sampIdx-MAX_NUM_AZIM_VIRT_ANT] = _complex_mpysp(samplesFlt2, antennaCalibParams[sampIdx]);
-        }
-
-        /* 5. Single Bin DFT on the azimuth antennas to estimate phase at peak.
-            *
-            \f[
-            X_{azim} (\omega_x) = \sum_{k=0}^{N_{azim} - 1} azimSample(k)  e^{-j k \omega_x}
-            \f]
-            * Multiply DFT factors with azimuth of Doppler FFT samples corrected for antenna calibration.
-            */
-        dotpCmplxf((float *)&azimSamplesCalib[0], (float *)&dftFactorsAzim[0], MAX_NUM_AZIM_VIRT_ANT, &DFTValAzim.cmplx.real, &DFTValAzim.cmplx.imag);
-
-
-        /* 6.  Single Bin DFT on the elevation antennas to estimate phase at peak.
-            *
-            \f[
-            X_{elev} (\omega_x) = \sum_{k=0}^{N_{elev} - 1} elevSample(k)  e^{-j (k+2) \omega_x}
-            \f]
-            * The elevation antennas (essentially the 4 virtual antennas corresponding to the
-            * elevation offset Tx antenna) are 4 in number and offset by 3 positions from the
-            * azimuth virtual array. Hence when the DFT is computed, begin from the 3rd DFT parameter.
-            *
-            * Both elevSamplesCalib and cosValSinVal[4] are double-word aligned. */
-        dotpCmplxf((float *)&elevSamplesCalib[0], (float *)&dftFactorsElev[0], MAX_NUM_ELEV_VIRT_ANT, &DFTValElev.cmplx.real, &DFTValElev.cmplx.imag);
-
-        /* 7. Estimate phase difference between the peak location at azimuth antennas and elevation antennas at peak.
-            *  - 1. compute the conjugate product to get the phase difference (i.e. AzimVal * conj(ElevVal)) */
-        elevOutput.ddat =  _complex_conjugate_mpysp (DFTValElev.ddat, DFTValAzim.ddat);
-
-
-        /* - 2. Compute the angle of the product to estimate the phase change in elevation.
-            \f[
-            \omega_z = angle (\ X_{elev} (\omega_x)' \times X_{azim} (\omega_x) )\
-            \f]
-        */
-        if (fabsf(elevOutput.cmplx.imag) < (0.15f*fabsf(elevOutput.cmplx.real)))
-        {
-            // small angle approximation.
-            wz = divsp(elevOutput.cmplx.imag, elevOutput.cmplx.real);
-        }
-        else
-        {
-            wz = atan2sp(elevOutput.cmplx.imag, elevOutput.cmplx.real);
-            if (wz > PI_)
-            {
-                    wz -= 2.0f*PI_;
-            }
-        }
-
-        /* 8. Obtain range using the range resolution and the range Index  */
-        range = rangeStep * (float)detObjList[objIdx].rangeIdx;
-
-        /* 9. Obtain z, x coordinates.
-            \f[
-            \Phi = asin(\frac{\omega_z}{2 \pi d_z})
-            \f]
+    DPC_ObjDet_XYZCfg xyzCfg;
+
+    /* The math itself lives in objdet_math.h so it can also be run by HostTools/dpc_sim.c */
+    xyzCfg.antennaCalibParams = &objDetObj->commonCfg.antennaCalibParams[0];
+    xyzCfg.antennaGeometryCfg = &objDetObj->commonCfg.antennaGeometryCfg[0];
+    xyzCfg.zeroInsrtMaskAzim = objDetObj->commonCfg.zeroInsrtMaskCfg.zeroInsrtMaskAzim;
+    xyzCfg.zeroInsrtMaskElev = objDetObj->commonCfg.zeroInsrtMaskCfg.zeroInsrtMaskElev;
+    xyzCfg.xSpacingByLambda = objDetObj->commonCfg.antennaSpacing.xSpacingByLambda;
+    xyzCfg.zSpacingByLambda = objDetObj->commonCfg.antennaSpacing.zSpacingByLambda;
+    xyzCfg.rangeStep = subFrmObj->staticCfg.rangeStep;
+    xyzCfg.dopplerStep = subFrmObj->staticCfg.dopplerStep;
+    xyzCfg.numAzimFFTBins = subFrmObj->dpuCfg.dopplerCfg.staticCfg.numAzimFFTBins;
+    xyzCfg.numDopplerBins = subFrmObj->staticCfg.numDopplerBins;
+    xyzCfg.fov = subFrmObj->aoaFovSinVal;
+
+    *finalNumObjOut = DPC_ObjDet_estimateXYZKernel(&xyzCfg, detObjList, numObjOut,
+                                                   objOut, objOutSideInfo);
 
-        \f[
-            z = range \times sin(\phi) = range * \frac{\omega_z}{2 \pi d_z}
-        \f]
-
-        */
-        elevSinPhase = wz * (1.0f / (2.0f * PI_ * objDetObj->commonCfg.antennaSpacing.zSpacingByLambda));
-        if ((elevSinPhase > subFrmObj->aoaFovSinVal.minElevationSinVal) && (elevSinPhase < subFrmObj->aoaFovSinVal.maxElevationSinVal))
-        {
-            z = range * elevSinPhase;
-
-            /*
-            \f[
-                x = range  cos(\phi)  sin(\theta) =  range  /frac{\omega_x}{2 \pi d_x}
-            \f]
-
-            */
-            peakLocFlt = peakLoc * (1.0f/ AOA_DFT_LEN);
-            if (peakLocFlt > 0.5f)
-            {
-                peakLocFlt -= 1.0f;
-            }
+    return retVal;
+}
 
-            x = range * peakLocFlt * (1.0f / objDetObj->commonCfg.antennaSpacing.xSpacingByLambda);
+/**
+ *  @b Description
+ *  @n
+ *     Function runs the AoA on the detections in the sub-frame's
+ *     finalDetObjList and stamps its start and end.
+ *
+ *  @param[in]  objDetObj   DPC object detection object
+ *  @param[in]  subFrmObj   Sub-frame the detections belong to
+ *  @param[in]  numDetObjs  Number of detections in finalDetObjList
+ *  @param[out] objOut      Point cloud
+ *  @param[out] objOutSideInfo  Point cloud side info
+ *  @param[out] numObjOut   Number of points in objOut
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static int32_t DPC_ObjDet_runAoa(ObjDetObj *objDetObj,
+                                 SubFrameObj *subFrmObj,
+                                 uint32_t numDetObjs,
+                                 DPIF_PointCloudCartesian *objOut,
+                                 DPIF_PointCloudSideInfo *objOutSideInfo,
+                                 uint32_t *numObjOut)
+{
+    int32_t retVal;
 
-            /* Obtain 'square of y' coordinate
-                \f[
-                y^2 = range^2 -x^2 - z^2
-            \f]
-            */
-            ySquared = (range * range) - (z * z) - (x * x);
+    gDpcStageTimes.aoaStart = CycleCounterP_getCount32();
+#ifdef OBJECTDETHWA_PRINT_DPC_TIMING_INFO
+    gTimingInfo.aoaStartTimes[gTimingInfo.aoaStartCnt % OBJECTDETHWA_NUM_FRAME_TIMING_TO_STORE] = gDpcStageTimes.aoaStart;
+    gTimingInfo.aoaStartCnt++;
+#endif
 
-            /* It is possible that ySquared is less than zero (i.e. a degenerate case). In such a case ignore the object.
-                * If the case is not degenerate, proceed to check if the object is in the field of view (FoV).
-                * If so , store the newly validated object in the final object list.*/
-            if (ySquared > 0)
-            {
-                /* Estimate azimuth phase.
-                    \f[
-                    sin(\Theta) = \frac{x}{range \times cos(\Phi)}
-                    \f]
-                */
-                elevCosPhase = sqrtsp(1 - (elevSinPhase * elevSinPhase));
-                azimSinPhase = divsp(x, (range * elevCosPhase));
-
-                /* Check if object is in azimuth FoV, If object is in FoV, proceed to store the coordinates in the final object list */
-                if ((azimSinPhase > subFrmObj->aoaFovSinVal.minAzimuthSinVal) && (azimSinPhase < subFrmObj->aoaFovSinVal.maxAzimuthSinVal))
-                {
+    retVal = DPC_ObjDet_estimateXYZ(subFrmObj, objDetObj, subFrmObj->dpuCfg.dopplerCfg.hwRes.finalDetObjList,
+                                    objOut, objOutSideInfo, numDetObjs, numObjOut);
 
-                    /* Store x, y, z values */
-                    objOut[ValidObjIdx].z = z;
-                    objOut[ValidObjIdx].x = x;
-                    objOut[ValidObjIdx].y = sqrtsp(ySquared);
-
-                    /* Obtain and store Velocity */
-                    if (detObjList[objIdx].dopIdxActual > numDopplerBins / 2)
-                    {
-                        dopIdx = detObjList[objIdx].dopIdxActual - numDopplerBins;
-                    }
-                    else
-                    {
-                        dopIdx = detObjList[objIdx].dopIdxActual;
-                    }
-                    objOut[ValidObjIdx].velocity = dopIdx * dopplerStep;
-
-                    /* Calcute the side info of final detected object */
-                    /* output is 20*log10(2)*value/2^(QVALUE) */
-                    noisedB = 6.0 * ((float)detObjList[objIdx].dopCfarNoise) * (1.0f/(1 << QVALUE_NOISE));
-                    signaldB = 6.0 * ((float)detObjList[objIdx].azimPeakSamples[1]) * (1.0f/(1<<QVALUE_SIGNAL));
-                    snrdB = signaldB - noisedB;
-
-                    subFrmObj->detObjOutSideInfo[ValidObjIdx].snr = (int)(10*snrdB);
-                    subFrmObj->detObjOutSideInfo[ValidObjIdx].noise = (int)(10*noisedB);
-
-                    /* Increment output list index */
-                    ValidObjIdx++;
-                }
-            }
-        } /* End of elevation FoV check cond */
-    }
-    *finalNumObjOut = ValidObjIdx;
+    gDpcStageTimes.aoaEnd = CycleCounterP_getCount32();
+    gDpcStageTimes.numDetObjs = numDetObjs;
+#ifdef OBJECTDETHWA_PRINT_DPC_TIMING_INFO
+    gTimingInfo.aoaEndTimes[gTimingInfo.aoaEndCnt % OBJECTDETHWA_NUM_FRAME_TIMING_TO_STORE] = gDpcStageTimes.aoaEnd;
+    gTimingInfo.aoaEndCnt++;
+#endif
 
-    goto exit;
-exit:
     return retVal;
 }
 #endif
@@ -1522,12 +1117,15 @@ static int32_t DPC_ObjDet_intersectDopAndRangeCFAR(
 )
 {
     int32_t retVal=0;
-    uint16_t valSubBinObj, cfarListStartIdx;
-    uint32_t isValidObj, objIdx, dopIdx, finalNumObjs = 0;
+    uint32_t isValidObj, objIdx, finalNumObjs = 0;
     uint16_t * rangeCfarObjPerDopList;
+    RangeCfarListObj *rangeCfarList;
+    uint32_t numSubBins, numRangeBins, rowWords, numRangeCfarObj = 0U, useBitmap;
+    uint32_t numValidObjs = 0U, maxNumValidObjs, runStart, runLen;
     uint32_t baseAddr = EDMA_getBaseAddr(objDetObj->edmaHandle[0]);
-    uint32_t edmaSrcAddr, edmaDstAddr, edmaTrigReg, edmaIntrStatusReg, edmaClrIntrStatusReg, channelMask;
+    uint32_t edmaSrcAddr, edmaAbCntAddr, edmaDstAddr, edmaTrigReg, edmaIntrStatusReg, edmaClrIntrStatusReg, channelMask;
     edmaSrcAddr = baseAddr + EDMA_TPCC_OPT(objDetObj->edmaDetObjs.channel) + 0x4U;
+    edmaAbCntAddr = edmaSrcAddr + 0x4U;
     edmaDstAddr = edmaSrcAddr + 0x8U;
     edmaTrigReg = baseAddr + EDMA_TPCC_ESR_RN(0U);
     edmaIntrStatusReg =  baseAddr + EDMA_TPCC_IPR_RN(0U);
@@ -1541,67 +1139,95 @@ static int32_t DPC_ObjDet_intersectDopAndRangeCFAR(
     if(subFrmObj->staticCfg.rangeCfarCfg.cfg.isEnabled)
     {
         rangeCfarObjPerDopList = (uint16_t *)subFrmObj->dpuCfg.rangeCfarCfg.res.rangeCfarNumObjPerDopplerBinBuf;
-        for (objIdx = 0; objIdx < dopNumObjOut; objIdx++)
+        rangeCfarList = (RangeCfarListObj *)subFrmObj->dpuCfg.rangeCfarCfg.res.rangeCfarList;
+        numSubBins = (uint32_t)subFrmObj->staticCfg.numChirpsPerFrame / (uint32_t)subFrmObj->staticCfg.numBandsTotal;
+        numRangeBins = subFrmObj->staticCfg.numRangeBins;
+        rowWords = DPC_OBJDET_RANGECFAR_BITMAP_ROW_WORDS(numRangeBins);
+        maxNumValidObjs = subFrmObj->dpuCfg.dopplerCfg.hwRes.finalMaxNumDetObjs;
+        if(maxNumValidObjs > INTERSECT_MAX_VALID_OBJS)
+        {
+            maxNumValidObjs = INTERSECT_MAX_VALID_OBJS;
+        }
+
+        /* Searching the sub bin's part of the range CFAR list costs as much as
+         * the sub bin has range CFAR detections, which is a lot in clutter.
+         * When the profile fits the bitmap, mark the range CFAR list once so
+         * every Doppler detection is a single bit test. */
+        useBitmap = ((numSubBins > 0U) && ((numSubBins * rowWords) <= RANGECFAR_BITMAP_SIZE_WORDS)) ? 1U : 0U;
+        if (useBitmap)
         {
-            dopIdx = detObjList[objIdx].dopIdx;
+            /* The per sub bin counts are cumulative, the last is the list length */
+            numRangeCfarObj = rangeCfarObjPerDopList[numSubBins - 1U];
+            DPC_ObjDet_rangeCfarBitmapMark(gRangeCfarBitmap, rowWords, numSubBins, numRangeBins,
+                                           rangeCfarList, numRangeCfarObj, 1U);
+        }
 
-            if (dopIdx > 0U)
+        for (objIdx = 0; objIdx < dopNumObjOut; objIdx++)
+        {
+            if (useBitmap)
             {
-                /* Obtain the number of objects for a sub bin in the Range CFAR list by
-                * subtracting two consecutive elements from the cummulative distribution */
-                valSubBinObj = rangeCfarObjPerDopList[dopIdx] - rangeCfarObjPerDopList[dopIdx - 1U];
-                cfarListStartIdx = rangeCfarObjPerDopList[dopIdx - 1U];
+                isValidObj = DPC_ObjDet_isDetInRangeCfarBitmap(&detObjList[objIdx], gRangeCfarBitmap,
+                                                               rowWords, numSubBins, numRangeBins);
             }
             else
             {
-                /* For the 0th sub bin, do not perform a subtraction */
-                valSubBinObj = rangeCfarObjPerDopList[dopIdx];
-                cfarListStartIdx = 0;
+                isValidObj = DPC_ObjDet_isDetInRangeCfar(&detObjList[objIdx], rangeCfarList,
+                                                         rangeCfarObjPerDopList);
             }
 
-            /* If the sub bin has valid objects in the range CFAR list, check whether the
-            * object currently being looked at (from the Doppler CFAR list), is also available
-            * in the range CFAR list. cfarListStartIdx tells us where to start searching for in
-            * the range CFAR list, and valSubBinObj tells us how many elements to search in.
-            * This saves computation time. */
-            if (valSubBinObj)
+            if(isValidObj)
             {
-                isValidObj = isObjInRangeAndDopplerList((uint32_t)detObjList[objIdx].rangeIdx,
-                                                        detObjList[objIdx].dopIdx,
-                                                        (RangeCfarListObj *)&subFrmObj->dpuCfg.rangeCfarCfg.res.rangeCfarList[cfarListStartIdx],
-                                                        valSubBinObj);
-
-                if(isValidObj)
+                gIntersectValidIdx[numValidObjs] = (uint16_t)objIdx;
+                numValidObjs++;
+                if(numValidObjs >= maxNumValidObjs)
                 {
-                    /* Check the completion of previous transfer before triggering the next. */
-                    if(finalNumObjs > 0U)
-                    {
-                        while(((*(volatile uint32_t*)((uint32_t)edmaIntrStatusReg)) & (channelMask)) != (channelMask))
-                        {
-                            /* wait */
-                        }
-                        *(volatile uint32_t*)((uint32_t)edmaClrIntrStatusReg) = channelMask;
-                    }
+                    break;
+                }
+            }
+        }
 
+        /* Move the kept detections to L2 with one AB transfer per run of
+         * neighbours in the Doppler list, so the DSP waits on the EDMA once
+         * per run instead of once per detection. */
+        if(numValidObjs > 0U)
+        {
+            EDMA_dmaSetPaRAMEntry(baseAddr, objDetObj->edmaDetObjs.channel, EDMACC_PARAM_ENTRY_SRC_DST_BIDX,
+                                  ((uint32_t)sizeof(DetObjParams) << 16U) | (uint32_t)sizeof(DetObjParams));
+        }
+        for (runStart = 0; runStart < numValidObjs; runStart += runLen)
+        {
+            runLen = DPC_ObjDet_detObjRunLen(gIntersectValidIdx, numValidObjs, runStart);
 
-                    /* EDMA this obj to L2 for further processing */
+            /* Check the completion of previous transfer before triggering the next. */
+            if(runStart > 0U)
+            {
+                while(((*(volatile uint32_t*)((uint32_t)edmaIntrStatusReg)) & (channelMask)) != (channelMask))
+                {
+                    /* wait */
+                }
+                *(volatile uint32_t*)((uint32_t)edmaClrIntrStatusReg) = channelMask;
+            }
 
-                    /* update src address */
-                    *(volatile uint32_t*)((uint32_t)edmaSrcAddr) = (uint32_t)SOC_virtToPhy((void*)&subFrmObj->dpuCfg.dopplerCfg.hwRes.detObjList[objIdx]);
+            /* update src address */
+            *(volatile uint32_t*)((uint32_t)edmaSrcAddr) = (uint32_t)SOC_virtToPhy((void*)&subFrmObj->dpuCfg.dopplerCfg.hwRes.detObjList[gIntersectValidIdx[runStart]]);
 
-                    /* update dst address */
-                    *(volatile uint32_t*)((uint32_t)edmaDstAddr) = (uint32_t)SOC_virtToPhy((void*)&subFrmObj->dpuCfg.dopplerCfg.hwRes.finalDetObjList[finalNumObjs]);
+            /* update bcnt (objects in the run) and acnt (one object) */
+            *(volatile uint32_t*)((uint32_t)edmaAbCntAddr) = (runLen << 16U) | (uint32_t)sizeof(DetObjParams);
 
-                    /* trigger */
-                    *(volatile uint32_t*)((uint32_t)edmaTrigReg) = channelMask;
+            /* update dst address */
+            *(volatile uint32_t*)((uint32_t)edmaDstAddr) = (uint32_t)SOC_virtToPhy((void*)&subFrmObj->dpuCfg.dopplerCfg.hwRes.finalDetObjList[runStart]);
 
-                    finalNumObjs++;
-                    if(finalNumObjs >= subFrmObj->dpuCfg.dopplerCfg.hwRes.finalMaxNumDetObjs)
-                    {
-                        break;
-                    }
-                }
-            }
+            /* trigger */
+            *(volatile uint32_t*)((uint32_t)edmaTrigReg) = channelMask;
+        }
+        finalNumObjs = numValidObjs;
+
+        /* Leave the bitmap all zero for the next frame or subframe,
+         * while the last run is still in flight */
+        if (useBitmap)
+        {
+            DPC_ObjDet_rangeCfarBitmapMark(gRangeCfarBitmap, rowWords, numSubBins, numRangeBins,
+                                           rangeCfarList, numRangeCfarObj, 0U);
         }
 
         /* Monitor the completion of last transfer here. */
@@ -1678,6 +1304,8 @@ int32_t DPC_ObjectDetection_execute(
     DPU_RangeCFARProcHWA_OutParams outRangeCfarProc;
     DetObjParams * detObjList;
     DPIF_PointCloudCartesian * objOut;
+    DPIF_PointCloudSideInfo * objOutSideInfo;
+    uint32_t finalNumDetObjs = 0U;
     uint32_t saveRestoreDataSize;
     int32_t retVal;
     DPC_ObjectDetection_ExecuteResult *result;
@@ -1703,17 +1331,80 @@ int32_t DPC_ObjectDetection_execute(
 
     subFrmObj = &objDetObj->subFrameObj[objDetObj->subFrameIndx];
 
-    /* Cache invalidation is required to mitigate incoherency
-     * issues associated with EDMA transfer from/to L3. */
-    CacheP_wbInvAll(CacheP_TYPE_ALL);
+    /* Cache invalidation is required to mitigate incoherency
+     * issues associated with EDMA transfer from/to L3. */
+    CacheP_wbInvAll(CacheP_TYPE_ALL);
+
+    gDpcStageTimes.executeStart = CycleCounterP_getCount32();
+    gDpcStageTimes.pipelined = gAoaPipe.enabled;
+    objOut = subFrmObj->dpuCfg.dopplerCfg.hwRes.objOut;
+    objOutSideInfo = subFrmObj->detObjOutSideInfo;
+
+#ifdef SUBSYS_DSS
+    /* The frame start callback may have handed over a result slot */
+    if (gDpcResultSlot.objOut != NULL)
+    {
+        objOut = (DPIF_PointCloudCartesian *)gDpcResultSlot.objOut;
+        objOutSideInfo = (DPIF_PointCloudSideInfo *)gDpcResultSlot.objOutSideInfo;
+    }
+
+    if (gAoaPipe.enabled)
+    {
+        uint32_t outBufIdx = gAoaPipe.outBufIdx;
+        uint32_t numAoaDetObjs = 0U;
+
+        /* The previous frame's detections are still in finalDetObjList. Run
+         * their AoA now, while the HWA does this frame's range FFT, and before
+         * this frame's Doppler DPU reuses that L2. The first frame after start
+         * has nothing pending and returns an empty point cloud. */
+        if (DPC_ObjDet_aoaPipePop(&gAoaPipe, &outBufIdx) != 0U)
+        {
+            numAoaDetObjs = DPC_ObjDet_resultSlotClamp(&gDpcResultSlot, gAoaPipe.numDetObjs);
+        }
+        if (gDpcResultSlot.objOut == NULL)
+        {
+            objOut = gAoaObjOut[outBufIdx];
+            objOutSideInfo = gAoaSideInfo[outBufIdx];
+        }
+
+        retVal = DPC_ObjDet_runAoa(objDetObj, &objDetObj->subFrameObj[gAoaPipe.subFrameIdx], numAoaDetObjs,
+                                   objOut, objOutSideInfo, &result->numObjOut);
+        if (retVal != 0)
+        {
+            goto exit;
+        }
+        result->dopNumObjOut = numAoaDetObjs;
+#ifdef DPC_OBJDET_CAPTURE
+        DPC_ObjDet_capturePoints(objOut, objOutSideInfo, result->numObjOut);
+#endif
+    }
+#endif
 
     retVal = DPU_RangeProcHWA_process(subFrmObj->dpuRangeObj,  &subFrmObj->dpuCfg.rangeCfg, &outRangeProc);
     if (retVal != 0)
     {
         goto exit;
     }
+#ifdef DPC_OBJDET_CAPTURE
+    /* Before the stamp, the copy counts as range time and the stages a
+     * replay is run for keep their own */
+    DPC_ObjDet_captureRange(objDetObj, subFrmObj);
+#endif
+    gDpcStageTimes.rangeEnd = CycleCounterP_getCount32();
     DebugP_assert(outRangeProc.endOfChirp == true);
 
+#ifdef DPC_OBJDET_COMP_TUNE
+    /* Sample the compressed radar cube before the Doppler DPU reuses it.
+     * The EDMA wrote it after the cache was invalidated above, so there
+     * are no stale lines of it. */
+    DPC_ObjDet_bfpTuneSample(&gDpcBfpTune[objDetObj->subFrameIndx],
+                             (const uint32_t *)subFrmObj->dpuCfg.rangeCfg.hwRes.radarCube.data,
+                             ((uint32_t)subFrmObj->staticCfg.numRangeBins * (uint32_t)subFrmObj->staticCfg.numChirps *
+                              (uint32_t)subFrmObj->staticCfg.ADCBufData.dataProperty.numRxAntennas) /
+                             (uint32_t)subFrmObj->staticCfg.compressionCfg.rangeBinsPerBlock,
+                             gBfpTunePower);
+#endif
+
     checkFFTClipStatus(objDetObj, &result->FFTClipCount[0]);
 
     if (processCallBack->processInterFrameBeginCallBackFxn != NULL)
@@ -1761,6 +1452,7 @@ int32_t DPC_ObjectDetection_execute(
     {
         goto exit;
     }
+    gDpcStageTimes.dopplerEnd = CycleCounterP_getCount32();
 #ifdef OBJECTDETHWA_PRINT_DPC_TIMING_INFO
     gTimingInfo.dopEndTimes[gTimingInfo.dopEndCnt % OBJECTDETHWA_NUM_FRAME_TIMING_TO_STORE] = CycleCounterP_getCount32();
     gTimingInfo.dopEndCnt++;
@@ -1776,9 +1468,9 @@ int32_t DPC_ObjectDetection_execute(
             goto exit;
         }
     }
+    gDpcStageTimes.rangeCfarEnd = CycleCounterP_getCount32();
 
     detObjList = subFrmObj->dpuCfg.dopplerCfg.hwRes.detObjList;
-    objOut     = subFrmObj->dpuCfg.dopplerCfg.hwRes.objOut;
 
     /* Procedure for Rx channels gain/phase offset measurement */
     if(objDetObj->commonCfg.measureRxChannelBiasCfg.enabled)
@@ -1792,11 +1484,25 @@ int32_t DPC_ObjectDetection_execute(
             &objDetObj->compRxChanCfgMeasureOut);
     }
 
-    retVal = DPC_ObjDet_intersectDopAndRangeCFAR(objDetObj, subFrmObj, outDopplerProc.numObjOut, detObjList, &result->dopNumObjOut) ;
+    retVal = DPC_ObjDet_intersectDopAndRangeCFAR(objDetObj, subFrmObj, outDopplerProc.numObjOut, detObjList, &finalNumDetObjs) ;
     if (retVal < 0)
     {
         goto exit;
     }
+    gDpcStageTimes.intersectEnd = CycleCounterP_getCount32();
+
+#ifdef DPC_OBJDET_CAPTURE
+    DPC_ObjDet_captureLists(subFrmObj, detObjList, outDopplerProc.numObjOut, finalNumDetObjs);
+#endif
+
+#ifdef DPC_OBJDET_COMP_TUNE
+    /* The radar cube is read, a new ratio can go in before the next range FFT */
+    retVal = DPC_ObjDet_compTuneDecide(objDetObj, subFrmObj);
+    if (retVal != 0)
+    {
+        goto exit;
+    }
+#endif
 
     /********************************
      * Prepare for subFrame switch
@@ -1860,26 +1566,32 @@ int32_t DPC_ObjectDetection_execute(
     }
 
 #ifdef SUBSYS_DSS
-#ifdef OBJECTDETHWA_PRINT_DPC_TIMING_INFO
-    gTimingInfo.aoaStartTimes[gTimingInfo.aoaStartCnt % OBJECTDETHWA_NUM_FRAME_TIMING_TO_STORE] = CycleCounterP_getCount32();
-    gTimingInfo.aoaStartCnt++;
-#endif
-
-    retVal = DPC_ObjDet_estimateXYZ(subFrmObj, objDetObj, subFrmObj->dpuCfg.dopplerCfg.hwRes.finalDetObjList, objOut, result->dopNumObjOut, &result->numObjOut);
-    if (retVal != 0)
+    if (gAoaPipe.enabled)
     {
-        goto exit;
+        /* This frame's AoA runs at the start of the next frame */
+        DPC_ObjDet_aoaPipePush(&gAoaPipe, objDetObj->subFrameIndx, finalNumDetObjs);
     }
+    else
+    {
+        finalNumDetObjs = DPC_ObjDet_resultSlotClamp(&gDpcResultSlot, finalNumDetObjs);
+        retVal = DPC_ObjDet_runAoa(objDetObj, subFrmObj, finalNumDetObjs, objOut, objOutSideInfo, &result->numObjOut);
+        if (retVal != 0)
+        {
+            goto exit;
+        }
+        result->dopNumObjOut = finalNumDetObjs;
+#ifdef DPC_OBJDET_CAPTURE
+        DPC_ObjDet_capturePoints(objOut, objOutSideInfo, result->numObjOut);
 #endif
-#ifdef OBJECTDETHWA_PRINT_DPC_TIMING_INFO
-    gTimingInfo.aoaEndTimes[gTimingInfo.aoaEndCnt % OBJECTDETHWA_NUM_FRAME_TIMING_TO_STORE] = CycleCounterP_getCount32();
-    gTimingInfo.aoaEndCnt++;
+    }
+#else
+    result->dopNumObjOut = finalNumDetObjs;
 #endif
 
 	/* Set DPM result */
     result->subFrameIdx = objDetObj->subFrameIndx;
     result->objOut      = objOut;
-    result->objOutSideInfo  = subFrmObj->detObjOutSideInfo;
+    result->objOutSideInfo  = objOutSideInfo;
     result->detMatrix   = subFrmObj->dpuCfg.dopplerCfg.hwRes.detMatrix;
     result->detObjList = subFrmObj->dpuCfg.dopplerCfg.hwRes.finalDetObjList;
 
@@ -1896,6 +1608,7 @@ int32_t DPC_ObjectDetection_execute(
     objDetObj->stats.interChirpProcessingMargin = 0;
 
     objDetObj->stats.interFrameEndTimeStamp = CycleCounterP_getCount32();
+    gDpcStageTimes.resultEnd = objDetObj->stats.interFrameEndTimeStamp;
     result->stats = (DPC_ObjectDetection_Stats *)((uint32_t)SOC_virtToPhy((void*)&objDetObj->stats));
 
     /* populate DPM_resultBuf - first pointer and size are for results of the
@@ -1962,7 +1675,11 @@ static int32_t DPC_ObjDet_reconfigSubFrame(ObjDetObj *objDetObj, uint8_t subFram
 
     subFrmObj = &objDetObj->subFrameObj[subFrameIndx];
 
-    DPC_ObjDet_GenRangeWindow(&subFrmObj->dpuCfg.rangeCfg);
+    /* Cached windows are still intact, only scratch ones need generating */
+    if (gWinCache.bypass)
+    {
+        DPC_ObjDet_GenRangeWindow(&subFrmObj->dpuCfg.rangeCfg);
+    }
 
     retVal = DPU_RangeProcHWA_config(subFrmObj->dpuRangeObj, &subFrmObj->dpuCfg.rangeCfg);
     if (retVal != 0)
@@ -1970,7 +1687,10 @@ static int32_t DPC_ObjDet_reconfigSubFrame(ObjDetObj *objDetObj, uint8_t subFram
         goto exit;
     }
 
-    (void)DPC_ObjDet_GenDopplerWindow(&subFrmObj->dpuCfg.dopplerCfg);
+    if (gWinCache.bypass)
+    {
+        (void)DPC_ObjDet_GenDopplerWindow(&subFrmObj->dpuCfg.dopplerCfg);
+    }
     retVal = DPU_DopplerProcHWA_config(subFrmObj->dpuDopplerObj, &subFrmObj->dpuCfg.dopplerCfg, 1);
     if (retVal != 0)
     {
@@ -1998,6 +1718,429 @@ exit:
     return(retVal);
 }
 
+#ifdef DPC_OBJDET_COMP_TUNE
+/**
+ *  @b Description
+ *  @n
+ *      Sets the compression ratio tuner of a sub-frame up after its pre-start
+ *      configuration. It stays off unless the radar cube is BFP compressed.
+ *
+ *  @param[in]  objDetObj    Pointer to DPC object
+ *  @param[in]  subFrmObj    Pointer to the sub-frame object
+ *  @param[in]  subFrameIndx Sub-frame index.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static void DPC_ObjDet_compTuneConfig(ObjDetObj *objDetObj, SubFrameObj *subFrmObj, uint8_t subFrameIndx)
+{
+    DPU_RangeProcHWA_CompressionCfg *compCfg = &subFrmObj->staticCfg.compressionCfg;
+    uint32_t decrImagBitw = 0U;
+
+#if defined (SOC_AWR294X) || defined(SOC_AWR2X44P)
+    /* ES2.0 parts give the imaginary part one mantissa bit less */
+    if (((HWA_Object *)objDetObj->hwaHandle)->isES2P0Device == true)
+    {
+        decrImagBitw = 1U;
+    }
+#endif
+
+    (void)memset((void *)&gDpcBfpTune[subFrameIndx], 0, sizeof(DPC_ObjDet_BfpTune));
+    if ((compCfg->isEnabled == true) && (compCfg->compressionMethod == HWA_COMPRESS_METHOD_BFP))
+    {
+        DPC_ObjDet_bfpTuneInit(&gDpcBfpTune[subFrameIndx], compCfg->rangeBinsPerBlock, decrImagBitw,
+                               compCfg->compressionRatio, DPC_OBJDET_COMP_TUNE_MIN_RATIO,
+                               DPC_OBJDET_COMP_TUNE_LOSS_DB, DPC_OBJDET_COMP_TUNE_HYST_DB,
+                               DPC_OBJDET_COMP_TUNE_BLOCKS, DPC_OBJDET_COMP_TUNE_FRAMES);
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Lets the tuner of the current sub-frame decide on the ratio and puts
+ *      a new one into the saved range and Doppler DPU configurations. With
+ *      more than one sub-frame the switch to this sub-frame configures the
+ *      DPUs with it, a single sub-frame is reconfigured here, after its radar
+ *      cube is read and before the next range FFT is triggered.
+ *
+ *  @param[in]  objDetObj Pointer to DPC object
+ *  @param[in]  subFrmObj Pointer to the current sub-frame object
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static int32_t DPC_ObjDet_compTuneDecide(ObjDetObj *objDetObj, SubFrameObj *subFrmObj)
+{
+    DPC_ObjDet_BfpTune *tune = &gDpcBfpTune[objDetObj->subFrameIndx];
+    uint32_t prevWords = tune->wordsCur;
+    uint32_t saveRestoreDataSize;
+    int32_t retVal = 0;
+    float ratio;
+
+    if (DPC_ObjDet_bfpTuneDecide(tune) == prevWords)
+    {
+        goto exit;
+    }
+
+    /* A whole number of words per block, so the DPUs round to exactly it */
+    ratio = DPC_ObjDet_bfpRatio(tune->wordsCur, tune->samplesPerBlock);
+    subFrmObj->staticCfg.compressionCfg.compressionRatio = ratio;
+    subFrmObj->dpuCfg.rangeCfg.staticCfg.compressionCfg.compressionRatio = ratio;
+    subFrmObj->dpuCfg.dopplerCfg.staticCfg.decompCfg.compressionRatio = ratio;
+
+    if (objDetObj->commonCfg.numSubFrames == 1U)
+    {
+        if (objDetObj->commonCfg.rangeProcCfg.rangeProcChain == DPU_RANGEPROCHWA_PREVIOUS_FRAME_DC_MODE)
+        {
+            /* Keep the DC estimates across the reconfiguration */
+            saveRestoreDataSize = (uint32_t)subFrmObj->staticCfg.ADCBufData.dataProperty.numRxAntennas * 4U;
+            if (objDetObj->commonCfg.rangeProcCfg.isReal2XEnabled)
+            {
+                saveRestoreDataSize >>= 1;
+            }
+            rangeProcHWA_storePreProcStats(&subFrmObj->dpuCfg.rangeCfg, saveRestoreDataSize, 0, 0);
+            retVal = DPC_ObjDet_reconfigSubFrame(objDetObj, objDetObj->subFrameIndx);
+            rangeProcHWA_loadPreProcStats(&subFrmObj->dpuCfg.rangeCfg, saveRestoreDataSize, 0, 0);
+        }
+        else
+        {
+            retVal = DPC_ObjDet_reconfigSubFrame(objDetObj, objDetObj->subFrameIndx);
+        }
+    }
+
+exit:
+    return retVal;
+}
+#endif
+
+#ifdef DPC_OBJDET_CAPTURE
+/**
+ *  @b Description
+ *  @n
+ *      Takes the capture buffer off the end of L3, before any of L3 is
+ *      allocated, and logs where it is for the debugger.
+ *
+ *  @param[in]  objDetObj Pointer to DPC object
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static void DPC_ObjDet_captureSetup(ObjDetObj *objDetObj)
+{
+    uintptr_t start = (uintptr_t)objDetObj->L3RamObj.cfg.addr;
+    uintptr_t end = start + objDetObj->L3RamObj.cfg.size;
+    uintptr_t capStart;
+
+    (void)memset((void *)&gDpcCapture, 0, sizeof(gDpcCapture));
+    if (objDetObj->L3RamObj.cfg.size <= (DPC_OBJDET_CAPTURE_SIZE + DPC_OBJDET_CAPTURE_ALIGN))
+    {
+        DebugP_log("ObjDet DPC: L3 too small for the capture buffer\n");
+        return;
+    }
+
+    capStart = (end - DPC_OBJDET_CAPTURE_SIZE) & ~((uintptr_t)DPC_OBJDET_CAPTURE_ALIGN - 1U);
+    gDpcCapture.buf  = (uint8_t *)capStart;
+    gDpcCapture.size = (uint32_t)(end - capStart);
+    objDetObj->L3RamObj.cfg.size = (uint32_t)(capStart - start);
+    DebugP_log("ObjDet DPC: capture buffer at 0x%08x, %u bytes\n", (uint32_t)capStart, gDpcCapture.size);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts a recording with the configuration of every sub-frame in its
+ *      header, or checks the capture a replay is going to use.
+ *
+ *  @param[in]  objDetObj Pointer to DPC object
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static void DPC_ObjDet_captureStart(ObjDetObj *objDetObj)
+{
+    DPC_ObjDet_Capture *cap = &gDpcCapture;
+    DPC_ObjDet_CaptureHdr *hdr;
+#ifdef DPC_OBJDET_CAPTURE_RECORD
+    DPC_ObjDet_CaptureSubFrame *cfg;
+    SubFrameObj *subFrmObj;
+    uint32_t i;
+#endif
+
+    cap->rec = NULL;
+    cap->aoaRec = NULL;
+    cap->replayRec = NULL;
+    cap->frameIdx = 0U;
+    (void)memset((void *)&cap->stats, 0, sizeof(cap->stats));
+
+#ifdef DPC_OBJDET_CAPTURE_RECORD
+    hdr = DPC_ObjDet_captureInit(cap->buf, cap->size, DPC_OBJDET_CAPTURE_SECTIONS);
+    if (hdr != NULL)
+    {
+        hdr->detObjSize       = (uint16_t)sizeof(DetObjParams);
+        hdr->rangeCfarObjSize = (uint16_t)sizeof(RangeCfarListObj);
+        hdr->pointSize        = (uint16_t)sizeof(DPIF_PointCloudCartesian);
+        hdr->sideInfoSize     = (uint16_t)sizeof(DPIF_PointCloudSideInfo);
+        hdr->numSubFrames     = (uint16_t)objDetObj->commonCfg.numSubFrames;
+        hdr->pipelinedAoa     = (uint16_t)gAoaPipe.enabled;
+
+        hdr->zeroInsrtMaskAzim = objDetObj->commonCfg.zeroInsrtMaskCfg.zeroInsrtMaskAzim;
+        hdr->zeroInsrtMaskElev = objDetObj->commonCfg.zeroInsrtMaskCfg.zeroInsrtMaskElev;
+        hdr->xSpacingByLambda  = objDetObj->commonCfg.antennaSpacing.xSpacingByLambda;
+        hdr->zSpacingByLambda  = objDetObj->commonCfg.antennaSpacing.zSpacingByLambda;
+        (void)memcpy((void *)&hdr->antennaGeometryCfg[0], (void *)&objDetObj->commonCfg.antennaGeometryCfg[0],
+                     MAX_NUM_VIRT_ANT * sizeof(uint16_t));
+        (void)memcpy((void *)&hdr->antennaCalibParams[0], (void *)&objDetObj->commonCfg.antennaCalibParams[0],
+                     2U * MAX_NUM_VIRT_ANT * sizeof(float));
+
+        for (i = 0U; i < hdr->numSubFrames; i++)
+        {
+            subFrmObj = &objDetObj->subFrameObj[i];
+            cfg = &hdr->subFrame[i];
+            cfg->radarCubeSize      = subFrmObj->dpuCfg.rangeCfg.hwRes.radarCube.dataSize;
+            cfg->numRangeBins       = subFrmObj->staticCfg.numRangeBins;
+            cfg->numDopplerBins     = subFrmObj->staticCfg.numDopplerBins;
+            cfg->numSubBins         = (uint16_t)((uint32_t)subFrmObj->staticCfg.numChirpsPerFrame /
+                                                 (uint32_t)subFrmObj->staticCfg.numBandsTotal);
+            cfg->numAzimFFTBins     = subFrmObj->dpuCfg.dopplerCfg.staticCfg.numAzimFFTBins;
+            cfg->numRxAntennas      = subFrmObj->staticCfg.ADCBufData.dataProperty.numRxAntennas;
+            cfg->numVirtualAntennas = subFrmObj->staticCfg.numVirtualAntennas;
+            cfg->finalMaxNumDetObjs = (uint16_t)subFrmObj->dpuCfg.dopplerCfg.hwRes.finalMaxNumDetObjs;
+            cfg->rangeCfarEnabled   = (subFrmObj->staticCfg.rangeCfarCfg.cfg.isEnabled) ? 1U : 0U;
+            cfg->compressed         = (subFrmObj->staticCfg.compressionCfg.isEnabled == true) ? 1U : 0U;
+            cfg->compressionRatio   = subFrmObj->staticCfg.compressionCfg.compressionRatio;
+            cfg->rangeStep          = subFrmObj->staticCfg.rangeStep;
+            cfg->dopplerStep        = subFrmObj->staticCfg.dopplerStep;
+            cfg->fov[0]             = subFrmObj->aoaFovSinVal.minAzimuthSinVal;
+            cfg->fov[1]             = subFrmObj->aoaFovSinVal.maxAzimuthSinVal;
+            cfg->fov[2]             = subFrmObj->aoaFovSinVal.minElevationSinVal;
+            cfg->fov[3]             = subFrmObj->aoaFovSinVal.maxElevationSinVal;
+        }
+    }
+#else
+    /* A replay only reads the capture, the header stays as it was loaded */
+    hdr = (DPC_ObjDet_CaptureHdr *)DPC_ObjDet_captureCheck(cap->buf, cap->size,
+                                                           sizeof(DetObjParams), sizeof(RangeCfarListObj),
+                                                           sizeof(DPIF_PointCloudCartesian),
+                                                           sizeof(DPIF_PointCloudSideInfo));
+    if (hdr == NULL)
+    {
+        DebugP_log("ObjDet DPC: no capture to replay at 0x%08x\n", (uint32_t)cap->buf);
+    }
+#endif
+    cap->hdr = hdr;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Runs after the range DPU. A recording starts the frame's record with
+ *      the radar cube. A replay takes the next record, back to the first
+ *      after the last, and puts its radar cube in place of the one of the
+ *      range FFT. A record of another sub-frame or radar cube size is
+ *      skipped, and so is the frame.
+ *
+ *  @param[in]  objDetObj Pointer to DPC object
+ *  @param[in]  subFrmObj Pointer to the current sub-frame object
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static void DPC_ObjDet_captureRange(ObjDetObj *objDetObj, SubFrameObj *subFrmObj)
+{
+    DPC_ObjDet_Capture *cap = &gDpcCapture;
+    DPIF_RadarCube *radarCube = &subFrmObj->dpuCfg.rangeCfg.hwRes.radarCube;
+#ifdef DPC_OBJDET_CAPTURE_REPLAY
+    const DPC_ObjDet_CaptureRec *rec;
+    const DPC_ObjDet_CaptureSec *sec = NULL;
+#endif
+
+    cap->rec = NULL;
+    cap->numDiffer = 0U;
+    if (cap->hdr == NULL)
+    {
+        return;
+    }
+
+#ifdef DPC_OBJDET_CAPTURE_RECORD
+    cap->rec = DPC_ObjDet_captureBegin(cap->hdr, cap->frameIdx, objDetObj->subFrameIndx);
+    cap->rec = DPC_ObjDet_captureAdd(cap->hdr, cap->rec, DPC_OBJDET_CAPTURE_SEC_RADAR_CUBE,
+                                     radarCube->data, radarCube->dataSize, 1U);
+#else
+    rec = DPC_ObjDet_captureNext(cap->hdr, cap->replayRec);
+    if ((rec == NULL) && (cap->replayRec != NULL))
+    {
+        rec = DPC_ObjDet_captureNext(cap->hdr, NULL);
+        cap->stats.numWraps++;
+    }
+    cap->replayRec = rec;
+    if (rec != NULL)
+    {
+        sec = DPC_ObjDet_captureFind(rec, DPC_OBJDET_CAPTURE_SEC_RADAR_CUBE);
+    }
+
+    if ((sec == NULL) || (rec->subFrameIdx != objDetObj->subFrameIndx) ||
+        (sec->elemSize != 1U) || (sec->count != radarCube->dataSize))
+    {
+        cap->stats.numSkipped++;
+    }
+    else
+    {
+        /* The Doppler DPU reads it with the EDMA */
+        (void)memcpy(radarCube->data, (const void *)(sec + 1), radarCube->dataSize);
+        CacheP_wb(radarCube->data, radarCube->dataSize, CacheP_TYPE_ALL);
+        /* The capture is in L3 like everything else, only the header guards it */
+        cap->rec = (DPC_ObjDet_CaptureRec *)rec;
+    }
+#endif
+    cap->frameIdx++;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Runs after the intersection, before the next range FFT overwrites the
+ *      Doppler list. Records the lists of the frame or compares them with
+ *      the recorded ones.
+ *
+ *  @param[in]  subFrmObj       Pointer to the current sub-frame object
+ *  @param[in]  detObjList      Doppler DPU detections
+ *  @param[in]  numDopObjs      Number of them
+ *  @param[in]  finalNumDetObjs Detections the intersection kept in finalDetObjList
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static void DPC_ObjDet_captureLists(SubFrameObj *subFrmObj, const DetObjParams *detObjList,
+                                    uint32_t numDopObjs, uint32_t finalNumDetObjs)
+{
+    DPC_ObjDet_Capture *cap = &gDpcCapture;
+    DPC_ObjDet_CaptureRec *rec = cap->rec;
+    const uint16_t *perDop = (const uint16_t *)subFrmObj->dpuCfg.rangeCfarCfg.res.rangeCfarNumObjPerDopplerBinBuf;
+    const void *rangeCfarList = subFrmObj->dpuCfg.rangeCfarCfg.res.rangeCfarList;
+    const DetObjParams *finalDetObjList = subFrmObj->dpuCfg.dopplerCfg.hwRes.finalDetObjList;
+    uint32_t numSubBins = 0U, numRangeCfarObj = 0U;
+
+    if (subFrmObj->staticCfg.rangeCfarCfg.cfg.isEnabled)
+    {
+        numSubBins = (uint32_t)subFrmObj->staticCfg.numChirpsPerFrame / (uint32_t)subFrmObj->staticCfg.numBandsTotal;
+        numRangeCfarObj = perDop[numSubBins - 1U];
+    }
+
+#ifdef DPC_OBJDET_CAPTURE_RECORD
+    rec = DPC_ObjDet_captureAdd(cap->hdr, rec, DPC_OBJDET_CAPTURE_SEC_DOP_LIST,
+                                detObjList, numDopObjs, sizeof(DetObjParams));
+    if (numSubBins > 0U)
+    {
+        rec = DPC_ObjDet_captureAdd(cap->hdr, rec, DPC_OBJDET_CAPTURE_SEC_RCFAR_LIST,
+                                    rangeCfarList, numRangeCfarObj, sizeof(RangeCfarListObj));
+        rec = DPC_ObjDet_captureAdd(cap->hdr, rec, DPC_OBJDET_CAPTURE_SEC_RCFAR_PERDOP,
+                                    perDop, numSubBins, sizeof(uint16_t));
+    }
+    rec = DPC_ObjDet_captureAdd(cap->hdr, rec, DPC_OBJDET_CAPTURE_SEC_FINAL_LIST,
+                                finalDetObjList, finalNumDetObjs, sizeof(DetObjParams));
+#else
+    cap->numDiffer += DPC_ObjDet_captureCompare(&cap->stats, rec, DPC_OBJDET_CAPTURE_SEC_DOP_LIST,
+                                                detObjList, numDopObjs, sizeof(DetObjParams));
+    if (numSubBins > 0U)
+    {
+        cap->numDiffer += DPC_ObjDet_captureCompare(&cap->stats, rec, DPC_OBJDET_CAPTURE_SEC_RCFAR_LIST,
+                                                    rangeCfarList, numRangeCfarObj, sizeof(RangeCfarListObj));
+        cap->numDiffer += DPC_ObjDet_captureCompare(&cap->stats, rec, DPC_OBJDET_CAPTURE_SEC_RCFAR_PERDOP,
+                                                    perDop, numSubBins, sizeof(uint16_t));
+    }
+    cap->numDiffer += DPC_ObjDet_captureCompare(&cap->stats, rec, DPC_OBJDET_CAPTURE_SEC_FINAL_LIST,
+                                                finalDetObjList, finalNumDetObjs, sizeof(DetObjParams));
+#endif
+
+    /* The AoA of this frame, now or with the next frame, ends the record */
+    cap->aoaRec = rec;
+    cap->aoaNumDiffer = cap->numDiffer;
+    cap->rec = NULL;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Runs after the AoA. Records the point cloud and ends the record, or
+ *      compares the point cloud with the recorded one and counts the frame.
+ *      The pipelined AoA computes the points of the previous frame, so they
+ *      go with its record.
+ *
+ *  @param[in]  objOut          Point cloud
+ *  @param[in]  objOutSideInfo  Point cloud side info
+ *  @param[in]  numObjOut       Number of points
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static void DPC_ObjDet_capturePoints(const DPIF_PointCloudCartesian *objOut,
+                                     const DPIF_PointCloudSideInfo *objOutSideInfo, uint32_t numObjOut)
+{
+    DPC_ObjDet_Capture *cap = &gDpcCapture;
+    DPC_ObjDet_CaptureRec *rec = cap->aoaRec;
+
+    if (rec == NULL)
+    {
+        return;
+    }
+
+#ifdef DPC_OBJDET_CAPTURE_RECORD
+    rec = DPC_ObjDet_captureAdd(cap->hdr, rec, DPC_OBJDET_CAPTURE_SEC_POINTS,
+                                objOut, numObjOut, sizeof(DPIF_PointCloudCartesian));
+    rec = DPC_ObjDet_captureAdd(cap->hdr, rec, DPC_OBJDET_CAPTURE_SEC_SIDE_INFO,
+                                objOutSideInfo, numObjOut, sizeof(DPIF_PointCloudSideInfo));
+    DPC_ObjDet_captureEnd(cap->hdr, rec);
+#else
+    cap->aoaNumDiffer += DPC_ObjDet_captureCompare(&cap->stats, rec, DPC_OBJDET_CAPTURE_SEC_POINTS,
+                                                   objOut, numObjOut, sizeof(DPIF_PointCloudCartesian));
+    cap->aoaNumDiffer += DPC_ObjDet_captureCompare(&cap->stats, rec, DPC_OBJDET_CAPTURE_SEC_SIDE_INFO,
+                                                   objOutSideInfo, numObjOut, sizeof(DPIF_PointCloudSideInfo));
+    DPC_ObjDet_captureFrameDone(&cap->stats, rec, cap->aoaNumDiffer);
+#endif
+    cap->aoaRec = NULL;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Writes the recording back to L3 for the debugger, or logs the
+ *      outcome of the replay.
+ *
+ * \ingroup DPC_OBJDET__INTERNAL_FUNCTION
+ */
+static void DPC_ObjDet_captureStop(void)
+{
+    DPC_ObjDet_Capture *cap = &gDpcCapture;
+#ifdef DPC_OBJDET_CAPTURE_REPLAY
+    uint32_t i;
+#endif
+
+    if (cap->hdr == NULL)
+    {
+        return;
+    }
+
+#ifdef DPC_OBJDET_CAPTURE_RECORD
+    CacheP_wb((void *)cap->buf, cap->hdr->usedSize, CacheP_TYPE_ALL);
+    DebugP_log("ObjDet DPC: captured %u frames, %u bytes at 0x%08x, %u dropped\n",
+               cap->hdr->numRecords, cap->hdr->usedSize, (uint32_t)cap->buf, cap->hdr->numDropped);
+#else
+    DebugP_log("ObjDet DPC: replayed %u frames, %u differ, %u skipped, %u wraps\n",
+               cap->stats.numFrames, cap->stats.numMismatched, cap->stats.numSkipped, cap->stats.numWraps);
+    if (cap->stats.numMismatched > 0U)
+    {
+        DebugP_log("ObjDet DPC: first differing frame %u\n", cap->stats.firstMismatchFrame);
+        for (i = 0U; i < DPC_OBJDET_CAPTURE_NUM_SECS; i++)
+        {
+            if (cap->stats.secMismatches[i] > 0U)
+            {
+                DebugP_log("ObjDet DPC: section %u differs in %u frames\n", i, cap->stats.secMismatches[i]);
+            }
+        }
+    }
+#endif
+}
+#endif
+
 /**
  *  @b Description
  *  @n
@@ -2032,6 +2175,17 @@ int32_t DPC_ObjectDetection_start (DPM_DPCHandle handle)
     (void)memset((void*)&gTimingInfo, 0, sizeof(timingInfo));
 #endif
 
+    /* A frame left in the AoA pipeline by the last stop is dropped */
+    (void)memset((void*)&gDpcStageTimes, 0, sizeof(gDpcStageTimes));
+#ifdef DPC_OBJDET_PIPELINED_AOA
+    DPC_ObjDet_aoaPipeReset(&gAoaPipe, ((objDetObj->commonCfg.numSubFrames == 1U) && (gAoaObjOut[1] != NULL)) ? 1U : 0U);
+#else
+    DPC_ObjDet_aoaPipeReset(&gAoaPipe, 0U);
+#endif
+#ifdef DPC_OBJDET_CAPTURE
+    DPC_ObjDet_captureStart(objDetObj);
+#endif
+
     /* Start marks consumption of all pre-start configs, reset the flag to check
      * if pre-starts were issued only after common config was issued for the next
      * time full configuration happens between stop and start */
@@ -2130,6 +2284,9 @@ int32_t DPC_ObjectDetection_stop (DPM_DPCHandle handle)
     {
         DebugP_log("Warning! FFT clipping happened for %d times in Doppler or Azimuth FFT Stage. \n", objDetObj->executeResult.FFTClipCount[1]);
     }
+#ifdef DPC_OBJDET_CAPTURE
+    DPC_ObjDet_captureStop();
+#endif
 
 #ifdef OBJECTDETHWA_PRINT_DPC_TIMING_INFO
     uint32_t i, frame0StartTime;
@@ -2265,14 +2422,33 @@ static int32_t DPC_ObjDet_rangeConfig(DPU_RangeProcHWA_Handle dpuHandle,
     /* Generating 1D window, allocate first */
     winGenLen = DPC_ObjDet_GetRangeWinGenLen(cfgSave);
     cfgSave->staticCfg.windowSize = winGenLen * sizeof(uint32_t);
-    windowBuffer = (int32_t *)DPC_ObjDet_MemPoolAlloc(WinBufRamObj, cfgSave->staticCfg.windowSize, (uint8_t)sizeof(uint32_t));
-    if (windowBuffer == NULL)
+    windowBuffer = (int32_t *)DPC_ObjDet_winCacheGet(&gWinCache,
+                                                     cfgSave->staticCfg.ADCBufData.dataProperty.numAdcSamples,
+                                                     winGenLen,
+                                                     DPC_DPU_RANGEPROC_FFT_WINDOW_TYPE,
+                                                     DPC_OBJDET_QFORMAT_RANGE_FFT);
+    if (windowBuffer != NULL)
+    {
+        cfgSave->staticCfg.window = windowBuffer;
+        DPC_ObjDet_genInterfMitigWindow(cfgSave->hwRes.hwaCfg.hwaInterfMitigWindow,
+                                        DPU_RANGEPROCHWADDMA_NUM_INTFMITIG_WIN_HWACOMMONCFG_SIZE);
+        DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_WINBUF, DPC_OBJDET_MEMMAP_OWNER_RANGE, "window",
+                             (uint32_t)((uintptr_t)windowBuffer - (uintptr_t)&gWinBuf[0]),
+                             cfgSave->staticCfg.windowSize, 0U);
+    }
+    else
     {
-        retVal = DPC_OBJECTDETECTION_ENOMEM__CORE_LOCAL_RAM_RANGE_HWA_WINDOW;
-        goto exit;
+        /* Window cache bypassed, generate into scratch */
+        windowBuffer = (int32_t *)DPC_ObjDet_MemPoolAllocTagged(WinBufRamObj, cfgSave->staticCfg.windowSize, (uint8_t)sizeof(uint32_t),
+                                                                gMemMap, DPC_OBJDET_MEMMAP_POOL_WINBUF, DPC_OBJDET_MEMMAP_OWNER_RANGE, "window");
+        if (windowBuffer == NULL)
+        {
+            retVal = DPC_OBJECTDETECTION_ENOMEM__CORE_LOCAL_RAM_RANGE_HWA_WINDOW;
+            goto exit;
+        }
+        cfgSave->staticCfg.window = windowBuffer;
+        DPC_ObjDet_GenRangeWindow(cfgSave);
     }
-    cfgSave->staticCfg.window = windowBuffer;
-    DPC_ObjDet_GenRangeWindow(cfgSave);
 
     /* hwres - edma */
     hwRes->edmaHandle = edmaHandle;
@@ -2378,7 +2554,8 @@ static int32_t DPC_ObjDet_rangeConfig(DPU_RangeProcHWA_Handle dpuHandle,
         && (ptrObjDetObj->commonCfg.numSubFrames > 1U))
         || (ptrObjDetObj->commonCfg.rangeProcCfg.rangeProcChain == DPU_RANGEPROCHWA_PREVIOUS_NTH_CHIRP_ESTIMATES_MODE))
     {
-        hwRes->dcEstIVal = (uint32_t *)DPC_ObjDet_MemPoolAlloc(&ptrObjDetObj->preProcBufObj, dcEstBufSize, (uint8_t)sizeof(uint32_t));
+        hwRes->dcEstIVal = (uint32_t *)DPC_ObjDet_MemPoolAllocTagged(&ptrObjDetObj->preProcBufObj, dcEstBufSize, (uint8_t)sizeof(uint32_t),
+                                                                    gMemMap, DPC_OBJDET_MEMMAP_POOL_PREPROC, DPC_OBJDET_MEMMAP_OWNER_RANGE, "dcEstI");
         if (hwRes->dcEstIVal == NULL)
         {
             retVal = DPC_OBJECTDETECTION_PREPROCBUF_ERR;
@@ -2387,7 +2564,8 @@ static int32_t DPC_ObjDet_rangeConfig(DPU_RangeProcHWA_Handle dpuHandle,
         (void)memset(hwRes->dcEstIVal, 0, dcEstBufSize);
         if(ptrObjDetObj->commonCfg.rangeProcCfg.isReal2XEnabled)
         {
-            hwRes->dcEstQVal = (uint32_t *)DPC_ObjDet_MemPoolAlloc(&ptrObjDetObj->preProcBufObj, dcEstBufSize, (uint8_t)sizeof(uint32_t));
+            hwRes->dcEstQVal = (uint32_t *)DPC_ObjDet_MemPoolAllocTagged(&ptrObjDetObj->preProcBufObj, dcEstBufSize, (uint8_t)sizeof(uint32_t),
+                                                                        gMemMap, DPC_OBJDET_MEMMAP_POOL_PREPROC, DPC_OBJDET_MEMMAP_OWNER_RANGE, "dcEstQ");
             if (hwRes->dcEstQVal == NULL)
             {
                 retVal = DPC_OBJECTDETECTION_PREPROCBUF_ERR;
@@ -2404,14 +2582,16 @@ static int32_t DPC_ObjDet_rangeConfig(DPU_RangeProcHWA_Handle dpuHandle,
 
     if(ptrObjDetObj->commonCfg.rangeProcCfg.rangeProcChain == DPU_RANGEPROCHWA_PREVIOUS_NTH_CHIRP_ESTIMATES_MODE)
     {
-        hwRes->intfThresMagVal = (uint32_t *)DPC_ObjDet_MemPoolAlloc(&ptrObjDetObj->preProcBufObj, intfThresBufSize, (uint8_t)sizeof(uint32_t));
+        hwRes->intfThresMagVal = (uint32_t *)DPC_ObjDet_MemPoolAllocTagged(&ptrObjDetObj->preProcBufObj, intfThresBufSize, (uint8_t)sizeof(uint32_t),
+                                                                          gMemMap, DPC_OBJDET_MEMMAP_POOL_PREPROC, DPC_OBJDET_MEMMAP_OWNER_RANGE, "intfMag");
         if (hwRes->intfThresMagVal == NULL)
         {
             retVal = DPC_OBJECTDETECTION_PREPROCBUF_ERR;
             goto exit;
         }
 
-        hwRes->intfThresMagDiffVal = (uint32_t *)DPC_ObjDet_MemPoolAlloc(&ptrObjDetObj->preProcBufObj, intfThresBufSize, (uint8_t)sizeof(uint32_t));
+        hwRes->intfThresMagDiffVal = (uint32_t *)DPC_ObjDet_MemPoolAllocTagged(&ptrObjDetObj->preProcBufObj, intfThresBufSize, (uint8_t)sizeof(uint32_t),
+                                                                              gMemMap, DPC_OBJDET_MEMMAP_POOL_PREPROC, DPC_OBJDET_MEMMAP_OWNER_RANGE, "intfMagDiff");
         if (hwRes->intfThresMagDiffVal == NULL)
         {
             retVal = DPC_OBJECTDETECTION_PREPROCBUF_ERR;
@@ -2433,15 +2613,21 @@ static int32_t DPC_ObjDet_rangeConfig(DPU_RangeProcHWA_Handle dpuHandle,
     hwaCfg->hwaWinRamOffset = (uint16_t) *windowOffset;
     if ((hwaCfg->hwaWinRamOffset + winGenLen) > DPC_OBJDET_HWA_MAX_WINDOW_RAM_SIZE_IN_SAMPLES)
     {
+        DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_WINRAM, DPC_OBJDET_MEMMAP_OWNER_RANGE, "winRam",
+                             DPC_OBJDET_MEMMAP_NO_FIT, winGenLen, 0U);
         retVal = DPC_OBJECTDETECTION_ENOMEM_HWA_WINDOW_RAM;
         goto exit;
     }
+    DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_WINRAM, DPC_OBJDET_MEMMAP_OWNER_RANGE, "winRam",
+                         *windowOffset, winGenLen, 0U);
     *windowOffset += winGenLen;
 
     hwaCfg->numParamSet = DPU_RANGEPROCHWADDMA_NUM_HWA_PARAM_SETS + staticCfg->compressionCfg.bfpCompExtraParamSets;
     /* Twice the value of rangeProcChain equals the number of paramsets saved compared to the default mode */
     hwaCfg->numParamSet -= ptrObjDetObj->commonCfg.rangeProcCfg.rangeProcChain * 2U;
     hwaCfg->paramSetStartIdx = DPC_OBJDET_DPU_RANGEPROC_PARAMSET_START_IDX;
+    DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_PARAMSET, DPC_OBJDET_MEMMAP_OWNER_RANGE, "params",
+                         hwaCfg->paramSetStartIdx, hwaCfg->numParamSet, 0U);
 
     retVal = DPU_RangeProcHWA_config(dpuHandle, cfgSave);
     if (retVal != 0)
@@ -2602,16 +2788,31 @@ static int32_t DPC_ObjDet_dopplerConfig(SubFrameObj *obj,
     /* hwaCfg - window */
     winGenLen = DPC_ObjDet_GetDopplerWinGenLen(dopCfg);
     hwaCfg->windowSize = winGenLen * sizeof(int32_t);
-    DPC_ObjDet_MemPoolReset(WinBufRamObj);
-    windowBuffer = DPC_ObjDet_MemPoolAlloc(WinBufRamObj, hwaCfg->windowSize, (uint8_t)sizeof(uint32_t));
-    if (windowBuffer == NULL)
+    winType = DPC_ObjDet_dopplerWinType(dopCfg->staticCfg.numChirps);
+    windowBuffer = DPC_ObjDet_winCacheGet(&gWinCache, dopCfg->staticCfg.numChirps, winGenLen,
+                                          winType, DPC_OBJDET_QFORMAT_DOPPLER_FFT);
+    if (windowBuffer != NULL)
     {
-        retVal = DPC_OBJECTDETECTION_ENOMEM__CORE_LOCAL_RAM_DOPPLER_HWA_WINDOW;
-        goto exit;
+        hwaCfg->window = (int32_t *)windowBuffer;
+        DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_WINBUF, DPC_OBJDET_MEMMAP_OWNER_DOPPLER, "window",
+                             (uint32_t)((uintptr_t)windowBuffer - (uintptr_t)&gWinBuf[0]),
+                             hwaCfg->windowSize, 0U);
+    }
+    else
+    {
+        /* Window cache bypassed, generate into scratch */
+        DPC_ObjDet_MemPoolReset(WinBufRamObj);
+        windowBuffer = DPC_ObjDet_MemPoolAllocTagged(WinBufRamObj, hwaCfg->windowSize, (uint8_t)sizeof(uint32_t),
+                                                     gMemMap, DPC_OBJDET_MEMMAP_POOL_WINBUF, DPC_OBJDET_MEMMAP_OWNER_DOPPLER, "window");
+        if (windowBuffer == NULL)
+        {
+            retVal = DPC_OBJECTDETECTION_ENOMEM__CORE_LOCAL_RAM_DOPPLER_HWA_WINDOW;
+            goto exit;
+        }
+        hwaCfg->window = (int32_t *)windowBuffer;
+        winType = DPC_ObjDet_GenDopplerWindow(dopCfg);
     }
-    hwaCfg->window = (int32_t *)windowBuffer;
     hwaCfg->winRamOffset = (uint16_t) *windowOffset;
-    winType = DPC_ObjDet_GenDopplerWindow(dopCfg);
     if (winType != DPC_DPU_DOPPLERPROC_FFT_WINDOW_TYPE)
     {
         retVal = DPC_OBJECTDETECTION_WIN_ERR;
@@ -2625,9 +2826,13 @@ static int32_t DPC_ObjDet_dopplerConfig(SubFrameObj *obj,
 #endif
     if ((hwaCfg->winRamOffset + winGenLen) > DPC_OBJDET_HWA_MAX_WINDOW_RAM_SIZE_IN_SAMPLES)
     {
+        DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_WINRAM, DPC_OBJDET_MEMMAP_OWNER_DOPPLER, "winRam",
+                             DPC_OBJDET_MEMMAP_NO_FIT, winGenLen, 0U);
         retVal = DPC_OBJECTDETECTION_ENOMEM_HWA_WINDOW_RAM;
         goto exit;
     }
+    DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_WINRAM, DPC_OBJDET_MEMMAP_OWNER_DOPPLER, "winRam",
+                         *windowOffset, winGenLen, 0U);
     *windowOffset += winGenLen;
 
     /********************************************
@@ -2661,7 +2866,8 @@ static int32_t DPC_ObjDet_dopplerConfig(SubFrameObj *obj,
     /* Allocate an intersected shorter list in L2 RAM. */
     detObjListSizeInBytes = sizeof(DetObjParams) * hwRes->finalMaxNumDetObjs;
     DPC_ObjDet_MemPoolSet(CoreLocalRamObj, CoreLocalScratchStartPoolAddr);
-    scratchBufMem = DPC_ObjDet_MemPoolAlloc(CoreLocalRamObj, detObjListSizeInBytes, (uint8_t)sizeof(uint32_t));
+    scratchBufMem = DPC_ObjDet_MemPoolAllocTagged(CoreLocalRamObj, detObjListSizeInBytes, (uint8_t)sizeof(uint32_t),
+                                                  gMemMap, DPC_OBJDET_MEMMAP_POOL_L2, DPC_OBJDET_MEMMAP_OWNER_AOA, "detObjList");
     if (scratchBufMem == NULL)
     {
         retVal = DPC_OBJECTDETECTION_ENOMEM__OBJ_PARAMS_RAM_DOPPLER_DECOMP_BUF;
@@ -2671,7 +2877,8 @@ static int32_t DPC_ObjDet_dopplerConfig(SubFrameObj *obj,
     hwRes->finalDetObjList = (DetObjParams *)scratchBufMem;
 
     objOutSizeInBytes = sizeof(DPIF_PointCloudCartesian) * hwRes->finalMaxNumDetObjs;
-    scratchBufMem = DPC_ObjDet_MemPoolAlloc(L3ramObj, objOutSizeInBytes, (uint8_t)sizeof(uint32_t));
+    scratchBufMem = DPC_ObjDet_MemPoolAllocTagged(L3ramObj, objOutSizeInBytes, (uint8_t)sizeof(uint32_t),
+                                                  gMemMap, DPC_OBJDET_MEMMAP_POOL_L3, DPC_OBJDET_MEMMAP_OWNER_AOA, "objOut");
     if (scratchBufMem == NULL)
     {
         retVal = DPC_OBJECTDETECTION_ENOMEM__OBJ_PARAMS_RAM_DOPPLER_DECOMP_BUF;
@@ -2680,7 +2887,8 @@ static int32_t DPC_ObjDet_dopplerConfig(SubFrameObj *obj,
     hwRes->objOut = (DPIF_PointCloudCartesian *)scratchBufMem;
 
     sideInfoSizeInBytes = sizeof(DPIF_PointCloudSideInfo) * hwRes->finalMaxNumDetObjs;
-    scratchBufMem = DPC_ObjDet_MemPoolAlloc(L3ramObj, sideInfoSizeInBytes, (uint8_t)DOUBLEWORD_ALIGNED);
+    scratchBufMem = DPC_ObjDet_MemPoolAllocTagged(L3ramObj, sideInfoSizeInBytes, (uint8_t)DOUBLEWORD_ALIGNED,
+                                                  gMemMap, DPC_OBJDET_MEMMAP_POOL_L3, DPC_OBJDET_MEMMAP_OWNER_AOA, "sideInfo");
     if (scratchBufMem == NULL){
         retVal = DPC_OBJECTDETECTION_ENOMEM__OBJ_PARAMS_SIDEINFO;
         goto exit;
@@ -2719,7 +2927,8 @@ static int32_t DPC_ObjDet_dopplerConfig(SubFrameObj *obj,
                                 ((uint32_t)staticCfg->numRangeBins / (uint32_t)staticCfg->compressionCfg.rangeBinsPerBlock);
     }
 
-    scratchBufMem = DPC_ObjDet_MemPoolAlloc(L3ramObj, hwRes->decompScratchBufferSizeBytes, (uint8_t)sizeof(uint32_t));
+    scratchBufMem = DPC_ObjDet_MemPoolAllocTagged(L3ramObj, hwRes->decompScratchBufferSizeBytes, (uint8_t)sizeof(uint32_t),
+                                                  gMemMap, DPC_OBJDET_MEMMAP_POOL_L3, DPC_OBJDET_MEMMAP_OWNER_DOPPLER, "decompScr");
     if (scratchBufMem == NULL)
     {
         retVal = DPC_OBJECTDETECTION_ENOMEM__CORE_LOCAL_RAM_DOPPLER_DECOMP_BUF;
@@ -2788,6 +2997,9 @@ static int32_t DPC_ObjDet_dopplerConfig(SubFrameObj *obj,
     hwaCfg->decompStageHwaStateMachineCfg.paramSetStartIdx = DPC_OBJDET_DPU_DOPPLERPROCHWADDMA_PARAMSET_START_IDX + staticCfg->compressionCfg.bfpCompExtraParamSets;
     hwaCfg->decompStageHwaStateMachineCfg.paramSetStartIdx -= objDetObj->commonCfg.rangeProcCfg.rangeProcChain * 2U;
     hwaCfg->decompStageHwaStateMachineCfg.numParamSets = DPU_DOPPLERPOCHWADDMA_DECOMP_NUM_HWA_PARAMSETS + staticCfg->compressionCfg.bfpCompExtraParamSets;
+    DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_PARAMSET, DPC_OBJDET_MEMMAP_OWNER_DOPPLER, "decompPar",
+                         hwaCfg->decompStageHwaStateMachineCfg.paramSetStartIdx,
+                         hwaCfg->decompStageHwaStateMachineCfg.numParamSets, 0U);
 }}
 
 
@@ -2852,6 +3064,9 @@ static int32_t DPC_ObjDet_dopplerConfig(SubFrameObj *obj,
 	{
         hwaCfg->dopplerStageHwaStateMachineCfg.numParamSets = DPU_DOPPLERPOCHWADDMA_DOPPLER_NUM_HWA_PARAMSETS - DPU_DOPPLERPOCHWADDMA_SUMTX_NUM_HWA_PARAMSETS;
     }
+    DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_PARAMSET, DPC_OBJDET_MEMMAP_OWNER_DOPPLER, "dopplerPar",
+                         hwaCfg->dopplerStageHwaStateMachineCfg.paramSetStartIdx,
+                         hwaCfg->dopplerStageHwaStateMachineCfg.numParamSets, 0U);
 
     }}
 
@@ -2861,6 +3076,9 @@ static int32_t DPC_ObjDet_dopplerConfig(SubFrameObj *obj,
     {{
     hwaCfg->azimCfarStageHwaStateMachineCfg.paramSetStartIdx = hwaCfg->dopplerStageHwaStateMachineCfg.paramSetStartIdx + hwaCfg->dopplerStageHwaStateMachineCfg.numParamSets;
     hwaCfg->azimCfarStageHwaStateMachineCfg.numParamSets = DPU_DOPPLERPOCHWADDMA_AZIM_NUM_HWA_PARAMSETS + 2U * (dopStaticCfg->numRxAntennas - MAX_NUM_RX);
+    DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_PARAMSET, DPC_OBJDET_MEMMAP_OWNER_DOPPLER, "azimPar",
+                         hwaCfg->azimCfarStageHwaStateMachineCfg.paramSetStartIdx,
+                         hwaCfg->azimCfarStageHwaStateMachineCfg.numParamSets, 0U);
 
     /* Allocate the EDMA channel to copy the antenna samples of detected object. */
     DPC_ObjDet_EDMAChannelConfigAssist(edmaHandle,
@@ -2953,7 +3171,8 @@ static int32_t DPC_ObjDet_rangeCfarConfig(DPU_RangeCFARProcHWA_Handle dpuHandle,
 
     /* DPU Output Resource */
     res->rangeCfarListSizeBytes = sizeof(RangeCfarListObj) * DPC_OBJDET_RANGECFAR_MAX_NUM_OBJECTS;
-    scratchBufMem = DPC_ObjDet_MemPoolAlloc(L3ramObj, res->rangeCfarListSizeBytes, (uint8_t)sizeof(uint32_t));
+    scratchBufMem = DPC_ObjDet_MemPoolAllocTagged(L3ramObj, res->rangeCfarListSizeBytes, (uint8_t)sizeof(uint32_t),
+                                                  gMemMap, DPC_OBJDET_MEMMAP_POOL_L3, DPC_OBJDET_MEMMAP_OWNER_RANGE_CFAR, "cfarList");
     if (scratchBufMem == NULL)
     {
         retVal = DPC_OBJECTDETECTION_ENOMEM__OBJ_PARAMS_RAM_RANGE_CFAR_BUF;
@@ -2977,7 +3196,8 @@ static int32_t DPC_ObjDet_rangeCfarConfig(DPU_RangeCFARProcHWA_Handle dpuHandle,
 
     res->rangeCfarScratchBufSizeBytes = sizeof(cmplx32ImRe_t) * DPC_OBJDET_RANGECFAR_MAX_NUM_OBJECTS;
 
-    scratchBufMem = DPC_ObjDet_MemPoolAlloc(CoreLocalRamObj, res->rangeCfarScratchBufSizeBytes / 2U, (uint8_t)sizeof(uint32_t));
+    scratchBufMem = DPC_ObjDet_MemPoolAllocTagged(CoreLocalRamObj, res->rangeCfarScratchBufSizeBytes / 2U, (uint8_t)sizeof(uint32_t),
+                                                  gMemMap, DPC_OBJDET_MEMMAP_POOL_L2, DPC_OBJDET_MEMMAP_OWNER_RANGE_CFAR, "cfarScr0");
     if (scratchBufMem == NULL)
     {
         retVal = DPC_OBJECTDETECTION_ENOMEM__CORE_LOCAL_RAM_RANGECFAR_SCRATCH_BUF;
@@ -2985,7 +3205,8 @@ static int32_t DPC_ObjDet_rangeCfarConfig(DPU_RangeCFARProcHWA_Handle dpuHandle,
     }
     res->rangeCfarScratchBuf[0] = (uint8_t *)scratchBufMem;
 
-    scratchBufMem = DPC_ObjDet_MemPoolAlloc(CoreLocalRamObj, res->rangeCfarScratchBufSizeBytes / 2U, (uint8_t)sizeof(uint32_t));
+    scratchBufMem = DPC_ObjDet_MemPoolAllocTagged(CoreLocalRamObj, res->rangeCfarScratchBufSizeBytes / 2U, (uint8_t)sizeof(uint32_t),
+                                                  gMemMap, DPC_OBJDET_MEMMAP_POOL_L2, DPC_OBJDET_MEMMAP_OWNER_RANGE_CFAR, "cfarScr1");
     if (scratchBufMem == NULL)
     {
         retVal = DPC_OBJECTDETECTION_ENOMEM__CORE_LOCAL_RAM_RANGECFAR_SCRATCH_BUF;
@@ -2996,7 +3217,8 @@ static int32_t DPC_ObjDet_rangeCfarConfig(DPU_RangeCFARProcHWA_Handle dpuHandle,
     res->rangeCfarNumObjPerDopplerBinSizeBytes = sizeof(uint16_t) * staticCfg->numChirpsPerFrame / staticCfg->numBandsTotal;
 
     /* Allocating in L3 as this is required till the doppler and range CFAR intersecton stage.*/
-    scratchBufMem = DPC_ObjDet_MemPoolAlloc(L3ramObj, res->rangeCfarNumObjPerDopplerBinSizeBytes, (uint8_t)sizeof(uint32_t));
+    scratchBufMem = DPC_ObjDet_MemPoolAllocTagged(L3ramObj, res->rangeCfarNumObjPerDopplerBinSizeBytes, (uint8_t)sizeof(uint32_t),
+                                                  gMemMap, DPC_OBJDET_MEMMAP_POOL_L3, DPC_OBJDET_MEMMAP_OWNER_RANGE_CFAR, "cfarNumObj");
     if (scratchBufMem == NULL)
     {
         retVal = DPC_OBJECTDETECTION_ENOMEM__CORE_LOCAL_RAM_RANGECFAR_NUMOBJ_PER_DOPPLER_BUF;
@@ -3004,6 +3226,9 @@ static int32_t DPC_ObjDet_rangeCfarConfig(DPU_RangeCFARProcHWA_Handle dpuHandle,
     }
     res->rangeCfarNumObjPerDopplerBinBuf = (uint8_t *)scratchBufMem;
 
+    /* The intersection stage expects the range CFAR bitmap to start out clear */
+    (void)memset(gRangeCfarBitmap, 0, sizeof(gRangeCfarBitmap));
+
     /* Assign the detection matrix */
     res->detMatrix = *detMatrix;
 	    }
@@ -3061,6 +3286,8 @@ static int32_t DPC_ObjDet_rangeCfarConfig(DPU_RangeCFARProcHWA_Handle dpuHandle,
 
     res->hwaCfg.numParamSet = DPU_RANGECFARPROCHWADDMA_NUM_HWA_PARAMSETS;
     res->hwaCfg.paramSetStartIdx = (uint8_t)DPC_OBJDET_DPU_RANGECFARPROCHWADDMA_PARAMSET_START_IDX + 2U * staticCfg->compressionCfg.bfpCompExtraParamSets;
+    DPC_ObjDet_memMapAdd(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_PARAMSET, DPC_OBJDET_MEMMAP_OWNER_RANGE_CFAR, "params",
+                         res->hwaCfg.paramSetStartIdx, res->hwaCfg.numParamSet, 0U);
 
     retVal = DPU_RangeCFARProcHWA_config(dpuHandle, cfgSave);
     if (retVal != 0)
@@ -3093,6 +3320,8 @@ exit:
  *     No L3 buffers are presently required that need to be preserved across sub-frames
  *     (type described in #1 above), neither are L3 scratch buffers required for
  *     intermediate processing within DPU process call.
+ *  4. Every buffer handed out, HWA window RAM and param sets included, is written
+ *     into the sub-frame's memory map in gDpcMemMap.
  *
  *  @param[in]  obj Pointer to sub-frame object
  *  @param[in]  commonCfg Pointer to pre-start common configuration
@@ -3169,6 +3398,15 @@ static int32_t DPC_ObjDet_preStartConfig(SubFrameObj *obj,
     DPC_ObjDet_MemPoolReset(L3ramObj);
     DPC_ObjDet_MemPoolReset(CoreLocalRamObj);
 
+    /* Start the memory map of the sub-frame */
+    DPC_ObjDet_memMapReset(gMemMap);
+    DPC_ObjDet_memMapSetPool(gMemMap, DPC_OBJDET_MEMMAP_POOL_L3, L3ramObj->cfg.size);
+    DPC_ObjDet_memMapSetPool(gMemMap, DPC_OBJDET_MEMMAP_POOL_L2, CoreLocalRamObj->cfg.size);
+    DPC_ObjDet_memMapSetPool(gMemMap, DPC_OBJDET_MEMMAP_POOL_WINBUF, sizeof(gWinBuf));
+    DPC_ObjDet_memMapSetPool(gMemMap, DPC_OBJDET_MEMMAP_POOL_PREPROC, ptrObjDetObj->preProcBufObj.cfg.size);
+    DPC_ObjDet_memMapSetPool(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_WINRAM, DPC_OBJDET_HWA_MAX_WINDOW_RAM_SIZE_IN_SAMPLES);
+    DPC_ObjDet_memMapSetPool(gMemMap, DPC_OBJDET_MEMMAP_POOL_HWA_PARAMSET, SOC_HWA_NUM_PARAM_SETS);
+
     /* L3 allocations */
     /* L3 - radar cube */
     /* Input and output samples out of the rangeproc/compression DPU */
@@ -3188,8 +3426,9 @@ static int32_t DPC_ObjDet_preStartConfig(SubFrameObj *obj,
                                         (uint32_t)staticCfg->ADCBufData.dataProperty.numRxAntennas * sizeof(cmplx16ReIm_t);
     temp = (float) radarCubeDecompressedSizeInBytes * achievedCompressionRatio;
     radarCube.dataSize = (uint32_t)temp;
-    radarCube.data = DPC_ObjDet_MemPoolAlloc(L3ramObj, radarCube.dataSize,
-                                            (uint8_t)DPC_OBJDET_RADAR_CUBE_DATABUF_BYTE_ALIGNMENT);
+    radarCube.data = DPC_ObjDet_MemPoolAllocTagged(L3ramObj, radarCube.dataSize,
+                                            (uint8_t)DPC_OBJDET_RADAR_CUBE_DATABUF_BYTE_ALIGNMENT,
+                                            gMemMap, DPC_OBJDET_MEMMAP_POOL_L3, DPC_OBJDET_MEMMAP_OWNER_RANGE, "radarCube");
 
     if (radarCube.data == NULL)
     {
@@ -3202,8 +3441,9 @@ static int32_t DPC_ObjDet_preStartConfig(SubFrameObj *obj,
     {
         /* L3 - detection matrix */
         detMatrix.dataSize = (uint32_t)staticCfg->numRangeBins * ((uint32_t)staticCfg->numDopplerBins / (uint32_t)staticCfg->numBandsTotal) * sizeof(uint16_t);
-        detMatrix.data = DPC_ObjDet_MemPoolAlloc(L3ramObj, detMatrix.dataSize,
-                                                (uint8_t)DPC_OBJDET_DET_MATRIX_DATABUF_BYTE_ALIGNMENT);
+        detMatrix.data = DPC_ObjDet_MemPoolAllocTagged(L3ramObj, detMatrix.dataSize,
+                                                (uint8_t)DPC_OBJDET_DET_MATRIX_DATABUF_BYTE_ALIGNMENT,
+                                                gMemMap, DPC_OBJDET_MEMMAP_POOL_L3, DPC_OBJDET_MEMMAP_OWNER_DOPPLER, "detMatrix");
         if (detMatrix.data == NULL)
         {
             retVal = DPC_OBJECTDETECTION_ENOMEM__L3_RAM_DET_MATRIX;
@@ -3282,6 +3522,31 @@ static int32_t DPC_ObjDet_preStartConfig(SubFrameObj *obj,
         goto exit;
     }
 
+    gAoaObjOut[0] = obj->dpuCfg.dopplerCfg.hwRes.objOut;
+    gAoaSideInfo[0] = obj->detObjOutSideInfo;
+    gAoaObjOut[1] = NULL;
+    gAoaSideInfo[1] = NULL;
+#ifdef DPC_OBJDET_PIPELINED_AOA
+    /* Second point cloud buffer, so the one returned for a frame stays
+     * untouched while the AoA of the next frame writes the other */
+    if (commonCfg->numSubFrames == 1U)
+    {
+        gAoaObjOut[1] = (DPIF_PointCloudCartesian *)DPC_ObjDet_MemPoolAllocTagged(L3ramObj,
+                            sizeof(DPIF_PointCloudCartesian) * obj->dpuCfg.dopplerCfg.hwRes.finalMaxNumDetObjs,
+                            (uint8_t)sizeof(uint32_t),
+                            gMemMap, DPC_OBJDET_MEMMAP_POOL_L3, DPC_OBJDET_MEMMAP_OWNER_AOA, "objOut1");
+        gAoaSideInfo[1] = (DPIF_PointCloudSideInfo *)DPC_ObjDet_MemPoolAllocTagged(L3ramObj,
+                            sizeof(DPIF_PointCloudSideInfo) * obj->dpuCfg.dopplerCfg.hwRes.finalMaxNumDetObjs,
+                            (uint8_t)DOUBLEWORD_ALIGNED,
+                            gMemMap, DPC_OBJDET_MEMMAP_POOL_L3, DPC_OBJDET_MEMMAP_OWNER_AOA, "sideInfo1");
+        if ((gAoaObjOut[1] == NULL) || (gAoaSideInfo[1] == NULL))
+        {
+            retVal = DPC_OBJECTDETECTION_ENOMEM__OBJ_PARAMS_SIDEINFO;
+            goto exit;
+        }
+    }
+#endif
+
 #ifdef SUBSYS_DSS
     /* Sin values of FOV */
     obj->aoaFovSinVal.minAzimuthSinVal   = sinsp(radConversionFactor * obj->staticCfg.aoaFovCfg.minAzimuthDeg);
@@ -3293,6 +3558,7 @@ static int32_t DPC_ObjDet_preStartConfig(SubFrameObj *obj,
     /* Report RAM usage */
     *CoreLocalRamUsage = DPC_ObjDet_MemPoolGetMaxUsage(CoreLocalRamObj);
     *L3RamUsage = DPC_ObjDet_MemPoolGetMaxUsage(L3ramObj);
+    gMemMap->valid = 1U;
 
 exit:
     return retVal;
@@ -3346,6 +3612,13 @@ int32_t DPC_ObjectDetection_ioctl(
 
         objDetObj->commonCfg = *cfg;
         objDetObj->isCommonCfgReceived = true;
+
+        /* Pre-start configs of every sub-frame follow, they pick their
+         * windows from the cache again */
+        DPC_ObjDet_winCacheNewConfig(&gWinCache);
+
+        /* and write new memory maps */
+        (void)memset((void *)&gDpcMemMap[0], 0, sizeof(gDpcMemMap));
         
         objDetObj->preProcBufObj.cfg.addr = &preProcBuffer[0];
         objDetObj->preProcBufObj.cfg.size = sizeof(preProcBuffer);
@@ -3454,6 +3727,7 @@ int32_t DPC_ObjectDetection_ioctl(
                 memUsage = &cfg->memUsage;
                 memUsage->L3RamTotal = objDetObj->L3RamObj.cfg.size;
                 memUsage->CoreLocalRamTotal = objDetObj->CoreLocalRamObj.cfg.size;
+                gMemMap = &gDpcMemMap[subFrameNum];
                 retVal = DPC_ObjDet_preStartConfig(subFrmObj,
                              &objDetObj->commonCfg, &cfg->staticCfg,
                              &objDetObj->edmaHandle[0],
@@ -3468,6 +3742,9 @@ int32_t DPC_ObjectDetection_ioctl(
                 {
                     goto exit;
                 }
+#ifdef DPC_OBJDET_COMP_TUNE
+                DPC_ObjDet_compTuneConfig(objDetObj, subFrmObj, subFrameNum);
+#endif
 
 #if defined(SOC_AWR2X44P)
                 /* Populate the configs requirred for AoA estimation */
@@ -3574,6 +3851,7 @@ DPM_DPCHandle DPC_ObjectDetection_init(
 
     /* Initialize memory */
     (void)memset((void *)objDetObj, 0, sizeof(ObjDetObj));
+    DPC_ObjDet_winCacheInit(&gWinCache, &gWinBuf[0], sizeof(gWinBuf));
 
 #ifdef INCLUDE_DPM
     /* Copy over the DPM configuration: */
@@ -3585,6 +3863,9 @@ DPM_DPCHandle DPC_ObjectDetection_init(
     objDetObj->hwaHandle = dpcInitParams->hwaHandle;
     objDetObj->L3RamObj.cfg = dpcInitParams->L3ramCfg;
     objDetObj->CoreLocalRamObj.cfg = dpcInitParams->CoreLocalRamCfg;
+#ifdef DPC_OBJDET_CAPTURE
+    DPC_ObjDet_captureSetup(objDetObj);
+#endif
 
     for(i = 0; i < (uint32_t)EDMA_NUM_CC; i++)
     {
@@ -44,140 +44,1003 @@
 #include <C:/ti/mmwave_mcuplus_sdk_04_07_01_04/mmwave_mcuplus_sdk_04_07_01_04/ti/utils/cli/cli.h> //needed for CLI wrapper
 #include "FreeRTOS.h" //needed for task management
 #include "task.h" //needed for task management
+#include <kernel/dpl/SemaphoreP.h> //needed for the offload request table
+#include <kernel/dpl/ClockP.h> //needed for job latency
+#include <kernel/dpl/CycleCounterP.h> //needed for IPC benchmark timestamps
 #include <C:\Users\there\Documents\Capstone\RadarFirmware\enums.h> //my custom universal values
+#include <C:\Users\there\Documents\Capstone\RadarFirmware\job_sched.h> //picks which core runs a job
+#include <C:\Users\there\Documents\Capstone\RadarFirmware\ipc_bench.h> //IPC benchmark harness
 
 //RPMessage objects
 static RPMessage_Object gMsgObj;
 static RPMessage_Object gRecvObj;
+static RPMessage_Object gBenchObj; //benchmark echoes, kept off gRecvObj so the dispatcher never sees them
 
-//command structure
+//batch operands and the DSP ring, fills all of USER_SHM_MEM so it starts at IPC_SHM_BASE
+uint8_t gIpcShm[IPC_SHM_SIZE] __attribute__((aligned(128), section(".bss.user_shared_mem")));
+
+//producer side of the shared memory ring to the DSP
+static IpcRing *gRing = (IpcRing *)&gIpcShm[IPC_SHM_RING_OFFSET];
+
+/* ======================= Offload Dispatcher ======================= */
+/*
+ * Every reply from R5F_1 and the DSP lands on gRecvObj. Instead of each
+ * caller blocking in RPMessage_recv (which only allows one request in
+ * flight and lets one caller eat another caller's reply) a single
+ * dispatcher task owns the receive side and hands each reply to whoever
+ * is waiting on that request id. Callers can either block for the result
+ * or register a callback and keep sending.
+ */
+
+//how many requests can be outstanding at once across all cores
+#define OFFLOAD_MAX_PENDING (16U)
+
+//dispatcher task setup (runs above the CLI so replies are never left waiting)
+#define OFFLOAD_TASK_PRI (4U)
+#define OFFLOAD_TASK_SIZE (4096U/sizeof(configSTACK_DEPTH_TYPE))
+
+//called from the dispatcher task when a request finishes
+typedef void (*OffloadCallback)(uint16_t reqId, int32_t status, int32_t result, void *arg);
+
+//one outstanding request
 typedef struct {
-    char op[4]; //opcode
-    int x; //first number
-    int y; //second number
-} MathCmd;
+    uint8_t inUse; //slot is taken
+    uint8_t done; //reply has arrived (blocking callers only)
+    uint8_t opcode; //opcode that was sent, used to check the reply
+    uint16_t reqId; //id that was sent
+    uint16_t remoteCoreId; //core the request went to
+    int32_t status; //reply status
+    int32_t result; //reply value
+    OffloadCallback callback; //NULL if a caller is blocked on doneSem
+    void *cbArg; //passed back to the callback
+    SemaphoreP_Object doneSem; //posted when a blocking request finishes
+} OffloadSlot;
+
+static OffloadSlot gOffloadSlots[OFFLOAD_MAX_PENDING];
+static SemaphoreP_Object gOffloadLock; //protects gOffloadSlots and gOffloadNextReqId
+static uint16_t gOffloadNextReqId = 0;
+
+StackType_t gOffloadTaskStack[OFFLOAD_TASK_SIZE] __attribute__((aligned(32)));
+StaticTask_t gOffloadTaskObj;
+TaskHandle_t gOffloadTask;
 
 /* This function sends commands to the correct cores to offload tasks
  */
-static void send_to_core(uint16_t RemoteCoreID, uint16_t RemoteEndPt, char buf[64])
+static int32_t send_to_core(uint16_t RemoteCoreID, uint16_t RemoteEndPt, IpcMsg *msg, uint16_t size)
+{
+    return RPMessage_send( msg, size,
+                           RemoteCoreID, RemoteEndPt,
+                           gMainSendEndPt, SystemP_WAIT_FOREVER);
+}
+
+/* This function finds the slot waiting on a reply.
+ * The lock must be held. Returns -1 if nobody is waiting on it.
+ */
+static int32_t offload_find_slot(uint16_t reqId, uint16_t remoteCoreId)
+{
+    uint32_t i;
+    for(i = 0; i < OFFLOAD_MAX_PENDING; i++)
+    {
+        if(gOffloadSlots[i].inUse && (gOffloadSlots[i].done == 0) &&
+           (gOffloadSlots[i].reqId == reqId) && (gOffloadSlots[i].remoteCoreId == remoteCoreId))
+        {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+/* This function is the dispatcher task.
+ * It receives every reply sent to R5F_0 and completes the matching request.
+ */
+static void offload_dispatch_task(void *args)
+{
+    uint8_t recv_buf[IPC_MSG_MAX_SIZE];
+    IpcMsg msg;
+
+    while(1)
+    {
+        uint16_t recv_buf_size = sizeof(recv_buf);
+        uint16_t SrcCore;
+        uint16_t SrcEndPt;
+        int32_t status = RPMessage_recv(&gRecvObj, recv_buf, &recv_buf_size, &SrcCore, &SrcEndPt, SystemP_WAIT_FOREVER);
+        if(status != 0)
+        {
+            continue;
+        }
+
+        int16_t msgStatus = ipc_msg_decode(recv_buf, recv_buf_size, &msg);
+        if(msgStatus == IPC_STATUS_BAD_LENGTH && recv_buf_size < sizeof(IpcMsgHeader))
+        {
+            DebugP_log("Dropped runt reply from core %u\r\n", SrcCore);
+            continue; //no request id to match it with
+        }
+
+        SemaphoreP_pend(&gOffloadLock, SystemP_WAIT_FOREVER);
+        int32_t idx = offload_find_slot(msg.hdr.reqId, SrcCore);
+        if(idx < 0)
+        {
+            SemaphoreP_post(&gOffloadLock);
+            DebugP_log("Dropped reply %u from core %u, no request waiting\r\n", msg.hdr.reqId, SrcCore);
+            continue;
+        }
+
+        OffloadSlot *slot = &gOffloadSlots[idx];
+        if(msgStatus != IPC_STATUS_OK)
+        {
+            slot->status = msgStatus;
+        }
+        else if(msg.hdr.opcode != (slot->opcode | IPC_OP_RESULT))
+        {
+            slot->status = IPC_STATUS_BAD_OPCODE;
+        }
+        else
+        {
+            slot->status = msg.hdr.status;
+            slot->result = msg.payload.result;
+        }
+
+        if(slot->callback != NULL)
+        {
+            //copy out and free the slot before calling so the callback can resubmit
+            OffloadCallback callback = slot->callback;
+            void *cbArg = slot->cbArg;
+            uint16_t reqId = slot->reqId;
+            int32_t slotStatus = slot->status;
+            int32_t result = slot->result;
+            slot->inUse = 0;
+            SemaphoreP_post(&gOffloadLock);
+            callback(reqId, slotStatus, result, cbArg);
+        }
+        else
+        {
+            //the blocked caller frees the slot once it has read the result
+            slot->done = 1;
+            SemaphoreP_post(&gOffloadLock);
+            SemaphoreP_post(&slot->doneSem);
+        }
+    }
+}
+
+/* This function sets up the request table and starts the dispatcher task.
+ * gRecvObj must already be constructed.
+ */
+static void offload_init(void)
 {
-    uint16_t size = strlen(buf) + 1; //add 1 to account for terminating character
-    RPMessage_send( buf, size,
-                    RemoteCoreID, RemoteEndPt,
-                    gMainSendEndPt, SystemP_WAIT_FOREVER);
+    uint32_t i;
+    SemaphoreP_constructMutex(&gOffloadLock);
+    for(i = 0; i < OFFLOAD_MAX_PENDING; i++)
+    {
+        gOffloadSlots[i].inUse = 0;
+        SemaphoreP_constructBinary(&gOffloadSlots[i].doneSem, 0);
+    }
+
+    gOffloadTask = xTaskCreateStatic( offload_dispatch_task, /* Pointer to the function that implements the task. */
+                                      "offload_dispatch",    /* Text name for the task.  This is to facilitate debugging only. */
+                                      OFFLOAD_TASK_SIZE,     /* Stack depth in units of StackType_t typically uint32_t on 32b CPUs */
+                                      NULL,                  /* We are not using the task parameter. */
+                                      OFFLOAD_TASK_PRI,      /* task priority, 0 is lowest priority, configMAX_PRIORITIES-1 is highest */
+                                      gOffloadTaskStack,     /* pointer to stack base */
+                                      &gOffloadTaskObj );    /* pointer to statically allocated task object memory */
+    configASSERT(gOffloadTask != NULL);
+}
+
+/* This function reserves a slot, tags an encoded request and sends it.
+ * It does not wait for the reply. Returns the slot index or a negative status.
+ */
+static int32_t offload_send(IpcMsg *msg, uint16_t size,
+                            uint16_t RemoteCoreID, uint16_t RemoteEndPt,
+                            OffloadCallback callback, void *cbArg, uint16_t *reqIdOut)
+{
+    int32_t idx = -1;
+    uint32_t i;
+
+    SemaphoreP_pend(&gOffloadLock, SystemP_WAIT_FOREVER);
+    for(i = 0; i < OFFLOAD_MAX_PENDING; i++)
+    {
+        if(gOffloadSlots[i].inUse == 0)
+        {
+            idx = (int32_t)i;
+            break;
+        }
+    }
+    if(idx < 0)
+    {
+        SemaphoreP_post(&gOffloadLock);
+        return IPC_STATUS_BUSY;
+    }
+
+    //claim the slot before sending so a fast reply always finds it
+    OffloadSlot *slot = &gOffloadSlots[idx];
+    slot->inUse = 1;
+    slot->done = 0;
+    slot->opcode = msg->hdr.opcode;
+    slot->reqId = gOffloadNextReqId++;
+    slot->remoteCoreId = RemoteCoreID;
+    slot->status = IPC_STATUS_OK;
+    slot->result = 0;
+    slot->callback = callback;
+    slot->cbArg = cbArg;
+    uint16_t reqId = slot->reqId;
+    SemaphoreP_post(&gOffloadLock);
+
+    msg->hdr.reqId = reqId;
+    int32_t status = send_to_core(RemoteCoreID, RemoteEndPt, msg, size);
+    if(status != 0)
+    {
+        SemaphoreP_pend(&gOffloadLock, SystemP_WAIT_FOREVER);
+        slot->inUse = 0;
+        SemaphoreP_post(&gOffloadLock);
+        return status;
+    }
+
+    if(reqIdOut != NULL)
+    {
+        *reqIdOut = reqId;
+    }
+    return idx;
+}
+
+/* This function sends a two-number math command to another core without
+ * waiting. callback runs on the dispatcher task when the reply arrives.
+ * Returns 0 or IPC_STATUS_BUSY if too many requests are outstanding.
+ */
+static int32_t offload_math_async(uint8_t opcode, int32_t x, int32_t y,
+                                  uint16_t RemoteCoreID, uint16_t RemoteEndPt,
+                                  OffloadCallback callback, void *cbArg, uint16_t *reqId)
+{
+    IpcMsg msg;
+    uint16_t size = ipc_msg_encode_math(&msg, opcode, 0, x, y);
+    int32_t idx = offload_send(&msg, size, RemoteCoreID, RemoteEndPt, callback, cbArg, reqId);
+    return (idx < 0) ? idx : 0;
+}
+
+/* This function waits for a blocking request to finish and frees its slot.
+ */
+static int32_t offload_wait(int32_t idx, int32_t *result)
+{
+    OffloadSlot *slot = &gOffloadSlots[idx];
+    SemaphoreP_pend(&slot->doneSem, SystemP_WAIT_FOREVER);
+
+    SemaphoreP_pend(&gOffloadLock, SystemP_WAIT_FOREVER);
+    int32_t status = slot->status;
+    *result = slot->result;
+    slot->inUse = 0;
+    SemaphoreP_post(&gOffloadLock);
+    return status;
+}
+
+/* This function sends a two-number math command to another core and waits
+ * for the binary reply. Other requests can be in flight at the same time.
+ */
+static int32_t offload_math(uint8_t opcode, int32_t x, int32_t y,
+                            uint16_t RemoteCoreID, uint16_t RemoteEndPt, int32_t *result)
+{
+    IpcMsg msg;
+    uint16_t size = ipc_msg_encode_math(&msg, opcode, 0, x, y);
+    int32_t idx = offload_send(&msg, size, RemoteCoreID, RemoteEndPt, NULL, NULL, NULL);
+    if(idx < 0)
+    {
+        return idx;
+    }
+    return offload_wait(idx, result);
+}
+
+/* This function publishes the entry from ipc_ring_reserve and rings the
+ * DSP's doorbell. seq is set to the entry's sequence number for ipc_ring_done.
+ */
+static int32_t ring_commit(uint32_t *seq)
+{
+    IpcMsg msg;
+    uint32_t head = ipc_ring_commit(gRing);
+    uint16_t size = ipc_msg_encode_doorbell(&msg, head);
+    *seq = head - 1U;
+    return send_to_core(CSL_CORE_ID_C66SS0, gDSPRecEndPt, &msg, size);
+}
+
+/* ======================= Job Scheduler ======================= */
+/*
+ * ADD/SUB/MUL and the VEC batches go through job_sched.h instead of a
+ * fixed core. The scheduler queues each job on the core it expects to
+ * finish first and sched_pump() starts queued jobs as cores free up.
+ * R5F_0 jobs run right inside the pump, the others go out through the
+ * offload dispatcher and finish in its callback.
+ */
+
+//one job waiting on the scheduler, lives on the caller's stack
+typedef struct {
+    IpcMsg msg; //encoded request
+    uint16_t size;
+    SchedJob job; //filled in when the job starts
+    uint64_t startUs; //when it started, for the latency estimate
+    int32_t status;
+    int32_t result;
+    SemaphoreP_Object doneSem; //posted when the job finishes
+} SchedWaiter;
+
+static Sched gSched;
+static SemaphoreP_Object gSchedLock; //protects gSched
+
+//where to send jobs for each enum sched_core (R5F_0 runs them itself)
+static const uint16_t gSchedCoreId[SCHED_NUM_CORES] = {CSL_CORE_ID_R5FSS0_0, CSL_CORE_ID_R5FSS0_1, CSL_CORE_ID_C66SS0};
+static const uint16_t gSchedEndPt[SCHED_NUM_CORES] = {gMainRecEndPt, gSubRecEndPt, gDSPRecEndPt};
+static const char *gSchedCoreName[SCHED_NUM_CORES] = {"R5F0", "R5F1", "DSP"};
+
+static void sched_pump(void);
+
+/* This function registers every job the cores know how to run.
+ * Starting guesses are rough, the measured latency takes over quickly.
+ */
+static void sched_setup(void)
+{
+    //scalar math is cheap everywhere, remote cost is mostly the IPC round trip
+    const uint32_t mathSeedUs[SCHED_NUM_CORES] = {2U, 40U, 60U};
+    //batches are cheapest with the DSP's SIMD loop once they are big enough
+    const uint32_t vecSeedUs[SCHED_NUM_CORES] = {400U, 300U, 120U};
+
+    SemaphoreP_constructMutex(&gSchedLock);
+    sched_init(&gSched);
+    sched_register_op(&gSched, IPC_OP_ADD, SCHED_CAP_ALL, mathSeedUs);
+    sched_register_op(&gSched, IPC_OP_SUB, SCHED_CAP_ALL, mathSeedUs);
+    sched_register_op(&gSched, IPC_OP_MUL, SCHED_CAP_ALL, mathSeedUs);
+    sched_register_op(&gSched, IPC_OP_VEC_ADD, SCHED_CAP_ALL, vecSeedUs);
+    sched_register_op(&gSched, IPC_OP_VEC_SUB, SCHED_CAP_ALL, vecSeedUs);
+    sched_register_op(&gSched, IPC_OP_VEC_MUL, SCHED_CAP_ALL, vecSeedUs);
+    //DSP only kernels register here with SCHED_CAP(SCHED_CORE_DSP)
+}
+
+/* This function records a finished job and wakes its caller.
+ * The waiter can go away as soon as doneSem is posted.
+ */
+static void sched_job_finish(SchedWaiter *w, int32_t status, int32_t result)
+{
+    uint32_t elapsedUs = (uint32_t)(ClockP_getTimeUsec() - w->startUs);
+
+    SemaphoreP_pend(&gSchedLock, SystemP_WAIT_FOREVER);
+    sched_complete(&gSched, &w->job, elapsedUs);
+    SemaphoreP_post(&gSchedLock);
+
+    w->status = status;
+    w->result = result;
+    SemaphoreP_post(&w->doneSem);
+}
+
+/* This function fails a job that was never sent and wakes its caller.
+ * The scheduler frees its slot without taking a latency sample.
+ */
+static void sched_job_fail(SchedWaiter *w, int32_t status)
+{
+    SemaphoreP_pend(&gSchedLock, SystemP_WAIT_FOREVER);
+    sched_abort(&gSched, &w->job);
+    SemaphoreP_post(&gSchedLock);
+
+    w->status = status;
+    w->result = 0;
+    SemaphoreP_post(&w->doneSem);
+}
+
+/* This function is the offload callback for scheduled jobs.
+ * It runs on the dispatcher task.
+ */
+static void sched_remote_done(uint16_t reqId, int32_t status, int32_t result, void *arg)
+{
+    sched_job_finish((SchedWaiter *)arg, status, result);
+    sched_pump(); //a core just freed up
+}
+
+/* This function starts queued jobs on every core that has room.
+ */
+static void sched_pump(void)
+{
+    uint32_t started;
+    do
+    {
+        uint32_t core;
+        started = 0;
+        for(core = 0; core < SCHED_NUM_CORES; core++)
+        {
+            SchedJob job;
+            SemaphoreP_pend(&gSchedLock, SystemP_WAIT_FOREVER);
+            int32_t got = sched_next(&gSched, core, &job);
+            SemaphoreP_post(&gSchedLock);
+            if(!got)
+            {
+                continue;
+            }
+            started++;
+
+            SchedWaiter *w = (SchedWaiter *)job.arg;
+            w->job = job;
+            w->startUs = ClockP_getTimeUsec();
+            if(core == SCHED_CORE_R5F0)
+            {
+                //run it here with the same code the other cores use
+                IpcMsg reply;
+                if(ipc_opcode_is_vec(w->msg.hdr.opcode))
+                {
+                    ipc_msg_handle_vec(&w->msg, &reply, ipc_vec_run);
+                }
+                else
+                {
+                    ipc_msg_handle_math(&w->msg, &reply);
+                }
+                sched_job_finish(w, reply.hdr.status, reply.payload.result);
+            }
+            else
+            {
+                int32_t idx = offload_send(&w->msg, w->size, gSchedCoreId[core], gSchedEndPt[core],
+                                           sched_remote_done, w, NULL);
+                if(idx < 0)
+                {
+                    sched_job_fail(w, idx);
+                }
+            }
+        }
+    } while(started > 0);
+}
+
+/* This function runs an encoded request on whichever core the scheduler
+ * picks and waits for it. core is set to the enum sched_core that ran it.
+ */
+static int32_t sched_run(IpcMsg *msg, uint16_t size, int32_t *result, int32_t *core)
+{
+    SchedWaiter w;
+    w.msg = *msg;
+    w.size = size;
+    w.status = 0;
+    w.result = 0;
+    SemaphoreP_constructBinary(&w.doneSem, 0);
+
+    SemaphoreP_pend(&gSchedLock, SystemP_WAIT_FOREVER);
+    int32_t picked = sched_submit(&gSched, msg->hdr.opcode, &w);
+    SemaphoreP_post(&gSchedLock);
+    if(picked < 0)
+    {
+        SemaphoreP_destruct(&w.doneSem);
+        return picked;
+    }
+
+    sched_pump();
+    SemaphoreP_pend(&w.doneSem, SystemP_WAIT_FOREVER);
+    SemaphoreP_destruct(&w.doneSem);
+
+    *result = w.result;
+    *core = w.job.core; //may differ from picked if another core took it
+    return w.status;
+}
+
+/* This function runs a two-number math command wherever it will finish first
+ */
+static int32_t sched_math(uint8_t opcode, int32_t x, int32_t y, int32_t *result, int32_t *core)
+{
+    IpcMsg msg;
+    uint16_t size = ipc_msg_encode_math(&msg, opcode, 0, x, y);
+    return sched_run(&msg, size, result, core);
 }
 
 /* ======================= Command Handlers ======================= */
 
-/* This function handles addition.
- * It is run locally
+/* This function runs one of the two-number commands for the CLI.
+ * The scheduler decides which core does the work unless a core is named.
  */
-static int32_t cmd_add(int32_t argc, char* argv[])
+static int32_t cmd_math(const char *name, uint8_t opcode, int32_t argc, char* argv[])
 {
-    if(argc == 3) //make sure there are 3 parts of the argument
+    int32_t result = 0;
+    int32_t core = -1;
+    int32_t status;
+
+    if(argc != 3 && argc != 4) //make sure there are 3 or 4 parts of the argument
     {
-        int x = atoi(argv[1]); //set second part (first number) as x
-        int y = atoi(argv[2]); //set third part (second number) as y
-        int result = x + y; //add numbers
+        DebugP_log("Usage: %s X Y [R5F0|R5F1|DSP]\r\n", name);
+        return -1;
+    }
 
-        //give result to the CLI
-        DebugP_log("ADD result = %d\r\n", result);
+    if(argc == 4)
+    {
+        //pinned to one core, skips the scheduler
+        for(core = 0; core < SCHED_NUM_CORES; core++)
+        {
+            if(strcmp(argv[3], gSchedCoreName[core]) == 0)
+            {
+                break;
+            }
+        }
+        if(core == SCHED_NUM_CORES)
+        {
+            DebugP_log("Usage: %s X Y [R5F0|R5F1|DSP]\r\n", name);
+            return -1;
+        }
+        if(core == SCHED_CORE_R5F0)
+        {
+            IpcMsg req, reply;
+            ipc_msg_encode_math(&req, opcode, 0, atoi(argv[1]), atoi(argv[2]));
+            ipc_msg_handle_math(&req, &reply);
+            status = reply.hdr.status;
+            result = reply.payload.result;
+        }
+        else
+        {
+            status = offload_math(opcode, atoi(argv[1]), atoi(argv[2]),
+                                  gSchedCoreId[core], gSchedEndPt[core], &result);
+        }
     }
     else
     {
-        DebugP_log("Usage: ADD X Y\r\n");
-        return -1;
+        status = sched_math(opcode, atoi(argv[1]), atoi(argv[2]), &result, &core);
     }
+
+    if(status != 0)
+    {
+        DebugP_log("%s failed with status %d\r\n", name, status);
+        return status;
+    }
+    DebugP_log("%s result = %d (ran on %s)\r\n", name, result, gSchedCoreName[core]);
     return 0;
 }
 
+/* This function handles addition.
+ */
+static int32_t cmd_add(int32_t argc, char* argv[])
+{
+    return cmd_math("ADD", IPC_OP_ADD, argc, argv);
+}
+
 /* This function handles subtraction.
- * It is run on the R5F1 core.
  */
 static int32_t cmd_sub(int32_t argc, char* argv[])
 {
-    if(argc == 3) //make sure there are 3 parts of the argument
+    return cmd_math("SUB", IPC_OP_SUB, argc, argv);
+}
+
+/* This function handles multiplication.
+ */
+static int32_t cmd_mul(int32_t argc, char* argv[])
+{
+    return cmd_math("MUL", IPC_OP_MUL, argc, argv);
+}
+
+/* This function prints what the scheduler has learned about each core
+ */
+static int32_t cmd_sched(int32_t argc, char* argv[])
+{
+    uint32_t core;
+    uint32_t op;
+
+    SemaphoreP_pend(&gSchedLock, SystemP_WAIT_FOREVER);
+    for(core = 0; core < SCHED_NUM_CORES; core++)
     {
-        char buf[64];
-        uint16_t buf_size = sizeof(buf);
-        snprintf(buf, buf_size-1, "SUB %s %s", argv[1], argv[2]);
-        send_to_core(CSL_CORE_ID_R5FSS0_1, gSubRecEndPt, buf);
+        DebugP_log("%s: backlog %u us, in flight %u, queued %u, stolen %u\r\n", gSchedCoreName[core],
+                   gSched.backlogUs[core], gSched.inFlight[core], gSched.queue[core].count, gSched.steals[core]);
+        for(op = 0; op < gSched.numOps; op++)
+        {
+            if(gSched.ops[op].capMask & SCHED_CAP(core))
+            {
+                DebugP_log("    op 0x%02x: %u us\r\n", gSched.ops[op].opcode, gSched.estUs[core][op]);
+            }
+        }
+    }
+    SemaphoreP_post(&gSchedLock);
+    return 0;
+}
+
+//tracks a batch of async requests started from the CLI
+typedef struct {
+    SemaphoreP_Object doneSem; //posted once per finished request
+    uint32_t errors; //requests that came back with a bad status
+    int32_t sum; //sum of all results, printed so the run can be checked
+} PipeCtx;
 
-        //create variables for core id and endpoint
-        uint16_t SrcCore = CSL_CORE_ID_R5FSS0_1;
-        uint16_t SrcEndPt = gSubSendEndPt;
+/* This function is the completion callback for cmd_pipe.
+ * It runs on the dispatcher task.
+ */
+static void pipe_done(uint16_t reqId, int32_t status, int32_t result, void *arg)
+{
+    PipeCtx *ctx = (PipeCtx *)arg;
+    if(status != IPC_STATUS_OK)
+    {
+        ctx->errors++;
+    }
+    else
+    {
+        ctx->sum += result;
+    }
+    SemaphoreP_post(&ctx->doneSem);
+}
 
-        //wait for response
-        char recv_buf[64];
-        uint16_t recv_buf_size = sizeof(recv_buf);
-        int32_t status = RPMessage_recv(&gRecvObj, recv_buf, &recv_buf_size, &SrcCore, &SrcEndPt, SystemP_WAIT_FOREVER);
-        if(status == 0)
+/* This function keeps many requests in flight at once.
+ * Even requests go to R5F1 as SUB, odd requests go to the DSP as MUL.
+ */
+static int32_t cmd_pipe(int32_t argc, char* argv[])
+{
+    if(argc != 2) //make sure there are 2 parts of the argument
+    {
+        DebugP_log("Usage: PIPE N\r\n");
+        return -1;
+    }
+
+    int32_t count = atoi(argv[1]);
+    int32_t sent = 0;
+    int32_t finished = 0;
+    int32_t status = 0;
+    PipeCtx ctx;
+    if(count <= 0)
+    {
+        DebugP_log("Usage: PIPE N\r\n");
+        return -1;
+    }
+    ctx.errors = 0;
+    ctx.sum = 0;
+    SemaphoreP_constructCounting(&ctx.doneSem, 0, count);
+
+    while(sent < count)
+    {
+        if(sent & 1)
         {
-            DebugP_log("SUB result = %s\r\n", recv_buf);
+            status = offload_math_async(IPC_OP_MUL, sent, 2, CSL_CORE_ID_C66SS0, gDSPRecEndPt, pipe_done, &ctx, NULL);
         }
+        else
+        {
+            status = offload_math_async(IPC_OP_SUB, sent, 2, CSL_CORE_ID_R5FSS0_1, gSubRecEndPt, pipe_done, &ctx, NULL);
+        }
+
+        if(status == IPC_STATUS_BUSY)
+        {
+            if(sent > finished)
+            {
+                //table is full, wait for one of ours to free a slot and try again
+                SemaphoreP_pend(&ctx.doneSem, SystemP_WAIT_FOREVER);
+                finished++;
+            }
+            else
+            {
+                //table is full of other commands' requests, nothing of ours will post
+                vTaskDelay(1);
+            }
+            continue;
+        }
+        if(status != 0)
+        {
+            DebugP_log("PIPE send failed with status %d\r\n", status);
+            break;
+        }
+        sent++;
+    }
+
+    //wait for everything still in flight, ctx lives on this stack
+    while(finished < sent)
+    {
+        SemaphoreP_pend(&ctx.doneSem, SystemP_WAIT_FOREVER);
+        finished++;
+    }
+    SemaphoreP_destruct(&ctx.doneSem);
+
+    DebugP_log("PIPE sent %d, errors %u, sum = %d\r\n", sent, ctx.errors, ctx.sum);
+    return (status == IPC_STATUS_BUSY) ? 0 : status;
+}
+
+//largest batch the VEC command can fit in gIpcShm (x, y and out arrays)
+#define VEC_MAX_COUNT ((IPC_SHM_VEC_SIZE / (3U * sizeof(int32_t))) & ~1U)
+
+/* This function runs one batch of ADD, SUB or MUL.
+ * The scheduler decides which core does the work.
+ */
+static int32_t cmd_vec(int32_t argc, char* argv[])
+{
+    uint8_t opcode;
+
+    if(argc != 3) //make sure there are 3 parts of the argument
+    {
+        DebugP_log("Usage: VEC ADD|SUB|MUL N\r\n");
+        return -1;
+    }
+
+    if(strcmp(argv[1], "ADD") == 0)
+    {
+        opcode = IPC_OP_VEC_ADD;
+    }
+    else if(strcmp(argv[1], "SUB") == 0)
+    {
+        opcode = IPC_OP_VEC_SUB;
+    }
+    else if(strcmp(argv[1], "MUL") == 0)
+    {
+        opcode = IPC_OP_VEC_MUL;
     }
     else
     {
-        DebugP_log("Usage: SUB X Y\r\n");
+        DebugP_log("Usage: VEC ADD|SUB|MUL N\r\n");
         return -1;
     }
-    return 0;
+
+    int32_t count = atoi(argv[2]);
+    if(count <= 0 || count > (int32_t)VEC_MAX_COUNT)
+    {
+        DebugP_log("VEC count must be 1 to %u\r\n", (uint32_t)VEC_MAX_COUNT);
+        return -1;
+    }
+
+    //lay the three arrays out back to back in shared memory
+    int32_t *x = (int32_t *)&gIpcShm[IPC_SHM_VEC_OFFSET];
+    int32_t *y = x + VEC_MAX_COUNT;
+    int32_t *out = y + VEC_MAX_COUNT;
+    int32_t i;
+    for(i = 0; i < count; i++)
+    {
+        x[i] = i;
+        y[i] = 3 - i;
+    }
+
+    IpcMsg msg;
+    int32_t written = 0;
+    int32_t core = 0;
+    uint16_t size = ipc_msg_encode_vec(&msg, opcode, 0,
+                                       (uint32_t)((uint8_t *)x - gIpcShm),
+                                       (uint32_t)((uint8_t *)y - gIpcShm),
+                                       (uint32_t)((uint8_t *)out - gIpcShm), (uint32_t)count);
+    int32_t status = sched_run(&msg, size, &written, &core);
+    if(status == 0 && written != count)
+    {
+        status = IPC_STATUS_BAD_LENGTH;
+    }
+    if(status != 0)
+    {
+        DebugP_log("VEC failed with status %d\r\n", status);
+        return status;
+    }
+
+    //check the result against the same operation done here
+    int32_t errors = 0;
+    for(i = 0; i < count; i++)
+    {
+        int32_t expect = (opcode == IPC_OP_VEC_ADD) ? (x[i] + y[i]) :
+                         (opcode == IPC_OP_VEC_SUB) ? (x[i] - y[i]) : (x[i] * y[i]);
+        if(out[i] != expect)
+        {
+            errors++;
+        }
+    }
+    DebugP_log("VEC %s of %d elements done on %s, %d mismatches\r\n", argv[1], count, gSchedCoreName[core], errors);
+    return (errors == 0) ? 0 : -1;
 }
 
-/* This function handles multiplication.
- * It is run on the DSP core.
+//largest batch that fits in one ring slot (x, padding and y, results overwrite x)
+#define RING_MAX_COUNT ((IPC_RING_PAYLOAD_SIZE / (2U * sizeof(int32_t))) & ~1U)
+
+/* This function sends one MUL batch to the DSP through the shared memory ring.
+ * The operands are written straight into the ring slot and never copied.
  */
-static int32_t cmd_mul(int32_t argc, char* argv[])
+static int32_t cmd_ring(int32_t argc, char* argv[])
 {
-    if(argc == 3) //make sure there are 3 parts of the argument
+    if(argc != 2) //make sure there are 2 parts of the argument
     {
-        char buf[64];
-        uint16_t buf_size = sizeof(buf);
-        snprintf(buf, buf_size-1, "MUL %s %s", argv[1], argv[2]);
-        send_to_core(CSL_CORE_ID_C66SS0, gDSPRecEndPt, buf);
+        DebugP_log("Usage: RING N\r\n");
+        return -1;
+    }
 
-        //create variables for core id and endpoint
-        uint16_t SrcCore = CSL_CORE_ID_C66SS0;
-        uint16_t SrcEndPt = gDSPSendEndPt;
+    int32_t count = atoi(argv[1]);
+    if(count <= 0 || count > (int32_t)RING_MAX_COUNT)
+    {
+        DebugP_log("RING count must be 1 to %u\r\n", (uint32_t)RING_MAX_COUNT);
+        return -1;
+    }
 
-        //wait for response
-        char recv_buf[64];
-        uint16_t recv_buf_size = sizeof(recv_buf);
-        int32_t status = RPMessage_recv(&gRecvObj, recv_buf, &recv_buf_size, &SrcCore, &SrcEndPt, SystemP_WAIT_FOREVER);
-        if(status == 0)
+    IpcRingEntry *entry = ipc_ring_reserve(gRing);
+    if(entry == NULL)
+    {
+        DebugP_log("RING is full, DSP has not caught up\r\n");
+        return IPC_STATUS_BUSY;
+    }
+
+    //build the job in place
+    int32_t *x = (int32_t *)IPC_RING_PAYLOAD(entry);
+    int32_t *y = x + IPC_RING_VEC_Y_INDEX((uint32_t)count);
+    int32_t i;
+    entry->opcode = IPC_OP_VEC_MUL;
+    entry->reqId = 0;
+    entry->status = IPC_STATUS_OK;
+    entry->count = (uint32_t)count;
+    entry->len = IPC_RING_VEC_LEN((uint32_t)count);
+    for(i = 0; i < count; i++)
+    {
+        x[i] = i;
+        y[i] = 3 - i;
+    }
+
+    uint32_t seq;
+    int32_t status = ring_commit(&seq);
+    if(status != 0)
+    {
+        DebugP_log("RING doorbell failed with status %d\r\n", status);
+        return status;
+    }
+
+    //wait for the DSP to move tail past it (1 second max)
+    for(i = 0; i < 1000 && !ipc_ring_done(gRing, seq); i++)
+    {
+        vTaskDelay(1);
+    }
+    if(!ipc_ring_done(gRing, seq))
+    {
+        DebugP_log("RING timed out waiting for the DSP\r\n");
+        return -1;
+    }
+    if(entry->status != IPC_STATUS_OK)
+    {
+        DebugP_log("RING failed with status %d\r\n", entry->status);
+        return entry->status;
+    }
+
+    //results were written over x, y is untouched
+    int32_t errors = 0;
+    for(i = 0; i < count; i++)
+    {
+        if(x[i] != i * y[i])
         {
-            DebugP_log("MUL result = %s\r\n", recv_buf);
+            errors++;
         }
     }
-    else
+    DebugP_log("RING MUL of %d elements done, %d mismatches\r\n", count, errors);
+    return (errors == 0) ? 0 : -1;
+}
+
+/* ======================= IPC Benchmark ======================= */
+
+#define BENCH_DEFAULT_ITERATIONS (200U)
+#define BENCH_MAX_ITERATIONS (10000U)
+#define BENCH_RECV_TIMEOUT_US (10000U) //an echo this late counts as dropped
+
+//core the local benchmark transport talks to
+typedef struct {
+    uint16_t coreId;
+    uint16_t endPt;
+} BenchTarget;
+
+/* This function sends a benchmark message from the benchmark endpoint
+ */
+static int32_t bench_send(void *ctx, const void *buf, uint16_t len)
+{
+    BenchTarget *target = (BenchTarget *)ctx;
+    return RPMessage_send((void *)buf, len, target->coreId, target->endPt,
+                          gMainBenchEndPt, SystemP_WAIT_FOREVER);
+}
+
+/* This function waits for a benchmark echo
+ */
+static int32_t bench_recv(void *ctx, void *buf, uint16_t *len)
+{
+    uint16_t SrcCore, SrcEndPt;
+    return RPMessage_recv(&gBenchObj, buf, len, &SrcCore, &SrcEndPt,
+                          ClockP_usecToTicks(BENCH_RECV_TIMEOUT_US));
+}
+
+static uint32_t bench_cycles(void *ctx)
+{
+    return CycleCounterP_getCount32();
+}
+
+/* This function prints one core pair's results
+ */
+static void bench_print(const char *pair, const IpcBenchResult *res)
+{
+    uint32_t i, bin;
+    DebugP_log("%s:\r\n", pair);
+    DebugP_log("  bytes drops  rtt min/avg/p99/max (ns)        one-way avg/p99 (ns)  msgs/s   bytes/s\r\n");
+    for(i = 0; i < IPC_BENCH_NUM_SIZES; i++)
     {
-        DebugP_log("Usage: MUL X Y\r\n");
+        const IpcBenchSizeResult *sz = &res->size[i];
+        uint32_t rttAvg = (sz->rtt.count > 0) ? (uint32_t)(sz->rtt.sumNs / sz->rtt.count) : 0;
+        uint32_t owAvg = (sz->oneWay.count > 0) ? (uint32_t)(sz->oneWay.sumNs / sz->oneWay.count) : 0;
+        DebugP_log("  %5u %5u  %6u/%6u/%6u/%6u  %6u/%6u  %7u %9u\r\n",
+                   sz->msgBytes, sz->drops,
+                   sz->rtt.minNs, rttAvg, ipc_bench_percentile_us(&sz->rtt, 99U) * 1000U, sz->rtt.maxNs,
+                   owAvg, ipc_bench_percentile_us(&sz->oneWay, 99U) * 1000U,
+                   sz->msgsPerSec, sz->bytesPerSec);
+
+        //round trip histogram, bins below 1us, then doubling
+        DebugP_log("        rtt hist:");
+        for(bin = 0; bin < IPC_BENCH_HIST_BINS; bin++)
+        {
+            if(sz->rtt.hist[bin] > 0)
+            {
+                DebugP_log(" <%uus:%u", 1U << bin, sz->rtt.hist[bin]);
+            }
+        }
+        DebugP_log("\r\n");
+    }
+}
+
+/* This function runs the benchmark from R5F_0 to one core
+ */
+static void bench_local(const char *pair, uint16_t coreId, uint16_t endPt, uint32_t iterations)
+{
+    BenchTarget target = {coreId, endPt};
+    IpcBenchTransport t = {bench_send, bench_recv, bench_cycles, &target, IPC_BENCH_R5F_MHZ};
+    IpcBenchResult res;
+
+    res.srcCore = CSL_CORE_ID_R5FSS0_0;
+    res.dstCore = coreId;
+    ipc_bench_run(&t, iterations, &res);
+    bench_print(pair, &res);
+}
+
+/* This function measures latency and throughput between every pair of cores.
+ * R5F_1 to DSP runs on R5F_1 and leaves its result in shared memory.
+ */
+static int32_t cmd_bench(int32_t argc, char* argv[])
+{
+    uint32_t iterations = BENCH_DEFAULT_ITERATIONS;
+    if(argc > 2)
+    {
+        DebugP_log("Usage: BENCH [iterations]\r\n");
+        return -1;
+    }
+    if(argc == 2)
+    {
+        int32_t n = atoi(argv[1]);
+        if(n <= 0 || n > (int32_t)BENCH_MAX_ITERATIONS)
+        {
+            DebugP_log("BENCH iterations must be 1 to %u\r\n", BENCH_MAX_ITERATIONS);
+            return -1;
+        }
+        iterations = (uint32_t)n;
+    }
+
+    bench_local("R5F0 <-> R5F1", CSL_CORE_ID_R5FSS0_1, gSubRecEndPt, iterations);
+    bench_local("R5F0 <-> DSP", CSL_CORE_ID_C66SS0, gDSPRecEndPt, iterations);
+
+    IpcBenchResult *remote = (IpcBenchResult *)&gIpcShm[IPC_SHM_BENCH_OFFSET];
+    int32_t result;
+    remote->status = IPC_STATUS_BUSY;
+    int32_t status = offload_math(IPC_OP_BENCH_RUN, (int32_t)iterations, 0,
+                                  CSL_CORE_ID_R5FSS0_1, gSubRecEndPt, &result);
+    if(status != IPC_STATUS_OK)
+    {
+        DebugP_log("R5F1 <-> DSP benchmark request failed with status %d\r\n", status);
+        return -1;
+    }
+    if(remote->status != 0)
+    {
+        DebugP_log("R5F1 <-> DSP benchmark failed on R5F1 with status %d\r\n", remote->status);
         return -1;
     }
+    bench_print("R5F1 <-> DSP", remote);
     return 0;
 }
 
-/* 
- * This function handles the setting up the CLI commands
+/*
+ * R5F_0 command table. CLI_open sorts these together with the mmWave
+ * extension commands so each line is found with a binary search.
  */
-static int32_t cli_setup(CLI_Cfg cliCfg)
+static const CLI_CmdTableEntry gR5f0CmdTable[] =
 {
     /*-----BASIC TEST COMMANDS-----*/
-    //addition
-    cliCfg.tableEntry[0].cmd = "ADD";
-    cliCfg.tableEntry[0].helpString = "Add two integers";
-    cliCfg.tableEntry[0].cmdHandlerFxn = cmd_add;
-
-    //subtraction
-    cliCfg.tableEntry[1].cmd = "SUB";
-    cliCfg.tableEntry[1].helpString = "Subtract two integers";
-    cliCfg.tableEntry[1].cmdHandlerFxn = cmd_sub;
+    {"ADD",   "Add two integers",                                          cmd_add},
+    {"SUB",   "Subtract two integers",                                     cmd_sub},
+    {"MUL",   "Multiply two integers",                                     cmd_mul},
+    {"PIPE",  "Send N requests to R5F1 and DSP without waiting",           cmd_pipe},  //pipelined offload
+    {"VEC",   "Run ADD/SUB/MUL over N elements in one message",            cmd_vec},   //batched math over shared memory
+    {"RING",  "Send an N element MUL to the DSP through the shared ring",  cmd_ring},  //zero-copy ring to the DSP
+    {"SCHED", "Show per-core latency estimates and queues",                cmd_sched}, //scheduler state
+    {"BENCH", "Measure IPC latency and throughput between all cores",      cmd_bench}, //IPC latency and throughput
+};
+#define R5F0_NUM_CMDS (sizeof(gR5f0CmdTable) / sizeof(gR5f0CmdTable[0]))
 
-    //multiplication
-    cliCfg.tableEntry[2].cmd = "MUL";
-    cliCfg.tableEntry[2].helpString = "Multiply two integers";
-    cliCfg.tableEntry[2].cmdHandlerFxn = cmd_mul;
+/*
+ * This function handles the setting up the CLI commands
+ */
+static int32_t cli_setup(CLI_Cfg *cliCfg)
+{
+    uint32_t i;
 
+    //leave room for the help command CLI_open adds at the end
+    if(R5F0_NUM_CMDS >= CLI_MAX_CMD)
+    {
+        return -1;
+    }
+    for(i = 0; i < R5F0_NUM_CMDS; i++)
+    {
+        cliCfg->tableEntry[i] = gR5f0CmdTable[i];
+    }
     return 0;
 }
 
@@ -204,6 +1067,22 @@ void r5f0_main(void *args)
     createParams2.localEndPt = gMainSendEndPt;
     RPMessage_construct(&gMsgObj, &createParams2);
 
+    //benchmark echoes
+    RPMessage_CreateParams createParams3;
+    RPMessage_CreateParams_init(&createParams3);
+    createParams3.localEndPt = gMainBenchEndPt;
+    RPMessage_construct(&gBenchObj, &createParams3);
+    CycleCounterP_reset();
+
+    //start the dispatcher that owns gRecvObj
+    offload_init();
+
+    //empty the DSP ring before any doorbell can go out
+    ipc_ring_init(gRing);
+
+    //register the jobs the scheduler can place
+    sched_setup();
+
     //initiate CLI interface
     CLI_Cfg cliCfg = {0};
     cliCfg.cliUartHandle = gUartHandle[CONFIG_UART0]; //UART handle from sysconfig
@@ -211,7 +1090,10 @@ void r5f0_main(void *args)
     cliCfg.taskPriority = 3;
 
     //set up CLI commands
-    cli_setup(cliCfg);
+    if(cli_setup(&cliCfg) != 0)
+    {
+        DebugP_log("R5F0 command table does not fit in the CLI\r\n");
+    }
 
     /*-----OPEN CLI-----*/
     CLI_open(&cliCfg);
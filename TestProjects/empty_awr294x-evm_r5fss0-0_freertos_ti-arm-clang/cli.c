@@ -69,6 +69,25 @@ StackType_t gCliTskStack[CLI_TASK_STACK_SIZE] __attribute__((aligned(32)));
  * @brief   Global variable which tracks the CLI MCB
  */
 CLI_MCB     gCLI;
+
+/**
+ * @brief   Most commands the lookup table can hold: the application table
+ *          plus the mmWave extension table.
+ */
+#define CLI_MAX_LOOKUP_CMD          (CLI_MAX_CMD + 48U)
+
+/**
+ * @brief   Every registered command (application and mmWave extension)
+ *          sorted by name. Built once by @ref CLI_open and searched with
+ *          @ref CLI_findCommand instead of a strcmp over each table.
+ */
+static CLI_CmdTableEntry*   gCliLookup[CLI_MAX_LOOKUP_CMD];
+static uint32_t             gCliNumLookup = 0U;
+
+/**
+ * @brief   mmWave extension table, terminated by an entry without a handler.
+ */
+extern CLI_CmdTableEntry gCLIMMWaveExtensionTable[];
 // #define CLI_BYPASS
 #define MAX_RADAR_CMD               34
 char* radarCmdString[MAX_RADAR_CMD] =
@@ -144,6 +163,119 @@ static int32_t CLI_help (int32_t argc, char* argv[])
     }
     return 0;
 }
+/**
+ *  @b Description
+ *  @n
+ *      Adds a command to the sorted lookup table. Entries keep the order they
+ *      were added in when names are equal and only the first is kept, so an
+ *      application command overrides a mmWave extension command of the same name.
+ *
+ *  @param[in]  ptrEntry
+ *      Command to add
+ *
+ *  \ingroup CLI_UTIL_INTERNAL_FUNCTION
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t CLI_addLookup (CLI_CmdTableEntry* ptrEntry)
+{
+    uint32_t    pos;
+    int32_t     cmp = 1;
+
+    /* Find the first entry that sorts after this one: */
+    for (pos = gCliNumLookup; pos > 0U; pos--)
+    {
+        cmp = strcmp(gCliLookup[pos - 1U]->cmd, ptrEntry->cmd);
+        if (cmp <= 0)
+            break;
+    }
+
+    /* Duplicate name: the earlier registration wins */
+    if ((pos > 0U) && (cmp == 0))
+        return 0;
+
+    if (gCliNumLookup >= CLI_MAX_LOOKUP_CMD)
+        return -1;
+
+    memmove ((void *)&gCliLookup[pos + 1U], (void *)&gCliLookup[pos],
+             (gCliNumLookup - pos) * sizeof(CLI_CmdTableEntry*));
+    gCliLookup[pos] = ptrEntry;
+    gCliNumLookup++;
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Builds the sorted lookup table from the registered commands and,
+ *      when enabled, the mmWave extension commands.
+ *
+ *  \ingroup CLI_UTIL_INTERNAL_FUNCTION
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t CLI_buildLookup (void)
+{
+    CLI_CmdTableEntry*  ptrEntry;
+    uint32_t            index;
+
+    gCliNumLookup = 0U;
+    for (index = 0; index < gCLI.numCLICommands; index++)
+    {
+        if (CLI_addLookup (&gCLI.cfg.tableEntry[index]) < 0)
+            return -1;
+    }
+
+    if (gCLI.cfg.enableMMWaveExtension == 1U)
+    {
+        for (ptrEntry = &gCLIMMWaveExtensionTable[0]; ptrEntry->cmdHandlerFxn != NULL; ptrEntry++)
+        {
+            if (CLI_addLookup (ptrEntry) < 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Finds a command by name with a binary search of the lookup table.
+ *
+ *  @param[in]  cmd
+ *      Command name, the first token of the line
+ *
+ *  \ingroup CLI_UTIL_INTERNAL_FUNCTION
+ *
+ *  @retval
+ *      Matching command entry, or NULL if there is none
+ */
+static CLI_CmdTableEntry* CLI_findCommand (const char* cmd)
+{
+    uint32_t    low = 0U;
+    uint32_t    high = gCliNumLookup;
+
+    while (low < high)
+    {
+        uint32_t    mid = low + ((high - low) >> 1);
+        int32_t     cmp = strcmp(gCliLookup[mid]->cmd, cmd);
+
+        if (cmp == 0)
+            return gCliLookup[mid];
+        if (cmp < 0)
+            low = mid + 1U;
+        else
+            high = mid;
+    }
+    return NULL;
+}
+
 #ifdef CLI_BYPASS
 static int32_t CLI_ByPassApi(CLI_Cfg* ptrCLICfg)
 {
@@ -357,7 +489,6 @@ static void CLI_task(void* args)
     uint32_t                argIndex;
     CLI_CmdTableEntry*      ptrCLICommandEntry;
     int32_t                 cliStatus, status;
-    uint32_t                index;
 
     /* Do we have a banner to be displayed? */
     if (gCLI.cfg.cliBanner != NULL)
@@ -417,45 +548,26 @@ static void CLI_task(void* args)
         if (argIndex == 0)
             continue;
 
-        /* Cycle through all the registered CLI commands: */
-        for (index = 0; index < gCLI.numCLICommands; index++)
-        {
-            ptrCLICommandEntry = &gCLI.cfg.tableEntry[index];
-
-            /* Do we have a match? */
-            if (strcmp(ptrCLICommandEntry->cmd, tokenizedArgs[0]) == 0)
-            {
-                /* YES: Pass this to the CLI registered function */
-                cliStatus = ptrCLICommandEntry->cmdHandlerFxn (argIndex, tokenizedArgs);
-                if (cliStatus == 0)
-                {
-                    CLI_write ("Done\r\n");
-                }
-                else
-                {
-                    CLI_write ("Error %d\r\n", cliStatus);
-                }
-                break;
-            }
-        }
-
-        /* Did we get a matching CLI command? */
-        if (index == gCLI.numCLICommands)
+        /* Find the command among the application and mmWave extension commands: */
+        ptrCLICommandEntry = CLI_findCommand (tokenizedArgs[0]);
+        if (ptrCLICommandEntry != NULL)
         {
-            /* NO matching command found. Is the mmWave extension enabled? */
-            if (gCLI.cfg.enableMMWaveExtension == 1U)
+            /* YES: Pass this to the CLI registered function */
+            cliStatus = ptrCLICommandEntry->cmdHandlerFxn (argIndex, tokenizedArgs);
+            if (cliStatus == 0)
             {
-                /* Yes: Pass this to the mmWave extension handler */
-                cliStatus = CLI_MMWaveExtensionHandler (argIndex, tokenizedArgs);
+                CLI_write ("Done\r\n");
             }
-
-            /* Was the CLI command found? */
-            if (cliStatus == -1)
+            else
             {
-                /* No: The command was still not found */
-                CLI_write ("'%s' is not recognized as a CLI command\r\n", tokenizedArgs[0]);
+                CLI_write ("Error %d\r\n", cliStatus);
             }
         }
+        else
+        {
+            /* No: The command was not found */
+            CLI_write ("'%s' is not recognized as a CLI command\r\n", tokenizedArgs[0]);
+        }
     }
     #else
 
@@ -571,6 +683,10 @@ int32_t CLI_open (CLI_Cfg* ptrCLICfg)
     /* Increment the number of CLI commands: */
     gCLI.numCLICommands++;
 
+    /* Sort every command once so the CLI task can binary search them: */
+    if (CLI_buildLookup () < 0)
+        return -1;
+
     gCliTask = xTaskCreateStatic( CLI_task,   /* Pointer to the function that implements the task. */
                                   "cli_task_main", /* Text name for the task.  This is to facilitate debugging only. */
                                   CLI_TASK_STACK_SIZE,  /* Stack depth in units of StackType_t typically uint32_t on 32b CPUs */
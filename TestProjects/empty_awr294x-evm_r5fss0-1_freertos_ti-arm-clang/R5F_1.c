@@ -36,13 +36,18 @@
 #include "ti_drivers_open_close.h"
 #include "ti_board_open_close.h"
 #include <drivers/ipc_rpmsg.h> //needed for shared memory
-#include <stdlib.h> //needed for sscanf
 #include <string.h> //needed for string operations
+#include <kernel/dpl/CycleCounterP.h> //timestamps for the IPC benchmark
+#include <kernel/dpl/ClockP.h>
 #include <C:\Users\there\Documents\Capstone\RadarFirmware\enums.h> //my custom universal values
+#include <C:\Users\there\Documents\Capstone\RadarFirmware\ipc_bench.h> //IPC benchmark harness
 
 //RPMessage objects
 static RPMessage_Object gMsgObj;
 static RPMessage_Object gRecvObj;
+static RPMessage_Object gBenchObj; //receives the DSP's benchmark echoes
+
+#define BENCH_RECV_TIMEOUT_US (10000U) //an echo this late counts as dropped
 
 /* This function is the UART callback function
  */
@@ -53,14 +58,54 @@ static void uart_callback()
 
 /* This function sends commands to the correct cores to offload tasks
  */
-static void send_to_core(uint16_t RemoteCoreID, uint16_t RemoteEndPt, char buf[64])
+static void send_to_core(uint16_t RemoteCoreID, uint16_t RemoteEndPt, IpcMsg *msg, uint16_t size)
 {
-    uint16_t size = strlen(buf) + 1; //add 1 to account for terminating character
-    RPMessage_send( buf, size,
+    RPMessage_send( msg, size,
                     RemoteCoreID, RemoteEndPt,
                     gSubSendEndPt, SystemP_WAIT_FOREVER);
 }
 
+/* This function sends a benchmark message to the DSP
+ */
+static int32_t bench_send(void *ctx, const void *buf, uint16_t len)
+{
+    return RPMessage_send((void *)buf, len, CSL_CORE_ID_C66SS0, gDSPRecEndPt,
+                          gSubBenchEndPt, SystemP_WAIT_FOREVER);
+}
+
+/* This function waits for the DSP to echo a benchmark message back
+ */
+static int32_t bench_recv(void *ctx, void *buf, uint16_t *len)
+{
+    uint16_t SrcCore, SrcEndPt;
+    return RPMessage_recv(&gBenchObj, buf, len, &SrcCore, &SrcEndPt,
+                          ClockP_usecToTicks(BENCH_RECV_TIMEOUT_US));
+}
+
+static uint32_t bench_cycles(void *ctx)
+{
+    return CycleCounterP_getCount32();
+}
+
+/* This function runs the IPC benchmark against the DSP for R5F_0 and leaves
+ * the result in the shared memory benchmark area.
+ */
+static int16_t run_bench(uint32_t iterations)
+{
+    IpcBenchResult *res = (IpcBenchResult *)IPC_SHM_PTR(IPC_SHM_BENCH_OFFSET);
+    IpcBenchTransport t = {bench_send, bench_recv, bench_cycles, NULL, IPC_BENCH_R5F_MHZ};
+
+    if(iterations == 0)
+    {
+        return IPC_STATUS_BAD_LENGTH;
+    }
+    res->srcCore = CSL_CORE_ID_R5FSS0_1;
+    res->dstCore = CSL_CORE_ID_C66SS0;
+    res->status = IPC_STATUS_BUSY;
+    ipc_bench_run(&t, iterations, res);
+    return IPC_STATUS_OK;
+}
+
 /*
  * This does the subtraction operation on the data sent by the main core.
  */
@@ -70,8 +115,9 @@ void r5f1_main(void *args)
     Drivers_open();
     Board_driversOpen();
 
-    char buf[64];
+    uint8_t buf[IPC_MSG_MAX_SIZE];
     uint16_t buf_size;
+    IpcMsg req, reply;
 
     //setup
     RPMessage_CreateParams createParams;
@@ -85,6 +131,14 @@ void r5f1_main(void *args)
     createParams2.localEndPt = gSubSendEndPt;
     RPMessage_construct(&gMsgObj, &createParams2);
 
+    //benchmark echoes from the DSP
+    RPMessage_CreateParams createParams3;
+    RPMessage_CreateParams_init(&createParams3);
+    createParams3.localEndPt = gSubBenchEndPt;
+    RPMessage_construct(&gBenchObj, &createParams3);
+
+    CycleCounterP_reset(); //start the benchmark timestamps
+
     while(1)
     {
         buf_size = sizeof(buf);
@@ -92,18 +146,39 @@ void r5f1_main(void *args)
         uint16_t SrcEndPt = gMainSendEndPt;
         int32_t status = RPMessage_recv(&gRecvObj, buf, &buf_size, &SrcCore, &SrcEndPt, SystemP_WAIT_FOREVER);
 
-        if(status == 0) //if a message is actually received
+        uint32_t rxCycles = CycleCounterP_getCount32();
+
+        //benchmark echoes go straight back to whoever sent them
+        if(status == 0 && ipc_bench_echo(buf, buf_size, CycleCounterP_getCount32() - rxCycles, IPC_BENCH_R5F_MHZ))
+        {
+            RPMessage_send(buf, buf_size, SrcCore, SrcEndPt, gSubSendEndPt, SystemP_WAIT_FOREVER);
+        }
+        else if(status == 0) //if a message is actually received
         {
-            DebugP_log("R5F1 got message: '%s' len=%u from core=%u ep=%u\r\n", buf, buf_size, SrcCore, SrcEndPt);
-            int x, y;
-            sscanf(buf, "SUB %d %d", &x, &y); //get numbers
-            int result = x - y; //calculate
-            snprintf(buf, sizeof(buf)-1, "%d", result);
+            uint16_t reply_size;
+            int16_t msg_status = ipc_msg_decode(buf, buf_size, &req);
+            if(msg_status == IPC_STATUS_OK && ipc_opcode_is_vec(req.hdr.opcode))
+            {
+                reply_size = ipc_msg_handle_vec(&req, &reply, ipc_vec_run); //whole batch from shared memory
+            }
+            else if(msg_status == IPC_STATUS_OK && req.hdr.opcode == IPC_OP_BENCH_RUN)
+            {
+                int16_t bench_status = run_bench((uint32_t)req.payload.math.x); //blocks until the DSP run is done
+                reply_size = ipc_msg_encode_result(&reply, &req.hdr, bench_status, 0);
+            }
+            else if(msg_status == IPC_STATUS_OK)
+            {
+                reply_size = ipc_msg_handle_math(&req, &reply); //calculate
+            }
+            else
+            {
+                reply_size = ipc_msg_encode_result(&reply, &req.hdr, msg_status, 0);
+            }
 
-            DebugP_log("R5F1 sending reply: %s\r\n", buf);
+            DebugP_log("R5F1 op=%u id=%u status=%d result=%d\r\n", req.hdr.opcode, req.hdr.reqId, reply.hdr.status, reply.payload.result);
 
             //send result
-            send_to_core(SrcCore, gMainRecEndPt, buf);
+            send_to_core(SrcCore, gMainRecEndPt, &reply, reply_size);
         }
     }
 
@@ -1,6 +1,9 @@
 #ifndef ENUMS_H //makes sure it doesn't get repeatedly defined by multiple files
 #define ENUMS_H
 
+#include <stdint.h> //needed for fixed width message fields
+#include <string.h> //needed for memcpy
+
 //enum for endpoints
 enum ipc_end_pt
 {
@@ -10,7 +13,442 @@ enum ipc_end_pt
     gSubSendEndPt = 5U, //R5F_1
     gSubRecEndPt = 6U, //R5F_0
     gDSPSendEndPt = 7U, //DSP
-    gDSPRecEndPt = 8U //DSP
+    gDSPRecEndPt = 8U, //DSP
+
+    /*BENCHMARK ENDPOINTS*/
+    gMainBenchEndPt = 9U, //R5F_0, echoes come back here during BENCH
+    gSubBenchEndPt = 10U //R5F_1, echoes come back here during BENCH
 };
 
+/* ======================= Binary IPC Messages ======================= */
+/*
+ * Every command sent between R5F_0, R5F_1 and the DSP uses this fixed layout
+ * instead of a text string. All three cores are little endian and the fields
+ * are naturally aligned, so the struct can be copied straight into and out of
+ * the RPMessage buffer without any text formatting or parsing.
+ */
+
+//bump this whenever the layout of IpcMsg changes
+#define IPC_MSG_VERSION (1U)
+
+//largest message the vring will carry (matches the old 64 byte string buffers)
+#define IPC_MSG_MAX_SIZE (64U)
+
+//enum for command opcodes
+enum ipc_opcode
+{
+    IPC_OP_ADD = 1U, //x + y
+    IPC_OP_SUB = 2U, //x - y
+    IPC_OP_MUL = 3U, //x * y
+    IPC_OP_VEC_ADD = 0x11U, //x[i] + y[i] over a batch in shared memory
+    IPC_OP_VEC_SUB = 0x12U, //x[i] - y[i] over a batch in shared memory
+    IPC_OP_VEC_MUL = 0x13U, //x[i] * y[i] over a batch in shared memory
+    IPC_OP_RING_DOORBELL = 0x20U, //new entries are waiting in the shared memory ring, no reply
+    IPC_OP_BENCH_ECHO = 0x30U, //send the message straight back to its source endpoint (see ipc_bench.h)
+    IPC_OP_BENCH_RUN = 0x31U, //R5F_1 only, benchmark against the DSP, x = iterations
+    IPC_OP_RESULT = 0x80U //reply carrying a result, or'd with the request opcode
+};
+
+//enum for message status codes (0 is SUCCESS like everywhere else)
+enum ipc_status
+{
+    IPC_STATUS_OK = 0,
+    IPC_STATUS_BAD_VERSION = -1, //sender uses a different IPC_MSG_VERSION
+    IPC_STATUS_BAD_OPCODE = -2, //receiver does not handle this opcode
+    IPC_STATUS_BAD_LENGTH = -3, //message is shorter than its header says
+    IPC_STATUS_BUSY = -4 //sender already has too many requests outstanding
+};
+
+//header at the start of every message (8 bytes)
+typedef struct {
+    uint8_t version; //IPC_MSG_VERSION
+    uint8_t opcode; //enum ipc_opcode
+    uint16_t reqId; //echoed back in the reply so it can be matched to the request
+    int16_t status; //enum ipc_status, only meaningful in replies
+    uint16_t payloadLen; //number of payload bytes after the header
+} IpcMsgHeader;
+
+//operands for the two-number math commands
+typedef struct {
+    int32_t x; //first number
+    int32_t y; //second number
+} IpcMathArgs;
+
+//describes a batch of operands in USER_SHM_MEM
+//offsets are from the start of the region so every core can find them
+typedef struct {
+    uint32_t xOffset; //first array of int32_t
+    uint32_t yOffset; //second array of int32_t
+    uint32_t outOffset; //results are written here
+    uint32_t count; //number of elements in each array
+} IpcVecArgs;
+
+//full message as it sits in the RPMessage buffer
+typedef struct {
+    IpcMsgHeader hdr;
+    union {
+        IpcMathArgs math; //request payload
+        IpcVecArgs vec; //batch request payload
+        uint32_t ringHead; //doorbell payload, producer index after the last commit
+        int32_t result; //reply payload (element count for batches)
+    } payload;
+} IpcMsg;
+
+/* ======================= Shared Memory Batches ======================= */
+/*
+ * A single message only carries two operands, so batches are passed by
+ * reference instead. R5F_0 owns USER_SHM_MEM (16KB, see linker.cmd) and
+ * fills it with the operand arrays, then sends one IpcVecArgs message.
+ * The region is mapped at a different address on the DSP, so messages
+ * only ever carry offsets and each core adds its own base.
+ *
+ * The first half holds batch arrays, the second half holds the ring below
+ * and a small area for benchmark results.
+ */
+#if defined(_TMS320C6X)
+#define IPC_SHM_BASE (0xC02E8000U) //USER_SHM_MEM as seen by the DSP
+#else
+#define IPC_SHM_BASE (0x102E8000U) //USER_SHM_MEM as seen by the R5Fs
+#endif
+#define IPC_SHM_SIZE (0x4000U)
+
+//how USER_SHM_MEM is split up
+#define IPC_SHM_VEC_OFFSET (0x0000U) //batch arrays for IpcVecArgs
+#define IPC_SHM_VEC_SIZE (0x2000U)
+#define IPC_SHM_RING_OFFSET (0x2000U) //IpcRing
+#define IPC_SHM_RING_SIZE (0x1D00U)
+#define IPC_SHM_BENCH_OFFSET (0x3D00U) //IpcBenchResult from R5F_1
+#define IPC_SHM_BENCH_SIZE (0x0300U)
+
+//turns a shared memory offset into a pointer on this core
+#define IPC_SHM_PTR(offset) ((void *)(uintptr_t)(IPC_SHM_BASE + (uint32_t)(offset)))
+
+//runs one batch on the local core, lets the DSP plug in its SIMD version
+typedef int16_t (*IpcVecFxn)(uint8_t opcode, const int32_t *x, const int32_t *y, int32_t *out, uint32_t count);
+
+/* This function fills in a message header
+ */
+static inline void ipc_msg_set_header(IpcMsg *msg, uint8_t opcode, uint16_t reqId, int16_t status, uint16_t payloadLen)
+{
+    msg->hdr.version = IPC_MSG_VERSION;
+    msg->hdr.opcode = opcode;
+    msg->hdr.reqId = reqId;
+    msg->hdr.status = status;
+    msg->hdr.payloadLen = payloadLen;
+}
+
+/* This function builds a two-number math request.
+ * It returns the number of bytes to send.
+ */
+static inline uint16_t ipc_msg_encode_math(IpcMsg *msg, uint8_t opcode, uint16_t reqId, int32_t x, int32_t y)
+{
+    ipc_msg_set_header(msg, opcode, reqId, IPC_STATUS_OK, sizeof(IpcMathArgs));
+    msg->payload.math.x = x;
+    msg->payload.math.y = y;
+    return sizeof(IpcMsgHeader) + sizeof(IpcMathArgs);
+}
+
+/* This function builds a batch request for arrays already in shared memory.
+ * It returns the number of bytes to send.
+ */
+static inline uint16_t ipc_msg_encode_vec(IpcMsg *msg, uint8_t opcode, uint16_t reqId,
+                                          uint32_t xOffset, uint32_t yOffset, uint32_t outOffset, uint32_t count)
+{
+    ipc_msg_set_header(msg, opcode, reqId, IPC_STATUS_OK, sizeof(IpcVecArgs));
+    msg->payload.vec.xOffset = xOffset;
+    msg->payload.vec.yOffset = yOffset;
+    msg->payload.vec.outOffset = outOffset;
+    msg->payload.vec.count = count;
+    return sizeof(IpcMsgHeader) + sizeof(IpcVecArgs);
+}
+
+/* This function builds a ring doorbell. The consumer does not reply to it.
+ * It returns the number of bytes to send.
+ */
+static inline uint16_t ipc_msg_encode_doorbell(IpcMsg *msg, uint32_t head)
+{
+    ipc_msg_set_header(msg, IPC_OP_RING_DOORBELL, 0, IPC_STATUS_OK, sizeof(uint32_t));
+    msg->payload.ringHead = head;
+    return sizeof(IpcMsgHeader) + sizeof(uint32_t);
+}
+
+/* This function builds the reply to a request.
+ * It returns the number of bytes to send.
+ */
+static inline uint16_t ipc_msg_encode_result(IpcMsg *msg, const IpcMsgHeader *req, int16_t status, int32_t result)
+{
+    ipc_msg_set_header(msg, req->opcode | IPC_OP_RESULT, req->reqId, status, sizeof(int32_t));
+    msg->payload.result = result;
+    return sizeof(IpcMsgHeader) + sizeof(int32_t);
+}
+
+/* This function checks a received buffer and copies it into msg.
+ * It returns IPC_STATUS_OK or the reason the message was rejected.
+ */
+static inline int16_t ipc_msg_decode(const void *buf, uint16_t len, IpcMsg *msg)
+{
+    if(len < sizeof(IpcMsgHeader))
+    {
+        memset(&msg->hdr, 0, sizeof(IpcMsgHeader)); //so a reply can still be built from it
+        return IPC_STATUS_BAD_LENGTH;
+    }
+    memcpy(&msg->hdr, buf, sizeof(IpcMsgHeader));
+    if(msg->hdr.version != IPC_MSG_VERSION)
+    {
+        return IPC_STATUS_BAD_VERSION;
+    }
+    if((msg->hdr.payloadLen > sizeof(msg->payload)) || (len < sizeof(IpcMsgHeader) + msg->hdr.payloadLen))
+    {
+        return IPC_STATUS_BAD_LENGTH;
+    }
+    memcpy(&msg->payload, (const uint8_t *)buf + sizeof(IpcMsgHeader), msg->hdr.payloadLen);
+    return IPC_STATUS_OK;
+}
+
+/* This function runs a two-number math request and fills in the reply.
+ * It is shared so every core computes the same thing for the same opcode.
+ * It returns the number of bytes to send back.
+ */
+static inline uint16_t ipc_msg_handle_math(const IpcMsg *req, IpcMsg *reply)
+{
+    int32_t result = 0;
+    int16_t status = IPC_STATUS_OK;
+
+    if(req->hdr.payloadLen != sizeof(IpcMathArgs))
+    {
+        status = IPC_STATUS_BAD_LENGTH;
+    }
+    else if(req->hdr.opcode == IPC_OP_ADD)
+    {
+        result = req->payload.math.x + req->payload.math.y;
+    }
+    else if(req->hdr.opcode == IPC_OP_SUB)
+    {
+        result = req->payload.math.x - req->payload.math.y;
+    }
+    else if(req->hdr.opcode == IPC_OP_MUL)
+    {
+        result = req->payload.math.x * req->payload.math.y;
+    }
+    else
+    {
+        status = IPC_STATUS_BAD_OPCODE;
+    }
+    return ipc_msg_encode_result(reply, &req->hdr, status, result);
+}
+
+/* This function checks one array of a batch fits inside shared memory
+ * and is 8 byte aligned so it can be loaded two elements at a time.
+ */
+static inline int ipc_vec_range_ok(uint32_t offset, uint32_t count)
+{
+    uint32_t rel = offset - IPC_SHM_VEC_OFFSET; //wraps to huge if below the area
+    return ((offset & 7U) == 0) && (rel < IPC_SHM_VEC_SIZE) &&
+           (count <= (IPC_SHM_VEC_SIZE - rel) / sizeof(int32_t));
+}
+
+/* This function is the plain C version of a batch operation.
+ * R5F_1 uses it directly, the DSP has its own SIMD version.
+ */
+static inline int16_t ipc_vec_run(uint8_t opcode, const int32_t *x, const int32_t *y, int32_t *out, uint32_t count)
+{
+    uint32_t i;
+    if(opcode == IPC_OP_VEC_ADD)
+    {
+        for(i = 0; i < count; i++)
+        {
+            out[i] = x[i] + y[i];
+        }
+    }
+    else if(opcode == IPC_OP_VEC_SUB)
+    {
+        for(i = 0; i < count; i++)
+        {
+            out[i] = x[i] - y[i];
+        }
+    }
+    else if(opcode == IPC_OP_VEC_MUL)
+    {
+        for(i = 0; i < count; i++)
+        {
+            out[i] = x[i] * y[i];
+        }
+    }
+    else
+    {
+        return IPC_STATUS_BAD_OPCODE;
+    }
+    return IPC_STATUS_OK;
+}
+
+/* This function checks a batch request, runs it with run() and fills in
+ * the reply. The reply result is the number of elements written.
+ * It returns the number of bytes to send back.
+ */
+static inline uint16_t ipc_msg_handle_vec(const IpcMsg *req, IpcMsg *reply, IpcVecFxn run)
+{
+    const IpcVecArgs *vec = &req->payload.vec;
+    int16_t status;
+
+    if(req->hdr.payloadLen != sizeof(IpcVecArgs) ||
+       !ipc_vec_range_ok(vec->xOffset, vec->count) ||
+       !ipc_vec_range_ok(vec->yOffset, vec->count) ||
+       !ipc_vec_range_ok(vec->outOffset, vec->count))
+    {
+        return ipc_msg_encode_result(reply, &req->hdr, IPC_STATUS_BAD_LENGTH, 0);
+    }
+
+    status = run(req->hdr.opcode,
+                 (const int32_t *)IPC_SHM_PTR(vec->xOffset),
+                 (const int32_t *)IPC_SHM_PTR(vec->yOffset),
+                 (int32_t *)IPC_SHM_PTR(vec->outOffset),
+                 vec->count);
+    return ipc_msg_encode_result(reply, &req->hdr, status, (status == IPC_STATUS_OK) ? (int32_t)vec->count : 0);
+}
+
+/* This function says whether an opcode is a shared memory batch
+ */
+static inline int ipc_opcode_is_vec(uint8_t opcode)
+{
+    return (opcode & 0xF0U) == 0x10U;
+}
+
+/* ======================= Shared Memory Ring ======================= */
+/*
+ * Single producer (R5F_0) / single consumer (DSP) ring for bulk payloads.
+ * The producer builds each entry directly in its slot, bumps head and
+ * sends a one-way IPC_OP_RING_DOORBELL. The consumer works on the entry
+ * in place and bumps tail. Nothing is copied through the vring and no
+ * lock is needed because each index only has one writer.
+ *
+ * An entry is finished once tail has moved past it. Its slot (and any
+ * results written into it) stays untouched until the producer wraps
+ * around and reserves it again.
+ */
+#define IPC_RING_LINE (128U) //C66x L2 cache line, keeps each index in its own line
+#define IPC_RING_SLOTS (8U) //must be a power of 2
+#define IPC_RING_SLOT_SIZE (896U) //multiple of IPC_RING_LINE
+
+//header at the start of every ring slot (16 bytes so the payload stays 8 byte aligned)
+typedef struct {
+    uint8_t opcode; //enum ipc_opcode, says what the payload is
+    uint8_t rsvd;
+    uint16_t reqId; //free for the producer to tag entries
+    int16_t status; //enum ipc_status, written by the consumer
+    uint16_t rsvd2;
+    uint32_t len; //payload bytes after this header
+    uint32_t count; //element count for batch opcodes
+} IpcRingEntry;
+
+#define IPC_RING_PAYLOAD_SIZE (IPC_RING_SLOT_SIZE - sizeof(IpcRingEntry))
+#define IPC_RING_PAYLOAD(entry) ((void *)((IpcRingEntry *)(entry) + 1))
+
+//batch payloads are x then y, y starts at the next even element so it stays 8 byte aligned for the DSP
+#define IPC_RING_VEC_Y_INDEX(count) (((count) + 1U) & ~1U)
+#define IPC_RING_VEC_LEN(count) ((IPC_RING_VEC_Y_INDEX(count) + (count)) * sizeof(int32_t))
+
+typedef struct {
+    volatile uint32_t head; //next entry to fill, only written by the producer
+    uint8_t pad0[IPC_RING_LINE - sizeof(uint32_t)];
+    volatile uint32_t tail; //next entry to consume, only written by the consumer
+    uint8_t pad1[IPC_RING_LINE - sizeof(uint32_t)];
+    uint8_t slots[IPC_RING_SLOTS][IPC_RING_SLOT_SIZE];
+} IpcRing;
+
+//the ring as seen from this core
+#define IPC_RING_PTR() ((IpcRing *)IPC_SHM_PTR(IPC_SHM_RING_OFFSET))
+
+/*
+ * The R5Fs map USER_SHM_MEM non-cached, so they only need a barrier.
+ * The DSP may cache it, so it invalidates before reading shared fields
+ * and writes back after changing them.
+ */
+#if defined(_TMS320C6X)
+#include <kernel/dpl/CacheP.h>
+#define IPC_RING_SYNC_IN(ptr, size) CacheP_inv((void *)(ptr), (size), CacheP_TYPE_ALL)
+#define IPC_RING_SYNC_OUT(ptr, size) CacheP_wbInv((void *)(ptr), (size), CacheP_TYPE_ALL)
+#define IPC_RING_BARRIER() _mfence()
+#elif defined(__ARM_ARCH)
+#define IPC_RING_SYNC_IN(ptr, size)
+#define IPC_RING_SYNC_OUT(ptr, size)
+#define IPC_RING_BARRIER() __asm__ __volatile__("dmb" ::: "memory")
+#else
+#define IPC_RING_SYNC_IN(ptr, size)
+#define IPC_RING_SYNC_OUT(ptr, size)
+#define IPC_RING_BARRIER() __sync_synchronize()
+#endif
+
+/* This function empties the ring. Only the producer calls it, before any doorbell.
+ */
+static inline void ipc_ring_init(IpcRing *ring)
+{
+    ring->head = 0;
+    ring->tail = 0;
+    IPC_RING_BARRIER();
+    IPC_RING_SYNC_OUT(ring, 2U * IPC_RING_LINE);
+}
+
+/* This function returns the next free slot for the producer to fill,
+ * or NULL if the consumer has not caught up yet.
+ */
+static inline IpcRingEntry *ipc_ring_reserve(IpcRing *ring)
+{
+    IPC_RING_SYNC_IN(&ring->tail, IPC_RING_LINE);
+    uint32_t head = ring->head;
+    if((head - ring->tail) >= IPC_RING_SLOTS)
+    {
+        return NULL;
+    }
+    return (IpcRingEntry *)ring->slots[head & (IPC_RING_SLOTS - 1U)];
+}
+
+/* This function publishes the slot from ipc_ring_reserve.
+ * It returns the new head to put in the doorbell.
+ */
+static inline uint32_t ipc_ring_commit(IpcRing *ring)
+{
+    uint32_t head = ring->head;
+    IPC_RING_SYNC_OUT(ring->slots[head & (IPC_RING_SLOTS - 1U)], IPC_RING_SLOT_SIZE);
+    IPC_RING_BARRIER(); //entry must land before the new head does
+    ring->head = head + 1U;
+    IPC_RING_SYNC_OUT(&ring->head, IPC_RING_LINE);
+    return head + 1U;
+}
+
+/* This function returns the oldest unconsumed entry, or NULL if the ring is empty.
+ */
+static inline IpcRingEntry *ipc_ring_peek(IpcRing *ring)
+{
+    IPC_RING_SYNC_IN(&ring->head, IPC_RING_LINE);
+    uint32_t tail = ring->tail;
+    if(tail == ring->head)
+    {
+        return NULL;
+    }
+    IPC_RING_BARRIER(); //read head before the entry it covers
+    IpcRingEntry *entry = (IpcRingEntry *)ring->slots[tail & (IPC_RING_SLOTS - 1U)];
+    IPC_RING_SYNC_IN(entry, IPC_RING_SLOT_SIZE);
+    return entry;
+}
+
+/* This function hands the entry from ipc_ring_peek back to the producer.
+ */
+static inline void ipc_ring_release(IpcRing *ring)
+{
+    uint32_t tail = ring->tail;
+    IPC_RING_SYNC_OUT(ring->slots[tail & (IPC_RING_SLOTS - 1U)], IPC_RING_SLOT_SIZE);
+    IPC_RING_BARRIER(); //results must land before the new tail does
+    ring->tail = tail + 1U;
+    IPC_RING_SYNC_OUT(&ring->tail, IPC_RING_LINE);
+}
+
+/* This function says whether the entry committed as sequence number seq
+ * (the value ipc_ring_commit returned minus one) has been consumed.
+ */
+static inline int ipc_ring_done(IpcRing *ring, uint32_t seq)
+{
+    IPC_RING_SYNC_IN(&ring->tail, IPC_RING_LINE);
+    return (int32_t)(ring->tail - seq) > 0;
+}
+
 #endif
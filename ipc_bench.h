@@ -0,0 +1,316 @@
+#ifndef IPC_BENCH_H //makes sure it doesn't get repeatedly defined by multiple files
+#define IPC_BENCH_H
+
+#include <stdint.h> //needed for fixed width fields
+#include <string.h> //needed for memcpy
+#include "enums.h" //message header and opcodes
+
+/* ======================= IPC Benchmark ======================= */
+/*
+ * Measures the firmware's own RPMessage path between two cores. The
+ * initiating core sends IPC_OP_BENCH_ECHO messages and the other core
+ * sends each one straight back, adding how many of its own cycles it
+ * held on to the message.
+ *
+ *  - round trip: CycleCounterP from just before send to just after recv
+ *  - one way: (round trip - remote turnaround) / 2, since the two cores
+ *    do not share a clock this is the closest honest estimate
+ *  - throughput: IPC_BENCH_WINDOW echoes kept in flight for the whole run
+ *
+ * Everything here works through IpcBenchTransport, so the same code runs
+ * on the board with RPMessage and on the PC with HostTools/ipc_bench_host.c.
+ */
+
+//CPU clocks, used to turn cycle counts into time
+#define IPC_BENCH_R5F_MHZ (300U)
+#define IPC_BENCH_DSP_MHZ (360U)
+
+#define IPC_BENCH_HIST_BINS (16U) //bin 0 is under 1us, bin i is [2^(i-1), 2^i) us
+#define IPC_BENCH_NUM_SIZES (3U)
+#define IPC_BENCH_SIZE(i) (24U + 12U * (i)) //24, 36 and 48 byte messages, all fit the 64 byte vring buffers
+#define IPC_BENCH_MAX_SIZE IPC_BENCH_SIZE(IPC_BENCH_NUM_SIZES - 1U)
+#define IPC_BENCH_WINDOW (4U) //echoes in flight during the throughput run
+
+//how the harness talks to the other core
+typedef struct {
+    int32_t (*send)(void *ctx, const void *buf, uint16_t len); //0 on success
+    int32_t (*recv)(void *ctx, void *buf, uint16_t *len); //0 on success, anything else is a timeout
+    uint32_t (*cycles)(void *ctx); //free running 32 bit cycle counter
+    void *ctx;
+    uint32_t localMHz; //clock of the cycle counter
+} IpcBenchTransport;
+
+//payload of every benchmark message, the rest up to the message size is filler
+typedef struct {
+    uint32_t seq; //matches echoes to sends
+    uint32_t turnaroundCycles; //filled in by the echoing core
+    uint32_t echoMHz; //clock of the echoing core
+} IpcBenchEcho;
+
+//latency distribution
+typedef struct {
+    uint32_t count;
+    uint32_t minNs;
+    uint32_t maxNs;
+    uint64_t sumNs;
+    uint32_t hist[IPC_BENCH_HIST_BINS];
+} IpcBenchStats;
+
+//everything measured for one message size
+typedef struct {
+    uint16_t msgBytes; //whole message including the header
+    uint16_t rsvd;
+    uint32_t drops; //echoes that timed out or came back wrong
+    IpcBenchStats rtt;
+    IpcBenchStats oneWay;
+    uint32_t msgsPerSec; //echoes completed per second
+    uint32_t bytesPerSec; //message bytes moved per second, both directions
+} IpcBenchSizeResult;
+
+//one core pair
+typedef struct {
+    uint16_t srcCore; //CSL core id that ran the benchmark
+    uint16_t dstCore; //CSL core id that echoed
+    int32_t status; //0 once the run has finished
+    IpcBenchSizeResult size[IPC_BENCH_NUM_SIZES];
+} IpcBenchResult;
+
+/* This function turns a cycle count into nanoseconds
+ */
+static inline uint32_t ipc_bench_cycles_to_ns(uint32_t cycles, uint32_t mhz)
+{
+    return (uint32_t)(((uint64_t)cycles * 1000U) / mhz);
+}
+
+/* This function returns the histogram bin for a latency
+ */
+static inline uint32_t ipc_bench_bin(uint32_t ns)
+{
+    uint32_t us = ns / 1000U;
+    uint32_t bin = 0;
+    while(us > 0 && bin < IPC_BENCH_HIST_BINS - 1U)
+    {
+        us >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+/* This function adds one sample to a distribution
+ */
+static inline void ipc_bench_stats_add(IpcBenchStats *st, uint32_t ns)
+{
+    if(st->count == 0 || ns < st->minNs)
+    {
+        st->minNs = ns;
+    }
+    if(ns > st->maxNs)
+    {
+        st->maxNs = ns;
+    }
+    st->count++;
+    st->sumNs += ns;
+    st->hist[ipc_bench_bin(ns)]++;
+}
+
+/* This function returns the upper edge in us of the bin holding the
+ * given percentile, which is as precise as the histogram gets.
+ */
+static inline uint32_t ipc_bench_percentile_us(const IpcBenchStats *st, uint32_t pct)
+{
+    uint32_t want = (st->count * pct + 99U) / 100U;
+    uint32_t seen = 0;
+    uint32_t bin;
+    for(bin = 0; bin < IPC_BENCH_HIST_BINS; bin++)
+    {
+        seen += st->hist[bin];
+        if(seen >= want && seen > 0)
+        {
+            return 1U << bin;
+        }
+    }
+    return 1U << (IPC_BENCH_HIST_BINS - 1U);
+}
+
+/* This function is the echoing side. If buf holds a benchmark request it
+ * is turned into the reply in place and 1 is returned, send it back to the
+ * source endpoint with the same length. Anything else returns 0.
+ */
+static inline int ipc_bench_echo(uint8_t *buf, uint16_t len, uint32_t turnaroundCycles, uint32_t mhz)
+{
+    IpcMsgHeader hdr;
+    IpcBenchEcho echo;
+
+    if(len < sizeof(IpcMsgHeader) + sizeof(IpcBenchEcho))
+    {
+        return 0;
+    }
+    memcpy(&hdr, buf, sizeof(hdr));
+    if(hdr.version != IPC_MSG_VERSION || hdr.opcode != IPC_OP_BENCH_ECHO)
+    {
+        return 0;
+    }
+
+    hdr.opcode |= IPC_OP_RESULT;
+    memcpy(&echo, buf + sizeof(hdr), sizeof(echo));
+    echo.turnaroundCycles = turnaroundCycles;
+    echo.echoMHz = mhz;
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), &echo, sizeof(echo));
+    return 1;
+}
+
+/* This function builds one benchmark request of len bytes
+ */
+static inline void ipc_bench_build(uint8_t *buf, uint16_t len, uint32_t seq)
+{
+    IpcMsgHeader hdr;
+    IpcBenchEcho echo;
+    uint16_t i;
+
+    hdr.version = IPC_MSG_VERSION;
+    hdr.opcode = IPC_OP_BENCH_ECHO;
+    hdr.reqId = (uint16_t)seq;
+    hdr.status = IPC_STATUS_OK;
+    hdr.payloadLen = (uint16_t)(len - sizeof(hdr));
+    echo.seq = seq;
+    echo.turnaroundCycles = 0;
+    echo.echoMHz = 0;
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), &echo, sizeof(echo));
+    for(i = sizeof(hdr) + sizeof(echo); i < len; i++)
+    {
+        buf[i] = (uint8_t)(seq + i); //filler so the bytes actually change
+    }
+}
+
+/* This function checks a received echo and pulls out its payload.
+ * It returns 1 if it is the reply to a benchmark message of len bytes.
+ */
+static inline int ipc_bench_parse(const uint8_t *buf, uint16_t rxLen, uint16_t len, IpcBenchEcho *echo)
+{
+    IpcMsgHeader hdr;
+    if(rxLen != len)
+    {
+        return 0;
+    }
+    memcpy(&hdr, buf, sizeof(hdr));
+    if(hdr.version != IPC_MSG_VERSION || hdr.opcode != (IPC_OP_BENCH_ECHO | IPC_OP_RESULT))
+    {
+        return 0;
+    }
+    memcpy(echo, buf + sizeof(hdr), sizeof(*echo));
+    return 1;
+}
+
+/* This function measures latency for one message size, one echo at a time
+ */
+static inline void ipc_bench_latency(const IpcBenchTransport *t, uint32_t iterations, uint32_t *seq, IpcBenchSizeResult *res)
+{
+    uint8_t buf[IPC_BENCH_MAX_SIZE];
+    uint32_t i;
+
+    for(i = 0; i < iterations; i++)
+    {
+        uint32_t want = (*seq)++;
+        IpcBenchEcho echo;
+        uint16_t rxLen;
+        int got = 0;
+
+        ipc_bench_build(buf, res->msgBytes, want);
+        uint32_t start = t->cycles(t->ctx);
+        if(t->send(t->ctx, buf, res->msgBytes) != 0)
+        {
+            res->drops++;
+            continue;
+        }
+
+        //skip anything stale from an earlier timeout
+        while(!got)
+        {
+            rxLen = sizeof(buf);
+            if(t->recv(t->ctx, buf, &rxLen) != 0)
+            {
+                break;
+            }
+            got = ipc_bench_parse(buf, rxLen, res->msgBytes, &echo) && (echo.seq == want);
+        }
+        uint32_t end = t->cycles(t->ctx);
+        if(!got)
+        {
+            res->drops++;
+            continue;
+        }
+
+        uint32_t rttNs = ipc_bench_cycles_to_ns(end - start, t->localMHz);
+        uint32_t remoteNs = (echo.echoMHz > 0) ? ipc_bench_cycles_to_ns(echo.turnaroundCycles, echo.echoMHz) : 0;
+        ipc_bench_stats_add(&res->rtt, rttNs);
+        ipc_bench_stats_add(&res->oneWay, (rttNs > remoteNs) ? (rttNs - remoteNs) / 2U : 0);
+    }
+}
+
+/* This function measures sustained throughput for one message size,
+ * keeping IPC_BENCH_WINDOW echoes in flight until iterations have finished.
+ */
+static inline void ipc_bench_throughput(const IpcBenchTransport *t, uint32_t iterations, uint32_t *seq, IpcBenchSizeResult *res)
+{
+    uint8_t buf[IPC_BENCH_MAX_SIZE];
+    uint32_t sent = 0;
+    uint32_t done = 0;
+    uint32_t firstSeq = *seq;
+
+    uint32_t start = t->cycles(t->ctx);
+    while(done < iterations)
+    {
+        //top the window back up
+        while(sent < iterations && (sent - done) < IPC_BENCH_WINDOW)
+        {
+            ipc_bench_build(buf, res->msgBytes, (*seq)++);
+            if(t->send(t->ctx, buf, res->msgBytes) != 0)
+            {
+                break;
+            }
+            sent++;
+        }
+
+        IpcBenchEcho echo;
+        uint16_t rxLen = sizeof(buf);
+        if(t->recv(t->ctx, buf, &rxLen) != 0)
+        {
+            break; //whatever is still in flight is lost
+        }
+        if(ipc_bench_parse(buf, rxLen, res->msgBytes, &echo) && (echo.seq - firstSeq) < sent)
+        {
+            done++;
+        }
+    }
+    uint32_t end = t->cycles(t->ctx);
+
+    res->drops += sent - done;
+    uint64_t elapsedNs = ((uint64_t)(end - start) * 1000U) / t->localMHz;
+    if(elapsedNs > 0)
+    {
+        res->msgsPerSec = (uint32_t)(((uint64_t)done * 1000000000U) / elapsedNs);
+        res->bytesPerSec = res->msgsPerSec * 2U * res->msgBytes;
+    }
+}
+
+/* This function runs the whole benchmark against one core.
+ * iterations is per message size and per phase.
+ */
+static inline void ipc_bench_run(const IpcBenchTransport *t, uint32_t iterations, IpcBenchResult *res)
+{
+    uint32_t seq = 0;
+    uint32_t i;
+
+    memset(res->size, 0, sizeof(res->size));
+    for(i = 0; i < IPC_BENCH_NUM_SIZES; i++)
+    {
+        res->size[i].msgBytes = (uint16_t)IPC_BENCH_SIZE(i);
+        ipc_bench_latency(t, iterations, &seq, &res->size[i]);
+        ipc_bench_throughput(t, iterations, &seq, &res->size[i]);
+    }
+    res->status = 0;
+}
+
+#endif
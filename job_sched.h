@@ -0,0 +1,275 @@
+#ifndef JOB_SCHED_H //makes sure it doesn't get repeatedly defined by multiple files
+#define JOB_SCHED_H
+
+#include <stdint.h> //needed for fixed width fields
+
+/* ======================= Offload Job Scheduler ======================= */
+/*
+ * Decides which core runs each offloaded job. Every operation is
+ * registered with the cores that can run it and a starting guess of how
+ * long it takes on each. Jobs go to the core with the earliest estimated
+ * finish (work already given to that core plus this job), and the
+ * estimates follow the measured latency of finished jobs.
+ *
+ * Each core only has a couple of jobs actually sent to it at a time, the
+ * rest wait in a per-core queue here. A core that runs out of work takes
+ * the newest job from another core's queue when it can finish it sooner,
+ * so work piled up behind a busy core moves to an idle one.
+ *
+ * This file only holds the placement policy. It has no RTOS or IPC calls
+ * so the exact same code runs in HostTools/job_sched_sim.c.
+ */
+
+//cores a job can go to
+enum sched_core
+{
+    SCHED_CORE_R5F0 = 0, //run locally on R5F_0
+    SCHED_CORE_R5F1 = 1,
+    SCHED_CORE_DSP = 2,
+    SCHED_NUM_CORES = 3
+};
+
+//capability flags for sched_register_op
+#define SCHED_CAP(core) (1U << (core))
+#define SCHED_CAP_ALL (SCHED_CAP(SCHED_CORE_R5F0) | SCHED_CAP(SCHED_CORE_R5F1) | SCHED_CAP(SCHED_CORE_DSP))
+
+#define SCHED_MAX_OPS (16U) //operations that can be registered
+#define SCHED_QUEUE_LEN (16U) //jobs waiting per core, must be a power of 2
+#define SCHED_MAX_IN_FLIGHT (2U) //jobs actually sent to one core at a time
+#define SCHED_EWMA_SHIFT (3U) //latency estimate moves 1/8 of the way to each sample
+
+//return codes (0 and up are core numbers)
+#define SCHED_ERR_UNKNOWN_OP (-1) //opcode was never registered
+#define SCHED_ERR_FULL (-2) //every core that can run the op has a full queue
+
+//one registered operation
+typedef struct {
+    uint8_t opcode; //enum ipc_opcode or any other id
+    uint8_t capMask; //SCHED_CAP() of each core that can run it
+} SchedOp;
+
+//one job
+typedef struct {
+    uint8_t opIdx; //index into Sched.ops
+    uint8_t core; //core it is queued on or running on
+    uint32_t estUs; //estimate added to that core's backlog
+    void *arg; //caller's job data, never touched here
+} SchedJob;
+
+//queue of jobs waiting for one core
+typedef struct {
+    SchedJob jobs[SCHED_QUEUE_LEN];
+    uint32_t head; //oldest job
+    uint32_t count;
+} SchedQueue;
+
+//scheduler state
+typedef struct {
+    SchedOp ops[SCHED_MAX_OPS];
+    uint32_t numOps;
+    uint32_t estUs[SCHED_NUM_CORES][SCHED_MAX_OPS]; //expected latency of each op on each core
+    uint32_t backlogUs[SCHED_NUM_CORES]; //estimated work queued plus in flight
+    uint32_t inFlight[SCHED_NUM_CORES];
+    uint32_t steals[SCHED_NUM_CORES]; //jobs this core took from another core's queue
+    SchedQueue queue[SCHED_NUM_CORES];
+} Sched;
+
+/* This function clears the scheduler and its registry
+ */
+static inline void sched_init(Sched *s)
+{
+    uint32_t i;
+    uint8_t *p = (uint8_t *)s;
+    for(i = 0; i < sizeof(Sched); i++)
+    {
+        p[i] = 0;
+    }
+}
+
+/* This function registers an operation.
+ * seedUs is the starting latency guess for each core (ignored for cores not in capMask).
+ * It returns the op index or SCHED_ERR_FULL.
+ */
+static inline int32_t sched_register_op(Sched *s, uint8_t opcode, uint8_t capMask, const uint32_t seedUs[SCHED_NUM_CORES])
+{
+    uint32_t core;
+    if(s->numOps >= SCHED_MAX_OPS)
+    {
+        return SCHED_ERR_FULL;
+    }
+    s->ops[s->numOps].opcode = opcode;
+    s->ops[s->numOps].capMask = capMask;
+    for(core = 0; core < SCHED_NUM_CORES; core++)
+    {
+        s->estUs[core][s->numOps] = seedUs[core];
+    }
+    return (int32_t)s->numOps++;
+}
+
+/* This function finds a registered operation.
+ * It returns the op index or SCHED_ERR_UNKNOWN_OP.
+ */
+static inline int32_t sched_find_op(const Sched *s, uint8_t opcode)
+{
+    uint32_t i;
+    for(i = 0; i < s->numOps; i++)
+    {
+        if(s->ops[i].opcode == opcode)
+        {
+            return (int32_t)i;
+        }
+    }
+    return SCHED_ERR_UNKNOWN_OP;
+}
+
+/* This function picks the core that should finish an op soonest.
+ * Cores whose queue is full are skipped.
+ * Ties go to the lower core number, so R5F_0 wins when it costs the same.
+ */
+static inline int32_t sched_pick_core(const Sched *s, uint32_t opIdx)
+{
+    int32_t best = SCHED_ERR_UNKNOWN_OP;
+    uint32_t bestFinish = 0;
+    uint32_t core;
+    for(core = 0; core < SCHED_NUM_CORES; core++)
+    {
+        if(((s->ops[opIdx].capMask & SCHED_CAP(core)) == 0) ||
+           (s->queue[core].count >= SCHED_QUEUE_LEN))
+        {
+            continue;
+        }
+        uint32_t finish = s->backlogUs[core] + s->estUs[core][opIdx];
+        if(best < 0 || finish < bestFinish)
+        {
+            best = (int32_t)core;
+            bestFinish = finish;
+        }
+    }
+    return best;
+}
+
+/* This function queues a job on the core that should finish it soonest.
+ * It returns the core picked or a negative SCHED_ERR code.
+ */
+static inline int32_t sched_submit(Sched *s, uint8_t opcode, void *arg)
+{
+    int32_t opIdx = sched_find_op(s, opcode);
+    if(opIdx < 0)
+    {
+        return opIdx;
+    }
+    int32_t core = sched_pick_core(s, (uint32_t)opIdx);
+    if(core < 0)
+    {
+        return SCHED_ERR_FULL; //every core that can run it is backed up
+    }
+
+    SchedQueue *q = &s->queue[core];
+    SchedJob *job = &q->jobs[(q->head + q->count) & (SCHED_QUEUE_LEN - 1U)];
+    job->opIdx = (uint8_t)opIdx;
+    job->core = (uint8_t)core;
+    job->estUs = s->estUs[core][opIdx];
+    job->arg = arg;
+    q->count++;
+    s->backlogUs[core] += job->estUs;
+    return core;
+}
+
+/* This function hands out the next job for a core to start, if it has room.
+ * A core with an empty queue takes the newest job from another queue if it
+ * would finish it sooner. It returns 1 and fills in job, or 0 if there is nothing to do.
+ */
+static inline int32_t sched_next(Sched *s, uint32_t core, SchedJob *job)
+{
+    SchedQueue *q = &s->queue[core];
+
+    if(s->inFlight[core] >= SCHED_MAX_IN_FLIGHT)
+    {
+        return 0;
+    }
+
+    if(q->count > 0)
+    {
+        *job = q->jobs[q->head];
+        q->head = (q->head + 1U) & (SCHED_QUEUE_LEN - 1U);
+        q->count--;
+        s->inFlight[core]++;
+        return 1;
+    }
+
+    //nothing of our own, look for the job we would finish soonest compared
+    //to where it is. The newest job on a queue finishes last, around the
+    //end of that core's backlog, so only take it if we beat that.
+    uint32_t victim = SCHED_NUM_CORES;
+    uint32_t bestGain = 0;
+    uint32_t other;
+    for(other = 0; other < SCHED_NUM_CORES; other++)
+    {
+        SchedQueue *oq = &s->queue[other];
+        if(other == core || oq->count == 0)
+        {
+            continue;
+        }
+        SchedJob *newest = &oq->jobs[(oq->head + oq->count - 1U) & (SCHED_QUEUE_LEN - 1U)];
+        if((s->ops[newest->opIdx].capMask & SCHED_CAP(core)) == 0)
+        {
+            continue;
+        }
+        uint32_t ours = s->backlogUs[core] + s->estUs[core][newest->opIdx];
+        if(ours < s->backlogUs[other] && (s->backlogUs[other] - ours) > bestGain)
+        {
+            victim = other;
+            bestGain = s->backlogUs[other] - ours;
+        }
+    }
+    if(victim == SCHED_NUM_CORES)
+    {
+        return 0;
+    }
+
+    //move the newest job over, it has the longest wait ahead of it
+    SchedQueue *vq = &s->queue[victim];
+    *job = vq->jobs[(vq->head + vq->count - 1U) & (SCHED_QUEUE_LEN - 1U)];
+    vq->count--;
+    s->backlogUs[victim] -= (s->backlogUs[victim] > job->estUs) ? job->estUs : s->backlogUs[victim];
+    job->core = (uint8_t)core;
+    job->estUs = s->estUs[core][job->opIdx];
+    s->backlogUs[core] += job->estUs;
+    s->inFlight[core]++;
+    s->steals[core]++;
+    return 1;
+}
+
+/* This function drops a started job that never ran, like one whose send
+ * failed. It frees its slot but leaves the latency estimate alone, a near
+ * zero sample from a failed send would pull later jobs toward that core.
+ */
+static inline void sched_abort(Sched *s, const SchedJob *job)
+{
+    uint32_t core = job->core;
+
+    if(s->inFlight[core] > 0)
+    {
+        s->inFlight[core]--;
+    }
+    s->backlogUs[core] -= (s->backlogUs[core] > job->estUs) ? job->estUs : s->backlogUs[core];
+}
+
+/* This function records a finished job and folds its latency into the estimate.
+ */
+static inline void sched_complete(Sched *s, const SchedJob *job, uint32_t measuredUs)
+{
+    uint32_t core = job->core;
+    int32_t est = (int32_t)s->estUs[core][job->opIdx];
+
+    if(s->inFlight[core] > 0)
+    {
+        s->inFlight[core]--;
+    }
+    s->backlogUs[core] -= (s->backlogUs[core] > job->estUs) ? job->estUs : s->backlogUs[core];
+
+    est += ((int32_t)measuredUs - est) / (1 << SCHED_EWMA_SHIFT);
+    s->estUs[core][job->opIdx] = (est > 0) ? (uint32_t)est : 1U;
+}
+
+#endif